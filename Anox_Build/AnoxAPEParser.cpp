@@ -2,33 +2,64 @@
 
 #include "rkit/Core/Endian.h"
 #include "rkit/Core/Optional.h"
-#include "rkit/Core/Stream.h"
 #include "rkit/Core/String.h"
 
+#include <limits>
+#include <string.h>
+
 namespace anox::buildsystem::ape_parse
 {
-	APEReader::APEReader(rkit::IReadStream &stream)
-		: m_stream(stream)
+	rkit::Result ParseTree::AddOperand(uint32_t &outIndex, const Operand &operand)
+	{
+		if (m_operands.Count() >= std::numeric_limits<uint32_t>::max())
+			RKIT_THROW(rkit::ResultCode::kDataError);
+
+		outIndex = static_cast<uint32_t>(m_operands.Count());
+		return m_operands.Append(operand);
+	}
+
+	rkit::Result ParseTree::AddExpression(uint32_t &outIndex, const ExpressionValue &expr)
+	{
+		if (m_expressions.Count() >= std::numeric_limits<uint32_t>::max())
+			RKIT_THROW(rkit::ResultCode::kDataError);
+
+		outIndex = static_cast<uint32_t>(m_expressions.Count());
+		return m_expressions.Append(expr);
+	}
+
+	const Operand &ParseTree::GetOperand(uint32_t index) const
+	{
+		return m_operands[index];
+	}
+
+	const ExpressionValue &ParseTree::GetExpression(uint32_t index) const
+	{
+		return m_expressions[index];
+	}
+
+	APEReader::APEReader(const rkit::ConstSpan<uint8_t> &data, ParseTree &tree)
+		: m_data(data)
+		, m_tree(tree)
 	{
 	}
 
 	rkit::Result APEReader::Read(float &value)
 	{
 		rkit::endian::LittleFloat32_t temp;
-		RKIT_CHECK(m_stream.ReadOneBinary(temp));
+		RKIT_CHECK(ReadOneBinary(temp));
 		value = temp.Get();
 		RKIT_RETURN_OK;
 	}
 
 	rkit::Result APEReader::Read(uint8_t &value)
 	{
-		return m_stream.ReadOneBinary(value);
+		return ReadOneBinary(value);
 	}
 
 	rkit::Result APEReader::Read(uint16_t &value)
 	{
 		rkit::endian::LittleUInt16_t temp;
-		RKIT_CHECK(m_stream.ReadOneBinary(temp));
+		RKIT_CHECK(ReadOneBinary(temp));
 		value = temp.Get();
 		RKIT_RETURN_OK;
 	}
@@ -36,7 +67,7 @@ namespace anox::buildsystem::ape_parse
 	rkit::Result APEReader::Read(uint32_t &value)
 	{
 		rkit::endian::LittleUInt32_t temp;
-		RKIT_CHECK(m_stream.ReadOneBinary(temp));
+		RKIT_CHECK(ReadOneBinary(temp));
 		value = temp.Get();
 		RKIT_RETURN_OK;
 	}
@@ -44,7 +75,7 @@ namespace anox::buildsystem::ape_parse
 	rkit::Result APEReader::Read(uint64_t &value)
 	{
 		rkit::endian::LittleUInt64_t temp;
-		RKIT_CHECK(m_stream.ReadOneBinary(temp));
+		RKIT_CHECK(ReadOneBinary(temp));
 		value = temp.Get();
 		RKIT_RETURN_OK;
 	}
@@ -60,7 +91,7 @@ namespace anox::buildsystem::ape_parse
 	rkit::Result APEReader::Read(rkit::Optional<ExpressionValue> &value)
 	{
 		rkit::endian::LittleUInt64_t exprFlag;
-		RKIT_CHECK(m_stream.ReadOneBinary(exprFlag));
+		RKIT_CHECK(ReadOneBinary(exprFlag));
 
 		if (exprFlag.Get() == 0)
 			value.Reset();
@@ -70,11 +101,11 @@ namespace anox::buildsystem::ape_parse
 			RKIT_CHECK(expr.Read(*this));
 
 			rkit::endian::LittleUInt64_t zeroCheck;
-			RKIT_CHECK(m_stream.ReadOneBinary(zeroCheck));
+			RKIT_CHECK(ReadOneBinary(zeroCheck));
 			if (zeroCheck.Get() != 0)
 				RKIT_THROW(rkit::ResultCode::kDataError);
 
-			value = std::move(expr);
+			value = expr;
 		}
 		else
 			RKIT_THROW(rkit::ResultCode::kDataError);
@@ -82,7 +113,7 @@ namespace anox::buildsystem::ape_parse
 		RKIT_RETURN_OK;
 	}
 
-	rkit::Result APEReader::Read(rkit::Optional<rkit::ByteString> &value)
+	rkit::Result APEReader::Read(rkit::Optional<rkit::ByteStringView> &value)
 	{
 		uint32_t length = 0;
 		RKIT_CHECK(Read(length));
@@ -91,25 +122,24 @@ namespace anox::buildsystem::ape_parse
 			value.Reset();
 		else
 		{
-			rkit::ByteStringConstructionBuffer cbuf;
-			RKIT_CHECK(cbuf.Allocate(length - 1));
+			if (m_data.Count() - m_position < length)
+				RKIT_THROW(rkit::ResultCode::kIOReadError);
 
-			RKIT_CHECK(m_stream.ReadAllSpan(cbuf.GetSpan()));
-
-			uint8_t terminator = 0;
-			RKIT_CHECK(m_stream.ReadOneBinary(terminator));
-			if (terminator != 0)
+			const uint8_t *chars = m_data.Ptr() + m_position;
+			if (chars[length - 1] != 0)
 				RKIT_THROW(rkit::ResultCode::kDataError);
 
-			value = rkit::ByteString(std::move(cbuf));
+			m_position += length;
+
+			value = rkit::ByteStringView(chars, length - 1);
 		}
 
 		RKIT_RETURN_OK;
 	}
 
-	rkit::Result APEReader::Read(rkit::ByteString &value)
+	rkit::Result APEReader::Read(rkit::ByteStringView &value)
 	{
-		rkit::Optional<rkit::ByteString> bstr;
+		rkit::Optional<rkit::ByteStringView> bstr;
 		RKIT_CHECK(Read(bstr));
 
 		if (!bstr.IsSet())
@@ -125,22 +155,20 @@ namespace anox::buildsystem::ape_parse
 		uint8_t doneByte = 0;
 		for (;;)
 		{
-			RKIT_CHECK(m_stream.ReadOneBinary(doneByte));
+			RKIT_CHECK(ReadOneBinary(doneByte));
 
 			if (doneByte != 0)
 				break;
 
 			uint8_t typeByte = 0;
-			RKIT_CHECK(m_stream.ReadOneBinary(typeByte));
+			RKIT_CHECK(ReadOneBinary(typeByte));
 
-			rkit::UniquePtr<Operand> operand;
-			RKIT_CHECK(Operand::CreateFromType(operand, typeByte));
-
-			RKIT_CHECK(operand->Read(*this));
+			uint32_t operandIndex = 0;
+			RKIT_CHECK(ReadOperand(operandIndex, typeByte));
 		}
 
 		uint8_t extraByte = 0;
-		RKIT_CHECK(m_stream.ReadOneBinary(extraByte));
+		RKIT_CHECK(ReadOneBinary(extraByte));
 
 		if (doneByte != 0xff || extraByte != 0xff)
 			RKIT_THROW(rkit::ResultCode::kDataError);
@@ -160,20 +188,73 @@ namespace anox::buildsystem::ape_parse
 
 	rkit::Result APEReader::SkipPadding(size_t count)
 	{
-		rkit::endian::LittleUInt64_t padding;
-		padding = static_cast<uint64_t>(0);
+		if (m_data.Count() - m_position < count)
+			RKIT_THROW(rkit::ResultCode::kIOReadError);
 
-		while (count > 0)
+		const uint8_t *padding = m_data.Ptr() + m_position;
+		for (size_t i = 0; i < count; i++)
 		{
-			const size_t sizeToRead = rkit::Min<size_t>(count, sizeof(padding));
-			RKIT_CHECK(m_stream.ReadAll(&padding, sizeToRead));
-
-			if (padding.Get() != 0)
+			if (padding[i] != 0)
 				RKIT_THROW(rkit::ResultCode::kDataError);
+		}
+
+		m_position += count;
+
+		RKIT_RETURN_OK;
+	}
 
-			count -= sizeToRead;
+	rkit::Result APEReader::ReadOperand(uint32_t &outOperandIndex, uint8_t typeByte)
+	{
+		Operand operand;
+
+		switch (typeByte)
+		{
+		case 0:
+			{
+				ExpressionValue expr;
+				RKIT_CHECK(expr.Read(*this));
+
+				operand.m_operandType = OperandType::Expression;
+				RKIT_CHECK(m_tree.AddExpression(operand.m_expressionIndex, expr));
+			}
+			break;
+		case 4:
+			operand.m_operandType = OperandType::FloatLiteral;
+			RKIT_CHECK(Read(operand.m_floatValue));
+			break;
+		case 5:
+			operand.m_operandType = OperandType::FloatVariable;
+			RKIT_CHECK(Read(operand.m_stringValue));
+			break;
+		case 16:
+			operand.m_operandType = OperandType::StringLiteral;
+			RKIT_CHECK(Read(operand.m_stringValue));
+			break;
+		case 17:
+			operand.m_operandType = OperandType::StringVariable;
+			RKIT_CHECK(Read(operand.m_stringValue));
+			break;
+		default:
+			RKIT_THROW(rkit::ResultCode::kDataError);
 		}
 
+		return m_tree.AddOperand(outOperandIndex, operand);
+	}
+
+	template<class T>
+	rkit::Result APEReader::ReadOneBinary(T &value)
+	{
+		return ReadBytes(&value, sizeof(T));
+	}
+
+	rkit::Result APEReader::ReadBytes(void *data, size_t size)
+	{
+		if (m_data.Count() - m_position < size)
+			RKIT_THROW(rkit::ResultCode::kIOReadError);
+
+		memcpy(data, m_data.Ptr() + m_position, size);
+		m_position += size;
+
 		RKIT_RETURN_OK;
 	}
 
@@ -190,7 +271,7 @@ namespace anox::buildsystem::ape_parse
 
 		m_operator = static_cast<Operator>(op);
 
-		rkit::UniquePtr<Operand> *const operandPtrs[2] =
+		uint32_t *const operandIndexes[2] =
 		{
 			&m_left,
 			&m_right
@@ -200,62 +281,13 @@ namespace anox::buildsystem::ape_parse
 		{
 			const uint8_t operandType = ((flags >> operandIndex) & 0x15u);
 
-			rkit::UniquePtr<Operand> operand;
-			RKIT_CHECK(Operand::CreateFromType(operand, operandType));
-
 			uint32_t prefix1 = 0;
 			uint32_t prefix2 = 0;
 			RKIT_CHECK(reader.Read(prefix1));
 			RKIT_CHECK(reader.Read(prefix2));
-			RKIT_CHECK(operand->Read(reader));
-
-			*(operandPtrs[operandIndex]) = std::move(operand);
+			RKIT_CHECK(reader.ReadOperand(*(operandIndexes[operandIndex]), operandType));
 		}
 
 		RKIT_RETURN_OK;
 	}
-
-	rkit::Result Operand::CreateFromType(rkit::UniquePtr<Operand> &outOperand, uint8_t typeByte)
-	{
-		switch (typeByte)
-		{
-		case 0:
-			return rkit::New<ExpressionOperand>(outOperand);
-		case 4:
-			return rkit::New<FloatOperand>(outOperand);
-		case 5:
-			return rkit::New<FloatVariableNameOperand>(outOperand);
-		case 16:
-			return rkit::New<StringOperand>(outOperand);
-		case 17:
-			return rkit::New<StringVariableNameOperand>(outOperand);
-		default:
-			RKIT_THROW(rkit::ResultCode::kDataError);
-		}
-	}
-
-	rkit::Result FloatOperand::Read(APEReader &reader)
-	{
-		return reader.Read(m_value);
-	}
-
-	rkit::Result FloatVariableNameOperand::Read(APEReader &reader)
-	{
-		return reader.Read(m_value);
-	}
-
-	rkit::Result StringOperand::Read(APEReader &reader)
-	{
-		return reader.Read(m_value);
-	}
-
-	rkit::Result StringVariableNameOperand::Read(APEReader &reader)
-	{
-		return reader.Read(m_value);
-	}
-
-	rkit::Result ExpressionOperand::Read(APEReader &reader)
-	{
-		return m_value.Read(reader);
-	}
 }
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "rkit/Core/Optional.h"
-#include "rkit/Core/Stream.h"
+#include "rkit/Core/Span.h"
 #include "rkit/Core/StringProto.h"
 #include "rkit/Core/String.h"
 #include "rkit/Core/UniquePtr.h"
@@ -21,16 +21,18 @@ namespace anox::buildsystem::ape_parse
 {
 	struct IAPEWriter;
 	class APEReader;
-	struct Operand;
+	class ParseTree;
 
+	// Strings in the parse tree are views into the APE file buffer, which stores
+	// a null terminator after every string.
 	struct TextureID
 	{
-		rkit::ByteString m_str;
+		rkit::ByteStringView m_str;
 	};
 
 	struct WindowStyleID
 	{
-		rkit::ByteString m_str;
+		rkit::ByteStringView m_str;
 	};
 
 	struct ExpressionValue
@@ -56,8 +58,8 @@ namespace anox::buildsystem::ape_parse
 		};
 
 		Operator m_operator = Operator::Invalid;
-		rkit::UniquePtr<Operand> m_left;
-		rkit::UniquePtr<Operand> m_right;
+		uint32_t m_left = 0;	// Operand index in the parse tree
+		uint32_t m_right = 0;	// Operand index in the parse tree
 
 		rkit::Result Read(APEReader &reader);
 	};
@@ -73,57 +75,16 @@ namespace anox::buildsystem::ape_parse
 
 	struct Operand
 	{
-		virtual ~Operand() {}
+		OperandType m_operandType = OperandType::FloatLiteral;
 
-		virtual rkit::Result Read(APEReader &reader) = 0;
-		virtual OperandType GetOperandType() const = 0;
-
-		static rkit::Result CreateFromType(rkit::UniquePtr<Operand> &outOperand, uint8_t typeByte);
-	};
-
-	struct FloatOperand : public Operand
-	{
-		float m_value = 0;
-
-		OperandType GetOperandType() const override { return OperandType::FloatLiteral; }
-		rkit::Result Read(APEReader &reader) override;
-	};
-
-	struct FloatVariableNameOperand : public Operand
-	{
-		rkit::ByteString m_value;
-
-		OperandType GetOperandType() const override { return OperandType::FloatVariable; }
-		rkit::Result Read(APEReader &reader) override;
-	};
-
-	struct StringOperand : public Operand
-	{
-		rkit::ByteString m_value;
-
-		OperandType GetOperandType() const override { return OperandType::StringLiteral; }
-		rkit::Result Read(APEReader &reader) override;
-	};
-
-	struct ExpressionOperand : public Operand
-	{
-		ExpressionValue m_value;
-
-		OperandType GetOperandType() const override { return OperandType::Expression; }
-		rkit::Result Read(APEReader &reader) override;
-	};
-
-	struct StringVariableNameOperand : public Operand
-	{
-		rkit::ByteString m_value;
-
-		OperandType GetOperandType() const override { return OperandType::StringVariable; }
-		rkit::Result Read(APEReader &reader) override;
+		float m_floatValue = 0.f;				// FloatLiteral
+		rkit::ByteStringView m_stringValue;		// FloatVariable, StringLiteral, StringVariable
+		uint32_t m_expressionIndex = 0;			// Expression, index in the parse tree
 	};
 
 	struct FormattingValue
 	{
-		rkit::Vector<rkit::UniquePtr<Operand>> m_operands;
+		rkit::Vector<uint32_t> m_operands;		// Operand indexes in the parse tree
 	};
 
 	struct SwitchCommand
@@ -131,7 +92,7 @@ namespace anox::buildsystem::ape_parse
 		uint64_t m_cc = 0;
 		uint8_t m_opcode = 0;
 		FormattingValue m_fmt;
-		rkit::Optional<rkit::ByteString> m_str;
+		rkit::Optional<rkit::ByteStringView> m_str;
 		rkit::Optional<ExpressionValue> m_expr;
 	};
 
@@ -152,17 +113,35 @@ namespace anox::buildsystem::ape_parse
 		virtual rkit::Result Write(uint32_t value) = 0;
 		virtual rkit::Result Write(uint64_t value) = 0;
 		virtual rkit::Result Write(const rkit::Optional<ExpressionValue> &value) = 0;
-		virtual rkit::Result Write(const rkit::Optional<rkit::ByteString> &value) = 0;
-		virtual rkit::Result Write(const rkit::ByteString &value) = 0;
+		virtual rkit::Result Write(const rkit::Optional<rkit::ByteStringView> &value) = 0;
+		virtual rkit::Result Write(const rkit::ByteStringView &value) = 0;
 		virtual rkit::Result Write(const FormattingValue &value) = 0;
 		virtual rkit::Result Write(const TextureID &textureID) = 0;
 		virtual rkit::Result Write(const WindowStyleID &styleID) = 0;
 	};
 
+	// Flat storage for the operands and subexpressions of all expressions in an APE file.
+	// Nodes reference each other by index.
+	class ParseTree
+	{
+	public:
+		rkit::Result AddOperand(uint32_t &outIndex, const Operand &operand);
+		rkit::Result AddExpression(uint32_t &outIndex, const ExpressionValue &expr);
+
+		const Operand &GetOperand(uint32_t index) const;
+		const ExpressionValue &GetExpression(uint32_t index) const;
+
+	private:
+		rkit::Vector<Operand> m_operands;
+		rkit::Vector<ExpressionValue> m_expressions;
+	};
+
+	// Reads APE data from a buffer containing the entire file.  The buffer must outlive
+	// the parse tree and any commands read from it.
 	class APEReader
 	{
 	public:
-		explicit APEReader(rkit::IReadStream &stream);
+		APEReader(const rkit::ConstSpan<uint8_t> &data, ParseTree &tree);
 
 		rkit::Result Read(float &value);
 		rkit::Result Read(uint8_t &value);
@@ -171,14 +150,23 @@ namespace anox::buildsystem::ape_parse
 		rkit::Result Read(uint64_t &value);
 		rkit::Result ReadBits(uint32_t &value, uint32_t allowedMask);
 		rkit::Result Read(rkit::Optional<ExpressionValue> &value);
-		rkit::Result Read(rkit::Optional<rkit::ByteString> &value);
-		rkit::Result Read(rkit::ByteString &value);
+		rkit::Result Read(rkit::Optional<rkit::ByteStringView> &value);
+		rkit::Result Read(rkit::ByteStringView &value);
 		rkit::Result Read(FormattingValue &value);
 		rkit::Result Read(TextureID &value);
 		rkit::Result Read(WindowStyleID &value);
 		rkit::Result SkipPadding(size_t count);
 
+		rkit::Result ReadOperand(uint32_t &outOperandIndex, uint8_t typeByte);
+
 	private:
-		rkit::IReadStream &m_stream;
+		template<class T>
+		rkit::Result ReadOneBinary(T &value);
+
+		rkit::Result ReadBytes(void *data, size_t size);
+
+		rkit::ConstSpan<uint8_t> m_data;
+		size_t m_position = 0;
+		ParseTree &m_tree;
 	};
 }
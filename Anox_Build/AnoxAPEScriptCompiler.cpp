@@ -11,11 +11,14 @@
 
 #include "rkit/Core/Algorithm.h"
 #include "rkit/Core/HashTable.h"
+#include "rkit/Core/Job.h"
 #include "rkit/Core/MemoryStream.h"
+#include "rkit/Core/NewDelete.h"
 #include "rkit/Core/NoCopy.h"
 #include "rkit/Core/Stream.h"
 #include "rkit/Core/LogDriver.h"
 #include "rkit/Core/QuickSort.h"
+#include "rkit/Core/SystemDriver.h"
 
 #include "rkit/BuildSystem/BuildSystem.h"
 #include "rkit/Data/ContentID.h"
@@ -49,6 +52,42 @@ namespace anox::buildsystem
 
 		bool operator==(const APEResourceRefKey &other) const = default;
 	};
+
+	enum class APEIndexFixupType
+	{
+		String,
+		OptionalString,
+		OperandList,
+		ExpressionValue,
+		MaterialReference,
+	};
+
+	// Location of an index value embedded in a window command stream
+	struct APEIndexFixup
+	{
+		APEIndexFixupType m_fixupType = APEIndexFixupType::String;
+		size_t m_offset = 0;
+	};
+
+	// Maps indexes from a batch compiler context to the indexes in the merged context
+	struct APEIndexRemap
+	{
+		rkit::Vector<uint32_t> m_strings;
+		rkit::Vector<uint32_t> m_tempStrings;
+		rkit::Vector<uint32_t> m_materialNames;
+		rkit::Vector<uint32_t> m_resourceRefs;
+		rkit::Vector<uint32_t> m_expressions;
+		rkit::Vector<uint32_t> m_operandLists;
+
+		rkit::Result RemapOptionalString(rkit::endian::LittleUInt32_t &index) const;
+		rkit::Result RemapExpression(data::ape::Expression &expr) const;
+		rkit::Result RemapExprValue(data::ape::ExpressionValue &value) const;
+		rkit::Result RemapOperand(data::ape::ExpressionValue &value) const;
+		rkit::Result RemapMaterialReference(data::ape::MaterialReference &matRef) const;
+
+		static rkit::Result RemapIndex(uint32_t &index, const rkit::Vector<uint32_t> &indexMap);
+		static rkit::Result RemapIndex(rkit::endian::LittleUInt32_t &index, const rkit::Vector<uint32_t> &indexMap);
+	};
 }
 
 template<>
@@ -61,18 +100,18 @@ namespace anox::buildsystem
 	class APECompilerContext
 	{
 	public:
-		explicit APECompilerContext(rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback);
+		APECompilerContext(const ape_parse::ParseTree &parseTree, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback);
 
 		rkit::Result IndexExpression(uint32_t &outIndex, data::ape::Expression &&expr);
 		rkit::Result IndexOperandList(uint32_t &outIndex, rkit::Vector<data::ape::ExpressionValue> &&operands);
-		rkit::Result IndexString(uint32_t &outIndex, const rkit::ByteString &str);
+		rkit::Result IndexString(uint32_t &outIndex, const rkit::ByteStringSliceView &str);
 		rkit::Result IndexResource(uint32_t &outIndex, uint32_t compileNamespace, uint32_t compileNodeType, uint32_t resNamespace, uint32_t resType,
 			const rkit::StringView &prefix, const rkit::ByteStringSliceView &arg);
 
 		rkit::Result ConvertOptionalExprValue(data::ape::ExpressionValue &outExprValue, const rkit::Optional<ape_parse::ExpressionValue> &value);
 		rkit::Result ConvertExprValue(uint32_t &outIndex, data::ape::OperandType &outOperandType, bool &outIsString, const ape_parse::ExpressionValue &expr);
-		rkit::Result ConvertOptionalByteString(uint32_t &outDWord, const rkit::Optional<rkit::ByteString> &value);
-		rkit::Result ConvertByteString(uint32_t &outDWord, const rkit::ByteString &value);
+		rkit::Result ConvertOptionalByteString(uint32_t &outDWord, const rkit::Optional<rkit::ByteStringView> &value);
+		rkit::Result ConvertByteString(uint32_t &outDWord, const rkit::ByteStringSliceView &value);
 		rkit::Result ConvertFormattingValue(uint32_t &outDWord, const ape_parse::FormattingValue &value);
 		rkit::Result ConvertOperand(uint32_t &outIndex, data::ape::OperandType &outOperandType, bool &outIsString, const ape_parse::Operand &operand);
 		rkit::Result ConvertMaterial(data::ape::MaterialReference &outMaterialRef, const rkit::ByteString &bstr);
@@ -83,7 +122,23 @@ namespace anox::buildsystem
 			rkit::Vector<data::ape::ResourceRef> &outResourceRefs, rkit::Vector<data::ape::IntermediateResourceRef> &outIntermediateRefs,
 			rkit::Vector<rkit::String> &outTempStrings) const;
 
+		// Merges the contents of a batch context, indexing its values in the same order
+		// that they would have been indexed if the batch were compiled into this context.
+		rkit::Result Merge(const APECompilerContext &batchCtx, APEIndexRemap &outRemap);
+
+		const ape_parse::ParseTree &GetParseTree() const;
+
 	private:
+		struct DeferredNodeDependency
+		{
+			uint32_t m_nodeNamespace = 0;
+			uint32_t m_nodeType = 0;
+			rkit::CIPath m_path;
+		};
+
+		template<class TKey>
+		static rkit::Result GetKeysInIndexOrder(rkit::Vector<const TKey *> &outKeys, const rkit::HashMap<TKey, uint32_t> &hashMap);
+
 		class OperandListKey final : public rkit::NoCopy
 		{
 		public:
@@ -128,6 +183,10 @@ namespace anox::buildsystem
 		rkit::HashMap<APEResourceRefKey, uint32_t> m_resourceRefs;
 		rkit::HashMap<rkit::String, uint32_t> m_tempStrings;
 
+		// Batch contexts have no feedback, node dependencies are added when they are merged
+		rkit::Vector<DeferredNodeDependency> m_deferredNodeDependencies;
+
+		const ape_parse::ParseTree &m_parseTree;
 		rkit::buildsystem::IDependencyNodeCompilerFeedback *m_feedback = nullptr;
 	};
 
@@ -135,7 +194,7 @@ namespace anox::buildsystem
 	{
 	public:
 		APEWriter() = delete;
-		APEWriter(APECompilerContext &context, rkit::IWriteStream &stream);
+		APEWriter(APECompilerContext &context, rkit::IWriteStream &stream, rkit::Vector<APEIndexFixup> &fixups);
 
 		rkit::Result Write(float value) override;
 		rkit::Result Write(uint8_t value) override;
@@ -143,17 +202,23 @@ namespace anox::buildsystem
 		rkit::Result Write(uint32_t value) override;
 		rkit::Result Write(uint64_t value) override;
 		rkit::Result Write(const rkit::Optional<ape_parse::ExpressionValue> &value) override;
-		rkit::Result Write(const rkit::Optional<rkit::ByteString> &value) override;
-		rkit::Result Write(const rkit::ByteString &value) override;
+		rkit::Result Write(const rkit::Optional<rkit::ByteStringView> &value) override;
+		rkit::Result Write(const rkit::ByteStringView &value) override;
 		rkit::Result Write(const ape_parse::FormattingValue &value) override;
 		rkit::Result Write(const ape_parse::TextureID &value) override;
 		rkit::Result Write(const ape_parse::WindowStyleID &value) override;
 
 	private:
-		rkit::Result IndexString(uint32_t &outIndex, uint32_t baseIndex, const rkit::ByteString &value);
+		rkit::Result IndexString(uint32_t &outIndex, uint32_t baseIndex, const rkit::ByteStringSliceView &value);
+		rkit::Result AddFixup(APEIndexFixupType fixupType);
+
+		template<class T>
+		rkit::Result WriteBinary(const T &value);
 
 		APECompilerContext &m_context;
 		rkit::IWriteStream &m_stream;
+		rkit::Vector<APEIndexFixup> &m_fixups;
+		size_t m_position = 0;
 	};
 
 
@@ -218,6 +283,7 @@ namespace anox::buildsystem
 		{
 			rkit::endian::LittleUInt32_t m_windowID;
 			rkit::Vector<uint8_t> m_commandStream;
+			rkit::Vector<APEIndexFixup> m_indexFixups;
 		};
 
 		struct SwitchDef
@@ -266,6 +332,48 @@ namespace anox::buildsystem
 			rkit::Vector<data::ape::IntermediateResourceRef> m_intermediateResourceRefs;
 		};
 
+		// Contiguous range of windows and switches compiled into its own context.
+		// Windows come first, followed by switches.
+		struct CompileBatch
+		{
+			size_t m_firstItem = 0;
+			size_t m_numItems = 0;
+			rkit::UniquePtr<APECompilerContext> m_ctx;
+		};
+
+		class CompileBatchJobRunner final : public rkit::IJobRunner
+		{
+		public:
+			CompileBatchJobRunner(CompileBatch &batch, APEBlob &blob, const rkit::Vector<WindowDef> &windowDefs, const rkit::Vector<SwitchDef> &switchDefs);
+
+			rkit::Result Run() override;
+
+		private:
+			CompileBatch &m_batch;
+			APEBlob &m_blob;
+			const rkit::Vector<WindowDef> &m_windowDefs;
+			const rkit::Vector<SwitchDef> &m_switchDefs;
+		};
+
+		static const uint8_t kIfOpcode = 1;
+		static const uint8_t kExternOpcode = 10;
+		static const uint8_t kWhileOpcode = 11;
+		static const uint8_t kJumpOpcode = 22;
+		static const uint8_t kRJumpOpcode = 23;
+
+		// Minimum number of windows and switches to compile on one thread.  Each batch also costs
+		// a context merge and an index remap pass, so small scripts stay on the calling thread.
+		static const size_t kMinItemsPerBatch = 256;
+
+		static rkit::Result ParseAPEFile(const rkit::ConstSpan<uint8_t> &fileContents, ape_parse::ParseTree &parseTree, rkit::Vector<WindowDef> &windowDefs, rkit::Vector<SwitchDef> &switchDefs);
+		static rkit::Result CompileAll(rkit::buildsystem::IBuildSystemInstance &instance, size_t minItemsPerBatch, APECompilerContext &ctx, APEBlob &blob, const rkit::Vector<WindowDef> &windowDefs, const rkit::Vector<SwitchDef> &switchDefs);
+		static rkit::Result CompileItems(APECompilerContext &ctx, APEBlob &blob, const rkit::Vector<WindowDef> &windowDefs, const rkit::Vector<SwitchDef> &switchDefs, size_t firstItem, size_t numItems);
+		static rkit::Result RemapWindow(CompiledWindowDef &compiledWindow, const APEIndexRemap &remap);
+		static rkit::Result RemapSwitch(CompiledSwitchDef &compiledSwitch, const APEIndexRemap &remap);
+
+		template<class T, class TFunc>
+		static rkit::Result RemapCommandStreamValue(rkit::Vector<uint8_t> &commandStream, size_t offset, const TFunc &remapFunc);
+
 		static rkit::Result CompileWindow(APECompilerContext &ctx, CompiledWindowDef &compiledWindow, const WindowDef &wdef);
 		static rkit::Result CompileSwitch(APECompilerContext &ctx, CompiledSwitchDef &compiledSwitch, const SwitchDef &switchDef);
 		static rkit::Result CompileBasicBlock(APECompilerContext &ctx, rkit::Vector<data::ape::SwitchCommand> &cmdStream, const rkit::HashMap<uint64_t, const ape_parse::SwitchCommand *> &tree, uint64_t firstCC);
@@ -299,61 +407,65 @@ namespace anox::buildsystem
 		static rkit::Result ResolvePath(rkit::CIPath &depsFilePath, const rkit::StringView &groupNodeIdentifier, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback);
 	};
 
-	APEWriter::APEWriter(APECompilerContext &context, rkit::IWriteStream &stream)
+	APEWriter::APEWriter(APECompilerContext &context, rkit::IWriteStream &stream, rkit::Vector<APEIndexFixup> &fixups)
 		: m_context(context)
 		, m_stream(stream)
+		, m_fixups(fixups)
 	{
 	}
 
 	rkit::Result APEWriter::Write(float value)
 	{
 		rkit::endian::LittleFloat32_t encoded(value);
-		return m_stream.WriteOneBinary(encoded);
+		return WriteBinary(encoded);
 	}
 
 	rkit::Result APEWriter::Write(uint8_t value)
 	{
-		return m_stream.WriteOneBinary(value);
+		return WriteBinary(value);
 	}
 
 	rkit::Result APEWriter::Write(uint16_t value)
 	{
 		rkit::endian::LittleUInt16_t encoded(value);
-		return m_stream.WriteOneBinary(value);
+		return WriteBinary(value);
 	}
 
 	rkit::Result APEWriter::Write(uint32_t value)
 	{
 		rkit::endian::LittleUInt32_t encoded(value);
-		return m_stream.WriteOneBinary(value);
+		return WriteBinary(value);
 	}
 
 	rkit::Result APEWriter::Write(uint64_t value)
 	{
 		rkit::endian::LittleUInt64_t encoded(value);
-		return m_stream.WriteOneBinary(value);
+		return WriteBinary(value);
 	}
 
 	rkit::Result APEWriter::Write(const rkit::Optional<ape_parse::ExpressionValue> &value)
 	{
 		data::ape::ExpressionValue expr = {};
 		RKIT_CHECK(m_context.ConvertOptionalExprValue(expr, value));
-		return m_stream.WriteOneBinary(expr);
+		RKIT_CHECK(AddFixup(APEIndexFixupType::ExpressionValue));
+		return WriteBinary(expr);
 	}
 
-	rkit::Result APEWriter::Write(const rkit::Optional<rkit::ByteString> &value)
+	rkit::Result APEWriter::Write(const rkit::Optional<rkit::ByteStringView> &value)
 	{
 		uint32_t index = 0;
 		RKIT_CHECK(m_context.ConvertOptionalByteString(index, value));
 		rkit::endian::LittleUInt32_t indexData = rkit::endian::LittleUInt32_t(index);
 
-		return m_stream.WriteOneBinary(indexData);
+		RKIT_CHECK(AddFixup(APEIndexFixupType::OptionalString));
+		return WriteBinary(indexData);
 	}
 
-	rkit::Result APEWriter::Write(const rkit::ByteString &value)
+	rkit::Result APEWriter::Write(const rkit::ByteStringView &value)
 	{
 		uint32_t index = 0;
 		RKIT_CHECK(IndexString(index, 0, value));
+		RKIT_CHECK(AddFixup(APEIndexFixupType::String));
 		return Write(index);
 	}
 
@@ -362,14 +474,17 @@ namespace anox::buildsystem
 		uint32_t index = 0;
 		RKIT_CHECK(m_context.ConvertFormattingValue(index, value));
 		rkit::endian::LittleUInt32_t indexData = rkit::endian::LittleUInt32_t(index);
-		return m_stream.WriteOneBinary(indexData);
+		RKIT_CHECK(AddFixup(APEIndexFixupType::OperandList));
+		return WriteBinary(indexData);
 	}
 
 	rkit::Result APEWriter::Write(const ape_parse::TextureID &value)
 	{
 		data::ape::MaterialReference matRef = {};
 
-		rkit::ByteString bstr = value.m_str;
+		rkit::ByteString bstr;
+		RKIT_CHECK(bstr.Set(value.m_str));
+
 		if (bstr.StartsWith(rkit::StringSliceView(u8"../").RemoveEncoding()))
 		{
 			RKIT_CHECK(bstr.Set(bstr.SubString(3, bstr.Length() - 3)));
@@ -384,7 +499,8 @@ namespace anox::buildsystem
 		}
 
 		RKIT_CHECK(m_context.ConvertMaterial(matRef, bstr));
-		return m_stream.WriteOneBinary(matRef);
+		RKIT_CHECK(AddFixup(APEIndexFixupType::MaterialReference));
+		return WriteBinary(matRef);
 	}
 
 	rkit::Result APEWriter::Write(const ape_parse::WindowStyleID &value)
@@ -405,10 +521,29 @@ namespace anox::buildsystem
 			RKIT_CHECK(m_context.ConvertMaterial(matRef, adjusted));
 		}
 
-		return m_stream.WriteOneBinary(matRef);
+		RKIT_CHECK(AddFixup(APEIndexFixupType::MaterialReference));
+		return WriteBinary(matRef);
 	}
 
-	rkit::Result APEWriter::IndexString(uint32_t &outIndex, uint32_t baseIndex, const rkit::ByteString &value)
+	rkit::Result APEWriter::AddFixup(APEIndexFixupType fixupType)
+	{
+		APEIndexFixup fixup;
+		fixup.m_fixupType = fixupType;
+		fixup.m_offset = m_position;
+
+		return m_fixups.Append(fixup);
+	}
+
+	template<class T>
+	rkit::Result APEWriter::WriteBinary(const T &value)
+	{
+		RKIT_CHECK(m_stream.WriteOneBinary(value));
+		m_position += sizeof(T);
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEWriter::IndexString(uint32_t &outIndex, uint32_t baseIndex, const rkit::ByteStringSliceView &value)
 	{
 		uint32_t ctxIndex = 0;
 		RKIT_CHECK(m_context.IndexString(ctxIndex, value));
@@ -466,114 +601,33 @@ namespace anox::buildsystem
 		rkit::CIPath path;
 		RKIT_CHECK(path.Set(depsNode->GetIdentifier()));
 
-		rkit::UniquePtr<rkit::ISeekableReadStream> inputFile;
-		RKIT_CHECK(feedback->OpenInput(rkit::buildsystem::BuildFileLocation::kSourceDir, path, inputFile));
-
-		rkit::Vector<WindowDef> windowDefs;
-		rkit::Vector<SwitchDef> switchDefs;
+		// APE files are parsed a few bytes at a time, so the whole file is loaded first.
+		// Strings in the parse tree point into this buffer.
+		rkit::Vector<uint8_t> fileContents;
 
 		{
-			rkit::endian::LittleUInt64_t header;
-			RKIT_CHECK(inputFile->ReadOneBinary(header));
-
-			if (header.Get() != 0xffffffff0000013d)
-			{
-				rkit::log::Error(u8"Invalid APE header");
-				RKIT_THROW(rkit::ResultCode::kDataError);
-			}
-
-			// Load windows
-			for (;;)
-			{
-				rkit::endian::LittleUInt32_t windowID;
-				RKIT_CHECK(inputFile->ReadOneBinary(windowID));
-
-				if (windowID.Get() == 0)
-					break;
-
-				WindowDef windowDef;
-				windowDef.m_windowID = windowID.Get();
-
-				for (;;)
-				{
-					uint8_t opcode = 0;
-					RKIT_CHECK(inputFile->ReadOneBinary(opcode));
-
-					rkit::UniquePtr<ape_parse::WindowCommand> cmd;
-					RKIT_CHECK(ape_parse::CreateWindowCommand(cmd, opcode));
-
-					ape_parse::APEReader reader(*inputFile);
-					RKIT_CHECK(cmd->Parse(reader));
-
-					if (cmd->GetCommandType() == data::WindowCommandType::End)
-						break;
-
-					RKIT_CHECK(windowDef.m_commands.Append(std::move(cmd)));
-				}
-
-				RKIT_CHECK(windowDefs.Append(std::move(windowDef)));
-			}
-
-			// Load switches
-			{
-				ape_parse::APEReader reader(*inputFile);
-				uint32_t switchMarker = 0;
-				RKIT_CHECK(reader.Read(switchMarker));
-				if (switchMarker != 0xfffffffeu)
-					RKIT_THROW(rkit::ResultCode::kDataError);
-
-				for (;;)
-				{
-					uint32_t switchLabel = 0;
-					RKIT_CHECK(reader.Read(switchLabel));
-					if (switchLabel == 0)
-						break;
-
-					SwitchDef switchDef;
-					switchDef.m_switchID = switchLabel;
-
-					for (;;)
-					{
-						ape_parse::SwitchCommand cmd;
-						RKIT_CHECK(reader.Read(cmd.m_cc));
-						RKIT_CHECK(reader.Read(cmd.m_opcode));
-
-						if (cmd.m_opcode > 21)
-						{
-							if (cmd.m_opcode == 69)
-								break;	// End
-
-							RKIT_THROW(rkit::ResultCode::kDataError);
-						}
+			rkit::UniquePtr<rkit::ISeekableReadStream> inputFile;
+			RKIT_CHECK(feedback->OpenInput(rkit::buildsystem::BuildFileLocation::kSourceDir, path, inputFile));
 
-						RKIT_CHECK(reader.Read(cmd.m_str));
-						RKIT_CHECK(reader.Read(cmd.m_fmt));
-						RKIT_CHECK(reader.Read(cmd.m_expr));
-						RKIT_CHECK(switchDef.m_commands.Append(std::move(cmd)));
-					}
+			const rkit::FilePos_t fileSize = inputFile->GetSize();
+			if (fileSize > std::numeric_limits<size_t>::max())
+				RKIT_THROW(rkit::ResultCode::kOutOfMemory);
 
-					RKIT_CHECK(switchDefs.Append(std::move(switchDef)));
-				}
-			}
+			RKIT_CHECK(fileContents.Resize(static_cast<size_t>(fileSize)));
+			RKIT_CHECK(inputFile->ReadAllSpan(fileContents.ToSpan()));
 		}
 
-		APECompilerContext compilerCtx(feedback);
+		ape_parse::ParseTree parseTree;
+		rkit::Vector<WindowDef> windowDefs;
+		rkit::Vector<SwitchDef> switchDefs;
 
-		APEBlob blob;
+		RKIT_CHECK(ParseAPEFile(fileContents.ToSpan(), parseTree, windowDefs, switchDefs));
 
-		RKIT_CHECK(blob.m_windows.Resize(windowDefs.Count()));
+		APECompilerContext compilerCtx(parseTree, feedback);
 
-		for (size_t windowIndex = 0; windowIndex < windowDefs.Count(); windowIndex++)
-		{
-			RKIT_CHECK(CompileWindow(compilerCtx, blob.m_windows[windowIndex], windowDefs[windowIndex]));
-		}
+		APEBlob blob;
 
-		RKIT_CHECK(blob.m_switches.Resize(switchDefs.Count()));
-
-		for (size_t switchIndex = 0; switchIndex < switchDefs.Count(); switchIndex++)
-		{
-			RKIT_CHECK(CompileSwitch(compilerCtx, blob.m_switches[switchIndex], switchDefs[switchIndex]));
-		}
+		RKIT_CHECK(CompileAll(*feedback->GetBuildSystemInstance(), kMinItemsPerBatch, compilerCtx, blob, windowDefs, switchDefs));
 
 		RKIT_CHECK(compilerCtx.DumpResults(blob.m_operandLists, blob.m_exprs, blob.m_strings, blob.m_materialWildcards, blob.m_materialNames, blob.m_resourceRefs, blob.m_intermediateResourceRefs, blob.m_tempStrings));
 
@@ -628,8 +682,97 @@ namespace anox::buildsystem
 		RKIT_RETURN_OK;
 	}
 
-	APECompilerContext::APECompilerContext(rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
-		: m_feedback(feedback)
+	rkit::Result APEScriptCompilerImpl::ParseAPEFile(const rkit::ConstSpan<uint8_t> &fileContents, ape_parse::ParseTree &parseTree, rkit::Vector<WindowDef> &windowDefs, rkit::Vector<SwitchDef> &switchDefs)
+	{
+		ape_parse::APEReader reader(fileContents, parseTree);
+
+		uint64_t header = 0;
+		RKIT_CHECK(reader.Read(header));
+
+		if (header != 0xffffffff0000013d)
+		{
+			rkit::log::Error(u8"Invalid APE header");
+			RKIT_THROW(rkit::ResultCode::kDataError);
+		}
+
+		// Load windows
+		for (;;)
+		{
+			uint32_t windowID = 0;
+			RKIT_CHECK(reader.Read(windowID));
+
+			if (windowID == 0)
+				break;
+
+			WindowDef windowDef;
+			windowDef.m_windowID = windowID;
+
+			for (;;)
+			{
+				uint8_t opcode = 0;
+				RKIT_CHECK(reader.Read(opcode));
+
+				rkit::UniquePtr<ape_parse::WindowCommand> cmd;
+				RKIT_CHECK(ape_parse::CreateWindowCommand(cmd, opcode));
+
+				RKIT_CHECK(cmd->Parse(reader));
+
+				if (cmd->GetCommandType() == data::WindowCommandType::End)
+					break;
+
+				RKIT_CHECK(windowDef.m_commands.Append(std::move(cmd)));
+			}
+
+			RKIT_CHECK(windowDefs.Append(std::move(windowDef)));
+		}
+
+		// Load switches
+		{
+			uint32_t switchMarker = 0;
+			RKIT_CHECK(reader.Read(switchMarker));
+			if (switchMarker != 0xfffffffeu)
+				RKIT_THROW(rkit::ResultCode::kDataError);
+
+			for (;;)
+			{
+				uint32_t switchLabel = 0;
+				RKIT_CHECK(reader.Read(switchLabel));
+				if (switchLabel == 0)
+					break;
+
+				SwitchDef switchDef;
+				switchDef.m_switchID = switchLabel;
+
+				for (;;)
+				{
+					ape_parse::SwitchCommand cmd;
+					RKIT_CHECK(reader.Read(cmd.m_cc));
+					RKIT_CHECK(reader.Read(cmd.m_opcode));
+
+					if (cmd.m_opcode > 21)
+					{
+						if (cmd.m_opcode == 69)
+							break;	// End
+
+						RKIT_THROW(rkit::ResultCode::kDataError);
+					}
+
+					RKIT_CHECK(reader.Read(cmd.m_str));
+					RKIT_CHECK(reader.Read(cmd.m_fmt));
+					RKIT_CHECK(reader.Read(cmd.m_expr));
+					RKIT_CHECK(switchDef.m_commands.Append(std::move(cmd)));
+				}
+
+				RKIT_CHECK(switchDefs.Append(std::move(switchDef)));
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	APECompilerContext::APECompilerContext(const ape_parse::ParseTree &parseTree, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
+		: m_parseTree(parseTree)
+		, m_feedback(feedback)
 	{
 	}
 
@@ -645,9 +788,12 @@ namespace anox::buildsystem
 		return APECompilerHelper::IndexValue(outIndex, m_operandLists, opsKey.ComputeHash(), std::move(opsKey));
 	}
 
-	rkit::Result APECompilerContext::IndexString(uint32_t &outIndex, const rkit::ByteString &str)
+	rkit::Result APECompilerContext::IndexString(uint32_t &outIndex, const rkit::ByteStringSliceView &str)
 	{
-		return APECompilerHelper::IndexValue<rkit::ByteString>(outIndex, m_strings, rkit::ByteString(str));
+		rkit::ByteString bstr;
+		RKIT_CHECK(bstr.Set(str));
+
+		return APECompilerHelper::IndexValue<rkit::ByteString>(outIndex, m_strings, std::move(bstr));
 	}
 
 	rkit::Result APECompilerContext::IndexResource(uint32_t &outIndex, uint32_t compileNamespace, uint32_t compileNodeType, uint32_t resNamespace, uint32_t resType,
@@ -671,7 +817,19 @@ namespace anox::buildsystem
 
 		if (compileNamespace != anox::kAnoxNamespaceID || compileNodeType != anox::buildsystem::kRawFileNodeID)
 		{
-			RKIT_CHECK(m_feedback->AddNodeDependency(compileNamespace, compileNodeType, rkit::buildsystem::BuildFileLocation::kSourceDir, path.ToString()));
+			if (m_feedback)
+			{
+				RKIT_CHECK(m_feedback->AddNodeDependency(compileNamespace, compileNodeType, rkit::buildsystem::BuildFileLocation::kSourceDir, path.ToString()));
+			}
+			else
+			{
+				DeferredNodeDependency deferredDep;
+				deferredDep.m_nodeNamespace = compileNamespace;
+				deferredDep.m_nodeType = compileNodeType;
+				RKIT_CHECK(deferredDep.m_path.Set(path.ToString()));
+
+				RKIT_CHECK(m_deferredNodeDependencies.Append(std::move(deferredDep)));
+			}
 		}
 
 		uint32_t pathIndex = 0;
@@ -751,8 +909,8 @@ namespace anox::buildsystem
 		case ape_parse::ExpressionValue::Operator::Sub:
 		case ape_parse::ExpressionValue::Operator::Mul:
 		case ape_parse::ExpressionValue::Operator::Div:
-			RKIT_CHECK(ConvertOperand(leftIndex, leftOpType, leftIsString, *expr.m_left));
-			RKIT_CHECK(ConvertOperand(rightIndex, rightOpType, rightIsString, *expr.m_right));
+			RKIT_CHECK(ConvertOperand(leftIndex, leftOpType, leftIsString, m_parseTree.GetOperand(expr.m_left)));
+			RKIT_CHECK(ConvertOperand(rightIndex, rightOpType, rightIsString, m_parseTree.GetOperand(expr.m_right)));
 			if (leftIsString || rightIsString)
 				RKIT_THROW(rkit::ResultCode::kDataError);
 
@@ -760,8 +918,8 @@ namespace anox::buildsystem
 			break;
 		case ape_parse::ExpressionValue::Operator::Eq:
 		case ape_parse::ExpressionValue::Operator::Neq:
-			RKIT_CHECK(ConvertOperand(leftIndex, leftOpType, leftIsString, *expr.m_left));
-			RKIT_CHECK(ConvertOperand(rightIndex, rightOpType, rightIsString, *expr.m_right));
+			RKIT_CHECK(ConvertOperand(leftIndex, leftOpType, leftIsString, m_parseTree.GetOperand(expr.m_left)));
+			RKIT_CHECK(ConvertOperand(rightIndex, rightOpType, rightIsString, m_parseTree.GetOperand(expr.m_right)));
 			if (leftIsString && rightIsString)
 				op = (expr.m_operator == ape_parse::ExpressionValue::Operator::Eq) ? data::ape::Operator::StrEq : data::ape::Operator::StrNeq;
 			else
@@ -793,27 +951,27 @@ namespace anox::buildsystem
 
 	rkit::Result APECompilerContext::ConvertOperand(uint32_t &outIndex, data::ape::OperandType &outOperandType, bool &outIsString, const ape_parse::Operand &operand)
 	{
-		switch (operand.GetOperandType())
+		switch (operand.m_operandType)
 		{
 		case ape_parse::OperandType::Expression:
-			return ConvertExprValue(outIndex, outOperandType, outIsString, static_cast<const ape_parse::ExpressionOperand &>(operand).m_value);
+			return ConvertExprValue(outIndex, outOperandType, outIsString, m_parseTree.GetExpression(operand.m_expressionIndex));
 		case ape_parse::OperandType::FloatLiteral:
-			memcpy(&outIndex, &static_cast<const ape_parse::FloatOperand &>(operand).m_value, 4);
+			memcpy(&outIndex, &operand.m_floatValue, 4);
 			outIsString = false;
 			outOperandType = data::ape::OperandType::Literal;
 			break;
 		case ape_parse::OperandType::FloatVariable:
-			RKIT_CHECK(IndexString(outIndex, static_cast<const ape_parse::FloatVariableNameOperand &>(operand).m_value));
+			RKIT_CHECK(IndexString(outIndex, operand.m_stringValue));
 			outIsString = false;
 			outOperandType = data::ape::OperandType::Variable;
 			break;
 		case ape_parse::OperandType::StringLiteral:
-			RKIT_CHECK(IndexString(outIndex, static_cast<const ape_parse::StringOperand &>(operand).m_value));
+			RKIT_CHECK(IndexString(outIndex, operand.m_stringValue));
 			outIsString = true;
 			outOperandType = data::ape::OperandType::Literal;
 			break;
 		case ape_parse::OperandType::StringVariable:
-			RKIT_CHECK(IndexString(outIndex, static_cast<const ape_parse::StringVariableNameOperand &>(operand).m_value));
+			RKIT_CHECK(IndexString(outIndex, operand.m_stringValue));
 			outIsString = true;
 			outOperandType = data::ape::OperandType::Variable;
 			break;
@@ -975,7 +1133,155 @@ namespace anox::buildsystem
 		RKIT_RETURN_OK;
 	}
 
-	rkit::Result APECompilerContext::ConvertOptionalByteString(uint32_t &outDWord, const rkit::Optional<rkit::ByteString> &value)
+	rkit::Result APECompilerContext::Merge(const APECompilerContext &batchCtx, APEIndexRemap &outRemap)
+	{
+		{
+			rkit::Vector<const rkit::ByteString *> strings;
+			RKIT_CHECK(GetKeysInIndexOrder(strings, batchCtx.m_strings));
+			RKIT_CHECK(outRemap.m_strings.Reserve(strings.Count()));
+
+			for (const rkit::ByteString *str : strings)
+			{
+				uint32_t index = 0;
+				RKIT_CHECK(IndexString(index, *str));
+				RKIT_CHECK(outRemap.m_strings.Append(index));
+			}
+		}
+
+		{
+			rkit::Vector<const rkit::String *> tempStrings;
+			RKIT_CHECK(GetKeysInIndexOrder(tempStrings, batchCtx.m_tempStrings));
+			RKIT_CHECK(outRemap.m_tempStrings.Reserve(tempStrings.Count()));
+
+			for (const rkit::String *str : tempStrings)
+			{
+				uint32_t index = 0;
+				RKIT_CHECK(APECompilerHelper::IndexValue<rkit::String>(index, m_tempStrings, rkit::String(*str)));
+				RKIT_CHECK(outRemap.m_tempStrings.Append(index));
+			}
+		}
+
+		{
+			rkit::Vector<const rkit::CIPath *> materialNames;
+			RKIT_CHECK(GetKeysInIndexOrder(materialNames, batchCtx.m_materialNames));
+			RKIT_CHECK(outRemap.m_materialNames.Reserve(materialNames.Count()));
+
+			for (const rkit::CIPath *path : materialNames)
+			{
+				uint32_t index = 0;
+				RKIT_CHECK(APECompilerHelper::IndexValue<rkit::CIPath>(index, m_materialNames, rkit::CIPath(*path)));
+				RKIT_CHECK(outRemap.m_materialNames.Append(index));
+			}
+		}
+
+		{
+			// Wildcard indexes aren't referenced by anything, but the order still has to match
+			rkit::Vector<const rkit::String *> materialWildcards;
+			RKIT_CHECK(GetKeysInIndexOrder(materialWildcards, batchCtx.m_materialWildcards));
+
+			for (const rkit::String *str : materialWildcards)
+			{
+				uint32_t index = 0;
+				RKIT_CHECK(APECompilerHelper::IndexValue<rkit::String>(index, m_materialWildcards, rkit::String(*str)));
+			}
+		}
+
+		{
+			rkit::Vector<const APEResourceRefKey *> resourceRefs;
+			RKIT_CHECK(GetKeysInIndexOrder(resourceRefs, batchCtx.m_resourceRefs));
+			RKIT_CHECK(outRemap.m_resourceRefs.Reserve(resourceRefs.Count()));
+
+			for (const APEResourceRefKey *batchRefKey : resourceRefs)
+			{
+				APEResourceRefKey refKey = *batchRefKey;
+				RKIT_CHECK(APEIndexRemap::RemapIndex(refKey.m_pathTempStringIndex, outRemap.m_tempStrings));
+
+				uint32_t index = 0;
+				RKIT_CHECK(APECompilerHelper::IndexValue<APEResourceRefKey>(index, m_resourceRefs, std::move(refKey)));
+				RKIT_CHECK(outRemap.m_resourceRefs.Append(index));
+			}
+		}
+
+		{
+			// Subexpressions are always indexed before the expressions that use them,
+			// so they are remapped by the time that they are referenced.
+			rkit::Vector<const ExpressionKey *> exprs;
+			RKIT_CHECK(GetKeysInIndexOrder(exprs, batchCtx.m_expressions));
+			RKIT_CHECK(outRemap.m_expressions.Reserve(exprs.Count()));
+
+			for (const ExpressionKey *exprKey : exprs)
+			{
+				data::ape::Expression expr = exprKey->GetExpression();
+				RKIT_CHECK(outRemap.RemapExpression(expr));
+
+				uint32_t index = 0;
+				RKIT_CHECK(IndexExpression(index, std::move(expr)));
+				RKIT_CHECK(outRemap.m_expressions.Append(index));
+			}
+		}
+
+		{
+			rkit::Vector<const OperandListKey *> operandLists;
+			RKIT_CHECK(GetKeysInIndexOrder(operandLists, batchCtx.m_operandLists));
+			RKIT_CHECK(outRemap.m_operandLists.Reserve(operandLists.Count()));
+
+			for (const OperandListKey *opsKey : operandLists)
+			{
+				const rkit::ConstSpan<data::ape::ExpressionValue> batchOperands = opsKey->GetOperands();
+
+				rkit::Vector<data::ape::ExpressionValue> operands;
+				RKIT_CHECK(operands.Resize(batchOperands.Count()));
+
+				rkit::CopySpan(operands.ToSpan(), batchOperands);
+
+				for (data::ape::ExpressionValue &operand : operands)
+				{
+					RKIT_CHECK(outRemap.RemapOperand(operand));
+				}
+
+				uint32_t index = 0;
+				RKIT_CHECK(IndexOperandList(index, std::move(operands)));
+				RKIT_CHECK(outRemap.m_operandLists.Append(index));
+			}
+		}
+
+		for (const DeferredNodeDependency &deferredDep : batchCtx.m_deferredNodeDependencies)
+		{
+			if (m_feedback)
+			{
+				RKIT_CHECK(m_feedback->AddNodeDependency(deferredDep.m_nodeNamespace, deferredDep.m_nodeType, rkit::buildsystem::BuildFileLocation::kSourceDir, deferredDep.m_path.ToString()));
+			}
+			else
+			{
+				DeferredNodeDependency dep;
+				dep.m_nodeNamespace = deferredDep.m_nodeNamespace;
+				dep.m_nodeType = deferredDep.m_nodeType;
+				RKIT_CHECK(dep.m_path.Set(deferredDep.m_path.ToString()));
+
+				RKIT_CHECK(m_deferredNodeDependencies.Append(std::move(dep)));
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	const ape_parse::ParseTree &APECompilerContext::GetParseTree() const
+	{
+		return m_parseTree;
+	}
+
+	template<class TKey>
+	rkit::Result APECompilerContext::GetKeysInIndexOrder(rkit::Vector<const TKey *> &outKeys, const rkit::HashMap<TKey, uint32_t> &hashMap)
+	{
+		RKIT_CHECK(outKeys.Resize(hashMap.Count()));
+
+		for (rkit::HashMapKeyValueView<TKey, const uint32_t> pair : hashMap)
+			outKeys[pair.Value()] = &pair.Key();
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APECompilerContext::ConvertOptionalByteString(uint32_t &outDWord, const rkit::Optional<rkit::ByteStringView> &value)
 	{
 		if (!value.IsSet())
 			outDWord = 0;
@@ -989,7 +1295,7 @@ namespace anox::buildsystem
 		RKIT_RETURN_OK;
 	}
 
-	rkit::Result APECompilerContext::ConvertByteString(uint32_t &outDWord, const rkit::ByteString &value)
+	rkit::Result APECompilerContext::ConvertByteString(uint32_t &outDWord, const rkit::ByteStringSliceView &value)
 	{
 		return IndexString(outDWord, value);
 	}
@@ -1003,30 +1309,30 @@ namespace anox::buildsystem
 
 		rkit::Vector<data::ape::ExpressionValue> operands;
 
-		for (const rkit::UniquePtr<ape_parse::Operand> &inOperandPtr : value.m_operands)
+		for (uint32_t operandIndex : value.m_operands)
 		{
-			const ape_parse::Operand &inOperand = *inOperandPtr;
+			const ape_parse::Operand &inOperand = m_parseTree.GetOperand(operandIndex);
 
 			data::ape::ExprType exprType = data::ape::ExprType::Empty;
 			uint32_t index = 0;
 			data::ape::ExpressionValue outExpr;
-			switch (inOperand.GetOperandType())
+			switch (inOperand.m_operandType)
 			{
 			case ape_parse::OperandType::FloatLiteral:
 				exprType = data::ape::ExprType::FloatLiteral;
-				memcpy(&index, &static_cast<const ape_parse::FloatOperand &>(inOperand).m_value, 4);
+				memcpy(&index, &inOperand.m_floatValue, 4);
 				break;
 			case ape_parse::OperandType::FloatVariable:
 				exprType = data::ape::ExprType::FloatVariable;
-				RKIT_CHECK(ConvertByteString(index, static_cast<const ape_parse::FloatVariableNameOperand &>(inOperand).m_value));
+				RKIT_CHECK(ConvertByteString(index, inOperand.m_stringValue));
 				break;
 			case ape_parse::OperandType::StringLiteral:
 				exprType = data::ape::ExprType::StringLiteral;
-				RKIT_CHECK(ConvertByteString(index, static_cast<const ape_parse::StringOperand &>(inOperand).m_value));
+				RKIT_CHECK(ConvertByteString(index, inOperand.m_stringValue));
 				break;
 			case ape_parse::OperandType::StringVariable:
 				exprType = data::ape::ExprType::StringVariable;
-				RKIT_CHECK(ConvertByteString(index, static_cast<const ape_parse::StringVariableNameOperand &>(inOperand).m_value));
+				RKIT_CHECK(ConvertByteString(index, inOperand.m_stringValue));
 				break;
 			default:
 				RKIT_THROW(rkit::ResultCode::kInternalError);
@@ -1066,6 +1372,150 @@ namespace anox::buildsystem
 		RKIT_RETURN_OK;
 	}
 
+	rkit::Result APEIndexRemap::RemapOptionalString(rkit::endian::LittleUInt32_t &index) const
+	{
+		const uint32_t biasedIndex = index.Get();
+		if (biasedIndex == 0)
+			RKIT_RETURN_OK;
+
+		uint32_t strIndex = biasedIndex - 1;
+		RKIT_CHECK(RemapIndex(strIndex, m_strings));
+
+		uint32_t remappedBiasedIndex = 0;
+		RKIT_CHECK(rkit::SafeAdd<uint32_t>(remappedBiasedIndex, strIndex, 1));
+
+		index = remappedBiasedIndex;
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEIndexRemap::RemapExpression(data::ape::Expression &expr) const
+	{
+		data::ape::Operator op = data::ape::Operator::Invalid;
+		data::ape::OperandType leftOpType = data::ape::OperandType::Invalid;
+		data::ape::OperandType rightOpType = data::ape::OperandType::Invalid;
+
+		data::ape::Expression::UnpackOperandInfo(expr.m_packedOperandInfo, op, leftOpType, rightOpType);
+
+		const bool literalsAreStrings = (op == data::ape::Operator::StrEq || op == data::ape::Operator::StrNeq);
+
+		const data::ape::OperandType opTypes[2] = { leftOpType, rightOpType };
+		rkit::endian::LittleUInt32_t *values[2] = { &expr.m_leftValue, &expr.m_rightValue };
+
+		for (size_t i = 0; i < 2; i++)
+		{
+			switch (opTypes[i])
+			{
+			case data::ape::OperandType::Expression:
+				RKIT_CHECK(RemapIndex(*values[i], m_expressions));
+				break;
+			case data::ape::OperandType::Literal:
+				if (literalsAreStrings)
+				{
+					RKIT_CHECK(RemapIndex(*values[i], m_strings));
+				}
+				break;
+			case data::ape::OperandType::Variable:
+				RKIT_CHECK(RemapIndex(*values[i], m_strings));
+				break;
+			default:
+				RKIT_THROW(rkit::ResultCode::kInternalError);
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEIndexRemap::RemapExprValue(data::ape::ExpressionValue &value) const
+	{
+		switch (value.m_exprType)
+		{
+		case data::ape::ExprType::Empty:
+		case data::ape::ExprType::FloatLiteral:
+			break;
+		case data::ape::ExprType::FloatExpression:
+			RKIT_CHECK(RemapIndex(value.m_index, m_expressions));
+			break;
+		case data::ape::ExprType::StringLiteral:
+		case data::ape::ExprType::FloatVariable:
+		case data::ape::ExprType::StringVariable:
+			RKIT_CHECK(RemapIndex(value.m_index, m_strings));
+			break;
+		default:
+			RKIT_THROW(rkit::ResultCode::kInternalError);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEIndexRemap::RemapOperand(data::ape::ExpressionValue &value) const
+	{
+		// Operand lists never reference expressions, FloatExpression operands in extern
+		// arg lists are variable names.
+		switch (value.m_exprType)
+		{
+		case data::ape::ExprType::Empty:
+		case data::ape::ExprType::FloatLiteral:
+		case data::ape::ExprType::UIntLiteral:
+		case data::ape::ExprType::IntLiteral:
+			break;
+		case data::ape::ExprType::FloatExpression:
+		case data::ape::ExprType::StringLiteral:
+		case data::ape::ExprType::FloatVariable:
+		case data::ape::ExprType::StringVariable:
+		case data::ape::ExprType::ObjectVariable:
+		case data::ape::ExprType::TextureVariable:
+			RKIT_CHECK(RemapIndex(value.m_index, m_strings));
+			break;
+		case data::ape::ExprType::ContentID:
+			RKIT_CHECK(RemapIndex(value.m_index, m_resourceRefs));
+			break;
+		default:
+			RKIT_THROW(rkit::ResultCode::kInternalError);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEIndexRemap::RemapMaterialReference(data::ape::MaterialReference &matRef) const
+	{
+		switch (matRef.m_refType)
+		{
+		case data::ape::MaterialReferenceType::Null:
+			break;
+		case data::ape::MaterialReferenceType::WildcardString:
+			RKIT_CHECK(RemapIndex(matRef.m_index, m_strings));
+			break;
+		case data::ape::MaterialReferenceType::ContentID:
+			RKIT_CHECK(RemapIndex(matRef.m_index, m_materialNames));
+			break;
+		default:
+			RKIT_THROW(rkit::ResultCode::kInternalError);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEIndexRemap::RemapIndex(uint32_t &index, const rkit::Vector<uint32_t> &indexMap)
+	{
+		if (index >= indexMap.Count())
+			RKIT_THROW(rkit::ResultCode::kInternalError);
+
+		index = indexMap[index];
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEIndexRemap::RemapIndex(rkit::endian::LittleUInt32_t &index, const rkit::Vector<uint32_t> &indexMap)
+	{
+		uint32_t remappedIndex = index.Get();
+		RKIT_CHECK(RemapIndex(remappedIndex, indexMap));
+
+		index = remappedIndex;
+
+		RKIT_RETURN_OK;
+	}
+
 	APECompilerContext::OperandListKey::OperandListKey(rkit::Vector<data::ape::ExpressionValue> &&operands)
 		: m_operands(std::move(operands))
 	{
@@ -1300,19 +1750,188 @@ namespace anox::buildsystem
 		RKIT_RETURN_OK;
 	}
 
+	APEScriptCompilerImpl::CompileBatchJobRunner::CompileBatchJobRunner(CompileBatch &batch, APEBlob &blob, const rkit::Vector<WindowDef> &windowDefs, const rkit::Vector<SwitchDef> &switchDefs)
+		: m_batch(batch)
+		, m_blob(blob)
+		, m_windowDefs(windowDefs)
+		, m_switchDefs(switchDefs)
+	{
+	}
+
+	rkit::Result APEScriptCompilerImpl::CompileBatchJobRunner::Run()
+	{
+		return CompileItems(*m_batch.m_ctx, m_blob, m_windowDefs, m_switchDefs, m_batch.m_firstItem, m_batch.m_numItems);
+	}
+
+	rkit::Result APEScriptCompilerImpl::CompileAll(rkit::buildsystem::IBuildSystemInstance &instance, size_t minItemsPerBatch, APECompilerContext &ctx, APEBlob &blob, const rkit::Vector<WindowDef> &windowDefs, const rkit::Vector<SwitchDef> &switchDefs)
+	{
+		RKIT_CHECK(blob.m_windows.Resize(windowDefs.Count()));
+		RKIT_CHECK(blob.m_switches.Resize(switchDefs.Count()));
+
+		const size_t numItems = windowDefs.Count() + switchDefs.Count();
+		const size_t numBatches = instance.ComputeNumBatches(numItems, minItemsPerBatch);
+
+		if (numBatches <= 1)
+			return CompileItems(ctx, blob, windowDefs, switchDefs, 0, numItems);
+
+		// Each batch is compiled into its own context, then the batches are merged in order
+		// so that the output is identical to compiling everything into one context.
+		rkit::Vector<CompileBatch> batches;
+		RKIT_CHECK(batches.Resize(numBatches));
+
+		for (size_t batchIndex = 0; batchIndex < numBatches; batchIndex++)
+		{
+			CompileBatch &batch = batches[batchIndex];
+			batch.m_firstItem = numItems * batchIndex / numBatches;
+			batch.m_numItems = numItems * (batchIndex + 1) / numBatches - batch.m_firstItem;
+
+			RKIT_CHECK(rkit::New<APECompilerContext>(batch.m_ctx, ctx.GetParseTree(), nullptr));
+		}
+
+		{
+			rkit::Vector<rkit::UniquePtr<rkit::IJobRunner>> batchRunners;
+
+			for (CompileBatch &batch : batches)
+			{
+				rkit::UniquePtr<rkit::IJobRunner> jobRunner;
+				RKIT_CHECK(rkit::New<CompileBatchJobRunner>(jobRunner, batch, blob, windowDefs, switchDefs));
+
+				RKIT_CHECK(batchRunners.Append(std::move(jobRunner)));
+			}
+
+			RKIT_CHECK(instance.RunBatchJobs(std::move(batchRunners)));
+		}
+
+		for (const CompileBatch &batch : batches)
+		{
+			APEIndexRemap remap;
+			RKIT_CHECK(ctx.Merge(*batch.m_ctx, remap));
+
+			for (size_t itemIndex = batch.m_firstItem; itemIndex < batch.m_firstItem + batch.m_numItems; itemIndex++)
+			{
+				if (itemIndex < windowDefs.Count())
+				{
+					RKIT_CHECK(RemapWindow(blob.m_windows[itemIndex], remap));
+				}
+				else
+				{
+					RKIT_CHECK(RemapSwitch(blob.m_switches[itemIndex - windowDefs.Count()], remap));
+				}
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEScriptCompilerImpl::CompileItems(APECompilerContext &ctx, APEBlob &blob, const rkit::Vector<WindowDef> &windowDefs, const rkit::Vector<SwitchDef> &switchDefs, size_t firstItem, size_t numItems)
+	{
+		for (size_t itemIndex = firstItem; itemIndex < firstItem + numItems; itemIndex++)
+		{
+			if (itemIndex < windowDefs.Count())
+			{
+				RKIT_CHECK(CompileWindow(ctx, blob.m_windows[itemIndex], windowDefs[itemIndex]));
+			}
+			else
+			{
+				const size_t switchIndex = itemIndex - windowDefs.Count();
+				RKIT_CHECK(CompileSwitch(ctx, blob.m_switches[switchIndex], switchDefs[switchIndex]));
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEScriptCompilerImpl::RemapWindow(CompiledWindowDef &compiledWindow, const APEIndexRemap &remap)
+	{
+		for (const APEIndexFixup &fixup : compiledWindow.m_indexFixups)
+		{
+			switch (fixup.m_fixupType)
+			{
+			case APEIndexFixupType::String:
+				RKIT_CHECK(RemapCommandStreamValue<rkit::endian::LittleUInt32_t>(compiledWindow.m_commandStream, fixup.m_offset,
+					[&remap](rkit::endian::LittleUInt32_t &index) { return APEIndexRemap::RemapIndex(index, remap.m_strings); }));
+				break;
+			case APEIndexFixupType::OptionalString:
+				RKIT_CHECK(RemapCommandStreamValue<rkit::endian::LittleUInt32_t>(compiledWindow.m_commandStream, fixup.m_offset,
+					[&remap](rkit::endian::LittleUInt32_t &index) { return remap.RemapOptionalString(index); }));
+				break;
+			case APEIndexFixupType::OperandList:
+				RKIT_CHECK(RemapCommandStreamValue<rkit::endian::LittleUInt32_t>(compiledWindow.m_commandStream, fixup.m_offset,
+					[&remap](rkit::endian::LittleUInt32_t &index) { return APEIndexRemap::RemapIndex(index, remap.m_operandLists); }));
+				break;
+			case APEIndexFixupType::ExpressionValue:
+				RKIT_CHECK(RemapCommandStreamValue<data::ape::ExpressionValue>(compiledWindow.m_commandStream, fixup.m_offset,
+					[&remap](data::ape::ExpressionValue &value) { return remap.RemapExprValue(value); }));
+				break;
+			case APEIndexFixupType::MaterialReference:
+				RKIT_CHECK(RemapCommandStreamValue<data::ape::MaterialReference>(compiledWindow.m_commandStream, fixup.m_offset,
+					[&remap](data::ape::MaterialReference &matRef) { return remap.RemapMaterialReference(matRef); }));
+				break;
+			default:
+				RKIT_THROW(rkit::ResultCode::kInternalError);
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEScriptCompilerImpl::RemapSwitch(CompiledSwitchDef &compiledSwitch, const APEIndexRemap &remap)
+	{
+		for (data::ape::SwitchCommand &cmd : compiledSwitch.m_commands)
+		{
+			// Jumps are generated by CompileBasicBlock and don't have any indexes
+			if (cmd.m_opcode == kJumpOpcode || cmd.m_opcode == kRJumpOpcode)
+				continue;
+
+			if (cmd.m_opcode == kExternOpcode)
+			{
+				RKIT_CHECK(APEIndexRemap::RemapIndex(cmd.m_strValue, remap.m_operandLists));
+			}
+			else
+			{
+				if (cmd.m_opcode != kIfOpcode && cmd.m_opcode != kWhileOpcode)
+				{
+					RKIT_CHECK(remap.RemapOptionalString(cmd.m_strValue));
+				}
+
+				RKIT_CHECK(APEIndexRemap::RemapIndex(cmd.m_fmtValue, remap.m_operandLists));
+			}
+
+			RKIT_CHECK(remap.RemapExprValue(cmd.m_exprValue));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	template<class T, class TFunc>
+	rkit::Result APEScriptCompilerImpl::RemapCommandStreamValue(rkit::Vector<uint8_t> &commandStream, size_t offset, const TFunc &remapFunc)
+	{
+		if (offset > commandStream.Count() || commandStream.Count() - offset < sizeof(T))
+			RKIT_THROW(rkit::ResultCode::kInternalError);
+
+		T value;
+		memcpy(&value, commandStream.GetBuffer() + offset, sizeof(T));
+
+		RKIT_CHECK(remapFunc(value));
+
+		memcpy(commandStream.GetBuffer() + offset, &value, sizeof(T));
+
+		RKIT_RETURN_OK;
+	}
+
 	rkit::Result APEScriptCompilerImpl::CompileWindow(APECompilerContext &ctx, CompiledWindowDef &compiledWindow, const WindowDef &wdef)
 	{
 		compiledWindow.m_windowID = wdef.m_windowID;
 
 		VectorMemoryStream stream(compiledWindow.m_commandStream);
 
-		APEWriter writer(ctx, stream);
+		APEWriter writer(ctx, stream, compiledWindow.m_indexFixups);
 
 		for (const rkit::UniquePtr<ape_parse::WindowCommand> &cmdPtr : wdef.m_commands)
 		{
 			const ape_parse::WindowCommand &cmd = *cmdPtr;
 
-			RKIT_CHECK(compiledWindow.m_commandStream.Append(static_cast<uint8_t>(cmd.GetCommandType())));
+			RKIT_CHECK(writer.Write(static_cast<uint8_t>(cmd.GetCommandType())));
 			RKIT_CHECK(cmd.Write(writer));
 		}
 
@@ -1335,12 +1954,6 @@ namespace anox::buildsystem
 
 	rkit::Result APEScriptCompilerImpl::CompileBasicBlock(APECompilerContext &ctx, rkit::Vector<data::ape::SwitchCommand> &cmdStream, const rkit::HashMap<uint64_t, const ape_parse::SwitchCommand *> &tree, uint64_t cc)
 	{
-		const uint8_t kIfOpcode = 1;
-		const uint8_t kExternOpcode = 10;
-		const uint8_t kWhileOpcode = 11;
-		const uint8_t kJumpOpcode = 22;
-		const uint8_t kRJumpOpcode = 23;
-
 		for (;;)
 		{
 			rkit::HashMap<uint64_t, const ape_parse::SwitchCommand *>::ConstIterator_t it = tree.Find(cc);
@@ -2752,6 +3365,11 @@ namespace anox::buildsystem
 		return true;
 	}
 
+	bool APEScriptCompiler::CanRunAnalysisConcurrently() const
+	{
+		return true;
+	}
+
 	rkit::Result APEScriptCompiler::RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
 		return Impl().RunAnalysis(depsNode, feedback);
@@ -2777,6 +3395,43 @@ namespace anox::buildsystem
 		return rkit::New<APEScriptCompiler>(outCompiler);
 	}
 
+	rkit::Result APEScriptCompiler::ParseOnly(const rkit::ConstSpan<uint8_t> &fileContents, size_t &outNumCommands)
+	{
+		ape_parse::ParseTree parseTree;
+		rkit::Vector<APEScriptCompilerImpl::WindowDef> windowDefs;
+		rkit::Vector<APEScriptCompilerImpl::SwitchDef> switchDefs;
+
+		RKIT_CHECK(APEScriptCompilerImpl::ParseAPEFile(fileContents, parseTree, windowDefs, switchDefs));
+
+		size_t numCommands = 0;
+		for (const APEScriptCompilerImpl::WindowDef &windowDef : windowDefs)
+			numCommands += windowDef.m_commands.Count();
+		for (const APEScriptCompilerImpl::SwitchDef &switchDef : switchDefs)
+			numCommands += switchDef.m_commands.Count();
+
+		outNumCommands = numCommands;
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result APEScriptCompiler::CompileOnly(rkit::buildsystem::IBuildSystemInstance &instance, const rkit::ConstSpan<uint8_t> &fileContents, size_t minItemsPerBatch)
+	{
+		ape_parse::ParseTree parseTree;
+		rkit::Vector<APEScriptCompilerImpl::WindowDef> windowDefs;
+		rkit::Vector<APEScriptCompilerImpl::SwitchDef> switchDefs;
+
+		RKIT_CHECK(APEScriptCompilerImpl::ParseAPEFile(fileContents, parseTree, windowDefs, switchDefs));
+
+		APECompilerContext compilerCtx(parseTree, nullptr);
+
+		APEScriptCompilerImpl::APEBlob blob;
+		RKIT_CHECK(APEScriptCompilerImpl::CompileAll(instance, minItemsPerBatch, compilerCtx, blob, windowDefs, switchDefs));
+
+		RKIT_CHECK(compilerCtx.DumpResults(blob.m_operandLists, blob.m_exprs, blob.m_strings, blob.m_materialWildcards, blob.m_materialNames, blob.m_resourceRefs, blob.m_intermediateResourceRefs, blob.m_tempStrings));
+
+		RKIT_RETURN_OK;
+	}
+
 	rkit::Result APEGroupCompilerImpl::RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
 		rkit::CIPath depsFilePath;
@@ -2874,6 +3529,11 @@ namespace anox::buildsystem
 		return true;
 	}
 
+	bool APEGroupCompiler::CanRunAnalysisConcurrently() const
+	{
+		return true;
+	}
+
 	rkit::Result APEGroupCompiler::RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
 		return Impl().RunAnalysis(depsNode, feedback);
@@ -2899,6 +3559,11 @@ namespace anox::buildsystem
 		return true;
 	}
 
+	bool APEDepsCompiler::CanRunAnalysisConcurrently() const
+	{
+		return true;
+	}
+
 	rkit::Result APEDepsCompiler::RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
 		return Impl().RunAnalysis(depsNode, feedback);
@@ -3,6 +3,7 @@
 #include "rkit/BuildSystem/DependencyGraph.h"
 #include "rkit/Core/PathProto.h"
 #include "rkit/Core/Opaque.h"
+#include "rkit/Core/SpanProtos.h"
 
 namespace anox::buildsystem
 {
@@ -14,6 +15,7 @@ namespace anox::buildsystem
 	{
 	public:
 		bool HasAnalysisStage() const override;
+		bool CanRunAnalysisConcurrently() const override;
 		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 
@@ -28,6 +30,7 @@ namespace anox::buildsystem
 	{
 	public:
 		bool HasAnalysisStage() const override;
+		bool CanRunAnalysisConcurrently() const override;
 		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 
@@ -36,12 +39,19 @@ namespace anox::buildsystem
 		static rkit::Result FormatOutputPath(rkit::CIPath &outPath, const rkit::StringView &identifier);
 
 		static rkit::Result Create(rkit::UniquePtr<APEScriptCompiler> &outCompiler);
+
+		// Parses an APE file without compiling it
+		static rkit::Result ParseOnly(const rkit::ConstSpan<uint8_t> &fileContents, size_t &outNumCommands);
+
+		// Parses and compiles an APE file without writing it, in batches of at least minItemsPerBatch windows and switches
+		static rkit::Result CompileOnly(rkit::buildsystem::IBuildSystemInstance &instance, const rkit::ConstSpan<uint8_t> &fileContents, size_t minItemsPerBatch);
 	};
 
 	class APEGroupCompiler final : public rkit::buildsystem::IDependencyNodeCompiler, public rkit::Opaque<APEGroupCompilerImpl>
 	{
 	public:
 		bool HasAnalysisStage() const override;
+		bool CanRunAnalysisConcurrently() const override;
 		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 
@@ -20,6 +20,8 @@
 
 #include "rkit/Math/SoftFloat.h"
 
+#include "rkit/Utilities/ImageKernels.h"
+
 #include "anox/Build/NodeIDs.h"
 
 #include "anox/CoreUtils/CoreUtils.h"
@@ -412,6 +414,7 @@ namespace anox { namespace buildsystem
 	{
 	public:
 		bool HasAnalysisStage() const override;
+		bool CanRunAnalysisConcurrently() const override;
 
 		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
@@ -436,6 +439,7 @@ namespace anox { namespace buildsystem
 	{
 	public:
 		bool HasAnalysisStage() const override;
+		bool CanRunAnalysisConcurrently() const override;
 
 		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
@@ -447,6 +451,7 @@ namespace anox { namespace buildsystem
 	{
 	public:
 		bool HasAnalysisStage() const override;
+		bool CanRunAnalysisConcurrently() const override;
 
 		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
@@ -545,6 +550,11 @@ namespace anox { namespace buildsystem
 		return true;
 	}
 
+	bool BSPMapCompiler::CanRunAnalysisConcurrently() const
+	{
+		return true;
+	}
+
 	rkit::Result BSPMapCompiler::RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
 		BSPDataCollection bsp;
@@ -684,6 +694,11 @@ namespace anox { namespace buildsystem
 		return true;
 	}
 
+	bool BSPGeometryCompiler::CanRunAnalysisConcurrently() const
+	{
+		return true;
+	}
+
 	rkit::Result BSPGeometryCompiler::RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
 		RKIT_CHECK(feedback->AddNodeDependency(kAnoxNamespaceID, buildsystem::kBSPLightmapNodeID, rkit::buildsystem::BuildFileLocation::kSourceDir, depsNode->GetIdentifier()));
@@ -1193,6 +1208,11 @@ namespace anox { namespace buildsystem
 		return true;
 	}
 
+	bool BSPEntityCompiler::CanRunAnalysisConcurrently() const
+	{
+		return true;
+	}
+
 	rkit::Result BSPEntityCompiler::RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
 		bool haveScripts = false;
@@ -1205,7 +1225,7 @@ namespace anox { namespace buildsystem
 			RKIT_CHECK(feedback->AddNodeDependency(kAnoxNamespaceID, kAPEScriptNodeID, rkit::buildsystem::BuildFileLocation::kSourceDir, scriptsPathStr));
 		}
 
-		rkit::UniquePtr<UserEntityDictionaryBase> dictionary;
+		const UserEntityDictionaryBase *dictionary = nullptr;
 		RKIT_CHECK(EntityDefCompilerBase::LoadUserEntityDictionary(dictionary, feedback));
 
 		BSPDataCollection bsp;
@@ -1242,7 +1262,7 @@ namespace anox { namespace buildsystem
 		}
 
 
-		rkit::UniquePtr<UserEntityDictionaryBase> dictionary;
+		const UserEntityDictionaryBase *dictionary = nullptr;
 		RKIT_CHECK(EntityDefCompilerBase::LoadUserEntityDictionary(dictionary, feedback));
 
 		BSPDataCollection bsp;
@@ -3559,6 +3579,8 @@ namespace anox { namespace buildsystem
 			for (size_t px = 0; px < atlasNumPixels; px++)
 				atlasBytes[px * 4 + 1] = 0;
 
+			const rkit::utils::IImageKernels *imageKernels = rkit::GetDrivers().m_utilitiesDriver->GetImageKernels();
+
 			// Fill it up
 			for (const priv::LightmapTreeNode &treeNode : lightmapTree.m_nodes)
 			{
@@ -3622,6 +3644,13 @@ namespace anox { namespace buildsystem
 						for (size_t inStyleIndex = 0; inStyleIndex < numLightmapsWithThisStyle; inStyleIndex++)
 							inScanlines[inStyleIndex] = inStyleLightmaps[inStyleIndex].SubSpan(lmy * inLightmapWidth * 3, static_cast<size_t>(inLightmapWidth) * 3);
 
+						// A single lightmap can't exceed 255, so it's a straight RGB to RGBA expansion
+						if (numLightmapsWithThisStyle == 1)
+						{
+							imageKernels->ExpandRGB8ToRGBA8(outScanline, inScanlines[0], rkit::utils::RGBChannelOrder::kRGB);
+							continue;
+						}
+
 						for (size_t lmx = 0; lmx < inLightmapWidth; lmx++)
 						{
 							const rkit::Span<uint8_t> outTexel = outScanline.SubSpan(lmx * 4, 4);
@@ -24,9 +24,11 @@
 
 namespace anox
 {
-	class BuildDriver final : public rkit::buildsystem::IBuildSystemAddOnDriver
+	class BuildDriver final : public IBuildDriver
 	{
 	public:
+		rkit::Result ParseAPEScript(const rkit::ConstSpan<uint8_t> &fileContents, size_t &outNumCommands) const override;
+		rkit::Result CompileAPEScript(rkit::buildsystem::IBuildSystemInstance &instance, const rkit::ConstSpan<uint8_t> &fileContents, size_t minItemsPerBatch) const override;
 
 	private:
 		rkit::Result InitDriver(const rkit::DriverInitParameters *) override;
@@ -206,4 +208,14 @@ rkit::Result anox::BuildDriver::RegisterBuildSystemAddOn(rkit::buildsystem::IBui
 }
 
 
+rkit::Result anox::BuildDriver::ParseAPEScript(const rkit::ConstSpan<uint8_t> &fileContents, size_t &outNumCommands) const
+{
+	return buildsystem::APEScriptCompiler::ParseOnly(fileContents, outNumCommands);
+}
+
+rkit::Result anox::BuildDriver::CompileAPEScript(rkit::buildsystem::IBuildSystemInstance &instance, const rkit::ConstSpan<uint8_t> &fileContents, size_t minItemsPerBatch) const
+{
+	return buildsystem::APEScriptCompiler::CompileOnly(instance, fileContents, minItemsPerBatch);
+}
+
 RKIT_IMPLEMENT_MODULE(Anox, Build, ::anox::BuildModule)
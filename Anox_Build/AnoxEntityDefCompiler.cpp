@@ -15,6 +15,8 @@
 
 #include "AnoxModelCompiler.h"
 
+#include <string.h>
+
 
 namespace anox { namespace buildsystem {
 	struct UserEntityDef2
@@ -37,10 +39,38 @@ namespace anox { namespace buildsystem {
 		rkit::ByteString m_description;
 	};
 
+	// Compiled dictionary image layout, held in memory by the memoized input and never written out:
+	// UserEntityDictionaryHeader
+	// UserEntityDictionaryEntry[m_numEDefs], sorted by class name
+	// uint8_t[m_stringPoolSize], null-terminated strings
+	struct UserEntityDictionaryHeader
+	{
+		rkit::endian::LittleUInt32_t m_numEDefs;
+		rkit::endian::LittleUInt32_t m_stringPoolSize;
+	};
+
+	struct UserEntityDictionaryString
+	{
+		rkit::endian::LittleUInt32_t m_offset;
+		rkit::endian::LittleUInt32_t m_length;
+	};
+
+	struct UserEntityDictionaryEntry
+	{
+		UserEntityDictionaryString m_className;
+		UserEntityDictionaryString m_modelPath;
+		UserEntityDictionaryString m_type;
+		UserEntityDictionaryString m_description;
+
+		// Model content ID and entity type are resolved by the edef compiler
+		data::UserEntityDef m_def;
+	};
+
 	class UserEntityDictionary final : public UserEntityDictionaryBase
 	{
 	public:
-		explicit UserEntityDictionary(rkit::Vector<UserEntityDef2> &&edefs);
+		explicit UserEntityDictionary(rkit::Vector<uint8_t> &&image);
+
 		bool FindEntityDef(const rkit::ByteStringSliceView &name, uint32_t &outEDefID) const override;
 
 		rkit::ByteStringView GetEDefType(uint32_t edefID) const override;
@@ -48,10 +78,19 @@ namespace anox { namespace buildsystem {
 
 		rkit::Result WriteEDef(rkit::IWriteStream &stream, uint32_t edefID) const override;
 
-		const UserEntityDef2 &GetEDef(uint32_t edefID) const;
+		const UserEntityDictionaryEntry &GetEntry(uint32_t edefID) const;
+		rkit::ByteStringView GetString(const UserEntityDictionaryString &str) const;
+
+		static rkit::Result CompileImage(rkit::Vector<UserEntityDef2> &edefs, rkit::Vector<uint8_t> &outImage);
 
 	private:
-		rkit::Vector<UserEntityDef2> m_defs;
+		static rkit::Result AddPooledString(rkit::Vector<uint8_t> &stringPool, UserEntityDictionaryString &outString, const rkit::ConstSpan<uint8_t> &chars);
+
+		rkit::Vector<uint8_t> m_image;
+
+		const UserEntityDictionaryHeader *m_header = nullptr;
+		const UserEntityDictionaryEntry *m_entries = nullptr;
+		const uint8_t *m_stringPool = nullptr;
 	};
 
 
@@ -67,29 +106,36 @@ namespace anox { namespace buildsystem {
 
 		static rkit::Result ParseLabel(const rkit::ConstSpan<uint8_t> &span, Label &outLabel);
 
+		static rkit::Result ParseUserEntityDictionary(rkit::ISeekableReadStream &stream, rkit::UniquePtr<rkit::buildsystem::IMemoizedInput> &outParsedInput);
+
 	private:
 		static rkit::Result IndexString(rkit::Vector<rkit::AsciiString> &strings, rkit::HashMap<rkit::AsciiString, uint16_t> &stringToIndex, const rkit::AsciiString &str, uint16_t &outIndex);
 	};
 
-	UserEntityDictionary::UserEntityDictionary(rkit::Vector<UserEntityDef2> &&edefs)
-		: m_defs(std::move(edefs))
+	UserEntityDictionary::UserEntityDictionary(rkit::Vector<uint8_t> &&image)
+		: m_image(std::move(image))
 	{
-		rkit::QuickSort(m_defs.begin(), m_defs.end(), [](const UserEntityDef2 &a, const UserEntityDef2 &b)
-			{
-				return a.m_className.ToByteView() < b.m_className.ToByteView();
-			});
+		const uint8_t *imageBytes = m_image.GetBuffer();
+
+		m_header = reinterpret_cast<const UserEntityDictionaryHeader *>(imageBytes);
+		imageBytes += sizeof(UserEntityDictionaryHeader);
+
+		m_entries = reinterpret_cast<const UserEntityDictionaryEntry *>(imageBytes);
+		imageBytes += sizeof(UserEntityDictionaryEntry) * m_header->m_numEDefs.Get();
+
+		m_stringPool = imageBytes;
 	}
 
 	bool UserEntityDictionary::FindEntityDef(const rkit::ByteStringSliceView &name, uint32_t &outEDefID) const
 	{
 		size_t minInclusive = 0;
-		size_t maxExclusive = m_defs.Count();
+		size_t maxExclusive = m_header->m_numEDefs.Get();
 
 		while (minInclusive != maxExclusive)
 		{
 			const size_t testIndex = (minInclusive + maxExclusive) / 2;
 
-			std::strong_ordering ordering = m_defs[testIndex].m_className.ToByteView().CompareOrdered(name);
+			std::strong_ordering ordering = GetString(m_entries[testIndex].m_className).CompareOrdered(name);
 			if (ordering == std::strong_ordering::equal)
 			{
 				outEDefID = static_cast<uint32_t>(testIndex);
@@ -110,12 +156,12 @@ namespace anox { namespace buildsystem {
 
 	rkit::ByteStringView UserEntityDictionary::GetEDefType(uint32_t edefID) const
 	{
-		return m_defs[edefID].m_type;
+		return GetString(m_entries[edefID].m_type);
 	}
 
 	uint32_t UserEntityDictionary::GetEDefCount() const
 	{
-		return static_cast<uint32_t>(m_defs.Count());
+		return m_header->m_numEDefs.Get();
 	}
 
 	rkit::Result UserEntityDictionary::WriteEDef(rkit::IWriteStream &stream, uint32_t edefID) const
@@ -123,9 +169,102 @@ namespace anox { namespace buildsystem {
 		RKIT_THROW(rkit::ResultCode::kNotYetImplemented);
 	}
 
-	const UserEntityDef2 &UserEntityDictionary::GetEDef(uint32_t edefID) const
+	const UserEntityDictionaryEntry &UserEntityDictionary::GetEntry(uint32_t edefID) const
+	{
+		return m_entries[edefID];
+	}
+
+	rkit::ByteStringView UserEntityDictionary::GetString(const UserEntityDictionaryString &str) const
+	{
+		return rkit::ByteStringView(m_stringPool + str.m_offset.Get(), str.m_length.Get());
+	}
+
+	rkit::Result UserEntityDictionary::AddPooledString(rkit::Vector<uint8_t> &stringPool, UserEntityDictionaryString &outString, const rkit::ConstSpan<uint8_t> &chars)
 	{
-		return m_defs[edefID];
+		if (stringPool.Count() + chars.Count() >= std::numeric_limits<uint32_t>::max())
+			RKIT_THROW(rkit::ResultCode::kDataError);
+
+		outString.m_offset = static_cast<uint32_t>(stringPool.Count());
+		outString.m_length = static_cast<uint32_t>(chars.Count());
+
+		RKIT_CHECK(stringPool.Append(chars));
+		RKIT_CHECK(stringPool.Append(static_cast<uint8_t>(0)));
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result UserEntityDictionary::CompileImage(rkit::Vector<UserEntityDef2> &edefs, rkit::Vector<uint8_t> &outImage)
+	{
+		rkit::QuickSort(edefs.begin(), edefs.end(), [](const UserEntityDef2 &a, const UserEntityDef2 &b)
+			{
+				return a.m_className.ToByteView() < b.m_className.ToByteView();
+			});
+
+		if (edefs.Count() >= std::numeric_limits<uint32_t>::max())
+			RKIT_THROW(rkit::ResultCode::kDataError);
+
+		const uint32_t numEDefs = static_cast<uint32_t>(edefs.Count());
+
+		rkit::Vector<UserEntityDictionaryEntry> entries;
+		rkit::Vector<uint8_t> stringPool;
+
+		RKIT_CHECK(entries.Resize(numEDefs));
+
+		for (uint32_t edefID = 0; edefID < numEDefs; edefID++)
+		{
+			const UserEntityDef2 &edef = edefs[edefID];
+			UserEntityDictionaryEntry &entry = entries[edefID];
+
+			RKIT_CHECK(AddPooledString(stringPool, entry.m_className, edef.m_className.ToSpan()));
+			RKIT_CHECK(AddPooledString(stringPool, entry.m_modelPath, edef.m_modelPath.ToSpan().ReinterpretCast<const uint8_t>()));
+			RKIT_CHECK(AddPooledString(stringPool, entry.m_type, edef.m_type.ToSpan()));
+			RKIT_CHECK(AddPooledString(stringPool, entry.m_description, edef.m_description.ToSpan()));
+
+			data::UserEntityDef &outDef = entry.m_def;
+			outDef = data::UserEntityDef();
+			outDef.m_modelCode = edef.m_modelCode;
+
+			for (size_t axis = 0; axis < 3; axis++)
+			{
+				outDef.m_scale[axis] = edef.m_scale[axis];
+				outDef.m_bboxMin[axis] = edef.m_bboxMin[axis];
+				outDef.m_bboxMax[axis] = edef.m_bboxMax[axis];
+			}
+
+			outDef.m_shadowType = static_cast<uint8_t>(edef.m_shadowType);
+			outDef.m_flags = edef.m_flags;
+			outDef.m_walkSpeed = edef.m_walkSpeed;
+			outDef.m_runSpeed = edef.m_runSpeed;
+			outDef.m_speed = edef.m_speed;
+			outDef.m_targetSequenceID = edef.m_targetSequence.RawValue();
+			outDef.m_miscValue = edef.m_miscValue;
+			outDef.m_startSequenceID = edef.m_startSequence.RawValue();
+		}
+
+		if (stringPool.Count() >= std::numeric_limits<uint32_t>::max())
+			RKIT_THROW(rkit::ResultCode::kDataError);
+
+		UserEntityDictionaryHeader header;
+		header.m_numEDefs = numEDefs;
+		header.m_stringPoolSize = static_cast<uint32_t>(stringPool.Count());
+
+		const size_t imageSize = sizeof(UserEntityDictionaryHeader)
+			+ sizeof(UserEntityDictionaryEntry) * entries.Count()
+			+ stringPool.Count();
+
+		RKIT_CHECK(outImage.Resize(imageSize));
+
+		uint8_t *imageBytes = outImage.GetBuffer();
+
+		memcpy(imageBytes, &header, sizeof(header));
+		imageBytes += sizeof(header);
+
+		memcpy(imageBytes, entries.GetBuffer(), sizeof(UserEntityDictionaryEntry) * entries.Count());
+		imageBytes += sizeof(UserEntityDictionaryEntry) * entries.Count();
+
+		memcpy(imageBytes, stringPool.GetBuffer(), stringPool.Count());
+
+		RKIT_RETURN_OK;
 	}
 
 	bool EntityDefCompiler::HasAnalysisStage() const
@@ -144,7 +283,7 @@ namespace anox { namespace buildsystem {
 		if (!rkit::GetDrivers().m_utilitiesDriver->ParseUInt32(identifier.SubString(prefix.Length()).RemoveEncoding(), 10, edefID))
 			RKIT_THROW(rkit::ResultCode::kInternalError);
 
-		rkit::UniquePtr<UserEntityDictionaryBase> dictionary;
+		const UserEntityDictionaryBase *dictionary = nullptr;
 		RKIT_CHECK(EntityDefCompilerBase::LoadUserEntityDictionary(dictionary, feedback));
 
 		const uint32_t numEDefs = dictionary->GetEDefCount();
@@ -152,8 +291,9 @@ namespace anox { namespace buildsystem {
 		if (edefID >= numEDefs)
 			RKIT_THROW(rkit::ResultCode::kInternalError);
 
-		const UserEntityDef2 &edef = static_cast<UserEntityDictionary &>(*dictionary).GetEDef(edefID);
-		const rkit::AsciiStringView modelPath = edef.m_modelPath;
+		const UserEntityDictionary &dict = *static_cast<const UserEntityDictionary *>(dictionary);
+		const rkit::ByteStringView modelPathBytes = dict.GetString(dict.GetEntry(edefID).m_modelPath);
+		const rkit::AsciiStringView modelPath(reinterpret_cast<const char *>(modelPathBytes.GetChars()), modelPathBytes.Length());
 
 		rkit::String modelPathStr;
 		RKIT_CHECK(modelPathStr.ConvertFrom(modelPath));
@@ -190,7 +330,7 @@ namespace anox { namespace buildsystem {
 		if (!rkit::GetDrivers().m_utilitiesDriver->ParseUInt32(identifier.SubString(prefix.Length()).RemoveEncoding(), 10, edefID))
 			RKIT_THROW(rkit::ResultCode::kInternalError);
 
-		rkit::UniquePtr<UserEntityDictionaryBase> dictionary;
+		const UserEntityDictionaryBase *dictionary = nullptr;
 		RKIT_CHECK(EntityDefCompilerBase::LoadUserEntityDictionary(dictionary, feedback));
 
 		const uint32_t numEDefs = dictionary->GetEDefCount();
@@ -198,10 +338,11 @@ namespace anox { namespace buildsystem {
 		if (edefID >= numEDefs)
 			RKIT_THROW(rkit::ResultCode::kInternalError);
 
-		const UserEntityDef2 &edef = static_cast<UserEntityDictionary &>(*dictionary).GetEDef(edefID);
-		const rkit::AsciiStringView modelPathStrView = edef.m_modelPath;
+		const UserEntityDictionary &dict = *static_cast<const UserEntityDictionary *>(dictionary);
+		const UserEntityDictionaryEntry &entry = dict.GetEntry(edefID);
+		const rkit::ByteStringView description = dict.GetString(entry.m_description);
 
-		if (edef.m_description.Length() > 255)
+		if (description.Length() > 255)
 		{
 			rkit::log::Error(u8"Description too long");
 			RKIT_THROW(rkit::ResultCode::kDataError);
@@ -214,7 +355,7 @@ namespace anox { namespace buildsystem {
 
 			rkit::ByteString fullType;
 			RKIT_CHECK(fullType.Set(rkit::StringView(u8"userentity_").RemoveEncoding()));
-			RKIT_CHECK(fullType.Append(edef.m_type));
+			RKIT_CHECK(fullType.Append(dict.GetString(entry.m_type)));
 
 			for (size_t i = 0; i < schema.m_numClassDefs; i++)
 			{
@@ -236,18 +377,11 @@ namespace anox { namespace buildsystem {
 			}
 		}
 
-		data::UserEntityDef outDef = {};
-		outDef.m_modelCode = edef.m_modelCode;
+		data::UserEntityDef outDef = entry.m_def;
 
-		for (size_t axis = 0; axis < 3; axis++)
 		{
-			outDef.m_scale[axis] = edef.m_scale[axis];
-			outDef.m_bboxMin[axis] = edef.m_bboxMin[axis];
-			outDef.m_bboxMax[axis] = edef.m_bboxMax[axis];
-		}
-
-		{
-			const rkit::AsciiStringView modelPath = edef.m_modelPath;
+			const rkit::ByteStringView modelPathBytes = dict.GetString(entry.m_modelPath);
+			const rkit::AsciiStringView modelPath(reinterpret_cast<const char *>(modelPathBytes.GetChars()), modelPathBytes.Length());
 
 			rkit::String modelPathStr;
 			RKIT_CHECK(modelPathStr.ConvertFrom(modelPath));
@@ -274,15 +408,7 @@ namespace anox { namespace buildsystem {
 		}
 
 		outDef.m_entityType = static_cast<uint32_t>(classDefIndex.Get());
-		outDef.m_shadowType = static_cast<uint8_t>(edef.m_shadowType);
-		outDef.m_flags = edef.m_flags;
-		outDef.m_walkSpeed = edef.m_walkSpeed;
-		outDef.m_runSpeed = edef.m_runSpeed;
-		outDef.m_speed = edef.m_speed;
-		outDef.m_targetSequenceID = edef.m_targetSequence.RawValue();
-		outDef.m_miscValue = edef.m_miscValue;
-		outDef.m_startSequenceID = edef.m_startSequence.RawValue();
-		outDef.m_descriptionStringLength = static_cast<uint8_t>(edef.m_description.Length());
+		outDef.m_descriptionStringLength = static_cast<uint8_t>(description.Length());
 
 		rkit::CIPath edefPath;
 		RKIT_CHECK(edefPath.Set(depsNode->GetIdentifier()));
@@ -291,7 +417,7 @@ namespace anox { namespace buildsystem {
 		RKIT_CHECK(feedback->OpenOutput(rkit::buildsystem::BuildFileLocation::kIntermediateDir, edefPath, outFile));
 
 		RKIT_CHECK(outFile->WriteAll(&outDef, sizeof(outDef)));
-		RKIT_CHECK(outFile->WriteAllSpan(edef.m_description.ToSpan()));
+		RKIT_CHECK(outFile->WriteAllSpan(description.ToSpan()));
 
 		RKIT_RETURN_OK;
 	}
@@ -381,20 +507,27 @@ namespace anox { namespace buildsystem {
 		return edefIdentifier.Format(u8"edefs/edef{}", edefID);
 	}
 
-	rkit::Result EntityDefCompilerBase::LoadUserEntityDictionary(rkit::UniquePtr<UserEntityDictionaryBase> &outDictionary, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
+	rkit::Result EntityDefCompilerBase::LoadUserEntityDictionary(const UserEntityDictionaryBase *&outDictionary, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
-		rkit::UniquePtr<rkit::ISeekableReadStream> inFile;
-		RKIT_CHECK(feedback->OpenInput(rkit::buildsystem::BuildFileLocation::kSourceDir, u8"models/entity.dat", inFile));
+		const rkit::buildsystem::IMemoizedInput *parsedInput = nullptr;
+		RKIT_CHECK(feedback->OpenMemoizedInput(rkit::buildsystem::BuildFileLocation::kSourceDir, u8"models/entity.dat", EntityDefCompiler::ParseUserEntityDictionary, parsedInput));
 
-		if (inFile->GetSize() >= std::numeric_limits<size_t>::max())
+		outDictionary = static_cast<const UserEntityDictionaryBase *>(parsedInput);
+
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result EntityDefCompiler::ParseUserEntityDictionary(rkit::ISeekableReadStream &stream, rkit::UniquePtr<rkit::buildsystem::IMemoizedInput> &outParsedInput)
+	{
+		if (stream.GetSize() >= std::numeric_limits<size_t>::max())
 			RKIT_THROW(rkit::ResultCode::kOutOfMemory);
 
-		const size_t fileSize = static_cast<size_t>(inFile->GetSize());
+		const size_t fileSize = static_cast<size_t>(stream.GetSize());
 
 		rkit::Vector<uint8_t> edefCharsArray;
 		RKIT_CHECK(edefCharsArray.Resize(fileSize));
 
-		RKIT_CHECK(inFile->ReadAllSpan(edefCharsArray.ToSpan()));
+		RKIT_CHECK(stream.ReadAllSpan(edefCharsArray.ToSpan()));
 
 		rkit::ConstSpan<uint8_t> fileChars = edefCharsArray.ToSpan();
 
@@ -626,7 +759,10 @@ namespace anox { namespace buildsystem {
 			RKIT_CHECK(edefs.Append(edef));
 		}
 
-		RKIT_CHECK(rkit::New<UserEntityDictionary>(outDictionary, std::move(edefs)));
+		rkit::Vector<uint8_t> image;
+		RKIT_CHECK(UserEntityDictionary::CompileImage(edefs, image));
+
+		RKIT_CHECK(rkit::New<UserEntityDictionary>(outParsedInput, std::move(image)));
 
 		RKIT_RETURN_OK;
 	}
@@ -20,7 +20,7 @@ namespace anox
 
 namespace anox { namespace buildsystem
 {
-	class UserEntityDictionaryBase
+	class UserEntityDictionaryBase : public rkit::buildsystem::IMemoizedInput
 	{
 	public:
 		virtual ~UserEntityDictionaryBase() {}
@@ -38,7 +38,10 @@ namespace anox { namespace buildsystem
 	{
 	public:
 		static rkit::Result FormatEDef(rkit::String &edefIdentifier, uint32_t edefID);
-		static rkit::Result LoadUserEntityDictionary(rkit::UniquePtr<UserEntityDictionaryBase> &dictionary, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback);
+		// Returns the memoized dictionary compiled from models/entity.dat, valid until the next build.
+		// The dictionary is a single flat image, consumers index into it without reparsing.
+		// It only exists at build time, the runtime loads compiled edefs by content ID.
+		static rkit::Result LoadUserEntityDictionary(const UserEntityDictionaryBase *&outDictionary, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback);
 
 		static rkit::Result Create(rkit::UniquePtr<EntityDefCompilerBase> &outCompiler);
 	};
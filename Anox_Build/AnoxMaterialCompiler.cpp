@@ -195,6 +195,11 @@ namespace anox { namespace buildsystem
 		return true;
 	}
 
+	bool MaterialCompiler::CanRunAnalysisConcurrently() const
+	{
+		return true;
+	}
+
 	rkit::Result MaterialCompiler::MaterialNodeTypeFromFourCC(data::MaterialResourceType &outNodeType, uint32_t nodeTypeFourCC)
 	{
 		switch (nodeTypeFourCC)
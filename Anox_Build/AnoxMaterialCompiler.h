@@ -33,6 +33,7 @@ namespace anox { namespace buildsystem
 		MaterialCompiler(rkit::png::IPngDriver &pngDriver);
 
 		bool HasAnalysisStage() const override;
+		bool CanRunAnalysisConcurrently() const override;
 
 		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
@@ -5,6 +5,7 @@
 #include "rkit/Core/FPControl.h"
 #include "rkit/Core/HashTable.h"
 #include "rkit/Core/BoolVector.h"
+#include "rkit/Core/BufferedStream.h"
 #include "rkit/Core/LogDriver.h"
 #include "rkit/Core/Optional.h"
 #include "rkit/Core/Pair.h"
@@ -241,6 +242,7 @@ namespace anox { namespace buildsystem
 	{
 	public:
 		bool HasAnalysisStage() const override;
+		bool CanRunAnalysisConcurrently() const override;
 		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 
@@ -267,6 +269,7 @@ namespace anox { namespace buildsystem
 	{
 	public:
 		bool HasAnalysisStage() const override;
+		bool CanRunAnalysisConcurrently() const override;
 		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 
@@ -277,6 +280,7 @@ namespace anox { namespace buildsystem
 	{
 	public:
 		bool HasAnalysisStage() const override;
+		bool CanRunAnalysisConcurrently() const override;
 		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
 
@@ -534,6 +538,11 @@ namespace anox { namespace buildsystem
 		return true;
 	}
 
+	bool AnoxMDACompiler::CanRunAnalysisConcurrently() const
+	{
+		return true;
+	}
+
 	rkit::Result AnoxMDACompiler::OpenMDAPath(rkit::UniquePtr<rkit::ISeekableReadStream> &outInputFile, bool &outIsActuallyMD2, rkit::CIPath &inOutPath, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
 		outIsActuallyMD2 = false;
@@ -1321,6 +1330,11 @@ namespace anox { namespace buildsystem
 		return true;
 	}
 
+	bool AnoxMD2Compiler::CanRunAnalysisConcurrently() const
+	{
+		return true;
+	}
+
 	rkit::Result AnoxMD2Compiler::RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
 		rkit::CIPath md2Path;
@@ -1345,6 +1359,11 @@ namespace anox { namespace buildsystem
 		return true;
 	}
 
+	bool AnoxCTCCompiler::CanRunAnalysisConcurrently() const
+	{
+		return true;
+	}
+
 	rkit::Result AnoxCTCCompiler::RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
 	{
 		rkit::CIPath ctcPath;
@@ -1387,8 +1406,12 @@ namespace anox { namespace buildsystem
 		rkit::CIPath ctcPath;
 		RKIT_CHECK(ctcPath.Set(depsNode->GetIdentifier()));
 
-		rkit::UniquePtr<rkit::ISeekableReadStream> inputFile;
-		RKIT_CHECK(feedback->OpenInput(rkit::buildsystem::BuildFileLocation::kSourceDir, ctcPath, inputFile));
+		rkit::UniquePtr<rkit::ISeekableReadStream> unbufferedInputFile;
+		RKIT_CHECK(feedback->OpenInput(rkit::buildsystem::BuildFileLocation::kSourceDir, ctcPath, unbufferedInputFile));
+
+		// Vertex morphs, bone weights, and bone keys are read a few bytes at a time
+		rkit::UniquePtr<rkit::BufferedSeekableReadStream> inputFile;
+		RKIT_CHECK(rkit::GetDrivers().m_utilitiesDriver->CreateBufferedSeekableReadStream(inputFile, std::move(unbufferedInputFile), 64 * 1024));
 
 		CTCHeader header;
 		RKIT_CHECK(inputFile->ReadOneBinary(header));
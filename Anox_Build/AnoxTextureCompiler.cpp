@@ -1,6 +1,7 @@
 #include "AnoxTextureCompiler.h"
 
 #include "rkit/Core/Algorithm.h"
+#include "rkit/Core/Drivers.h"
 #include "rkit/Core/Endian.h"
 #include "rkit/Core/LogDriver.h"
 #include "rkit/Core/Path.h"
@@ -16,6 +17,7 @@
 #include "rkit/Png/PngDriver.h"
 
 #include "rkit/Utilities/Image.h"
+#include "rkit/Utilities/ImageKernels.h"
 
 namespace anox { namespace buildsystem
 {
@@ -764,37 +766,23 @@ namespace anox { namespace buildsystem
 			}
 		}
 
-		for (uint32_t y = 0; y < height; y++)
+		if (tgaHeader.m_pixelSizeBits != 24 && tgaHeader.m_pixelSizeBits != 32)
 		{
-			const rkit::Span<priv::TextureCompilerPixel<uint8_t, 4>> outScanline = image->GetScanlineSpan(height - 1 - y);
-			RKIT_ASSERT(outScanline.Count() >= width);
+			rkit::log::Error(u8"TGA bit size unsupported");
+			RKIT_THROW(rkit::ResultCode::kNotYetImplemented);
+		}
 
-			const uint8_t *inScanlineBytes = decompressedImageData.GetBuffer() + static_cast<size_t>(y) * width * pixelSizeBytes;
+		const rkit::utils::IImageKernels *kernels = rkit::GetDrivers().m_utilitiesDriver->GetImageKernels();
 
-			switch (tgaHeader.m_pixelSizeBits)
-			{
-			case 24:
-			{
-				for (size_t i = 0; i < width; i++)
-				{
-					const uint8_t *inBytes = inScanlineBytes + (i * 3);
-					outScanline[i].Set(inBytes[2], inBytes[1], inBytes[0], 0xff);
-				}
-			}
-			break;
-			case 32:
-			{
-				for (size_t i = 0; i < width; i++)
-				{
-					const uint8_t *inBytes = inScanlineBytes + (i * 4);
-					outScanline[i].Set(inBytes[2], inBytes[1], inBytes[0], inBytes[3]);
-				}
-			}
-			break;
-			default:
-				rkit::log::Error(u8"TGA bit size unsupported");
-				RKIT_THROW(rkit::ResultCode::kNotYetImplemented);
-			}
+		for (uint32_t y = 0; y < height; y++)
+		{
+			const rkit::Span<uint8_t> outScanlineBytes(static_cast<uint8_t *>(image->ModifyScanline(height - 1 - y)), static_cast<size_t>(width) * 4u);
+			const rkit::ConstSpan<uint8_t> inScanlineBytes(decompressedImageData.GetBuffer() + static_cast<size_t>(y) * width * pixelSizeBytes, static_cast<size_t>(width) * pixelSizeBytes);
+
+			if (tgaHeader.m_pixelSizeBits == 24)
+				kernels->ExpandRGB8ToRGBA8(outScanlineBytes, inScanlineBytes, rkit::utils::RGBChannelOrder::kBGR);
+			else
+				kernels->SwapRedBlueRGBA8(outScanlineBytes, inScanlineBytes);
 		}
 
 		outImage = std::move(image);
@@ -927,27 +915,35 @@ namespace anox { namespace buildsystem
 
 			const bool hasAlpha = DispositionHasAlpha(disposition);
 
+			uint8_t rgbaPalette[256][4];
+			for (size_t i = 0; i < palette.Count(); i++)
+			{
+				const RGBTriplet_t &triplet = palette[i];
+				rgbaPalette[i][0] = triplet[0];
+				rgbaPalette[i][1] = triplet[1];
+				rgbaPalette[i][2] = triplet[2];
+				rgbaPalette[i][3] = 255;
+			}
+
+			if (hasAlpha && palette.Count() == 256)
+			{
+				for (size_t i = 0; i < 4; i++)
+					rgbaPalette[255][i] = 0;
+			}
+
+			// Only the entries that exist in the file are passed, so the kernel rejects indexes past the end
+			const rkit::utils::IImageKernels *kernels = rkit::GetDrivers().m_utilitiesDriver->GetImageKernels();
+			const rkit::ConstSpan<uint8_t> paletteBytes(&rgbaPalette[0][0], palette.Count() * 4u);
+
 			for (uint32_t y = 0; y < height; y++)
 			{
 				const rkit::ConstSpan<uint8_t> inScanline = pcxData.ToSpan().SubSpan(y * scanLinePitch, width);
-				const rkit::Span<priv::TextureCompilerPixel<uint8_t, 4>> outScanline = image->GetScanlineSpan(y);
+				const rkit::Span<uint8_t> outScanlineBytes(static_cast<uint8_t *>(image->ModifyScanline(y)), static_cast<size_t>(width) * 4u);
 
-				for (uint32_t x = 0; x < width; x++)
+				if (!kernels->ExpandPalette8ToRGBA8(outScanlineBytes, inScanline, paletteBytes))
 				{
-					uint8_t elementValue = inScanline[x];
-					if (elementValue > palette.Count())
-					{
-						rkit::log::ErrorFmt(u8"PCX file '{}' had an out-of-range value", shortName.GetChars());
-						RKIT_THROW(rkit::ResultCode::kMalformedFile);
-					}
-
-					if (elementValue == 255 && hasAlpha)
-						outScanline[x].Set(0, 0, 0, 0);
-					else
-					{
-						const RGBTriplet_t &triplet = palette[elementValue];
-						outScanline[x].Set(triplet[0], triplet[1], triplet[2], 255);
-					}
+					rkit::log::ErrorFmt(u8"PCX file '{}' had an out-of-range value", shortName.GetChars());
+					RKIT_THROW(rkit::ResultCode::kMalformedFile);
 				}
 			}
 		}
@@ -1014,36 +1010,24 @@ namespace anox { namespace buildsystem
 		priv::TextureCompilerImage<uint8_t, 4> tcImage;
 		RKIT_CHECK(tcImage.Initialize(image.GetWidth(), image.GetHeight(), rkit::utils::PixelPacking::kUInt8));
 
+		const rkit::utils::IImageKernels *kernels = rkit::GetDrivers().m_utilitiesDriver->GetImageKernels();
+		const uint8_t numChannels = image.GetNumChannels();
+
 		for (uint32_t y = 0; y < height; y++)
 		{
-			rkit::Span<priv::TextureCompilerPixel<uint8_t, 4>> outScanline = tcImage.GetScanlineSpan(y);
-			const void *inScanline = image.GetScanline(y);
+			const rkit::Span<uint8_t> outScanlineBytes(static_cast<uint8_t *>(tcImage.ModifyScanline(y)), static_cast<size_t>(width) * 4u);
+			const rkit::ConstSpan<uint8_t> inScanlineBytes(static_cast<const uint8_t *>(image.GetScanline(y)), static_cast<size_t>(width) * numChannels);
 
-			switch (image.GetNumChannels())
+			switch (numChannels)
 			{
 			case 1:
-				for (size_t x = 0; x < width; x++)
-				{
-					const uint8_t grayscaleValue = static_cast<const uint8_t *>(inScanline)[x];
-					priv::TextureCompilerPixel<uint8_t, 4> &pixel = outScanline[x];
-					pixel.Set(grayscaleValue, grayscaleValue, grayscaleValue, 255);
-				}
+				kernels->ExpandGray8ToRGBA8(outScanlineBytes, inScanlineBytes);
 				break;
 			case 3:
-				for (size_t x = 0; x < width; x++)
-				{
-					const uint8_t *rgbValue = static_cast<const uint8_t *>(inScanline) + (x * 3);
-					priv::TextureCompilerPixel<uint8_t, 4> &pixel = outScanline[x];
-					pixel.Set(rgbValue[0], rgbValue[1], rgbValue[2], 255);
-				}
+				kernels->ExpandRGB8ToRGBA8(outScanlineBytes, inScanlineBytes, rkit::utils::RGBChannelOrder::kRGB);
 				break;
 			case 4:
-				for (size_t x = 0; x < width; x++)
-				{
-					const uint8_t *rgbaValue = static_cast<const uint8_t *>(inScanline) + (x * 4);
-					priv::TextureCompilerPixel<uint8_t, 4> &pixel = outScanline[x];
-					pixel.Set(rgbaValue[0], rgbaValue[1], rgbaValue[2], rgbaValue[3]);
-				}
+				rkit::CopySpanNonOverlapping(outScanlineBytes, inScanlineBytes);
 				break;
 			default:
 				RKIT_THROW(rkit::ResultCode::kInternalError);
@@ -7,13 +7,37 @@ namespace anox::game
 {
 	AllWorldObjectsIterator &AllWorldObjectsIterator::operator++()
 	{
-		RKIT_ASSERT(m_proxy != nullptr);
+		RKIT_ASSERT(m_buckets != nullptr);
 
-		WorldObjectProxy *nextProxy = m_proxy->m_next.Get();
-		while (nextProxy != nullptr && nextProxy->m_object.Get() == nullptr)
-			nextProxy = nextProxy->m_next.Get();
+		m_slot++;
+		SkipRemovedObjects();
 
-		m_proxy = nextProxy;
 		return *this;
 	}
+
+	void AllWorldObjectsIterator::SkipRemovedObjects()
+	{
+		const rkit::Vector<WorldObjectTypeBucket> &buckets = *m_buckets;
+
+		while (m_bucketIndex < buckets.Count())
+		{
+			const rkit::Vector<rkit::RCPtr<WorldObjectProxy>> &objects = buckets[m_bucketIndex].m_objects;
+
+			while (m_slot < objects.Count())
+			{
+				if (objects[m_slot]->m_object.IsValid())
+					return;
+
+				m_slot++;
+			}
+
+			m_bucketIndex++;
+			m_slot = 0;
+		}
+
+		// Reached the end
+		m_buckets = nullptr;
+		m_bucketIndex = 0;
+		m_slot = 0;
+	}
 }
@@ -1,9 +1,19 @@
 #pragma once
 
+#include "rkit/Core/CoreDefs.h"
+
+namespace rkit
+{
+	template<class T>
+	class Vector;
+}
+
 namespace anox::game
 {
 	class WorldObject;
+	struct RuntimeTypeInfo;
 	struct WorldObjectProxy;
+	struct WorldObjectTypeBucket;
 	class WorldImpl;
 
 	class AllWorldObjectsIterator
@@ -22,13 +32,19 @@ namespace anox::game
 		AllWorldObjectsIterator &operator++();
 
 	private:
-		explicit AllWorldObjectsIterator(WorldObjectProxy *obj);
+		AllWorldObjectsIterator(const rkit::Vector<WorldObjectTypeBucket> *buckets, size_t bucketIndex, size_t slot);
+
+		void SkipRemovedObjects();
 
-		WorldObjectProxy *m_proxy;
+		const rkit::Vector<WorldObjectTypeBucket> *m_buckets;
+		size_t m_bucketIndex;
+		size_t m_slot;
 	};
 
-	// NOTE: Adding objects while iterating a collection is safe.
-	// Removing objects while iterating a collection is NOT safe.
+	// Objects are visited grouped by type.
+	// NOTE: Adding objects while iterating a collection is safe, added objects
+	// will be visited.  Removing objects while iterating a collection is also
+	// safe, removed objects are skipped.
 	class AllWorldObjectsCollection
 	{
 	public:
@@ -41,36 +57,57 @@ namespace anox::game
 		AllWorldObjectsIterator end() const;
 
 	private:
-		explicit AllWorldObjectsCollection(WorldObjectProxy *firstProxy);
+		explicit AllWorldObjectsCollection(const rkit::Vector<WorldObjectTypeBucket> &buckets);
+
+		const rkit::Vector<WorldObjectTypeBucket> *m_buckets;
+	};
+
+	// All objects in the world with the same most-derived type.  Objects are
+	// grouped so that batched passes over a type touch contiguous memory, and
+	// so that objects that don't need per-frame updates cost nothing per frame.
+	struct WorldObjectTypeBucket
+	{
+		const RuntimeTypeInfo *m_type = nullptr;
+
+		// Removed objects leave a proxy with no object until the world is compacted
+		rkit::Vector<rkit::RCPtr<WorldObjectProxy>> m_objects;
+		size_t m_numRemovedObjects = 0;
 
-		WorldObjectProxy *m_firstProxy;
+		// Removed entries are null until the world is compacted
+		rkit::Vector<WorldObject *> m_frameUpdateObjects;
+		size_t m_numRemovedFrameUpdates = 0;
 	};
 }
 
 #include "GameObjects/WorldObject.h"
 
 #include "rkit/Core/RKitAssert.h"
+#include "rkit/Core/Vector.h"
 
 namespace anox::game
 {
 	inline AllWorldObjectsIterator::AllWorldObjectsIterator()
-		: m_proxy(nullptr)
+		: m_buckets(nullptr)
+		, m_bucketIndex(0)
+		, m_slot(0)
 	{
 	}
 
-	inline AllWorldObjectsIterator::AllWorldObjectsIterator(WorldObjectProxy *proxy)
-		: m_proxy(proxy)
+	inline AllWorldObjectsIterator::AllWorldObjectsIterator(const rkit::Vector<WorldObjectTypeBucket> *buckets, size_t bucketIndex, size_t slot)
+		: m_buckets(buckets)
+		, m_bucketIndex(bucketIndex)
+		, m_slot(slot)
 	{
 	}
 
 	inline bool AllWorldObjectsIterator::operator==(const AllWorldObjectsIterator &other) const
 	{
-		return m_proxy == other.m_proxy;
+		return m_buckets == other.m_buckets && m_bucketIndex == other.m_bucketIndex && m_slot == other.m_slot;
 	}
 
 	inline bool AllWorldObjectsIterator::operator!=(const AllWorldObjectsIterator &other) const
 	{
-		return m_proxy != other.m_proxy;
+		return !((*this) == other);
 	}
 
 	inline AllWorldObjectsIterator AllWorldObjectsIterator::operator++(int)
@@ -80,14 +117,16 @@ namespace anox::game
 		return copy;
 	}
 
-	inline AllWorldObjectsCollection::AllWorldObjectsCollection(WorldObjectProxy *firstProxy)
-		: m_firstProxy(firstProxy)
+	inline AllWorldObjectsCollection::AllWorldObjectsCollection(const rkit::Vector<WorldObjectTypeBucket> &buckets)
+		: m_buckets(&buckets)
 	{
 	}
 
 	inline AllWorldObjectsIterator AllWorldObjectsCollection::begin() const
 	{
-		return AllWorldObjectsIterator(m_firstProxy);
+		AllWorldObjectsIterator it(m_buckets, 0, 0);
+		it.SkipRemovedObjects();
+		return it;
 	}
 
 	inline AllWorldObjectsIterator AllWorldObjectsCollection::end() const
@@ -97,7 +136,7 @@ namespace anox::game
 
 	inline WorldObject &AllWorldObjectsIterator::operator*() const
 	{
-		WorldObject *obj = this->m_proxy->m_object.Get();
+		WorldObject *obj = (*m_buckets)[m_bucketIndex].m_objects[m_slot]->m_object.Get();
 		RKIT_ASSERT(obj != nullptr);
 		return *obj;
 	}
@@ -268,6 +268,7 @@ namespace anox::game::sandbox
 			uint32_t udefDescPos = 0;
 			for (const game::UserEntityDefValues &udef : udefValuesSpan)
 			{
+				// Descriptions are indexed by udef ID, so empty ones still take a slot
 				if (udef.m_descLength > 0)
 				{
 					rkit::ByteStringConstructionBuffer cbuf;
@@ -279,6 +280,10 @@ namespace anox::game::sandbox
 
 					udefDescPos += udef.m_descLength;
 				}
+				else
+				{
+					RKIT_CHECK(udefDescs.Append(rkit::ByteString()));
+				}
 			}
 		}
 
@@ -292,6 +297,14 @@ namespace anox::game::sandbox
 		return session->AsyncRunFrame(session->GetWorld());
 	}
 
+#if !RKIT_IS_FINAL
+	rkit::Result SandboxExports::MTAsync_RunWorldBenchmark(void *gameSession, uint32_t numObjects, uint32_t numFrames)
+	{
+		Session *session = static_cast<Session *>(gameSession);
+		return session->AsyncRunWorldBenchmark(numObjects, numFrames);
+	}
+#endif
+
 	rkit::Result SandboxExports::MTAsync_LoadMapScriptPackage(void *gameSession, void *scriptCatalogData, size_t scriptCatalogSize)
 	{
 		Session *session = static_cast<Session *>(gameSession);
@@ -15,9 +15,16 @@
 
 #include "SandboxResourceLoader.h"
 
+#include "anox/Sandbox/AnoxGame.sb.generated.h"
+
 #include "AllWorldObjects.h"
+#if !RKIT_IS_FINAL
+#include "GameObjects/InfoPlayerStartObject.h"
+#endif
 #include "AnoxGameSession.h"
 #include "AnoxWorldObjectFactory.h"
+#include "EntityLevelLoader.h"
+#include "GameObjects/UserEntityDef.h"
 
 #include "ScriptManager.h"
 #include "World.h"
@@ -45,10 +52,18 @@ namespace anox::game
 		rkit::ResultCoroutine EnterGameSession(rkit::ICoroThread &thread, World &world);
 
 		rkit::ResultCoroutine RunFrame(rkit::ICoroThread &thread, World &world);
+#if !RKIT_IS_FINAL
+		rkit::ResultCoroutine RunWorldBenchmark(rkit::ICoroThread &thread, uint32_t numObjects, uint32_t numFrames);
+#endif
 
 	private:
 		rkit::ResultCoroutine LoadMultipleScripts(rkit::ICoroThread &thread, ScriptManager::ScriptLayer layer, rkit::Span<const rkit::data::ContentID> contentIDs);
 
+#if !RKIT_IS_FINAL
+		static uint64_t GetBenchmarkTimestamp(uint64_t &outFrequency);
+		static uint64_t TimestampsToMicroseconds(uint64_t startTime, uint64_t endTime, uint64_t frequency);
+#endif
+
 		rkit::UniquePtr<World> m_world;
 		rkit::UniquePtr<ScriptManager> m_scriptManager;
 		rkit::UniquePtr<rkit::ICoroThread> m_mainCoroThread;
@@ -77,6 +92,15 @@ namespace anox::game
 		rkit::Span<const uint8_t> spawnData, rkit::Vector<rkit::ByteStringView> spawnDefStrings,
 		rkit::Span<const game::UserEntityDefValues> udefs, rkit::Vector<rkit::ByteString> udefDescriptions)
 	{
+		rkit::Vector<UserEntityDef> edefs;
+		CORO_CHECK(EntityLevelLoader::ResolveEDefs(edefs, udefs, udefDescriptions.ToSpan()));
+
+		const WorldObjectSpawnParams spawnParams =
+		{
+			spawnDefStrings.ToSpan(),
+			edefs.ToSpan()
+		};
+
 		for (const rkit::endian::LittleUInt32_t &entityTypeLEU32 : entityTypes)
 		{
 			const uint32_t entityTypeID = entityTypeLEU32.Get();
@@ -102,13 +126,6 @@ namespace anox::game
 				CORO_THROW(rkit::ResultCode::kDataError);
 			}
 
-			WorldObjectSpawnParams spawnParams =
-			{
-				spawnDefStrings.ToSpan(),
-				udefs,
-				udefDescriptions.ToSpan()
-			};
-
 			CORO_CHECK(deserializeFunc(fieldsRef, spawnParams, spawnData.Ptr()));
 			spawnData = spawnData.SubSpan(spawnDataSize);
 
@@ -166,6 +183,87 @@ namespace anox::game
 		CORO_RETURN_OK;
 	}
 
+#if !RKIT_IS_FINAL
+	rkit::ResultCoroutine SessionImpl::RunWorldBenchmark(rkit::ICoroThread &thread, uint32_t numObjects, uint32_t numFrames)
+	{
+		// Runs in a scratch world so that the session world is undisturbed
+		rkit::UniquePtr<World> world;
+		CORO_CHECK(World::Create(world, *m_scriptManager));
+
+		rkit::Vector<InfoPlayerStartObject *> objects;
+		CORO_CHECK(objects.Reserve(numObjects));
+
+		uint64_t timerFrequency = 0;
+		uint32_t numUpdating = 0;
+
+		const uint64_t spawnStartTime = GetBenchmarkTimestamp(timerFrequency);
+
+		for (uint32_t i = 0; i < numObjects; i++)
+		{
+			InfoPlayerStartObject *obj = nullptr;
+			CORO_CHECK(WorldObjectFactory::CreateDynamic(*world, obj));
+
+			// Most objects in a level are idle, so only a few update every frame
+			if (i % 8u == 0)
+			{
+				CORO_CHECK(world->SetObjectNeedsFrameUpdate(obj, true));
+				numUpdating++;
+			}
+
+			CORO_CHECK(objects.Append(obj));
+		}
+
+		const uint64_t frameStartTime = GetBenchmarkTimestamp(timerFrequency);
+
+		for (uint32_t i = 0; i < numFrames; i++)
+		{
+			CORO_CHECK(co_await world->OnRunFrame(thread));
+		}
+
+		const uint64_t removeStartTime = GetBenchmarkTimestamp(timerFrequency);
+
+		size_t numRemoved = 0;
+		for (size_t i = 0; i < objects.Count(); i += 2)
+		{
+			world->RemoveObject(objects[i]);
+			numRemoved++;
+		}
+
+		// Removed objects are compacted out at the end of the frame
+		CORO_CHECK(co_await world->OnRunFrame(thread));
+
+		const uint64_t endTime = GetBenchmarkTimestamp(timerFrequency);
+
+		size_t numRemaining = 0;
+		for (WorldObject &obj : world->GetAllObjects())
+			numRemaining++;
+
+		const uint64_t frameMicroseconds = TimestampsToMicroseconds(frameStartTime, removeStartTime, timerFrequency);
+
+		rkit::log::LogInfoFmt(u8"World benchmark: spawned {} objects in {} usec", numObjects, TimestampsToMicroseconds(spawnStartTime, frameStartTime, timerFrequency));
+		rkit::log::LogInfoFmt(u8"World benchmark: {} frames with {} updating objects in {} usec ({} usec per frame)", numFrames, numUpdating, frameMicroseconds, (numFrames == 0) ? 0 : (frameMicroseconds / numFrames));
+		rkit::log::LogInfoFmt(u8"World benchmark: removed {} objects and compacted in {} usec, {} objects remaining", numRemoved, TimestampsToMicroseconds(removeStartTime, endTime, timerFrequency), numRemaining);
+
+		CORO_RETURN_OK;
+	}
+
+	uint64_t SessionImpl::GetBenchmarkTimestamp(uint64_t &outFrequency)
+	{
+		uint64_t timestamp = 0;
+		sandbox::SandboxImports::GetHighResTimestamp(timestamp, outFrequency);
+
+		return timestamp;
+	}
+
+	uint64_t SessionImpl::TimestampsToMicroseconds(uint64_t startTime, uint64_t endTime, uint64_t frequency)
+	{
+		if (frequency == 0)
+			return 0;
+
+		return (endTime - startTime) * 1000000u / frequency;
+	}
+#endif
+
 	rkit::ResultCoroutine SessionImpl::LoadMultipleScripts(rkit::ICoroThread &thread, ScriptManager::ScriptLayer layer, rkit::Span<const rkit::data::ContentID> contentIDs)
 	{
 		const size_t numScripts = contentIDs.Count();
@@ -234,6 +332,14 @@ namespace anox::game
 		return thread.EnterFunction(Impl().RunFrame(thread, world));
 	}
 
+#if !RKIT_IS_FINAL
+	rkit::Result Session::AsyncRunWorldBenchmark(uint32_t numObjects, uint32_t numFrames)
+	{
+		rkit::ICoroThread &thread = *Impl().m_mainCoroThread;
+		return thread.EnterFunction(Impl().RunWorldBenchmark(thread, numObjects, numFrames));
+	}
+#endif
+
 	World &Session::GetWorld() const
 	{
 		return *Impl().m_world;
@@ -46,6 +46,9 @@ namespace anox::game
 		rkit::Result AsyncPostSpawnInitialEntities(World &world);
 		rkit::Result AsyncRunFrame(World &world);
 		rkit::Result AsyncEnterGameSession(World &world);
+#if !RKIT_IS_FINAL
+		rkit::Result AsyncRunWorldBenchmark(uint32_t numObjects, uint32_t numFrames);
+#endif
 		rkit::Result WaitForMainThreadCoro(bool &outIsFinished);
 
 		static rkit::Result Create(rkit::UniquePtr<Session> &outSession, rkit::IMallocDriver *alloc);
@@ -29,7 +29,7 @@ namespace anox::game
 {
 	class WorldObject;
 	class World;
-	struct UserEntityDefValues;
+	struct UserEntityDef;
 	struct WorldObjectProxy;
 
 	template<class T>
@@ -38,8 +38,7 @@ namespace anox::game
 	struct WorldObjectSpawnParams
 	{
 		rkit::Span<const rkit::ByteStringView> m_spawnDefStrings;
-		rkit::Span<const UserEntityDefValues> m_udefs;
-		rkit::Span<const rkit::ByteString> m_udefDescriptions;
+		rkit::Span<const UserEntityDef> m_edefs;
 	};
 
 	typedef rkit::Result (*SerializeFromLevelFunction_t)(void *fieldsRef, const WorldObjectSpawnParams &spawnParams, const uint8_t *bytes);
@@ -7,6 +7,7 @@
 
 #include "rkit/Core/Optional.h"
 #include "rkit/Core/String.h"
+#include "rkit/Core/Vector.h"
 
 #include "rkit/Core/LogDriver.h"
 
@@ -33,29 +34,45 @@ namespace anox::game
 	{
 		const uint32_t udefID = static_cast<const rkit::endian::LittleUInt32_t *>(source)->Get();
 
-		if (udefID >= spawnParams.m_udefs.Count())
+		if (udefID >= spawnParams.m_edefs.Count())
 		{
 			rkit::log::Error(u8"Spawn def user entity def was out of range");
 			RKIT_THROW(rkit::ResultCode::kDataError);
 		}
 
-		const game::UserEntityDefValues &udef = spawnParams.m_udefs[udefID];
-
-		edef.m_modelCodeFourCC = udef.m_modelCodeFourCC;
-		edef.m_scale = rkit::math::Vec3::FromSpan(udef.m_scale.ToSpan());
-		edef.m_shadowType = udef.m_shadowType;
-		edef.m_bbox = rkit::math::BBox3(
-			rkit::math::Vec3::FromSpan(udef.m_bboxMin.ToSpan()),
-			rkit::math::Vec3::FromSpan(udef.m_bboxMax.ToSpan())
-		);
-		edef.m_userEntityFlags = udef.m_userEntityFlags;
-		edef.m_walkSpeed = udef.m_walkSpeed;
-		edef.m_runSpeed = udef.m_runSpeed;
-		edef.m_speed = udef.m_speed;
-		edef.m_targetSequence = udef.m_targetSequence;
-		edef.m_startSequence = udef.m_startSequence;
-		edef.m_miscValue = udef.m_miscValue;
-		edef.m_description = spawnParams.m_udefDescriptions[udefID];
+		edef = spawnParams.m_edefs[udefID];
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result EntityLevelLoader::ResolveEDefs(rkit::Vector<UserEntityDef> &outEDefs, const rkit::Span<const UserEntityDefValues> &udefs, const rkit::Span<const rkit::ByteString> &udefDescriptions)
+	{
+		if (udefDescriptions.Count() != udefs.Count())
+			RKIT_THROW(rkit::ResultCode::kDataError);
+
+		RKIT_CHECK(outEDefs.Resize(udefs.Count()));
+
+		for (size_t i = 0; i < udefs.Count(); i++)
+		{
+			const game::UserEntityDefValues &udef = udefs[i];
+			UserEntityDef &edef = outEDefs[i];
+
+			edef.m_modelCodeFourCC = udef.m_modelCodeFourCC;
+			edef.m_scale = rkit::math::Vec3::FromSpan(udef.m_scale.ToSpan());
+			edef.m_shadowType = udef.m_shadowType;
+			edef.m_bbox = rkit::math::BBox3(
+				rkit::math::Vec3::FromSpan(udef.m_bboxMin.ToSpan()),
+				rkit::math::Vec3::FromSpan(udef.m_bboxMax.ToSpan())
+			);
+			edef.m_userEntityFlags = udef.m_userEntityFlags;
+			edef.m_walkSpeed = udef.m_walkSpeed;
+			edef.m_runSpeed = udef.m_runSpeed;
+			edef.m_speed = udef.m_speed;
+			edef.m_targetSequence = udef.m_targetSequence;
+			edef.m_startSequence = udef.m_startSequence;
+			edef.m_miscValue = udef.m_miscValue;
+			edef.m_description = udefDescriptions[i];
+		}
+
 		RKIT_RETURN_OK;
 	}
 }
@@ -8,6 +8,12 @@ namespace rkit
 {
 	template<class T>
 	class Optional;
+
+	template<class T>
+	class Span;
+
+	template<class T>
+	class Vector;
 }
 
 namespace anox
@@ -19,6 +25,7 @@ namespace anox::game
 {
 	struct WorldObjectSpawnParams;
 	struct UserEntityDef;
+	struct UserEntityDefValues;
 
 	class EntityLevelLoader
 	{
@@ -32,6 +39,9 @@ namespace anox::game
 		static void LoadVec4(rkit::math::Vec4 &vec, const void *source);
 		static rkit::Result LoadByteString(rkit::ByteString &str, const void *source, const WorldObjectSpawnParams &spawnParams);
 		static rkit::Result LoadEDef(UserEntityDef &edef, const void *source, const WorldObjectSpawnParams &spawnParams);
+
+		// Converts the level's user entity defs once so that entities referencing them only copy the result
+		static rkit::Result ResolveEDefs(rkit::Vector<UserEntityDef> &outEDefs, const rkit::Span<const UserEntityDefValues> &udefs, const rkit::Span<const rkit::ByteString> &udefDescriptions);
 	};
 }
 
@@ -60,6 +60,8 @@ namespace anox::game
 	rkit::Result ScriptWindowInstance::HandleCommand(ScriptEnvironment &env, const ScriptPackage &pkg, const ape::ThinkSwitch &cmd)
 	{
 		m_thinkSwitch = Label::FromRawValue(cmd.m_label);
+		RKIT_CHECK(SetNeedsFrameUpdate(m_thinkSwitch != Label()));
+
 		RKIT_RETURN_OK;
 	}
 
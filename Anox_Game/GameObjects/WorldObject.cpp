@@ -35,4 +35,16 @@ namespace anox::game
 	{
 		CORO_RETURN_OK;
 	}
+
+	rkit::Result WorldObject::SetNeedsFrameUpdate(bool needsFrameUpdate)
+	{
+		// Not added to a world yet, the world picks this up when the object is added
+		if (!m_world)
+		{
+			m_needsFrameUpdate = needsFrameUpdate;
+			RKIT_RETURN_OK;
+		}
+
+		return GetWorld().SetObjectNeedsFrameUpdate(this, needsFrameUpdate);
+	}
 }
@@ -75,11 +75,7 @@ namespace anox::game
 
 	struct WorldObjectProxy final : public rkit::RefCounted
 	{
-		WorldObjectProxy *m_prev = nullptr;
-		rkit::RCPtr<WorldObjectProxy> m_next;
 		rkit::UniquePtr<WorldObject> m_object;
-
-		WorldObjectProxy *m_nextDead = nullptr;
 	};
 
 	class WorldObject : public DynamicObject
@@ -98,14 +94,26 @@ namespace anox::game
 
 		WorldObjectProxy &GetProxy() const;
 
+		bool NeedsFrameUpdate() const;
+
 	protected:
 		World &GetWorld() const;
 		ScriptContext &GetScriptContext();
 
+		// Objects only receive OnFrame calls while this is set
+		rkit::Result SetNeedsFrameUpdate(bool needsFrameUpdate);
+
 	private:
+		static const size_t kInvalidWorldSlot = static_cast<size_t>(-1);
+
 		World *m_world = nullptr;
 		WorldObjectProxy *m_proxy = nullptr;
 
+		size_t m_typeBucketIndex = kInvalidWorldSlot;
+		size_t m_typeBucketSlot = kInvalidWorldSlot;
+		size_t m_frameUpdateSlot = kInvalidWorldSlot;
+		bool m_needsFrameUpdate = false;
+
 		rkit::UniquePtr<ScriptContext> m_scriptContext;
 	};
 }
@@ -193,4 +201,9 @@ namespace anox::game
 	{
 		return *m_proxy;
 	}
+
+	inline bool WorldObject::NeedsFrameUpdate() const
+	{
+		return m_needsFrameUpdate;
+	}
 }
@@ -11,6 +11,7 @@
 
 #include "rkit/Core/NewDelete.h"
 #include "rkit/Core/Coroutine.h"
+#include "rkit/Core/HashTable.h"
 #include "rkit/Core/MemoryStream.h"
 #include "rkit/Core/Vector.h"
 
@@ -34,26 +35,32 @@ namespace anox::game
 
 		rkit::Result Initialize();
 
-		void AddObject(rkit::RCPtr<WorldObjectProxy> &&obj);
+		rkit::Result AddObject(rkit::RCPtr<WorldObjectProxy> &&obj);
 		void RemoveObject(WorldObject *obj);
 
+		rkit::Result SetObjectNeedsFrameUpdate(WorldObject *obj, bool needsFrameUpdate);
+
 		AllWorldObjectsCollection GetAllObjects() const;
 
 		rkit::ResultCoroutine OnWorldStarted(rkit::ICoroThread &thread);
 		rkit::ResultCoroutine OnRunFrame(rkit::ICoroThread &thread);
 
 	private:
-		void CleanUpObject(WorldObjectProxy *obj);
+		rkit::Result FindOrCreateTypeBucket(size_t &outBucketIndex, const RuntimeTypeInfo *type);
+		rkit::Result AddToFrameUpdates(WorldObject *obj);
+		void RemoveFromFrameUpdates(WorldObject *obj);
+
+		void CompactTypeBuckets();
 
 		ObjRef<GlobalSingleton> m_globalSingleton;
 		ScriptManager &m_scriptManager;
 		rkit::UniquePtr<ScriptEnvironment> m_scriptEnvironment;
 		rkit::UniquePtr<MusicManager> m_musicManager;
 
-		rkit::RCPtr<WorldObjectProxy> m_firstObj;
-		WorldObjectProxy* m_lastObject = nullptr;
+		rkit::Vector<WorldObjectTypeBucket> m_typeBuckets;
+		rkit::HashMap<const RuntimeTypeInfo *, size_t> m_typeToBucketIndex;
 
-		WorldObjectProxy *m_firstDead = nullptr;
+		bool m_needsCompaction = false;
 	};
 
 	WorldImpl::WorldImpl(ScriptManager &scriptManager)
@@ -63,8 +70,13 @@ namespace anox::game
 
 	WorldImpl::~WorldImpl()
 	{
-		while (m_firstObj.IsValid())
-			m_firstObj = std::move(m_firstObj->m_next);
+		// Objects may reference other objects in the world, so destroy all of
+		// the objects before releasing any proxies
+		for (WorldObjectTypeBucket &bucket : m_typeBuckets)
+		{
+			for (rkit::RCPtr<WorldObjectProxy> &proxy : bucket.m_objects)
+				proxy->m_object.Reset();
+		}
 	}
 
 	rkit::Result WorldImpl::Initialize()
@@ -75,7 +87,27 @@ namespace anox::game
 		RKIT_RETURN_OK;
 	}
 
-	void WorldImpl::AddObject(rkit::RCPtr<WorldObjectProxy> &&objProxyRCPtr)
+	rkit::Result WorldImpl::FindOrCreateTypeBucket(size_t &outBucketIndex, const RuntimeTypeInfo *type)
+	{
+		rkit::HashMap<const RuntimeTypeInfo *, size_t>::ConstIterator_t it = m_typeToBucketIndex.Find(type);
+		if (it != m_typeToBucketIndex.end())
+		{
+			outBucketIndex = it.Value();
+			RKIT_RETURN_OK;
+		}
+
+		const size_t bucketIndex = m_typeBuckets.Count();
+
+		RKIT_CHECK(m_typeBuckets.Append(WorldObjectTypeBucket()));
+		m_typeBuckets[bucketIndex].m_type = type;
+
+		RKIT_CHECK(m_typeToBucketIndex.Set(type, bucketIndex));
+
+		outBucketIndex = bucketIndex;
+		RKIT_RETURN_OK;
+	}
+
+	rkit::Result WorldImpl::AddObject(rkit::RCPtr<WorldObjectProxy> &&objProxyRCPtr)
 	{
 		WorldObjectProxy *proxyPtr = objProxyRCPtr.Get();
 
@@ -83,15 +115,26 @@ namespace anox::game
 
 		RKIT_ASSERT(obj != nullptr);
 
+		size_t bucketIndex = 0;
+		RKIT_CHECK(FindOrCreateTypeBucket(bucketIndex, obj->GetMostDerivedType()));
+
+		WorldObjectTypeBucket &bucket = m_typeBuckets[bucketIndex];
+
+		const size_t slot = bucket.m_objects.Count();
+		RKIT_CHECK(bucket.m_objects.Append(std::move(objProxyRCPtr)));
+
 		obj->m_proxy = proxyPtr;
 		obj->m_world = &this->Base();
+		obj->m_typeBucketIndex = bucketIndex;
+		obj->m_typeBucketSlot = slot;
 
-		if (m_lastObject)
-			m_lastObject->m_next = std::move(objProxyRCPtr);
-		else
-			m_firstObj = std::move(objProxyRCPtr);
+		// The object may have requested updates before it was added
+		if (obj->m_needsFrameUpdate)
+		{
+			RKIT_CHECK(AddToFrameUpdates(obj));
+		}
 
-		m_lastObject = proxyPtr;
+		RKIT_RETURN_OK;
 	}
 
 	void WorldImpl::RemoveObject(WorldObject *obj)
@@ -100,37 +143,120 @@ namespace anox::game
 
 		RKIT_ASSERT(proxy->m_object.IsValid());
 
+		RemoveFromFrameUpdates(obj);
+
+		// Leave the proxy in place so that iteration in progress is not disturbed,
+		// it is removed from the bucket when the world is compacted
+		m_typeBuckets[obj->m_typeBucketIndex].m_numRemovedObjects++;
+		m_needsCompaction = true;
+
 		proxy->m_object.Reset();
+	}
+
+	rkit::Result WorldImpl::SetObjectNeedsFrameUpdate(WorldObject *obj, bool needsFrameUpdate)
+	{
+		if (obj->m_needsFrameUpdate == needsFrameUpdate)
+			RKIT_RETURN_OK;
 
-		proxy->m_nextDead = m_firstDead;
-		m_firstDead = proxy;
+		obj->m_needsFrameUpdate = needsFrameUpdate;
+
+		// Not in the world yet, this will be handled when it's added
+		if (obj->m_typeBucketIndex == WorldObject::kInvalidWorldSlot)
+			RKIT_RETURN_OK;
+
+		if (needsFrameUpdate)
+			return AddToFrameUpdates(obj);
+
+		RemoveFromFrameUpdates(obj);
+		RKIT_RETURN_OK;
 	}
 
-	void WorldImpl::CleanUpObject(WorldObjectProxy *proxy)
+	rkit::Result WorldImpl::AddToFrameUpdates(WorldObject *obj)
 	{
-		WorldObjectProxy *nextProxyPtr = proxy->m_next.Get();
-		WorldObjectProxy *prevProxy = proxy->m_prev;
+		rkit::Vector<WorldObject *> &updateList = m_typeBuckets[obj->m_typeBucketIndex].m_frameUpdateObjects;
 
-		if (nextProxyPtr)
-			nextProxyPtr->m_prev = prevProxy;
-		else
-			m_lastObject = prevProxy;
+		const size_t slot = updateList.Count();
+		RKIT_CHECK(updateList.Append(obj));
 
-		// This will destroy the object!  Do not reference it after this line!
-		if (prevProxy)
-			prevProxy->m_next = std::move(proxy->m_next);
-		else
-			m_firstObj = std::move(proxy->m_next);
+		obj->m_frameUpdateSlot = slot;
+
+		RKIT_RETURN_OK;
 	}
 
-	AllWorldObjectsCollection WorldImpl::GetAllObjects() const
+	void WorldImpl::RemoveFromFrameUpdates(WorldObject *obj)
 	{
-		WorldObjectProxy *firstValidProxy = m_firstObj.Get();
+		if (obj->m_frameUpdateSlot == WorldObject::kInvalidWorldSlot)
+			return;
+
+		WorldObjectTypeBucket &bucket = m_typeBuckets[obj->m_typeBucketIndex];
 
-		while (firstValidProxy != nullptr && !firstValidProxy->m_object.IsValid())
-			firstValidProxy = firstValidProxy->m_next.Get();
+		RKIT_ASSERT(bucket.m_frameUpdateObjects[obj->m_frameUpdateSlot] == obj);
 
-		return AllWorldObjectsCollection(firstValidProxy);
+		bucket.m_frameUpdateObjects[obj->m_frameUpdateSlot] = nullptr;
+		bucket.m_numRemovedFrameUpdates++;
+
+		obj->m_frameUpdateSlot = WorldObject::kInvalidWorldSlot;
+		m_needsCompaction = true;
+	}
+
+	void WorldImpl::CompactTypeBuckets()
+	{
+		if (!m_needsCompaction)
+			return;
+
+		for (WorldObjectTypeBucket &bucket : m_typeBuckets)
+		{
+			if (bucket.m_numRemovedObjects > 0)
+			{
+				rkit::Vector<rkit::RCPtr<WorldObjectProxy>> &objects = bucket.m_objects;
+				const size_t numObjects = objects.Count();
+
+				size_t numKept = 0;
+				for (size_t i = 0; i < numObjects; i++)
+				{
+					WorldObject *obj = objects[i]->m_object.Get();
+					if (!obj)
+						continue;
+
+					obj->m_typeBucketSlot = numKept;
+
+					if (numKept != i)
+						objects[numKept] = std::move(objects[i]);
+
+					numKept++;
+				}
+
+				objects.ShrinkToSize(numKept);
+				bucket.m_numRemovedObjects = 0;
+			}
+
+			if (bucket.m_numRemovedFrameUpdates > 0)
+			{
+				rkit::Vector<WorldObject *> &updateList = bucket.m_frameUpdateObjects;
+				const size_t numUpdates = updateList.Count();
+
+				size_t numKept = 0;
+				for (size_t i = 0; i < numUpdates; i++)
+				{
+					WorldObject *obj = updateList[i];
+					if (!obj)
+						continue;
+
+					obj->m_frameUpdateSlot = numKept;
+					updateList[numKept++] = obj;
+				}
+
+				updateList.ShrinkToSize(numKept);
+				bucket.m_numRemovedFrameUpdates = 0;
+			}
+		}
+
+		m_needsCompaction = false;
+	}
+
+	AllWorldObjectsCollection WorldImpl::GetAllObjects() const
+	{
+		return AllWorldObjectsCollection(m_typeBuckets);
 	}
 
 	rkit::ResultCoroutine WorldImpl::OnWorldStarted(rkit::ICoroThread &thread)
@@ -149,18 +275,33 @@ namespace anox::game
 			CORO_CHECK(co_await obj.OnSpawnedFromLevel(thread));
 		}
 
+		CompactTypeBuckets();
+
 		CORO_RETURN_OK;
 	}
 
 	rkit::ResultCoroutine WorldImpl::OnRunFrame(rkit::ICoroThread &thread)
 	{
-		for (WorldObject &obj : GetAllObjects())
+		// Objects are updated one type at a time.  Objects may be added,
+		// removed, or change their update state during the frame, so the lists
+		// are re-read on every step and null entries are skipped.
+		for (size_t bucketIndex = 0; bucketIndex < m_typeBuckets.Count(); bucketIndex++)
 		{
-			CORO_CHECK(co_await obj.OnFrame(thread));
+			for (size_t slot = 0; slot < m_typeBuckets[bucketIndex].m_frameUpdateObjects.Count(); slot++)
+			{
+				WorldObject *obj = m_typeBuckets[bucketIndex].m_frameUpdateObjects[slot];
+
+				if (obj)
+				{
+					CORO_CHECK(co_await obj->OnFrame(thread));
+				}
+			}
 		}
 
 		CORO_CHECK(m_musicManager->OnFrame());
 
+		CompactTypeBuckets();
+
 		CORO_RETURN_OK;
 	}
 
@@ -184,8 +325,7 @@ namespace anox::game
 
 	rkit::Result World::AddObject(rkit::RCPtr<WorldObjectProxy> &&obj)
 	{
-		Impl().AddObject(std::move(obj));
-		RKIT_RETURN_OK;
+		return Impl().AddObject(std::move(obj));
 	}
 
 	void World::RemoveObject(WorldObject *obj)
@@ -193,6 +333,11 @@ namespace anox::game
 		Impl().RemoveObject(obj);
 	}
 
+	rkit::Result World::SetObjectNeedsFrameUpdate(WorldObject *obj, bool needsFrameUpdate)
+	{
+		return Impl().SetObjectNeedsFrameUpdate(obj, needsFrameUpdate);
+	}
+
 	AllWorldObjectsCollection World::GetAllObjects() const
 	{
 		return Impl().GetAllObjects();
@@ -43,6 +43,8 @@ namespace anox::game
 		rkit::Result AddObject(rkit::RCPtr<WorldObjectProxy> &&obj);
 		void RemoveObject(WorldObject *obj);
 
+		rkit::Result SetObjectNeedsFrameUpdate(WorldObject *obj, bool needsFrameUpdate);
+
 		// Include AllWorldObjects.h for these
 		AllWorldObjectsCollection GetAllObjects() const;
 
@@ -0,0 +1,862 @@
+#include "AnoxBSPCollision.h"
+
+#include "rkit/Core/Algorithm.h"
+#include "rkit/Core/RKitAssert.h"
+#include "rkit/Core/Span.h"
+
+#include "rkit/Math/Functions.h"
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+#include <emmintrin.h>
+#endif
+
+namespace anox
+{
+	namespace priv
+	{
+		// Distance that traces are kept away from brush surfaces, to avoid
+		// starting the next trace exactly on a plane
+		static const float kBSPTraceDistEpsilon = 0.03125f;
+
+		// Tree node and leaf bounds are quantized to integers, so pad them
+		static const float kBSPBoundsPadding = 1.0f;
+	}
+
+	struct AnoxBSPCollisionModel::TraceWork
+	{
+		float m_start[3];
+		float m_end[3];
+		float m_extents[3];
+		uint32_t m_contentsMask;
+		bool m_isPoint;
+
+		float m_fraction;
+		const CollisionBrushSide *m_hitSide;
+		const CollisionBrush *m_hitBrush;
+		uint32_t m_solidContents;
+		bool m_startSolid;
+		bool m_allSolid;
+
+		uint32_t m_brushCache[kBrushCacheSize];
+	};
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+	struct AnoxBSPCollisionModel::PacketTraceWork
+	{
+		struct BrushCacheEntry
+		{
+			uint32_t m_brushIndexPlusOne;
+			int m_testedLanes;
+		};
+
+		__m128 m_start[3];
+		__m128 m_end[3];
+		__m128 m_delta[3];
+		__m128 m_fraction;
+
+		uint32_t m_contentsMask;
+
+		const CollisionBrushSide *m_hitSides[4];
+		const CollisionBrush *m_hitBrushes[4];
+		uint32_t m_solidContents[4];
+		bool m_startSolid[4];
+		bool m_allSolid[4];
+
+		BrushCacheEntry m_brushCache[kBrushCacheSize];
+	};
+#endif
+
+	rkit::Result AnoxBSPCollisionModel::Initialize(const SourceData &src)
+	{
+		const size_t numNodes = src.m_treeNodes.Count();
+		const size_t numLeafs = src.m_leafs.Count();
+		const size_t numBrushes = src.m_brushes.Count();
+		const size_t numBrushSides = src.m_brushSides.Count();
+		const size_t numModels = src.m_models.Count();
+
+		RKIT_CHECK(m_nodes.Resize(numNodes));
+		RKIT_CHECK(m_leafs.Resize(numLeafs));
+		RKIT_CHECK(m_brushes.Resize(numBrushes));
+		RKIT_CHECK(m_brushSides.Resize(numBrushSides));
+		RKIT_CHECK(m_models.Resize(numModels));
+		RKIT_CHECK(m_leafBrushes.Resize(src.m_leafBrushes.Count()));
+
+		rkit::CopySpanNonOverlapping(m_leafBrushes.ToSpan(), src.m_leafBrushes);
+
+		for (size_t i = 0; i < numNodes; i++)
+		{
+			const AnoxBSPModelResourceBase::TreeNode &inNode = src.m_treeNodes[i];
+			CollisionNode &outNode = m_nodes[i];
+
+			const AnoxBSPModelResourceBase::Plane &plane = src.m_planes[inNode.m_planeIndex];
+			ConvertPlane(outNode.m_plane, src.m_normals[plane.m_normalIndex], plane.m_dist, inNode.m_planeFlip != 0);
+
+			for (size_t axis = 0; axis < 3; axis++)
+			{
+				outNode.m_mins[axis] = static_cast<float>(inNode.m_minBounds[axis]) - priv::kBSPBoundsPadding;
+				outNode.m_maxs[axis] = static_cast<float>(inNode.m_maxBounds[axis]) + priv::kBSPBoundsPadding;
+			}
+
+			if (inNode.m_frontNodeIsLeaf ? (inNode.m_frontNode >= numLeafs) : (inNode.m_frontNode >= numNodes))
+				RKIT_THROW(rkit::ResultCode::kDataError);
+
+			if (inNode.m_backNodeIsLeaf ? (inNode.m_backNode >= numLeafs) : (inNode.m_backNode >= numNodes))
+				RKIT_THROW(rkit::ResultCode::kDataError);
+
+			outNode.m_children[0] = inNode.m_frontNode | (inNode.m_frontNodeIsLeaf ? kLeafBit : 0u);
+			outNode.m_children[1] = inNode.m_backNode | (inNode.m_backNodeIsLeaf ? kLeafBit : 0u);
+		}
+
+		for (size_t i = 0; i < numLeafs; i++)
+		{
+			const AnoxBSPModelResourceBase::Leaf &inLeaf = src.m_leafs[i];
+			CollisionLeaf &outLeaf = m_leafs[i];
+
+			for (size_t axis = 0; axis < 3; axis++)
+			{
+				outLeaf.m_mins[axis] = static_cast<float>(inLeaf.m_minBounds[axis]) - priv::kBSPBoundsPadding;
+				outLeaf.m_maxs[axis] = static_cast<float>(inLeaf.m_maxBounds[axis]) + priv::kBSPBoundsPadding;
+			}
+
+			outLeaf.m_contents = inLeaf.m_contentFlags;
+			outLeaf.m_numLeafBrushes = static_cast<uint32_t>(inLeaf.m_brushes.Count());
+
+			if (outLeaf.m_numLeafBrushes == 0)
+				outLeaf.m_firstLeafBrush = 0;
+			else
+				outLeaf.m_firstLeafBrush = static_cast<uint32_t>(inLeaf.m_brushes.Ptr() - src.m_leafBrushes.Ptr());
+		}
+
+		for (size_t i = 0; i < numBrushes; i++)
+		{
+			const AnoxBSPModelResourceBase::Brush &inBrush = src.m_brushes[i];
+			CollisionBrush &outBrush = m_brushes[i];
+
+			outBrush.m_contents = inBrush.m_contents;
+			outBrush.m_numSides = static_cast<uint32_t>(inBrush.m_sides.Count());
+
+			if (outBrush.m_numSides == 0)
+				outBrush.m_firstSide = 0;
+			else
+				outBrush.m_firstSide = static_cast<uint32_t>(inBrush.m_sides.Ptr() - src.m_brushSides.Ptr());
+		}
+
+		for (size_t i = 0; i < numBrushSides; i++)
+		{
+			const AnoxBSPModelResourceBase::BrushSide &inSide = src.m_brushSides[i];
+			CollisionBrushSide &outSide = m_brushSides[i];
+
+			const AnoxBSPModelResourceBase::Plane &plane = src.m_planes[inSide.m_planeIndex];
+			ConvertPlane(outSide.m_plane, src.m_normals[plane.m_normalIndex], plane.m_dist, inSide.m_planeFlipBit != 0);
+
+			outSide.m_material = inSide.m_material;
+			outSide.m_materialFlags = inSide.m_materialFlags;
+		}
+
+		for (size_t i = 0; i < numModels; i++)
+		{
+			const AnoxBSPModelResourceBase::Model &inModel = src.m_models[i];
+			CollisionModel &outModel = m_models[i];
+
+			if (inModel.m_rootIsLeaf ? (inModel.m_rootIndex >= numLeafs) : (inModel.m_rootIndex >= numNodes))
+				RKIT_THROW(rkit::ResultCode::kDataError);
+
+			outModel.m_root = inModel.m_rootIndex | (inModel.m_rootIsLeaf ? kLeafBit : 0u);
+
+			for (size_t axis = 0; axis < 3; axis++)
+			{
+				outModel.m_mins[axis] = inModel.m_mins[axis];
+				outModel.m_maxs[axis] = inModel.m_maxs[axis];
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	size_t AnoxBSPCollisionModel::GetModelCount() const
+	{
+		return m_models.Count();
+	}
+
+	void AnoxBSPCollisionModel::GetModelBounds(size_t modelIndex, rkit::math::Vec3 &outMins, rkit::math::Vec3 &outMaxs) const
+	{
+		const CollisionModel &model = m_models[modelIndex];
+
+		outMins = rkit::math::Vec3::FromArray(model.m_mins);
+		outMaxs = rkit::math::Vec3::FromArray(model.m_maxs);
+	}
+
+	uint32_t AnoxBSPCollisionModel::PointContents(size_t modelIndex, const rkit::math::Vec3 &point) const
+	{
+		RKIT_ASSERT(modelIndex < m_models.Count());
+
+		const float px = point[0];
+		const float py = point[1];
+		const float pz = point[2];
+
+		uint32_t nodeRef = m_models[modelIndex].m_root;
+		while ((nodeRef & kLeafBit) == 0)
+		{
+			const CollisionNode &node = m_nodes[nodeRef];
+			const CollisionPlane &plane = node.m_plane;
+
+			const float d = plane.m_normal[0] * px + plane.m_normal[1] * py + plane.m_normal[2] * pz - plane.m_dist;
+
+			nodeRef = node.m_children[(d < 0.0f) ? 1 : 0];
+		}
+
+		return m_leafs[nodeRef & ~kLeafBit].m_contents;
+	}
+
+	void AnoxBSPCollisionModel::TraceRay(BSPTraceResult &outResult, size_t modelIndex, const rkit::math::Vec3 &start, const rkit::math::Vec3 &end, uint32_t contentsMask) const
+	{
+		const float extents[3] = { 0.0f, 0.0f, 0.0f };
+		const float centerOffset[3] = { 0.0f, 0.0f, 0.0f };
+
+		TraceGeneral(outResult, modelIndex, start, end, extents, centerOffset, contentsMask);
+	}
+
+	void AnoxBSPCollisionModel::TraceBox(BSPTraceResult &outResult, size_t modelIndex, const rkit::math::Vec3 &start, const rkit::math::Vec3 &end,
+		const rkit::math::Vec3 &mins, const rkit::math::Vec3 &maxs, uint32_t contentsMask) const
+	{
+		float extents[3];
+		float centerOffset[3];
+
+		for (size_t axis = 0; axis < 3; axis++)
+		{
+			extents[axis] = (maxs[axis] - mins[axis]) * 0.5f;
+			centerOffset[axis] = (maxs[axis] + mins[axis]) * 0.5f;
+		}
+
+		TraceGeneral(outResult, modelIndex, start, end, extents, centerOffset, contentsMask);
+	}
+
+	void AnoxBSPCollisionModel::TraceRays(const rkit::Span<BSPTraceResult> &outResults, size_t modelIndex, const rkit::Span<const BSPTraceRay> &rays, uint32_t contentsMask) const
+	{
+		RKIT_ASSERT(outResults.Count() == rays.Count());
+		RKIT_ASSERT(modelIndex < m_models.Count());
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+		const uint32_t root = m_models[modelIndex].m_root;
+
+		const size_t numRays = rays.Count();
+		for (size_t firstRay = 0; firstRay < numRays; firstRay += 4)
+		{
+			const size_t packetSize = rkit::Min<size_t>(4, numRays - firstRay);
+			TracePacket(outResults.SubSpan(firstRay, packetSize), root, rays.SubSpan(firstRay, packetSize), contentsMask);
+		}
+#else
+		for (size_t i = 0; i < rays.Count(); i++)
+			TraceRay(outResults[i], modelIndex, rays[i].m_start, rays[i].m_end, contentsMask);
+#endif
+	}
+
+	void AnoxBSPCollisionModel::TraceGeneral(BSPTraceResult &outResult, size_t modelIndex, const rkit::math::Vec3 &start, const rkit::math::Vec3 &end,
+		const float (&extents)[3], const float (&centerOffset)[3], uint32_t contentsMask) const
+	{
+		RKIT_ASSERT(modelIndex < m_models.Count());
+
+		TraceWork work;
+
+		for (size_t axis = 0; axis < 3; axis++)
+		{
+			work.m_start[axis] = start[axis] + centerOffset[axis];
+			work.m_end[axis] = end[axis] + centerOffset[axis];
+			work.m_extents[axis] = extents[axis];
+		}
+
+		work.m_isPoint = (extents[0] == 0.0f && extents[1] == 0.0f && extents[2] == 0.0f);
+		work.m_contentsMask = contentsMask;
+		work.m_fraction = 1.0f;
+		work.m_hitSide = nullptr;
+		work.m_hitBrush = nullptr;
+		work.m_solidContents = 0;
+		work.m_startSolid = false;
+		work.m_allSolid = false;
+
+		for (uint32_t &cacheEntry : work.m_brushCache)
+			cacheEntry = 0;
+
+		RecursiveTrace(work, m_models[modelIndex].m_root, 0.0f, 1.0f, work.m_start, work.m_end);
+
+		outResult = BSPTraceResult();
+
+		if (work.m_allSolid)
+			work.m_fraction = 0.0f;
+
+		outResult.m_fraction = work.m_fraction;
+		outResult.m_endPos = start + (end - start) * work.m_fraction;
+		outResult.m_startSolid = work.m_startSolid;
+		outResult.m_allSolid = work.m_allSolid;
+
+		if (work.m_hitSide)
+		{
+			const CollisionPlane &plane = work.m_hitSide->m_plane;
+
+			outResult.m_planeNormal = rkit::math::Vec3::FromArray(plane.m_normal);
+			outResult.m_planeDist = plane.m_dist;
+			outResult.m_material = work.m_hitSide->m_material;
+			outResult.m_materialFlags = work.m_hitSide->m_materialFlags;
+			outResult.m_contents = work.m_hitBrush->m_contents;
+		}
+		else if (work.m_startSolid)
+			outResult.m_contents = work.m_solidContents;
+	}
+
+	void AnoxBSPCollisionModel::RecursiveTrace(TraceWork &work, uint32_t nodeRef, float startFrac, float endFrac, const float (&p1)[3], const float (&p2)[3]) const
+	{
+		if (work.m_fraction <= startFrac)
+			return;
+
+		if (nodeRef & kLeafBit)
+		{
+			TraceToLeaf(work, nodeRef & ~kLeafBit);
+			return;
+		}
+
+		const CollisionNode &node = m_nodes[nodeRef];
+
+		if (!SweptBoxOverlaps(work, p1, p2, node.m_mins, node.m_maxs))
+			return;
+
+		const CollisionPlane &plane = node.m_plane;
+
+		const float t1 = plane.m_normal[0] * p1[0] + plane.m_normal[1] * p1[1] + plane.m_normal[2] * p1[2] - plane.m_dist;
+		const float t2 = plane.m_normal[0] * p2[0] + plane.m_normal[1] * p2[1] + plane.m_normal[2] * p2[2] - plane.m_dist;
+
+		float offset = 0.0f;
+		if (!work.m_isPoint)
+		{
+			offset = rkit::math::Absf(plane.m_normal[0]) * work.m_extents[0]
+				+ rkit::math::Absf(plane.m_normal[1]) * work.m_extents[1]
+				+ rkit::math::Absf(plane.m_normal[2]) * work.m_extents[2];
+		}
+
+		if (t1 >= offset && t2 >= offset)
+		{
+			RecursiveTrace(work, node.m_children[0], startFrac, endFrac, p1, p2);
+			return;
+		}
+
+		if (t1 < -offset && t2 < -offset)
+		{
+			RecursiveTrace(work, node.m_children[1], startFrac, endFrac, p1, p2);
+			return;
+		}
+
+		// Split the segment, with the near part covering up to the far side
+		// of the plane including the box offset, and the far part covering
+		// everything after the near side.
+		size_t nearSide = 0;
+		float nearFrac = 1.0f;
+		float farFrac = 0.0f;
+
+		if (t1 < t2)
+		{
+			const float invDist = 1.0f / (t1 - t2);
+			nearSide = 1;
+			farFrac = (t1 + offset + priv::kBSPTraceDistEpsilon) * invDist;
+			nearFrac = (t1 - offset + priv::kBSPTraceDistEpsilon) * invDist;
+		}
+		else if (t1 > t2)
+		{
+			const float invDist = 1.0f / (t1 - t2);
+			nearSide = 0;
+			farFrac = (t1 - offset - priv::kBSPTraceDistEpsilon) * invDist;
+			nearFrac = (t1 + offset + priv::kBSPTraceDistEpsilon) * invDist;
+		}
+
+		nearFrac = rkit::Max(0.0f, rkit::Min(1.0f, nearFrac));
+		farFrac = rkit::Max(0.0f, rkit::Min(1.0f, farFrac));
+
+		float mid[3];
+
+		{
+			const float midFrac = startFrac + (endFrac - startFrac) * nearFrac;
+			for (size_t axis = 0; axis < 3; axis++)
+				mid[axis] = p1[axis] + nearFrac * (p2[axis] - p1[axis]);
+
+			RecursiveTrace(work, node.m_children[nearSide], startFrac, midFrac, p1, mid);
+		}
+
+		{
+			const float midFrac = startFrac + (endFrac - startFrac) * farFrac;
+			for (size_t axis = 0; axis < 3; axis++)
+				mid[axis] = p1[axis] + farFrac * (p2[axis] - p1[axis]);
+
+			RecursiveTrace(work, node.m_children[nearSide ^ 1u], midFrac, endFrac, mid, p2);
+		}
+	}
+
+	void AnoxBSPCollisionModel::TraceToLeaf(TraceWork &work, uint32_t leafIndex) const
+	{
+		const CollisionLeaf &leaf = m_leafs[leafIndex];
+
+		if ((leaf.m_contents & work.m_contentsMask) == 0)
+			return;
+
+		const uint16_t *leafBrushes = m_leafBrushes.GetBuffer() + leaf.m_firstLeafBrush;
+
+		for (uint32_t i = 0; i < leaf.m_numLeafBrushes; i++)
+		{
+			const uint32_t brushIndex = leafBrushes[i];
+
+			// Brushes are frequently shared by neighboring leafs, skip ones that
+			// were recently tested
+			uint32_t &cacheEntry = work.m_brushCache[brushIndex % kBrushCacheSize];
+			if (cacheEntry == brushIndex + 1u)
+				continue;
+
+			cacheEntry = brushIndex + 1u;
+
+			const CollisionBrush &brush = m_brushes[brushIndex];
+			if ((brush.m_contents & work.m_contentsMask) == 0 || brush.m_numSides == 0)
+				continue;
+
+			ClipToBrush(work, brush);
+
+			if (work.m_allSolid)
+				return;
+		}
+	}
+
+	void AnoxBSPCollisionModel::ClipToBrush(TraceWork &work, const CollisionBrush &brush) const
+	{
+		float enterFrac = -1.0f;
+		float leaveFrac = 1.0f;
+		const CollisionBrushSide *leadSide = nullptr;
+
+		bool getsOut = false;
+		bool startsOut = false;
+
+		const CollisionBrushSide *sides = m_brushSides.GetBuffer() + brush.m_firstSide;
+
+		for (uint32_t i = 0; i < brush.m_numSides; i++)
+		{
+			const CollisionBrushSide &side = sides[i];
+			const CollisionPlane &plane = side.m_plane;
+
+			float dist = plane.m_dist;
+			if (!work.m_isPoint)
+			{
+				dist += rkit::math::Absf(plane.m_normal[0]) * work.m_extents[0]
+					+ rkit::math::Absf(plane.m_normal[1]) * work.m_extents[1]
+					+ rkit::math::Absf(plane.m_normal[2]) * work.m_extents[2];
+			}
+
+			const float d1 = plane.m_normal[0] * work.m_start[0] + plane.m_normal[1] * work.m_start[1] + plane.m_normal[2] * work.m_start[2] - dist;
+			const float d2 = plane.m_normal[0] * work.m_end[0] + plane.m_normal[1] * work.m_end[1] + plane.m_normal[2] * work.m_end[2] - dist;
+
+			if (d2 > 0.0f)
+				getsOut = true;
+			if (d1 > 0.0f)
+				startsOut = true;
+
+			// Completely in front of this side, so can't touch the brush
+			if (d1 > 0.0f && d2 >= d1)
+				return;
+
+			// Completely behind this side
+			if (d1 <= 0.0f && d2 <= 0.0f)
+				continue;
+
+			if (d1 > d2)
+			{
+				const float f = (d1 - priv::kBSPTraceDistEpsilon) / (d1 - d2);
+				if (f > enterFrac)
+				{
+					enterFrac = f;
+					leadSide = &side;
+				}
+			}
+			else
+			{
+				const float f = (d1 + priv::kBSPTraceDistEpsilon) / (d1 - d2);
+				if (f < leaveFrac)
+					leaveFrac = f;
+			}
+		}
+
+		if (!startsOut)
+		{
+			work.m_startSolid = true;
+			work.m_solidContents = brush.m_contents;
+
+			if (!getsOut)
+				work.m_allSolid = true;
+
+			return;
+		}
+
+		if (enterFrac < leaveFrac && enterFrac > -1.0f && enterFrac < work.m_fraction)
+		{
+			work.m_fraction = rkit::Max(0.0f, enterFrac);
+			work.m_hitSide = leadSide;
+			work.m_hitBrush = &brush;
+		}
+	}
+
+	bool AnoxBSPCollisionModel::SweptBoxOverlaps(const TraceWork &work, const float (&p1)[3], const float (&p2)[3], const float (&mins)[3], const float (&maxs)[3])
+	{
+		for (size_t axis = 0; axis < 3; axis++)
+		{
+			const float pad = work.m_extents[axis] + priv::kBSPTraceDistEpsilon;
+
+			if (rkit::Min(p1[axis], p2[axis]) - pad > maxs[axis])
+				return false;
+
+			if (rkit::Max(p1[axis], p2[axis]) + pad < mins[axis])
+				return false;
+		}
+
+		return true;
+	}
+
+	void AnoxBSPCollisionModel::ConvertPlane(CollisionPlane &outPlane, const rkit::math::Vec3 &normal, float dist, bool flip)
+	{
+		if (flip)
+		{
+			for (size_t axis = 0; axis < 3; axis++)
+				outPlane.m_normal[axis] = -normal[axis];
+
+			outPlane.m_dist = -dist;
+		}
+		else
+		{
+			for (size_t axis = 0; axis < 3; axis++)
+				outPlane.m_normal[axis] = normal[axis];
+
+			outPlane.m_dist = dist;
+		}
+	}
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+	namespace priv
+	{
+		inline __m128 SSESelect(__m128 mask, __m128 a, __m128 b)
+		{
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+
+		inline __m128i SSESelectInt(__m128 mask, __m128i a, __m128i b)
+		{
+			const __m128i maskI = _mm_castps_si128(mask);
+			return _mm_or_si128(_mm_and_si128(maskI, a), _mm_andnot_si128(maskI, b));
+		}
+
+		inline __m128 SSELaneMaskToVector(int laneMask)
+		{
+			const __m128i laneBits = _mm_set_epi32(8, 4, 2, 1);
+			const __m128i selected = _mm_and_si128(_mm_set1_epi32(laneMask), laneBits);
+			return _mm_castsi128_ps(_mm_cmpeq_epi32(selected, laneBits));
+		}
+
+		inline __m128 SSEDot3(const __m128 (&v)[3], float nx, float ny, float nz, float dist)
+		{
+			const __m128 x = _mm_mul_ps(v[0], _mm_set1_ps(nx));
+			const __m128 y = _mm_mul_ps(v[1], _mm_set1_ps(ny));
+			const __m128 z = _mm_mul_ps(v[2], _mm_set1_ps(nz));
+
+			return _mm_sub_ps(_mm_add_ps(_mm_add_ps(x, y), z), _mm_set1_ps(dist));
+		}
+	}
+
+	void AnoxBSPCollisionModel::TracePacket(const rkit::Span<BSPTraceResult> &outResults, uint32_t root, const rkit::Span<const BSPTraceRay> &rays, uint32_t contentsMask) const
+	{
+		const size_t numRays = rays.Count();
+		RKIT_ASSERT(numRays >= 1 && numRays <= 4);
+
+		PacketTraceWork work;
+
+		// Unused lanes duplicate the last ray and are masked off
+		float laneValues[6][4];
+		for (size_t lane = 0; lane < 4; lane++)
+		{
+			const BSPTraceRay &ray = rays[rkit::Min(lane, numRays - 1)];
+
+			for (size_t axis = 0; axis < 3; axis++)
+			{
+				laneValues[axis][lane] = ray.m_start[axis];
+				laneValues[axis + 3][lane] = ray.m_end[axis];
+			}
+		}
+
+		for (size_t axis = 0; axis < 3; axis++)
+		{
+			work.m_start[axis] = _mm_loadu_ps(laneValues[axis]);
+			work.m_end[axis] = _mm_loadu_ps(laneValues[axis + 3]);
+			work.m_delta[axis] = _mm_sub_ps(work.m_end[axis], work.m_start[axis]);
+		}
+
+		work.m_fraction = _mm_set1_ps(1.0f);
+		work.m_contentsMask = contentsMask;
+
+		for (size_t lane = 0; lane < 4; lane++)
+		{
+			work.m_hitSides[lane] = nullptr;
+			work.m_hitBrushes[lane] = nullptr;
+			work.m_solidContents[lane] = 0;
+			work.m_startSolid[lane] = false;
+			work.m_allSolid[lane] = false;
+		}
+
+		for (PacketTraceWork::BrushCacheEntry &cacheEntry : work.m_brushCache)
+		{
+			cacheEntry.m_brushIndexPlusOne = 0;
+			cacheEntry.m_testedLanes = 0;
+		}
+
+		const int activeMask = static_cast<int>((1u << numRays) - 1u);
+
+		RecursivePacketTrace(work, root, activeMask);
+
+		float fractions[4];
+		_mm_storeu_ps(fractions, work.m_fraction);
+
+		for (size_t lane = 0; lane < numRays; lane++)
+		{
+			BSPTraceResult &outResult = outResults[lane];
+			const BSPTraceRay &ray = rays[lane];
+
+			outResult = BSPTraceResult();
+
+			const float fraction = work.m_allSolid[lane] ? 0.0f : fractions[lane];
+
+			outResult.m_fraction = fraction;
+			outResult.m_endPos = ray.m_start + (ray.m_end - ray.m_start) * fraction;
+			outResult.m_startSolid = work.m_startSolid[lane];
+			outResult.m_allSolid = work.m_allSolid[lane];
+
+			const CollisionBrushSide *hitSide = work.m_hitSides[lane];
+			if (hitSide)
+			{
+				outResult.m_planeNormal = rkit::math::Vec3::FromArray(hitSide->m_plane.m_normal);
+				outResult.m_planeDist = hitSide->m_plane.m_dist;
+				outResult.m_material = hitSide->m_material;
+				outResult.m_materialFlags = hitSide->m_materialFlags;
+				outResult.m_contents = work.m_hitBrushes[lane]->m_contents;
+			}
+			else if (work.m_startSolid[lane])
+				outResult.m_contents = work.m_solidContents[lane];
+		}
+	}
+
+	void AnoxBSPCollisionModel::RecursivePacketTrace(PacketTraceWork &work, uint32_t nodeRef, int activeMask) const
+	{
+		const float *mins = nullptr;
+		const float *maxs = nullptr;
+
+		const CollisionNode *node = nullptr;
+		const CollisionLeaf *leaf = nullptr;
+
+		if (nodeRef & kLeafBit)
+		{
+			leaf = &m_leafs[nodeRef & ~kLeafBit];
+
+			if ((leaf->m_contents & work.m_contentsMask) == 0)
+				return;
+
+			mins = leaf->m_mins;
+			maxs = leaf->m_maxs;
+		}
+		else
+		{
+			node = &m_nodes[nodeRef];
+			mins = node->m_mins;
+			maxs = node->m_maxs;
+		}
+
+		// Cull lanes whose remaining segment misses the bounds.  Segments are
+		// shortened to the nearest hit so far.
+		__m128 curEnd[3];
+		__m128 overlaps = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+		const __m128 epsilon = _mm_set1_ps(priv::kBSPTraceDistEpsilon);
+
+		for (size_t axis = 0; axis < 3; axis++)
+		{
+			curEnd[axis] = _mm_add_ps(work.m_start[axis], _mm_mul_ps(work.m_delta[axis], work.m_fraction));
+
+			const __m128 segMin = _mm_sub_ps(_mm_min_ps(work.m_start[axis], curEnd[axis]), epsilon);
+			const __m128 segMax = _mm_add_ps(_mm_max_ps(work.m_start[axis], curEnd[axis]), epsilon);
+
+			overlaps = _mm_and_ps(overlaps, _mm_cmple_ps(segMin, _mm_set1_ps(maxs[axis])));
+			overlaps = _mm_and_ps(overlaps, _mm_cmpge_ps(segMax, _mm_set1_ps(mins[axis])));
+		}
+
+		activeMask &= _mm_movemask_ps(overlaps);
+		if (activeMask == 0)
+			return;
+
+		if (leaf)
+		{
+			PacketTraceToLeaf(work, nodeRef & ~kLeafBit, activeMask);
+			return;
+		}
+
+		const CollisionPlane &plane = node->m_plane;
+
+		const __m128 d1 = priv::SSEDot3(work.m_start, plane.m_normal[0], plane.m_normal[1], plane.m_normal[2], plane.m_dist);
+		const __m128 d2 = priv::SSEDot3(curEnd, plane.m_normal[0], plane.m_normal[1], plane.m_normal[2], plane.m_dist);
+
+		const __m128 negEpsilon = _mm_set1_ps(-priv::kBSPTraceDistEpsilon);
+
+		// Since brush clipping always uses the whole ray, segments are not split
+		// here, they only need to visit every leaf they touch.
+		const int frontMask = activeMask & _mm_movemask_ps(_mm_or_ps(_mm_cmpge_ps(d1, negEpsilon), _mm_cmpge_ps(d2, negEpsilon)));
+		const int backMask = activeMask & _mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(d1, epsilon), _mm_cmplt_ps(d2, epsilon)));
+
+		// Visit the side containing most ray starts first, so hits there can
+		// cull the far side
+		const int startsInFrontMask = activeMask & _mm_movemask_ps(_mm_cmpge_ps(d1, _mm_setzero_ps()));
+		const int startsInBackMask = activeMask & ~startsInFrontMask;
+
+		const int numStartsInFront = rkit::CountSetBits(static_cast<uint32_t>(startsInFrontMask));
+		const int numStartsInBack = rkit::CountSetBits(static_cast<uint32_t>(startsInBackMask));
+
+		const uint32_t nearSide = (numStartsInBack > numStartsInFront) ? 1 : 0;
+		const int nearMask = nearSide ? backMask : frontMask;
+		const int farMask = nearSide ? frontMask : backMask;
+
+		if (nearMask)
+			RecursivePacketTrace(work, node->m_children[nearSide], nearMask);
+
+		if (farMask)
+			RecursivePacketTrace(work, node->m_children[nearSide ^ 1u], farMask);
+	}
+
+	void AnoxBSPCollisionModel::PacketTraceToLeaf(PacketTraceWork &work, uint32_t leafIndex, int activeMask) const
+	{
+		const CollisionLeaf &leaf = m_leafs[leafIndex];
+		const uint16_t *leafBrushes = m_leafBrushes.GetBuffer() + leaf.m_firstLeafBrush;
+
+		for (uint32_t i = 0; i < leaf.m_numLeafBrushes; i++)
+		{
+			const uint32_t brushIndex = leafBrushes[i];
+
+			// Brushes shared with other leafs may have already been tested by
+			// some of the lanes, only test the remaining ones
+			PacketTraceWork::BrushCacheEntry &cacheEntry = work.m_brushCache[brushIndex % kBrushCacheSize];
+
+			int lanesToTest = activeMask;
+			if (cacheEntry.m_brushIndexPlusOne == brushIndex + 1u)
+			{
+				lanesToTest &= ~cacheEntry.m_testedLanes;
+				if (lanesToTest == 0)
+					continue;
+
+				cacheEntry.m_testedLanes |= lanesToTest;
+			}
+			else
+			{
+				cacheEntry.m_brushIndexPlusOne = brushIndex + 1u;
+				cacheEntry.m_testedLanes = lanesToTest;
+			}
+
+			const CollisionBrush &brush = m_brushes[brushIndex];
+			if ((brush.m_contents & work.m_contentsMask) == 0 || brush.m_numSides == 0)
+				continue;
+
+			ClipPacketToBrush(work, lanesToTest, brushIndex);
+		}
+	}
+
+	void AnoxBSPCollisionModel::ClipPacketToBrush(PacketTraceWork &work, int activeMask, uint32_t brushIndex) const
+	{
+		const CollisionBrush &brush = m_brushes[brushIndex];
+		const CollisionBrushSide *sides = m_brushSides.GetBuffer() + brush.m_firstSide;
+
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 epsilon = _mm_set1_ps(priv::kBSPTraceDistEpsilon);
+
+		__m128 enterFrac = _mm_set1_ps(-1.0f);
+		__m128 leaveFrac = _mm_set1_ps(1.0f);
+		__m128i leadSide = _mm_set1_epi32(-1);
+
+		__m128 getsOut = zero;
+		__m128 startsOut = zero;
+		__m128 outside = zero;
+
+		for (uint32_t i = 0; i < brush.m_numSides; i++)
+		{
+			const CollisionPlane &plane = sides[i].m_plane;
+
+			const __m128 d1 = priv::SSEDot3(work.m_start, plane.m_normal[0], plane.m_normal[1], plane.m_normal[2], plane.m_dist);
+			const __m128 d2 = priv::SSEDot3(work.m_end, plane.m_normal[0], plane.m_normal[1], plane.m_normal[2], plane.m_dist);
+
+			const __m128 d1InFront = _mm_cmpgt_ps(d1, zero);
+
+			getsOut = _mm_or_ps(getsOut, _mm_cmpgt_ps(d2, zero));
+			startsOut = _mm_or_ps(startsOut, d1InFront);
+			outside = _mm_or_ps(outside, _mm_and_ps(d1InFront, _mm_cmpge_ps(d2, d1)));
+
+			if ((_mm_movemask_ps(outside) & activeMask) == activeMask)
+				return;
+
+			const __m128 crosses = _mm_or_ps(d1InFront, _mm_cmpgt_ps(d2, zero));
+			const __m128 invDist = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sub_ps(d1, d2));
+
+			const __m128 entering = _mm_and_ps(crosses, _mm_cmpgt_ps(d1, d2));
+			const __m128 leaving = _mm_and_ps(crosses, _mm_cmplt_ps(d1, d2));
+
+			const __m128 enterCandidate = _mm_mul_ps(_mm_sub_ps(d1, epsilon), invDist);
+			const __m128 leaveCandidate = _mm_mul_ps(_mm_add_ps(d1, epsilon), invDist);
+
+			const __m128 improvesEnter = _mm_and_ps(entering, _mm_cmpgt_ps(enterCandidate, enterFrac));
+			const __m128 improvesLeave = _mm_and_ps(leaving, _mm_cmplt_ps(leaveCandidate, leaveFrac));
+
+			enterFrac = priv::SSESelect(improvesEnter, enterCandidate, enterFrac);
+			leadSide = priv::SSESelectInt(improvesEnter, _mm_set1_epi32(static_cast<int32_t>(i)), leadSide);
+			leaveFrac = priv::SSESelect(improvesLeave, leaveCandidate, leaveFrac);
+		}
+
+		activeMask &= ~_mm_movemask_ps(outside);
+
+		const int startsOutMask = _mm_movemask_ps(startsOut);
+		const int solidLanes = activeMask & ~startsOutMask;
+
+		if (solidLanes)
+		{
+			const int getsOutMask = _mm_movemask_ps(getsOut);
+
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if ((solidLanes & (1 << lane)) == 0)
+					continue;
+
+				work.m_startSolid[lane] = true;
+				work.m_solidContents[lane] = brush.m_contents;
+
+				if ((getsOutMask & (1 << lane)) == 0)
+					work.m_allSolid[lane] = true;
+			}
+
+			// All-solid lanes have nothing further to find
+			const __m128 allSolidVector = priv::SSELaneMaskToVector(solidLanes & ~getsOutMask);
+			work.m_fraction = priv::SSESelect(allSolidVector, zero, work.m_fraction);
+		}
+
+		const __m128 hits = _mm_and_ps(
+			_mm_and_ps(_mm_cmplt_ps(enterFrac, leaveFrac), _mm_cmpgt_ps(enterFrac, _mm_set1_ps(-1.0f))),
+			_mm_cmplt_ps(enterFrac, work.m_fraction));
+
+		const int hitLanes = activeMask & startsOutMask & _mm_movemask_ps(hits);
+		if (hitLanes == 0)
+			return;
+
+		work.m_fraction = priv::SSESelect(priv::SSELaneMaskToVector(hitLanes), _mm_max_ps(enterFrac, zero), work.m_fraction);
+
+		int32_t leadSides[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(leadSides), leadSide);
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			if ((hitLanes & (1 << lane)) == 0)
+				continue;
+
+			work.m_hitSides[lane] = sides + leadSides[lane];
+			work.m_hitBrushes[lane] = &brush;
+		}
+	}
+#endif
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "rkit/Core/CoreDefs.h"
+#include "rkit/Core/Vector.h"
+
+#include "rkit/Math/Vec.h"
+
+#include "AnoxBSPModelResource.h"
+
+namespace rkit
+{
+	template<class T>
+	class Span;
+}
+
+namespace anox
+{
+	struct BSPTraceResult
+	{
+		float m_fraction = 1.0f;
+		rkit::math::Vec3 m_endPos;
+
+		rkit::math::Vec3 m_planeNormal;
+		float m_planeDist = 0.0f;
+
+		uint32_t m_contents = 0;
+		uint32_t m_material = 0;
+		uint32_t m_materialFlags = 0;
+
+		bool m_startSolid = false;
+		bool m_allSolid = false;
+	};
+
+	struct BSPTraceRay
+	{
+		rkit::math::Vec3 m_start;
+		rkit::math::Vec3 m_end;
+	};
+
+	// Collision queries over the BSP tree and brushes of a loaded map.  All
+	// queries are const and keep their working state on the stack, so they
+	// can be issued concurrently from any number of jobs.
+	class AnoxBSPCollisionModel
+	{
+	public:
+		struct SourceData
+		{
+			rkit::Span<const rkit::math::Vec3> m_normals;
+			rkit::Span<const AnoxBSPModelResourceBase::Plane> m_planes;
+			rkit::Span<const AnoxBSPModelResourceBase::TreeNode> m_treeNodes;
+			rkit::Span<const AnoxBSPModelResourceBase::Leaf> m_leafs;
+			rkit::Span<const uint16_t> m_leafBrushes;
+			rkit::Span<const AnoxBSPModelResourceBase::Brush> m_brushes;
+			rkit::Span<const AnoxBSPModelResourceBase::BrushSide> m_brushSides;
+			rkit::Span<const AnoxBSPModelResourceBase::Model> m_models;
+		};
+
+		rkit::Result Initialize(const SourceData &sourceData);
+
+		size_t GetModelCount() const;
+		void GetModelBounds(size_t modelIndex, rkit::math::Vec3 &outMins, rkit::math::Vec3 &outMaxs) const;
+
+		uint32_t PointContents(size_t modelIndex, const rkit::math::Vec3 &point) const;
+
+		void TraceRay(BSPTraceResult &outResult, size_t modelIndex, const rkit::math::Vec3 &start, const rkit::math::Vec3 &end, uint32_t contentsMask) const;
+		void TraceBox(BSPTraceResult &outResult, size_t modelIndex, const rkit::math::Vec3 &start, const rkit::math::Vec3 &end,
+			const rkit::math::Vec3 &mins, const rkit::math::Vec3 &maxs, uint32_t contentsMask) const;
+
+		// Traces many rays at once.  Where SIMD is available, rays are traversed
+		// in packets that share node visits and brush tests.
+		void TraceRays(const rkit::Span<BSPTraceResult> &outResults, size_t modelIndex, const rkit::Span<const BSPTraceRay> &rays, uint32_t contentsMask) const;
+
+	private:
+		static const uint32_t kLeafBit = 0x80000000u;
+		static const size_t kBrushCacheSize = 64;
+
+		struct CollisionPlane
+		{
+			float m_normal[3];
+			float m_dist;
+		};
+
+		struct CollisionNode
+		{
+			CollisionPlane m_plane;
+			float m_mins[3];
+			float m_maxs[3];
+
+			// Front and back, with kLeafBit set for leafs
+			uint32_t m_children[2];
+		};
+
+		struct CollisionLeaf
+		{
+			float m_mins[3];
+			float m_maxs[3];
+
+			uint32_t m_contents;
+			uint32_t m_firstLeafBrush;
+			uint32_t m_numLeafBrushes;
+		};
+
+		struct CollisionBrush
+		{
+			uint32_t m_firstSide;
+			uint32_t m_numSides;
+			uint32_t m_contents;
+		};
+
+		struct CollisionBrushSide
+		{
+			CollisionPlane m_plane;
+			uint32_t m_material;
+			uint32_t m_materialFlags;
+		};
+
+		struct CollisionModel
+		{
+			uint32_t m_root;
+			float m_mins[3];
+			float m_maxs[3];
+		};
+
+		struct TraceWork;
+		struct PacketTraceWork;
+
+		void TraceGeneral(BSPTraceResult &outResult, size_t modelIndex, const rkit::math::Vec3 &start, const rkit::math::Vec3 &end,
+			const float (&extents)[3], const float (&centerOffset)[3], uint32_t contentsMask) const;
+
+		void RecursiveTrace(TraceWork &work, uint32_t nodeRef, float startFrac, float endFrac, const float (&p1)[3], const float (&p2)[3]) const;
+		void TraceToLeaf(TraceWork &work, uint32_t leafIndex) const;
+		void ClipToBrush(TraceWork &work, const CollisionBrush &brush) const;
+
+		static bool SweptBoxOverlaps(const TraceWork &work, const float (&p1)[3], const float (&p2)[3], const float (&mins)[3], const float (&maxs)[3]);
+		static void ConvertPlane(CollisionPlane &outPlane, const rkit::math::Vec3 &normal, float dist, bool flip);
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+		void TracePacket(const rkit::Span<BSPTraceResult> &outResults, uint32_t root, const rkit::Span<const BSPTraceRay> &rays, uint32_t contentsMask) const;
+		void RecursivePacketTrace(PacketTraceWork &work, uint32_t nodeRef, int activeMask) const;
+		void PacketTraceToLeaf(PacketTraceWork &work, uint32_t leafIndex, int activeMask) const;
+		void ClipPacketToBrush(PacketTraceWork &work, int activeMask, uint32_t brushIndex) const;
+#endif
+
+		rkit::Vector<CollisionNode> m_nodes;
+		rkit::Vector<CollisionLeaf> m_leafs;
+		rkit::Vector<uint16_t> m_leafBrushes;
+		rkit::Vector<CollisionBrush> m_brushes;
+		rkit::Vector<CollisionBrushSide> m_brushSides;
+		rkit::Vector<CollisionModel> m_models;
+	};
+}
@@ -1,4 +1,5 @@
 #include "AnoxBSPModelResource.h"
+#include "AnoxBSPCollision.h"
 #include "AnoxMaterialResource.h"
 #include "AnoxAbstractSingleFileResource.h"
 #include "AnoxGameFileSystem.h"
@@ -33,6 +34,8 @@ namespace anox
 	public:
 		friend struct AnoxBSPModelLoaderInfo;
 
+		const AnoxBSPCollisionModel &GetCollisionModel() const override;
+
 	private:
 		rkit::Vector<rkit::math::Vec3> m_normals;
 		rkit::Vector<Plane> m_planes;
@@ -50,6 +53,8 @@ namespace anox
 		rkit::Vector<DrawCluster> m_drawClusters;
 		rkit::Vector<DrawClusterModelGroupRef> m_drawClusterModelGroupRefs;
 
+		AnoxBSPCollisionModel m_collisionModel;
+
 		rkit::RCPtr<IBuffer> m_vertexBuffer;
 		rkit::RCPtr<IBuffer> m_indexBuffer;
 		rkit::RCPtr<IBuffer> m_normalsBuffer;
@@ -291,8 +296,9 @@ namespace anox
 						}
 
 						uint32_t planeValue = inNode.m_plane.Get();
-						outNode.m_planeIndex = rkit::sanitizers::SanitizeClampUInt(planeValue >> 1, numPlanes - 1);
-						outNode.m_planeFlip = (planeValue & 1);
+						// Node planes are stored unflipped, the children are swapped instead
+						outNode.m_planeIndex = rkit::sanitizers::SanitizeClampUInt(planeValue, numPlanes - 1);
+						outNode.m_planeFlip = 0;
 
 						const uint8_t splitByte = (splitBytes[nodeIndex >> 2] >> ((nodeIndex & 3) * 2)) & 3;
 
@@ -949,6 +955,18 @@ namespace anox
 
 	rkit::Result AnoxBSPModelLoaderInfo::LoadContents(State_t &state, Resource_t &resource)
 	{
+		AnoxBSPCollisionModel::SourceData collisionSource;
+		collisionSource.m_normals = resource.m_normals.ToSpan();
+		collisionSource.m_planes = resource.m_planes.ToSpan();
+		collisionSource.m_treeNodes = resource.m_treeNodes.ToSpan();
+		collisionSource.m_leafs = resource.m_leafs.ToSpan();
+		collisionSource.m_leafBrushes = resource.m_leafBrushes.ToSpan();
+		collisionSource.m_brushes = resource.m_brushes.ToSpan();
+		collisionSource.m_brushSides = resource.m_brushSides.ToSpan();
+		collisionSource.m_models = resource.m_models.ToSpan();
+
+		RKIT_CHECK(resource.m_collisionModel.Initialize(collisionSource));
+
 		RKIT_RETURN_OK;
 	}
 
@@ -1001,6 +1019,11 @@ namespace anox
 		RKIT_RETURN_OK;
 	}
 
+	const AnoxBSPCollisionModel &AnoxBSPModelResource::GetCollisionModel() const
+	{
+		return m_collisionModel;
+	}
+
 	rkit::Result AnoxBSPModelResourceLoaderBase::Create(rkit::RCPtr<AnoxBSPModelResourceLoaderBase> &outLoader)
 	{
 		typedef AnoxAbstractSingleFileResourceLoader<AnoxBSPModelLoaderInfo> Loader_t;
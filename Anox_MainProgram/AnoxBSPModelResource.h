@@ -12,6 +12,7 @@ namespace rkit
 
 namespace anox
 {
+	class AnoxBSPCollisionModel;
 	class AnoxBSPModelResourceBase;
 
 	class AnoxBSPModelResourceLoaderBase : public AnoxCIPathKeyedResourceLoader<AnoxBSPModelResourceBase>
@@ -136,5 +137,7 @@ namespace anox
 			uint32_t m_clusterIndex;
 			uint32_t m_modelGroupIndex;
 		};
+
+		virtual const AnoxBSPCollisionModel &GetCollisionModel() const = 0;
 	};
 }
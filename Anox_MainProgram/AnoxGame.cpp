@@ -40,7 +40,7 @@ namespace anox
 	class AnoxGame final : public IAnoxGame
 	{
 	public:
-		explicit AnoxGame(const rkit::Optional<uint16_t> &numThreads);
+		AnoxGame(const rkit::Optional<uint16_t> &numThreads, RenderBackend renderBackend);
 		~AnoxGame();
 
 		rkit::Result Start() override;
@@ -74,13 +74,15 @@ namespace anox
 		rkit::data::IDataDriver *m_dataDriver = nullptr;
 
 		rkit::Optional<uint16_t> m_numThreadsOverride;
+		RenderBackend m_renderBackend;
 	};
 }
 
 namespace anox
 {
-	AnoxGame::AnoxGame(const rkit::Optional<uint16_t> &numThreads)
+	AnoxGame::AnoxGame(const rkit::Optional<uint16_t> &numThreads, RenderBackend renderBackend)
 		: m_numThreadsOverride(numThreads)
+		, m_renderBackend(renderBackend)
 	{
 	}
 
@@ -119,7 +121,8 @@ namespace anox
 			RKIT_THROW(rkit::ResultCode::kModuleLoadFailed);
 		}
 
-		uint32_t numWorkThreads = rkit::GetDrivers().m_systemDriver->GetProcessorCount() - 1;
+		// The main thread runs main-thread jobs between frames
+		uint32_t numWorkThreads = rkit::GetDrivers().m_utilitiesDriver->ComputeThreadPoolSize(true);
 
 		if (m_numThreadsOverride.IsSet())
 			numWorkThreads = m_numThreadsOverride.Get() - 1;
@@ -140,7 +143,7 @@ namespace anox
 		RKIT_CHECK(ICaptureHarness::CreateRealTime(m_captureHarness, *this, *m_resourceManager, std::move(emptyConfig)));
 
 		RKIT_CHECK(AudioSubsystem::Create(m_audioSubsystem, *m_threadPool->GetJobQueue()));
-		RKIT_CHECK(IGraphicsSubsystem::Create(m_graphicsSubsystem, *m_fileSystem, *m_dataDriver, *m_threadPool, anox::RenderBackend::kVulkan));
+		RKIT_CHECK(IGraphicsSubsystem::Create(m_graphicsSubsystem, *m_fileSystem, *m_dataDriver, *m_threadPool, m_renderBackend));
 
 		m_resourceManager->SetGraphicsSubsystem(m_graphicsSubsystem.Get());
 
@@ -229,8 +232,8 @@ namespace anox
 		CORO_RETURN_OK;
 	}
 
-	rkit::Result anox::IAnoxGame::Create(rkit::UniquePtr<IAnoxGame> &outGame, const rkit::Optional<uint16_t> &numThreads)
+	rkit::Result anox::IAnoxGame::Create(rkit::UniquePtr<IAnoxGame> &outGame, const rkit::Optional<uint16_t> &numThreads, RenderBackend renderBackend)
 	{
-		return rkit::New<AnoxGame>(outGame, numThreads);
+		return rkit::New<AnoxGame>(outGame, numThreads, renderBackend);
 	}
 }
@@ -13,11 +13,15 @@
 #include "rkit/Core/Pair.h"
 #include "rkit/Core/Path.h"
 #include "rkit/Core/String.h"
+#include "rkit/Core/SystemDriver.h"
 #include "rkit/Core/UtilitiesDriver.h"
+#include "rkit/Core/Vector.h"
+#include "rkit/Core/XorShift.h"
 
 #include "rkit/Sandbox/Sandbox.h"
 #include "rkit/Sandbox/ThreadCreationParameters.h"
 
+#include "AnoxBSPCollision.h"
 #include "AnoxBSPModelResource.h"
 #include "AnoxCaptureHarness.h"
 #include "AnoxCommandRegistry.h"
@@ -122,6 +126,10 @@ namespace anox
 
 		rkit::ResultCoroutine Cmd_Exec(rkit::ICoroThread &thread, AnoxCommandStackBase &commandStack, const rkit::ISpan<rkit::ByteStringView> &args);
 		rkit::ResultCoroutine Cmd_Map(rkit::ICoroThread &thread, AnoxCommandStackBase &commandStack, const rkit::ISpan<rkit::ByteStringView> &args);
+#if !RKIT_IS_FINAL
+		rkit::ResultCoroutine Cmd_TraceBench(rkit::ICoroThread &thread, AnoxCommandStackBase &commandStack, const rkit::ISpan<rkit::ByteStringView> &args);
+		rkit::ResultCoroutine Cmd_WorldBench(rkit::ICoroThread &thread, AnoxCommandStackBase &commandStack, const rkit::ISpan<rkit::ByteStringView> &args);
+#endif
 
 		IAnoxGame *m_game;
 		rkit::UniquePtr<rkit::ICoroThread> m_mainCoroThread;
@@ -191,6 +199,11 @@ namespace anox
 		RKIT_CHECK(m_game->GetCommandRegistry()->RegisterMemberFuncCommand<&AnoxGameLogic::Cmd_Exec>(u8"exec", this));
 		RKIT_CHECK(m_game->GetCommandRegistry()->RegisterMemberFuncCommand<&AnoxGameLogic::Cmd_Map>(u8"map", this));
 
+#if !RKIT_IS_FINAL
+		RKIT_CHECK(m_game->GetCommandRegistry()->RegisterMemberFuncCommand<&AnoxGameLogic::Cmd_TraceBench>(u8"bsp_tracebench", this));
+		RKIT_CHECK(m_game->GetCommandRegistry()->RegisterMemberFuncCommand<&AnoxGameLogic::Cmd_WorldBench>(u8"world_bench", this));
+#endif
+
 		RKIT_CHECK(AnoxCommandStackBase::Create(m_commandStack, 64 * 1024, 1024));
 
 		RKIT_CHECK(rkit::utils::CreateCoroThread(m_mainCoroThread, rkit::GetDrivers().m_mallocDriver.Get(), 1 * 1024 * 1024, rkit::GetDrivers().GetAssertDriver()));
@@ -559,6 +572,157 @@ namespace anox
 		CORO_RETURN_OK;
 	}
 
+#if !RKIT_IS_FINAL
+	rkit::ResultCoroutine AnoxGameLogic::Cmd_TraceBench(rkit::ICoroThread &thread, AnoxCommandStackBase &cmdStack, const rkit::ISpan<rkit::ByteStringView> &args)
+	{
+		uint32_t numRays = 100000;
+
+		if (args.Count() >= 1)
+		{
+			if (!rkit::GetDrivers().m_utilitiesDriver->ParseUInt32(args[0], 10, numRays) || numRays == 0)
+			{
+				rkit::log::Error(u8"Usage: bsp_tracebench [ray count]");
+				CORO_RETURN_OK;
+			}
+		}
+
+		if (!m_bspModel.IsValid())
+		{
+			rkit::log::Error(u8"bsp_tracebench requires a loaded map");
+			CORO_RETURN_OK;
+		}
+
+		const AnoxBSPCollisionModel &collision = m_bspModel->GetCollisionModel();
+		if (collision.GetModelCount() == 0)
+		{
+			rkit::log::Error(u8"Map has no collision models");
+			CORO_RETURN_OK;
+		}
+
+		rkit::math::Vec3 mins;
+		rkit::math::Vec3 maxs;
+		collision.GetModelBounds(0, mins, maxs);
+
+		rkit::Vector<BSPTraceRay> rays;
+		rkit::Vector<BSPTraceResult> scalarResults;
+		rkit::Vector<BSPTraceResult> packetResults;
+
+		CORO_CHECK(rays.Resize(numRays));
+		CORO_CHECK(scalarResults.Resize(numRays));
+		CORO_CHECK(packetResults.Resize(numRays));
+
+		rkit::XorShift32 rng;
+		const rkit::math::Vec3 extent = maxs - mins;
+
+		for (BSPTraceRay &ray : rays)
+		{
+			float coords[6];
+			for (float &coord : coords)
+				coord = rng.NextUnitFloat();
+
+			ray.m_start = mins + extent * rkit::math::Vec3(coords[0], coords[1], coords[2]);
+			ray.m_end = mins + extent * rkit::math::Vec3(coords[3], coords[4], coords[5]);
+		}
+
+		const uint32_t contentsMask = 0xffffffffu;
+		const rkit::math::Vec3 boxMins(-16.0f, -16.0f, -24.0f);
+		const rkit::math::Vec3 boxMaxs(16.0f, 16.0f, 32.0f);
+
+		const rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+		const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency();
+
+		const uint64_t scalarStartTime = sysDriver.GetHighResTimestamp();
+		for (size_t i = 0; i < numRays; i++)
+			collision.TraceRay(scalarResults[i], 0, rays[i].m_start, rays[i].m_end, contentsMask);
+
+		const uint64_t packetStartTime = sysDriver.GetHighResTimestamp();
+		collision.TraceRays(packetResults.ToSpan(), 0, rays.ToSpan(), contentsMask);
+
+		const uint64_t boxStartTime = sysDriver.GetHighResTimestamp();
+		for (size_t i = 0; i < numRays; i++)
+			collision.TraceBox(scalarResults[i], 0, rays[i].m_start, rays[i].m_end, boxMins, boxMaxs, contentsMask);
+
+		const uint64_t endTime = sysDriver.GetHighResTimestamp();
+
+		// Box traces overwrote the scalar ray results, so redo them for comparison
+		uint32_t numMatching = 0;
+		for (size_t i = 0; i < numRays; i++)
+		{
+			BSPTraceResult rayResult;
+			collision.TraceRay(rayResult, 0, rays[i].m_start, rays[i].m_end, contentsMask);
+
+			const float fractionDelta = rayResult.m_fraction - packetResults[i].m_fraction;
+			if (fractionDelta > -0.001f && fractionDelta < 0.001f && rayResult.m_startSolid == packetResults[i].m_startSolid)
+				numMatching++;
+		}
+
+		const uint64_t timings[3] =
+		{
+			packetStartTime - scalarStartTime,
+			boxStartTime - packetStartTime,
+			endTime - boxStartTime,
+		};
+
+		const rkit::Utf8Char_t *labels[3] =
+		{
+			u8"Ray",
+			u8"Ray packet",
+			u8"Box",
+		};
+
+		for (size_t i = 0; i < 3; i++)
+		{
+			const uint64_t microseconds = timings[i] * 1000000u / timerFrequency;
+			const uint64_t tracesPerSecond = (timings[i] == 0) ? 0 : (static_cast<uint64_t>(numRays) * timerFrequency / timings[i]);
+
+			rkit::log::LogInfoFmt(u8"{}: {} traces in {} usec ({} traces/sec)", labels[i], numRays, microseconds, tracesPerSecond);
+		}
+
+		rkit::log::LogInfoFmt(u8"Packet results matching scalar results: {}/{}", numMatching, numRays);
+
+		CORO_RETURN_OK;
+	}
+
+	rkit::ResultCoroutine AnoxGameLogic::Cmd_WorldBench(rkit::ICoroThread &thread, AnoxCommandStackBase &cmdStack, const rkit::ISpan<rkit::ByteStringView> &args)
+	{
+		uint32_t numObjects = 10000;
+		uint32_t numFrames = 100;
+
+		const rkit::IUtilitiesDriver &utils = *rkit::GetDrivers().m_utilitiesDriver;
+
+		if ((args.Count() >= 1 && !utils.ParseUInt32(args[0], 10, numObjects))
+			|| (args.Count() >= 2 && !utils.ParseUInt32(args[1], 10, numFrames)))
+		{
+			rkit::log::Error(u8"Usage: world_bench [object count] [frame count]");
+			CORO_RETURN_OK;
+		}
+
+		if (!m_sandbox.IsValid())
+		{
+			rkit::log::Error(u8"world_bench requires a running game session");
+			CORO_RETURN_OK;
+		}
+
+		const rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+
+		const uint64_t startTime = sysDriver.GetHighResTimestamp();
+
+		CORO_CHECK(m_sandboxImports.MTAsync_RunWorldBenchmark(m_sandboxMainThreadContext.Get(), m_sandboxEnv.m_gameSessionObjAddr, numObjects, numFrames));
+
+		{
+			SandboxMainThreadBlocker mtBlocker(this);
+			CORO_CHECK(co_await thread.AwaitBlocker(mtBlocker.CreateBlocker()));
+		}
+
+		const uint64_t endTime = sysDriver.GetHighResTimestamp();
+		const uint64_t microseconds = (endTime - startTime) * 1000000u / sysDriver.GetHighResTimestampFrequency();
+
+		rkit::log::LogInfoFmt(u8"World benchmark completed in {} usec", microseconds);
+
+		CORO_RETURN_OK;
+	}
+#endif
+
 	rkit::ResultCoroutine AnoxGameLogic::LoadCIPathKeyedResource(rkit::ICoroThread &thread, AnoxResourceRetrieveResult &loadResult,
 		uint32_t resourceType, const rkit::CIPathView &path)
 	{
@@ -729,6 +893,12 @@ namespace anox
 		CORO_CHECK(CopySpanToSandbox(entityDefValuesMO, udefValues.ToSpan()));
 		CORO_CHECK(CopySpanToSandbox(udefDescBytesMO, udefDescBytes.ToSpan()));
 
+#if !RKIT_IS_FINAL
+		const rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+
+		const uint64_t spawnStartTime = sysDriver.GetHighResTimestamp();
+#endif
+
 		CORO_CHECK(m_sandboxImports.MTAsync_SpawnInitialEntities(
 			m_sandboxMainThreadContext.Get(), m_sandboxEnv.m_gameSessionObjAddr,
 			entityTypesMO.m_addr, entityTypesMO.m_size / sizeof(uint32_t),
@@ -744,6 +914,15 @@ namespace anox
 			CORO_CHECK(co_await thread.AwaitBlocker(mtBlocker.CreateBlocker()));
 		}
 
+#if !RKIT_IS_FINAL
+		{
+			const uint64_t spawnEndTime = sysDriver.GetHighResTimestamp();
+			const uint64_t microseconds = (spawnEndTime - spawnStartTime) * 1000000u / sysDriver.GetHighResTimestampFrequency();
+
+			rkit::log::LogInfoFmt(u8"GameLogic: Spawned {} objects in {} usec", chunks.m_entityTypes.Count(), microseconds);
+		}
+#endif
+
 		CORO_CHECK(m_sandbox->ReleaseDynamicMemory(entityTypesMO.m_mmid));
 		CORO_CHECK(m_sandbox->ReleaseDynamicMemory(spawnDataMO.m_mmid));
 		CORO_CHECK(m_sandbox->ReleaseDynamicMemory(stringLengthsMO.m_mmid));
@@ -10,6 +10,7 @@
 #include "rkit/Core/String.h"
 #include "rkit/Core/LogDriver.h"
 #include "rkit/Core/Optional.h"
+#include "rkit/Core/SystemDriver.h"
 
 #include "rkit/Data/ContentID.h"
 #include "rkit/Sandbox/Sandbox.h"
@@ -45,6 +46,16 @@ namespace anox::game::sandbox
 		RKIT_RETURN_OK;
 	}
 
+	::rkit::Result HostExports::GetHighResTimestamp(::rkit::sandbox::Environment &env, ::rkit::sandbox::IThreadContext *thread, uint64_t &timestamp, uint64_t &frequency)
+	{
+		const rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+
+		timestamp = sysDriver.GetHighResTimestamp();
+		frequency = sysDriver.GetHighResTimestampFrequency();
+
+		RKIT_RETURN_OK;
+	}
+
 	::rkit::Result HostExports::GetContentIDKeyedResource(::rkit::sandbox::Environment &envBase, ::rkit::sandbox::IThreadContext *thread, uint32_t &reqID, uint32_t resourceType, ::rkit::sandbox::Address_t contentIDAddr)
 	{
 		AnoxGameSandboxEnvironment &env = static_cast<AnoxGameSandboxEnvironment &>(envBase);
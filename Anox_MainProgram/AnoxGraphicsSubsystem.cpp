@@ -62,6 +62,8 @@
 #include "rkit/Core/RefCounted.h"
 #include "rkit/Core/Result.h"
 #include "rkit/Core/StaticBoolArray.h"
+#include "rkit/Core/StreamingCopy.h"
+#include "rkit/Core/StripedCopyJobRunner.h"
 #include "rkit/Core/Stream.h"
 #include "rkit/Core/SystemDriver.h"
 #include "rkit/Core/UniquePtr.h"
@@ -154,6 +156,7 @@ namespace anox
 		struct UploadActionSet;
 		struct UploadTask;
 		struct FrameSyncPoint;
+		struct BufferStripedMemCopyAction;
 
 		template<class T>
 		struct PipelineConfigResolution
@@ -370,18 +373,6 @@ namespace anox
 			rkit::RCPtr<rkit::JobSignaler> m_doneCopyingSignaler;
 		};
 
-		class StripedMemCopyJobRunner final : public rkit::IJobRunner
-		{
-		public:
-			StripedMemCopyJobRunner(GraphicsSubsystem &graphicsSubsystem, uint8_t syncPointIndex);
-
-			rkit::Result Run() override;
-
-		private:
-			GraphicsSubsystem &m_graphicsSubsystem;
-			uint8_t m_syncPointIndex;
-		};
-
 		class StripedMemCopyCleanupJobRunner final : public rkit::IJobRunner
 		{
 		public:
@@ -574,6 +565,8 @@ namespace anox
 			uint32_t m_rowCount = 0;
 
 			rkit::render::MemoryPosition m_destPosition;
+
+			void CopyRange(uint64_t offset, uint64_t size) const;
 		};
 
 		struct PrepareImageForTransferAction
@@ -1524,43 +1517,15 @@ namespace anox
 		RKIT_RETURN_OK;
 	}
 
-	GraphicsSubsystem::StripedMemCopyJobRunner::StripedMemCopyJobRunner(GraphicsSubsystem &graphicsSubsystem, uint8_t syncPointIndex)
-		: m_graphicsSubsystem(graphicsSubsystem)
-		, m_syncPointIndex(syncPointIndex)
-	{
-	}
-
-	rkit::Result GraphicsSubsystem::StripedMemCopyJobRunner::Run()
+	void GraphicsSubsystem::BufferStripedMemCopyAction::CopyRange(uint64_t offset, uint64_t size) const
 	{
-		FrameSyncPoint &syncPoint = m_graphicsSubsystem.m_syncPoints[m_syncPointIndex];
-
-		for (const BufferStripedMemCopyAction &memCopyAction : syncPoint.m_asyncUploadActionSet.m_stripedMemCpy)
-		{
-			const uint8_t *srcStart = memCopyAction.m_start;
-			const uint32_t rowSizeBytes = memCopyAction.m_rowSizeBytes;
-			const uint32_t rowInPitch = memCopyAction.m_rowInPitch;
-			const uint32_t rowOutPitch = memCopyAction.m_rowOutPitch;
-			const uint32_t rowCount = memCopyAction.m_rowCount;
-
-			rkit::render::IMemoryAllocation *memAllocation = memCopyAction.m_destPosition.GetAllocation();
-			rkit::render::GPUMemoryOffset_t memOffset = memCopyAction.m_destPosition.GetOffset();
+		rkit::render::IMemoryAllocation *memAllocation = m_destPosition.GetAllocation();
+		rkit::render::GPUMemoryOffset_t memOffset = m_destPosition.GetOffset();
 
-			uint8_t *destStart = static_cast<uint8_t *>(memAllocation->GetCPUPtr()) + memOffset;
+		uint8_t *destStart = static_cast<uint8_t *>(memAllocation->GetCPUPtr()) + memOffset;
 
-			if (rowInPitch == rowOutPitch)
-				memcpy(destStart, srcStart, rowInPitch * rowCount);
-			else
-			{
-				for (uint32_t i = 0; i < rowCount; i++)
-				{
-					memcpy(destStart, srcStart, rowSizeBytes);
-					srcStart += rowInPitch;
-					destStart += rowOutPitch;
-				}
-			}
-		}
-
-		RKIT_RETURN_OK;
+		// Upload memory is usually write-combined, so this uses non-temporal stores
+		rkit::StreamingCopyRows(destStart, m_start, m_rowSizeBytes, m_rowInPitch, m_rowOutPitch, m_rowCount, offset, size);
 	}
 
 	GraphicsSubsystem::StripedMemCopyCleanupJobRunner::StripedMemCopyCleanupJobRunner(GraphicsSubsystem &graphicsSubsystem, uint8_t syncPointIndex)
@@ -2712,6 +2677,14 @@ namespace anox
 			canUpdatePipelineCache = true;
 			break;
 
+		case anox::RenderBackend::kNull:
+			// The null backend doesn't compile anything, so it can use the Vulkan pipeline package as-is
+			backendModule = u8"Render_Null";
+			pipelinesFile = u8"pipelines_vk.rkp";
+			pipelinesCacheFile = u8"pipeline_cache_null.rsf";
+			canUpdatePipelineCache = true;
+			break;
+
 		default:
 			RKIT_THROW(rkit::ResultCode::kInternalError);
 		}
@@ -3103,11 +3076,32 @@ namespace anox
 
 		if (actionSet.m_stripedMemCpy.Count() > 0)
 		{
-			rkit::UniquePtr<StripedMemCopyJobRunner> copyJobRunner;
-			RKIT_CHECK(rkit::New<StripedMemCopyJobRunner>(copyJobRunner, *this, m_currentSyncPoint));
+			// The copy jobs reference the action set, which isn't cleared until the sync point is reused
+			const rkit::ConstSpan<BufferStripedMemCopyAction> memCopyActions = actionSet.m_stripedMemCpy.ToSpan();
+
+			// Split the copies into balanced byte ranges, one job each
+			const uint64_t totalCopyBytes = rkit::ComputeStripedCopyTotalBytes(memCopyActions);
+			const uint64_t numCopyJobs = rkit::ComputeNumStripedCopyJobs(totalCopyBytes, rkit::GetDrivers().m_systemDriver->GetProcessorCount());
+
+			rkit::Vector<rkit::RCPtr<rkit::Job>> copyJobs;
+			RKIT_CHECK(copyJobs.Reserve(static_cast<size_t>(numCopyJobs)));
+
+			for (uint64_t jobIndex = 0; jobIndex < numCopyJobs; jobIndex++)
+			{
+				const uint64_t firstByte = totalCopyBytes * jobIndex / numCopyJobs;
+				const uint64_t endByte = totalCopyBytes * (jobIndex + 1) / numCopyJobs;
+
+				rkit::UniquePtr<rkit::StripedCopyJobRunner<BufferStripedMemCopyAction>> copyJobRunner;
+				RKIT_CHECK(rkit::New<rkit::StripedCopyJobRunner<BufferStripedMemCopyAction>>(copyJobRunner, memCopyActions, firstByte, endByte));
+
+				rkit::RCPtr<rkit::Job> copyJob;
+				RKIT_CHECK(m_threadPool.GetJobQueue()->CreateJob(&copyJob, rkit::JobType::kNormalPriority, std::move(copyJobRunner), rkit::JobDependencyList()));
+
+				RKIT_CHECK(copyJobs.Append(std::move(copyJob)));
+			}
 
 			rkit::RCPtr<rkit::Job> memCopyJob;
-			RKIT_CHECK(m_threadPool.GetJobQueue()->CreateJob(&memCopyJob, rkit::JobType::kNormalPriority, std::move(copyJobRunner), rkit::JobDependencyList()));
+			RKIT_CHECK(m_threadPool.GetJobQueue()->CreateJob(&memCopyJob, rkit::JobType::kNormalPriority, rkit::UniquePtr<rkit::IJobRunner>(), copyJobs.ToSpan()));
 
 			m_syncPoints[m_currentSyncPoint].m_asyncUploadActionSet.m_memCopyJob = memCopyJob;
 
@@ -55,6 +55,7 @@ namespace anox
 	enum class RenderBackend
 	{
 		kVulkan,
+		kNull,
 	};
 
 	struct IBinaryGPUWaitableFenceFactory
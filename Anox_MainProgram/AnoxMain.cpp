@@ -2,6 +2,8 @@
 #include "anox/AnoxModule.h"
 #include "anox/AnoxUtilitiesDriver.h"
 
+#include "AnoxGraphicsSubsystem.h"
+
 #include "rkit/Core/Drivers.h"
 #include "rkit/Core/LogDriver.h"
 #include "rkit/Core/Module.h"
@@ -56,6 +58,7 @@ rkit::Result anox::MainProgramDriver::InitProgram()
 	rkit::Span<const rkit::StringView> args = sysDriver.GetCommandLine();
 
 	bool autoBuild = false;
+	bool watchBuild = false;
 	bool run = false;
 
 	rkit::StringView buildTarget;
@@ -69,6 +72,8 @@ rkit::Result anox::MainProgramDriver::InitProgram()
 
 	rkit::Optional<uint16_t> numThreads;
 
+	anox::RenderBackend gameRenderBackend = anox::RenderBackend::kVulkan;
+
 	for (size_t i = 0; i < args.Count(); i++)
 	{
 		const rkit::StringView &arg = args[i];
@@ -164,8 +169,12 @@ rkit::Result anox::MainProgramDriver::InitProgram()
 
 			autoBuild = true;
 		}
+		else if (arg == u8"-watch")
+			watchBuild = true;
 		else if (arg == u8"-run")
 			run = true;
+		else if (arg == u8"-nullrender")
+			gameRenderBackend = anox::RenderBackend::kNull;
 		else if (arg == u8"-threads")
 		{
 			i++;
@@ -213,7 +222,7 @@ rkit::Result anox::MainProgramDriver::InitProgram()
 
 		IUtilitiesDriver *utilsDriver = static_cast<IUtilitiesDriver *>(rkit::GetDrivers().FindDriver(kAnoxNamespaceID, u8"Utilities"));
 
-		RKIT_CHECK(utilsDriver->RunDataBuild(buildTarget, buildSourceDirectory, buildIntermediateDirectory, dataDirectory, dataSourceDirectory, renderBackendType));
+		RKIT_CHECK(utilsDriver->RunDataBuild(buildTarget, buildSourceDirectory, buildIntermediateDirectory, dataDirectory, dataSourceDirectory, renderBackendType, watchBuild));
 	}
 
 
@@ -223,7 +232,7 @@ rkit::Result anox::MainProgramDriver::InitProgram()
 
 	if (run)
 	{
-		RKIT_CHECK(IAnoxGame::Create(m_game, numThreads));
+		RKIT_CHECK(IAnoxGame::Create(m_game, numThreads, gameRenderBackend));
 
 		RKIT_CHECK(m_game->Start());
 	}
@@ -4,8 +4,8 @@
 #include "rkit/Core/HashTable.h"
 #include "rkit/Core/Job.h"
 #include "rkit/Core/JobQueue.h"
-#include "rkit/Core/Mutex.h"
-#include "rkit/Core/MutexLock.h"
+#include "rkit/Core/ReadWriteLock.h"
+#include "rkit/Core/ReadWriteLockGuard.h"
 #include "rkit/Core/Result.h"
 #include "rkit/Core/UniquePtr.h"
 #include "rkit/Core/String.h"
@@ -41,7 +41,7 @@ namespace anox
 
 		rkit::Result Init();
 
-		rkit::UniquePtr<rkit::IMutex> m_resourcesMutex;
+		rkit::UniquePtr<rkit::IReadWriteLock> m_resourcesLock;
 		AnoxResourceManager *m_resManager;
 	};
 
@@ -65,7 +65,7 @@ namespace anox
 		rkit::RCPtr<AnoxResourceLoaderSynchronizer> m_sync;
 		rkit::SimpleObjectAllocation<AnoxResourceTracker> m_self;
 
-		// Only modify these fields under the resource mutex lock
+		// Only modify these fields under an exclusive resource lock
 		rkit::RCPtr<rkit::JobSignaler> m_loadCompletionSignaler;
 		rkit::RCPtr<rkit::Job> m_loadCompletionJob;
 		AnoxResourceTracker *m_prevResource = nullptr;
@@ -191,6 +191,8 @@ namespace anox
 
 		rkit::Result InternalRegisterLoader(uint32_t resourceType, AnoxResourceKeyType keyType, rkit::RCPtr<AnoxResourceLoaderBase> &&factory);
 
+		static rkit::Result CreateFinishedFuture(rkit::Future<AnoxResourceRetrieveResult> &loadFuture, rkit::RCPtr<AnoxResourceBase> &&resource);
+
 		template<class TKeyedTracker, class TKeyViewType, AnoxResourceKeyType TKeyType>
 		rkit::Result InternalGetResource(rkit::RCPtr<rkit::Job> *outJob, rkit::Future<AnoxResourceRetrieveResult> &loadFuture, const ResourceKey<TKeyViewType> &key, rkit::HashMap<ResourceKey<TKeyViewType>, AnoxResourceTracker *> *resourceMap);
 
@@ -198,7 +200,7 @@ namespace anox
 		rkit::IJobQueue *m_jobQueue;
 
 		rkit::HashMap<uint32_t, TypeKeyedFactory> m_loaders;
-		rkit::UniquePtr<rkit::IMutex> m_loaderMutex;
+		rkit::UniquePtr<rkit::IReadWriteLock> m_loaderLock;
 
 		rkit::HashMap<ResourceKey<rkit::CIPathView>, AnoxResourceTracker *> m_pathKeyedResources;
 		rkit::HashMap<ResourceKey<rkit::StringView>, AnoxResourceTracker *> m_stringKeyedResources;
@@ -232,7 +234,7 @@ namespace anox
 
 	rkit::Result AnoxResourceLoaderSynchronizer::Init()
 	{
-		RKIT_CHECK(rkit::GetDrivers().m_systemDriver->CreateMutex(m_resourcesMutex));
+		RKIT_CHECK(rkit::GetDrivers().m_systemDriver->CreateReadWriteLock(m_resourcesLock));
 
 		RKIT_RETURN_OK;
 	}
@@ -249,7 +251,7 @@ namespace anox
 	void AnoxResourceTracker::RCTrackerZero()
 	{
 		{
-			rkit::MutexLock lock(*m_sync->m_resourcesMutex);
+			rkit::ExclusiveLock lock(*m_sync->m_resourcesLock);
 
 			// Check for object resurrection, which can happen if the object is being retrieved
 			// from the resource manager while the last live reference is being destroyed
@@ -280,7 +282,7 @@ namespace anox
 		rkit::RCPtr<rkit::JobSignaler> completionSignaler;
 
 		{
-			rkit::MutexLock lock(*m_sync->m_resourcesMutex);
+			rkit::ExclusiveLock lock(*m_sync->m_resourcesLock);
 
 			futureContainerRCPtr = std::move(m_pendingFutureContainer);
 			m_pendingFutureContainer.Reset();
@@ -305,7 +307,7 @@ namespace anox
 		AnoxResourceRetrieveResult result;
 
 		{
-			rkit::MutexLock lock(*m_sync->m_resourcesMutex);
+			rkit::ExclusiveLock lock(*m_sync->m_resourcesLock);
 
 			futureContainerRCPtr = std::move(m_pendingFutureContainer);
 			m_pendingFutureContainer.Reset();
@@ -429,7 +431,7 @@ namespace anox
 		rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
 
 		RKIT_CHECK(rkit::New<AnoxResourceLoaderSynchronizer>(m_sync, this));
-		RKIT_CHECK(sysDriver.CreateMutex(m_loaderMutex));
+		RKIT_CHECK(sysDriver.CreateReadWriteLock(m_loaderLock));
 
 		RKIT_CHECK(m_sync->Init());
 
@@ -516,7 +518,7 @@ namespace anox
 
 	rkit::Result AnoxResourceManager::InternalRegisterLoader(uint32_t resourceType, AnoxResourceKeyType keyType, rkit::RCPtr<AnoxResourceLoaderBase> &&loader)
 	{
-		rkit::MutexLock lock(*m_loaderMutex);
+		rkit::ExclusiveLock lock(*m_loaderLock);
 
 		TypeKeyedFactory keyedFactory;
 		keyedFactory.m_keyType = keyType;
@@ -527,6 +529,24 @@ namespace anox
 		RKIT_RETURN_OK;
 	}
 
+	rkit::Result AnoxResourceManager::CreateFinishedFuture(rkit::Future<AnoxResourceRetrieveResult> &loadFuture, rkit::RCPtr<AnoxResourceBase> &&resource)
+	{
+		rkit::RCPtr<rkit::FutureContainer<AnoxResourceRetrieveResult>> futureContainer;
+		RKIT_CHECK(rkit::New<rkit::FutureContainer<AnoxResourceRetrieveResult>>(futureContainer));
+
+		if (resource.IsValid())
+		{
+			AnoxResourceRetrieveResult retrieveResult;
+			retrieveResult.m_resourceHandle = std::move(resource);
+			futureContainer->Complete(std::move(retrieveResult));
+		}
+		else
+			futureContainer->Fail();
+
+		loadFuture = rkit::Future<AnoxResourceRetrieveResult>(futureContainer);
+		RKIT_RETURN_OK;
+	}
+
 	template<class TKeyedTracker, class TKeyViewType, AnoxResourceKeyType TKeyType>
 	rkit::Result AnoxResourceManager::InternalGetResource(rkit::RCPtr<rkit::Job> *outJob, rkit::Future<AnoxResourceRetrieveResult> &loadFuture, const ResourceKey<TKeyViewType> &key, rkit::HashMap<ResourceKey<TKeyViewType>, AnoxResourceTracker *> *resourceMap)
 	{
@@ -537,13 +557,45 @@ namespace anox
 
 		// The loadCompleter and resourceRCPtr must be before the lock so that
 		// if a failure occurs in this function, they will be destroyed outside
-		// of the lock, since their destruction will lock the resource mutex.
+		// of the lock, since their destruction will take the resource lock.
 		rkit::RCPtr<AnoxResourceBase> resourceRCPtr;
 		rkit::RCPtr<AnoxResourceLoadCompletionNotifier> loadCompleter;
 
 		rkit::HashValue_t hash = rkit::Hasher<ResourceKey<TKeyViewType>>::ComputeHash(0, key);
 
-		rkit::MutexLock resLock(*m_sync->m_resourcesMutex);
+		// Most requests are for resources that have already finished loading and are still
+		// referenced, which only need a shared lock.  A resource whose count has dropped to zero
+		// may be inside RCTrackerZero, so reviving it is left to the exclusive path below.
+		{
+			rkit::SharedLock sharedLock(*m_sync->m_resourcesLock);
+
+			const rkit::HashMap<ResourceKey<TKeyViewType>, AnoxResourceTracker *> &constResourceMap = *resourceMap;
+
+			MapConstIterator_t it = constResourceMap.FindPrehashed(hash, key);
+			if (it != constResourceMap.end() && !it.Value()->m_pendingFutureContainer.IsValid())
+			{
+				AnoxResourceTracker *tracker = it.Value();
+				AnoxResourceBase *resourcePtr = tracker->m_resource.Get();
+
+				if (resourcePtr == nullptr)
+				{
+					sharedLock.Unlock();
+
+					return CreateFinishedFuture(loadFuture, rkit::RCPtr<AnoxResourceBase>());
+				}
+
+				if (tracker->RCTrackerAddRefIfNotZero())
+				{
+					rkit::RCPtr<AnoxResourceBase> trackerPtr(rkit::RCPtrMoveTag(), resourcePtr, tracker);
+
+					sharedLock.Unlock();
+
+					return CreateFinishedFuture(loadFuture, std::move(trackerPtr));
+				}
+			}
+		}
+
+		rkit::ExclusiveLock resLock(*m_sync->m_resourcesLock);
 
 		MapIterator_t it = resourceMap->FindPrehashed(hash, key);
 		if (it != resourceMap->end())
@@ -585,27 +637,14 @@ namespace anox
 
 				resLock.Unlock();
 
-				rkit::RCPtr<rkit::FutureContainer<AnoxResourceRetrieveResult>> futureContainer;
-				RKIT_CHECK(rkit::New<rkit::FutureContainer<AnoxResourceRetrieveResult>>(futureContainer));
-
-				if (trackerPtr.IsValid())
-				{
-					AnoxResourceRetrieveResult retrieveResult;
-					retrieveResult.m_resourceHandle = rkit::RCPtr<AnoxResourceBase>(resourcePtr, tracker);
-					futureContainer->Complete(std::move(retrieveResult));
-				}
-				else
-					futureContainer->Fail();
-
-				loadFuture = rkit::Future<AnoxResourceRetrieveResult>(futureContainer);
-				RKIT_RETURN_OK;
+				return CreateFinishedFuture(loadFuture, std::move(trackerPtr));
 			}
 		}
 
 		// Resource is not registered
 		rkit::RCPtr<AnoxResourceLoaderBase> loader;
 		{
-			rkit::MutexLock factoryLock(*m_loaderMutex);
+			rkit::SharedLock factoryLock(*m_loaderLock);
 			rkit::HashMap<uint32_t, TypeKeyedFactory>::ConstIterator_t factoryIt = m_loaders.Find(key.GetResourceType());
 			if (factoryIt == m_loaders.end() || factoryIt.Value().m_keyType != TKeyType)
 				RKIT_THROW(rkit::ResultCode::kInvalidParameter);
@@ -634,7 +673,7 @@ namespace anox
 
 		resourceRCPtr = rkit::RCPtr<AnoxResourceBase>(resource, tracker);
 
-		// Now that resourceRCPtr is set, failure will cause the mutex to be unlocked, followed by
+		// Now that resourceRCPtr is set, failure will cause the lock to be released, followed by
 		// re-lock and unregistration of the resource by resourceRCPtr
 		rkit::RCPtr<rkit::FutureContainer<AnoxResourceRetrieveResult>> pendingFutureContainer;
 		RKIT_CHECK(rkit::New<rkit::FutureContainer<AnoxResourceRetrieveResult>>(pendingFutureContainer));
@@ -4,7 +4,6 @@
 #include "AnoxAbstractSingleFileResource.h"
 
 #include "rkit/Data/ContentID.h"
-#include "rkit/Core/Sanitizers.h"
 
 #include "anox/CoreUtils/CoreUtils.h"
 
@@ -73,11 +72,6 @@ namespace anox
 				RKIT_THROW(rkit::ResultCode::kInternalError);
 			}
 		}
-
-		static rkit::Result ParseEntity(void *data, const AnoxSpawnDefsResource &resource, rkit::Span<const uint8_t> entityData, const data::EntityClassDef *eclass);
-
-		template<size_t TComponents>
-		static void ParseFloatArray(void *outData, const void *inData);
 	};
 
 	class AnoxSpawnDefsResource final : public AnoxSpawnDefsResourceBase
@@ -182,97 +176,6 @@ namespace anox
 		RKIT_RETURN_OK;
 	}
 
-	rkit::Result AnoxSpawnDefsLoaderInfo::ParseEntity(void *data, const AnoxSpawnDefsResource &resource, rkit::Span<const uint8_t> entityData, const data::EntityClassDef *eclass)
-	{
-		const data::EntityClassDef *parent = eclass->m_parent;
-
-		if (parent)
-		{
-			RKIT_CHECK(ParseEntity(data, resource, entityData.SubSpan(0, parent->m_dataSize), parent));
-		}
-
-		const rkit::ConstSpan<data::EntityFieldDef> fieldDefs(eclass->m_fields, eclass->m_numFields);
-
-		for (const data::EntityFieldDef &fieldDef : fieldDefs)
-		{
-			void *fieldDataPos = static_cast<void *>(static_cast<uint8_t *>(data) + fieldDef.m_structOffset);
-			const void *inDataPos = entityData.Ptr() + fieldDef.m_dataOffset;
-
-			switch (fieldDef.m_fieldType)
-			{
-			case data::EntityFieldType::kLabel:
-				*static_cast<Label *>(fieldDataPos) = Label::FromRawValue(static_cast<const rkit::endian::LittleUInt32_t *>(inDataPos)->Get());
-				break;
-			case data::EntityFieldType::kBool:
-			case data::EntityFieldType::kBoolOnOff:
-				*static_cast<bool *>(fieldDataPos) = ((*static_cast<const uint8_t *>(inDataPos)) != 0);
-				break;
-			case data::EntityFieldType::kUInt:
-				*static_cast<uint32_t *>(fieldDataPos) = static_cast<const rkit::endian::LittleUInt32_t *>(inDataPos)->Get();
-				break;
-			case data::EntityFieldType::kFloat:
-				*static_cast<float *>(fieldDataPos) = rkit::sanitizers::SanitizeClampFloat(*static_cast<const rkit::endian::LittleFloat32_t *>(inDataPos), 40);
-				break;
-			case data::EntityFieldType::kVec2:
-				ParseFloatArray<2>(fieldDataPos, inDataPos);
-				break;
-			case data::EntityFieldType::kVec3:
-				ParseFloatArray<3>(fieldDataPos, inDataPos);
-				break;
-			case data::EntityFieldType::kVec4:
-				ParseFloatArray<4>(fieldDataPos, inDataPos);
-				break;
-			case data::EntityFieldType::kString:
-				{
-					uint32_t stringIndex = static_cast<const rkit::endian::LittleUInt32_t *>(inDataPos)->Get();
-
-					if (stringIndex > resource.m_chunks.m_entityStringLengths.Count())
-						RKIT_THROW(rkit::ResultCode::kDataError);
-
-					if (stringIndex == 0)
-						new (fieldDataPos) rkit::Optional<uint32_t>();
-					else
-						new (fieldDataPos) rkit::Optional<uint32_t>(stringIndex - 1);
-				}
-				break;
-			case data::EntityFieldType::kEntityDef:
-				{
-					uint32_t edefIndex = static_cast<const rkit::endian::LittleUInt32_t *>(inDataPos)->Get();
-					if (edefIndex >= resource.m_userEntityDefs.Count())
-						RKIT_THROW(rkit::ResultCode::kDataError);
-
-					*static_cast<uint32_t *>(fieldDataPos) = edefIndex;
-				}
-				break;
-			case data::EntityFieldType::kBSPModel:
-				// uint32
-				RKIT_THROW(rkit::ResultCode::kNotYetImplemented);
-			case data::EntityFieldType::kComponent:
-				{
-					const data::EntityClassDef *componentClass = fieldDef.m_classDef;
-					RKIT_ASSERT(componentClass != nullptr);
-					RKIT_CHECK(ParseEntity(fieldDataPos, resource, entityData.SubSpan(fieldDef.m_dataOffset, componentClass->m_dataSize), componentClass));
-				}
-				break;
-			default:
-				RKIT_THROW(rkit::ResultCode::kDataError);
-			};
-		}
-
-		RKIT_RETURN_OK;		
-	}
-
-	template<size_t TComponents>
-	void AnoxSpawnDefsLoaderInfo::ParseFloatArray(void *outData, const void *inData)
-	{
-		const rkit::endian::LittleFloat32_t *inFloats = static_cast<const rkit::endian::LittleFloat32_t *>(inData);
-
-		rkit::StaticArray<float, TComponents> &outFloats = *static_cast<rkit::StaticArray<float, TComponents> *>(outData);
-
-		for (size_t i = 0; i < TComponents; i++)
-			outFloats[i] = rkit::sanitizers::SanitizeClampFloat(inFloats[i], 40);
-	}
-
 	rkit::Result AnoxSpawnDefsResourceLoaderBase::Create(rkit::RCPtr<AnoxSpawnDefsResourceLoaderBase> &outLoader)
 	{
 		typedef AnoxAbstractSingleFileResourceLoader<AnoxSpawnDefsLoaderInfo> Loader_t;
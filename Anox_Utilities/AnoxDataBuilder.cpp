@@ -11,7 +11,9 @@
 #include "rkit/BuildSystem/PackageBuilder.h"
 
 #include "rkit/Core/DirectoryScan.h"
+#include "rkit/Core/DirectoryWatcher.h"
 #include "rkit/Core/Drivers.h"
+#include "rkit/Core/FileMapping.h"
 #include "rkit/Core/LogDriver.h"
 #include "rkit/Core/HashTable.h"
 #include "rkit/Core/Module.h"
@@ -32,9 +34,29 @@ namespace anox { namespace utils
 	public:
 		AnoxDataBuilder(anox::IUtilitiesDriver *utils);
 
-		rkit::Result Run(const rkit::StringView &targetName, const rkit::OSAbsPathView &sourceDir, const rkit::OSAbsPathView &intermedDir, const rkit::OSAbsPathView &dataDir, const rkit::OSAbsPathView &dataSourceDir, rkit::render::BackendType backendType) override;
+		rkit::Result Run(const rkit::StringView &targetName, const rkit::OSAbsPathView &sourceDir, const rkit::OSAbsPathView &intermedDir, const rkit::OSAbsPathView &dataDir, const rkit::OSAbsPathView &dataSourceDir, rkit::render::BackendType backendType, bool watch) override;
 
 	private:
+		static const uint32_t kWatchPollIntervalMSec = 50;
+		static const uint32_t kWatchSettleTimeMSec = 250;
+		static const uint32_t kWatchFallbackPollIntervalMSec = 2000;
+
+		struct WatchedDirectory
+		{
+			rkit::buildsystem::BuildFileLocation m_location = rkit::buildsystem::BuildFileLocation::kInvalid;
+			bool m_isBuildOutput = false;
+			bool m_containsSourceDir = false;
+			rkit::UniquePtr<rkit::IDirectoryWatcher> m_watcher;
+		};
+
+		struct InvalidateChangedPathContext
+		{
+			rkit::buildsystem::IBuildSystemInstance *m_bsi = nullptr;
+			rkit::buildsystem::BuildFileLocation m_location = rkit::buildsystem::BuildFileLocation::kInvalid;
+			bool m_containsSourceDir = false;
+			bool m_haveUnconvertiblePath = false;
+		};
+
 		class ExportPipelinesCheckRunner final : public rkit::buildsystem::IBuildSystemAction
 		{
 		public:
@@ -62,6 +84,11 @@ namespace anox { namespace utils
 		rkit::Result ExportPipelineLibraries(rkit::buildsystem::IBuildSystemInstance &bsi);
 		rkit::Result ExportScriptCatalog(rkit::buildsystem::IBuildSystemInstance &bsi);
 
+		rkit::Result WatchAndRebuild(rkit::buildsystem::IBuildSystemInstance &bsi, rkit::buildsystem::IBuildFileSystem &fs, const rkit::OSAbsPathView &sourceDir, const rkit::OSAbsPathView &intermedDir, const rkit::OSAbsPathView &dataSourceDir);
+		static rkit::Result AddWatchedDirectory(rkit::Vector<WatchedDirectory> &watchedDirs, bool &outWatchingAll, const rkit::OSAbsPathView &path, rkit::buildsystem::BuildFileLocation location, bool isBuildOutput, bool containsSourceDir);
+		static rkit::Result ReadWatchedChanges(rkit::buildsystem::IBuildSystemInstance &bsi, WatchedDirectory &watchedDir, bool &outOverflowed);
+		static rkit::Result InvalidateChangedPathCallback(void *userdata, const rkit::OSRelPathView &path);
+
 		rkit::buildsystem::IBuildSystemDriver *m_bsDriver;
 		anox::IUtilitiesDriver *m_utils;
 	};
@@ -225,7 +252,7 @@ namespace anox { namespace utils
 		RKIT_RETURN_OK;
 	}
 
-	rkit::Result AnoxDataBuilder::Run(const rkit::StringView &targetName, const rkit::OSAbsPathView &sourceDir, const rkit::OSAbsPathView &intermedDir, const rkit::OSAbsPathView &dataDir, const rkit::OSAbsPathView &dataSourceDir, rkit::render::BackendType backendType)
+	rkit::Result AnoxDataBuilder::Run(const rkit::StringView &targetName, const rkit::OSAbsPathView &sourceDir, const rkit::OSAbsPathView &intermedDir, const rkit::OSAbsPathView &dataDir, const rkit::OSAbsPathView &dataSourceDir, rkit::render::BackendType backendType, bool watch)
 	{
 		rkit::IModule *buildModule = rkit::GetDrivers().m_moduleDriver->LoadModule(rkit::IModuleDriver::kDefaultNamespace, u8"Build");
 		if (!buildModule)
@@ -334,9 +361,165 @@ namespace anox { namespace utils
 
 		RKIT_CHECK(instance->Build(&fs));
 
+		if (watch)
+		{
+			RKIT_CHECK(WatchAndRebuild(*instance, fs, sourceDir, intermedDir, dataSourceDir));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	// Keeps the graph and file status cache from the last build, and rebuilds using only the statuses
+	// of files that changed since.  If changes can't be tracked, every file is revalidated instead.
+	rkit::Result AnoxDataBuilder::WatchAndRebuild(rkit::buildsystem::IBuildSystemInstance &bsi, rkit::buildsystem::IBuildFileSystem &fs, const rkit::OSAbsPathView &sourceDir, const rkit::OSAbsPathView &intermedDir, const rkit::OSAbsPathView &dataSourceDir)
+	{
+		rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+
+		rkit::Vector<WatchedDirectory> watchedDirs;
+		bool watchingAll = true;
+
+		// The source directory is the anoxdata subdirectory of the exe directory, so one recursive
+		// watch on the exe directory covers both
+		RKIT_CHECK(AddWatchedDirectory(watchedDirs, watchingAll, sourceDir, rkit::buildsystem::BuildFileLocation::kAuxDir0, false, true));
+		RKIT_CHECK(AddWatchedDirectory(watchedDirs, watchingAll, dataSourceDir, rkit::buildsystem::BuildFileLocation::kSourceDir, false, false));
+		RKIT_CHECK(AddWatchedDirectory(watchedDirs, watchingAll, intermedDir, rkit::buildsystem::BuildFileLocation::kIntermediateDir, true, false));
+
+		if (!watchingAll)
+			rkit::log::Warning(u8"Couldn't watch all build directories, polling for changes instead");
+
+		const uint64_t timestampFrequency = sysDriver.GetHighResTimestampFrequency();
+
+		for (;;)
+		{
+			bool needFullRevalidation = false;
+
+			if (!watchingAll)
+			{
+				sysDriver.SleepMSec(kWatchFallbackPollIntervalMSec);
+				needFullRevalidation = true;
+			}
+			else
+			{
+				// Changes to the intermediate directory only invalidate statuses, since builds write there.
+				// After a source change, keep collecting changes until the directories settle.
+				bool haveSourceChanges = false;
+				uint32_t quietTimeMSec = 0;
+
+				rkit::log::LogInfo(u8"Watching for changes...");
+
+				while (!haveSourceChanges || quietTimeMSec < kWatchSettleTimeMSec)
+				{
+					bool changedThisPoll = false;
+
+					for (WatchedDirectory &watchedDir : watchedDirs)
+					{
+						while (watchedDir.m_watcher->WaitForChanges(0))
+						{
+							bool overflowed = false;
+							RKIT_CHECK(ReadWatchedChanges(bsi, watchedDir, overflowed));
+
+							if (overflowed)
+								needFullRevalidation = true;
+
+							if (!watchedDir.m_isBuildOutput)
+							{
+								haveSourceChanges = true;
+								changedThisPoll = true;
+							}
+						}
+					}
+
+					if (changedThisPoll)
+						quietTimeMSec = 0;
+					else
+					{
+						sysDriver.SleepMSec(kWatchPollIntervalMSec);
+						quietTimeMSec += kWatchPollIntervalMSec;
+					}
+				}
+			}
+
+			const uint64_t startTime = sysDriver.GetHighResTimestamp();
+
+			rkit::PackedResultAndExtCode buildResult;
+			if (needFullRevalidation)
+			{
+				rkit::log::LogInfo(u8"Revalidating all files...");
+				buildResult = RKIT_TRY_EVAL(bsi.Build(&fs));
+			}
+			else
+				buildResult = RKIT_TRY_EVAL(bsi.BuildIncremental(&fs));
+
+			const uint64_t elapsedMSec = (sysDriver.GetHighResTimestamp() - startTime) * 1000u / timestampFrequency;
+
+			// Keep watching after a failed build, so the error can be fixed in place
+			if (rkit::utils::ResultIsOK(buildResult))
+				rkit::log::LogInfoFmt(u8"Rebuild finished in {} ms", elapsedMSec);
+			else
+				rkit::log::ErrorFmt(u8"Rebuild failed after {} ms", elapsedMSec);
+		}
+	}
+
+	rkit::Result AnoxDataBuilder::AddWatchedDirectory(rkit::Vector<WatchedDirectory> &watchedDirs, bool &outWatchingAll, const rkit::OSAbsPathView &path, rkit::buildsystem::BuildFileLocation location, bool isBuildOutput, bool containsSourceDir)
+	{
+		if (path.Length() == 0)
+			RKIT_RETURN_OK;
+
+		WatchedDirectory watchedDir;
+		watchedDir.m_location = location;
+		watchedDir.m_isBuildOutput = isBuildOutput;
+		watchedDir.m_containsSourceDir = containsSourceDir;
+
+		RKIT_CHECK(rkit::GetDrivers().m_systemDriver->OpenDirectoryWatcherAbs(watchedDir.m_watcher, path, true));
+
+		if (!watchedDir.m_watcher.IsValid())
+		{
+			outWatchingAll = false;
+			RKIT_RETURN_OK;
+		}
+
+		return watchedDirs.Append(std::move(watchedDir));
+	}
+
+	rkit::Result AnoxDataBuilder::ReadWatchedChanges(rkit::buildsystem::IBuildSystemInstance &bsi, WatchedDirectory &watchedDir, bool &outOverflowed)
+	{
+		InvalidateChangedPathContext context;
+		context.m_bsi = &bsi;
+		context.m_location = watchedDir.m_location;
+		context.m_containsSourceDir = watchedDir.m_containsSourceDir;
+
+		RKIT_CHECK(watchedDir.m_watcher->ReadChanges(outOverflowed, &context, InvalidateChangedPathCallback));
+
+		// A reported path that can't be invalidated individually is treated like a lost change
+		if (context.m_haveUnconvertiblePath)
+			outOverflowed = true;
+
 		RKIT_RETURN_OK;
 	}
 
+	rkit::Result AnoxDataBuilder::InvalidateChangedPathCallback(void *userdata, const rkit::OSRelPathView &path)
+	{
+		InvalidateChangedPathContext *context = static_cast<InvalidateChangedPathContext *>(userdata);
+
+		// The OS can report names that aren't valid build paths, such as 8.3 short names
+		rkit::CIPath ciPath;
+		if (!rkit::utils::ResultIsOK(RKIT_TRY_EVAL(ciPath.ConvertFrom(path))))
+		{
+			context->m_haveUnconvertiblePath = true;
+			RKIT_RETURN_OK;
+		}
+
+		if (context->m_containsSourceDir && ciPath.NumComponents() > 0 && ciPath.AbsSlice(1) == rkit::CIPathView(u8"anoxdata"))
+		{
+			rkit::CIPath sourcePath;
+			RKIT_CHECK(sourcePath.Set(ciPath.RelSlice(1, ciPath.NumComponents() - 1)));
+
+			return context->m_bsi->InvalidateFileStatus(rkit::buildsystem::BuildFileLocation::kSourceDir, sourcePath);
+		}
+
+		return context->m_bsi->InvalidateFileStatus(context->m_location, ciPath);
+	}
+
 	AnoxDataBuilder::ExportPipelinesCheckRunner::ExportPipelinesCheckRunner(AnoxDataBuilder &dataBuilder, rkit::buildsystem::IBuildSystemInstance &bsi)
 		: m_dataBuilder(dataBuilder)
 		, m_bsi(bsi)
@@ -776,9 +959,10 @@ namespace anox { namespace utils
 					rkit::OSAbsPath archivePath = m_sourceDir;
 					RKIT_CHECK(archivePath.Append(scanItem.m_fileName));
 
-					rkit::UniquePtr<rkit::ISeekableReadStream> archiveStream;
+					// Archives are mapped so entry reads become copies out of the page cache instead of seek+read calls
+					rkit::UniquePtr<rkit::IFileMapping> archiveMapping;
 
-					RKIT_TRY_CATCH_RETHROW(sysDriver.OpenFileReadAbs(archiveStream, archivePath, false),
+					RKIT_TRY_CATCH_RETHROW(sysDriver.OpenFileMappingAbs(archiveMapping, archivePath, rkit::FileMappingMode::kReadOnly, rkit::FileAccessHint::kRandom, false),
 						rkit::CatchContext(
 							[]
 							{
@@ -787,6 +971,12 @@ namespace anox { namespace utils
 						)
 					);
 
+					rkit::UniquePtr<rkit::IFileMappingView> archiveView;
+					RKIT_CHECK(archiveMapping->MapEntireFile(archiveView));
+
+					rkit::UniquePtr<rkit::ISeekableReadStream> archiveStream;
+					RKIT_CHECK(rkit::New<rkit::MappedViewReadStream>(archiveStream, std::move(archiveView)));
+
 					rkit::CIPath fileNameCIPath;
 					RKIT_CHECK(fileNameCIPath.ConvertFrom(scanItem.m_fileName));
 
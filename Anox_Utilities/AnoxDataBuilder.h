@@ -22,7 +22,7 @@ namespace anox
 		{
 			virtual ~IDataBuilder() {}
 
-			virtual rkit::Result Run(const rkit::StringView &targetName, const rkit::OSAbsPathView &sourceDir, const rkit::OSAbsPathView &intermedDir, const rkit::OSAbsPathView &dataDir, const rkit::OSAbsPathView &dataSourceDir, rkit::render::BackendType backendType) = 0;
+			virtual rkit::Result Run(const rkit::StringView &targetName, const rkit::OSAbsPathView &sourceDir, const rkit::OSAbsPathView &intermedDir, const rkit::OSAbsPathView &dataDir, const rkit::OSAbsPathView &dataSourceDir, rkit::render::BackendType backendType, bool watch) = 0;
 
 			static rkit::Result Create(IUtilitiesDriver *utils, rkit::UniquePtr<IDataBuilder> &outDataBuilder);
 		};
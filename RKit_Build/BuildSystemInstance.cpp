@@ -7,11 +7,19 @@
 #include "rkit/BuildSystem/DependencyGraph.h"
 
 #include "rkit/Core/BufferStream.h"
+#include "rkit/Core/ConditionVariable.h"
+#include "rkit/Core/Event.h"
 #include "rkit/Core/FileAttributes.h"
+#include "rkit/Core/FileMapping.h"
 #include "rkit/Core/HashTable.h"
 #include "rkit/Core/HybridVector.h"
+#include "rkit/Core/Job.h"
+#include "rkit/Core/JobQueue.h"
 #include "rkit/Core/LogDriver.h"
+#include "rkit/Core/MemoryStream.h"
+#include "rkit/Core/MutexLock.h"
 #include "rkit/Core/NewDelete.h"
+#include "rkit/Core/OpenAddressedIndex.h"
 #include "rkit/Core/Optional.h"
 #include "rkit/Core/Pair.h"
 #include "rkit/Core/Path.h"
@@ -21,11 +29,13 @@
 #include "rkit/Core/StringPool.h"
 #include "rkit/Core/StringView.h"
 #include "rkit/Core/SystemDriver.h"
+#include "rkit/Core/UtilitiesDriver.h"
 #include "rkit/Core/Vector.h"
 
 #include "rkit/Data/ContentID.h"
 
 #include "rkit/Utilities/Sha2.h"
+#include "rkit/Utilities/ThreadPool.h"
 
 #include <algorithm>
 
@@ -64,6 +74,8 @@ namespace rkit { namespace buildsystem
 
 		HashValue_t ComputeHash(HashValue_t baseHash) const;
 
+		bool IsAtOrUnder(BuildFileLocation location, const CIPathView &path) const;
+
 	private:
 		BuildFileLocation m_location;
 		CIPathView m_path;
@@ -84,12 +96,31 @@ namespace rkit { namespace buildsystem
 
 		HashValue_t ComputeHash(HashValue_t baseHash) const;
 
+		bool IsAtOrUnder(BuildFileLocation location, const CIPathView &path) const;
+
 	private:
 		BuildFileLocation m_location;
 		CIPathView m_path;
 		bool m_directoryMode;
 	};
 
+	class MemoizedInputKey
+	{
+	public:
+		MemoizedInputKey(BuildFileLocation inputLocation, const CIPathView &path, IDependencyNodeCompilerFeedback::ParseMemoizedInputCallback_t parseCallback);
+
+		bool operator==(const MemoizedInputKey &other) const;
+		bool operator!=(const MemoizedInputKey &other) const;
+
+		HashValue_t ComputeHash(HashValue_t baseHash) const;
+
+	private:
+		MemoizedInputKey() = delete;
+
+		FileLocationKey m_fileLocation;
+		IDependencyNodeCompilerFeedback::ParseMemoizedInputCallback_t m_parseCallback;
+	};
+
 	class NodeKey
 	{
 	public:
@@ -123,6 +154,12 @@ struct ::rkit::Hasher<rkit::buildsystem::DirectoryScanKey>
 	static HashValue_t ComputeHash(HashValue_t baseHash, const rkit::buildsystem::DirectoryScanKey &value);
 };
 
+template<>
+struct ::rkit::Hasher<rkit::buildsystem::MemoizedInputKey>
+{
+	static HashValue_t ComputeHash(HashValue_t baseHash, const rkit::buildsystem::MemoizedInputKey &value);
+};
+
 template<>
 struct ::rkit::Hasher<rkit::buildsystem::NodeKey>
 {
@@ -140,6 +177,21 @@ bool rkit::buildsystem::NodeTypeKey::operator!=(const NodeTypeKey &other) const
 }
 
 
+namespace rkit { namespace buildsystem
+{
+	static bool IsPathAtOrUnder(BuildFileLocation keyLocation, const CIPathView &keyPath, BuildFileLocation location, const CIPathView &path)
+	{
+		if (keyLocation != location)
+			return false;
+
+		const size_t numComponents = path.NumComponents();
+		if (keyPath.NumComponents() < numComponents)
+			return false;
+
+		return keyPath.AbsSlice(numComponents) == path.AbsSlice(numComponents);
+	}
+} } // rkit::buildsystem
+
 rkit::buildsystem::FileLocationKey::FileLocationKey()
 	: m_location(BuildFileLocation::kInvalid)
 	, m_path(u8"")
@@ -186,6 +238,11 @@ rkit::HashValue_t rkit::buildsystem::FileLocationKey::ComputeHash(HashValue_t ba
 	return hash;
 }
 
+bool rkit::buildsystem::FileLocationKey::IsAtOrUnder(BuildFileLocation location, const CIPathView &path) const
+{
+	return IsPathAtOrUnder(m_location, m_path, location, path);
+}
+
 
 
 rkit::buildsystem::DirectoryScanKey::DirectoryScanKey()
@@ -241,6 +298,34 @@ rkit::HashValue_t rkit::buildsystem::DirectoryScanKey::ComputeHash(HashValue_t b
 	return hash;
 }
 
+bool rkit::buildsystem::DirectoryScanKey::IsAtOrUnder(BuildFileLocation location, const CIPathView &path) const
+{
+	return IsPathAtOrUnder(m_location, m_path, location, path);
+}
+
+rkit::buildsystem::MemoizedInputKey::MemoizedInputKey(BuildFileLocation inputLocation, const CIPathView &path, IDependencyNodeCompilerFeedback::ParseMemoizedInputCallback_t parseCallback)
+	: m_fileLocation(inputLocation, path)
+	, m_parseCallback(parseCallback)
+{
+}
+
+bool rkit::buildsystem::MemoizedInputKey::operator==(const MemoizedInputKey &other) const
+{
+	return m_fileLocation == other.m_fileLocation && m_parseCallback == other.m_parseCallback;
+}
+
+bool rkit::buildsystem::MemoizedInputKey::operator!=(const MemoizedInputKey &other) const
+{
+	return !((*this) == other);
+}
+
+rkit::HashValue_t rkit::buildsystem::MemoizedInputKey::ComputeHash(HashValue_t baseHash) const
+{
+	HashValue_t hash = m_fileLocation.ComputeHash(baseHash);
+	hash = Hasher<IDependencyNodeCompilerFeedback::ParseMemoizedInputCallback_t>::ComputeHash(hash, m_parseCallback);
+	return hash;
+}
+
 rkit::buildsystem::NodeKey::NodeKey(const NodeTypeKey &nodeTypeKey, BuildFileLocation inputLocation, const StringView &identifier)
 	: m_typeKey(nodeTypeKey)
 	, m_inputLocation(inputLocation)
@@ -280,6 +365,11 @@ rkit::HashValue_t rkit::Hasher<rkit::buildsystem::DirectoryScanKey>::ComputeHash
 	return value.ComputeHash(baseHash);
 }
 
+rkit::HashValue_t rkit::Hasher<rkit::buildsystem::MemoizedInputKey>::ComputeHash(HashValue_t baseHash, const rkit::buildsystem::MemoizedInputKey &value)
+{
+	return value.ComputeHash(baseHash);
+}
+
 rkit::HashValue_t rkit::Hasher<rkit::buildsystem::NodeKey>::ComputeHash(HashValue_t baseHash, const rkit::buildsystem::NodeKey &value)
 {
 	return value.ComputeHash(baseHash);
@@ -299,6 +389,13 @@ namespace rkit { namespace buildsystem
 		Completed,
 	};
 
+	struct BuildCacheRecordLocation
+	{
+		size_t m_segmentIndex = 0;
+		uint64_t m_filePos = 0;
+		uint64_t m_size = 0;
+	};
+
 	namespace serializer
 	{
 		template<class T>
@@ -324,13 +421,13 @@ namespace rkit { namespace buildsystem
 		class DeserializeResolver final : public IDeserializeResolver
 		{
 		public:
-			DeserializeResolver(const Span<const UniquePtr<DependencyNode>> &nodes, const Span<const String> &strings);
+			DeserializeResolver(BuildSystemInstance &instance, const Span<const String> &strings);
 
 			Result GetString(size_t index, StringView &outString) const override;
 			Result GetDependencyNode(size_t index, IDependencyNode *&outNode) const override;
 
 		private:
-			Span<const UniquePtr<DependencyNode>> m_nodes;
+			BuildSystemInstance &m_instance;
 			Span<const String> m_strings;
 		};
 
@@ -355,6 +452,35 @@ namespace rkit { namespace buildsystem
 		static Result DeserializeCompactSize(IReadStream &stream, size_t &sz);
 	}
 
+	// Hashed index over one of a node's product or dependency lists.  Only item indexes and
+	// hashes are stored, and candidates are compared against the list itself.  Short lists are
+	// scanned instead, and items that were added to the list since the last lookup are indexed
+	// on the next one.
+	template<class TKey>
+	class NodeItemIndex
+	{
+	public:
+		NodeItemIndex();
+
+		template<class TItem>
+		Result Find(bool &outFound, size_t &outIndex, const Vector<TItem> &items, const TKey &key, HashValue_t hash);
+
+		template<class TItem>
+		Result Sync(const Vector<TItem> &items);
+
+		void Clear();
+
+	private:
+		static const size_t kMinIndexedItems = 8;
+
+		OpenAddressedIndex m_index;
+	};
+
+	static FileLocationKey GetNodeItemKey(const FileStatus &fileStatus);
+	static FileLocationKey GetNodeItemKey(const FileDependencyInfo &fileDependency);
+	static DirectoryScanKey GetNodeItemKey(const DirectoryScanDependencyInfo &dirScanDependency);
+	static IDependencyNode *GetNodeItemKey(const NodeDependencyInfo &nodeDependency);
+
 	class DependencyNode final : public IDependencyNode
 	{
 	public:
@@ -373,6 +499,7 @@ namespace rkit { namespace buildsystem
 
 		void MarkOutOfDate() override;
 		bool WasCompiled() const override;
+		void ClearWasCompiled();
 		bool IsContentBased() const override;
 
 		Span<const uint8_t> GetContent() const override;
@@ -409,6 +536,8 @@ namespace rkit { namespace buildsystem
 		Result AddCompileDirectoryScanDependency(const DirectoryScanDependencyInfoView &dirScanInfo);
 		Result AddNodeDependency(const NodeDependencyInfo &nodeInfo);
 
+		Result FindFileDependency(bool isCompilePhase, BuildFileLocation location, const CIPathView &path, const FileDependencyInfo *&outFileInfo);
+
 		Result SerializeInitialState(IWriteStream &stream) const;
 		static Result DeserializeInitialState(IReadStream &stream, uint32_t &outNodeNamespace, uint32_t &outNodeType, Vector<uint8_t> &outContent, BuildFileLocation &outInputLocation);
 
@@ -420,6 +549,17 @@ namespace rkit { namespace buildsystem
 		void SetSerializedIndex(size_t index);
 		size_t GetSerializedIndex() const;
 
+		void MarkCacheRecordDirty();
+		bool IsCacheRecordDirty() const;
+		void SetCacheRecord(const BuildCacheRecordLocation &location);
+		const BuildCacheRecordLocation &GetCacheRecord() const;
+
+		bool IsInCacheLiveSet() const;
+		void SetInCacheLiveSet(bool inLiveSet);
+
+		bool IsInCacheCheckpoint() const;
+		void SetInCacheCheckpoint(bool inCheckpoint);
+
 	private:
 		DependencyNode() = delete;
 
@@ -436,6 +576,8 @@ namespace rkit { namespace buildsystem
 			Result CheckInputExists(BuildFileLocation location, const CIPathView &path, bool &outExists) override;
 			Result OpenInput(BuildFileLocation location, const CIPathView &path, UniquePtr<ISeekableReadStream> &inputFile) override;
 			Result TryOpenInput(BuildFileLocation location, const CIPathView &path, UniquePtr<ISeekableReadStream> &inputFile) override;
+			Result OpenMemoizedInput(BuildFileLocation location, const CIPathView &path, ParseMemoizedInputCallback_t parseCallback, const IMemoizedInput *&outParsedInput) override;
+			Result TryOpenMemoizedInput(BuildFileLocation location, const CIPathView &path, ParseMemoizedInputCallback_t parseCallback, const IMemoizedInput *&outParsedInput) override;
 			Result OpenOutput(BuildFileLocation location, const CIPathView &path, UniquePtr<ISeekableReadWriteStream> &outputFile) override;
 			Result AddAnonymousDeployableContent(BuildFileLocation location, const CIPathView &path) override;
 
@@ -450,12 +592,14 @@ namespace rkit { namespace buildsystem
 
 			IBuildSystemInstance *GetBuildSystemInstance() const override;
 
+
 			void MarkOutputFileFinished(size_t productIndex, BuildFileLocation location, const CIPathView &path);
 
 			Result CheckFault() const override;
 
 		private:
 			Result CheckedMarkOutputFileFinished(size_t productIndex, BuildFileLocation location, const CIPathView &path);
+			Result AddInputFileDependency(BuildFileLocation location, const CIPathView &path, FileStatusView &outStatusView, bool &outExists);
 
 			Result InternalEnumerateFilesOrDirectories(BuildFileLocation location, const CIPathView &path, bool directoryMode, void *userdata, EnumerateFilesResultCallback_t resultCallback);
 
@@ -503,9 +647,9 @@ namespace rkit { namespace buildsystem
 		static DirectoryScanDependencyInfoView GetCompileDirectoryScanDependencyByIndex(const IDependencyNode *const &node, size_t index);
 		static NodeDependencyInfo GetNodeDependencyByIndex(const IDependencyNode *const & node, size_t index);
 
-		static Result FindOrAddProduct(Vector<FileStatus> &products, BuildFileLocation location, const CIPathView &path, size_t &outIndex);
-		static Result AddFileDependency(Vector<FileDependencyInfo> &fileDependencies, const FileDependencyInfoView &fileInfo);
-		static Result AddDirectoryScanDependency(Vector<DirectoryScanDependencyInfo> &dirScanDependencies, const DirectoryScanDependencyInfoView &dirScanInfo);
+		static Result FindOrAddProduct(Vector<FileStatus> &products, NodeItemIndex<FileLocationKey> &productIndex, BuildFileLocation location, const CIPathView &path, size_t &outIndex);
+		static Result AddFileDependency(Vector<FileDependencyInfo> &fileDependencies, NodeItemIndex<FileLocationKey> &fileDependencyIndex, const FileDependencyInfoView &fileInfo);
+		static Result AddDirectoryScanDependency(Vector<DirectoryScanDependencyInfo> &dirScanDependencies, NodeItemIndex<DirectoryScanKey> &dirScanDependencyIndex, const DirectoryScanDependencyInfoView &dirScanInfo);
 
 		Vector<FileStatus> m_analysisProducts;
 		Vector<FileStatus> m_compileProducts;
@@ -516,6 +660,14 @@ namespace rkit { namespace buildsystem
 		Vector<DirectoryScanDependencyInfo> m_compileDirectoryScanDependencies;
 		Vector<NodeDependencyInfo> m_nodeDependencies;
 
+		NodeItemIndex<FileLocationKey> m_analysisProductIndex;
+		NodeItemIndex<FileLocationKey> m_compileProductIndex;
+		NodeItemIndex<FileLocationKey> m_analysisFileDependencyIndex;
+		NodeItemIndex<FileLocationKey> m_compileFileDependencyIndex;
+		NodeItemIndex<DirectoryScanKey> m_analysisDirectoryScanDependencyIndex;
+		NodeItemIndex<DirectoryScanKey> m_compileDirectoryScanDependencyIndex;
+		NodeItemIndex<IDependencyNode *> m_nodeDependencyIndex;
+
 		Vector<uint8_t> m_content;
 
 		DependencyState m_dependencyState;
@@ -532,8 +684,18 @@ namespace rkit { namespace buildsystem
 
 		size_t m_serializedIndex;
 		bool m_wasCompiled;
+
+		BuildCacheRecordLocation m_cacheRecord;
+		bool m_cacheRecordDirty;
+		bool m_inCacheLiveSet;
+		bool m_inCacheCheckpoint;
 	};
 
+	// The cache file is a header followed by appended segments and checkpoints.  Each segment
+	// is a string pool followed by node records, and each checkpoint lists the segments and
+	// the record and lookup key of every live node.  The header's active instance points at
+	// the latest checkpoint, so records that didn't change are never rewritten.  Loading only
+	// reads the checkpoint, and a record is decoded the first time its node is looked up.
 	struct BuildCacheInstanceInfo
 	{
 		uint64_t m_filePos = 0;
@@ -543,7 +705,7 @@ namespace rkit { namespace buildsystem
 	struct BuildCacheFileHeader
 	{
 		static const uint32_t kCacheIdentifier = RKIT_FOURCC('B', 'S', 'C', 'F');
-		static const uint32_t kCacheVersion = 1;
+		static const uint32_t kCacheVersion = 3;
 
 		uint32_t m_identifier = 0;
 		uint32_t m_version = 0;
@@ -567,8 +729,11 @@ namespace rkit { namespace buildsystem
 		Result AddPostBuildAction(IBuildSystemAction *action) override;
 
 		Result LoadCache() override;
+		Result BenchmarkCache(uint32_t numPasses) override;
 
 		Result Build(IBuildFileSystem *fs) override;
+		Result BuildIncremental(IBuildFileSystem *fs) override;
+		Result InvalidateFileStatus(BuildFileLocation location, const CIPathView &path) override;
 
 		IDependencyGraphFactory *GetDependencyGraphFactory() const override;
 
@@ -579,6 +744,8 @@ namespace rkit { namespace buildsystem
 		Result ResolveFileStatus(BuildFileLocation location, const CIPathView &path, bool allowDirectories, FileStatusView &outStatusView, bool cached, bool &outExists);
 		Result ResolveDirectoryScan(BuildFileLocation location, const CIPathView &path, bool directoryMode, DirectoryScanView &outScanView, bool cached, bool &outExists);
 
+		Result ResolveMemoizedInput(BuildFileLocation location, const CIPathView &path, const FileStatusView &status, IDependencyNodeCompilerFeedback::ParseMemoizedInputCallback_t parseCallback, const IMemoizedInput *&outParsedInput);
+
 		Result TryOpenFileRead(BuildFileLocation location, const CIPathView &path, UniquePtr<ISeekableReadStream> &outFile) override;
 		Result OpenFileWrite(BuildFileLocation location, const CIPathView &path, UniquePtr<ISeekableReadWriteStream> &outFile) override;
 
@@ -592,7 +759,26 @@ namespace rkit { namespace buildsystem
 
 		Result RegisterCASSource(const data::ContentID &contentID, BuildFileLocation inputFileLocation, const CIPathView &path) override;
 
+		IMutex &GetGraphMutex() const;
+
+		size_t ComputeNumBatches(size_t numItems, size_t minItemsPerBatch) const override;
+		Result RunBatchJobs(Vector<UniquePtr<IJobRunner>> &&batchRunners) override;
+
+		Result LoadCachedNodeByID(size_t cacheID, DependencyNode *&outNode);
+
 	private:
+		static const size_t kMinFileStatusesPerBatch = 256;
+		static const size_t kMinCASUpdatesPerBatch = 4;
+		static const size_t kCASCopyBufferSize = 64 * 1024;
+
+		// The cache is rewritten from scratch once it has this many segments, or once
+		// superseded records make up more than half of it
+		static const size_t kMaxCacheSegments = 16;
+		static const uint64_t kMinCacheCompactionSize = 1024 * 1024;
+
+		// Fraction of records that the cache benchmark rewrites to simulate an incremental build
+		static const size_t kCacheBenchDirtyNodeInterval = 16;
+
 		struct CachedFileStatus
 		{
 			bool m_exists = true;
@@ -605,6 +791,27 @@ namespace rkit { namespace buildsystem
 			DirectoryScan m_scan;
 		};
 
+		// A record listed in the loaded checkpoint.  The node is created on first lookup.
+		struct CachedNodeRecord
+		{
+			size_t m_cacheID = 0;
+			BuildCacheRecordLocation m_location;
+			uint32_t m_nodeNamespace = 0;
+			uint32_t m_nodeType = 0;
+			BuildFileLocation m_inputLocation = BuildFileLocation::kInvalid;
+			String m_identifier;
+
+			DependencyNode *m_node = nullptr;
+			uint64_t m_bodyOffset = 0;
+			bool m_loadFailed = false;
+		};
+
+		struct CachedSegmentStrings
+		{
+			bool m_isLoaded = false;
+			Vector<String> m_strings;
+		};
+
 		struct PrintableFourCC
 		{
 			explicit PrintableFourCC(uint32_t fourCC);
@@ -629,6 +836,85 @@ namespace rkit { namespace buildsystem
 			CIPath m_path;
 		};
 
+		struct MemoizedInput
+		{
+			BuildFileLocation m_location = BuildFileLocation::kInvalid;
+			CIPath m_path;
+			uint64_t m_fileSize = 0;
+			UTCMSecTimestamp_t m_fileTime = 0;
+			utils::Sha256DigestBytes m_contentDigest = {};
+			UniquePtr<IMemoizedInput> m_parsedInput;
+		};
+
+		struct PrefetchAnalysis
+		{
+			DependencyNode *m_node = nullptr;
+			PackedResultAndExtCode m_result = utils::PackResult(ResultCode::kOK);
+			PrefetchAnalysis *m_nextCompleted = nullptr;
+		};
+
+		struct PrefetchState
+		{
+			HashSet<DependencyNode *> m_visitedNodes;
+			Vector<DependencyNode *> m_nodesToCheck;
+			Vector<UniquePtr<PrefetchAnalysis>> m_analyses;
+			UniquePtr<utils::IThreadPool> m_threadPool;
+			size_t m_numInFlight = 0;
+			PackedResultAndExtCode m_analysisResult = utils::PackResult(ResultCode::kOK);
+		};
+
+		struct FileStatusPrefetch
+		{
+			BuildFileLocation m_location = BuildFileLocation::kInvalid;
+			CIPath m_path;
+			UniquePtr<CachedFileStatus> m_cachedStatus;
+		};
+
+		class FileStatusBatchJobRunner final : public IJobRunner
+		{
+		public:
+			FileStatusBatchJobRunner(IBuildFileSystem &fs, const Span<UniquePtr<FileStatusPrefetch>> &prefetches);
+
+			Result Run() override;
+
+		private:
+			IBuildFileSystem &m_fs;
+			Span<UniquePtr<FileStatusPrefetch>> m_prefetches;
+		};
+
+		struct CASUpdate
+		{
+			data::ContentID m_contentID;
+			const CASSource *m_source = nullptr;
+			bool m_wasPublished = false;
+			bool m_wasCloned = false;
+			FilePos_t m_bytesCopied = 0;
+		};
+
+		class CASUpdateBatchJobRunner final : public IJobRunner
+		{
+		public:
+			CASUpdateBatchJobRunner(const BuildSystemInstance &instance, const Span<CASUpdate> &updates);
+
+			Result Run() override;
+
+		private:
+			const BuildSystemInstance &m_instance;
+			Span<CASUpdate> m_updates;
+		};
+
+		class AnalysisJobRunner final : public IJobRunner
+		{
+		public:
+			AnalysisJobRunner(BuildSystemInstance &instance, PrefetchAnalysis &prefetch);
+
+			Result Run() override;
+
+		private:
+			BuildSystemInstance &m_instance;
+			PrefetchAnalysis &m_prefetch;
+		};
+
 		static ContentID CreateContentID(const Span<const uint8_t> &content);
 
 		Result CreateNode(uint32_t nodeNamespace, uint32_t nodeType, BuildFileLocation buildFileLocation, const StringView &identifier, Vector<uint8_t> &&content, UniquePtr<IDependencyNode> &outNode) const;
@@ -640,6 +926,22 @@ namespace rkit { namespace buildsystem
 		Result CheckNodeNodeDependencies(DependencyNode *node);
 		Result StratifyRelevantNodes();
 
+		Result RunBuild();
+
+
+		Result PrefetchFileStatuses();
+		Result AddFileStatusPrefetch(Vector<UniquePtr<FileStatusPrefetch>> &prefetches, HashSet<FileLocationKey> &prefetchLocations, BuildFileLocation location, const CIPathView &path);
+		static Result ResolveFileStatusPrefetches(IBuildFileSystem &fs, const Span<UniquePtr<FileStatusPrefetch>> &prefetches);
+
+		Result PrefetchAnalyses();
+		Result RunPrefetchWalk(PrefetchState &state);
+		Result CollectPrefetchedAnalyses(PrefetchState &state);
+		Result QueuePrefetchCheck(PrefetchState &state, DependencyNode *node);
+		Result StartPrefetchAnalysis(PrefetchState &state, DependencyNode *node);
+		void MarkPrefetchAnalysisCompleted(PrefetchAnalysis &prefetch);
+
+		void LogAnalysis(const DependencyNode *node) const;
+
 		static Result ResolveCachedFileStatusCallback(void *userdata, const FileStatusView &status);
 
 		void ErrorBlameNode(DependencyNode *node, const StringView &msg);
@@ -651,15 +953,34 @@ namespace rkit { namespace buildsystem
 		static PrintableFourCC FourCCToPrintable(uint32_t fourCC);
 
 		static CIPathView GetCacheFileName();
+		static CIPathView GetCacheTempFileName();
+		static CIPathView GetCacheBenchFileName();
 
 		static IDependencyNode *GetRelevantNodeByIndex(const IBuildSystemInstance * const& instance, size_t index);
 
-		Result CheckedLoadCache(ISeekableReadStream &stream, FilePos_t pos);
+		Result LoadCacheFile(const CIPathView &cacheFileName);
+		Result CheckedLoadCache(const Span<const uint8_t> &fileData, const BuildCacheInstanceInfo &checkpoint);
+		static Result LoadCacheStringPool(const Span<const uint8_t> &fileData, uint64_t filePos, Vector<String> &outStrings);
+		DependencyNode *FindCachedNode(const NodeKey &nodeKey);
+		Result LoadCachedNode(size_t recordIndex, DependencyNode *&outNode);
+		Result LoadAllCachedNodes();
+		Result DecodePendingCachedRecords();
+		Result DecodeCachedRecordBody(const CachedNodeRecord &record);
+		Result GetCachedSegmentStrings(size_t segmentIndex, Span<const String> &outStrings);
+		void ReleaseCachedRecords();
+		void ResetCache();
 		Result SaveCache();
+		Result CollectCacheLiveNodes(Vector<DependencyNode *> &outLiveNodes) const;
+		static Result SerializeCacheSegment(BufferStream &outStream, const Span<DependencyNode * const> &nodes, size_t segmentIndex, uint64_t segmentFilePos);
+		Result SerializeCacheCheckpoint(IWriteStream &stream, const Span<DependencyNode * const> &liveNodes) const;
+		Result AppendCache(bool &outAppended, const CIPathView &cacheFileName, const Span<DependencyNode * const> &liveNodes, uint64_t &outBytesWritten);
+		Result CompactCache(const CIPathView &cacheFileName, const Span<DependencyNode * const> &liveNodes, uint64_t &outBytesWritten);
 
 		Result InternalEnumerateFilesOrDirectories(BuildFileLocation location, const CIPathView &path, bool isDirectoryMode, void *userdata, EnumerateFilesResultCallback_t resultCallback);
 
-		Result UpdateCAS(const data::ContentID &contentID);
+		Result UpdateCASFiles();
+		Result UpdateCAS(CASUpdate &update) const;
+		Result CopyCASSource(CASUpdate &update, const OSAbsPathView &destPath) const;
 
 		String m_targetName;
 		OSAbsPath m_srcDir;
@@ -684,7 +1005,40 @@ namespace rkit { namespace buildsystem
 
 		HashMap<data::ContentID, CASSource> m_casSources;
 
+		HashMap<MemoizedInputKey, UniquePtr<MemoizedInput> > m_memoizedInputs;
+		UniquePtr<IMutex> m_memoizedInputsMutex;
+
+		// Guards the file status caches, CAS sources, and node creation while analyses run on workers
+		UniquePtr<IMutex> m_graphMutex;
+
+		UniquePtr<IMutex> m_prefetchMutex;
+		UniquePtr<IConditionVariable> m_prefetchCompletedCondition;
+		PrefetchAnalysis *m_completedPrefetches;
+		bool m_prefetchingAnalyses;
+
+		// Created on first use and kept for the life of the instance, so that batches don't pay for thread startup
+		UniquePtr<utils::IThreadPool> m_batchThreadPool;
+		UniquePtr<IEvent> m_batchWakeEvent;
+		UniquePtr<IEvent> m_batchTerminateEvent;
+
 		IBuildFileSystem *m_fs;
+
+		// File positions of the string pool of each segment in the cache file
+		Vector<uint64_t> m_cacheSegments;
+		uint64_t m_cacheFileSize;
+		size_t m_nextCacheID;
+		size_t m_cacheCheckpointNodeCount;
+		bool m_cacheFileValid;
+
+		// Records of the loaded checkpoint, decoded out of the mapped file on first lookup.  The
+		// file is only appended to, so they stay valid until the cache is compacted.
+		UniquePtr<IFileMappingView> m_cacheView;
+		Vector<CachedNodeRecord> m_cachedRecords;
+		HashMap<NodeKey, size_t> m_cachedRecordLookup;
+		Vector<size_t> m_cachedRecordIndexByID;
+		Vector<CachedSegmentStrings> m_cachedSegmentStrings;
+		Vector<size_t> m_pendingCachedRecords;
+		bool m_cachedRecordsInCheckpoint;
 	};
 
 	NodeTypeKey::NodeTypeKey(uint32_t typeNamespace, uint32_t typeID)
@@ -703,6 +1057,88 @@ namespace rkit { namespace buildsystem
 		return m_typeID;
 	}
 
+	template<class TKey>
+	NodeItemIndex<TKey>::NodeItemIndex()
+	{
+	}
+
+	template<class TKey>
+	template<class TItem>
+	Result NodeItemIndex<TKey>::Find(bool &outFound, size_t &outIndex, const Vector<TItem> &items, const TKey &key, HashValue_t hash)
+	{
+		outFound = false;
+
+		if (items.Count() < kMinIndexedItems)
+		{
+			for (size_t i = 0; i < items.Count(); i++)
+			{
+				if (GetNodeItemKey(items[i]) == key)
+				{
+					outFound = true;
+					outIndex = i;
+					break;
+				}
+			}
+
+			RKIT_RETURN_OK;
+		}
+
+		RKIT_CHECK(Sync(items));
+
+		outFound = m_index.Find(outIndex, hash, [&items, &key](size_t itemIndex)
+			{
+				return GetNodeItemKey(items[itemIndex]) == key;
+			});
+
+		RKIT_RETURN_OK;
+	}
+
+	template<class TKey>
+	template<class TItem>
+	Result NodeItemIndex<TKey>::Sync(const Vector<TItem> &items)
+	{
+		// The list was reset or replaced
+		if (items.Count() < m_index.Count())
+			Clear();
+
+		if (items.Count() < kMinIndexedItems)
+			RKIT_RETURN_OK;
+
+		RKIT_CHECK(m_index.Reserve(items.Count()));
+
+		for (size_t i = m_index.Count(); i < items.Count(); i++)
+			m_index.Insert(i, Hasher<TKey>::ComputeHash(0, GetNodeItemKey(items[i])));
+
+		RKIT_RETURN_OK;
+	}
+
+	template<class TKey>
+	void NodeItemIndex<TKey>::Clear()
+	{
+		m_index.Clear();
+	}
+
+	FileLocationKey GetNodeItemKey(const FileStatus &fileStatus)
+	{
+		return FileLocationKey(fileStatus.m_location, fileStatus.m_filePath);
+	}
+
+	FileLocationKey GetNodeItemKey(const FileDependencyInfo &fileDependency)
+	{
+		return GetNodeItemKey(fileDependency.m_status);
+	}
+
+	DirectoryScanKey GetNodeItemKey(const DirectoryScanDependencyInfo &dirScanDependency)
+	{
+		const DirectoryScan &dirScan = dirScanDependency.m_dirScan;
+		return DirectoryScanKey(dirScan.m_directoryLocation, dirScan.m_directoryPath, dirScan.m_directoryMode);
+	}
+
+	IDependencyNode *GetNodeItemKey(const NodeDependencyInfo &nodeDependency)
+	{
+		return nodeDependency.m_node;
+	}
+
 	DependencyNode::DependencyNode(IDependencyNodeCompiler *compiler, uint32_t nodeNamespace, uint32_t nodeType, Vector<uint8_t> &&content, BuildFileLocation inputLocation)
 		: m_compiler(compiler)
 		, m_nodeType(nodeType)
@@ -715,6 +1151,9 @@ namespace rkit { namespace buildsystem
 		, m_lastCompilerVersion(0)
 		, m_serializedIndex(0)
 		, m_wasCompiled(false)
+		, m_cacheRecordDirty(true)
+		, m_inCacheLiveSet(false)
+		, m_inCacheCheckpoint(false)
 		, m_content(std::move(content))
 	{
 	}
@@ -748,6 +1187,9 @@ namespace rkit { namespace buildsystem
 
 	void DependencyNode::SetState(DependencyState depState)
 	{
+		if (m_dependencyState != depState || depState != DependencyState::UpToDate)
+			m_cacheRecordDirty = true;
+
 		m_dependencyState = depState;
 
 		if (depState == DependencyState::NotAnalyzedOrCompiled)
@@ -756,14 +1198,18 @@ namespace rkit { namespace buildsystem
 			m_analysisFileDependencies.Reset();
 			m_nodeDependencies.Reset();
 
-			m_compileProducts.Reset();
-			m_compileFileDependencies.Reset();
+			m_analysisProductIndex.Clear();
+			m_analysisFileDependencyIndex.Clear();
+			m_nodeDependencyIndex.Clear();
 		}
 
-		if (depState == DependencyState::NotCompiled)
+		if (depState == DependencyState::NotAnalyzedOrCompiled || depState == DependencyState::NotCompiled)
 		{
 			m_compileProducts.Reset();
 			m_compileFileDependencies.Reset();
+
+			m_compileProductIndex.Clear();
+			m_compileFileDependencyIndex.Clear();
 		}
 	}
 
@@ -777,6 +1223,11 @@ namespace rkit { namespace buildsystem
 		return m_wasCompiled;
 	}
 
+	void DependencyNode::ClearWasCompiled()
+	{
+		m_wasCompiled = false;
+	}
+
 	bool DependencyNode::IsContentBased() const
 	{
 		return m_content.Count() > 0;
@@ -838,6 +1289,7 @@ namespace rkit { namespace buildsystem
 	{
 		DependencyNodeCompilerFeedback feedback(static_cast<BuildSystemInstance *>(instance), this, false);
 
+		m_cacheRecordDirty = true;
 		m_lastCompilerVersion = m_compiler->GetVersion();
 		RKIT_CHECK(m_compiler->RunAnalysis(this, &feedback));
 
@@ -848,6 +1300,7 @@ namespace rkit { namespace buildsystem
 	{
 		DependencyNodeCompilerFeedback feedback(static_cast<BuildSystemInstance *>(instance), this, true);
 
+		m_cacheRecordDirty = true;
 		m_lastCompilerVersion = m_compiler->GetVersion();
 		RKIT_CHECK(m_compiler->RunCompile(this, &feedback));
 
@@ -895,17 +1348,15 @@ namespace rkit { namespace buildsystem
 		return CallbackSpan<DirectoryScanDependencyInfoView, const IDependencyNode *>(GetCompileDirectoryScanDependencyByIndex, this, m_compileDirectoryScanDependencies.Count());
 	}
 
-	Result DependencyNode::FindOrAddProduct(Vector<FileStatus> &products, BuildFileLocation location, const CIPathView &path, size_t &outIndex)
+	Result DependencyNode::FindOrAddProduct(Vector<FileStatus> &products, NodeItemIndex<FileLocationKey> &productIndex, BuildFileLocation location, const CIPathView &path, size_t &outIndex)
 	{
-		for (size_t i = 0; i < products.Count(); i++)
-		{
-			const FileStatus &fileStatus = products[i];
-			if (fileStatus.m_location == location && fileStatus.m_filePath == path)
-			{
-				outIndex = i;
-				RKIT_RETURN_OK;
-			}
-		}
+		const FileLocationKey key(location, path);
+
+		bool found = false;
+		RKIT_CHECK(productIndex.Find(found, outIndex, products, key, Hasher<FileLocationKey>::ComputeHash(0, key)));
+
+		if (found)
+			RKIT_RETURN_OK;
 
 		FileStatus newStatus;
 		RKIT_CHECK(newStatus.m_filePath.Set(path));
@@ -920,13 +1371,13 @@ namespace rkit { namespace buildsystem
 	Result DependencyNode::FindOrAddAnalysisProduct(BuildFileLocation location, const CIPathView &path, size_t &outIndex)
 	{
 		RKIT_ASSERT(path.Length() != 0);
-		return FindOrAddProduct(m_analysisProducts, location, path, outIndex);
+		return FindOrAddProduct(m_analysisProducts, m_analysisProductIndex, location, path, outIndex);
 	}
 
 	Result DependencyNode::FindOrAddCompileProduct(BuildFileLocation location, const CIPathView &path, size_t &outIndex)
 	{
 		RKIT_ASSERT(path.Length() != 0);
-		return FindOrAddProduct(m_compileProducts, location, path, outIndex);
+		return FindOrAddProduct(m_compileProducts, m_compileProductIndex, location, path, outIndex);
 	}
 
 	Result DependencyNode::AddCASProduct(const data::ContentID &contentID)
@@ -942,33 +1393,36 @@ namespace rkit { namespace buildsystem
 
 	Result DependencyNode::AddAnalysisFileDependency(const FileDependencyInfoView &fileInfo)
 	{
-		return AddFileDependency(m_analysisFileDependencies, fileInfo);
+		return AddFileDependency(m_analysisFileDependencies, m_analysisFileDependencyIndex, fileInfo);
 	}
 
 	Result DependencyNode::AddCompileFileDependency(const FileDependencyInfoView &fileInfo)
 	{
-		return AddFileDependency(m_compileFileDependencies, fileInfo);
+		return AddFileDependency(m_compileFileDependencies, m_compileFileDependencyIndex, fileInfo);
 	}
 
 	Result DependencyNode::AddAnalysisDirectoryScanDependency(const DirectoryScanDependencyInfoView &dirScanInfo)
 	{
-		return AddDirectoryScanDependency(m_analysisDirectoryScanDependencies, dirScanInfo);
+		return AddDirectoryScanDependency(m_analysisDirectoryScanDependencies, m_analysisDirectoryScanDependencyIndex, dirScanInfo);
 	}
 
 	Result DependencyNode::AddCompileDirectoryScanDependency(const DirectoryScanDependencyInfoView &dirScanInfo)
 	{
-		return AddDirectoryScanDependency(m_compileDirectoryScanDependencies, dirScanInfo);
+		return AddDirectoryScanDependency(m_compileDirectoryScanDependencies, m_compileDirectoryScanDependencyIndex, dirScanInfo);
 	}
 
-	Result DependencyNode::AddFileDependency(Vector<FileDependencyInfo> &fileDependencies, const FileDependencyInfoView &fileInfo)
+	Result DependencyNode::AddFileDependency(Vector<FileDependencyInfo> &fileDependencies, NodeItemIndex<FileLocationKey> &fileDependencyIndex, const FileDependencyInfoView &fileInfo)
 	{
-		for (FileDependencyInfo &existingFDI : fileDependencies)
+		const FileLocationKey key(fileInfo.m_status.m_location, fileInfo.m_status.m_filePath);
+
+		bool found = false;
+		size_t existingIndex = 0;
+		RKIT_CHECK(fileDependencyIndex.Find(found, existingIndex, fileDependencies, key, Hasher<FileLocationKey>::ComputeHash(0, key)));
+
+		if (found)
 		{
-			if (existingFDI.m_status.m_location == fileInfo.m_status.m_location && existingFDI.m_status.m_filePath == fileInfo.m_status.m_filePath)
-			{
-				RKIT_CHECK(existingFDI.Set(fileInfo));
-				RKIT_RETURN_OK;
-			}
+			RKIT_CHECK(fileDependencies[existingIndex].Set(fileInfo));
+			RKIT_RETURN_OK;
 		}
 
 		FileDependencyInfo fdi;
@@ -979,19 +1433,20 @@ namespace rkit { namespace buildsystem
 		RKIT_RETURN_OK;
 	}
 
-	Result DependencyNode::AddDirectoryScanDependency(Vector<DirectoryScanDependencyInfo> &dirScanDependencies, const DirectoryScanDependencyInfoView &dirScanInfo)
+	Result DependencyNode::AddDirectoryScanDependency(Vector<DirectoryScanDependencyInfo> &dirScanDependencies, NodeItemIndex<DirectoryScanKey> &dirScanDependencyIndex, const DirectoryScanDependencyInfoView &dirScanInfo)
 	{
 		RKIT_ASSERT(dirScanInfo.m_dirScan.m_directoryPath.Length() != 0);
 
-		for (DirectoryScanDependencyInfo &existingDSDI : dirScanDependencies)
+		const DirectoryScanKey key(dirScanInfo.m_dirScan.m_directoryLocation, dirScanInfo.m_dirScan.m_directoryPath, dirScanInfo.m_dirScan.m_directoryMode);
+
+		bool found = false;
+		size_t existingIndex = 0;
+		RKIT_CHECK(dirScanDependencyIndex.Find(found, existingIndex, dirScanDependencies, key, Hasher<DirectoryScanKey>::ComputeHash(0, key)));
+
+		if (found)
 		{
-			if (existingDSDI.m_dirScan.m_directoryLocation == dirScanInfo.m_dirScan.m_directoryLocation
-				&& existingDSDI.m_dirScan.m_directoryPath == dirScanInfo.m_dirScan.m_directoryPath
-				&& existingDSDI.m_dirScan.m_directoryMode == dirScanInfo.m_dirScan.m_directoryMode)
-			{
-				RKIT_CHECK(existingDSDI.Set(dirScanInfo));
-				RKIT_RETURN_OK;
-			}
+			RKIT_CHECK(dirScanDependencies[existingIndex].Set(dirScanInfo));
+			RKIT_RETURN_OK;
 		}
 
 		DirectoryScanDependencyInfo dsdi;
@@ -1130,8 +1585,8 @@ namespace rkit { namespace buildsystem
 		return stream.WriteAll(bytes, length);
 	}
 
-	serializer::DeserializeResolver::DeserializeResolver(const Span<const UniquePtr<DependencyNode>> &nodes, const Span<const String> &strings)
-		: m_nodes(nodes)
+	serializer::DeserializeResolver::DeserializeResolver(BuildSystemInstance &instance, const Span<const String> &strings)
+		: m_instance(instance)
 		, m_strings(strings)
 	{
 	}
@@ -1147,10 +1602,10 @@ namespace rkit { namespace buildsystem
 
 	Result serializer::DeserializeResolver::GetDependencyNode(size_t index, IDependencyNode *&outNode) const
 	{
-		if (index >= m_nodes.Count())
-			RKIT_THROW(ResultCode::kInvalidParameter);
+		DependencyNode *node = nullptr;
+		RKIT_CHECK(m_instance.LoadCachedNodeByID(index, node));
 
-		outNode = m_nodes[index].Get();
+		outNode = node;
 		RKIT_RETURN_OK;
 	}
 
@@ -1309,17 +1764,34 @@ namespace rkit { namespace buildsystem
 
 	Result DependencyNode::AddNodeDependency(const NodeDependencyInfo &nodeInfo)
 	{
-		for (const NodeDependencyInfo &existingInfo : m_nodeDependencies)
-		{
-			if (nodeInfo.m_node == existingInfo.m_node)
-				RKIT_RETURN_OK;
-		}
+		bool found = false;
+		size_t existingIndex = 0;
+		RKIT_CHECK(m_nodeDependencyIndex.Find(found, existingIndex, m_nodeDependencies, nodeInfo.m_node, Hasher<IDependencyNode *>::ComputeHash(0, nodeInfo.m_node)));
+
+		if (found)
+			RKIT_RETURN_OK;
 
 		RKIT_CHECK(m_nodeDependencies.Append(nodeInfo));
 
 		RKIT_RETURN_OK;
 	}
 
+	Result DependencyNode::FindFileDependency(bool isCompilePhase, BuildFileLocation location, const CIPathView &path, const FileDependencyInfo *&outFileInfo)
+	{
+		Vector<FileDependencyInfo> &fileDependencies = (isCompilePhase ? m_compileFileDependencies : m_analysisFileDependencies);
+		NodeItemIndex<FileLocationKey> &fileDependencyIndex = (isCompilePhase ? m_compileFileDependencyIndex : m_analysisFileDependencyIndex);
+
+		const FileLocationKey key(location, path);
+
+		bool found = false;
+		size_t index = 0;
+		RKIT_CHECK(fileDependencyIndex.Find(found, index, fileDependencies, key, Hasher<FileLocationKey>::ComputeHash(0, key)));
+
+		outFileInfo = found ? &fileDependencies[index] : nullptr;
+
+		RKIT_RETURN_OK;
+	}
+
 	Result DependencyNode::SerializeInitialState(IWriteStream &stream) const
 	{
 		RKIT_CHECK(stream.WriteAll(&m_nodeNamespace, sizeof(m_nodeNamespace)));
@@ -1408,6 +1880,8 @@ namespace rkit { namespace buildsystem
 	Result DependencyNode::MarkProductFinished(bool isCompilePhase, size_t productIndex, const FileStatusView &fstatus)
 	{
 		Vector<FileStatus> &products = (isCompilePhase ? m_compileProducts : m_analysisProducts);
+
+		m_cacheRecordDirty = true;
 		return products[productIndex].Set(fstatus);
 	}
 
@@ -1421,6 +1895,47 @@ namespace rkit { namespace buildsystem
 		return m_serializedIndex;
 	}
 
+	void DependencyNode::MarkCacheRecordDirty()
+	{
+		m_cacheRecordDirty = true;
+	}
+
+	bool DependencyNode::IsCacheRecordDirty() const
+	{
+		return m_cacheRecordDirty;
+	}
+
+	void DependencyNode::SetCacheRecord(const BuildCacheRecordLocation &location)
+	{
+		m_cacheRecord = location;
+		m_cacheRecordDirty = false;
+	}
+
+	const BuildCacheRecordLocation &DependencyNode::GetCacheRecord() const
+	{
+		return m_cacheRecord;
+	}
+
+	bool DependencyNode::IsInCacheLiveSet() const
+	{
+		return m_inCacheLiveSet;
+	}
+
+	void DependencyNode::SetInCacheLiveSet(bool inLiveSet)
+	{
+		m_inCacheLiveSet = inLiveSet;
+	}
+
+	bool DependencyNode::IsInCacheCheckpoint() const
+	{
+		return m_inCacheCheckpoint;
+	}
+
+	void DependencyNode::SetInCacheCheckpoint(bool inCheckpoint)
+	{
+		m_inCacheCheckpoint = inCheckpoint;
+	}
+
 	DependencyNode::DependencyNodeCompilerFeedback::DependencyNodeCompilerFeedback(BuildSystemInstance *instance, DependencyNode *node, bool isCompilePhase)
 		: m_buildInstance(instance)
 		, m_dependencyNode(node)
@@ -1432,17 +1947,17 @@ namespace rkit { namespace buildsystem
 
 	Result DependencyNode::DependencyNodeCompilerFeedback::CheckInputExists(BuildFileLocation location, const CIPathView &path, bool &outExists)
 	{
-		CallbackSpan<FileDependencyInfoView, const IDependencyNode *> depsSpan = m_isCompilePhase ? m_dependencyNode->GetCompileFileDependencies() : m_dependencyNode->GetAnalysisFileDependencies();
+		const FileDependencyInfo *existingFileInfo = nullptr;
+		RKIT_CHECK(m_dependencyNode->FindFileDependency(m_isCompilePhase, location, path, existingFileInfo));
 
-		for (FileDependencyInfoView fStatus : depsSpan)
+		if (existingFileInfo)
 		{
-			if (fStatus.m_status.m_location == location && fStatus.m_status.m_filePath == path)
-			{
-				outExists = fStatus.m_fileExists;
-				RKIT_RETURN_OK;
-			}
+			outExists = existingFileInfo->m_fileExists;
+			RKIT_RETURN_OK;
 		}
 
+		MutexLock lock(m_buildInstance->GetGraphMutex());
+
 		FileStatusView newFStatusView;
 		bool exists = false;
 		RKIT_CHECK(m_buildInstance->ResolveFileStatus(location, path, false, newFStatusView, true, exists));
@@ -1486,24 +2001,69 @@ namespace rkit { namespace buildsystem
 	{
 		inputFile.Reset();
 
-		CallbackSpan<FileDependencyInfoView, const IDependencyNode *> depsSpan = m_isCompilePhase ? m_dependencyNode->GetCompileFileDependencies() : m_dependencyNode->GetAnalysisFileDependencies();
+		const FileDependencyInfo *existingFileInfo = nullptr;
+		RKIT_CHECK(m_dependencyNode->FindFileDependency(m_isCompilePhase, location, path, existingFileInfo));
+
+		if (existingFileInfo && !existingFileInfo->m_fileExists)
+			RKIT_RETURN_OK;
 
-		for (const FileDependencyInfoView &fStatus : depsSpan)
 		{
-			if (fStatus.m_status.m_location == location && fStatus.m_status.m_filePath == path)
-			{
-				if (!fStatus.m_fileExists)
-					RKIT_RETURN_OK;
-			}
+			MutexLock lock(m_buildInstance->GetGraphMutex());
+
+			FileStatusView newFStatusView;
+			bool exists = false;
+			RKIT_CHECK(AddInputFileDependency(location, path, newFStatusView, exists));
 		}
 
-		FileStatusView newFStatusView;
+		RKIT_CHECK(m_buildInstance->TryOpenFileRead(location, path, inputFile));
+
+		RKIT_RETURN_OK;
+	}
+
+	Result DependencyNode::DependencyNodeCompilerFeedback::OpenMemoizedInput(BuildFileLocation location, const CIPathView &path, ParseMemoizedInputCallback_t parseCallback, const IMemoizedInput *&outParsedInput)
+	{
+		RKIT_CHECK(TryOpenMemoizedInput(location, path, parseCallback, outParsedInput));
+		if (!outParsedInput)
+			RKIT_THROW(ResultCode::kFileOpenError);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result DependencyNode::DependencyNodeCompilerFeedback::TryOpenMemoizedInput(BuildFileLocation location, const CIPathView &path, ParseMemoizedInputCallback_t parseCallback, const IMemoizedInput *&outParsedInput)
+	{
+		outParsedInput = nullptr;
+
+		// The cached status may be replaced once the lock is released, so keep a copy
+		FileStatusView memoStatusView;
 		bool exists = false;
-		RKIT_CHECK(m_buildInstance->ResolveFileStatus(location, path, false, newFStatusView, true, exists));
+
+		{
+			MutexLock lock(m_buildInstance->GetGraphMutex());
+
+			FileStatusView fStatusView;
+			RKIT_CHECK(AddInputFileDependency(location, path, fStatusView, exists));
+
+			memoStatusView.m_location = location;
+			memoStatusView.m_filePath = path;
+			memoStatusView.m_fileSize = fStatusView.m_fileSize;
+			memoStatusView.m_fileTime = fStatusView.m_fileTime;
+		}
+
+		if (!exists)
+			RKIT_RETURN_OK;
+
+		RKIT_CHECK(m_buildInstance->ResolveMemoizedInput(location, path, memoStatusView, parseCallback, outParsedInput));
+
+		RKIT_RETURN_OK;
+	}
+
+	Result DependencyNode::DependencyNodeCompilerFeedback::AddInputFileDependency(BuildFileLocation location, const CIPathView &path, FileStatusView &outStatusView, bool &outExists)
+	{
+		RKIT_CHECK(m_buildInstance->ResolveFileStatus(location, path, false, outStatusView, true, outExists));
 
 		FileDependencyInfoView newDepInfo;
-		newDepInfo.m_status = newFStatusView;
-		newDepInfo.m_fileExists = exists;
+		newDepInfo.m_status = outStatusView;
+		newDepInfo.m_fileExists = outExists;
 		newDepInfo.m_mustBeUpToDate = true;
 
 		if (m_isCompilePhase)
@@ -1515,8 +2075,6 @@ namespace rkit { namespace buildsystem
 			RKIT_CHECK(m_dependencyNode->AddAnalysisFileDependency(newDepInfo));
 		}
 
-		RKIT_CHECK(m_buildInstance->TryOpenFileRead(location, path, inputFile));
-
 		RKIT_RETURN_OK;
 	}
 
@@ -1550,7 +2108,10 @@ namespace rkit { namespace buildsystem
 
 		RKIT_CHECK(m_dependencyNode->AddCASProduct(contentID));
 
-		RKIT_CHECK(m_buildInstance->RegisterCASSource(contentID, location, path));
+		{
+			MutexLock lock(m_buildInstance->GetGraphMutex());
+			RKIT_CHECK(m_buildInstance->RegisterCASSource(contentID, location, path));
+		}
 
 		CIPath casPath;
 		RKIT_CHECK(casPath.AppendComponent(u8"cas"));
@@ -1595,7 +2156,10 @@ namespace rkit { namespace buildsystem
 
 		memcpy(outContentID.m_data, digest.m_data, sizeof(digest.m_data));
 
-		RKIT_CHECK(m_buildInstance->RegisterCASSource(outContentID, location, path));
+		{
+			MutexLock lock(m_buildInstance->GetGraphMutex());
+			RKIT_CHECK(m_buildInstance->RegisterCASSource(outContentID, location, path));
+		}
 
 		RKIT_CHECK(m_dependencyNode->AddCASProduct(outContentID));
 
@@ -1610,7 +2174,11 @@ namespace rkit { namespace buildsystem
 	Result DependencyNode::DependencyNodeCompilerFeedback::AddNodeDependency(uint32_t nodeTypeNamespace, uint32_t nodeTypeID, BuildFileLocation inputFileLocation, const StringView &identifier)
 	{
 		IDependencyNode *node = nullptr;
-		RKIT_CHECK(m_buildInstance->FindOrCreateNamedNode(nodeTypeNamespace, nodeTypeID, inputFileLocation, identifier, node));
+
+		{
+			MutexLock lock(m_buildInstance->GetGraphMutex());
+			RKIT_CHECK(m_buildInstance->FindOrCreateNamedNode(nodeTypeNamespace, nodeTypeID, inputFileLocation, identifier, node));
+		}
 
 		NodeDependencyInfo depInfo;
 		depInfo.m_mustBeUpToDate = true;
@@ -1629,7 +2197,11 @@ namespace rkit { namespace buildsystem
 	{
 		DirectoryScanDependencyInfoView newDepInfo;
 
-		RKIT_CHECK(m_buildInstance->ResolveDirectoryScan(location, path, directoryMode, newDepInfo.m_dirScan, true, newDepInfo.m_dirExists));
+		// Cached directory scans are never replaced, so the view stays valid after unlocking
+		{
+			MutexLock lock(m_buildInstance->GetGraphMutex());
+			RKIT_CHECK(m_buildInstance->ResolveDirectoryScan(location, path, directoryMode, newDepInfo.m_dirScan, true, newDepInfo.m_dirExists));
+		}
 
 		if (m_isCompilePhase)
 		{
@@ -1678,6 +2250,8 @@ namespace rkit { namespace buildsystem
 
 	Result DependencyNode::DependencyNodeCompilerFeedback::CheckedMarkOutputFileFinished(size_t productIndex, BuildFileLocation location, const CIPathView &path)
 	{
+		MutexLock lock(m_buildInstance->GetGraphMutex());
+
 		FileStatusView fileStatusView;
 		bool exists = false;
 		RKIT_CHECK(m_buildInstance->ResolveFileStatus(location, path, false, fileStatusView, false, exists));
@@ -1807,7 +2381,14 @@ namespace rkit { namespace buildsystem
 	}
 
 	BuildSystemInstance::BuildSystemInstance()
-		: m_fs(nullptr)
+		: m_completedPrefetches(nullptr)
+		, m_prefetchingAnalyses(false)
+		, m_fs(nullptr)
+		, m_cacheFileSize(0)
+		, m_nextCacheID(1)
+		, m_cacheCheckpointNodeCount(0)
+		, m_cacheFileValid(false)
+		, m_cachedRecordsInCheckpoint(false)
 	{
 	}
 
@@ -1824,6 +2405,13 @@ namespace rkit { namespace buildsystem
 		RKIT_CHECK(m_dataFilesDir.Set(dataFilesDir));
 		RKIT_CHECK(m_dataContentDir.Set(dataContentDir));
 
+		RKIT_CHECK(GetDrivers().m_systemDriver->CreateMutex(m_memoizedInputsMutex));
+		RKIT_CHECK(GetDrivers().m_systemDriver->CreateMutex(m_graphMutex));
+		RKIT_CHECK(GetDrivers().m_systemDriver->CreateMutex(m_prefetchMutex));
+		RKIT_CHECK(GetDrivers().m_systemDriver->CreateConditionVariable(m_prefetchCompletedCondition));
+		RKIT_CHECK(GetDrivers().m_systemDriver->CreateEvent(m_batchWakeEvent, true, false));
+		RKIT_CHECK(GetDrivers().m_systemDriver->CreateEvent(m_batchTerminateEvent, true, false));
+
 		UniquePtr<IDependencyNodeCompiler> depsCompiler;
 		RKIT_CHECK(New<DepsNodeCompiler>(depsCompiler));
 
@@ -1843,23 +2431,20 @@ namespace rkit { namespace buildsystem
 		RKIT_RETURN_OK;
 	}
 
-	Result BuildSystemInstance::CheckedLoadCache(ISeekableReadStream &seekableStream, FilePos_t pos)
+	Result BuildSystemInstance::LoadCacheStringPool(const Span<const uint8_t> &fileData, uint64_t filePos, Vector<String> &outStrings)
 	{
-		RKIT_CHECK(seekableStream.SeekStart(pos));
-
-		IReadStream &stream = seekableStream;
-
-		Vector<UniquePtr<DependencyNode>> nodesVector;
-		HashMap<NodeKey, DependencyNode *> nodeLookup;
+		if (filePos > fileData.Count())
+			RKIT_THROW(ResultCode::kOperationFailed);
 
-		Vector<String> stringsVector;
+		ReadOnlyMemoryStream stream(fileData.SubSpan(static_cast<size_t>(filePos)));
 
 		size_t numStrings = 0;
 		RKIT_CHECK(serializer::DeserializeCompactSize(stream, numStrings));
 
-		RKIT_CHECK(stringsVector.Resize(numStrings));
+		if (numStrings > stream.GetSize())
+			RKIT_THROW(ResultCode::kOperationFailed);
 
-		Span<const String> strings = stringsVector.ToSpan();
+		RKIT_CHECK(outStrings.Resize(numStrings));
 
 		for (size_t i = 0; i < numStrings; i++)
 		{
@@ -1871,51 +2456,122 @@ namespace rkit { namespace buildsystem
 
 			RKIT_CHECK(stream.ReadAllSpan(strBuf.GetSpan()));
 
-			stringsVector[i] = String(std::move(strBuf));
+			outStrings[i] = String(std::move(strBuf));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::CheckedLoadCache(const Span<const uint8_t> &fileData, const BuildCacheInstanceInfo &checkpoint)
+	{
+		if (checkpoint.m_filePos > fileData.Count() || checkpoint.m_size > fileData.Count() - checkpoint.m_filePos)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		ReadOnlyMemoryStream stream(fileData.SubSpan(static_cast<size_t>(checkpoint.m_filePos), static_cast<size_t>(checkpoint.m_size)));
+
+		// Segment string pools are loaded when a record in the segment is decoded
+		size_t numSegments = 0;
+		RKIT_CHECK(serializer::DeserializeCompactSize(stream, numSegments));
+
+		if (numSegments > stream.GetSize())
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		Vector<uint64_t> segments;
+		RKIT_CHECK(segments.Resize(numSegments));
+		RKIT_CHECK(stream.ReadAllSpan(segments.ToSpan()));
+
+		for (uint64_t segmentFilePos : segments)
+		{
+			if (segmentFilePos > fileData.Count())
+				RKIT_THROW(ResultCode::kOperationFailed);
 		}
 
+		Vector<CachedSegmentStrings> segmentStrings;
+		RKIT_CHECK(segmentStrings.Resize(numSegments));
+
+		// Node records
 		size_t numNodes = 0;
+		size_t nextCacheID = 0;
 		RKIT_CHECK(serializer::DeserializeCompactSize(stream, numNodes));
+		RKIT_CHECK(serializer::DeserializeCompactSize(stream, nextCacheID));
+
+		if (nextCacheID == 0 || nextCacheID > fileData.Count() || numNodes >= nextCacheID)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		Vector<size_t> recordIndexByID;
+		RKIT_CHECK(recordIndexByID.Resize(nextCacheID));
 
-		RKIT_CHECK(nodesVector.Resize(numNodes));
+		for (size_t &recordIndex : recordIndexByID)
+			recordIndex = std::numeric_limits<size_t>::max();
 
-		Span<const UniquePtr<DependencyNode>> nodes = nodesVector.ToSpan();
+		Vector<CachedNodeRecord> records;
+		RKIT_CHECK(records.Resize(numNodes));
 
 		for (size_t i = 0; i < numNodes; i++)
 		{
-			uint32_t nodeNamespace = 0;
-			uint32_t nodeType = 0;
-			BuildFileLocation inputLocation = BuildFileLocation::kInvalid;
-			Vector<uint8_t> content;
+			CachedNodeRecord &record = records[i];
+
+			RKIT_CHECK(serializer::DeserializeCompactSize(stream, record.m_cacheID));
+			RKIT_CHECK(serializer::DeserializeCompactSize(stream, record.m_location.m_segmentIndex));
+			RKIT_CHECK(stream.ReadAll(&record.m_location.m_filePos, sizeof(record.m_location.m_filePos)));
+			RKIT_CHECK(stream.ReadAll(&record.m_location.m_size, sizeof(record.m_location.m_size)));
+
+			RKIT_CHECK(stream.ReadAll(&record.m_nodeNamespace, sizeof(record.m_nodeNamespace)));
+			RKIT_CHECK(stream.ReadAll(&record.m_nodeType, sizeof(record.m_nodeType)));
+			RKIT_CHECK(serializer::DeserializeEnum(stream, record.m_inputLocation));
 
-			RKIT_CHECK(DependencyNode::DeserializeInitialState(stream, nodeNamespace, nodeType, content, inputLocation));
+			size_t identifierLength = 0;
+			RKIT_CHECK(serializer::DeserializeCompactSize(stream, identifierLength));
 
-			HashMap<NodeTypeKey, UniquePtr<IDependencyNodeCompiler>>::ConstIterator_t it = m_nodeCompilers.Find(NodeTypeKey(nodeNamespace, nodeType));
-			if (it == m_nodeCompilers.end())
+			if (identifierLength > stream.GetSize())
 				RKIT_THROW(ResultCode::kOperationFailed);
 
-			IDependencyNodeCompiler *compiler = it.Value().Get();
+			StringConstructionBuffer strBuf;
+			RKIT_CHECK(strBuf.Allocate(identifierLength));
+			RKIT_CHECK(stream.ReadAllSpan(strBuf.GetSpan()));
 
-			RKIT_CHECK(New<DependencyNode>(nodesVector[i], compiler, nodeNamespace, nodeType, std::move(content), inputLocation));
-		}
+			record.m_identifier = String(std::move(strBuf));
 
-		serializer::DeserializeResolver resolver(nodes, strings);
-		for (size_t i = 0; i < numNodes; i++)
-		{
-			RKIT_CHECK(nodes[i]->Deserialize(stream, resolver));
+			const BuildCacheRecordLocation &location = record.m_location;
+
+			if (record.m_cacheID == 0 || record.m_cacheID >= nextCacheID || recordIndexByID[record.m_cacheID] != std::numeric_limits<size_t>::max() || location.m_segmentIndex >= numSegments)
+				RKIT_THROW(ResultCode::kOperationFailed);
+
+			if (location.m_filePos > fileData.Count() || location.m_size > fileData.Count() - location.m_filePos)
+				RKIT_THROW(ResultCode::kOperationFailed);
+
+			if (m_nodeCompilers.Find(NodeTypeKey(record.m_nodeNamespace, record.m_nodeType)) == m_nodeCompilers.end())
+				RKIT_THROW(ResultCode::kOperationFailed);
+
+			recordIndexByID[record.m_cacheID] = i;
 		}
 
+		// Keys refer to the record identifiers, so the lookup is built once the records are in place
+		HashMap<NodeKey, size_t> recordLookup;
+
 		for (size_t i = 0; i < numNodes; i++)
 		{
-			DependencyNode *node = nodes[i].Get();
+			const CachedNodeRecord &record = records[i];
 
-			NodeKey nodeKey(NodeTypeKey(node->GetDependencyNodeNamespace(), node->GetDependencyNodeType()), node->GetInputFileLocation(), node->GetIdentifier());
+			NodeKey nodeKey(NodeTypeKey(record.m_nodeNamespace, record.m_nodeType), record.m_inputLocation, record.m_identifier);
+
+			if (recordLookup.Find(nodeKey) != recordLookup.end())
+				RKIT_THROW(ResultCode::kOperationFailed);
 
-			RKIT_CHECK(nodeLookup.Set(nodeKey, node));
+			RKIT_CHECK(recordLookup.Set(nodeKey, i));
 		}
 
-		m_nodes = std::move(nodesVector);
-		m_nodeLookup = std::move(nodeLookup);
+		m_cachedRecords = std::move(records);
+		m_cachedRecordLookup = std::move(recordLookup);
+		m_cachedRecordIndexByID = std::move(recordIndexByID);
+		m_cachedSegmentStrings = std::move(segmentStrings);
+		m_cachedRecordsInCheckpoint = true;
+
+		m_cacheSegments = std::move(segments);
+		m_cacheFileSize = fileData.Count();
+		m_nextCacheID = nextCacheID;
+		m_cacheCheckpointNodeCount = numNodes;
+		m_cacheFileValid = true;
 
 		RKIT_RETURN_OK;
 	}
@@ -1925,37 +2581,346 @@ namespace rkit { namespace buildsystem
 		if (m_nodes.Count() != 0)
 			RKIT_THROW(ResultCode::kOperationFailed);
 
+		ISystemDriver &sysDriver = *GetDrivers().m_systemDriver;
+
+		const uint64_t startTime = sysDriver.GetHighResTimestamp();
+
+		RKIT_CHECK(LoadCacheFile(GetCacheFileName()));
+
+		if (m_cacheFileValid)
+		{
+			const uint64_t elapsedMSec = (sysDriver.GetHighResTimestamp() - startTime) * 1000u / sysDriver.GetHighResTimestampFrequency();
+			rkit::log::LogInfoFmt(u8"Indexed {} cached node records from {} segments in {} ms", m_cachedRecords.Count(), m_cacheSegments.Count(), elapsedMSec);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::LoadCacheFile(const CIPathView &cacheFileName)
+	{
 		OSAbsPath cacheFullPath;
-		RKIT_CHECK(ConstructIntermediatePath(cacheFullPath, GetCacheFileName()));
+		RKIT_CHECK(ConstructIntermediatePath(cacheFullPath, cacheFileName));
 
 		ISystemDriver &sysDriver = *GetDrivers().m_systemDriver;
 
-		UniquePtr<ISeekableReadStream> graphStream;
-		RKIT_CHECK(sysDriver.OpenFileReadAbs(graphStream, cacheFullPath, true));
+		UniquePtr<IFileMapping> graphMapping;
+		RKIT_CHECK(sysDriver.OpenFileMappingAbs(graphMapping, cacheFullPath, FileMappingMode::kReadOnly, FileAccessHint::kRandom, true));
 
-		if (!graphStream.IsValid())
+		if (!graphMapping.IsValid())
 			RKIT_RETURN_OK;
 
-		BuildCacheFileHeader header;
-		size_t countRead = 0;
-		RKIT_CHECK(graphStream->ReadPartial(&header, sizeof(header), countRead));
-		if (countRead != sizeof(header))
+		const FilePos_t fileSize = graphMapping->GetFileSize();
+		if (fileSize < sizeof(BuildCacheFileHeader) || fileSize > std::numeric_limits<size_t>::max())
 			RKIT_RETURN_OK;
 
+		// The view stays mapped so that records can be decoded out of the page cache when their nodes are looked up
+		UniquePtr<IFileMappingView> graphView;
+		RKIT_CHECK(graphMapping->MapEntireFile(graphView));
+
+		graphMapping.Reset();
+
+		const Span<const uint8_t> fileData = graphView->GetBytes();
+
+		BuildCacheFileHeader header;
+		memcpy(&header, fileData.Ptr(), sizeof(header));
+
 		if (header.m_identifier != BuildCacheFileHeader::kCacheIdentifier || header.m_version != BuildCacheFileHeader::kCacheVersion || header.m_activeInstance >= 2)
 			RKIT_RETURN_OK;
 
 		const BuildCacheInstanceInfo &cacheInstance = header.m_instances[header.m_activeInstance];
 
-		PackedResultAndExtCode result = RKIT_TRY_EVAL(CheckedLoadCache(*graphStream, cacheInstance.m_filePos));
+		PackedResultAndExtCode result = RKIT_TRY_EVAL(CheckedLoadCache(fileData, cacheInstance));
 
 		if (!utils::ResultIsOK(result))
 		{
 			rkit::log::Error(u8"A problem occurred while loading the build system cache");
-			m_nodeLookup.Clear();
-			m_nodes.Reset();
+			ResetCache();
+
+			RKIT_RETURN_OK;
+		}
+
+		m_cacheView = std::move(graphView);
+
+		RKIT_RETURN_OK;
+	}
+
+	DependencyNode *BuildSystemInstance::FindCachedNode(const NodeKey &nodeKey)
+	{
+		HashMap<NodeKey, size_t>::ConstIterator_t it = m_cachedRecordLookup.Find(nodeKey);
+
+		if (it == m_cachedRecordLookup.end())
+			return nullptr;
+
+		const size_t recordIndex = it.Value();
+
+		DependencyNode *node = nullptr;
+		PackedResultAndExtCode result = RKIT_TRY_EVAL(LoadCachedNode(recordIndex, node));
+
+		if (utils::ResultIsOK(result))
+			result = RKIT_TRY_EVAL(DecodePendingCachedRecords());
+
+		if (!utils::ResultIsOK(result))
+		{
+			const StringView identifier = m_cachedRecords[recordIndex].m_identifier;
+			rkit::log::ErrorFmt(u8"A problem occurred while loading cached node {}", identifier);
+			return nullptr;
+		}
+
+		return node;
+	}
+
+	Result BuildSystemInstance::LoadCachedNodeByID(size_t cacheID, DependencyNode *&outNode)
+	{
+		if (cacheID >= m_cachedRecordIndexByID.Count() || m_cachedRecordIndexByID[cacheID] == std::numeric_limits<size_t>::max())
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		return LoadCachedNode(m_cachedRecordIndexByID[cacheID], outNode);
+	}
+
+	Result BuildSystemInstance::LoadCachedNode(size_t recordIndex, DependencyNode *&outNode)
+	{
+		CachedNodeRecord &record = m_cachedRecords[recordIndex];
+
+		if (record.m_node != nullptr)
+		{
+			outNode = record.m_node;
+			RKIT_RETURN_OK;
+		}
+
+		if (record.m_loadFailed)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		record.m_loadFailed = true;
+
+		const Span<const uint8_t> recordData = m_cacheView->GetBytes().SubSpan(static_cast<size_t>(record.m_location.m_filePos), static_cast<size_t>(record.m_location.m_size));
+		ReadOnlyMemoryStream recordStream(recordData);
+
+		uint32_t nodeNamespace = 0;
+		uint32_t nodeType = 0;
+		BuildFileLocation inputLocation = BuildFileLocation::kInvalid;
+		Vector<uint8_t> content;
+
+		RKIT_CHECK(DependencyNode::DeserializeInitialState(recordStream, nodeNamespace, nodeType, content, inputLocation));
+
+		if (nodeNamespace != record.m_nodeNamespace || nodeType != record.m_nodeType || inputLocation != record.m_inputLocation)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		HashMap<NodeTypeKey, UniquePtr<IDependencyNodeCompiler>>::ConstIterator_t it = m_nodeCompilers.Find(NodeTypeKey(nodeNamespace, nodeType));
+		if (it == m_nodeCompilers.end())
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		UniquePtr<DependencyNode> node;
+		RKIT_CHECK(New<DependencyNode>(node, it.Value().Get(), nodeNamespace, nodeType, std::move(content), inputLocation));
+		RKIT_CHECK(node->Initialize(record.m_identifier));
+
+		node->SetSerializedIndex(record.m_cacheID);
+		node->SetCacheRecord(record.m_location);
+		node->SetInCacheCheckpoint(m_cachedRecordsInCheckpoint);
+
+		DependencyNode *nodePtr = node.Get();
+		RKIT_CHECK(AddNode(std::move(node)));
+
+		record.m_node = nodePtr;
+		record.m_bodyOffset = recordStream.Tell();
+		record.m_loadFailed = false;
+
+		// The rest of the record can refer to other nodes, so it's decoded once this lookup is done
+		RKIT_CHECK(m_pendingCachedRecords.Append(recordIndex));
+
+		outNode = nodePtr;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::LoadAllCachedNodes()
+	{
+		for (size_t i = 0; i < m_cachedRecords.Count(); i++)
+		{
+			DependencyNode *node = nullptr;
+			RKIT_CHECK(LoadCachedNode(i, node));
+		}
+
+		return DecodePendingCachedRecords();
+	}
+
+	Result BuildSystemInstance::DecodePendingCachedRecords()
+	{
+		while (m_pendingCachedRecords.Count() > 0)
+		{
+			const size_t recordIndex = m_pendingCachedRecords[m_pendingCachedRecords.Count() - 1];
+			m_pendingCachedRecords.RemoveRange(m_pendingCachedRecords.Count() - 1, 1);
+
+			const CachedNodeRecord &record = m_cachedRecords[recordIndex];
+			DependencyNode *node = record.m_node;
+
+			PackedResultAndExtCode result = RKIT_TRY_EVAL(DecodeCachedRecordBody(record));
+
+			// A record that can't be decoded is treated as out of date, so the node is analyzed again
+			if (!utils::ResultIsOK(result))
+			{
+				RKIT_CHECK(node->Initialize(record.m_identifier));
+				node->SetState(DependencyState::NotAnalyzedOrCompiled);
+
+				rkit::log::ErrorFmt(u8"A problem occurred while loading cached node {}, it will be rebuilt", node->GetIdentifier());
+			}
+
+			// Decoding replaced the identifier string that the lookup key refers to
+			NodeKey nodeKey(NodeTypeKey(node->GetDependencyNodeNamespace(), node->GetDependencyNodeType()), node->GetInputFileLocation(), node->GetIdentifier());
+			RKIT_CHECK(m_nodeLookup.SetAndReplaceKey(nodeKey, node));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::DecodeCachedRecordBody(const CachedNodeRecord &record)
+	{
+		Span<const String> strings;
+		RKIT_CHECK(GetCachedSegmentStrings(record.m_location.m_segmentIndex, strings));
+
+		serializer::DeserializeResolver resolver(*this, strings);
+
+		const uint64_t bodyFilePos = record.m_location.m_filePos + record.m_bodyOffset;
+		const uint64_t bodySize = record.m_location.m_size - record.m_bodyOffset;
+
+		ReadOnlyMemoryStream recordStream(m_cacheView->GetBytes().SubSpan(static_cast<size_t>(bodyFilePos), static_cast<size_t>(bodySize)));
+		RKIT_CHECK(record.m_node->Deserialize(recordStream, resolver));
+
+		if (!(record.m_identifier == record.m_node->GetIdentifier()))
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::GetCachedSegmentStrings(size_t segmentIndex, Span<const String> &outStrings)
+	{
+		CachedSegmentStrings &segmentStrings = m_cachedSegmentStrings[segmentIndex];
+
+		if (!segmentStrings.m_isLoaded)
+		{
+			RKIT_CHECK(LoadCacheStringPool(m_cacheView->GetBytes(), m_cacheSegments[segmentIndex], segmentStrings.m_strings));
+			segmentStrings.m_isLoaded = true;
+		}
+
+		outStrings = segmentStrings.m_strings.ToSpan();
+
+		RKIT_RETURN_OK;
+	}
+
+	void BuildSystemInstance::ReleaseCachedRecords()
+	{
+		m_cachedRecordLookup.Clear();
+		m_cachedRecords.Reset();
+		m_cachedRecordIndexByID.Reset();
+		m_cachedSegmentStrings.Reset();
+		m_pendingCachedRecords.Reset();
+		m_cachedRecordsInCheckpoint = false;
+		m_cacheView.Reset();
+	}
+
+	void BuildSystemInstance::ResetCache()
+	{
+		ReleaseCachedRecords();
+
+		m_nodeLookup.Clear();
+		m_nodes.Reset();
+		m_cacheSegments.Reset();
+		m_cacheFileSize = 0;
+		m_nextCacheID = 1;
+		m_cacheCheckpointNodeCount = 0;
+		m_cacheFileValid = false;
+	}
+
+	Result BuildSystemInstance::BenchmarkCache(uint32_t numPasses)
+	{
+		if (m_nodes.Count() != 0 || numPasses == 0)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		ISystemDriver &sysDriver = *GetDrivers().m_systemDriver;
+
+		uint64_t indexTime = 0;
+		uint64_t decodeTime = 0;
+		uint64_t appendTime = 0;
+		uint64_t rewriteTime = 0;
+		uint64_t appendBytes = 0;
+		uint64_t rewriteBytes = 0;
+		size_t numRecords = 0;
+		size_t numAppendedRecords = 0;
+
+		for (uint32_t pass = 0; pass < numPasses; pass++)
+		{
+			ResetCache();
+
+			const uint64_t indexStartTime = sysDriver.GetHighResTimestamp();
+			RKIT_CHECK(LoadCacheFile(GetCacheFileName()));
+			const uint64_t decodeStartTime = sysDriver.GetHighResTimestamp();
+
+			if (!m_cacheFileValid)
+			{
+				rkit::log::Error(u8"There is no valid build cache to benchmark");
+				RKIT_THROW(ResultCode::kOperationFailed);
+			}
+
+			numRecords = m_cachedRecords.Count();
+
+			// The previous format decoded every record at startup
+			RKIT_CHECK(LoadAllCachedNodes());
+			const uint64_t decodeEndTime = sysDriver.GetHighResTimestamp();
+
+			Vector<DependencyNode *> liveNodes;
+			RKIT_CHECK(liveNodes.Reserve(m_nodes.Count()));
+
+			for (const UniquePtr<DependencyNode> &node : m_nodes)
+			{
+				RKIT_CHECK(liveNodes.Append(node.Get()));
+			}
+
+			// The previous format rewrote every record on each save.  Saves go to a scratch
+			// file so that the real cache is left alone.
+			uint64_t bytesWritten = 0;
+
+			const uint64_t rewriteStartTime = sysDriver.GetHighResTimestamp();
+			RKIT_CHECK(CompactCache(GetCacheBenchFileName(), liveNodes.ToSpan(), bytesWritten));
+			const uint64_t rewriteEndTime = sysDriver.GetHighResTimestamp();
+
+			rewriteBytes = bytesWritten;
+
+			numAppendedRecords = 0;
+			for (size_t i = 0; i < liveNodes.Count(); i += kCacheBenchDirtyNodeInterval)
+			{
+				liveNodes[i]->MarkCacheRecordDirty();
+				numAppendedRecords++;
+			}
+
+			bool appended = false;
+
+			const uint64_t appendStartTime = sysDriver.GetHighResTimestamp();
+			RKIT_CHECK(AppendCache(appended, GetCacheBenchFileName(), liveNodes.ToSpan(), bytesWritten));
+			const uint64_t appendEndTime = sysDriver.GetHighResTimestamp();
+
+			if (!appended)
+				RKIT_THROW(ResultCode::kOperationFailed);
+
+			appendBytes = bytesWritten;
+
+			indexTime += decodeStartTime - indexStartTime;
+			decodeTime += decodeEndTime - decodeStartTime;
+			rewriteTime += rewriteEndTime - rewriteStartTime;
+			appendTime += appendEndTime - appendStartTime;
 		}
 
+		ResetCache();
+
+		const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency() * numPasses;
+
+		const uint64_t indexMicroseconds = indexTime * 1000000u / timerFrequency;
+		const uint64_t fullLoadMicroseconds = (indexTime + decodeTime) * 1000000u / timerFrequency;
+		const uint64_t appendMicroseconds = appendTime * 1000000u / timerFrequency;
+		const uint64_t rewriteMicroseconds = rewriteTime * 1000000u / timerFrequency;
+
+		rkit::log::LogInfoFmt(u8"{} cached node records, {} passes", numRecords, numPasses);
+		rkit::log::LogInfoFmt(u8"Load: indexed {} usec, every record decoded {} usec", indexMicroseconds, fullLoadMicroseconds);
+		rkit::log::LogInfoFmt(u8"Save: {} changed records appended {} usec, {} bytes; every record rewritten {} usec, {} bytes", numAppendedRecords, appendMicroseconds, appendBytes, rewriteMicroseconds, rewriteBytes);
+
 		RKIT_RETURN_OK;
 	}
 
@@ -1967,7 +2932,7 @@ namespace rkit { namespace buildsystem
 		HashMap<NodeKey, DependencyNode *>::ConstIterator_t it = m_nodeLookup.Find(key);
 
 		if (it == m_nodeLookup.end())
-			return nullptr;
+			return const_cast<BuildSystemInstance *>(this)->FindCachedNode(key);
 
 		return it.Value();
 	}
@@ -2060,21 +3025,91 @@ namespace rkit { namespace buildsystem
 	{
 		m_fs = fs;
 		m_cachedFileStatus.Clear();
+		m_cachedDirScan.Clear();
 
-		// Step 1: Compute initial dependency graph
-		for (const UniquePtr<DependencyNode> &nodeUPtr : m_nodes)
-			nodeUPtr->SetDependencyCheckPhase(DependencyCheckPhase::None);
+		return RunBuild();
+	}
 
-		m_depCheckStack.Reset();
-		m_relevantNodes.Reset();
+	Result BuildSystemInstance::BuildIncremental(IBuildFileSystem *fs)
+	{
+		m_fs = fs;
 
-		for (DependencyNode *node : m_rootNodes)
-		{
-			RKIT_CHECK(AddRelevantNode(node));
-		}
+		return RunBuild();
+	}
 
-		// May add more relevant nodes during this loop
-		for (size_t i = 0; i < m_relevantNodes.Count(); i++)
+	Result BuildSystemInstance::InvalidateFileStatus(BuildFileLocation location, const CIPathView &path)
+	{
+		// The path may be a directory that was renamed or deleted, in which case the change is only
+		// reported once for the directory, so everything cached under it has to go too.
+		{
+			Vector<FileLocationKey> staleFileKeys;
+			for (HashMap<FileLocationKey, UniquePtr<CachedFileStatus> >::ConstIterator_t it = m_cachedFileStatus.begin(); it != m_cachedFileStatus.end(); ++it)
+			{
+				if (it.Key().IsAtOrUnder(location, path))
+				{
+					RKIT_CHECK(staleFileKeys.Append(it.Key()));
+				}
+			}
+
+			for (const FileLocationKey &key : staleFileKeys)
+				m_cachedFileStatus.Remove(key);
+		}
+
+		{
+			Vector<DirectoryScanKey> staleScanKeys;
+			for (HashMap<DirectoryScanKey, UniquePtr<CachedDirScan> >::ConstIterator_t it = m_cachedDirScan.begin(); it != m_cachedDirScan.end(); ++it)
+			{
+				if (it.Key().IsAtOrUnder(location, path))
+				{
+					RKIT_CHECK(staleScanKeys.Append(it.Key()));
+				}
+			}
+
+			for (const DirectoryScanKey &key : staleScanKeys)
+				m_cachedDirScan.Remove(key);
+		}
+
+		// Adding or removing the path also changes its parent's listing
+		for (int dirModeInt = 0; dirModeInt < 2; dirModeInt++)
+		{
+			const bool directoryMode = (dirModeInt != 0);
+
+			if (path.NumComponents() > 0)
+			{
+				CIPath parentPath;
+				RKIT_CHECK(parentPath.Set(path.AbsSlice(path.NumComponents() - 1)));
+
+				m_cachedDirScan.Remove(DirectoryScanKey(location, parentPath, directoryMode));
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::RunBuild()
+	{
+		for (const UniquePtr<DependencyNode> &nodeUPtr : m_nodes)
+			nodeUPtr->ClearWasCompiled();
+
+		// Step 1: Compute initial dependency graph.  The file statuses recorded in the cached graph
+		// are resolved in parallel first, and analyses that can run concurrently are run ahead of
+		// the walk, which then only has to re-check them.
+		RKIT_CHECK(PrefetchFileStatuses());
+		RKIT_CHECK(PrefetchAnalyses());
+
+		for (const UniquePtr<DependencyNode> &nodeUPtr : m_nodes)
+			nodeUPtr->SetDependencyCheckPhase(DependencyCheckPhase::None);
+
+		m_depCheckStack.Reset();
+		m_relevantNodes.Reset();
+
+		for (DependencyNode *node : m_rootNodes)
+		{
+			RKIT_CHECK(AddRelevantNode(node));
+		}
+
+		// May add more relevant nodes during this loop
+		for (size_t i = 0; i < m_relevantNodes.Count(); i++)
 		{
 			DependencyNode *node = m_relevantNodes[i];
 
@@ -2111,16 +3146,7 @@ namespace rkit { namespace buildsystem
 		}
 
 		// Step 5: Copy CAS files
-		rkit::log::LogInfo(u8"Updating CAS files...");
-		for (size_t i = 0; i < m_relevantNodes.Count(); i++)
-		{
-			const DependencyNode *node = m_relevantNodes[i];
-
-			for (const data::ContentID &contentID : node->GetCompileCASProducts())
-			{
-				RKIT_CHECK(UpdateCAS(contentID));
-			}
-		}
+		RKIT_CHECK(UpdateCASFiles());
 
 		// Step 6: Write updated state
 		RKIT_CHECK(SaveCache());
@@ -2130,101 +3156,333 @@ namespace rkit { namespace buildsystem
 
 	Result BuildSystemInstance::SaveCache()
 	{
-		rkit::BufferStream depsGraphNodesStream;
-		StringPoolBuilder stringPool;
+		ISystemDriver &sysDriver = *GetDrivers().m_systemDriver;
 
-		// Write nodes
-		size_t serializedIndex = 0;
-		for (DependencyNode *node : m_relevantNodes)
+		const uint64_t startTime = sysDriver.GetHighResTimestamp();
+
+		Vector<DependencyNode *> liveNodes;
+		RKIT_CHECK(CollectCacheLiveNodes(liveNodes));
+
+		size_t numDirtyNodes = 0;
+		size_t numLiveNodesInCheckpoint = 0;
+		uint64_t cleanRecordBytes = 0;
+		for (const DependencyNode *node : liveNodes)
 		{
-			node->SetSerializedIndex(serializedIndex++);
+			if (node->IsCacheRecordDirty())
+				numDirtyNodes++;
+			else
+				cleanRecordBytes += node->GetCacheRecord().m_size;
+
+			if (node->IsInCacheCheckpoint())
+				numLiveNodesInCheckpoint++;
 		}
 
-		RKIT_CHECK(serializer::SerializeCompactSize(depsGraphNodesStream, serializedIndex));
-		for (DependencyNode *node : m_relevantNodes)
+		// If every live node is in the last checkpoint and the checkpoint has no other nodes, nothing changed
+		if (m_cacheFileValid && numDirtyNodes == 0 && numLiveNodesInCheckpoint == liveNodes.Count() && liveNodes.Count() == m_cacheCheckpointNodeCount)
+			RKIT_RETURN_OK;
+
+		bool shouldCompact = !m_cacheFileValid || m_cacheSegments.Count() >= kMaxCacheSegments;
+
+		if (m_cacheFileSize >= kMinCacheCompactionSize && m_cacheFileSize / 2u > cleanRecordBytes)
+			shouldCompact = true;
+
+		uint64_t bytesWritten = 0;
+		bool appended = false;
+
+		if (!shouldCompact)
 		{
-			RKIT_CHECK(node->SerializeInitialState(depsGraphNodesStream));
+			RKIT_CHECK(AppendCache(appended, GetCacheFileName(), liveNodes.ToSpan(), bytesWritten));
 		}
 
+		if (!appended)
+		{
+			RKIT_CHECK(CompactCache(GetCacheFileName(), liveNodes.ToSpan(), bytesWritten));
+		}
+
+		for (const UniquePtr<DependencyNode> &node : m_nodes)
+			node->SetInCacheCheckpoint(false);
+
+		m_cachedRecordsInCheckpoint = false;
+
+		for (DependencyNode *node : liveNodes)
+			node->SetInCacheCheckpoint(true);
+
+		m_cacheCheckpointNodeCount = liveNodes.Count();
+
+		const uint64_t elapsedMSec = (sysDriver.GetHighResTimestamp() - startTime) * 1000u / sysDriver.GetHighResTimestampFrequency();
+
+		if (appended)
+			rkit::log::LogInfoFmt(u8"Appended {} of {} node records to the build cache, {} bytes written in {} ms", numDirtyNodes, liveNodes.Count(), bytesWritten, elapsedMSec);
+		else
+			rkit::log::LogInfoFmt(u8"Compacted build cache to {} node records, {} bytes written in {} ms", liveNodes.Count(), bytesWritten, elapsedMSec);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::CollectCacheLiveNodes(Vector<DependencyNode *> &outLiveNodes) const
+	{
+		// Relevant nodes, plus any nodes they depend on, so that every cache ID in a record resolves
 		for (DependencyNode *node : m_relevantNodes)
 		{
-			RKIT_CHECK(node->Serialize(depsGraphNodesStream, stringPool));
+			if (!node->IsInCacheLiveSet())
+			{
+				node->SetInCacheLiveSet(true);
+				RKIT_CHECK(outLiveNodes.Append(node));
+			}
+		}
+
+		for (size_t i = 0; i < outLiveNodes.Count(); i++)
+		{
+			CallbackSpan<NodeDependencyInfo, const IDependencyNode *> nodeDeps = outLiveNodes[i]->GetNodeDependencies();
+
+			for (size_t di = 0; di < nodeDeps.Count(); di++)
+			{
+				DependencyNode *depNode = static_cast<DependencyNode *>(nodeDeps[di].m_node);
+
+				if (!depNode->IsInCacheLiveSet())
+				{
+					depNode->SetInCacheLiveSet(true);
+					RKIT_CHECK(outLiveNodes.Append(depNode));
+				}
+			}
+		}
+
+		for (DependencyNode *node : outLiveNodes)
+			node->SetInCacheLiveSet(false);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::SerializeCacheSegment(BufferStream &outStream, const Span<DependencyNode * const> &nodes, size_t segmentIndex, uint64_t segmentFilePos)
+	{
+		rkit::BufferStream recordsStream;
+		StringPoolBuilder stringPool;
+
+		Vector<BuildCacheRecordLocation> records;
+		RKIT_CHECK(records.Resize(nodes.Count()));
+
+		for (size_t i = 0; i < nodes.Count(); i++)
+		{
+			const FilePos_t recordStart = recordsStream.Tell();
+
+			RKIT_CHECK(nodes[i]->SerializeInitialState(recordsStream));
+			RKIT_CHECK(nodes[i]->Serialize(recordsStream, stringPool));
+
+			records[i].m_segmentIndex = segmentIndex;
+			records[i].m_filePos = recordStart;
+			records[i].m_size = recordsStream.Tell() - recordStart;
 		}
 
 		// Write strings
-		rkit::BufferStream stringPoolStream;
-		size_t numStrings = stringPool.NumStrings();
+		const size_t numStrings = stringPool.NumStrings();
 
-		RKIT_CHECK(serializer::SerializeCompactSize(stringPoolStream, numStrings));
+		RKIT_CHECK(serializer::SerializeCompactSize(outStream, numStrings));
 		for (size_t i = 0; i < numStrings; i++)
 		{
 			StringView str = stringPool.GetStringByIndex(i);
-			RKIT_CHECK(serializer::SerializeCompactSize(stringPoolStream, str.Length()));
-			RKIT_CHECK(stringPoolStream.WriteAll(str.GetChars(), str.Length()));
+			RKIT_CHECK(serializer::SerializeCompactSize(outStream, str.Length()));
+			RKIT_CHECK(outStream.WriteAll(str.GetChars(), str.Length()));
 		}
 
-		FilePos_t stringPoolSize = stringPoolStream.GetSize();
-		FilePos_t graphSize = depsGraphNodesStream.GetSize();
+		// Write records
+		const uint64_t recordsFilePos = segmentFilePos + outStream.GetSize();
+
+		Span<const uint8_t> recordsData = recordsStream.GetBuffer().ToSpan();
+		RKIT_CHECK(outStream.WriteAll(recordsData.Ptr(), recordsData.Count()));
 
-		FilePos_t combinedSize = 0;
-		RKIT_CHECK(SafeAdd(combinedSize, stringPoolSize, graphSize));
+		for (size_t i = 0; i < nodes.Count(); i++)
+		{
+			records[i].m_filePos += recordsFilePos;
+			nodes[i]->SetCacheRecord(records[i]);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::SerializeCacheCheckpoint(IWriteStream &stream, const Span<DependencyNode * const> &liveNodes) const
+	{
+		RKIT_CHECK(serializer::SerializeCompactSize(stream, m_cacheSegments.Count()));
+
+		for (uint64_t segmentFilePos : m_cacheSegments)
+		{
+			RKIT_CHECK(stream.WriteAll(&segmentFilePos, sizeof(segmentFilePos)));
+		}
+
+		RKIT_CHECK(serializer::SerializeCompactSize(stream, liveNodes.Count()));
+		RKIT_CHECK(serializer::SerializeCompactSize(stream, m_nextCacheID));
+
+		for (const DependencyNode *node : liveNodes)
+		{
+			const BuildCacheRecordLocation &record = node->GetCacheRecord();
+
+			RKIT_CHECK(serializer::SerializeCompactSize(stream, node->GetSerializedIndex()));
+			RKIT_CHECK(serializer::SerializeCompactSize(stream, record.m_segmentIndex));
+			RKIT_CHECK(stream.WriteAll(&record.m_filePos, sizeof(record.m_filePos)));
+			RKIT_CHECK(stream.WriteAll(&record.m_size, sizeof(record.m_size)));
+
+			// Lookup key, so that loading doesn't have to touch the record
+			const uint32_t nodeNamespace = node->GetDependencyNodeNamespace();
+			const uint32_t nodeType = node->GetDependencyNodeType();
+			const StringView identifier = node->GetIdentifier();
+
+			RKIT_CHECK(stream.WriteAll(&nodeNamespace, sizeof(nodeNamespace)));
+			RKIT_CHECK(stream.WriteAll(&nodeType, sizeof(nodeType)));
+			RKIT_CHECK(serializer::SerializeEnum(stream, node->GetInputFileLocation()));
+			RKIT_CHECK(serializer::SerializeCompactSize(stream, identifier.Length()));
+			RKIT_CHECK(stream.WriteAll(identifier.GetChars(), identifier.Length()));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::AppendCache(bool &outAppended, const CIPathView &cacheFileName, const Span<DependencyNode * const> &liveNodes, uint64_t &outBytesWritten)
+	{
+		outAppended = false;
 
 		OSAbsPath cacheFullPath;
-		RKIT_CHECK(ConstructIntermediatePath(cacheFullPath, GetCacheFileName()));
+		RKIT_CHECK(ConstructIntermediatePath(cacheFullPath, cacheFileName));
 
 		ISystemDriver &sysDriver = *GetDrivers().m_systemDriver;
 		UniquePtr<ISeekableReadWriteStream> graphStream;
-		RKIT_CHECK(sysDriver.OpenFileReadWriteAbs(graphStream, cacheFullPath, true, true, false, false));
+		RKIT_CHECK(sysDriver.OpenFileReadWriteAbs(graphStream, cacheFullPath, false, false, false, true));
 
-		bool headerOK = false;
+		if (!graphStream.IsValid())
+			RKIT_RETURN_OK;
 
 		BuildCacheFileHeader header;
-		if (graphStream->GetSize() >= sizeof(header))
-		{
-			RKIT_CHECK(graphStream->ReadAll(&header, sizeof(header)));
+		if (graphStream->GetSize() != m_cacheFileSize || m_cacheFileSize < sizeof(header))
+			RKIT_RETURN_OK;
 
-			if (header.m_version == BuildCacheFileHeader::kCacheVersion && header.m_identifier == BuildCacheFileHeader::kCacheIdentifier && header.m_activeInstance < 2)
-				headerOK = true;
-		}
+		RKIT_CHECK(graphStream->ReadAll(&header, sizeof(header)));
 
-		if (!headerOK)
+		if (header.m_version != BuildCacheFileHeader::kCacheVersion || header.m_identifier != BuildCacheFileHeader::kCacheIdentifier || header.m_activeInstance >= 2)
+			RKIT_RETURN_OK;
+
+		Vector<DependencyNode *> dirtyNodes;
+		for (DependencyNode *node : liveNodes)
 		{
-			header = BuildCacheFileHeader();
-			header.m_identifier = BuildCacheFileHeader::kCacheIdentifier;
-			header.m_version = BuildCacheFileHeader::kCacheVersion;
-			header.m_activeInstance = 1;
+			if (!node->IsCacheRecordDirty())
+				continue;
+
+			if (node->GetSerializedIndex() == 0)
+				node->SetSerializedIndex(m_nextCacheID++);
 
-			RKIT_CHECK(graphStream->SeekStart(0));
-			RKIT_CHECK(graphStream->WriteAll(&header, sizeof(header)));
-			RKIT_CHECK(graphStream->Flush());
+			RKIT_CHECK(dirtyNodes.Append(node));
 		}
 
-		const BuildCacheInstanceInfo &oldInst = header.m_instances[header.m_activeInstance];
-		BuildCacheInstanceInfo &newInst = header.m_instances[1 - header.m_activeInstance];
+		// If anything fails past this point, the record table no longer matches the file,
+		// so the next save rewrites it from scratch
+		m_cacheFileValid = false;
 
-		bool canWriteBeforeOldInst = false;
-		if (oldInst.m_filePos < sizeof(header) || (oldInst.m_filePos - sizeof(header)) >= combinedSize)
-			canWriteBeforeOldInst = true;
+		RKIT_CHECK(graphStream->SeekEnd(0));
 
-		if (!canWriteBeforeOldInst)
+		if (dirtyNodes.Count() > 0)
 		{
-			RKIT_CHECK(graphStream->SeekEnd(0));
+			const uint64_t segmentFilePos = graphStream->Tell();
+
+			rkit::BufferStream segmentStream;
+			RKIT_CHECK(SerializeCacheSegment(segmentStream, dirtyNodes.ToSpan(), m_cacheSegments.Count(), segmentFilePos));
+			RKIT_CHECK(m_cacheSegments.Append(segmentFilePos));
+
+			Span<const uint8_t> segmentData = segmentStream.GetBuffer().ToSpan();
+			RKIT_CHECK(graphStream->WriteAll(segmentData.Ptr(), segmentData.Count()));
 		}
 
-		newInst.m_filePos = graphStream->Tell();
-		newInst.m_size = combinedSize;
+		rkit::BufferStream checkpointStream;
+		RKIT_CHECK(SerializeCacheCheckpoint(checkpointStream, liveNodes));
 
-		Span<const uint8_t> stringPoolData = stringPoolStream.GetBuffer().ToSpan();
-		RKIT_CHECK(graphStream->WriteAll(stringPoolData.Ptr(), stringPoolData.Count()));
+		BuildCacheInstanceInfo &newInst = header.m_instances[1 - header.m_activeInstance];
+		newInst.m_filePos = graphStream->Tell();
+		newInst.m_size = checkpointStream.GetSize();
 
-		Span<const uint8_t> nodesData = depsGraphNodesStream.GetBuffer().ToSpan();
-		RKIT_CHECK(graphStream->WriteAll(nodesData.Ptr(), nodesData.Count()));
+		Span<const uint8_t> checkpointData = checkpointStream.GetBuffer().ToSpan();
+		RKIT_CHECK(graphStream->WriteAll(checkpointData.Ptr(), checkpointData.Count()));
 		RKIT_CHECK(graphStream->Flush());
 
 		header.m_activeInstance = 1 - header.m_activeInstance;
 
 		RKIT_CHECK(graphStream->SeekStart(0));
 		RKIT_CHECK(graphStream->WriteAll(&header, sizeof(header)));
+		RKIT_CHECK(graphStream->Flush());
+
+		const uint64_t newFileSize = graphStream->GetSize();
+
+		outBytesWritten = newFileSize - m_cacheFileSize;
+		outAppended = true;
+
+		m_cacheFileSize = newFileSize;
+		m_cacheFileValid = true;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::CompactCache(const CIPathView &cacheFileName, const Span<DependencyNode * const> &liveNodes, uint64_t &outBytesWritten)
+	{
+		m_cacheFileValid = false;
+		m_cacheSegments.Reset();
+
+		// Records that were never looked up aren't live, and the file can't be replaced while it's mapped
+		ReleaseCachedRecords();
+
+		// Records of nodes that aren't live are dropped, so they have to be written again
+		// with a new cache ID if they become live later
+		for (const UniquePtr<DependencyNode> &node : m_nodes)
+		{
+			node->SetSerializedIndex(0);
+			node->MarkCacheRecordDirty();
+		}
+
+		for (size_t i = 0; i < liveNodes.Count(); i++)
+			liveNodes[i]->SetSerializedIndex(i + 1);
+
+		m_nextCacheID = liveNodes.Count() + 1;
+
+		BuildCacheFileHeader header;
+		header.m_identifier = BuildCacheFileHeader::kCacheIdentifier;
+		header.m_version = BuildCacheFileHeader::kCacheVersion;
+		header.m_activeInstance = 0;
+
+		const uint64_t segmentFilePos = sizeof(header);
+
+		rkit::BufferStream segmentStream;
+		RKIT_CHECK(SerializeCacheSegment(segmentStream, liveNodes, 0, segmentFilePos));
+		RKIT_CHECK(m_cacheSegments.Append(segmentFilePos));
+
+		rkit::BufferStream checkpointStream;
+		RKIT_CHECK(SerializeCacheCheckpoint(checkpointStream, liveNodes));
+
+		header.m_instances[0].m_filePos = segmentFilePos + segmentStream.GetSize();
+		header.m_instances[0].m_size = checkpointStream.GetSize();
+
+		OSAbsPath cacheFullPath;
+		RKIT_CHECK(ConstructIntermediatePath(cacheFullPath, cacheFileName));
+
+		OSAbsPath tempFullPath;
+		RKIT_CHECK(ConstructIntermediatePath(tempFullPath, GetCacheTempFileName()));
+
+		ISystemDriver &sysDriver = *GetDrivers().m_systemDriver;
+
+		{
+			UniquePtr<ISeekableWriteStream> tempStream;
+			RKIT_CHECK(sysDriver.OpenFileWriteAbs(tempStream, tempFullPath, true, true, true, false));
+
+			Span<const uint8_t> segmentData = segmentStream.GetBuffer().ToSpan();
+			Span<const uint8_t> checkpointData = checkpointStream.GetBuffer().ToSpan();
+
+			RKIT_CHECK(tempStream->WriteAll(&header, sizeof(header)));
+			RKIT_CHECK(tempStream->WriteAll(segmentData.Ptr(), segmentData.Count()));
+			RKIT_CHECK(tempStream->WriteAll(checkpointData.Ptr(), checkpointData.Count()));
+			RKIT_CHECK(tempStream->Flush());
+		}
+
+		// Replace the old file in one step, so an interrupted compaction leaves it intact
+		bool moved = false;
+		RKIT_CHECK(sysDriver.MoveFileFromAbsToAbs(moved, tempFullPath, cacheFullPath, true, false));
+
+		outBytesWritten = header.m_instances[0].m_filePos + header.m_instances[0].m_size;
+
+		m_cacheFileSize = outBytesWritten;
+		m_cacheFileValid = true;
 
 		RKIT_RETURN_OK;
 	}
@@ -2268,135 +3526,567 @@ namespace rkit { namespace buildsystem
 
 		HashMap<NodeTypeKey, UniquePtr<IDependencyNodeCompiler> >::ConstIterator_t compilerIt = m_nodeCompilers.Find(NodeTypeKey(nodeNamespace, nodeType));
 
-		if (compilerIt == m_nodeCompilers.end())
+		if (compilerIt == m_nodeCompilers.end())
+		{
+			rkit::log::ErrorFmt(u8"Unknown dependency node type {} / {}", static_cast<unsigned int>(nodeNamespace), static_cast<unsigned int>(nodeType));
+			RKIT_THROW(ResultCode::kInvalidParameter);
+		}
+
+		UniquePtr<DependencyNode> depNode;
+		RKIT_CHECK(New<DependencyNode>(depNode, compilerIt.Value().Get(), nodeNamespace, nodeType, std::move(content), buildFileLocation));
+
+		RKIT_CHECK(depNode->Initialize(identifier));
+
+		outNode = std::move(depNode);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::CreateNamedNode(uint32_t nodeNamespace, uint32_t nodeType, BuildFileLocation buildFileLocation, const StringView &identifier, UniquePtr<IDependencyNode> &outNode) const
+	{
+		return CreateNode(nodeNamespace, nodeType, buildFileLocation, identifier, Vector<uint8_t>(), outNode);
+	}
+
+	Result BuildSystemInstance::CreateContentNode(uint32_t nodeNamespace, uint32_t nodeType, BuildFileLocation buildFileLocation, Vector<uint8_t> &&contentRef, UniquePtr<IDependencyNode> &outNode) const
+	{
+		Vector<uint8_t> content = std::move(contentRef);
+
+		if (content.Count() == 0)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		return CreateNode(nodeNamespace, nodeType, buildFileLocation, CreateContentID(content.ToSpan()).GetStringView(), std::move(content), outNode);
+	}
+
+	Result BuildSystemInstance::RegisterNodeCompiler(uint32_t nodeNamespace, uint32_t nodeType, UniquePtr<IDependencyNodeCompiler> &&compiler)
+	{
+		UniquePtr<IDependencyNodeCompiler> compilerMoved(std::move(compiler));
+
+		RKIT_CHECK(m_nodeCompilers.Set(NodeTypeKey(nodeNamespace, nodeType), std::move(compilerMoved)));
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::AddNode(UniquePtr<DependencyNode> &&node)
+	{
+		NodeTypeKey typeKey(node->GetDependencyNodeNamespace(), node->GetDependencyNodeType());
+		NodeKey nodeKey(typeKey, node->GetInputFileLocation(), node->GetIdentifier());
+
+		DependencyNode *nodePtr = node.Get();
+
+		RKIT_CHECK(m_nodes.Append(std::move(node)));
+
+		RKIT_TRY_CATCH_RETHROW(m_nodeLookup.Set(nodeKey, nodePtr),
+			CatchContext(
+				[this]
+				{
+					m_nodes.RemoveRange(m_nodes.Count() - 1, 1);
+				}
+			)
+		);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::AddRelevantNode(DependencyNode *node)
+	{
+		if (node->GetDependencyCheckPhase() == DependencyCheckPhase::None)
+		{
+			RKIT_CHECK(m_relevantNodes.Append(node));
+			node->SetDependencyCheckPhase(DependencyCheckPhase::CheckFiles);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::ProcessTopDepCheck()
+	{
+		DependencyNode *node = m_depCheckStack[m_depCheckStack.Count() - 1];
+
+		if (node->GetDependencyCheckPhase() == DependencyCheckPhase::Completed)
+		{
+			m_depCheckStack.RemoveRange(m_depCheckStack.Count() - 1, 1);
+			RKIT_RETURN_OK;
+		}
+
+		if (node->GetDependencyCheckPhase() == DependencyCheckPhase::CheckFiles)
+		{
+			// This may lower the state to NotAnalyzedOrCompiled or NotCompiled
+			RKIT_CHECK(CheckNodeFilesAndVersion(node));
+
+			node->SetDependencyCheckPhase(DependencyCheckPhase::EnumerateNodes);
+		}
+
+		if (node->GetDependencyCheckPhase() == DependencyCheckPhase::EnumerateNodes)
+		{
+			// This may lower the state to NotCompiled
+			DependencyState depState = node->GetDependencyState();
+
+			if (depState == DependencyState::NotAnalyzedOrCompiled)
+			{
+				if (node->GetCompiler()->HasAnalysisStage())
+				{
+					LogAnalysis(node);
+					RKIT_CHECK(node->RunAnalysis(this));
+				}
+
+				depState = DependencyState::NotCompiled;
+				node->SetState(depState);
+			}
+
+			node->SetDependencyCheckPhase(DependencyCheckPhase::CheckNodes);
+
+			RKIT_RETURN_OK;
+		}
+
+		RKIT_ASSERT(node->GetDependencyCheckPhase() == DependencyCheckPhase::CheckNodes);
+
+		RKIT_CHECK(CheckNodeNodeDependencies(node));
+
+		RKIT_RETURN_OK;
+	}
+
+	void BuildSystemInstance::LogAnalysis(const DependencyNode *node) const
+	{
+		rkit::StringView locationStr = u8"Unk";
+
+		switch (node->GetInputFileLocation())
+		{
+		case BuildFileLocation::kSourceDir:
+			locationStr = u8"Src";
+			break;
+		case BuildFileLocation::kIntermediateDir:
+			locationStr = u8"Imd";
+			break;
+		default:
+			break;
+		};
+
+		rkit::log::LogInfoFmt(u8"Build Analysis: {} {} {} -> '{}'", FourCCToPrintable(node->GetDependencyNodeNamespace()).GetStr(), FourCCToPrintable(node->GetDependencyNodeType()).GetStr(), locationStr, node->GetIdentifier());
+	}
+
+	// Resolves the status of every file that the dependency check will look at for the cached graph,
+	// in parallel batches, so that the check only hits the file status cache.  This only changes when
+	// each status is queried, not the result, since the cache is only refreshed by finished outputs.
+	Result BuildSystemInstance::PrefetchFileStatuses()
+	{
+		const int kCompilePhase = 0;
+		const int kAnalysisPhase = 1;
+
+		HashSet<DependencyNode *> visitedNodes;
+		Vector<DependencyNode *> nodesToVisit;
+
+		HashSet<FileLocationKey> prefetchLocations;
+		Vector<UniquePtr<FileStatusPrefetch>> prefetches;
+
+		for (DependencyNode *node : m_rootNodes)
+		{
+			if (!visitedNodes.Contains(node))
+			{
+				RKIT_CHECK(visitedNodes.Add(node));
+				RKIT_CHECK(nodesToVisit.Append(node));
+			}
+		}
+
+		while (nodesToVisit.Count() > 0)
+		{
+			DependencyNode *node = nodesToVisit[nodesToVisit.Count() - 1];
+			nodesToVisit.RemoveRange(nodesToVisit.Count() - 1, 1);
+
+			for (const NodeDependencyInfo &nodeDep : node->GetNodeDependencies())
+			{
+				DependencyNode *depNode = static_cast<DependencyNode *>(nodeDep.m_node);
+
+				if (nodeDep.m_mustBeUpToDate && !visitedNodes.Contains(depNode))
+				{
+					RKIT_CHECK(visitedNodes.Add(depNode));
+					RKIT_CHECK(nodesToVisit.Append(depNode));
+				}
+			}
+
+			// Same conditions as CheckNodeFilesAndVersion
+			if (node->GetLastCompilerVersion() != node->GetCompiler()->GetVersion())
+				continue;
+
+			const DependencyState depState = node->GetDependencyState();
+
+			for (int phase = 0; phase < 2; phase++)
+			{
+				if (phase == kCompilePhase && depState != DependencyState::UpToDate)
+					continue;
+
+				if (phase == kAnalysisPhase && depState != DependencyState::UpToDate && depState != DependencyState::NotCompiled)
+					continue;
+
+				CallbackSpan<FileStatusView, const IDependencyNode *> productsSpan = (phase == kCompilePhase) ? node->GetCompileProducts() : node->GetAnalysisProducts();
+				CallbackSpan<FileDependencyInfoView, const IDependencyNode *> fileDepsSpan = (phase == kCompilePhase) ? node->GetCompileFileDependencies() : node->GetAnalysisFileDependencies();
+
+				for (const FileDependencyInfoView &fdiView : fileDepsSpan)
+				{
+					if (fdiView.m_mustBeUpToDate)
+					{
+						RKIT_CHECK(AddFileStatusPrefetch(prefetches, prefetchLocations, fdiView.m_status.m_location, fdiView.m_status.m_filePath));
+					}
+				}
+
+				for (const FileStatusView &productStatus : productsSpan)
+				{
+					RKIT_CHECK(AddFileStatusPrefetch(prefetches, prefetchLocations, productStatus.m_location, productStatus.m_filePath));
+				}
+
+				if (phase == kCompilePhase)
+				{
+					for (const data::ContentID &contentID : node->GetCompileCASProducts())
+					{
+						data::ContentIDString idString = contentID.ToString();
+
+						CIPath contentPath;
+						RKIT_CHECK(contentPath.AppendComponent(idString.ToStringView()));
+
+						RKIT_CHECK(AddFileStatusPrefetch(prefetches, prefetchLocations, BuildFileLocation::kOutputContent, contentPath));
+					}
+				}
+			}
+		}
+
+		const size_t numPrefetches = prefetches.Count();
+
+		const size_t numBatches = ComputeNumBatches(numPrefetches, kMinFileStatusesPerBatch);
+
+		if (numBatches <= 1)
+		{
+			RKIT_CHECK(ResolveFileStatusPrefetches(*m_fs, prefetches.ToSpan()));
+		}
+		else
+		{
+			Vector<UniquePtr<IJobRunner>> batchRunners;
+
+			for (size_t batchIndex = 0; batchIndex < numBatches; batchIndex++)
+			{
+				const size_t firstPrefetch = numPrefetches * batchIndex / numBatches;
+				const size_t numBatchPrefetches = numPrefetches * (batchIndex + 1) / numBatches - firstPrefetch;
+
+				UniquePtr<IJobRunner> jobRunner;
+				RKIT_CHECK(New<FileStatusBatchJobRunner>(jobRunner, *m_fs, prefetches.ToSpan().SubSpan(firstPrefetch, numBatchPrefetches)));
+
+				RKIT_CHECK(batchRunners.Append(std::move(jobRunner)));
+			}
+
+			RKIT_CHECK(RunBatchJobs(std::move(batchRunners)));
+		}
+
+		// Insert in discovery order so the cache contents don't depend on batch timing
+		for (const UniquePtr<FileStatusPrefetch> &prefetch : prefetches)
+		{
+			UniquePtr<CachedFileStatus> fileStatus = std::move(prefetch->m_cachedStatus);
+
+			if (!fileStatus->m_exists)
+			{
+				RKIT_CHECK(fileStatus->m_status.m_filePath.Set(prefetch->m_path));
+			}
+
+			FileLocationKey insertLocKey(prefetch->m_location, fileStatus->m_status.m_filePath);
+			RKIT_CHECK(m_cachedFileStatus.SetAndReplaceKey(insertLocKey, std::move(fileStatus)));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::AddFileStatusPrefetch(Vector<UniquePtr<FileStatusPrefetch>> &prefetches, HashSet<FileLocationKey> &prefetchLocations, BuildFileLocation location, const CIPathView &path)
+	{
+		if (prefetchLocations.Contains(FileLocationKey(location, path)))
+			RKIT_RETURN_OK;
+
+		// Incremental builds keep statuses that weren't invalidated
+		if (m_cachedFileStatus.Find(FileLocationKey(location, path)) != m_cachedFileStatus.end())
+			RKIT_RETURN_OK;
+
+		UniquePtr<FileStatusPrefetch> prefetch;
+		RKIT_CHECK(New<FileStatusPrefetch>(prefetch));
+
+		prefetch->m_location = location;
+		RKIT_CHECK(prefetch->m_path.Set(path));
+
+		RKIT_CHECK(New<CachedFileStatus>(prefetch->m_cachedStatus));
+		prefetch->m_cachedStatus->m_exists = false;
+
+		// Key references the prefetch's own path, which doesn't move
+		RKIT_CHECK(prefetchLocations.Add(FileLocationKey(location, prefetch->m_path)));
+		RKIT_CHECK(prefetches.Append(std::move(prefetch)));
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::ResolveFileStatusPrefetches(IBuildFileSystem &fs, const Span<UniquePtr<FileStatusPrefetch>> &prefetches)
+	{
+		for (const UniquePtr<FileStatusPrefetch> &prefetch : prefetches)
+		{
+			RKIT_CHECK(fs.ResolveFileStatusIfExists(prefetch->m_location, prefetch->m_path, false, prefetch->m_cachedStatus.Get(), ResolveCachedFileStatusCallback));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	BuildSystemInstance::FileStatusBatchJobRunner::FileStatusBatchJobRunner(IBuildFileSystem &fs, const Span<UniquePtr<FileStatusPrefetch>> &prefetches)
+		: m_fs(fs)
+		, m_prefetches(prefetches)
+	{
+	}
+
+	Result BuildSystemInstance::FileStatusBatchJobRunner::Run()
+	{
+		return ResolveFileStatusPrefetches(m_fs, m_prefetches);
+	}
+
+	size_t BuildSystemInstance::ComputeNumBatches(size_t numItems, size_t minItemsPerBatch) const
+	{
+		const size_t processorCount = GetDrivers().m_systemDriver->GetProcessorCount();
+
+		size_t numBatches = numItems / minItemsPerBatch;
+		if (numBatches > processorCount)
+			numBatches = processorCount;
+
+		return numBatches;
+	}
+
+	Result BuildSystemInstance::RunBatchJobs(Vector<UniquePtr<IJobRunner>> &&batchRunners)
+	{
+		// Concurrent analyses already keep every core busy
+		if (m_prefetchingAnalyses)
+		{
+			for (const UniquePtr<IJobRunner> &jobRunner : batchRunners)
+			{
+				RKIT_CHECK(jobRunner->Run());
+			}
+
+			RKIT_RETURN_OK;
+		}
+
+		if (!m_batchThreadPool.IsValid())
+		{
+			// This thread runs batches while it waits
+			const uint32_t numThreads = GetDrivers().m_utilitiesDriver->ComputeThreadPoolSize(true);
+
+			RKIT_CHECK(GetDrivers().m_utilitiesDriver->CreateThreadPool(m_batchThreadPool, numThreads));
+		}
+
+		IJobQueue &jobQueue = *m_batchThreadPool->GetJobQueue();
+
+		Vector<RCPtr<Job>> batchJobs;
+
+		for (UniquePtr<IJobRunner> &jobRunner : batchRunners)
+		{
+			RCPtr<Job> batchJob;
+			RKIT_CHECK(jobQueue.CreateJob(&batchJob, JobType::kNormalPriority, std::move(jobRunner), JobDependencyList()));
+
+			RKIT_CHECK(batchJobs.Append(std::move(batchJob)));
+		}
+
+		RCPtr<Job> doneJob;
+		RKIT_CHECK(jobQueue.CreateJob(&doneJob, JobType::kNormalPriority, UniquePtr<IJobRunner>(), batchJobs.ToSpan()));
+
+		batchJobs.Reset();
+
+		jobQueue.WaitForJob(*doneJob, m_batchThreadPool->GetAllJobTypes(), m_batchWakeEvent.Get(), m_batchTerminateEvent.Get());
+
+		// A faulted queue stays faulted, so start over with a new pool next time
+		const PackedResultAndExtCode faultResult = RKIT_TRY_EVAL(jobQueue.CheckFault());
+		if (!utils::ResultIsOK(faultResult))
+		{
+			(void) m_batchThreadPool->Close();
+			m_batchThreadPool.Reset();
+
+			RKIT_CHECK(ThrowIfError(faultResult));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	// Walks the graph from the roots the same way as the dependency check, but instead of running
+	// analyses inline, runs them as jobs and continues the walk into each node's dependencies once
+	// its analysis finishes.  Nothing else about the node is changed, so the dependency check that
+	// follows re-checks every node in the usual order and only finds the analyses already done.
+	// Nodes whose compilers can't run analysis concurrently are left for the dependency check.
+	Result BuildSystemInstance::PrefetchAnalyses()
+	{
+		PrefetchState state;
+
+		m_completedPrefetches = nullptr;
+		m_prefetchingAnalyses = true;
+
+		PackedResultAndExtCode walkResult = RKIT_TRY_EVAL(RunPrefetchWalk(state));
+
+		// Jobs reference the prefetch state, so they must all finish even if the walk failed
+		while (state.m_numInFlight > 0)
 		{
-			rkit::log::ErrorFmt(u8"Unknown dependency node type {} / {}", static_cast<unsigned int>(nodeNamespace), static_cast<unsigned int>(nodeType));
-			RKIT_THROW(ResultCode::kInvalidParameter);
+			RKIT_CHECK(CollectPrefetchedAnalyses(state));
 		}
 
-		UniquePtr<DependencyNode> depNode;
-		RKIT_CHECK(New<DependencyNode>(depNode, compilerIt.Value().Get(), nodeNamespace, nodeType, std::move(content), buildFileLocation));
+		m_prefetchingAnalyses = false;
 
-		RKIT_CHECK(depNode->Initialize(identifier));
+		if (state.m_threadPool.IsValid())
+		{
+			RKIT_CHECK(utils::ThrowResult(state.m_threadPool->Close()));
+		}
 
-		outNode = std::move(depNode);
+		RKIT_CHECK(ThrowIfError(walkResult));
+		RKIT_CHECK(ThrowIfError(state.m_analysisResult));
 
 		RKIT_RETURN_OK;
 	}
 
-	Result BuildSystemInstance::CreateNamedNode(uint32_t nodeNamespace, uint32_t nodeType, BuildFileLocation buildFileLocation, const StringView &identifier, UniquePtr<IDependencyNode> &outNode) const
+	Result BuildSystemInstance::RunPrefetchWalk(PrefetchState &state)
 	{
-		return CreateNode(nodeNamespace, nodeType, buildFileLocation, identifier, Vector<uint8_t>(), outNode);
-	}
+		for (DependencyNode *node : m_rootNodes)
+		{
+			RKIT_CHECK(QueuePrefetchCheck(state, node));
+		}
 
-	Result BuildSystemInstance::CreateContentNode(uint32_t nodeNamespace, uint32_t nodeType, BuildFileLocation buildFileLocation, Vector<uint8_t> &&contentRef, UniquePtr<IDependencyNode> &outNode) const
-	{
-		Vector<uint8_t> content = std::move(contentRef);
+		for (;;)
+		{
+			while (state.m_nodesToCheck.Count() > 0)
+			{
+				if (utils::UnpackResultCode(state.m_analysisResult) != ResultCode::kOK)
+					RKIT_RETURN_OK;
 
-		if (content.Count() == 0)
-			RKIT_THROW(ResultCode::kInvalidParameter);
+				DependencyNode *node = state.m_nodesToCheck[state.m_nodesToCheck.Count() - 1];
+				state.m_nodesToCheck.RemoveRange(state.m_nodesToCheck.Count() - 1, 1);
 
-		return CreateNode(nodeNamespace, nodeType, buildFileLocation, CreateContentID(content.ToSpan()).GetStringView(), std::move(content), outNode);
-	}
+				{
+					MutexLock lock(*m_graphMutex);
+					RKIT_CHECK(CheckNodeFilesAndVersion(node));
+				}
 
-	Result BuildSystemInstance::RegisterNodeCompiler(uint32_t nodeNamespace, uint32_t nodeType, UniquePtr<IDependencyNodeCompiler> &&compiler)
-	{
-		UniquePtr<IDependencyNodeCompiler> compilerMoved(std::move(compiler));
+				if (node->GetDependencyState() != DependencyState::NotAnalyzedOrCompiled)
+				{
+					for (const NodeDependencyInfo &nodeDep : node->GetNodeDependencies())
+					{
+						if (nodeDep.m_mustBeUpToDate)
+						{
+							RKIT_CHECK(QueuePrefetchCheck(state, static_cast<DependencyNode *>(nodeDep.m_node)));
+						}
+					}
+				}
+				else if (node->GetCompiler()->HasAnalysisStage() && node->GetCompiler()->CanRunAnalysisConcurrently())
+				{
+					RKIT_CHECK(StartPrefetchAnalysis(state, node));
+				}
+			}
 
-		RKIT_CHECK(m_nodeCompilers.Set(NodeTypeKey(nodeNamespace, nodeType), std::move(compilerMoved)));
+			if (state.m_numInFlight == 0)
+				break;
+
+			RKIT_CHECK(CollectPrefetchedAnalyses(state));
+		}
 
 		RKIT_RETURN_OK;
 	}
 
-	Result BuildSystemInstance::AddNode(UniquePtr<DependencyNode> &&node)
+	Result BuildSystemInstance::CollectPrefetchedAnalyses(PrefetchState &state)
 	{
-		NodeTypeKey typeKey(node->GetDependencyNodeNamespace(), node->GetDependencyNodeType());
-		NodeKey nodeKey(typeKey, node->GetInputFileLocation(), node->GetIdentifier());
+		PrefetchAnalysis *prefetch = nullptr;
+		{
+			MutexLock lock(*m_prefetchMutex);
 
-		DependencyNode *nodePtr = node.Get();
+			// Waits can wake spuriously, so the list is re-checked after each one
+			while (m_completedPrefetches == nullptr)
+				m_prefetchCompletedCondition->Wait(*m_prefetchMutex);
 
-		RKIT_CHECK(m_nodes.Append(std::move(node)));
+			prefetch = m_completedPrefetches;
+			m_completedPrefetches = nullptr;
+		}
 
-		RKIT_TRY_CATCH_RETHROW(m_nodeLookup.Set(nodeKey, nodePtr),
-			CatchContext(
-				[this]
+		while (prefetch != nullptr)
+		{
+			DependencyNode *node = prefetch->m_node;
+
+			state.m_numInFlight--;
+
+			if (utils::UnpackResultCode(prefetch->m_result) != ResultCode::kOK)
+			{
+				if (utils::UnpackResultCode(state.m_analysisResult) == ResultCode::kOK)
+					state.m_analysisResult = prefetch->m_result;
+			}
+			else
+			{
+				node->SetState(DependencyState::NotCompiled);
+
+				for (const NodeDependencyInfo &nodeDep : node->GetNodeDependencies())
 				{
-					m_nodes.RemoveRange(m_nodes.Count() - 1, 1);
+					if (nodeDep.m_mustBeUpToDate)
+					{
+						RKIT_CHECK(QueuePrefetchCheck(state, static_cast<DependencyNode *>(nodeDep.m_node)));
+					}
 				}
-			)
-		);
+			}
+
+			prefetch = prefetch->m_nextCompleted;
+		}
 
 		RKIT_RETURN_OK;
 	}
 
-	Result BuildSystemInstance::AddRelevantNode(DependencyNode *node)
+	Result BuildSystemInstance::QueuePrefetchCheck(PrefetchState &state, DependencyNode *node)
 	{
-		if (node->GetDependencyCheckPhase() == DependencyCheckPhase::None)
-		{
-			RKIT_CHECK(m_relevantNodes.Append(node));
-			node->SetDependencyCheckPhase(DependencyCheckPhase::CheckFiles);
-		}
+		if (state.m_visitedNodes.Contains(node))
+			RKIT_RETURN_OK;
+
+		RKIT_CHECK(state.m_visitedNodes.Add(node));
+		RKIT_CHECK(state.m_nodesToCheck.Append(node));
 
 		RKIT_RETURN_OK;
 	}
 
-	Result BuildSystemInstance::ProcessTopDepCheck()
+	Result BuildSystemInstance::StartPrefetchAnalysis(PrefetchState &state, DependencyNode *node)
 	{
-		DependencyNode *node = m_depCheckStack[m_depCheckStack.Count() - 1];
-
-		if (node->GetDependencyCheckPhase() == DependencyCheckPhase::Completed)
+		if (!state.m_threadPool.IsValid())
 		{
-			m_depCheckStack.RemoveRange(m_depCheckStack.Count() - 1, 1);
-			RKIT_RETURN_OK;
+			// This thread only waits for analyses to finish
+			const uint32_t numThreads = GetDrivers().m_utilitiesDriver->ComputeThreadPoolSize(false);
+
+			RKIT_CHECK(GetDrivers().m_utilitiesDriver->CreateThreadPool(state.m_threadPool, numThreads));
 		}
 
-		if (node->GetDependencyCheckPhase() == DependencyCheckPhase::CheckFiles)
-		{
-			// This may lower the state to NotAnalyzedOrCompiled or NotCompiled
-			RKIT_CHECK(CheckNodeFilesAndVersion(node));
+		UniquePtr<PrefetchAnalysis> prefetch;
+		RKIT_CHECK(New<PrefetchAnalysis>(prefetch));
 
-			node->SetDependencyCheckPhase(DependencyCheckPhase::EnumerateNodes);
-		}
+		prefetch->m_node = node;
 
-		if (node->GetDependencyCheckPhase() == DependencyCheckPhase::EnumerateNodes)
-		{
-			// This may lower the state to NotCompiled
-			DependencyState depState = node->GetDependencyState();
+		UniquePtr<IJobRunner> jobRunner;
+		RKIT_CHECK(New<AnalysisJobRunner>(jobRunner, *this, *prefetch));
 
-			if (depState == DependencyState::NotAnalyzedOrCompiled)
-			{
-				if (node->GetCompiler()->HasAnalysisStage())
-				{
-					rkit::StringView locationStr = u8"Unk";
+		RKIT_CHECK(state.m_analyses.Append(std::move(prefetch)));
 
-					switch (node->GetInputFileLocation())
-					{
-					case BuildFileLocation::kSourceDir:
-						locationStr = u8"Src";
-						break;
-					case BuildFileLocation::kIntermediateDir:
-						locationStr = u8"Imd";
-						break;
-					default:
-						break;
-					};
+		LogAnalysis(node);
 
-					rkit::log::LogInfoFmt(u8"Build Analysis: {} {} {} -> '{}'", FourCCToPrintable(node->GetDependencyNodeNamespace()).GetStr(), FourCCToPrintable(node->GetDependencyNodeType()).GetStr(), locationStr, node->GetIdentifier());
-					RKIT_CHECK(node->RunAnalysis(this));
-				}
+		RCPtr<Job> analysisJob;
+		RKIT_CHECK(state.m_threadPool->GetJobQueue()->CreateJob(&analysisJob, JobType::kNormalPriority, std::move(jobRunner), JobDependencyList()));
 
-				depState = DependencyState::NotCompiled;
-				node->SetState(depState);
-			}
+		state.m_numInFlight++;
 
-			node->SetDependencyCheckPhase(DependencyCheckPhase::CheckNodes);
+		RKIT_RETURN_OK;
+	}
 
-			RKIT_RETURN_OK;
+	void BuildSystemInstance::MarkPrefetchAnalysisCompleted(PrefetchAnalysis &prefetch)
+	{
+		{
+			MutexLock lock(*m_prefetchMutex);
+			prefetch.m_nextCompleted = m_completedPrefetches;
+			m_completedPrefetches = &prefetch;
 		}
 
-		RKIT_ASSERT(node->GetDependencyCheckPhase() == DependencyCheckPhase::CheckNodes);
+		m_prefetchCompletedCondition->WakeOne();
+	}
 
-		RKIT_CHECK(CheckNodeNodeDependencies(node));
+	BuildSystemInstance::AnalysisJobRunner::AnalysisJobRunner(BuildSystemInstance &instance, PrefetchAnalysis &prefetch)
+		: m_instance(instance)
+		, m_prefetch(prefetch)
+	{
+	}
+
+	Result BuildSystemInstance::AnalysisJobRunner::Run()
+	{
+		m_prefetch.m_result = RKIT_TRY_EVAL(m_prefetch.m_node->RunAnalysis(&m_instance));
+		m_instance.MarkPrefetchAnalysisCompleted(m_prefetch);
 
 		RKIT_RETURN_OK;
 	}
@@ -2791,6 +4481,89 @@ namespace rkit { namespace buildsystem
 		RKIT_RETURN_OK;
 	}
 
+	Result BuildSystemInstance::ResolveMemoizedInput(BuildFileLocation location, const CIPathView &path, const FileStatusView &status, IDependencyNodeCompilerFeedback::ParseMemoizedInputCallback_t parseCallback, const IMemoizedInput *&outParsedInput)
+	{
+		MutexLock lock(*m_memoizedInputsMutex);
+
+		MemoizedInput *memo = nullptr;
+
+		HashMap<MemoizedInputKey, UniquePtr<MemoizedInput> >::Iterator_t lookupIt = m_memoizedInputs.Find(MemoizedInputKey(location, path, parseCallback));
+		if (lookupIt != m_memoizedInputs.end())
+		{
+			memo = lookupIt.Value().Get();
+
+			if (memo->m_fileSize == status.m_fileSize && memo->m_fileTime == status.m_fileTime)
+			{
+				outParsedInput = memo->m_parsedInput.Get();
+				RKIT_RETURN_OK;
+			}
+		}
+
+		// File status changed or the file was never parsed, so load it and check the contents
+		UniquePtr<ISeekableReadStream> inputFile;
+		RKIT_CHECK(TryOpenFileRead(location, path, inputFile));
+
+		if (!inputFile.IsValid())
+			RKIT_THROW(ResultCode::kFileOpenError);
+
+		const FilePos_t fileSize = inputFile->GetSize();
+		if (fileSize > std::numeric_limits<size_t>::max())
+			RKIT_THROW(ResultCode::kOutOfMemory);
+
+		Vector<uint8_t> contents;
+		RKIT_CHECK(contents.Resize(static_cast<size_t>(fileSize)));
+
+		if (contents.Count() > 0)
+		{
+			RKIT_CHECK(inputFile->ReadAll(contents.GetBuffer(), contents.Count()));
+		}
+
+		inputFile.Reset();
+
+		const utils::Sha256DigestBytes contentDigest = GetDrivers().m_utilitiesDriver->GetSha256Calculator()->SimpleHashBuffer(contents.GetBuffer(), contents.Count());
+
+		if (memo != nullptr && !memcmp(memo->m_contentDigest.m_data, contentDigest.m_data, sizeof(contentDigest.m_data)))
+		{
+			// Touched but unchanged
+			memo->m_fileSize = status.m_fileSize;
+			memo->m_fileTime = status.m_fileTime;
+
+			outParsedInput = memo->m_parsedInput.Get();
+			RKIT_RETURN_OK;
+		}
+
+		UniquePtr<IMemoizedInput> parsedInput;
+		{
+			ReadOnlyMemoryStream contentsStream(contents.ToSpan());
+			RKIT_CHECK(parseCallback(contentsStream, parsedInput));
+		}
+
+		if (!parsedInput.IsValid())
+			RKIT_THROW(ResultCode::kInternalError);
+
+		if (memo == nullptr)
+		{
+			UniquePtr<MemoizedInput> newMemo;
+			RKIT_CHECK(New<MemoizedInput>(newMemo));
+
+			newMemo->m_location = location;
+			RKIT_CHECK(newMemo->m_path.Set(path));
+
+			memo = newMemo.Get();
+
+			RKIT_CHECK(m_memoizedInputs.SetAndReplaceKey(MemoizedInputKey(location, memo->m_path, parseCallback), std::move(newMemo)));
+		}
+
+		memo->m_fileSize = status.m_fileSize;
+		memo->m_fileTime = status.m_fileTime;
+		memo->m_contentDigest = contentDigest;
+		memo->m_parsedInput = std::move(parsedInput);
+
+		outParsedInput = memo->m_parsedInput.Get();
+
+		RKIT_RETURN_OK;
+	}
+
 	Result BuildSystemInstance::TryOpenFileRead(BuildFileLocation location, const CIPathView &path, UniquePtr<ISeekableReadStream> &outFile)
 	{
 		// Keep the behavior here in sync with ResolveFileStatus
@@ -2857,9 +4630,89 @@ namespace rkit { namespace buildsystem
 		RKIT_RETURN_OK;
 	}
 
-	Result BuildSystemInstance::UpdateCAS(const data::ContentID &contentID)
+	// Publishes every CAS product of the relevant nodes that isn't already in the content directory.
+	// Files are published in parallel batches, preferring clones over copies where supported.
+	Result BuildSystemInstance::UpdateCASFiles()
+	{
+		rkit::log::LogInfo(u8"Updating CAS files...");
+
+		HashSet<data::ContentID> queuedContentIDs;
+		Vector<CASUpdate> updates;
+
+		for (const DependencyNode *node : m_relevantNodes)
+		{
+			for (const data::ContentID &contentID : node->GetCompileCASProducts())
+			{
+				if (queuedContentIDs.Contains(contentID))
+					continue;
+
+				HashMap<data::ContentID, CASSource>::ConstIterator_t it = m_casSources.Find(contentID);
+				if (it == m_casSources.end())
+				{
+					rkit::log::ErrorFmt(u8"Couldn't find CAS source for content '{}'", contentID.ToString().ToStringView().GetChars());
+					RKIT_THROW(ResultCode::kInternalError);
+				}
+
+				CASUpdate update;
+				update.m_contentID = contentID;
+				update.m_source = &it.Value();
+
+				RKIT_CHECK(queuedContentIDs.Add(contentID));
+				RKIT_CHECK(updates.Append(update));
+			}
+		}
+
+		const size_t numUpdates = updates.Count();
+		const size_t numBatches = ComputeNumBatches(numUpdates, kMinCASUpdatesPerBatch);
+
+		if (numBatches <= 1)
+		{
+			for (CASUpdate &update : updates)
+			{
+				RKIT_CHECK(UpdateCAS(update));
+			}
+		}
+		else
+		{
+			Vector<UniquePtr<IJobRunner>> batchRunners;
+
+			for (size_t batchIndex = 0; batchIndex < numBatches; batchIndex++)
+			{
+				const size_t firstUpdate = numUpdates * batchIndex / numBatches;
+				const size_t numBatchUpdates = numUpdates * (batchIndex + 1) / numBatches - firstUpdate;
+
+				UniquePtr<IJobRunner> jobRunner;
+				RKIT_CHECK(New<CASUpdateBatchJobRunner>(jobRunner, *this, updates.ToSpan().SubSpan(firstUpdate, numBatchUpdates)));
+
+				RKIT_CHECK(batchRunners.Append(std::move(jobRunner)));
+			}
+
+			RKIT_CHECK(RunBatchJobs(std::move(batchRunners)));
+		}
+
+		size_t numPublished = 0;
+		size_t numCloned = 0;
+		FilePos_t bytesCopied = 0;
+
+		for (const CASUpdate &update : updates)
+		{
+			if (update.m_wasPublished)
+				numPublished++;
+
+			if (update.m_wasCloned)
+				numCloned++;
+
+			RKIT_CHECK(SafeAdd(bytesCopied, bytesCopied, update.m_bytesCopied));
+		}
+
+		rkit::log::LogInfoFmt(u8"Published {} of {} CAS files ({} cloned), {} bytes copied", numPublished, numUpdates, numCloned, bytesCopied);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result BuildSystemInstance::UpdateCAS(CASUpdate &update) const
 	{
-		data::ContentIDString contentIDString = contentID.ToString();
+		data::ContentIDString contentIDString = update.m_contentID.ToString();
 
 		OSAbsPath contentBasePath = m_dataContentDir;
 		OSAbsPath contentPath;
@@ -2879,61 +4732,113 @@ namespace rkit { namespace buildsystem
 		bool succeeded_IGNORE = false;
 		RKIT_CHECK(sysDriver.GetFileAttributesAbs(succeeded_IGNORE, exists, attribs, contentPath, false));
 
-		if (!exists)
+		if (exists)
+			RKIT_RETURN_OK;
+
+		OSAbsPath tempPath;
+
 		{
-			HashMap<data::ContentID, CASSource>::ConstIterator_t it = m_casSources.Find(contentID);
-			if (it == m_casSources.end())
-			{
-				rkit::log::ErrorFmt(u8"Couldn't find CAS source for content '{}'", contentIDString.ToStringView().GetChars());
-				RKIT_THROW(ResultCode::kInternalError);
-			}
+			String tempName;
+			RKIT_CHECK(tempName.Set(contentIDString.ToStringView()));
+			RKIT_CHECK(tempName.Append(u8".tmp"));
 
-			OSAbsPath tempPath;
+			OSRelPath osRelPath;
+			RKIT_CHECK(osRelPath.ConvertFrom(CIPathView(tempName)));
 
-			{
-				String tempName;
-				RKIT_CHECK(tempName.Set(contentIDString.ToStringView()));
-				RKIT_CHECK(tempName.Append(u8".tmp"));
+			tempPath = contentBasePath;
+			RKIT_CHECK(tempPath.Append(osRelPath));
+		}
 
-				OSRelPath osRelPath;
-				RKIT_CHECK(osRelPath.ConvertFrom(CIPathView(tempName)));
+		// Intermediate files can be cloned or copied by the OS directly.  Anything else, or a failed
+		// OS copy, goes through the build file system.
+		bool published = false;
 
-				tempPath = contentBasePath;
-				RKIT_CHECK(tempPath.Append(osRelPath));
-			}
+		const CASSource &source = *update.m_source;
+		if (source.m_location == BuildFileLocation::kIntermediateDir)
+		{
+			OSAbsPath sourcePath;
+			RKIT_CHECK(ConstructIntermediatePath(sourcePath, source.m_path));
 
-			UniquePtr<ISeekableReadStream> inStream;
-			RKIT_CHECK(m_fs->TryOpenFileRead(it.Value().m_location, it.Value().m_path, inStream));
+			RKIT_CHECK(sysDriver.CloneFileFromAbsToAbs(published, sourcePath, tempPath, true));
 
-			if (!inStream.IsValid())
+			if (published)
+				update.m_wasCloned = true;
+			else
 			{
-				rkit::log::ErrorFmt(u8"Couldn't open CAS source '{}'", it.Value().m_path.CStr());
-				RKIT_THROW(ResultCode::kInternalError);
+				RKIT_CHECK(sysDriver.CopyFileFromAbsToAbs(published, sourcePath, tempPath, true, true));
+
+				if (published)
+				{
+					RKIT_CHECK(sysDriver.GetFileAttributesAbs(succeeded_IGNORE, exists, attribs, tempPath, false));
+					update.m_bytesCopied = attribs.m_fileSize;
+				}
 			}
+		}
 
-			UniquePtr<ISeekableWriteStream> outStream;
-			RKIT_CHECK(sysDriver.OpenFileWriteAbs(outStream, tempPath, true, true, true, false));
+		if (!published)
+		{
+			RKIT_CHECK(CopyCASSource(update, tempPath));
+		}
 
-			FilePos_t amountRemaining = inStream->GetSize();
-			while (amountRemaining > 0)
-			{
-				uint8_t buffer[2048];
+		RKIT_CHECK(sysDriver.MoveFileFromAbsToAbs(succeeded_IGNORE, tempPath, contentPath, true, false));
 
-				size_t amountToCopy = sizeof(buffer);
-				if (amountToCopy > amountRemaining)
-					amountToCopy = static_cast<size_t>(amountRemaining);
+		update.m_wasPublished = true;
 
-				RKIT_CHECK(inStream->ReadAll(buffer, amountToCopy));
-				RKIT_CHECK(outStream->WriteAll(buffer, amountToCopy));
+		RKIT_RETURN_OK;
+	}
 
-				amountRemaining -= amountToCopy;
-			}
+	Result BuildSystemInstance::CopyCASSource(CASUpdate &update, const OSAbsPathView &destPath) const
+	{
+		const CASSource &source = *update.m_source;
 
-			RKIT_CHECK(outStream->Flush());
-			outStream.Reset();
-			inStream.Reset();
+		UniquePtr<ISeekableReadStream> inStream;
+		RKIT_CHECK(m_fs->TryOpenFileRead(source.m_location, source.m_path, inStream));
 
-			RKIT_CHECK(sysDriver.MoveFileFromAbsToAbs(succeeded_IGNORE, tempPath, contentPath, true, false));
+		if (!inStream.IsValid())
+		{
+			rkit::log::ErrorFmt(u8"Couldn't open CAS source '{}'", source.m_path.CStr());
+			RKIT_THROW(ResultCode::kInternalError);
+		}
+
+		UniquePtr<ISeekableWriteStream> outStream;
+		RKIT_CHECK(GetDrivers().m_systemDriver->OpenFileWriteAbs(outStream, destPath, true, true, true, false));
+
+		Vector<uint8_t> buffer;
+		RKIT_CHECK(buffer.Resize(kCASCopyBufferSize));
+
+		const FilePos_t fileSize = inStream->GetSize();
+
+		FilePos_t amountRemaining = fileSize;
+		while (amountRemaining > 0)
+		{
+			size_t amountToCopy = buffer.Count();
+			if (amountToCopy > amountRemaining)
+				amountToCopy = static_cast<size_t>(amountRemaining);
+
+			RKIT_CHECK(inStream->ReadAll(buffer.GetBuffer(), amountToCopy));
+			RKIT_CHECK(outStream->WriteAll(buffer.GetBuffer(), amountToCopy));
+
+			amountRemaining -= amountToCopy;
+		}
+
+		RKIT_CHECK(outStream->Flush());
+
+		update.m_bytesCopied = fileSize;
+
+		RKIT_RETURN_OK;
+	}
+
+	BuildSystemInstance::CASUpdateBatchJobRunner::CASUpdateBatchJobRunner(const BuildSystemInstance &instance, const Span<CASUpdate> &updates)
+		: m_instance(instance)
+		, m_updates(updates)
+	{
+	}
+
+	Result BuildSystemInstance::CASUpdateBatchJobRunner::Run()
+	{
+		for (CASUpdate &update : m_updates)
+		{
+			RKIT_CHECK(m_instance.UpdateCAS(update));
 		}
 
 		RKIT_RETURN_OK;
@@ -2974,6 +4879,11 @@ namespace rkit { namespace buildsystem
 		return CallbackSpan<IDependencyNode *, const IBuildSystemInstance *>(GetRelevantNodeByIndex, this, m_relevantNodes.Count());
 	}
 
+	IMutex &BuildSystemInstance::GetGraphMutex() const
+	{
+		return *m_graphMutex;
+	}
+
 	Result BuildSystemInstance::RegisterCASSource(const data::ContentID &contentID, BuildFileLocation inputFileLocation, const CIPathView &path)
 	{
 		if (m_casSources.Find(contentID) == m_casSources.end())
@@ -3057,6 +4967,16 @@ namespace rkit { namespace buildsystem
 		return u8"buildsystem.cache";
 	}
 
+	CIPathView BuildSystemInstance::GetCacheTempFileName()
+	{
+		return u8"buildsystem.cache.tmp";
+	}
+
+	CIPathView BuildSystemInstance::GetCacheBenchFileName()
+	{
+		return u8"buildsystem.cache.bench";
+	}
+
 	IDependencyNode *BuildSystemInstance::GetRelevantNodeByIndex(const IBuildSystemInstance *const &instance, size_t index)
 	{
 		return static_cast<const BuildSystemInstance *>(instance)->m_relevantNodes[index];
@@ -4,8 +4,11 @@
 #include "rkit/Core/LogDriver.h"
 #include "rkit/Core/Stream.h"
 #include "rkit/Core/String.h"
+#include "rkit/Core/UniquePtr.h"
 #include "rkit/Core/Vector.h"
 
+#include "rkit/Data/RenderDataHandler.h"
+
 #include "rkit/Render/RenderDefs.h"
 
 #include "rkit/Utilities/Sha2.h"
@@ -131,17 +134,22 @@ namespace rkit { namespace buildsystem
 		static Result WriteFloat64(double f, IWriteStream &stream);
 
 	private:
-		static Result StaticWriteObject(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTITypeBase *rtti, bool isConfigurable, bool isNullable, IWriteStream &stream);
-		static Result WriteEnum(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIEnumType *rtti, bool isConfigurable, IWriteStream &stream);
-		static Result WriteStructure(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIStructType *rtti, IWriteStream &stream);
-		static Result WriteNumber(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTINumberType *rtti, bool isConfigurable, IWriteStream &stream);
-		static Result WriteValueType(IPackageBuilder &pkgBuilder, const void *obj, IWriteStream &stream);
-		static Result WriteBinaryContentIndex(IPackageBuilder &pkgBuilder, const void *obj, IWriteStream &stream);
-		static Result WriteStringIndex(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIStringIndexType *rtti, IWriteStream &stream);
+		static Result WriteFieldImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTITypeBase *rtti, bool isConfigurable, bool isNullable);
+		static Result WriteEnumImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTIEnumType *rtti, bool isConfigurable);
+		static Result WriteStructureImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTIStructType *rtti);
+		static Result WriteNumberImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTINumberType *rtti, bool isConfigurable);
+		static Result WriteValueTypeImage(IPackageBuilder &pkgBuilder, const void *obj, void *image);
+		static Result WriteBinaryContentImage(IPackageBuilder &pkgBuilder, const void *obj, void *image);
+		static Result WriteStringIndexImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTIStringIndexType *rtti);
+		static Result WriteObjectPtrImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTIObjectPtrType *rtti, bool isNullable);
+		static Result WriteObjectPtrSpanImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTIObjectPtrSpanType *rtti, bool isNullable);
+
 		static Result WriteObjectPtr(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, IWriteStream &stream);
-		static Result WriteObjectPtrSpan(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIObjectPtrSpanType *rtti, bool isNullable, IWriteStream &stream);
 
-		static Result WriteConfigurationKey(IPackageBuilder &pkgBuilder, const render::ConfigStringIndex_t &str, data::RenderRTTIMainType mainType, IWriteStream &stream);
+		static Result IndexObjectPtr(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, size_t &outIndex);
+		static Result IndexConfigurationKey(IPackageBuilder &pkgBuilder, const render::ConfigStringIndex_t &str, data::RenderRTTIMainType mainType, render::ConfigStringIndex_t &outConfigKey);
+
+		static const void *EncodeImageIndex(size_t index);
 
 		static Result WritePartialLEUInt64(uint64_t ui, uint8_t numBytes, IWriteStream &stream);
 	};
@@ -425,6 +433,10 @@ namespace rkit { namespace buildsystem
 		RKIT_CHECK(PackageObjectWriter::WriteUInt32(packageVersion, stream));
 		RKIT_CHECK(stream.WriteAll(&shaDigest, sizeof(shaDigest)));
 
+		uint64_t layoutHash = 0;
+		RKIT_CHECK(m_dataHandler->GetPackageLayoutHash(layoutHash));
+		RKIT_CHECK(PackageObjectWriter::WriteUInt64(layoutHash, stream));
+
 		size_t numStrings = m_stringToIndex.Count();
 		size_t numConfigKeys = m_configKeys.Count();
 		size_t numBinaryContent = m_binaryContent.GetBlobs().Count();
@@ -466,8 +478,12 @@ namespace rkit { namespace buildsystem
 
 		for (size_t i = 0; i < kNumIndexables; i++)
 		{
+			UniquePtr<data::IRenderRTTIListBase> imageList;
+			RKIT_CHECK(m_dataHandler->ProcessIndexable(static_cast<data::RenderRTTIIndexableStructType>(i), &imageList, nullptr, nullptr));
+
 			RKIT_CHECK(PackageObjectWriter::WriteCompactIndex(m_objectSpans[i].GetBlobs().Count(), stream));
 			RKIT_CHECK(PackageObjectWriter::WriteCompactIndex(m_indexables[i].GetBlobs().Count(), stream));
+			RKIT_CHECK(PackageObjectWriter::WriteCompactIndex(imageList->GetElementSize(), stream));
 		}
 
 		for (size_t i = 0; i < kNumIndexables; i++)
@@ -498,95 +514,125 @@ namespace rkit { namespace buildsystem
 
 	Result PackageObjectWriter::WriteObject(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTITypeBase *rtti, IWriteStream &stream) const
 	{
-		return StaticWriteObject(pkgBuilder, obj, rtti, false, false, stream);
+		if (rtti->m_type != data::RenderRTTIType::Structure)
+			RKIT_THROW(ResultCode::kInternalError);
+
+		const data::RenderRTTIStructType *structRTTI = reinterpret_cast<const data::RenderRTTIStructType *>(rtti);
+
+		// Objects are written as images of their in-memory layout with references
+		// replaced by package indexes.  The field writers only assign members, so
+		// zero-filling the image first keeps padding bytes stable for deduplication.
+		UniquePtr<data::IRenderRTTIListBase> imageList;
+		RKIT_CHECK(pkgBuilder.GetDataHandler()->ProcessIndexable(structRTTI->m_indexableType, &imageList, nullptr, nullptr));
+		RKIT_CHECK(imageList->Resize(1));
+
+		void *image = imageList->GetElementPtr(0);
+		size_t imageSize = imageList->GetElementSize();
+
+		memset(image, 0, imageSize);
+
+		RKIT_CHECK(WriteStructureImage(pkgBuilder, obj, image, structRTTI));
+
+		return stream.WriteAll(image, imageSize);
 	}
 
-	Result PackageObjectWriter::StaticWriteObject(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTITypeBase *rtti, bool isConfigurable, bool isNullable, IWriteStream &stream)
+	Result PackageObjectWriter::WriteFieldImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTITypeBase *rtti, bool isConfigurable, bool isNullable)
 	{
 		switch (rtti->m_type)
 		{
 		case data::RenderRTTIType::Enum:
-			return WriteEnum(pkgBuilder, obj, reinterpret_cast<const data::RenderRTTIEnumType *>(rtti), isConfigurable, stream);
+			return WriteEnumImage(pkgBuilder, obj, image, reinterpret_cast<const data::RenderRTTIEnumType *>(rtti), isConfigurable);
 		case data::RenderRTTIType::Structure:
 			RKIT_ASSERT(!isConfigurable);
-			return WriteStructure(pkgBuilder, obj, reinterpret_cast<const data::RenderRTTIStructType *>(rtti), stream);
+			return WriteStructureImage(pkgBuilder, obj, image, reinterpret_cast<const data::RenderRTTIStructType *>(rtti));
 		case data::RenderRTTIType::Number:
-			return WriteNumber(pkgBuilder, obj, reinterpret_cast<const data::RenderRTTINumberType *>(rtti), isConfigurable, stream);
+			return WriteNumberImage(pkgBuilder, obj, image, reinterpret_cast<const data::RenderRTTINumberType *>(rtti), isConfigurable);
 		case data::RenderRTTIType::ValueType:
 			RKIT_ASSERT(!isConfigurable);
-			return WriteValueType(pkgBuilder, obj, stream);
+			return WriteValueTypeImage(pkgBuilder, obj, image);
 		case data::RenderRTTIType::StringIndex:
 			RKIT_ASSERT(!isConfigurable);
-			return WriteStringIndex(pkgBuilder, obj, reinterpret_cast<const data::RenderRTTIStringIndexType *>(rtti), stream);
+			return WriteStringIndexImage(pkgBuilder, obj, image, reinterpret_cast<const data::RenderRTTIStringIndexType *>(rtti));
 		case data::RenderRTTIType::ObjectPtr:
 			RKIT_ASSERT(!isConfigurable);
-			return WriteObjectPtr(pkgBuilder, obj, reinterpret_cast<const data::RenderRTTIObjectPtrType *>(rtti), isNullable, stream);
+			return WriteObjectPtrImage(pkgBuilder, obj, image, reinterpret_cast<const data::RenderRTTIObjectPtrType *>(rtti), isNullable);
 		case data::RenderRTTIType::ObjectPtrSpan:
 			RKIT_ASSERT(!isConfigurable);
-			return WriteObjectPtrSpan(pkgBuilder, obj, reinterpret_cast<const data::RenderRTTIObjectPtrSpanType *>(rtti), isNullable, stream);
+			return WriteObjectPtrSpanImage(pkgBuilder, obj, image, reinterpret_cast<const data::RenderRTTIObjectPtrSpanType *>(rtti), isNullable);
 		case data::RenderRTTIType::BinaryContent:
 			RKIT_ASSERT(!isConfigurable);
-			return WriteBinaryContentIndex(pkgBuilder, obj, stream);
+			return WriteBinaryContentImage(pkgBuilder, obj, image);
 		default:
 			RKIT_THROW(ResultCode::kInternalError);
 		}
 	}
 
-	Result PackageObjectWriter::WriteEnum(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIEnumType *rtti, bool isConfigurable, IWriteStream &stream)
+	Result PackageObjectWriter::WriteEnumImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTIEnumType *rtti, bool isConfigurable)
 	{
 		if (isConfigurable)
 		{
-			uint8_t state = rtti->m_getConfigurableStateFunc(obj);
-
-			RKIT_CHECK(WriteUInt8(state, stream));
-
-			switch (state)
+			switch (rtti->m_getConfigurableStateFunc(obj))
 			{
 			case static_cast<uint8_t>(render::ConfigurableValueState::Default):
+				rtti->m_writeConfigurableDefaultFunc(image);
 				RKIT_RETURN_OK;
 			case static_cast<uint8_t>(render::ConfigurableValueState::Configured):
-				return WriteConfigurationKey(pkgBuilder, rtti->m_readConfigurableNameFunc(obj), rtti->m_base.m_mainType, stream);
+				{
+					render::ConfigStringIndex_t configKey;
+					RKIT_CHECK(IndexConfigurationKey(pkgBuilder, rtti->m_readConfigurableNameFunc(obj), rtti->m_base.m_mainType, configKey));
+
+					rtti->m_writeConfigurableNameFunc(image, configKey);
+				}
+				RKIT_RETURN_OK;
 			case static_cast<uint8_t>(render::ConfigurableValueState::Explicit):
-				return WriteUIntForSize(rtti->m_readConfigurableValueFunc(obj), rtti->m_maxValueExclusive - 1, stream);
+				rtti->m_writeConfigurableValueFunc(image, rtti->m_readConfigurableValueFunc(obj));
+				RKIT_RETURN_OK;
 			default:
 				RKIT_THROW(ResultCode::kInternalError);
 			}
 		}
 		else
-			return WriteUIntForSize(rtti->m_readValueFunc(obj), rtti->m_maxValueExclusive - 1, stream);
+		{
+			rtti->m_writeValueFunc(image, rtti->m_readValueFunc(obj));
+			RKIT_RETURN_OK;
+		}
 	}
 
-	Result PackageObjectWriter::WriteStructure(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIStructType *rtti, IWriteStream &stream)
+	Result PackageObjectWriter::WriteStructureImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTIStructType *rtti)
 	{
 		for (size_t i = 0; i < rtti->m_numFields; i++)
 		{
 			const data::RenderRTTIStructField *field = rtti->m_fields + i;
 
-			void *memberPtr = field->m_getMemberPtrFunc(const_cast<void *>(obj));
+			const void *memberPtr = field->m_getMemberPtrFunc(const_cast<void *>(obj));
+			void *imageMemberPtr = field->m_getMemberPtrFunc(image);
 			const data::RenderRTTITypeBase *fieldRTTI = field->m_getTypeFunc();
 
-			RKIT_CHECK(StaticWriteObject(pkgBuilder, memberPtr, fieldRTTI, field->m_isConfigurable, field->m_isNullable, stream));
+			RKIT_CHECK(WriteFieldImage(pkgBuilder, memberPtr, imageMemberPtr, fieldRTTI, field->m_isConfigurable, field->m_isNullable));
 		}
 
 		RKIT_RETURN_OK;
 	}
 
-	Result PackageObjectWriter::WriteNumber(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTINumberType *rtti, bool isConfigurable, IWriteStream &stream)
+	Result PackageObjectWriter::WriteNumberImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTINumberType *rtti, bool isConfigurable)
 	{
 		const data::RenderRTTINumberTypeIOFunctions *ioFuncs = nullptr;
 
 		if (isConfigurable)
 		{
-			uint8_t state = rtti->m_getConfigurableStateFunc(obj);
-
-			RKIT_CHECK(WriteUInt8(state, stream));
-
-			switch (state)
+			switch (rtti->m_getConfigurableStateFunc(obj))
 			{
 			case static_cast<uint8_t>(render::ConfigurableValueState::Default):
+				rtti->m_writeConfigurableDefaultFunc(image);
 				RKIT_RETURN_OK;
 			case static_cast<uint8_t>(render::ConfigurableValueState::Configured):
-				return WriteConfigurationKey(pkgBuilder, rtti->m_readConfigurableNameFunc(obj), rtti->m_base.m_mainType, stream);
+				{
+					render::ConfigStringIndex_t configKey;
+					RKIT_CHECK(IndexConfigurationKey(pkgBuilder, rtti->m_readConfigurableNameFunc(obj), rtti->m_base.m_mainType, configKey));
+
+					rtti->m_writeConfigurableNameFunc(image, configKey);
+				}
+				RKIT_RETURN_OK;
 			case static_cast<uint8_t>(render::ConfigurableValueState::Explicit):
 				ioFuncs = &rtti->m_configurableFunctions;
 				break;
@@ -600,71 +646,50 @@ namespace rkit { namespace buildsystem
 		switch (rtti->m_representation)
 		{
 		case data::RenderRTTINumberRepresentation::Float:
-		{
-			double value = ioFuncs->m_readFloatFunc(obj);
-			if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize32)
-				return WriteFloat32(static_cast<float>(value), stream);
-			else if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize64)
-				return WriteFloat64(value, stream);
-			else
-				RKIT_THROW(ResultCode::kInternalError);
-		}
-		break;
+			ioFuncs->m_writeValueFloatFunc(image, ioFuncs->m_readFloatFunc(obj));
+			RKIT_RETURN_OK;
 		case data::RenderRTTINumberRepresentation::SignedInt:
-		{
-			int64_t value = ioFuncs->m_readValueSIntFunc(obj);
-			if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize8)
-				return WriteSInt8(static_cast<int8_t>(value), stream);
-			else if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize16)
-				return WriteSInt16(static_cast<int16_t>(value), stream);
-			else if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize32)
-				return WriteSInt32(static_cast<int32_t>(value), stream);
-			else if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize64)
-				return WriteSInt64(value, stream);
-			else
-				RKIT_THROW(ResultCode::kInternalError);
-		}
+			ioFuncs->m_writeValueSIntFunc(image, ioFuncs->m_readValueSIntFunc(obj));
+			RKIT_RETURN_OK;
 		case data::RenderRTTINumberRepresentation::UnsignedInt:
-		{
-			uint64_t value = ioFuncs->m_readValueUIntFunc(obj);
-			if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize1 || rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize8)
-				return WriteUInt8(static_cast<uint8_t>(value), stream);
-			else if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize16)
-				return WriteUInt16(static_cast<uint16_t>(value), stream);
-			else if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize32)
-				return WriteUInt32(static_cast<uint32_t>(value), stream);
-			else if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize64)
-				return WriteUInt64(value, stream);
-			else
-				RKIT_THROW(ResultCode::kInternalError);
-		}
+			ioFuncs->m_writeValueUIntFunc(image, ioFuncs->m_readValueUIntFunc(obj));
+			RKIT_RETURN_OK;
 		default:
 			RKIT_THROW(ResultCode::kInternalError);
 		}
 	}
 
-	Result PackageObjectWriter::WriteValueType(IPackageBuilder &pkgBuilder, const void *obj, IWriteStream &stream)
+	Result PackageObjectWriter::WriteValueTypeImage(IPackageBuilder &pkgBuilder, const void *obj, void *image)
 	{
 		const render::ValueType *valueType = static_cast<const render::ValueType *>(obj);
+		render::ValueType *imageValueType = static_cast<render::ValueType *>(image);
 
-		RKIT_CHECK(WriteUInt8(static_cast<uint8_t>(valueType->m_type), stream));
+		const data::IRenderDataHandler *dataHandler = pkgBuilder.GetDataHandler();
+		size_t index = 0;
 
 		switch (valueType->m_type)
 		{
 		case render::ValueTypeType::Numeric:
-			return WriteEnum(pkgBuilder, &valueType->m_value.m_numericType, pkgBuilder.GetDataHandler()->GetNumericTypeRTTI(), false, stream);
+			*imageValueType = render::ValueType(valueType->m_value.m_numericType);
+			RKIT_RETURN_OK;
 		case render::ValueTypeType::VectorNumeric:
-			return WriteObjectPtr(pkgBuilder, &valueType->m_value.m_vectorNumericType, pkgBuilder.GetDataHandler()->GetVectorNumericTypePtrRTTI(), false, stream);
+			RKIT_CHECK(IndexObjectPtr(pkgBuilder, &valueType->m_value.m_vectorNumericType, dataHandler->GetVectorNumericTypePtrRTTI(), false, index));
+			*imageValueType = render::ValueType(static_cast<const render::VectorNumericType *>(EncodeImageIndex(index)));
+			RKIT_RETURN_OK;
 		case render::ValueTypeType::CompoundNumeric:
-			return WriteObjectPtr(pkgBuilder, &valueType->m_value.m_compoundNumericType, pkgBuilder.GetDataHandler()->GetCompoundNumericTypePtrRTTI(), false, stream);
+			RKIT_CHECK(IndexObjectPtr(pkgBuilder, &valueType->m_value.m_compoundNumericType, dataHandler->GetCompoundNumericTypePtrRTTI(), false, index));
+			*imageValueType = render::ValueType(static_cast<const render::CompoundNumericType *>(EncodeImageIndex(index)));
+			RKIT_RETURN_OK;
 		case render::ValueTypeType::Structure:
-			return WriteObjectPtr(pkgBuilder, &valueType->m_value.m_structureType, pkgBuilder.GetDataHandler()->GetStructureTypePtrRTTI(), false, stream);
+			RKIT_CHECK(IndexObjectPtr(pkgBuilder, &valueType->m_value.m_structureType, dataHandler->GetStructureTypePtrRTTI(), false, index));
+			*imageValueType = render::ValueType(static_cast<const render::StructureType *>(EncodeImageIndex(index)));
+			RKIT_RETURN_OK;
 		default:
 			RKIT_THROW(ResultCode::kInternalError);
 		}
 	}
 
-	Result PackageObjectWriter::WriteBinaryContentIndex(IPackageBuilder &pkgBuilder, const void *obj, IWriteStream &stream)
+	Result PackageObjectWriter::WriteBinaryContentImage(IPackageBuilder &pkgBuilder, const void *obj, void *image)
 	{
 		const render::BinaryContent *binaryContent = static_cast<const render::BinaryContent *>(obj);
 
@@ -680,12 +705,13 @@ namespace rkit { namespace buildsystem
 
 		size_t index = 0;
 		RKIT_CHECK(pkgBuilder.IndexBinaryContent(BinaryBlobRef(std::move(blob)), index));
-		RKIT_CHECK(WriteCompactIndex(index, stream));
+
+		static_cast<render::BinaryContent *>(image)->m_contentIndex = index;
 
 		RKIT_RETURN_OK;
 	}
 
-	Result PackageObjectWriter::WriteStringIndex(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIStringIndexType *rtti, IWriteStream &stream)
+	Result PackageObjectWriter::WriteStringIndexImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTIStringIndexType *rtti)
 	{
 		int purpose = rtti->m_getPurposeFunc();
 
@@ -704,33 +730,23 @@ namespace rkit { namespace buildsystem
 			RKIT_THROW(ResultCode::kInternalError);
 
 		RKIT_CHECK(pkgBuilder.IndexString(str, index));
-		RKIT_CHECK(WriteCompactIndex(index, stream));
+
+		rtti->m_writeStringIndexFunc(image, index);
 
 		RKIT_RETURN_OK;
 	}
 
-	Result PackageObjectWriter::WriteObjectPtr(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, IWriteStream &stream)
+	Result PackageObjectWriter::WriteObjectPtrImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTIObjectPtrType *rtti, bool isNullable)
 	{
 		size_t index = 0;
-		const void *objPtr = rtti->m_readFunc(obj);
+		RKIT_CHECK(IndexObjectPtr(pkgBuilder, obj, rtti, isNullable, index));
 
-		if (objPtr == nullptr)
-		{
-			if (!isNullable)
-				RKIT_THROW(ResultCode::kInternalError);
-		}
-		else
-		{
-			RKIT_CHECK(pkgBuilder.IndexObject(objPtr, rtti->m_getTypeFunc(), true, index));
+		rtti->m_writeFunc(image, EncodeImageIndex(index));
 
-			if (isNullable)
-				index++;
-		}
-
-		return WriteCompactIndex(index, stream);
+		RKIT_RETURN_OK;
 	}
 
-	Result PackageObjectWriter::WriteObjectPtrSpan(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIObjectPtrSpanType *rtti, bool isNullable, IWriteStream &stream)
+	Result PackageObjectWriter::WriteObjectPtrSpanImage(IPackageBuilder &pkgBuilder, const void *obj, void *image, const data::RenderRTTIObjectPtrSpanType *rtti, bool isNullable)
 	{
 		const void *currentElement = nullptr;
 		size_t count = 0;
@@ -751,12 +767,42 @@ namespace rkit { namespace buildsystem
 		size_t objectListIndex = 0;
 		RKIT_CHECK(pkgBuilder.IndexObjectList(ptrType->m_getTypeFunc()->m_indexableType, spanBlobBuilder.Finish(), objectListIndex));
 
-		RKIT_CHECK(WriteCompactIndex(objectListIndex, stream));
+		rtti->m_setFunc(image, EncodeImageIndex(objectListIndex), count);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result PackageObjectWriter::WriteObjectPtr(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, IWriteStream &stream)
+	{
+		size_t index = 0;
+		RKIT_CHECK(IndexObjectPtr(pkgBuilder, obj, rtti, isNullable, index));
+
+		return WriteCompactIndex(index, stream);
+	}
+
+	Result PackageObjectWriter::IndexObjectPtr(IPackageBuilder &pkgBuilder, const void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, size_t &outIndex)
+	{
+		size_t index = 0;
+		const void *objPtr = rtti->m_readFunc(obj);
 
+		if (objPtr == nullptr)
+		{
+			if (!isNullable)
+				RKIT_THROW(ResultCode::kInternalError);
+		}
+		else
+		{
+			RKIT_CHECK(pkgBuilder.IndexObject(objPtr, rtti->m_getTypeFunc(), true, index));
+
+			if (isNullable)
+				index++;
+		}
+
+		outIndex = index;
 		RKIT_RETURN_OK;
 	}
 
-	Result PackageObjectWriter::WriteConfigurationKey(IPackageBuilder &pkgBuilder, const render::ConfigStringIndex_t &str, data::RenderRTTIMainType mainType, IWriteStream &stream)
+	Result PackageObjectWriter::IndexConfigurationKey(IPackageBuilder &pkgBuilder, const render::ConfigStringIndex_t &str, data::RenderRTTIMainType mainType, render::ConfigStringIndex_t &outConfigKey)
 	{
 		StringSliceView strSlice = pkgBuilder.GetStringResolver()->ResolveConfigKey(str.GetIndex());
 
@@ -766,11 +812,16 @@ namespace rkit { namespace buildsystem
 		size_t configKeyIndex = 0;
 		RKIT_CHECK(pkgBuilder.IndexConfigKey(globalStringIndex, mainType, configKeyIndex));
 
-		RKIT_CHECK(WriteCompactIndex(configKeyIndex, stream));
+		outConfigKey = render::ConfigStringIndex_t(configKeyIndex);
 
 		RKIT_RETURN_OK;
 	}
 
+	const void *PackageObjectWriter::EncodeImageIndex(size_t index)
+	{
+		return reinterpret_cast<const void *>(static_cast<uintptr_t>(index));
+	}
+
 	Result PackageObjectWriter::WriteUIntForSize(uint64_t ui, uint64_t max, IWriteStream &stream)
 	{
 		if (max <= 0xffu)
@@ -31,6 +31,8 @@ namespace rkit { namespace buildsystem
 
 		IModule *m_shaderCModule = nullptr;
 		const vulkan::GlslCApi *m_glslc = nullptr;
+
+		vulkan::ShaderCompileCacheStats m_shaderCacheStats;
 	};
 
 	typedef rkit::CustomDriverModuleStub<BuildVulkanDriver> BuildVulkanModule;
@@ -89,11 +91,13 @@ namespace rkit { namespace buildsystem
 			render::vulkan::GraphicPipelineStage stage = static_cast<render::vulkan::GraphicPipelineStage>(i);
 
 			UniquePtr<buildsystem::IDependencyNodeCompiler> stageCompiler;
-			RKIT_CHECK(rkit::buildsystem::vulkan::CreateGraphicsPipelineStageCompiler(m_glslc, stage, stageCompiler));
+			RKIT_CHECK(rkit::buildsystem::vulkan::CreateGraphicsPipelineStageCompiler(m_glslc, &m_shaderCacheStats, stage, stageCompiler));
 
 			RKIT_CHECK(instance->GetDependencyGraphFactory()->RegisterNodeCompiler(kDefaultNamespace, vulkan::CreateNodeTypeIDForStage(stage), std::move(stageCompiler)));
 		}
 
+		RKIT_CHECK(instance->AddPostBuildAction(&m_shaderCacheStats));
+
 		RKIT_RETURN_OK;
 	}
 } } // rkit::buildsystem
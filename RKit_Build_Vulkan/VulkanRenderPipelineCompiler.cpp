@@ -3,6 +3,7 @@
 #include "rkit/BuildSystem/BuildSystem.h"
 #include "rkit/BuildSystem/PackageBuilder.h"
 
+#include "rkit/Data/ContentID.h"
 #include "rkit/Data/DataDriver.h"
 #include "rkit/Data/RenderDataHandler.h"
 
@@ -11,17 +12,24 @@
 #include "rkit/Vulkan/GraphicsPipeline.h"
 
 #include "rkit/Core/BufferStream.h"
+#include "rkit/Core/Endian.h"
 #include "rkit/Core/FourCC.h"
 #include "rkit/Core/LogDriver.h"
 #include "rkit/Core/Module.h"
 #include "rkit/Core/ModuleDriver.h"
 #include "rkit/Core/Path.h"
 #include "rkit/Core/Stream.h"
+#include "rkit/Core/SystemDriver.h"
+#include "rkit/Core/UtilitiesDriver.h"
 
 #include "rkit/ShaderC/ShaderC_DLL.h"
 
+#include "rkit/Utilities/Sha2.h"
+
 #include <glslang/Include/glslang_c_interface.h>
 
+#include <cstddef>
+
 namespace rkit { namespace buildsystem { namespace vulkan
 {
 	struct GlslCApi;
@@ -63,7 +71,7 @@ namespace rkit { namespace buildsystem { namespace vulkan
 	class RenderPipelineStageBuildJob final : public PipelineCompilerBase
 	{
 	public:
-		RenderPipelineStageBuildJob(IDependencyNode *depsNode, IDependencyNodeCompilerFeedback *feedback, const GlslCApi *glslc, PipelineType pipelineType);
+		RenderPipelineStageBuildJob(IDependencyNode *depsNode, IDependencyNodeCompilerFeedback *feedback, const GlslCApi *glslc, ShaderCompileCacheStats *cacheStats, PipelineType pipelineType);
 
 		Result AddIncludePath(String &&str);
 
@@ -72,6 +80,17 @@ namespace rkit { namespace buildsystem { namespace vulkan
 		Result WriteToFile(IWriteStream &stream);
 
 	private:
+		struct ShaderCacheEntryHeader
+		{
+			endian::LittleUInt32_t m_magic;
+			endian::LittleUInt32_t m_version;
+			endian::LittleUInt64_t m_compileMicroseconds;
+			endian::LittleUInt32_t m_numDWords;
+		};
+
+		static const uint32_t kShaderCacheMagic = RKIT_FOURCC('S', 'P', 'V', 'C');
+		static const uint32_t kShaderCacheVersion = 2;
+
 		class IncludeResultBase : public glsl_include_result_t, public NoCopy
 		{
 		public:
@@ -117,6 +136,11 @@ namespace rkit { namespace buildsystem { namespace vulkan
 		static Result WriteTextureDescriptorType(IWriteStream &stream, const render::DescriptorType descriptorType, const render::ValueType &valueType);
 		static Result WriteConfigurableRTFormat(IWriteStream &stream, const render::ConfigurableValueBase<render::RenderTargetFormat> &format);
 
+		data::ContentID ComputeCacheKey(const glslang_input_t &input, const char *preprocessedCode) const;
+		static Result FormatCacheEntryPath(CIPath &outPath, const data::ContentID &cacheKey);
+		Result TryLoadCachedSPV(const data::ContentID &cacheKey, bool &outLoaded, uint64_t &outCompileMicroseconds);
+		Result StoreCachedSPV(const data::ContentID &cacheKey, uint64_t compileMicroseconds);
+
 		Result NormalizePath(String &path) const;
 		Result TryInclude(CIPath &&path, bool &outSucceeded, UniquePtr<IncludeResultBase> &outIncludeResult) const;
 		Result ProcessInclude(const StringView &headerName, const StringView &includerName, size_t includeDepth, bool isSystem, UniquePtr<IncludeResultBase> &outIncludeResult);
@@ -131,6 +155,7 @@ namespace rkit { namespace buildsystem { namespace vulkan
 
 		IMallocDriver *m_alloc;
 		const GlslCApi *m_glslc;
+		ShaderCompileCacheStats *m_cacheStats;
 
 		IDependencyNode *m_depsNode;
 		IDependencyNodeCompilerFeedback *m_feedback;
@@ -149,7 +174,7 @@ namespace rkit { namespace buildsystem { namespace vulkan
 	class RenderPipelineStageCompiler final : public IDependencyNodeCompiler, public PipelineCompilerBase
 	{
 	public:
-		explicit RenderPipelineStageCompiler(const GlslCApi *glslc, PipelineType pipelineType, uint32_t stage);
+		explicit RenderPipelineStageCompiler(const GlslCApi *glslc, ShaderCompileCacheStats *cacheStats, PipelineType pipelineType, uint32_t stage);
 
 		bool HasAnalysisStage() const override;
 		Result RunAnalysis(IDependencyNode *depsNode, IDependencyNodeCompilerFeedback *feedback) override;
@@ -163,6 +188,7 @@ namespace rkit { namespace buildsystem { namespace vulkan
 		PipelineType m_pipelineType;
 		uint32_t m_stageUInt;
 		const GlslCApi *m_glslc;
+		ShaderCompileCacheStats *m_cacheStats;
 	};
 
 	class RenderPipelineCompiler final : public IDependencyNodeCompiler, public PipelineCompilerBase
@@ -453,7 +479,7 @@ namespace rkit { namespace buildsystem { namespace vulkan
 		return m_extraBinaryContent[index].ToSpan();
 	}
 
-	RenderPipelineStageBuildJob::RenderPipelineStageBuildJob(IDependencyNode *depsNode, IDependencyNodeCompilerFeedback *feedback, const GlslCApi *glslc, PipelineType pipelineType)
+	RenderPipelineStageBuildJob::RenderPipelineStageBuildJob(IDependencyNode *depsNode, IDependencyNodeCompilerFeedback *feedback, const GlslCApi *glslc, ShaderCompileCacheStats *cacheStats, PipelineType pipelineType)
 		: m_depsNode(depsNode)
 		, m_feedback(feedback)
 		, m_pipelineType(pipelineType)
@@ -461,6 +487,7 @@ namespace rkit { namespace buildsystem { namespace vulkan
 		, m_alloc(GetDrivers().m_mallocDriver.Get())
 		, m_glslangResource{}
 		, m_glslc(glslc)
+		, m_cacheStats(cacheStats)
 	{
 	}
 
@@ -743,7 +770,45 @@ namespace rkit { namespace buildsystem { namespace vulkan
 		if (!shader)
 			RKIT_THROW(ResultCode::kOperationFailed);
 
-		if (!m_glslc->glslang_shader_preprocess(shader, &input) || !m_glslc->glslang_shader_parse(shader, &input))
+		if (!m_glslc->glslang_shader_preprocess(shader, &input))
+		{
+			const char *infoLog = m_glslc->glslang_shader_get_info_log(shader);
+			const char *infoDebugLog = m_glslc->glslang_shader_get_info_debug_log(shader);
+
+			if (infoLog && infoLog[0])
+				rkit::log::Error(StringView::FromCString(ReinterpretAnsiCharToUtf8Char(infoLog)));
+
+			if (infoDebugLog && infoDebugLog[0])
+				rkit::log::Error(StringView::FromCString(ReinterpretAnsiCharToUtf8Char(infoDebugLog)));
+
+			m_glslc->glslang_shader_delete(shader);
+			RKIT_THROW(ResultCode::kOperationFailed);
+		}
+
+		// Preprocessing always runs so that include dependencies are recorded,
+		// but everything after it can be skipped if the preprocessed source
+		// was compiled before.  Cache failures are treated as misses.
+		const data::ContentID cacheKey = ComputeCacheKey(input, m_glslc->glslang_shader_get_preprocessed_code(shader));
+
+		bool loadedFromCache = false;
+		uint64_t cachedCompileMicroseconds = 0;
+		if (!utils::ResultIsOK(RKIT_TRY_EVAL(TryLoadCachedSPV(cacheKey, loadedFromCache, cachedCompileMicroseconds))))
+			loadedFromCache = false;
+
+		if (loadedFromCache)
+		{
+			m_glslc->glslang_shader_delete(shader);
+
+			if (m_cacheStats)
+				m_cacheStats->AddHit(cachedCompileMicroseconds);
+
+			RKIT_RETURN_OK;
+		}
+
+		const ISystemDriver *sysDriver = GetDrivers().m_systemDriver.Get();
+		const uint64_t compileStartTime = sysDriver->GetHighResTimestamp();
+
+		if (!m_glslc->glslang_shader_parse(shader, &input))
 		{
 			const char *infoLog = m_glslc->glslang_shader_get_info_log(shader);
 			const char *infoDebugLog = m_glslc->glslang_shader_get_info_debug_log(shader);
@@ -798,6 +863,191 @@ namespace rkit { namespace buildsystem { namespace vulkan
 		m_glslc->glslang_program_delete(program);
 		m_glslc->glslang_shader_delete(shader);
 
+		const uint64_t compileTicks = sysDriver->GetHighResTimestamp() - compileStartTime;
+		const uint64_t compileMicroseconds = compileTicks * 1000000u / sysDriver->GetHighResTimestampFrequency();
+
+		if (m_cacheStats)
+			m_cacheStats->AddMiss(compileMicroseconds);
+
+		if (!utils::ResultIsOK(RKIT_TRY_EVAL(StoreCachedSPV(cacheKey, compileMicroseconds))))
+			rkit::log::Warning(u8"Failed to write SPIR-V cache entry");
+
+		RKIT_RETURN_OK;
+	}
+
+	data::ContentID RenderPipelineStageBuildJob::ComputeCacheKey(const glslang_input_t &input, const char *preprocessedCode) const
+	{
+		// Anything that can change the generated code must be part of the key.
+		// Defines and permutation settings are emitted into the prefix include,
+		// so they're covered by the preprocessed source.
+		const utils::ISha256Calculator *calculator = GetDrivers().m_utilitiesDriver->GetSha256Calculator();
+		utils::Sha256StreamingState state = calculator->CreateStreamingState();
+
+		glslang_version_t glslangVersion = {};
+		m_glslc->glslang_get_version(&glslangVersion);
+
+		const uint32_t keyValues[] =
+		{
+			kShaderCacheVersion,
+			static_cast<uint32_t>(glslangVersion.major),
+			static_cast<uint32_t>(glslangVersion.minor),
+			static_cast<uint32_t>(glslangVersion.patch),
+			static_cast<uint32_t>(input.language),
+			static_cast<uint32_t>(input.stage),
+			static_cast<uint32_t>(input.client),
+			static_cast<uint32_t>(input.client_version),
+			static_cast<uint32_t>(input.target_language),
+			static_cast<uint32_t>(input.target_language_version),
+			static_cast<uint32_t>(input.default_version),
+			static_cast<uint32_t>(input.default_profile),
+			static_cast<uint32_t>(input.messages),
+		};
+
+		for (uint32_t keyValue : keyValues)
+		{
+			const endian::LittleUInt32_t leValue(keyValue);
+			calculator->AppendStreamingState(state, &leValue, sizeof(leValue));
+		}
+
+		// All resource limits are hashed, not just the ones set here.  Everything before the
+		// limits flags is an int, so that part has no padding and can be hashed directly.
+		const size_t resourceIntsSize = offsetof(glslang_resource_t, limits);
+		static_assert(resourceIntsSize % sizeof(int) == 0, "Unexpected glslang_resource_t layout");
+
+		calculator->AppendStreamingState(state, &m_glslangResource, resourceIntsSize);
+
+		const glslang_limits_t &limits = m_glslangResource.limits;
+		const uint8_t limitFlags[] =
+		{
+			static_cast<uint8_t>(limits.non_inductive_for_loops ? 1 : 0),
+			static_cast<uint8_t>(limits.while_loops ? 1 : 0),
+			static_cast<uint8_t>(limits.do_while_loops ? 1 : 0),
+			static_cast<uint8_t>(limits.general_uniform_indexing ? 1 : 0),
+			static_cast<uint8_t>(limits.general_attribute_matrix_vector_indexing ? 1 : 0),
+			static_cast<uint8_t>(limits.general_varying_indexing ? 1 : 0),
+			static_cast<uint8_t>(limits.general_sampler_indexing ? 1 : 0),
+			static_cast<uint8_t>(limits.general_variable_indexing ? 1 : 0),
+			static_cast<uint8_t>(limits.general_constant_matrix_vector_indexing ? 1 : 0),
+		};
+
+		calculator->AppendStreamingState(state, limitFlags, sizeof(limitFlags));
+
+		const StringView flavor = StringView::FromCString(ReinterpretAnsiCharToUtf8Char(glslangVersion.flavor ? glslangVersion.flavor : ""));
+		const endian::LittleUInt32_t flavorLength(static_cast<uint32_t>(flavor.Length()));
+		calculator->AppendStreamingState(state, &flavorLength, sizeof(flavorLength));
+		calculator->AppendStreamingState(state, flavor.GetChars(), flavor.Length());
+
+		const StringView code = StringView::FromCString(ReinterpretAnsiCharToUtf8Char(preprocessedCode ? preprocessedCode : ""));
+		calculator->AppendStreamingState(state, code.GetChars(), code.Length());
+
+		calculator->FinalizeStreamingState(state);
+
+		const utils::Sha256DigestBytes digest = calculator->FlushToBytes(state.m_state);
+
+		data::ContentID contentID;
+		static_assert(sizeof(digest.m_data) == sizeof(contentID.m_data), "Digest size was wrong");
+		memcpy(contentID.m_data, digest.m_data, sizeof(digest.m_data));
+
+		return contentID;
+	}
+
+	Result RenderPipelineStageBuildJob::FormatCacheEntryPath(CIPath &outPath, const data::ContentID &cacheKey)
+	{
+		const data::ContentIDString keyString = cacheKey.ToString();
+
+		RKIT_CHECK(outPath.Set(GetCompiledShaderCacheIntermediateBasePath()));
+		RKIT_CHECK(outPath.AppendComponent(keyString.ToStringView()));
+
+		RKIT_RETURN_OK;
+	}
+
+	Result RenderPipelineStageBuildJob::TryLoadCachedSPV(const data::ContentID &cacheKey, bool &outLoaded, uint64_t &outCompileMicroseconds)
+	{
+		outLoaded = false;
+
+		CIPath path;
+		RKIT_CHECK(FormatCacheEntryPath(path, cacheKey));
+
+		// Cache entries are read outside of dependency tracking, since they're
+		// keyed by content and can't go stale.
+		UniquePtr<ISeekableReadStream> stream;
+		RKIT_CHECK(m_feedback->GetBuildSystemInstance()->TryOpenFileRead(BuildFileLocation::kIntermediateDir, path, stream));
+
+		if (!stream.IsValid())
+			RKIT_RETURN_OK;
+
+		ShaderCacheEntryHeader header;
+		if (stream->GetSize() < sizeof(header))
+			RKIT_RETURN_OK;
+
+		RKIT_CHECK(stream->ReadAll(&header, sizeof(header)));
+
+		if (header.m_magic.Get() != kShaderCacheMagic || header.m_version.Get() != kShaderCacheVersion)
+			RKIT_RETURN_OK;
+
+		const size_t numDWords = header.m_numDWords.Get();
+		if (stream->GetSize() - sizeof(header) != static_cast<FilePos_t>(numDWords) * 4u)
+			RKIT_RETURN_OK;
+
+		Vector<endian::LittleUInt32_t> leDWords;
+		RKIT_CHECK(leDWords.Resize(numDWords));
+		RKIT_CHECK(stream->ReadAll(leDWords.GetBuffer(), numDWords * sizeof(endian::LittleUInt32_t)));
+
+		RKIT_CHECK(m_resultSPV.Resize(numDWords));
+		for (size_t i = 0; i < numDWords; i++)
+			m_resultSPV[i] = leDWords[i].Get();
+
+		outCompileMicroseconds = header.m_compileMicroseconds.Get();
+		outLoaded = true;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result RenderPipelineStageBuildJob::StoreCachedSPV(const data::ContentID &cacheKey, uint64_t compileMicroseconds)
+	{
+		CIPath path;
+		RKIT_CHECK(FormatCacheEntryPath(path, cacheKey));
+
+		ShaderCacheEntryHeader header;
+		header.m_magic = kShaderCacheMagic;
+		header.m_version = kShaderCacheVersion;
+		header.m_compileMicroseconds = compileMicroseconds;
+		header.m_numDWords = static_cast<uint32_t>(m_resultSPV.Count());
+
+		// Entries are trusted by name, so the entry is written to a temporary file and only moved
+		// into place once it's complete.  A build that stops partway through leaves only the temporary.
+		CIPath tempPath;
+		{
+			const data::ContentIDString keyString = cacheKey.ToString();
+
+			String tempName;
+			RKIT_CHECK(tempName.Set(keyString.ToStringView()));
+			RKIT_CHECK(tempName.Append(u8".tmp"));
+
+			RKIT_CHECK(tempPath.Set(GetCompiledShaderCacheIntermediateBasePath()));
+			RKIT_CHECK(tempPath.AppendComponent(tempName.ToStringView()));
+		}
+
+		IBuildSystemInstance *instance = m_feedback->GetBuildSystemInstance();
+
+		{
+			UniquePtr<ISeekableReadWriteStream> stream;
+			RKIT_CHECK(instance->OpenFileWrite(BuildFileLocation::kIntermediateDir, tempPath, stream));
+
+			RKIT_CHECK(stream->WriteAll(&header, sizeof(header)));
+			RKIT_CHECK(WriteToFile(*stream));
+			RKIT_CHECK(stream->Flush());
+		}
+
+		OSAbsPath tempAbsPath;
+		RKIT_CHECK(instance->ConstructIntermediatePath(tempAbsPath, tempPath));
+
+		OSAbsPath entryAbsPath;
+		RKIT_CHECK(instance->ConstructIntermediatePath(entryAbsPath, path));
+
+		bool succeeded_IGNORE = false;
+		RKIT_CHECK(GetDrivers().m_systemDriver->MoveFileFromAbsToAbs(succeeded_IGNORE, tempAbsPath, entryAbsPath, true, false));
+
 		RKIT_RETURN_OK;
 	}
 
@@ -1354,10 +1604,11 @@ namespace rkit { namespace buildsystem { namespace vulkan
 		header_name = ReinterpretUtf8CharToAnsiChar(m_name.CStr());
 	}
 
-	RenderPipelineStageCompiler::RenderPipelineStageCompiler(const GlslCApi *glslc, PipelineType pipelineType, uint32_t stage)
+	RenderPipelineStageCompiler::RenderPipelineStageCompiler(const GlslCApi *glslc, ShaderCompileCacheStats *cacheStats, PipelineType pipelineType, uint32_t stage)
 		: m_pipelineType(pipelineType)
 		, m_stageUInt(stage)
 		, m_glslc(glslc)
+		, m_cacheStats(cacheStats)
 	{
 	}
 
@@ -1392,7 +1643,7 @@ namespace rkit { namespace buildsystem { namespace vulkan
 
 			render::vulkan::GraphicPipelineStage stage = static_cast<render::vulkan::GraphicPipelineStage>(m_stageUInt);
 
-			RenderPipelineStageBuildJob buildJob(depsNode, feedback, m_glslc, m_pipelineType);
+			RenderPipelineStageBuildJob buildJob(depsNode, feedback, m_glslc, m_cacheStats, m_pipelineType);
 			RKIT_CHECK(buildJob.RunGraphics(package.Get(), pipelineDesc, stage));
 
 			CIPath outPath;
@@ -1479,13 +1730,60 @@ namespace rkit { namespace buildsystem { namespace vulkan
 	}
 
 
+	void ShaderCompileCacheStats::AddHit(uint64_t savedMicroseconds)
+	{
+		m_numHits.Increment();
+		AtomicAdd(m_savedMicroseconds, savedMicroseconds);
+	}
+
+	void ShaderCompileCacheStats::AddMiss(uint64_t compileMicroseconds)
+	{
+		m_numMisses.Increment();
+		AtomicAdd(m_compileMicroseconds, compileMicroseconds);
+	}
+
+	Result ShaderCompileCacheStats::Run()
+	{
+		// Taking the counts resets them, so each build reports only its own results
+		const uint64_t numHits = AtomicTake(m_numHits);
+		const uint64_t numMisses = AtomicTake(m_numMisses);
+		const uint64_t savedMicroseconds = AtomicTake(m_savedMicroseconds);
+		const uint64_t compileMicroseconds = AtomicTake(m_compileMicroseconds);
+
+		if (numHits + numMisses > 0)
+		{
+			rkit::log::LogInfoFmt(u8"SPIR-V cache: {} hits, {} misses, {} ms saved, {} ms compiling",
+				numHits, numMisses, savedMicroseconds / 1000u, compileMicroseconds / 1000u);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	void ShaderCompileCacheStats::AtomicAdd(AtomicUInt64_t &value, uint64_t amount)
+	{
+		uint64_t expected = value.GetWeak();
+		while (!value.CompareExchangeWeak(expected, expected + amount))
+		{
+		}
+	}
+
+	uint64_t ShaderCompileCacheStats::AtomicTake(AtomicUInt64_t &value)
+	{
+		uint64_t expected = value.GetWeak();
+		while (!value.CompareExchangeWeak(expected, 0))
+		{
+		}
+
+		return expected;
+	}
+
 	Result CreatePipelineCompiler(UniquePtr<IDependencyNodeCompiler> &outCompiler)
 	{
 		return New<RenderPipelineCompiler>(outCompiler, PipelineType::Graphics);
 	}
 
-	Result CreateGraphicsPipelineStageCompiler(const GlslCApi *glslc, render::vulkan::GraphicPipelineStage stage, UniquePtr<IDependencyNodeCompiler> &outCompiler)
+	Result CreateGraphicsPipelineStageCompiler(const GlslCApi *glslc, ShaderCompileCacheStats *cacheStats, render::vulkan::GraphicPipelineStage stage, UniquePtr<IDependencyNodeCompiler> &outCompiler)
 	{
-		return New<RenderPipelineStageCompiler>(outCompiler, glslc, PipelineType::Graphics, static_cast<uint32_t>(stage));
+		return New<RenderPipelineStageCompiler>(outCompiler, glslc, cacheStats, PipelineType::Graphics, static_cast<uint32_t>(stage));
 	}
 } } } // rkit::buildsystem::vulkan
@@ -1,15 +1,38 @@
 #pragma once
 
+#include "rkit/BuildSystem/BuildSystem.h"
 #include "rkit/BuildSystem/DependencyGraph.h"
 
+#include "rkit/Core/Atomic.h"
+
 #include "rkit/Vulkan/GraphicsPipeline.h"
 
 namespace rkit { namespace buildsystem { namespace vulkan
 {
 	struct GlslCApi;
 
+	// Counts SPIR-V cache hits and misses over a build and reports them when it finishes.
+	// The counters are reset after each report.
+	class ShaderCompileCacheStats final : public IBuildSystemAction
+	{
+	public:
+		void AddHit(uint64_t savedMicroseconds);
+		void AddMiss(uint64_t compileMicroseconds);
+
+		Result Run() override;
+
+	private:
+		static void AtomicAdd(AtomicUInt64_t &value, uint64_t amount);
+		static uint64_t AtomicTake(AtomicUInt64_t &value);
+
+		AtomicUInt64_t m_numHits;
+		AtomicUInt64_t m_numMisses;
+		AtomicUInt64_t m_savedMicroseconds;
+		AtomicUInt64_t m_compileMicroseconds;
+	};
+
 	uint32_t CreateNodeTypeIDForStage(render::vulkan::GraphicPipelineStage pipelineStage);
 
 	Result CreatePipelineCompiler(UniquePtr<IDependencyNodeCompiler> &outCompiler);
-	Result CreateGraphicsPipelineStageCompiler(const GlslCApi *glslc, render::vulkan::GraphicPipelineStage stage, UniquePtr<IDependencyNodeCompiler> &outCompiler);
+	Result CreateGraphicsPipelineStageCompiler(const GlslCApi *glslc, ShaderCompileCacheStats *cacheStats, render::vulkan::GraphicPipelineStage stage, UniquePtr<IDependencyNodeCompiler> &outCompiler);
 } } } // rkit::buildsystem::vulkan
@@ -28,8 +28,13 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <limits>
 #include <utility>
 #include <cmath>
+#include <cstring>
 
 #include "rkit/Core/CoreLib.h"
+#include "rkit/Math/BitOps.h"
+#include "rkit/Math/Functions.h"
+
+#include "StringToFloatPowersOf5.h"
 
 #if LDBL_MANT_DIG == 53 && LDBL_MAX_EXP == 1024
 
@@ -760,6 +765,287 @@ static long double floatscan(ErrType &err, TFloatScanState *f, int prec, bool po
 }
 
 namespace rkit { namespace corelib {
+	// Fast path for short decimal strings in contiguous buffers.  Inputs with at
+	// most 19 significant digits are converted using the Clinger fast path when
+	// the mantissa and power of 10 are both exact, and otherwise using the
+	// Eisel-Lemire algorithm (as used by fast_float), which is correctly rounded
+	// for any 64-bit decimal mantissa.  Anything else (hex floats, inf/nan,
+	// long mantissas, out-of-range results) is left to floatscan.
+	template<class TFloat>
+	struct FastFloatTraits
+	{
+	};
+
+	template<>
+	struct FastFloatTraits<float>
+	{
+		typedef uint32_t Bits_t;
+
+		static const int kMantissaBits = 23;
+		static const int kMinimumExponent = -127;
+		static const int kInfinitePower = 0xFF;
+		static const int kSmallestPowerOf10 = -64;
+		static const int kLargestPowerOf10 = 38;
+		static const int kMinRoundToEvenPowerOf10 = -17;
+		static const int kMaxRoundToEvenPowerOf10 = 10;
+
+		static const int kMaxExactPowerOf10 = 10;
+		static const uint64_t kMaxExactMantissa = static_cast<uint64_t>(1) << 24;
+
+		static float ExactPowerOf10(int power)
+		{
+			static const float kPowers[] =
+			{
+				1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+			};
+
+			return kPowers[power];
+		}
+	};
+
+	template<>
+	struct FastFloatTraits<double>
+	{
+		typedef uint64_t Bits_t;
+
+		static const int kMantissaBits = 52;
+		static const int kMinimumExponent = -1023;
+		static const int kInfinitePower = 0x7FF;
+		static const int kSmallestPowerOf10 = -342;
+		static const int kLargestPowerOf10 = 308;
+		static const int kMinRoundToEvenPowerOf10 = -4;
+		static const int kMaxRoundToEvenPowerOf10 = 23;
+
+		static const int kMaxExactPowerOf10 = 22;
+		static const uint64_t kMaxExactMantissa = static_cast<uint64_t>(1) << 53;
+
+		static double ExactPowerOf10(int power)
+		{
+			static const double kPowers[] =
+			{
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+			};
+
+			return kPowers[power];
+		}
+	};
+
+	struct SimpleDecimal
+	{
+		uint64_t m_mantissa = 0;
+		int64_t m_exponent = 0;
+		bool m_negative = false;
+		size_t m_length = 0;
+	};
+
+	template<class TChar>
+	bool ScanSimpleDecimal(SimpleDecimal &outDecimal, const TChar *chars, size_t len)
+	{
+		const int kMaxDigits = 19;
+		const int64_t kExponentLimit = 0x10000000;
+
+		size_t pos = 0;
+		uint64_t mantissa = 0;
+		int64_t exponent = 0;
+		int numSignificantDigits = 0;
+		bool gotDigit = false;
+		bool negative = false;
+
+		if (pos < len && (chars[pos] == '+' || chars[pos] == '-'))
+		{
+			negative = (chars[pos] == '-');
+			pos++;
+		}
+
+		// Leave hex floats to floatscan
+		if (pos + 1 < len && chars[pos] == '0' && (chars[pos + 1] == 'x' || chars[pos + 1] == 'X'))
+			return false;
+
+		while (pos < len && chars[pos] >= '0' && chars[pos] <= '9')
+		{
+			const uint32_t digit = static_cast<uint32_t>(chars[pos] - '0');
+			if (numSignificantDigits > 0 || digit != 0)
+			{
+				mantissa = mantissa * 10u + digit;
+				numSignificantDigits++;
+			}
+			gotDigit = true;
+			pos++;
+		}
+
+		if (pos < len && chars[pos] == '.')
+		{
+			pos++;
+
+			while (pos < len && chars[pos] >= '0' && chars[pos] <= '9')
+			{
+				const uint32_t digit = static_cast<uint32_t>(chars[pos] - '0');
+				if (numSignificantDigits > 0 || digit != 0)
+				{
+					mantissa = mantissa * 10u + digit;
+					numSignificantDigits++;
+				}
+				exponent--;
+				gotDigit = true;
+				pos++;
+			}
+		}
+
+		if (!gotDigit || numSignificantDigits > kMaxDigits)
+			return false;
+
+		// An exponent marker with no digits after it isn't consumed
+		if (pos < len && (chars[pos] == 'e' || chars[pos] == 'E'))
+		{
+			size_t expPos = pos + 1;
+			bool negativeExp = false;
+
+			if (expPos < len && (chars[expPos] == '+' || chars[expPos] == '-'))
+			{
+				negativeExp = (chars[expPos] == '-');
+				expPos++;
+			}
+
+			if (expPos < len && chars[expPos] >= '0' && chars[expPos] <= '9')
+			{
+				int64_t expValue = 0;
+				while (expPos < len && chars[expPos] >= '0' && chars[expPos] <= '9')
+				{
+					if (expValue < kExponentLimit)
+						expValue = expValue * 10 + static_cast<int64_t>(chars[expPos] - '0');
+					expPos++;
+				}
+
+				exponent += negativeExp ? -expValue : expValue;
+				pos = expPos;
+			}
+		}
+
+		outDecimal.m_mantissa = mantissa;
+		outDecimal.m_exponent = exponent;
+		outDecimal.m_negative = negative;
+		outDecimal.m_length = pos;
+		return true;
+	}
+
+	template<class TFloat>
+	TFloat AssembleFloat(uint64_t mantissa, int32_t power2, bool negative)
+	{
+		typedef FastFloatTraits<TFloat> Traits_t;
+		typedef typename Traits_t::Bits_t Bits_t;
+
+		Bits_t bits = static_cast<Bits_t>(mantissa | (static_cast<uint64_t>(power2) << Traits_t::kMantissaBits));
+		if (negative)
+			bits |= static_cast<Bits_t>(static_cast<Bits_t>(1) << (sizeof(Bits_t) * 8 - 1));
+
+		TFloat result;
+		memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	template<class TFloat>
+	bool DecimalToFloatFast(TFloat &outF, const SimpleDecimal &decimal)
+	{
+		typedef FastFloatTraits<TFloat> Traits_t;
+
+		uint64_t w = decimal.m_mantissa;
+		const int64_t q = decimal.m_exponent;
+
+		if (w == 0)
+		{
+			outF = decimal.m_negative ? -static_cast<TFloat>(0) : static_cast<TFloat>(0);
+			return true;
+		}
+
+		// Clinger: both operands are exact, so a single IEEE operation rounds correctly
+		if (w <= Traits_t::kMaxExactMantissa && q >= -Traits_t::kMaxExactPowerOf10 && q <= Traits_t::kMaxExactPowerOf10)
+		{
+			TFloat value = static_cast<TFloat>(w);
+			if (q < 0)
+				value = value / Traits_t::ExactPowerOf10(static_cast<int>(-q));
+			else
+				value = value * Traits_t::ExactPowerOf10(static_cast<int>(q));
+
+			outF = decimal.m_negative ? -value : value;
+			return true;
+		}
+
+		// Overflow and underflow are range errors, which floatscan reports
+		if (q < Traits_t::kSmallestPowerOf10 || q > Traits_t::kLargestPowerOf10)
+			return false;
+
+		const int lz = 63 - bitops::FindHighestSet(w);
+		w <<= lz;
+
+		// Approximate w * 5^q with a 128-bit product.  The low word of the power is
+		// only needed if the bits below the mantissa in the high word are all set.
+		const size_t tableIndex = static_cast<size_t>(q - kEiselLemireSmallestPowerOf5) * 2;
+		const uint64_t precisionMask = static_cast<uint64_t>(0xFFFFFFFFFFFFFFFFull) >> (Traits_t::kMantissaBits + 3);
+
+		uint64_t productLow = 0;
+		uint64_t productHigh = 0;
+		math::UnsignedMultiplyInt64(w, kEiselLemirePowersOf5[tableIndex], productLow, productHigh);
+
+		if ((productHigh & precisionMask) == precisionMask)
+		{
+			const uint64_t secondHigh = math::UnsignedMultiplyInt64High(w, kEiselLemirePowersOf5[tableIndex + 1]);
+			productLow += secondHigh;
+			if (secondHigh > productLow)
+				productHigh++;
+		}
+
+		const int upperBit = static_cast<int>(productHigh >> 63);
+		const int shift = upperBit + 64 - Traits_t::kMantissaBits - 3;
+
+		uint64_t mantissa = productHigh >> shift;
+
+		// floor(q * log2(10)) + 63
+		const int32_t qPower2 = static_cast<int32_t>(((217706 * static_cast<int32_t>(q)) >> 16) + 63);
+		int32_t power2 = qPower2 + upperBit - lz - Traits_t::kMinimumExponent;
+
+		if (power2 <= 0)
+		{
+			// Subnormal
+			if (-power2 + 1 >= 64)
+				return false;
+
+			mantissa >>= -power2 + 1;
+			mantissa += (mantissa & 1u);
+			mantissa >>= 1;
+
+			if (mantissa == 0)
+				return false;
+
+			power2 = (mantissa < (static_cast<uint64_t>(1) << Traits_t::kMantissaBits)) ? 0 : 1;
+
+			outF = AssembleFloat<TFloat>(mantissa & ~(static_cast<uint64_t>(1) << Traits_t::kMantissaBits), power2, decimal.m_negative);
+			return true;
+		}
+
+		// Exactly halfway between two values, round to even
+		if (productLow <= 1 && q >= Traits_t::kMinRoundToEvenPowerOf10 && q <= Traits_t::kMaxRoundToEvenPowerOf10
+			&& (mantissa & 3u) == 1u && (mantissa << shift) == productHigh)
+			mantissa &= ~static_cast<uint64_t>(1);
+
+		mantissa += (mantissa & 1u);
+		mantissa >>= 1;
+
+		if (mantissa >= (static_cast<uint64_t>(2) << Traits_t::kMantissaBits))
+		{
+			mantissa = (static_cast<uint64_t>(1) << Traits_t::kMantissaBits);
+			power2++;
+		}
+
+		mantissa &= ~(static_cast<uint64_t>(1) << Traits_t::kMantissaBits);
+
+		if (power2 >= Traits_t::kInfinitePower)
+			return false;
+
+		outF = AssembleFloat<TFloat>(mantissa, power2, decimal.m_negative);
+		return true;
+	}
+
 	template<class TFloat, class TState>
 	bool CharsToFloat(TFloat &f, TState &state, int prec)
 	{
@@ -780,6 +1066,13 @@ namespace rkit { namespace corelib {
 	template<class TFloat, class TChar>
 	bool CharsToFloatChecking(TFloat &f, const TChar *chars, size_t &inOutLen, int prec)
 	{
+		SimpleDecimal decimal;
+		if (ScanSimpleDecimal(decimal, chars, inOutLen) && DecimalToFloatFast(f, decimal))
+		{
+			inOutLen = decimal.m_length;
+			return true;
+		}
+
 		corelib::MemFloatScanState<TChar> state(chars, inOutLen);
 		if (!CharsToFloat(f, state, prec))
 		{
@@ -3,6 +3,7 @@
 #include "rkit/Render/RenderDefs.h"
 
 #include "rkit/Core/Algorithm.h"
+#include "rkit/Core/BufferedStream.h"
 #include "rkit/Core/FourCC.h"
 #include "rkit/Core/LogDriver.h"
 #include "rkit/Core/Stream.h"
@@ -1247,7 +1248,7 @@ namespace rkit { namespace data
 		size_t GetBinaryContentSize(size_t binaryContentIndex) const override;
 		const utils::Sha256DigestBytes &GetPackageUUID() const override;
 
-		Result Load(const IRenderDataHandler *handler, bool allowTempStrings, IRenderDataConfigurator *configurator, IReadStream &stream);
+		Result Load(const IRenderDataHandler *handler, bool allowTempStrings, IRenderDataConfigurator *configurator, BufferedReadStream &stream);
 
 	private:
 		struct StringOffsetAndSize
@@ -1262,37 +1263,64 @@ namespace rkit { namespace data
 			size_t m_count = 0;
 		};
 
-		static Result ReadUInt8(IReadStream &stream, uint8_t &outValue);
-		static Result ReadUInt16(IReadStream &stream, uint16_t &outValue);
-		static Result ReadUInt32(IReadStream &stream, uint32_t &outValue);
-		static Result ReadUInt64(IReadStream &stream, uint64_t &outValue);
+		struct ImageFixup
+		{
+			size_t m_offset = 0;
+			const RenderRTTITypeBase *m_rtti = nullptr;
+			bool m_isConfigurable = false;
+			bool m_isNullable = false;
+		};
 
-		static Result ReadSInt8(IReadStream &stream, int8_t &outValue);
-		static Result ReadSInt16(IReadStream &stream, int16_t &outValue);
-		static Result ReadSInt32(IReadStream &stream, int32_t &outValue);
-		static Result ReadSInt64(IReadStream &stream, int64_t &outValue);
+		static const uint32_t kFieldStreamPackageVersion = 1;
 
-		static Result ReadFloat32(IReadStream &stream, float &outValue);
-		static Result ReadFloat64(IReadStream &stream, double &outValue);
+		static Result ReadUInt8(BufferedReadStream &stream, uint8_t &outValue);
+		static Result ReadUInt16(BufferedReadStream &stream, uint16_t &outValue);
+		static Result ReadUInt32(BufferedReadStream &stream, uint32_t &outValue);
+		static Result ReadUInt64(BufferedReadStream &stream, uint64_t &outValue);
 
-		static Result ReadVariableSizeUInt(IReadStream &stream, uint8_t size, uint64_t &outValue);
-		static Result ReadUIntForSize(IReadStream &stream, size_t maxValue, uint64_t &outValue);
+		static Result ReadSInt8(BufferedReadStream &stream, int8_t &outValue);
+		static Result ReadSInt16(BufferedReadStream &stream, int16_t &outValue);
+		static Result ReadSInt32(BufferedReadStream &stream, int32_t &outValue);
+		static Result ReadSInt64(BufferedReadStream &stream, int64_t &outValue);
 
-		static Result ReadCompactIndex(IReadStream &stream, size_t &outValue);
+		static Result ReadFloat32(BufferedReadStream &stream, float &outValue);
+		static Result ReadFloat64(BufferedReadStream &stream, double &outValue);
+
+		static Result ReadVariableSizeUInt(BufferedReadStream &stream, uint8_t size, uint64_t &outValue);
+		static Result ReadUIntForSize(BufferedReadStream &stream, size_t maxValue, uint64_t &outValue);
+
+		static Result ReadCompactIndex(BufferedReadStream &stream, size_t &outValue);
 
 		static uint64_t DecodeUInt64(uint8_t (&bytes)[8]);
 
-		Result ReadStructure(void *obj, const RenderRTTIStructType *rtti, IReadStream &stream, IRenderDataConfigurator *configurator) const;
-		Result ReadObject(void *obj, const RenderRTTITypeBase *rtti, bool isConfigurable, bool isNullable, IReadStream &stream, IRenderDataConfigurator *configurator) const;
-		Result ReadEnum(void *obj, const RenderRTTIEnumType *rtti, bool isConfigurable, IReadStream &stream, IRenderDataConfigurator *configurator) const;
-		Result ReadNumber(void *obj, const RenderRTTINumberType *rtti, bool isConfigurable, IReadStream &stream, IRenderDataConfigurator *configurator) const;
-		Result ReadValueType(void *obj, IReadStream &stream, IRenderDataConfigurator *configurator) const;
-		Result ReadStringIndex(void *obj, const data::RenderRTTIStringIndexType *rtti, IReadStream &stream) const;
-		Result ReadBinaryContent(void *obj, IReadStream &stream) const;
-		Result ReadObjectPtr(void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, IReadStream &stream) const;
-		Result ReadObjectPtrSpan(void *obj, const data::RenderRTTIObjectPtrSpanType *rtti, bool isNullable, IReadStream &stream) const;
+		Result ReadStructure(void *obj, const RenderRTTIStructType *rtti, BufferedReadStream &stream, IRenderDataConfigurator *configurator) const;
+		Result ReadObject(void *obj, const RenderRTTITypeBase *rtti, bool isConfigurable, bool isNullable, BufferedReadStream &stream, IRenderDataConfigurator *configurator) const;
+		Result ReadEnum(void *obj, const RenderRTTIEnumType *rtti, bool isConfigurable, BufferedReadStream &stream, IRenderDataConfigurator *configurator) const;
+		Result ReadNumber(void *obj, const RenderRTTINumberType *rtti, bool isConfigurable, BufferedReadStream &stream, IRenderDataConfigurator *configurator) const;
+		Result ReadValueType(void *obj, BufferedReadStream &stream, IRenderDataConfigurator *configurator) const;
+		Result ReadStringIndex(void *obj, const data::RenderRTTIStringIndexType *rtti, BufferedReadStream &stream) const;
+		Result ReadBinaryContent(void *obj, BufferedReadStream &stream) const;
+		Result ReadObjectPtr(void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, BufferedReadStream &stream) const;
+		Result ReadObjectPtrSpan(void *obj, const data::RenderRTTIObjectPtrSpanType *rtti, bool isNullable, BufferedReadStream &stream) const;
+
+		Result ReadConfigurationKey(render::ConfigStringIndex_t &outCfgKey, BufferedReadStream &stream) const;
 
-		Result ReadConfigurationKey(render::ConfigStringIndex_t &outCfgKey, IReadStream &stream) const;
+		Result ResolveObjectPtr(void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, size_t objectIndex) const;
+		Result ResolveObjectPtrSpan(void *obj, const data::RenderRTTIObjectPtrSpanType *rtti, bool isNullable, size_t spanIndex) const;
+		Result ResolveConfiguredNumber(void *obj, const RenderRTTINumberType *rtti, size_t cfgKeyIndex, IRenderDataConfigurator *configurator) const;
+		Result CheckConfigurationKey(size_t cfgKeyIndex) const;
+
+		Result LoadObjectImages(const IRenderDataHandler *handler, BufferedReadStream &stream, IRenderDataConfigurator *configurator);
+		static Result BuildImageFixups(Vector<ImageFixup> &fixups, const RenderRTTIStructType *rtti, const uint8_t *imageBase, void *obj);
+
+		Result FixupImageObject(void *obj, const ImageFixup &fixup, IRenderDataConfigurator *configurator) const;
+		Result FixupImageEnum(void *obj, const RenderRTTIEnumType *rtti, bool isConfigurable, IRenderDataConfigurator *configurator) const;
+		Result FixupImageNumber(void *obj, const RenderRTTINumberType *rtti, bool isConfigurable, IRenderDataConfigurator *configurator) const;
+		Result FixupImageValueType(void *obj) const;
+		Result FixupImageStringIndex(void *obj, const data::RenderRTTIStringIndexType *rtti) const;
+		Result FixupImageBinaryContent(void *obj) const;
+
+		static size_t DecodeImageIndex(const void *ptr);
 
 		Result ValidateStructureType(const render::StructureType *structType, const render::StructureType *upperLimit, size_t depth, size_t &complexity);
 		Result ValidateValueType(const render::ValueType &valueType, const render::StructureType *upperLimit, size_t depth, size_t &complexity);
@@ -1357,7 +1385,7 @@ namespace rkit { namespace data
 		return m_uuid;
 	}
 
-	Result Package::Load(const IRenderDataHandler *handler, bool allowTempStrings, IRenderDataConfigurator *configurator, IReadStream &stream)
+	Result Package::Load(const IRenderDataHandler *handler, bool allowTempStrings, IRenderDataConfigurator *configurator, BufferedReadStream &stream)
 	{
 		m_hasTempStrings = allowTempStrings;
 
@@ -1379,12 +1407,30 @@ namespace rkit { namespace data
 			RKIT_THROW(ResultCode::kMalformedFile);
 		}
 
-		if (packageVersion != handler->GetPackageVersion())
+		// Packages from before the image layout are still read field by field
+		const bool isImagePackage = (packageVersion == handler->GetPackageVersion());
+
+		if (!isImagePackage && packageVersion != kFieldStreamPackageVersion)
 		{
 			rkit::log::Error(u8"Package version doesn't match");
 			RKIT_THROW(ResultCode::kMalformedFile);
 		}
 
+		if (isImagePackage)
+		{
+			uint64_t packageLayoutHash = 0;
+			RKIT_CHECK(ReadUInt64(stream, packageLayoutHash));
+
+			uint64_t expectedLayoutHash = 0;
+			RKIT_CHECK(handler->GetPackageLayoutHash(expectedLayoutHash));
+
+			if (packageLayoutHash != expectedLayoutHash)
+			{
+				rkit::log::Error(u8"Package object layout doesn't match, the package needs to be rebuilt");
+				RKIT_THROW(ResultCode::kMalformedFile);
+			}
+		}
+
 		size_t numStrings = 0;
 		size_t numConfigKeys = 0;
 		size_t numBinaryContent = 0;
@@ -1464,6 +1510,18 @@ namespace rkit { namespace data
 
 			RKIT_CHECK(m_indexables[i]->Resize(indexableCount));
 			RKIT_CHECK(m_spanInfos[i].Resize(objectSpanCount));
+
+			if (isImagePackage)
+			{
+				size_t elementSize = 0;
+				RKIT_CHECK(ReadCompactIndex(stream, elementSize));
+
+				if (elementSize != m_indexables[i]->GetElementSize())
+				{
+					rkit::log::Error(u8"Package object layout doesn't match, the package needs to be rebuilt");
+					RKIT_THROW(ResultCode::kMalformedFile);
+				}
+			}
 		}
 
 		for (size_t i = 0; i < kNumIndexables; i++)
@@ -1503,19 +1561,26 @@ namespace rkit { namespace data
 			}
 		}
 
-		for (size_t i = 0; i < kNumIndexables; i++)
+		if (isImagePackage)
 		{
-			const RenderRTTIStructType *structType = nullptr;
-			RKIT_CHECK(handler->ProcessIndexable(static_cast<RenderRTTIIndexableStructType>(i), nullptr, nullptr, &structType));
+			RKIT_CHECK(LoadObjectImages(handler, stream, configurator));
+		}
+		else
+		{
+			for (size_t i = 0; i < kNumIndexables; i++)
+			{
+				const RenderRTTIStructType *structType = nullptr;
+				RKIT_CHECK(handler->ProcessIndexable(static_cast<RenderRTTIIndexableStructType>(i), nullptr, nullptr, &structType));
 
-			IRenderRTTIListBase &objectList = *m_indexables[i];
-			size_t count = objectList.GetCount();
+				IRenderRTTIListBase &objectList = *m_indexables[i];
+				size_t count = objectList.GetCount();
 
-			for (size_t j = 0; j < count; j++)
-			{
-				void *elementData = objectList.GetElementPtr(j);
+				for (size_t j = 0; j < count; j++)
+				{
+					void *elementData = objectList.GetElementPtr(j);
 
-				RKIT_CHECK(ReadStructure(elementData, structType, stream, configurator));
+					RKIT_CHECK(ReadStructure(elementData, structType, stream, configurator));
+				}
 			}
 		}
 
@@ -1530,12 +1595,12 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadUInt8(IReadStream &stream, uint8_t &outValue)
+	Result Package::ReadUInt8(BufferedReadStream &stream, uint8_t &outValue)
 	{
 		return stream.ReadAll(&outValue, 1);
 	}
 
-	Result Package::ReadUInt16(IReadStream &stream, uint16_t &outValue)
+	Result Package::ReadUInt16(BufferedReadStream &stream, uint16_t &outValue)
 	{
 		uint64_t value = 0;
 		RKIT_CHECK(ReadVariableSizeUInt(stream, 2, value));
@@ -1544,7 +1609,7 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadUInt32(IReadStream &stream, uint32_t &outValue)
+	Result Package::ReadUInt32(BufferedReadStream &stream, uint32_t &outValue)
 	{
 		uint64_t value = 0;
 		RKIT_CHECK(ReadVariableSizeUInt(stream, 4, value));
@@ -1553,17 +1618,17 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadUInt64(IReadStream &stream, uint64_t &outValue)
+	Result Package::ReadUInt64(BufferedReadStream &stream, uint64_t &outValue)
 	{
 		return ReadVariableSizeUInt(stream, 8, outValue);
 	}
 
-	Result Package::ReadSInt8(IReadStream &stream, int8_t &outValue)
+	Result Package::ReadSInt8(BufferedReadStream &stream, int8_t &outValue)
 	{
 		return stream.ReadAll(&outValue, 1);
 	}
 
-	Result Package::ReadSInt16(IReadStream &stream, int16_t &outValue)
+	Result Package::ReadSInt16(BufferedReadStream &stream, int16_t &outValue)
 	{
 		uint16_t value = 0;
 		RKIT_CHECK(ReadUInt16(stream, value));
@@ -1572,7 +1637,7 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadSInt32(IReadStream &stream, int32_t &outValue)
+	Result Package::ReadSInt32(BufferedReadStream &stream, int32_t &outValue)
 	{
 		uint32_t value = 0;
 		RKIT_CHECK(ReadUInt32(stream, value));
@@ -1581,7 +1646,7 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadSInt64(IReadStream &stream, int64_t &outValue)
+	Result Package::ReadSInt64(BufferedReadStream &stream, int64_t &outValue)
 	{
 		uint64_t value = 0;
 		RKIT_CHECK(ReadUInt64(stream, value));
@@ -1590,7 +1655,7 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadFloat32(IReadStream &stream, float &outValue)
+	Result Package::ReadFloat32(BufferedReadStream &stream, float &outValue)
 	{
 		uint32_t value = 0;
 		RKIT_CHECK(ReadUInt32(stream, value));
@@ -1599,7 +1664,7 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadFloat64(IReadStream &stream, double &outValue)
+	Result Package::ReadFloat64(BufferedReadStream &stream, double &outValue)
 	{
 		uint64_t value = 0;
 		RKIT_CHECK(ReadUInt64(stream, value));
@@ -1609,7 +1674,7 @@ namespace rkit { namespace data
 	}
 
 
-	Result Package::ReadVariableSizeUInt(IReadStream &stream, uint8_t size, uint64_t &outValue)
+	Result Package::ReadVariableSizeUInt(BufferedReadStream &stream, uint8_t size, uint64_t &outValue)
 	{
 		uint8_t bytes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 		RKIT_CHECK(stream.ReadAll(bytes, size));
@@ -1618,7 +1683,7 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadUIntForSize(IReadStream &stream, size_t maxValue, uint64_t &outValue)
+	Result Package::ReadUIntForSize(BufferedReadStream &stream, size_t maxValue, uint64_t &outValue)
 	{
 		if (maxValue > 0xffffffffu)
 			return ReadVariableSizeUInt(stream, 8, outValue);
@@ -1629,7 +1694,7 @@ namespace rkit { namespace data
 		return ReadVariableSizeUInt(stream, 1, outValue);
 	}
 
-	Result Package::ReadCompactIndex(IReadStream &stream, size_t &outValue)
+	Result Package::ReadCompactIndex(BufferedReadStream &stream, size_t &outValue)
 	{
 		uint8_t bytes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 
@@ -1667,7 +1732,7 @@ namespace rkit { namespace data
 		return result;
 	}
 
-	Result Package::ReadStructure(void *obj, const RenderRTTIStructType *rtti, IReadStream &stream, IRenderDataConfigurator *configurator) const
+	Result Package::ReadStructure(void *obj, const RenderRTTIStructType *rtti, BufferedReadStream &stream, IRenderDataConfigurator *configurator) const
 	{
 		for (size_t i = 0; i < rtti->m_numFields; i++)
 		{
@@ -1682,7 +1747,7 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadObject(void *obj, const data::RenderRTTITypeBase *rtti, bool isConfigurable, bool isNullable, IReadStream &stream, IRenderDataConfigurator *configurator) const
+	Result Package::ReadObject(void *obj, const data::RenderRTTITypeBase *rtti, bool isConfigurable, bool isNullable, BufferedReadStream &stream, IRenderDataConfigurator *configurator) const
 	{
 		switch (rtti->m_type)
 		{
@@ -1713,7 +1778,7 @@ namespace rkit { namespace data
 		}
 	}
 
-	Result Package::ReadEnum(void *obj, const RenderRTTIEnumType *rtti, bool isConfigurable, IReadStream &stream, IRenderDataConfigurator *configurator) const
+	Result Package::ReadEnum(void *obj, const RenderRTTIEnumType *rtti, bool isConfigurable, BufferedReadStream &stream, IRenderDataConfigurator *configurator) const
 	{
 		if (isConfigurable)
 		{
@@ -1775,7 +1840,7 @@ namespace rkit { namespace data
 		}
 	}
 
-	Result Package::ReadNumber(void *obj, const RenderRTTINumberType *rtti, bool isConfigurable, IReadStream &stream, IRenderDataConfigurator *configurator) const
+	Result Package::ReadNumber(void *obj, const RenderRTTINumberType *rtti, bool isConfigurable, BufferedReadStream &stream, IRenderDataConfigurator *configurator) const
 	{
 		const data::RenderRTTINumberTypeIOFunctions *ioFuncs = nullptr;
 
@@ -1796,32 +1861,7 @@ namespace rkit { namespace data
 
 					if (configurator)
 					{
-						StringView keyName = GetString(GetConfigKey(cfgKey.GetIndex()).m_stringIndex);
-
-						switch (rtti->m_representation)
-						{
-						case data::RenderRTTINumberRepresentation::Float:
-							{
-								double value = 0;
-								RKIT_CHECK(configurator->GetFloatConfigKey(cfgKey.GetIndex(), keyName, value));
-								rtti->m_configurableFunctions.m_writeValueFloatFunc(obj, value);
-							}
-							break;
-						case data::RenderRTTINumberRepresentation::SignedInt:
-							{
-								int64_t value = 0;
-								RKIT_CHECK(configurator->GetSIntConfigKey(cfgKey.GetIndex(), keyName, value));
-								rtti->m_configurableFunctions.m_writeValueSIntFunc(obj, value);
-							}
-							break;
-						case data::RenderRTTINumberRepresentation::UnsignedInt:
-							{
-								uint64_t value = 0;
-								RKIT_CHECK(configurator->GetUIntConfigKey(cfgKey.GetIndex(), keyName, value));
-								rtti->m_configurableFunctions.m_writeValueUIntFunc(obj, value);
-							}
-							break;
-						}
+						RKIT_CHECK(ResolveConfiguredNumber(obj, rtti, cfgKey.GetIndex(), configurator));
 					}
 					else
 						rtti->m_writeConfigurableNameFunc(obj, cfgKey);
@@ -1947,7 +1987,7 @@ namespace rkit { namespace data
 		}
 	}
 
-	Result Package::ReadValueType(void *obj, IReadStream &stream, IRenderDataConfigurator *configurator) const
+	Result Package::ReadValueType(void *obj, BufferedReadStream &stream, IRenderDataConfigurator *configurator) const
 	{
 		render::ValueType *vt = static_cast<render::ValueType *>(obj);
 
@@ -1993,7 +2033,7 @@ namespace rkit { namespace data
 		}
 	}
 
-	Result Package::ReadStringIndex(void *obj, const data::RenderRTTIStringIndexType *rtti, IReadStream &stream) const
+	Result Package::ReadStringIndex(void *obj, const data::RenderRTTIStringIndexType *rtti, BufferedReadStream &stream) const
 	{
 		int purpose = rtti->m_getPurposeFunc();
 
@@ -2011,7 +2051,7 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadBinaryContent(void *obj, IReadStream &stream) const
+	Result Package::ReadBinaryContent(void *obj, BufferedReadStream &stream) const
 	{
 		size_t binaryContentIndex = 0;
 		RKIT_CHECK(ReadCompactIndex(stream, binaryContentIndex));
@@ -2021,12 +2061,40 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadObjectPtr(void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, IReadStream &stream) const
+	Result Package::ReadObjectPtr(void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, BufferedReadStream &stream) const
 	{
 		size_t objectIndex = 0;
 
 		RKIT_CHECK(ReadCompactIndex(stream, objectIndex));
 
+		return ResolveObjectPtr(obj, rtti, isNullable, objectIndex);
+	}
+
+	Result Package::ReadObjectPtrSpan(void *obj, const data::RenderRTTIObjectPtrSpanType *rtti, bool isNullable, BufferedReadStream &stream) const
+	{
+		size_t spanIndex = 0;
+		RKIT_CHECK(ReadCompactIndex(stream, spanIndex));
+
+		return ResolveObjectPtrSpan(obj, rtti, isNullable, spanIndex);
+	}
+
+	Result Package::ReadConfigurationKey(render::ConfigStringIndex_t &outCfgKey, BufferedReadStream &stream) const
+	{
+		size_t index = 0;
+		RKIT_CHECK(ReadCompactIndex(stream, index));
+
+		if (index >= m_configKeys.Count())
+		{
+			rkit::log::Error(u8"Configuration key index was out of range");
+			RKIT_THROW(ResultCode::kMalformedFile);
+		}
+
+		outCfgKey = render::ConfigStringIndex_t(index);
+		RKIT_RETURN_OK;
+	}
+
+	Result Package::ResolveObjectPtr(void *obj, const data::RenderRTTIObjectPtrType *rtti, bool isNullable, size_t objectIndex) const
+	{
 		if (isNullable)
 		{
 			if (objectIndex == 0)
@@ -2055,7 +2123,7 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadObjectPtrSpan(void *obj, const data::RenderRTTIObjectPtrSpanType *rtti, bool isNullable, IReadStream &stream) const
+	Result Package::ResolveObjectPtrSpan(void *obj, const data::RenderRTTIObjectPtrSpanType *rtti, bool isNullable, size_t spanIndex) const
 	{
 		const data::RenderRTTIObjectPtrType *ptrType = rtti->m_getPtrTypeFunc();
 		const data::RenderRTTIStructType *structType = ptrType->m_getTypeFunc();
@@ -2064,9 +2132,6 @@ namespace rkit { namespace data
 		if (indexableInt >= kNumIndexables)
 			RKIT_THROW(ResultCode::kInternalError);
 
-		size_t spanIndex = 0;
-		RKIT_CHECK(ReadCompactIndex(stream, spanIndex));
-
 		const IRenderRTTIObjectPtrList &ptrList = *m_objectPtrs[indexableInt];
 		const Vector<ObjectSpanInfo> &spanInfos = m_spanInfos[indexableInt];
 
@@ -2102,21 +2167,336 @@ namespace rkit { namespace data
 		RKIT_RETURN_OK;
 	}
 
-	Result Package::ReadConfigurationKey(render::ConfigStringIndex_t &outCfgKey, IReadStream &stream) const
+	Result Package::ResolveConfiguredNumber(void *obj, const RenderRTTINumberType *rtti, size_t cfgKeyIndex, IRenderDataConfigurator *configurator) const
 	{
-		size_t index = 0;
-		RKIT_CHECK(ReadCompactIndex(stream, index));
+		StringView keyName = GetString(GetConfigKey(cfgKeyIndex).m_stringIndex);
 
-		if (index >= m_configKeys.Count())
+		switch (rtti->m_representation)
+		{
+		case data::RenderRTTINumberRepresentation::Float:
+			{
+				double value = 0;
+				RKIT_CHECK(configurator->GetFloatConfigKey(cfgKeyIndex, keyName, value));
+				rtti->m_configurableFunctions.m_writeValueFloatFunc(obj, value);
+			}
+			break;
+		case data::RenderRTTINumberRepresentation::SignedInt:
+			{
+				int64_t value = 0;
+				RKIT_CHECK(configurator->GetSIntConfigKey(cfgKeyIndex, keyName, value));
+				rtti->m_configurableFunctions.m_writeValueSIntFunc(obj, value);
+			}
+			break;
+		case data::RenderRTTINumberRepresentation::UnsignedInt:
+			{
+				uint64_t value = 0;
+				RKIT_CHECK(configurator->GetUIntConfigKey(cfgKeyIndex, keyName, value));
+				rtti->m_configurableFunctions.m_writeValueUIntFunc(obj, value);
+			}
+			break;
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result Package::CheckConfigurationKey(size_t cfgKeyIndex) const
+	{
+		if (cfgKeyIndex >= m_configKeys.Count())
 		{
 			rkit::log::Error(u8"Configuration key index was out of range");
 			RKIT_THROW(ResultCode::kMalformedFile);
 		}
 
-		outCfgKey = render::ConfigStringIndex_t(index);
 		RKIT_RETURN_OK;
 	}
 
+	Result Package::LoadObjectImages(const IRenderDataHandler *handler, BufferedReadStream &stream, IRenderDataConfigurator *configurator)
+	{
+		// Each object list is stored as one block in its in-memory layout, so read
+		// all of the lists before fixing up references between them.
+		for (size_t i = 0; i < kNumIndexables; i++)
+		{
+			IRenderRTTIListBase &objectList = *m_indexables[i];
+			size_t count = objectList.GetCount();
+
+			if (count == 0)
+				continue;
+
+			size_t imageSize = 0;
+			RKIT_CHECK(SafeMul(imageSize, count, objectList.GetElementSize()));
+
+			RKIT_CHECK(stream.ReadAll(objectList.GetElementPtr(0), imageSize));
+		}
+
+		Vector<ImageFixup> fixups;
+
+		for (size_t i = 0; i < kNumIndexables; i++)
+		{
+			IRenderRTTIListBase &objectList = *m_indexables[i];
+			size_t count = objectList.GetCount();
+
+			if (count == 0)
+				continue;
+
+			const RenderRTTIStructType *structType = nullptr;
+			RKIT_CHECK(handler->ProcessIndexable(static_cast<RenderRTTIIndexableStructType>(i), nullptr, nullptr, &structType));
+
+			uint8_t *imageBase = static_cast<uint8_t *>(objectList.GetElementPtr(0));
+			size_t elementSize = objectList.GetElementSize();
+
+			fixups.ShrinkToSize(0);
+			RKIT_CHECK(BuildImageFixups(fixups, structType, imageBase, imageBase));
+
+			for (size_t j = 0; j < count; j++)
+			{
+				uint8_t *elementData = imageBase + j * elementSize;
+
+				for (const ImageFixup &fixup : fixups)
+				{
+					RKIT_CHECK(FixupImageObject(elementData + fixup.m_offset, fixup, configurator));
+				}
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result Package::BuildImageFixups(Vector<ImageFixup> &fixups, const RenderRTTIStructType *rtti, const uint8_t *imageBase, void *obj)
+	{
+		for (size_t i = 0; i < rtti->m_numFields; i++)
+		{
+			const data::RenderRTTIStructField *field = rtti->m_fields + i;
+
+			void *memberPtr = field->m_getMemberPtrFunc(obj);
+			const data::RenderRTTITypeBase *fieldRTTI = field->m_getTypeFunc();
+
+			if (fieldRTTI->m_type == RenderRTTIType::Structure)
+			{
+				RKIT_CHECK(BuildImageFixups(fixups, reinterpret_cast<const RenderRTTIStructType *>(fieldRTTI), imageBase, memberPtr));
+				continue;
+			}
+
+			// Plain numbers are valid for any bit pattern except bools
+			if (fieldRTTI->m_type == RenderRTTIType::Number && !field->m_isConfigurable)
+			{
+				if (reinterpret_cast<const RenderRTTINumberType *>(fieldRTTI)->m_bitSize != RenderRTTINumberBitSize::BitSize1)
+					continue;
+			}
+
+			ImageFixup fixup;
+			fixup.m_offset = static_cast<size_t>(static_cast<const uint8_t *>(memberPtr) - imageBase);
+			fixup.m_rtti = fieldRTTI;
+			fixup.m_isConfigurable = field->m_isConfigurable;
+			fixup.m_isNullable = field->m_isNullable;
+
+			RKIT_CHECK(fixups.Append(fixup));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result Package::FixupImageObject(void *obj, const ImageFixup &fixup, IRenderDataConfigurator *configurator) const
+	{
+		const RenderRTTITypeBase *rtti = fixup.m_rtti;
+
+		switch (rtti->m_type)
+		{
+		case data::RenderRTTIType::Enum:
+			return FixupImageEnum(obj, reinterpret_cast<const data::RenderRTTIEnumType *>(rtti), fixup.m_isConfigurable, configurator);
+		case data::RenderRTTIType::Number:
+			return FixupImageNumber(obj, reinterpret_cast<const data::RenderRTTINumberType *>(rtti), fixup.m_isConfigurable, configurator);
+		case data::RenderRTTIType::ValueType:
+			return FixupImageValueType(obj);
+		case data::RenderRTTIType::StringIndex:
+			return FixupImageStringIndex(obj, reinterpret_cast<const data::RenderRTTIStringIndexType *>(rtti));
+		case data::RenderRTTIType::ObjectPtr:
+			{
+				const data::RenderRTTIObjectPtrType *ptrRTTI = reinterpret_cast<const data::RenderRTTIObjectPtrType *>(rtti);
+				return ResolveObjectPtr(obj, ptrRTTI, fixup.m_isNullable, DecodeImageIndex(ptrRTTI->m_readFunc(obj)));
+			}
+		case data::RenderRTTIType::ObjectPtrSpan:
+			{
+				const data::RenderRTTIObjectPtrSpanType *spanRTTI = reinterpret_cast<const data::RenderRTTIObjectPtrSpanType *>(rtti);
+
+				const void *encodedSpanIndex = nullptr;
+				size_t count = 0;
+				spanRTTI->m_getFunc(obj, encodedSpanIndex, count);
+
+				return ResolveObjectPtrSpan(obj, spanRTTI, fixup.m_isNullable, DecodeImageIndex(encodedSpanIndex));
+			}
+		case data::RenderRTTIType::BinaryContent:
+			return FixupImageBinaryContent(obj);
+		default:
+			RKIT_THROW(ResultCode::kInternalError);
+		}
+	}
+
+	Result Package::FixupImageEnum(void *obj, const RenderRTTIEnumType *rtti, bool isConfigurable, IRenderDataConfigurator *configurator) const
+	{
+		if (isConfigurable)
+		{
+			switch (rtti->m_getConfigurableStateFunc(obj))
+			{
+			case static_cast<uint8_t>(render::ConfigurableValueState::Default):
+				RKIT_RETURN_OK;
+			case static_cast<uint8_t>(render::ConfigurableValueState::Configured):
+				{
+					size_t cfgKeyIndex = rtti->m_readConfigurableNameFunc(obj).GetIndex();
+					RKIT_CHECK(CheckConfigurationKey(cfgKeyIndex));
+
+					if (configurator)
+					{
+						unsigned int configuredValue = 0;
+						RKIT_CHECK(configurator->GetEnumConfigKey(cfgKeyIndex, GetString(m_configKeys[cfgKeyIndex].m_stringIndex), rtti->m_base.m_mainType, configuredValue));
+						rtti->m_writeConfigurableValueFunc(obj, configuredValue);
+					}
+				}
+				RKIT_RETURN_OK;
+			case static_cast<uint8_t>(render::ConfigurableValueState::Explicit):
+				if (rtti->m_readConfigurableValueFunc(obj) >= rtti->m_maxValueExclusive)
+				{
+					rkit::log::Error(u8"Configurable enum value was out of range");
+					RKIT_THROW(ResultCode::kMalformedFile);
+				}
+				RKIT_RETURN_OK;
+			default:
+				rkit::log::Error(u8"Configurable enum state was invalid");
+				RKIT_THROW(ResultCode::kMalformedFile);
+			}
+		}
+		else
+		{
+			if (rtti->m_readValueFunc(obj) >= rtti->m_maxValueExclusive)
+			{
+				rkit::log::Error(u8"Enum value was out of range");
+				RKIT_THROW(ResultCode::kMalformedFile);
+			}
+
+			RKIT_RETURN_OK;
+		}
+	}
+
+	Result Package::FixupImageNumber(void *obj, const RenderRTTINumberType *rtti, bool isConfigurable, IRenderDataConfigurator *configurator) const
+	{
+		const void *valuePtr = obj;
+
+		if (isConfigurable)
+		{
+			switch (rtti->m_getConfigurableStateFunc(obj))
+			{
+			case static_cast<uint8_t>(render::ConfigurableValueState::Default):
+				RKIT_RETURN_OK;
+			case static_cast<uint8_t>(render::ConfigurableValueState::Configured):
+				{
+					size_t cfgKeyIndex = rtti->m_readConfigurableNameFunc(obj).GetIndex();
+					RKIT_CHECK(CheckConfigurationKey(cfgKeyIndex));
+
+					if (configurator)
+					{
+						RKIT_CHECK(ResolveConfiguredNumber(obj, rtti, cfgKeyIndex, configurator));
+					}
+				}
+				RKIT_RETURN_OK;
+			case static_cast<uint8_t>(render::ConfigurableValueState::Explicit):
+				if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize1)
+					valuePtr = &static_cast<const render::ConfigurableValueBase<bool> *>(obj)->m_u.m_value;
+				break;
+			default:
+				rkit::log::Error(u8"Invalid configurable number state");
+				RKIT_THROW(ResultCode::kMalformedFile);
+			}
+		}
+
+		// 1-bit values are bools, check the stored byte since any other value is not a valid bool
+		if (rtti->m_bitSize == data::RenderRTTINumberBitSize::BitSize1)
+		{
+			uint8_t v = 0;
+			memcpy(&v, valuePtr, 1);
+
+			if (v >= 2)
+			{
+				rkit::log::Error(u8"Invalid 1-bit value");
+				RKIT_THROW(ResultCode::kMalformedFile);
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result Package::FixupImageValueType(void *obj) const
+	{
+		render::ValueType *vt = static_cast<render::ValueType *>(obj);
+
+		const void *ptr = nullptr;
+
+		switch (vt->m_type)
+		{
+		case render::ValueTypeType::Numeric:
+			{
+				const RenderRTTIEnumType *numericTypeRTTI = reinterpret_cast<const RenderRTTIEnumType *>(render_rtti::RTTIResolver<render::NumericType>::GetRTTIType());
+				if (numericTypeRTTI->m_readValueFunc(&vt->m_value.m_numericType) >= numericTypeRTTI->m_maxValueExclusive)
+				{
+					rkit::log::Error(u8"Enum value was out of range");
+					RKIT_THROW(ResultCode::kMalformedFile);
+				}
+			}
+			RKIT_RETURN_OK;
+		case render::ValueTypeType::VectorNumeric:
+			RKIT_CHECK(ResolveObjectPtr(&ptr, reinterpret_cast<const RenderRTTIObjectPtrType *>(render_rtti::RTTIResolver<const render::VectorNumericType *>::GetRTTIType()), false, DecodeImageIndex(vt->m_value.m_vectorNumericType)));
+			*vt = render::ValueType(static_cast<const render::VectorNumericType *>(ptr));
+			RKIT_RETURN_OK;
+		case render::ValueTypeType::CompoundNumeric:
+			RKIT_CHECK(ResolveObjectPtr(&ptr, reinterpret_cast<const RenderRTTIObjectPtrType *>(render_rtti::RTTIResolver<const render::CompoundNumericType *>::GetRTTIType()), false, DecodeImageIndex(vt->m_value.m_compoundNumericType)));
+			*vt = render::ValueType(static_cast<const render::CompoundNumericType *>(ptr));
+			RKIT_RETURN_OK;
+		case render::ValueTypeType::Structure:
+			RKIT_CHECK(ResolveObjectPtr(&ptr, reinterpret_cast<const RenderRTTIObjectPtrType *>(render_rtti::RTTIResolver<const render::StructureType *>::GetRTTIType()), false, DecodeImageIndex(vt->m_value.m_structureType)));
+			*vt = render::ValueType(static_cast<const render::StructureType *>(ptr));
+			RKIT_RETURN_OK;
+		default:
+			rkit::log::Error(u8"Invalid valuetype");
+			RKIT_THROW(ResultCode::kMalformedFile);
+		}
+	}
+
+	Result Package::FixupImageStringIndex(void *obj, const data::RenderRTTIStringIndexType *rtti) const
+	{
+		int purpose = rtti->m_getPurposeFunc();
+
+		if (purpose != render::TempStringIndex_t::kPurpose && purpose != render::GlobalStringIndex_t::kPurpose)
+			RKIT_THROW(ResultCode::kInternalError);
+
+		if (purpose == render::TempStringIndex_t::kPurpose && !m_hasTempStrings)
+		{
+			rtti->m_writeStringIndexFunc(obj, 0);
+			RKIT_RETURN_OK;
+		}
+
+		if (rtti->m_readStringIndexFunc(obj) >= m_strings.Count())
+		{
+			rkit::log::Error(u8"String index was out of range");
+			RKIT_THROW(ResultCode::kMalformedFile);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result Package::FixupImageBinaryContent(void *obj) const
+	{
+		if (static_cast<const render::BinaryContent *>(obj)->m_contentIndex >= m_binaryContentSizes.Count())
+		{
+			rkit::log::Error(u8"Binary content index was out of range");
+			RKIT_THROW(ResultCode::kMalformedFile);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	size_t Package::DecodeImageIndex(const void *ptr)
+	{
+		return static_cast<size_t>(reinterpret_cast<uintptr_t>(ptr));
+	}
+
 	Result Package::ValidateStructureType(const render::StructureType *structType, const render::StructureType *upperLimit, size_t depth, size_t &complexity)
 	{
 		if (upperLimit != nullptr && structType >= upperLimit)
@@ -2249,7 +2629,7 @@ namespace rkit { namespace data
 
 	uint32_t RenderDataHandler::GetPackageVersion() const
 	{
-		return 1;
+		return 3;
 	}
 
 	uint32_t RenderDataHandler::GetPackageIdentifier() const
@@ -2257,12 +2637,114 @@ namespace rkit { namespace data
 		return RKIT_FOURCC('R', 'P', 'K', 'G');
 	}
 
+	Result RenderDataHandler::GetPackageLayoutHash(uint64_t &outHash) const
+	{
+		// 64-bit FNV-1a offset basis
+		uint64_t hash = 0xcbf29ce484222325u;
+
+		for (size_t i = 0; i < static_cast<size_t>(RenderRTTIIndexableStructType::Count); i++)
+		{
+			UniquePtr<IRenderRTTIListBase> list;
+			const RenderRTTIStructType *rtti = nullptr;
+			RKIT_CHECK(ProcessIndexable(static_cast<RenderRTTIIndexableStructType>(i), &list, nullptr, &rtti));
+
+			// Field offsets are taken from a real element, the same way the loader finds them
+			RKIT_CHECK(list->Resize(1));
+
+			uint8_t *imageBase = static_cast<uint8_t *>(list->GetElementPtr(0));
+
+			MixLayoutHash(hash, i);
+			MixLayoutHash(hash, list->GetElementSize());
+			HashStructLayout(hash, rtti, imageBase, imageBase);
+		}
+
+		outHash = hash;
+		RKIT_RETURN_OK;
+	}
+
+	void RenderDataHandler::HashStructLayout(uint64_t &hash, const RenderRTTIStructType *rtti, const uint8_t *imageBase, void *obj)
+	{
+		MixLayoutHash(hash, rtti->m_numFields);
+
+		for (size_t i = 0; i < rtti->m_numFields; i++)
+		{
+			const data::RenderRTTIStructField *field = rtti->m_fields + i;
+
+			void *memberPtr = field->m_getMemberPtrFunc(obj);
+			const data::RenderRTTITypeBase *fieldRTTI = field->m_getTypeFunc();
+
+			MixLayoutHash(hash, static_cast<uint64_t>(static_cast<const uint8_t *>(memberPtr) - imageBase));
+			MixLayoutHash(hash, static_cast<uint64_t>(fieldRTTI->m_type));
+			MixLayoutHash(hash, static_cast<uint64_t>(fieldRTTI->m_mainType));
+			MixLayoutHash(hash, (field->m_isConfigurable ? 1u : 0u) | (field->m_isNullable ? 2u : 0u));
+
+			switch (fieldRTTI->m_type)
+			{
+			case RenderRTTIType::Structure:
+				HashStructLayout(hash, reinterpret_cast<const RenderRTTIStructType *>(fieldRTTI), imageBase, memberPtr);
+				break;
+			case RenderRTTIType::Number:
+				{
+					const RenderRTTINumberType *numberRTTI = reinterpret_cast<const RenderRTTINumberType *>(fieldRTTI);
+					MixLayoutHash(hash, static_cast<uint64_t>(numberRTTI->m_bitSize));
+					MixLayoutHash(hash, static_cast<uint64_t>(numberRTTI->m_representation));
+				}
+				break;
+			case RenderRTTIType::ObjectPtrSpan:
+				MixLayoutHash(hash, reinterpret_cast<const RenderRTTIObjectPtrSpanType *>(fieldRTTI)->m_ptrSize);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	void RenderDataHandler::MixLayoutHash(uint64_t &hash, uint64_t value)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			hash ^= static_cast<uint8_t>(value >> (i * 8));
+			hash *= 0x100000001b3u;
+		}
+	}
+
 	Result RenderDataHandler::LoadPackage(IReadStream &stream, bool allowTempStrings, data::IRenderDataConfigurator *configurator, UniquePtr<IRenderDataPackage> &outPackage, Vector<Vector<uint8_t>> *outBinaryContent) const
 	{
+		Vector<uint8_t> readBuffer;
+		RKIT_CHECK(readBuffer.Resize(kPackageReadBufferSize));
+
+		BufferedReadStream bufferedStream(stream, readBuffer.ToSpan());
+
+		return LoadPackageBuffered(bufferedStream, allowTempStrings, configurator, outPackage, outBinaryContent);
+	}
+
+	Result RenderDataHandler::LoadPackage(ISeekableReadStream &stream, bool allowTempStrings, data::IRenderDataConfigurator *configurator, UniquePtr<IRenderDataPackage> &outPackage, Vector<Vector<uint8_t>> *outBinaryContent) const
+	{
+		Vector<uint8_t> readBuffer;
+		RKIT_CHECK(readBuffer.Resize(kPackageReadBufferSize));
+
+		BufferedReadStream bufferedStream(stream, readBuffer.ToSpan());
+
+		RKIT_CHECK(LoadPackageBuffered(bufferedStream, allowTempStrings, configurator, outPackage, outBinaryContent));
+
+		// Give back whatever was read ahead, since callers may read data that follows the package
+		const size_t bufferedCount = bufferedStream.GetBufferedCount();
+		if (bufferedCount > 0)
+		{
+			RKIT_CHECK(stream.SeekStart(stream.Tell() - static_cast<FilePos_t>(bufferedCount)));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result RenderDataHandler::LoadPackageBuffered(BufferedReadStream &bufferedStream, bool allowTempStrings, data::IRenderDataConfigurator *configurator, UniquePtr<IRenderDataPackage> &outPackage, Vector<Vector<uint8_t>> *outBinaryContent) const
+	{
+		// Package headers are mostly compact integers, so they're read through a buffer.
+		// Object images larger than the buffer are read directly into their lists.
 		UniquePtr<Package> package;
 		RKIT_CHECK(New<Package>(package));
 
-		RKIT_CHECK(package->Load(this, allowTempStrings, configurator, stream));
+		RKIT_CHECK(package->Load(this, allowTempStrings, configurator, bufferedStream));
 
 		if (outBinaryContent)
 		{
@@ -2279,7 +2761,7 @@ namespace rkit { namespace data
 
 				if (contentSize > 0)
 				{
-					RKIT_CHECK(stream.ReadAll(&contentInstance[0], contentSize));
+					RKIT_CHECK(bufferedStream.ReadAll(&contentInstance[0], contentSize));
 				}
 			}
 		}
@@ -3,6 +3,11 @@
 
 #include "rkit/Data/RenderDataHandler.h"
 
+namespace rkit
+{
+	class BufferedReadStream;
+}
+
 namespace rkit { namespace data
 {
 	class RenderDataHandler final : public IRenderDataHandler
@@ -31,7 +36,17 @@ namespace rkit { namespace data
 
 		uint32_t GetPackageVersion() const override;
 		uint32_t GetPackageIdentifier() const override;
+		Result GetPackageLayoutHash(uint64_t &outHash) const override;
 
 		Result LoadPackage(IReadStream &stream, bool allowTempStrings, data::IRenderDataConfigurator *configurator, UniquePtr<IRenderDataPackage> &outPackage, Vector<Vector<uint8_t>> *outBinaryContent) const override;
+		Result LoadPackage(ISeekableReadStream &stream, bool allowTempStrings, data::IRenderDataConfigurator *configurator, UniquePtr<IRenderDataPackage> &outPackage, Vector<Vector<uint8_t>> *outBinaryContent) const override;
+
+	private:
+		static const size_t kPackageReadBufferSize = 16 * 1024;
+
+		static void HashStructLayout(uint64_t &hash, const RenderRTTIStructType *rtti, const uint8_t *imageBase, void *obj);
+		static void MixLayoutHash(uint64_t &hash, uint64_t value);
+
+		Result LoadPackageBuffered(BufferedReadStream &bufferedStream, bool allowTempStrings, data::IRenderDataConfigurator *configurator, UniquePtr<IRenderDataPackage> &outPackage, Vector<Vector<uint8_t>> *outBinaryContent) const;
 	};
 } } // rkit::data
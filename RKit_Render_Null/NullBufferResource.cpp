@@ -0,0 +1,41 @@
+#include "NullBufferResource.h"
+
+#include "rkit/Render/BufferSpec.h"
+
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/UniquePtr.h"
+
+#include "NullMemoryHeap.h"
+
+namespace rkit { namespace render { namespace null {
+	static const GPUMemoryAlignment_t kBufferAlignment = 256;
+
+	NullBuffer::NullBuffer(const MemoryAddress &baseAddress, GPUMemorySize_t size)
+		: m_baseAddress(baseAddress)
+		, m_size(size)
+	{
+	}
+
+	uint8_t *NullBuffer::GetCPUMemory() const
+	{
+		return ResolveCPUMemory(m_baseAddress);
+	}
+
+	NullBufferPrototype::NullBufferPrototype(GPUMemorySize_t size)
+		: m_size(size)
+	{
+	}
+
+	MemoryRequirementsView NullBufferPrototype::GetMemoryRequirements() const
+	{
+		return ExportMemoryRequirements(m_size, kBufferAlignment);
+	}
+
+	Result NullBufferPrototype::Create(UniquePtr<NullBufferPrototype> &outBufferPrototype, const BufferSpec &bufferSpec, const BufferResourceSpec &resourceSpec)
+	{
+		if (bufferSpec.m_size == 0)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		return New<NullBufferPrototype>(outBufferPrototype, bufferSpec.m_size);
+	}
+} } }
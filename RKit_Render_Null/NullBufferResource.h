@@ -0,0 +1,66 @@
+#pragma once
+
+#include "rkit/Render/BufferResource.h"
+#include "rkit/Render/Memory.h"
+
+#include <stdint.h>
+
+namespace rkit
+{
+	template<class T>
+	class UniquePtr;
+}
+
+namespace rkit { namespace render {
+	struct BufferSpec;
+	struct BufferResourceSpec;
+} }
+
+namespace rkit { namespace render { namespace null {
+	class NullBuffer final : public IBufferResource
+	{
+	public:
+		NullBuffer(const MemoryAddress &baseAddress, GPUMemorySize_t size);
+
+		const MemoryAddress &GetBaseAddress() const;
+		GPUMemorySize_t GetSize() const;
+
+		uint8_t *GetCPUMemory() const;
+
+	private:
+		MemoryAddress m_baseAddress;
+		GPUMemorySize_t m_size;
+	};
+
+	class NullBufferPrototype final : public IBufferPrototype
+	{
+	public:
+		explicit NullBufferPrototype(GPUMemorySize_t size);
+
+		MemoryRequirementsView GetMemoryRequirements() const override;
+
+		GPUMemorySize_t GetSize() const;
+
+		static Result Create(UniquePtr<NullBufferPrototype> &outBufferPrototype, const BufferSpec &bufferSpec, const BufferResourceSpec &resourceSpec);
+
+	private:
+		GPUMemorySize_t m_size;
+	};
+} } }
+
+namespace rkit { namespace render { namespace null {
+	inline const MemoryAddress &NullBuffer::GetBaseAddress() const
+	{
+		return m_baseAddress;
+	}
+
+	inline GPUMemorySize_t NullBuffer::GetSize() const
+	{
+		return m_size;
+	}
+
+	inline GPUMemorySize_t NullBufferPrototype::GetSize() const
+	{
+		return m_size;
+	}
+} } }
@@ -0,0 +1,139 @@
+#include "NullCommandAllocator.h"
+#include "NullCommandBatch.h"
+
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/UniquePtr.h"
+#include "rkit/Core/Vector.h"
+
+namespace rkit { namespace render { namespace null
+{
+	class NullCommandAllocator final : public NullCommandAllocatorBase
+	{
+	public:
+		NullCommandAllocator(CommandQueueType queueType, bool isBundle);
+
+		IInternalCommandAllocator *ToInternalCommandAllocator() override;
+
+		Result OpenCopyCommandBatch(ICopyCommandBatch *&outCommandBatch, bool cpuWaitable) override;
+		Result OpenGraphicsCommandBatch(IGraphicsCommandBatch *&outCommandBatch, bool cpuWaitable) override;
+		Result OpenComputeCommandBatch(IComputeCommandBatch *&outCommandBatch, bool cpuWaitable) override;
+		Result OpenGraphicsComputeCommandBatch(IGraphicsComputeCommandBatch *&outCommandBatch, bool cpuWaitable) override;
+
+		Result ResetCommandAllocator(bool discardResources) override;
+
+		DynamicCastRef_t InternalDynamicCast() override;
+
+		template<class TCommandBatchType>
+		Result TypedOpenCommandBatch(TCommandBatchType *&outCommandBatch, bool cpuWaitable);
+
+		Result OpenCommandBatch(NullCommandBatchBase *&outCommandBatch, bool cpuWaitable);
+
+	private:
+		Vector<UniquePtr<NullCommandBatchBase>> m_commandBatches;
+		size_t m_numAllocatedBatches = 0;
+
+		CommandQueueType m_queueType = CommandQueueType::kCount;
+		bool m_isBundle = false;
+	};
+
+	NullCommandAllocator::NullCommandAllocator(CommandQueueType queueType, bool isBundle)
+		: m_queueType(queueType)
+		, m_isBundle(isBundle)
+	{
+	}
+
+	IInternalCommandAllocator *NullCommandAllocator::ToInternalCommandAllocator()
+	{
+		return this;
+	}
+
+	Result NullCommandAllocator::OpenCopyCommandBatch(ICopyCommandBatch *&outCommandBatch, bool cpuWaitable)
+	{
+		return TypedOpenCommandBatch(outCommandBatch, cpuWaitable);
+	}
+
+	Result NullCommandAllocator::OpenGraphicsCommandBatch(IGraphicsCommandBatch *&outCommandBatch, bool cpuWaitable)
+	{
+		return TypedOpenCommandBatch(outCommandBatch, cpuWaitable);
+	}
+
+	Result NullCommandAllocator::OpenComputeCommandBatch(IComputeCommandBatch *&outCommandBatch, bool cpuWaitable)
+	{
+		return TypedOpenCommandBatch(outCommandBatch, cpuWaitable);
+	}
+
+	Result NullCommandAllocator::OpenGraphicsComputeCommandBatch(IGraphicsComputeCommandBatch *&outCommandBatch, bool cpuWaitable)
+	{
+		return TypedOpenCommandBatch(outCommandBatch, cpuWaitable);
+	}
+
+	Result NullCommandAllocator::ResetCommandAllocator(bool discardResources)
+	{
+		m_numAllocatedBatches = 0;
+
+		if (discardResources)
+			m_commandBatches.Reset();
+
+		RKIT_RETURN_OK;
+	}
+
+	NullCommandAllocator::DynamicCastRef_t NullCommandAllocator::InternalDynamicCast()
+	{
+		switch (m_queueType)
+		{
+		case CommandQueueType::kGraphics:
+			return DynamicCastRef_t::CreateFrom<NullCommandAllocator, IGraphicsCommandAllocator, ICopyCommandAllocator>(this);
+		case CommandQueueType::kGraphicsCompute:
+			return DynamicCastRef_t::CreateFrom<NullCommandAllocator, IGraphicsCommandAllocator, IComputeCommandAllocator, IGraphicsComputeCommandAllocator, ICopyCommandAllocator>(this);
+		case CommandQueueType::kAsyncCompute:
+			return DynamicCastRef_t::CreateFrom<NullCommandAllocator, IComputeCommandAllocator, ICopyCommandAllocator>(this);
+		case CommandQueueType::kCopy:
+			return DynamicCastRef_t::CreateFrom<NullCommandAllocator, ICopyCommandAllocator>(this);
+		default:
+			return DynamicCastRef_t();
+		}
+	}
+
+	template<class TCommandBatchType>
+	Result NullCommandAllocator::TypedOpenCommandBatch(TCommandBatchType *&outCommandBatch, bool cpuWaitable)
+	{
+		NullCommandBatchBase *cmdBatch = nullptr;
+
+		RKIT_CHECK(OpenCommandBatch(cmdBatch, cpuWaitable));
+
+		outCommandBatch = cmdBatch;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandAllocator::OpenCommandBatch(NullCommandBatchBase *&outCommandBatch, bool cpuWaitable)
+	{
+		NullCommandBatchBase *cmdBatchPtr = nullptr;
+
+		if (m_numAllocatedBatches == m_commandBatches.Count())
+		{
+			UniquePtr<NullCommandBatchBase> cmdBatch;
+
+			RKIT_CHECK(NullCommandBatchBase::Create(cmdBatch));
+
+			cmdBatchPtr = cmdBatch.Get();
+
+			RKIT_CHECK(m_commandBatches.Append(std::move(cmdBatch)));
+		}
+		else
+			cmdBatchPtr = m_commandBatches[m_numAllocatedBatches].Get();
+
+		RKIT_CHECK(cmdBatchPtr->OpenCommandBatch(cpuWaitable));
+
+		m_numAllocatedBatches++;
+
+		outCommandBatch = cmdBatchPtr;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandAllocatorBase::Create(UniquePtr<NullCommandAllocatorBase> &outCommandAllocator, CommandQueueType queueType, bool isBundle)
+	{
+		return New<NullCommandAllocator>(outCommandAllocator, queueType, isBundle);
+	}
+} } } // rkit::render::null
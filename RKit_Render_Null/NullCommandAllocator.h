@@ -0,0 +1,13 @@
+#pragma once
+
+#include "rkit/Render/CommandQueueType.h"
+#include "rkit/Render/CommandAllocator.h"
+
+namespace rkit { namespace render { namespace null
+{
+	class NullCommandAllocatorBase : public IGraphicsComputeCommandAllocator, public IInternalCommandAllocator
+	{
+	public:
+		static Result Create(UniquePtr<NullCommandAllocatorBase> &outCommandAllocator, CommandQueueType queueType, bool isBundle);
+	};
+} } } // rkit::render::null
@@ -0,0 +1,246 @@
+#include "NullCommandBatch.h"
+
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/NoCopy.h"
+#include "rkit/Core/Result.h"
+#include "rkit/Core/UniquePtr.h"
+
+#include "rkit/Render/BufferImageFootprint.h"
+#include "rkit/Render/CommandEncoder.h"
+#include "rkit/Render/ImageRect.h"
+
+#include "NullBufferResource.h"
+#include "NullImageResource.h"
+
+#include <string.h>
+
+namespace rkit { namespace render { namespace null
+{
+	// Copies are performed on the CPU at the time that they are recorded, since
+	// nothing can observe the destination until the batch is waited on.
+	class NullCopyCommandEncoder final : public ICopyCommandEncoder, public NoCopy
+	{
+	public:
+		Result PipelineBarrier(const BarrierGroup &barrierGroup) override;
+		Result CopyBufferToImage(IImageResource &imageResource, const ImageRect3D &destRect,
+			IBufferResource &bufferResource, const BufferImageFootprint &bufferFootprint,
+			ImageLayout imageLayout, uint32_t mipLevel, uint32_t arrayLayer, ImagePlane plane) override;
+		Result CopyBufferToBuffer(IBufferResource &destResource, GPUMemoryOffset_t destOffset,
+			IBufferResource &srcResource, GPUMemoryOffset_t srcOffset, GPUMemorySize_t size) override;
+	};
+
+	class NullGraphicsCommandEncoder final : public IGraphicsCommandEncoder, public NoCopy
+	{
+	public:
+		Result WaitForSwapChainAcquire(ISwapChainSyncPoint &syncPoint, const rkit::EnumMask<rkit::render::PipelineStage> &subsequentStages) override;
+		Result SignalSwapChainPresentReady(ISwapChainSyncPoint &syncPoint, const rkit::EnumMask<rkit::render::PipelineStage> &priorStages) override;
+		Result PipelineBarrier(const BarrierGroup &barrierGroup) override;
+		Result ClearTargets(const Span<const RenderTargetClear> &renderTargetClears, const DepthStencilTargetClear *depthStencilClear, const Span<const ImageRect2D> &rects) override;
+	};
+
+	class NullComputeCommandEncoder final : public IComputeCommandEncoder, public NoCopy
+	{
+	};
+
+	class NullCommandBatch final : public NullCommandBatchBase
+	{
+	public:
+		Result OpenCommandBatch(bool cpuWaitable) override;
+
+		Result Submit() override;
+		Result WaitForCompletion(ICPUFenceWaiter &fenceWaiter) override;
+		Result CloseBatch() override;
+
+		Result OpenCopyCommandEncoder(ICopyCommandEncoder *&outCopyCommandEncoder) override;
+		Result OpenComputeCommandEncoder(IComputeCommandEncoder *&outComputeCommandEncoder) override;
+		Result OpenGraphicsCommandEncoder(IGraphicsCommandEncoder *&outGraphicsCommandEncoder, IRenderPassInstance &rpi) override;
+
+		Result AddWaitForFence(IBinaryGPUWaitableFence &fence, const PipelineStageMask_t &subsequentStageMask) override;
+		Result AddSignalFence(IBinaryGPUWaitableFence &fence) override;
+
+	private:
+		NullCopyCommandEncoder m_copyCommandEncoder;
+		NullGraphicsCommandEncoder m_graphicsCommandEncoder;
+		NullComputeCommandEncoder m_computeCommandEncoder;
+
+		bool m_isCPUWaitable = false;
+	};
+
+	Result NullCopyCommandEncoder::PipelineBarrier(const BarrierGroup &barrierGroup)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCopyCommandEncoder::CopyBufferToImage(IImageResource &imageResource, const ImageRect3D &destRect,
+		IBufferResource &bufferResource, const BufferImageFootprint &bufferFootprint,
+		ImageLayout imageLayout, uint32_t mipLevel, uint32_t arrayLayer, ImagePlane plane)
+	{
+		const NullImage &image = static_cast<const NullImage &>(imageResource);
+		const NullBuffer &buffer = static_cast<const NullBuffer &>(bufferResource);
+
+		const NullImageLayout &layout = image.GetLayout();
+
+		uint8_t *imageMem = image.GetCPUMemory();
+		const uint8_t *bufferMem = buffer.GetCPUMemory();
+
+		// Swap chain images have no backing memory
+		if (!imageMem || !bufferMem)
+			RKIT_RETURN_OK;
+
+		GPUMemoryOffset_t subresourceOffset = 0;
+		if (!layout.GetSubresourceOffset(subresourceOffset, mipLevel, arrayLayer))
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		if (destRect.m_x < 0 || destRect.m_y < 0 || destRect.m_z < 0)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		const uint32_t mipWidth = layout.GetMipWidth(mipLevel);
+		const uint32_t mipHeight = layout.GetMipHeight(mipLevel);
+		const uint32_t mipDepth = layout.GetMipDepth(mipLevel);
+
+		const uint32_t destX = static_cast<uint32_t>(destRect.m_x);
+		const uint32_t destY = static_cast<uint32_t>(destRect.m_y);
+		const uint32_t destZ = static_cast<uint32_t>(destRect.m_z);
+
+		if (destX > mipWidth || mipWidth - destX < destRect.m_width
+			|| destY > mipHeight || mipHeight - destY < destRect.m_height
+			|| destZ > mipDepth || mipDepth - destZ < destRect.m_depth)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		const GPUMemorySize_t bytesPerPixel = layout.GetBytesPerPixel();
+		const GPUMemorySize_t destRowPitch = bytesPerPixel * mipWidth;
+		const GPUMemorySize_t destSlicePitch = destRowPitch * mipHeight;
+		const GPUMemorySize_t srcSlicePitch = static_cast<GPUMemorySize_t>(bufferFootprint.m_rowPitch) * bufferFootprint.m_height;
+		const size_t rowSize = static_cast<size_t>(bytesPerPixel * destRect.m_width);
+
+		if (rowSize > bufferFootprint.m_rowPitch)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		if (destRect.m_depth > 0 && destRect.m_height > 0)
+		{
+			const GPUMemorySize_t lastRowEnd = bufferFootprint.m_bufferOffset
+				+ srcSlicePitch * (destRect.m_depth - 1)
+				+ static_cast<GPUMemorySize_t>(bufferFootprint.m_rowPitch) * (destRect.m_height - 1)
+				+ rowSize;
+
+			if (lastRowEnd > buffer.GetSize())
+				RKIT_THROW(ResultCode::kInvalidParameter);
+		}
+
+		for (uint32_t z = 0; z < destRect.m_depth; z++)
+		{
+			for (uint32_t y = 0; y < destRect.m_height; y++)
+			{
+				const GPUMemoryOffset_t srcOffset = bufferFootprint.m_bufferOffset + srcSlicePitch * z + static_cast<GPUMemorySize_t>(bufferFootprint.m_rowPitch) * y;
+				const GPUMemoryOffset_t destOffset = subresourceOffset + destSlicePitch * (destZ + z) + destRowPitch * (destY + y) + bytesPerPixel * destX;
+
+				memcpy(imageMem + destOffset, bufferMem + srcOffset, rowSize);
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCopyCommandEncoder::CopyBufferToBuffer(IBufferResource &destResource, GPUMemoryOffset_t destOffset,
+		IBufferResource &srcResource, GPUMemoryOffset_t srcOffset, GPUMemorySize_t size)
+	{
+		RKIT_ASSERT(size != 0);
+
+		const NullBuffer &destBuffer = static_cast<const NullBuffer &>(destResource);
+		const NullBuffer &srcBuffer = static_cast<const NullBuffer &>(srcResource);
+
+		if (destOffset > destBuffer.GetSize() || destBuffer.GetSize() - destOffset < size)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		if (srcOffset > srcBuffer.GetSize() || srcBuffer.GetSize() - srcOffset < size)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		uint8_t *destMem = destBuffer.GetCPUMemory();
+		const uint8_t *srcMem = srcBuffer.GetCPUMemory();
+
+		memmove(destMem + destOffset, srcMem + srcOffset, static_cast<size_t>(size));
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullGraphicsCommandEncoder::WaitForSwapChainAcquire(ISwapChainSyncPoint &syncPoint, const rkit::EnumMask<rkit::render::PipelineStage> &subsequentStages)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullGraphicsCommandEncoder::SignalSwapChainPresentReady(ISwapChainSyncPoint &syncPoint, const rkit::EnumMask<rkit::render::PipelineStage> &priorStages)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullGraphicsCommandEncoder::PipelineBarrier(const BarrierGroup &barrierGroup)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullGraphicsCommandEncoder::ClearTargets(const Span<const RenderTargetClear> &renderTargetClears, const DepthStencilTargetClear *depthStencilClear, const Span<const ImageRect2D> &rects)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandBatch::OpenCommandBatch(bool cpuWaitable)
+	{
+		m_isCPUWaitable = cpuWaitable;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandBatch::Submit()
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandBatch::WaitForCompletion(ICPUFenceWaiter &fenceWaiter)
+	{
+		if (!m_isCPUWaitable)
+			RKIT_THROW(ResultCode::kInternalError);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandBatch::CloseBatch()
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandBatch::OpenCopyCommandEncoder(ICopyCommandEncoder *&outCopyCommandEncoder)
+	{
+		outCopyCommandEncoder = &m_copyCommandEncoder;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandBatch::OpenComputeCommandEncoder(IComputeCommandEncoder *&outComputeCommandEncoder)
+	{
+		outComputeCommandEncoder = &m_computeCommandEncoder;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandBatch::OpenGraphicsCommandEncoder(IGraphicsCommandEncoder *&outGraphicsCommandEncoder, IRenderPassInstance &rpi)
+	{
+		outGraphicsCommandEncoder = &m_graphicsCommandEncoder;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandBatch::AddWaitForFence(IBinaryGPUWaitableFence &fence, const PipelineStageMask_t &subsequentStageMask)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandBatch::AddSignalFence(IBinaryGPUWaitableFence &fence)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCommandBatchBase::Create(UniquePtr<NullCommandBatchBase> &cmdBatch)
+	{
+		return New<NullCommandBatch>(cmdBatch);
+	}
+} } } // rkit::render::null
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "rkit/Render/CommandBatch.h"
+
+namespace rkit
+{
+	template<class T>
+	class UniquePtr;
+}
+
+namespace rkit { namespace render { namespace null
+{
+	class NullCommandBatchBase : public IGraphicsComputeCommandBatch
+	{
+	public:
+		virtual ~NullCommandBatchBase() {}
+
+		virtual Result OpenCommandBatch(bool cpuWaitable) = 0;
+
+		static Result Create(UniquePtr<NullCommandBatchBase> &cmdBatch);
+	};
+} } } // rkit::render::null
@@ -0,0 +1,328 @@
+#include "NullDevice.h"
+
+#include "NullBufferResource.h"
+#include "NullFence.h"
+#include "NullImageResource.h"
+#include "NullMemoryHeap.h"
+#include "NullPipelineLibraryLoader.h"
+#include "NullQueue.h"
+#include "NullRenderPass.h"
+#include "NullSwapChain.h"
+
+#include "rkit/Render/DeviceCaps.h"
+
+#include "rkit/Data/RenderDataHandler.h"
+
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/Result.h"
+#include "rkit/Core/Span.h"
+#include "rkit/Core/StaticArray.h"
+#include "rkit/Core/Stream.h"
+#include "rkit/Core/UniquePtr.h"
+#include "rkit/Core/Vector.h"
+
+namespace rkit { namespace render { namespace null
+{
+	class NullDevice final : public NullDeviceBase
+	{
+	public:
+		NullDevice(const RenderDeviceCaps &caps, const RenderDeviceRequirements &reqs);
+
+		CallbackSpan<ICopyCommandQueue *, const void *> GetCopyQueues() const override;
+		CallbackSpan<IComputeCommandQueue *, const void *> GetComputeQueues() const override;
+		CallbackSpan<IGraphicsCommandQueue *, const void *> GetGraphicsQueues() const override;
+		CallbackSpan<IGraphicsComputeCommandQueue *, const void *> GetGraphicsComputeQueues() const override;
+
+		Result CreateBinaryCPUWaitableFence(UniquePtr<IBinaryCPUWaitableFence> &outFence, bool startSignaled) override;
+		Result CreateBinaryGPUWaitableFence(UniquePtr<IBinaryGPUWaitableFence> &outFence) override;
+		Result CreateSwapChainSyncPoint(UniquePtr<ISwapChainSyncPoint> &outSyncPoint) override;
+
+		Result CreateRenderPassInstance(UniquePtr<IRenderPassInstance> &outInstance, const RenderPassRef_t &renderPass, const RenderPassResources &resources) override;
+
+		Result CreateCPUFenceWaiter(UniquePtr<ICPUFenceWaiter> &outFenceWaiter) override;
+
+		Result ResetBinaryFences(const ISpan<IBinaryCPUWaitableFence *> &fences) override;
+		Result WaitForDeviceIdle() override;
+
+		const IRenderDeviceCaps &GetCaps() const override;
+		const IRenderDeviceRequirements &GetRequirements() const override;
+
+		Result CreatePipelineLibraryLoader(UniquePtr<IPipelineLibraryLoader> &outLoader, UniquePtr<IPipelineLibraryConfigValidator> &&validator,
+			UniquePtr<data::IRenderDataPackage> &&package, UniquePtr<ISeekableReadStream> &&packageStream, FilePos_t packageBinaryContentStart) override;
+
+		Result CreateSwapChainPrototype(UniquePtr<ISwapChainPrototype> &outSwapChainPrototype, IDisplay &display) override;
+		Result CreateSwapChain(UniquePtr<ISwapChain> &outSwapChain, UniquePtr<ISwapChainPrototype> &&prototype, uint8_t numImages, RenderTargetFormat fmt, SwapChainWriteBehavior writeBehavior, IBaseCommandQueue &commandQueue) override;
+
+		Result CreateBufferPrototype(UniquePtr<IBufferPrototype> &outBufferPrototype, const BufferSpec &bufferSpec,
+			const BufferResourceSpec &resourceSpec, const Span<IBaseCommandQueue *const> &restrictedQueues) override;
+		Result CreateBuffer(UniquePtr<IBufferResource> &outBuffer, UniquePtr<IBufferPrototype> &&bufferPrototype,
+			const MemoryRegion &memRegion, const Span<const uint8_t> &initialData) override;
+
+		Result CreateImagePrototype(UniquePtr<IImagePrototype> &outImagePrototype, const ImageSpec &imageSpec,
+			const ImageResourceSpec &resourceSpec, const Span<IBaseCommandQueue *const> &restrictedQueues) override;
+		Result CreateImage(UniquePtr<IImageResource> &outImage, UniquePtr<IImagePrototype> &&imagePrototype,
+			const MemoryRegion &memRegion, const Span<const uint8_t> &initialData) override;
+
+		Result CreateMemoryHeap(UniquePtr<IMemoryHeap> &outHeap, const HeapKey &heapKey, GPUMemorySize_t size) override;
+
+		bool SupportsInitialTextureData() const override;
+		bool SupportsInitialBufferData() const override;
+		uint32_t GetUploadHeapAlignment() const override;
+
+		Result CreateQueues(CommandQueueType queueType, size_t numQueues);
+
+	private:
+		struct QueueFamily
+		{
+			Vector<UniquePtr<NullQueueBase>> m_queues;
+		};
+
+		typedef const void *ConstVoidPtr_t;
+
+		template<class T>
+		static CallbackSpan<T *, const void *> CreateCallbackSpanForQueueFamily(const QueueFamily &queueFamily);
+
+		template<class T>
+		static T *QueueFamilySpanGetElement(const ConstVoidPtr_t &queueFamilyPtr, size_t index);
+
+		static const size_t kNumQueues = static_cast<size_t>(CommandQueueType::kCount);
+
+		// Matches the alignment that CPU copies are most efficient at
+		static const uint32_t kUploadHeapAlignment = 16;
+
+		RenderDeviceCaps m_caps;
+		RenderDeviceRequirements m_reqs;
+
+		StaticArray<QueueFamily, kNumQueues> m_queueFamilies;
+	};
+
+	NullDevice::NullDevice(const RenderDeviceCaps &caps, const RenderDeviceRequirements &reqs)
+		: m_caps(caps)
+		, m_reqs(reqs)
+	{
+	}
+
+	template<class T>
+	CallbackSpan<T *, const void *> NullDevice::CreateCallbackSpanForQueueFamily(const QueueFamily &queueFamily)
+	{
+		return CallbackSpan<T *, const void *>(QueueFamilySpanGetElement<T>, &queueFamily, queueFamily.m_queues.Count());
+	}
+
+	template<class T>
+	T *NullDevice::QueueFamilySpanGetElement(const ConstVoidPtr_t &queueFamilyPtr, size_t index)
+	{
+		const QueueFamily *queueFamily = static_cast<const QueueFamily *>(queueFamilyPtr);
+		return queueFamily->m_queues[index].Get();
+	}
+
+	CallbackSpan<ICopyCommandQueue *, const void *> NullDevice::GetCopyQueues() const
+	{
+		return CreateCallbackSpanForQueueFamily<ICopyCommandQueue>(m_queueFamilies[static_cast<size_t>(CommandQueueType::kCopy)]);
+	}
+
+	CallbackSpan<IComputeCommandQueue *, const void *> NullDevice::GetComputeQueues() const
+	{
+		return CreateCallbackSpanForQueueFamily<IComputeCommandQueue>(m_queueFamilies[static_cast<size_t>(CommandQueueType::kAsyncCompute)]);
+	}
+
+	CallbackSpan<IGraphicsCommandQueue *, const void *> NullDevice::GetGraphicsQueues() const
+	{
+		return CreateCallbackSpanForQueueFamily<IGraphicsCommandQueue>(m_queueFamilies[static_cast<size_t>(CommandQueueType::kGraphics)]);
+	}
+
+	CallbackSpan<IGraphicsComputeCommandQueue *, const void *> NullDevice::GetGraphicsComputeQueues() const
+	{
+		return CreateCallbackSpanForQueueFamily<IGraphicsComputeCommandQueue>(m_queueFamilies[static_cast<size_t>(CommandQueueType::kGraphicsCompute)]);
+	}
+
+	Result NullDevice::CreateBinaryCPUWaitableFence(UniquePtr<IBinaryCPUWaitableFence> &outFence, bool startSignaled)
+	{
+		return New<NullBinaryCPUWaitableFence>(outFence);
+	}
+
+	Result NullDevice::CreateBinaryGPUWaitableFence(UniquePtr<IBinaryGPUWaitableFence> &outFence)
+	{
+		return New<NullBinaryGPUWaitableFence>(outFence);
+	}
+
+	Result NullDevice::CreateSwapChainSyncPoint(UniquePtr<ISwapChainSyncPoint> &outSyncPoint)
+	{
+		return New<NullSwapChainSyncPoint>(outSyncPoint);
+	}
+
+	Result NullDevice::CreateRenderPassInstance(UniquePtr<IRenderPassInstance> &outInstance, const RenderPassRef_t &renderPass, const RenderPassResources &resources)
+	{
+		return New<NullRenderPassInstance>(outInstance);
+	}
+
+	Result NullDevice::CreateCPUFenceWaiter(UniquePtr<ICPUFenceWaiter> &outFenceWaiter)
+	{
+		return New<NullCPUFenceWaiter>(outFenceWaiter);
+	}
+
+	Result NullDevice::ResetBinaryFences(const ISpan<IBinaryCPUWaitableFence *> &fences)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullDevice::WaitForDeviceIdle()
+	{
+		RKIT_RETURN_OK;
+	}
+
+	const IRenderDeviceCaps &NullDevice::GetCaps() const
+	{
+		return m_caps;
+	}
+
+	const IRenderDeviceRequirements &NullDevice::GetRequirements() const
+	{
+		return m_reqs;
+	}
+
+	Result NullDevice::CreatePipelineLibraryLoader(UniquePtr<IPipelineLibraryLoader> &outLoader, UniquePtr<IPipelineLibraryConfigValidator> &&validator,
+		UniquePtr<data::IRenderDataPackage> &&package, UniquePtr<ISeekableReadStream> &&packageStream, FilePos_t packageBinaryContentStart)
+	{
+		UniquePtr<NullPipelineLibraryLoaderBase> loader;
+		RKIT_CHECK(NullPipelineLibraryLoaderBase::Create(loader, std::move(validator), std::move(package), std::move(packageStream), packageBinaryContentStart));
+
+		outLoader = std::move(loader);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullDevice::CreateSwapChainPrototype(UniquePtr<ISwapChainPrototype> &outSwapChainPrototype, IDisplay &display)
+	{
+		return New<NullSwapChainPrototype>(outSwapChainPrototype);
+	}
+
+	Result NullDevice::CreateSwapChain(UniquePtr<ISwapChain> &outSwapChain, UniquePtr<ISwapChainPrototype> &&prototype, uint8_t numImages, RenderTargetFormat fmt, SwapChainWriteBehavior writeBehavior, IBaseCommandQueue &commandQueue)
+	{
+		UniquePtr<NullSwapChainBase> swapChain;
+		RKIT_CHECK(NullSwapChainBase::Create(swapChain, numImages));
+
+		prototype.Reset();
+
+		outSwapChain = std::move(swapChain);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullDevice::CreateBufferPrototype(UniquePtr<IBufferPrototype> &outBufferPrototype, const BufferSpec &bufferSpec,
+		const BufferResourceSpec &resourceSpec, const Span<IBaseCommandQueue *const> &restrictedQueues)
+	{
+		UniquePtr<NullBufferPrototype> prototype;
+		RKIT_CHECK(NullBufferPrototype::Create(prototype, bufferSpec, resourceSpec));
+
+		outBufferPrototype = std::move(prototype);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullDevice::CreateBuffer(UniquePtr<IBufferResource> &outBuffer, UniquePtr<IBufferPrototype> &&bufferPrototypeRef,
+		const MemoryRegion &memRegion, const Span<const uint8_t> &initialData)
+	{
+		RKIT_ASSERT(initialData.Count() == 0);
+
+		UniquePtr<IBufferPrototype> bufferPrototype = std::move(bufferPrototypeRef);
+
+		RKIT_ASSERT(bufferPrototype.IsValid());
+		RKIT_ASSERT(memRegion.GetAllocation() != nullptr);
+
+		const NullBufferPrototype &prototype = *static_cast<const NullBufferPrototype *>(bufferPrototype.Get());
+
+		if (memRegion.GetSize() < prototype.GetSize())
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		return New<NullBuffer>(outBuffer, memRegion.GetPosition(), prototype.GetSize());
+	}
+
+	Result NullDevice::CreateImagePrototype(UniquePtr<IImagePrototype> &outImagePrototype, const ImageSpec &imageSpec,
+		const ImageResourceSpec &resourceSpec, const Span<IBaseCommandQueue *const> &restrictedQueues)
+	{
+		UniquePtr<NullImagePrototype> prototype;
+		RKIT_CHECK(NullImagePrototype::Create(prototype, imageSpec, resourceSpec));
+
+		outImagePrototype = std::move(prototype);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullDevice::CreateImage(UniquePtr<IImageResource> &outImage, UniquePtr<IImagePrototype> &&imagePrototypeRef,
+		const MemoryRegion &memRegion, const Span<const uint8_t> &initialData)
+	{
+		RKIT_ASSERT(initialData.Count() == 0);
+
+		UniquePtr<IImagePrototype> imagePrototype = std::move(imagePrototypeRef);
+
+		RKIT_ASSERT(imagePrototype.IsValid());
+		RKIT_ASSERT(memRegion.GetAllocation() != nullptr);
+
+		const NullImagePrototype &prototype = *static_cast<const NullImagePrototype *>(imagePrototype.Get());
+
+		if (memRegion.GetSize() < prototype.GetLayout().GetTotalSize())
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		return New<NullImage>(outImage, prototype.GetLayout(), memRegion.GetPosition());
+	}
+
+	Result NullDevice::CreateMemoryHeap(UniquePtr<IMemoryHeap> &outHeap, const HeapKey &heapKey, GPUMemorySize_t size)
+	{
+		UniquePtr<NullMemoryHeap> heap;
+		RKIT_CHECK(New<NullMemoryHeap>(heap, HeapKeyIsCPUAccessible(heapKey)));
+
+		RKIT_CHECK(heap->Initialize(size));
+
+		outHeap = std::move(heap);
+
+		RKIT_RETURN_OK;
+	}
+
+	bool NullDevice::SupportsInitialTextureData() const
+	{
+		return false;
+	}
+
+	bool NullDevice::SupportsInitialBufferData() const
+	{
+		return false;
+	}
+
+	uint32_t NullDevice::GetUploadHeapAlignment() const
+	{
+		return kUploadHeapAlignment;
+	}
+
+	Result NullDevice::CreateQueues(CommandQueueType queueType, size_t numQueues)
+	{
+		QueueFamily &queueFamily = m_queueFamilies[static_cast<size_t>(queueType)];
+
+		RKIT_CHECK(queueFamily.m_queues.Resize(numQueues));
+
+		for (size_t i = 0; i < numQueues; i++)
+		{
+			RKIT_CHECK(NullQueueBase::Create(queueFamily.m_queues[i], queueType));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullDeviceBase::CreateDevice(UniquePtr<IRenderDevice> &outDevice, const size_t (&queueCounts)[static_cast<size_t>(CommandQueueType::kCount)],
+		const RenderDeviceCaps &caps, const RenderDeviceRequirements &reqs)
+	{
+		UniquePtr<NullDevice> device;
+		RKIT_CHECK(New<NullDevice>(device, caps, reqs));
+
+		for (size_t i = 0; i < static_cast<size_t>(CommandQueueType::kCount); i++)
+		{
+			if (queueCounts[i] > 0)
+			{
+				RKIT_CHECK(device->CreateQueues(static_cast<CommandQueueType>(i), queueCounts[i]));
+			}
+		}
+
+		outDevice = std::move(device);
+
+		RKIT_RETURN_OK;
+	}
+} } } // rkit::render::null
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "rkit/Render/RenderDevice.h"
+
+namespace rkit
+{
+	template<class T>
+	class UniquePtr;
+}
+
+namespace rkit { namespace render
+{
+	class RenderDeviceCaps;
+	class RenderDeviceRequirements;
+} } // rkit::render
+
+namespace rkit { namespace render { namespace null
+{
+	// Render device that executes nothing on a GPU.  Memory heaps are backed by CPU
+	// memory, copy commands run on the CPU at record time, and every fence is
+	// signaled as soon as it is submitted.
+	class NullDeviceBase : public IRenderDevice
+	{
+	public:
+		static const size_t kMaxQueuesPerType = 4;
+
+		static Result CreateDevice(UniquePtr<IRenderDevice> &outDevice, const size_t (&queueCounts)[static_cast<size_t>(CommandQueueType::kCount)],
+			const RenderDeviceCaps &caps, const RenderDeviceRequirements &reqs);
+	};
+} } } // rkit::render::null
@@ -0,0 +1,55 @@
+#include "NullFence.h"
+
+#include "rkit/Core/Result.h"
+#include "rkit/Core/Span.h"
+
+namespace rkit { namespace render { namespace null
+{
+	NullTimelineFence::NullTimelineFence(TimelinePoint_t initialValue)
+		: m_value(initialValue)
+	{
+	}
+
+	Result NullTimelineFence::SetValue(TimelinePoint_t value)
+	{
+		m_value = value;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullTimelineFence::GetCurrentValue(TimelinePoint_t &outValue) const
+	{
+		outValue = m_value;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullBinaryCPUWaitableFence::ResetFence()
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCPUFenceWaiter::WaitForFences(const Span<const Pair<ICPUVisibleTimelineFence *, TimelinePoint_t>> &timelineWaits, bool waitAll)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCPUFenceWaiter::WaitForFencesTimed(bool &outTimeout, const Span<const Pair<ICPUVisibleTimelineFence *, TimelinePoint_t>> &timelineWaits, uint64_t timeoutMSec, bool waitAll)
+	{
+		outTimeout = false;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCPUFenceWaiter::WaitForBinaryFences(const Span<IBinaryCPUWaitableFence *> &binaryWaits, bool waitAll)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullCPUFenceWaiter::WaitForBinaryFencesTimed(bool &outTimeout, const Span<IBinaryCPUWaitableFence *> &binaryWaits, uint64_t timeoutMSec, bool waitAll)
+	{
+		outTimeout = false;
+
+		RKIT_RETURN_OK;
+	}
+} } } // rkit::render::null
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "rkit/Render/Fence.h"
+
+namespace rkit
+{
+	template<class T>
+	class UniquePtr;
+}
+
+namespace rkit { namespace render { namespace null
+{
+	class NullTimelineFence final : public ICPUVisibleTimelineFence
+	{
+	public:
+		explicit NullTimelineFence(TimelinePoint_t initialValue);
+
+		Result SetValue(TimelinePoint_t value) override;
+		Result GetCurrentValue(TimelinePoint_t &outValue) const override;
+
+	private:
+		TimelinePoint_t m_value;
+	};
+
+	class NullBinaryCPUWaitableFence final : public IBinaryCPUWaitableFence
+	{
+	public:
+		Result ResetFence() override;
+	};
+
+	class NullBinaryGPUWaitableFence final : public IBinaryGPUWaitableFence
+	{
+	};
+
+	// Work on the null device completes as soon as it is submitted, so every wait
+	// is satisfied immediately.
+	class NullCPUFenceWaiter final : public ICPUFenceWaiter
+	{
+	public:
+		Result WaitForFences(const Span<const Pair<ICPUVisibleTimelineFence *, TimelinePoint_t>> &timelineWaits, bool waitAll) override;
+		Result WaitForFencesTimed(bool &outTimeout, const Span<const Pair<ICPUVisibleTimelineFence *, TimelinePoint_t>> &timelineWaits, uint64_t timeoutMSec, bool waitAll) override;
+		Result WaitForBinaryFences(const Span<IBinaryCPUWaitableFence *> &binaryWaits, bool waitAll) override;
+		Result WaitForBinaryFencesTimed(bool &outTimeout, const Span<IBinaryCPUWaitableFence *> &binaryWaits, uint64_t timeoutMSec, bool waitAll) override;
+	};
+} } } // rkit::render::null
@@ -0,0 +1,115 @@
+#include "NullImageResource.h"
+
+#include "rkit/Core/Algorithm.h"
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/UniquePtr.h"
+
+#include "NullMemoryHeap.h"
+
+namespace rkit { namespace render { namespace null {
+	static const GPUMemoryAlignment_t kImageAlignment = 256;
+
+	NullImageLayout::NullImageLayout()
+		: m_bytesPerPixel(0)
+		, m_numLayers(0)
+		, m_layerSize(0)
+	{
+	}
+
+	NullImageLayout::NullImageLayout(const ImageSpec &imageSpec)
+		: m_spec(imageSpec)
+		, m_bytesPerPixel(GetBytesPerPixel(imageSpec.m_format))
+		, m_numLayers(imageSpec.m_arrayLayers * (imageSpec.m_cubeMap ? 6 : 1))
+		, m_layerSize(0)
+	{
+		for (uint32_t mipLevel = 0; mipLevel < m_spec.m_mipLevels; mipLevel++)
+			m_layerSize += GetMipSize(mipLevel);
+	}
+
+	uint32_t NullImageLayout::GetMipWidth(uint32_t mipLevel) const
+	{
+		return rkit::Max<uint32_t>(m_spec.m_width >> mipLevel, 1);
+	}
+
+	uint32_t NullImageLayout::GetMipHeight(uint32_t mipLevel) const
+	{
+		return rkit::Max<uint32_t>(m_spec.m_height >> mipLevel, 1);
+	}
+
+	uint32_t NullImageLayout::GetMipDepth(uint32_t mipLevel) const
+	{
+		return rkit::Max<uint32_t>(m_spec.m_depth >> mipLevel, 1);
+	}
+
+	bool NullImageLayout::GetSubresourceOffset(GPUMemoryOffset_t &outOffset, uint32_t mipLevel, uint32_t arrayLayer) const
+	{
+		if (mipLevel >= m_spec.m_mipLevels || arrayLayer >= m_numLayers)
+			return false;
+
+		GPUMemoryOffset_t offset = m_layerSize * arrayLayer;
+		for (uint32_t i = 0; i < mipLevel; i++)
+			offset += GetMipSize(i);
+
+		outOffset = offset;
+		return true;
+	}
+
+	uint32_t NullImageLayout::GetBytesPerPixel(TextureFormat format)
+	{
+		switch (format)
+		{
+		case TextureFormat::RGBA_UNorm8:
+		case TextureFormat::RGBA_UNorm8_sRGB:
+		case TextureFormat::BGRA_UNorm8:
+		case TextureFormat::BGRA_UNorm8_sRGB:
+			return 4;
+		case TextureFormat::RG_UNorm8:
+		case TextureFormat::RG_UNorm8_sRGB:
+			return 2;
+		case TextureFormat::R_UNorm8:
+		case TextureFormat::R_UNorm8_sRGB:
+			return 1;
+		default:
+			return 0;
+		}
+	}
+
+	GPUMemorySize_t NullImageLayout::GetMipSize(uint32_t mipLevel) const
+	{
+		return static_cast<GPUMemorySize_t>(GetMipWidth(mipLevel)) * GetMipHeight(mipLevel) * GetMipDepth(mipLevel) * m_bytesPerPixel;
+	}
+
+	NullImage::NullImage(const NullImageLayout &layout, const MemoryAddress &baseAddress)
+		: m_layout(layout)
+		, m_baseAddress(baseAddress)
+	{
+	}
+
+	uint8_t *NullImage::GetCPUMemory() const
+	{
+		return ResolveCPUMemory(m_baseAddress);
+	}
+
+	NullImagePrototype::NullImagePrototype(const ImageSpec &imageSpec)
+		: m_layout(imageSpec)
+	{
+	}
+
+	MemoryRequirementsView NullImagePrototype::GetMemoryRequirements() const
+	{
+		return ExportMemoryRequirements(m_layout.GetTotalSize(), kImageAlignment);
+	}
+
+	Result NullImagePrototype::Create(UniquePtr<NullImagePrototype> &outImagePrototype, const ImageSpec &imageSpec, const ImageResourceSpec &resourceSpec)
+	{
+		if (NullImageLayout::GetBytesPerPixel(imageSpec.m_format) == 0 || imageSpec.m_mipLevels == 0 || imageSpec.m_arrayLayers == 0)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		return New<NullImagePrototype>(outImagePrototype, imageSpec);
+	}
+
+	NullRenderTargetView::NullRenderTargetView(IImageResource &image)
+		: m_image(image)
+	{
+	}
+} } }
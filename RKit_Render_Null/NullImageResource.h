@@ -0,0 +1,110 @@
+#pragma once
+
+#include "rkit/Render/ImageResource.h"
+#include "rkit/Render/ImageSpec.h"
+#include "rkit/Render/Memory.h"
+#include "rkit/Render/RenderTargetView.h"
+
+#include <stdint.h>
+
+namespace rkit
+{
+	template<class T>
+	class UniquePtr;
+}
+
+namespace rkit { namespace render { namespace null {
+	// Images are stored linearly, one array layer after another, with each layer
+	// containing its mip levels in order and rows tightly packed.
+	class NullImageLayout
+	{
+	public:
+		NullImageLayout();
+		explicit NullImageLayout(const ImageSpec &imageSpec);
+
+		GPUMemorySize_t GetTotalSize() const;
+
+		uint32_t GetBytesPerPixel() const;
+		uint32_t GetMipWidth(uint32_t mipLevel) const;
+		uint32_t GetMipHeight(uint32_t mipLevel) const;
+		uint32_t GetMipDepth(uint32_t mipLevel) const;
+
+		bool GetSubresourceOffset(GPUMemoryOffset_t &outOffset, uint32_t mipLevel, uint32_t arrayLayer) const;
+
+		static uint32_t GetBytesPerPixel(TextureFormat format);
+
+	private:
+		GPUMemorySize_t GetMipSize(uint32_t mipLevel) const;
+
+		ImageSpec m_spec;
+		uint32_t m_bytesPerPixel;
+		uint32_t m_numLayers;
+		GPUMemorySize_t m_layerSize;
+	};
+
+	class NullImage final : public IImageResource
+	{
+	public:
+		NullImage(const NullImageLayout &layout, const MemoryAddress &baseAddress);
+
+		const NullImageLayout &GetLayout() const;
+		uint8_t *GetCPUMemory() const;
+
+	private:
+		NullImageLayout m_layout;
+		MemoryAddress m_baseAddress;
+	};
+
+	class NullImagePrototype final : public IImagePrototype
+	{
+	public:
+		explicit NullImagePrototype(const ImageSpec &imageSpec);
+
+		MemoryRequirementsView GetMemoryRequirements() const override;
+
+		const NullImageLayout &GetLayout() const;
+
+		static Result Create(UniquePtr<NullImagePrototype> &outImagePrototype, const ImageSpec &imageSpec, const ImageResourceSpec &resourceSpec);
+
+	private:
+		NullImageLayout m_layout;
+	};
+
+	class NullRenderTargetView final : public IRenderTargetView
+	{
+	public:
+		explicit NullRenderTargetView(IImageResource &image);
+
+		IImageResource &GetImage() const;
+
+	private:
+		IImageResource &m_image;
+	};
+} } }
+
+namespace rkit { namespace render { namespace null {
+	inline GPUMemorySize_t NullImageLayout::GetTotalSize() const
+	{
+		return m_layerSize * m_numLayers;
+	}
+
+	inline uint32_t NullImageLayout::GetBytesPerPixel() const
+	{
+		return m_bytesPerPixel;
+	}
+
+	inline const NullImageLayout &NullImage::GetLayout() const
+	{
+		return m_layout;
+	}
+
+	inline const NullImageLayout &NullImagePrototype::GetLayout() const
+	{
+		return m_layout;
+	}
+
+	inline IImageResource &NullRenderTargetView::GetImage() const
+	{
+		return m_image;
+	}
+} } }
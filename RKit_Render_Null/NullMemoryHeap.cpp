@@ -0,0 +1,66 @@
+#include "NullMemoryHeap.h"
+
+#include "rkit/Render/HeapKey.h"
+#include "rkit/Render/HeapSpec.h"
+
+#include "rkit/Core/Optional.h"
+
+#include <limits>
+
+namespace rkit { namespace render { namespace null {
+	namespace NullMemoryRequirementsFuncs
+	{
+		rkit::Optional<HeapKey> HeapKeyFilter(const void *userdata, const HeapSpec &heapSpec)
+		{
+			// All heaps are system memory, so any heap spec can be satisfied
+			return HeapKey(heapSpec.m_cpuAccessible ? 1u : 0u);
+		}
+	}
+
+	NullMemoryHeap::NullMemoryHeap(bool cpuAccessible)
+		: m_cpuAccessible(cpuAccessible)
+	{
+	}
+
+	Result NullMemoryHeap::Initialize(GPUMemorySize_t size)
+	{
+		if (size > std::numeric_limits<size_t>::max())
+			RKIT_THROW(ResultCode::kOutOfMemory);
+
+		RKIT_CHECK(m_memory.Resize(static_cast<size_t>(size)));
+
+		RKIT_RETURN_OK;
+	}
+
+	GPUMemorySize_t NullMemoryHeap::GetSize() const
+	{
+		return m_memory.Count();
+	}
+
+	void *NullMemoryHeap::GetCPUPtr() const
+	{
+		if (!m_cpuAccessible)
+			return nullptr;
+
+		return GetMemory();
+	}
+
+	MemoryRequirementsView ExportMemoryRequirements(GPUMemorySize_t size, GPUMemoryAlignment_t alignment)
+	{
+		return MemoryRequirementsView(size, alignment, nullptr, NullMemoryRequirementsFuncs::HeapKeyFilter);
+	}
+
+	bool HeapKeyIsCPUAccessible(const HeapKey &heapKey)
+	{
+		return (heapKey.GetAsUInt64() & 1u) != 0;
+	}
+
+	uint8_t *ResolveCPUMemory(const MemoryAddress &address)
+	{
+		const NullMemoryHeap *heap = static_cast<const NullMemoryHeap *>(address.GetHeap());
+		if (!heap)
+			return nullptr;
+
+		return heap->GetMemory() + address.GetOffset();
+	}
+} } }
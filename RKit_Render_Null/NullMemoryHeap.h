@@ -0,0 +1,41 @@
+#pragma once
+
+#include "rkit/Render/Memory.h"
+#include "rkit/Render/MemoryProtos.h"
+
+#include "rkit/Core/Vector.h"
+
+#include <stdint.h>
+
+namespace rkit { namespace render { namespace null {
+	class NullMemoryHeap final : public IMemoryHeap
+	{
+	public:
+		explicit NullMemoryHeap(bool cpuAccessible);
+
+		Result Initialize(GPUMemorySize_t size);
+
+		GPUMemorySize_t GetSize() const override;
+		void *GetCPUPtr() const override;
+
+		uint8_t *GetMemory() const;
+
+	private:
+		Vector<uint8_t> m_memory;
+		bool m_cpuAccessible;
+	};
+
+	MemoryRequirementsView ExportMemoryRequirements(GPUMemorySize_t size, GPUMemoryAlignment_t alignment);
+
+	bool HeapKeyIsCPUAccessible(const HeapKey &heapKey);
+
+	// Resolves a memory address to the CPU memory backing it, or null if it isn't in a heap
+	uint8_t *ResolveCPUMemory(const MemoryAddress &address);
+} } }
+
+namespace rkit { namespace render { namespace null {
+	inline uint8_t *NullMemoryHeap::GetMemory() const
+	{
+		return const_cast<uint8_t *>(m_memory.GetBuffer());
+	}
+} } }
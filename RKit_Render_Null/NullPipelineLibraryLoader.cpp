@@ -0,0 +1,257 @@
+#include "NullPipelineLibraryLoader.h"
+
+#include "rkit/Utilities/Sha2.h"
+
+#include "rkit/Render/PipelineLibrary.h"
+#include "rkit/Render/PipelineLibraryItem.h"
+#include "rkit/Render/RenderDefs.h"
+
+#include "rkit/Data/RenderDataHandler.h"
+
+#include "rkit/Core/FourCC.h"
+#include "rkit/Core/HashTable.h"
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/Stream.h"
+#include "rkit/Core/String.h"
+#include "rkit/Core/UniquePtr.h"
+#include "rkit/Core/Vector.h"
+
+#include "NullRenderPass.h"
+
+#include <string.h>
+
+namespace rkit { namespace render { namespace null
+{
+	// The null backend has nothing to compile, so the cache only records which
+	// package it was built against.  This keeps the loader's cache flow identical
+	// to a real backend.
+	struct NullPipelineCacheHeader
+	{
+		static const uint32_t kExpectedIdentifier = RKIT_FOURCC('R', 'N', 'P', 'C');
+		static const uint16_t kExpectedVersion = 1;
+
+		uint32_t m_identifier = kExpectedIdentifier;
+		uint16_t m_version = kExpectedVersion;
+		uint16_t m_reserved = 0;
+
+		utils::Sha256DigestBytes m_packageUUID;
+	};
+
+	struct NullPipelineLibraryData : public NoCopy
+	{
+		NullPipelineLibraryData();
+		NullPipelineLibraryData(NullPipelineLibraryData &&other);
+
+		Vector<NullRenderPass> m_renderPasses;
+
+		HashMap<StringView, const RenderPassDesc *> m_nameToRenderPass;
+
+		UniquePtr<data::IRenderDataPackage> m_package;
+	};
+
+	NullPipelineLibraryData::NullPipelineLibraryData()
+	{
+	}
+
+	NullPipelineLibraryData::NullPipelineLibraryData(NullPipelineLibraryData &&other)
+		: m_renderPasses(std::move(other.m_renderPasses))
+		, m_nameToRenderPass(std::move(other.m_nameToRenderPass))
+		, m_package(std::move(other.m_package))
+	{
+	}
+
+	class NullPipelineLibrary final : public IPipelineLibrary, public IPipelineLibraryItemResolver
+	{
+	public:
+		explicit NullPipelineLibrary(NullPipelineLibraryData &&pipelineLibraryData);
+
+		RenderPassRef_t FindRenderPass(const StringSliceView &name) override;
+
+		IInternalRenderPass *ResolveCompiled(const RenderPassDesc &renderPass) const override;
+
+	private:
+		NullPipelineLibraryData m_data;
+	};
+
+	class NullPipelineLibraryLoader final : public NullPipelineLibraryLoaderBase
+	{
+	public:
+		NullPipelineLibraryLoader(UniquePtr<IPipelineLibraryConfigValidator> &&validator,
+			UniquePtr<data::IRenderDataPackage> &&package, UniquePtr<ISeekableReadStream> &&packageStream);
+
+		Result LoadObjectsFromPackage() override;
+
+		void SetMergedLibraryStream(UniquePtr<ISeekableReadStream> &&cacheReadStream, ISeekableReadWriteStream *cacheWriteStream) override;
+		Result TryOpenMergedLibrary(bool &outSucceeded) override;
+		Result LoadGraphicsPipelineFromMergedLibrary(size_t pipelineIndex, size_t permutationIndex) override;
+		void CloseMergedLibrary(bool unloadPipelines, bool unloadMergedCache) override;
+
+		Result CompileUnmergedGraphicsPipeline(size_t pipelineIndex, size_t permutationIndex) override;
+		Result AddMergedPipeline(size_t pipelineIndex, size_t permutationIndex) override;
+
+		Result SaveMergedPipeline() override;
+
+		Result GetFinishedPipeline(UniquePtr<IPipelineLibrary> &outPipelineLibrary) override;
+
+	private:
+		NullPipelineLibraryData m_data;
+
+		UniquePtr<IPipelineLibraryConfigValidator> m_validator;
+		UniquePtr<ISeekableReadStream> m_packageStream;
+
+		UniquePtr<ISeekableReadStream> m_cacheReadStream;
+		ISeekableReadWriteStream *m_cacheWriteStream = nullptr;
+
+		bool m_isFinished = false;
+	};
+
+	NullPipelineLibrary::NullPipelineLibrary(NullPipelineLibraryData &&pipelineLibraryData)
+		: m_data(static_cast<NullPipelineLibraryData &&>(pipelineLibraryData))
+	{
+	}
+
+	RenderPassRef_t NullPipelineLibrary::FindRenderPass(const StringSliceView &name)
+	{
+		HashMap<StringView, const RenderPassDesc *>::ConstIterator_t it = m_data.m_nameToRenderPass.Find(name);
+
+		if (it == m_data.m_nameToRenderPass.end())
+			return RenderPassRef_t();
+
+		return RenderPassRef_t(*this, it.Value());
+	}
+
+	IInternalRenderPass *NullPipelineLibrary::ResolveCompiled(const RenderPassDesc &renderPass) const
+	{
+		const RenderPassDesc *indexables = static_cast<const RenderPassDesc *>(m_data.m_package->GetIndexable(data::RenderRTTIIndexableStructType::RenderPassDesc)->GetElementPtr(0));
+		size_t itemIndex = static_cast<size_t>((&renderPass) - indexables);
+
+		return const_cast<NullRenderPass *>(&m_data.m_renderPasses[itemIndex]);
+	}
+
+	NullPipelineLibraryLoader::NullPipelineLibraryLoader(UniquePtr<IPipelineLibraryConfigValidator> &&validator,
+		UniquePtr<data::IRenderDataPackage> &&package, UniquePtr<ISeekableReadStream> &&packageStream)
+		: m_validator(std::move(validator))
+		, m_packageStream(std::move(packageStream))
+	{
+		m_data.m_package = std::move(package);
+	}
+
+	Result NullPipelineLibraryLoader::LoadObjectsFromPackage()
+	{
+		// Render passes
+		{
+			data::IRenderRTTIListBase *renderPasses = m_data.m_package->GetIndexable(rkit::data::RenderRTTIIndexableStructType::RenderPassDesc);
+
+			RKIT_CHECK(m_data.m_renderPasses.Resize(renderPasses->GetCount()));
+		}
+
+		// Render pass lookups
+		{
+			data::IRenderRTTIListBase *renderPassNameLookups = m_data.m_package->GetIndexable(rkit::data::RenderRTTIIndexableStructType::RenderPassNameLookup);
+
+			const size_t numRenderPassNameLookups = renderPassNameLookups->GetCount();
+
+			for (size_t i = 0; i < numRenderPassNameLookups; i++)
+			{
+				const render::RenderPassNameLookup &nameLookup = *static_cast<const render::RenderPassNameLookup *>(renderPassNameLookups->GetElementPtr(i));
+
+				StringView name = m_data.m_package->GetString(nameLookup.m_name.GetIndex());
+
+				RKIT_CHECK(m_data.m_nameToRenderPass.Set(name, nameLookup.m_renderPass));
+			}
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	void NullPipelineLibraryLoader::SetMergedLibraryStream(UniquePtr<ISeekableReadStream> &&cacheReadStream, ISeekableReadWriteStream *cacheWriteStream)
+	{
+		m_cacheReadStream = std::move(cacheReadStream);
+		m_cacheWriteStream = cacheWriteStream;
+	}
+
+	Result NullPipelineLibraryLoader::TryOpenMergedLibrary(bool &outSucceeded)
+	{
+		outSucceeded = false;
+
+		if (!m_cacheReadStream.IsValid())
+			RKIT_RETURN_OK;
+
+		if (m_cacheReadStream->GetSize() != sizeof(NullPipelineCacheHeader))
+			RKIT_RETURN_OK;
+
+		NullPipelineCacheHeader header = {};
+
+		RKIT_CHECK(m_cacheReadStream->SeekStart(0));
+		RKIT_CHECK(m_cacheReadStream->ReadAll(&header, sizeof(header)));
+
+		if (header.m_identifier != NullPipelineCacheHeader::kExpectedIdentifier
+			|| header.m_version != NullPipelineCacheHeader::kExpectedVersion
+			|| memcmp(&header.m_packageUUID, &m_data.m_package->GetPackageUUID(), sizeof(header.m_packageUUID))
+			)
+		{
+			RKIT_RETURN_OK;
+		}
+
+		outSucceeded = true;
+		RKIT_RETURN_OK;
+	}
+
+	Result NullPipelineLibraryLoader::LoadGraphicsPipelineFromMergedLibrary(size_t pipelineIndex, size_t permutationIndex)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	void NullPipelineLibraryLoader::CloseMergedLibrary(bool unloadPipelines, bool unloadMergedCache)
+	{
+		m_cacheReadStream.Reset();
+		m_cacheWriteStream = nullptr;
+	}
+
+	Result NullPipelineLibraryLoader::CompileUnmergedGraphicsPipeline(size_t pipelineIndex, size_t permutationIndex)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullPipelineLibraryLoader::AddMergedPipeline(size_t pipelineIndex, size_t permutationIndex)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	Result NullPipelineLibraryLoader::SaveMergedPipeline()
+	{
+		if (!m_cacheWriteStream)
+			RKIT_RETURN_OK;
+
+		NullPipelineCacheHeader header;
+		header.m_packageUUID = m_data.m_package->GetPackageUUID();
+
+		RKIT_CHECK(m_cacheWriteStream->SeekStart(0));
+		RKIT_CHECK(m_cacheWriteStream->WriteAll(&header, sizeof(header)));
+		RKIT_CHECK(m_cacheWriteStream->Truncate(m_cacheWriteStream->Tell()));
+		RKIT_CHECK(m_cacheWriteStream->Flush());
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullPipelineLibraryLoader::GetFinishedPipeline(UniquePtr<IPipelineLibrary> &outPipelineLibrary)
+	{
+		if (m_isFinished)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		m_isFinished = true;
+
+		UniquePtr<NullPipelineLibrary> pipelineLibrary;
+		RKIT_CHECK(New<NullPipelineLibrary>(pipelineLibrary, std::move(m_data)));
+
+		outPipelineLibrary = std::move(pipelineLibrary);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullPipelineLibraryLoaderBase::Create(UniquePtr<NullPipelineLibraryLoaderBase> &outLoader, UniquePtr<IPipelineLibraryConfigValidator> &&validator,
+		UniquePtr<data::IRenderDataPackage> &&package, UniquePtr<ISeekableReadStream> &&packageStream, FilePos_t packageBinaryContentStart)
+	{
+		return New<NullPipelineLibraryLoader>(outLoader, std::move(validator), std::move(package), std::move(packageStream));
+	}
+} } } // rkit::render::null
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "rkit/Core/StreamProtos.h"
+#include "rkit/Render/PipelineLibraryLoader.h"
+
+namespace rkit
+{
+	template<class T>
+	class UniquePtr;
+
+	struct ISeekableReadStream;
+	struct ISeekableReadWriteStream;
+
+	namespace data
+	{
+		struct IRenderDataPackage;
+	}
+}
+
+namespace rkit { namespace render { namespace null
+{
+	class NullPipelineLibraryLoaderBase : public IPipelineLibraryLoader
+	{
+	public:
+		static Result Create(UniquePtr<NullPipelineLibraryLoaderBase> &outLoader, UniquePtr<IPipelineLibraryConfigValidator> &&validator,
+			UniquePtr<data::IRenderDataPackage> &&package, UniquePtr<ISeekableReadStream> &&packageStream, FilePos_t packageBinaryContentStart);
+	};
+} } } // rkit::render::null
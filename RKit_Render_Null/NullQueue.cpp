@@ -0,0 +1,138 @@
+#include "NullQueue.h"
+
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/Result.h"
+#include "rkit/Core/UniquePtr.h"
+
+#include "NullCommandAllocator.h"
+
+namespace rkit { namespace render { namespace null
+{
+	class NullQueue final : public NullQueueBase
+	{
+	public:
+		explicit NullQueue(CommandQueueType queueType);
+
+		Result CreateCopyCommandAllocator(UniquePtr<ICopyCommandAllocator> &outCommandAllocator, bool isBundle) override;
+		Result CreateComputeCommandAllocator(UniquePtr<IComputeCommandAllocator> &outCommandAllocator, bool isBundle) override;
+		Result CreateGraphicsCommandAllocator(UniquePtr<IGraphicsCommandAllocator> &outCommandAllocator, bool isBundle) override;
+		Result CreateGraphicsComputeCommandAllocator(UniquePtr<IGraphicsComputeCommandAllocator> &outCommandAllocator, bool isBundle) override;
+
+		CommandQueueType GetCommandQueueType() const override;
+
+		ICopyCommandQueue *ToCopyCommandQueue() override;
+		IComputeCommandQueue *ToComputeCommandQueue() override;
+		IGraphicsCommandQueue *ToGraphicsCommandQueue() override;
+		IGraphicsComputeCommandQueue *ToGraphicsComputeCommandQueue() override;
+		IInternalCommandQueue *ToInternalCommandQueue() override;
+
+		template<class T>
+		Result CreateTypedCommandAllocator(UniquePtr<T> &outCommandAllocator, bool isBundle);
+
+	protected:
+		DynamicCastRef_t InternalDynamicCast() override;
+
+	private:
+		CommandQueueType m_queueType;
+	};
+
+	NullQueue::NullQueue(CommandQueueType queueType)
+		: m_queueType(queueType)
+	{
+	}
+
+	Result NullQueue::CreateCopyCommandAllocator(UniquePtr<ICopyCommandAllocator> &outCommandAllocator, bool isBundle)
+	{
+		return CreateTypedCommandAllocator(outCommandAllocator, isBundle);
+	}
+
+	Result NullQueue::CreateComputeCommandAllocator(UniquePtr<IComputeCommandAllocator> &outCommandAllocator, bool isBundle)
+	{
+		return CreateTypedCommandAllocator(outCommandAllocator, isBundle);
+	}
+
+	Result NullQueue::CreateGraphicsCommandAllocator(UniquePtr<IGraphicsCommandAllocator> &outCommandAllocator, bool isBundle)
+	{
+		return CreateTypedCommandAllocator(outCommandAllocator, isBundle);
+	}
+
+	Result NullQueue::CreateGraphicsComputeCommandAllocator(UniquePtr<IGraphicsComputeCommandAllocator> &outCommandAllocator, bool isBundle)
+	{
+		return CreateTypedCommandAllocator(outCommandAllocator, isBundle);
+	}
+
+	CommandQueueType NullQueue::GetCommandQueueType() const
+	{
+		return m_queueType;
+	}
+
+	ICopyCommandQueue *NullQueue::ToCopyCommandQueue()
+	{
+		if (IsQueueTypeCompatible(m_queueType, CommandQueueType::kCopy))
+			return this;
+		else
+			return nullptr;
+	}
+
+	IComputeCommandQueue *NullQueue::ToComputeCommandQueue()
+	{
+		if (IsQueueTypeCompatible(m_queueType, CommandQueueType::kAsyncCompute))
+			return this;
+		else
+			return nullptr;
+	}
+
+	IGraphicsCommandQueue *NullQueue::ToGraphicsCommandQueue()
+	{
+		if (IsQueueTypeCompatible(m_queueType, CommandQueueType::kGraphics))
+			return this;
+		else
+			return nullptr;
+	}
+
+	IGraphicsComputeCommandQueue *NullQueue::ToGraphicsComputeCommandQueue()
+	{
+		if (IsQueueTypeCompatible(m_queueType, CommandQueueType::kGraphicsCompute))
+			return this;
+		else
+			return nullptr;
+	}
+
+	IInternalCommandQueue *NullQueue::ToInternalCommandQueue()
+	{
+		return this;
+	}
+
+	template<class T>
+	Result NullQueue::CreateTypedCommandAllocator(UniquePtr<T> &outCommandAllocator, bool isBundle)
+	{
+		UniquePtr<NullCommandAllocatorBase> cmdAllocator;
+		RKIT_CHECK(NullCommandAllocatorBase::Create(cmdAllocator, m_queueType, isBundle));
+
+		outCommandAllocator = std::move(cmdAllocator);
+
+		RKIT_RETURN_OK;
+	}
+
+	NullQueue::DynamicCastRef_t NullQueue::InternalDynamicCast()
+	{
+		switch (m_queueType)
+		{
+		case CommandQueueType::kGraphics:
+			return DynamicCastRef_t::CreateFrom<NullQueue, IGraphicsCommandQueue, ICopyCommandQueue>(this);
+		case CommandQueueType::kGraphicsCompute:
+			return DynamicCastRef_t::CreateFrom<NullQueue, IGraphicsCommandQueue, IComputeCommandQueue, IGraphicsComputeCommandQueue, ICopyCommandQueue>(this);
+		case CommandQueueType::kAsyncCompute:
+			return DynamicCastRef_t::CreateFrom<NullQueue, IComputeCommandQueue, ICopyCommandQueue>(this);
+		case CommandQueueType::kCopy:
+			return DynamicCastRef_t::CreateFrom<NullQueue, ICopyCommandQueue>(this);
+		default:
+			return DynamicCastRef_t();
+		}
+	}
+
+	Result NullQueueBase::Create(UniquePtr<NullQueueBase> &outQueue, CommandQueueType queueType)
+	{
+		return New<NullQueue>(outQueue, queueType);
+	}
+} } } // rkit::render::null
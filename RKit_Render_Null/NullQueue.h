@@ -0,0 +1,12 @@
+#pragma once
+
+#include "rkit/Render/CommandQueue.h"
+
+namespace rkit { namespace render { namespace null
+{
+	class NullQueueBase : public IGraphicsComputeCommandQueue, public IInternalCommandQueue
+	{
+	public:
+		static Result Create(UniquePtr<NullQueueBase> &outQueue, CommandQueueType queueType);
+	};
+} } } // rkit::render::null
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "rkit/Render/RenderPass.h"
+#include "rkit/Render/RenderPassInstance.h"
+
+namespace rkit { namespace render { namespace null
+{
+	class NullRenderPass final : public IInternalRenderPass
+	{
+	};
+
+	class NullRenderPassInstance final : public IRenderPassInstance
+	{
+	};
+} } } // rkit::render::null
@@ -0,0 +1,115 @@
+#include "NullSwapChain.h"
+
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/UniquePtr.h"
+#include "rkit/Core/Vector.h"
+
+#include "NullImageResource.h"
+
+namespace rkit { namespace render { namespace null
+{
+	class NullSwapChain final : public NullSwapChainBase
+	{
+	public:
+		NullSwapChain();
+
+		Result Initialize(uint8_t numImages);
+
+		void GetExtents(uint32_t &outWidth, uint32_t &outHeight) const override;
+		Result AcquireFrame(ISwapChainSyncPoint &syncPoint) override;
+		Result Present(ISwapChainSyncPoint &syncPoint) override;
+
+		IRenderTargetView *GetRenderTargetViewForFrame(size_t frameIndex) override;
+		IImageResource *GetImageForFrame(size_t frameIndex) override;
+
+	private:
+		// The display is never presented to, so the extents only need to be
+		// something reasonable for viewport and scissor setup.
+		static const uint32_t kWidth = 640;
+		static const uint32_t kHeight = 480;
+
+		Vector<UniquePtr<NullImage>> m_images;
+		Vector<UniquePtr<NullRenderTargetView>> m_rtvs;
+
+		size_t m_nextFrameIndex;
+	};
+
+	Result NullSwapChainPrototype::CheckQueueCompatibility(bool &outIsCompatible, const IBaseCommandQueue &commandQueue) const
+	{
+		outIsCompatible = true;
+
+		RKIT_RETURN_OK;
+	}
+
+	NullSwapChain::NullSwapChain()
+		: m_nextFrameIndex(0)
+	{
+	}
+
+	Result NullSwapChain::Initialize(uint8_t numImages)
+	{
+		if (numImages == 0)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		ImageSpec imageSpec;
+		imageSpec.m_format = TextureFormat::RGBA_UNorm8;
+		imageSpec.m_width = kWidth;
+		imageSpec.m_height = kHeight;
+		imageSpec.m_depth = 1;
+
+		const NullImageLayout layout(imageSpec);
+
+		RKIT_CHECK(m_images.Resize(numImages));
+		RKIT_CHECK(m_rtvs.Resize(numImages));
+
+		for (size_t i = 0; i < numImages; i++)
+		{
+			RKIT_CHECK(New<NullImage>(m_images[i], layout, MemoryAddress()));
+			RKIT_CHECK(New<NullRenderTargetView>(m_rtvs[i], *m_images[i]));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	void NullSwapChain::GetExtents(uint32_t &outWidth, uint32_t &outHeight) const
+	{
+		outWidth = kWidth;
+		outHeight = kHeight;
+	}
+
+	Result NullSwapChain::AcquireFrame(ISwapChainSyncPoint &syncPoint)
+	{
+		static_cast<NullSwapChainSyncPoint &>(syncPoint).SetFrameIndex(m_nextFrameIndex);
+
+		m_nextFrameIndex = (m_nextFrameIndex + 1) % m_images.Count();
+
+		RKIT_RETURN_OK;
+	}
+
+	Result NullSwapChain::Present(ISwapChainSyncPoint &syncPoint)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	IRenderTargetView *NullSwapChain::GetRenderTargetViewForFrame(size_t frameIndex)
+	{
+		return m_rtvs[frameIndex].Get();
+	}
+
+	IImageResource *NullSwapChain::GetImageForFrame(size_t frameIndex)
+	{
+		return m_images[frameIndex].Get();
+	}
+
+	Result NullSwapChainBase::Create(UniquePtr<NullSwapChainBase> &outSwapChain, uint8_t numImages)
+	{
+		UniquePtr<NullSwapChain> swapChain;
+		RKIT_CHECK(New<NullSwapChain>(swapChain));
+
+		RKIT_CHECK(swapChain->Initialize(numImages));
+
+		outSwapChain = std::move(swapChain);
+
+		RKIT_RETURN_OK;
+	}
+} } } // rkit::render::null
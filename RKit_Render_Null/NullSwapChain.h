@@ -0,0 +1,52 @@
+#pragma once
+
+#include "rkit/Render/RenderDefs.h"
+#include "rkit/Render/SwapChain.h"
+#include "rkit/Render/SwapChainFrame.h"
+
+#include <cstdint>
+
+namespace rkit
+{
+	template<class T>
+	class UniquePtr;
+}
+
+namespace rkit { namespace render { namespace null
+{
+	class NullSwapChainSyncPoint final : public ISwapChainSyncPoint
+	{
+	public:
+		size_t GetFrameIndex() const override;
+
+		void SetFrameIndex(size_t frameIndex);
+
+	private:
+		size_t m_frameIndex = 0;
+	};
+
+	class NullSwapChainPrototype final : public ISwapChainPrototype
+	{
+	public:
+		Result CheckQueueCompatibility(bool &outIsCompatible, const IBaseCommandQueue &commandQueue) const override;
+	};
+
+	class NullSwapChainBase : public ISwapChain
+	{
+	public:
+		static Result Create(UniquePtr<NullSwapChainBase> &outSwapChain, uint8_t numImages);
+	};
+} } } // rkit::render::null
+
+namespace rkit { namespace render { namespace null
+{
+	inline size_t NullSwapChainSyncPoint::GetFrameIndex() const
+	{
+		return m_frameIndex;
+	}
+
+	inline void NullSwapChainSyncPoint::SetFrameIndex(size_t frameIndex)
+	{
+		m_frameIndex = frameIndex;
+	}
+} } } // rkit::render::null
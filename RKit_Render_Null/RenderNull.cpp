@@ -0,0 +1,106 @@
+#include "rkit/Render/RenderDriver.h"
+#include "rkit/Render/DeviceCaps.h"
+
+#include "rkit/Core/DriverModuleStub.h"
+#include "rkit/Core/LogDriver.h"
+#include "rkit/Core/ModuleDriver.h"
+#include "rkit/Core/ModuleGlue.h"
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/Span.h"
+#include "rkit/Core/UniquePtr.h"
+#include "rkit/Core/Vector.h"
+
+#include "NullDevice.h"
+
+namespace rkit { namespace render { namespace null
+{
+	class RenderNullAdapter final : public IRenderAdapter
+	{
+	public:
+		size_t GetCommandQueueCount(CommandQueueType type) const override;
+	};
+
+	class RenderNullDriver final : public rkit::render::IRenderDriver
+	{
+	public:
+		rkit::Result InitDriver(const DriverInitParameters *initParams) override;
+		void ShutdownDriver() override;
+
+		uint32_t GetDriverNamespaceID() const override { return rkit::IModuleDriver::kDefaultNamespace; }
+		rkit::StringView GetDriverName() const override { return u8"Render_Null"; }
+
+		Result EnumerateAdapters(Vector<UniquePtr<IRenderAdapter>> &adapters) const override;
+		Result CreateDevice(UniquePtr<IRenderDevice> &outDevice, const Span<CommandQueueTypeRequest> &queueRequests, const IRenderDeviceCaps &requiredCaps, const IRenderDeviceCaps &optionalCaps, IRenderAdapter &adapter) override;
+	};
+
+	typedef rkit::CustomDriverModuleStub<RenderNullDriver> RenderNullModule;
+
+	size_t RenderNullAdapter::GetCommandQueueCount(CommandQueueType type) const
+	{
+		return NullDeviceBase::kMaxQueuesPerType;
+	}
+
+	Result RenderNullDriver::InitDriver(const DriverInitParameters *initParams)
+	{
+		RKIT_RETURN_OK;
+	}
+
+	void RenderNullDriver::ShutdownDriver()
+	{
+	}
+
+	Result RenderNullDriver::EnumerateAdapters(Vector<UniquePtr<IRenderAdapter>> &adapters) const
+	{
+		UniquePtr<IRenderAdapter> adapter;
+		RKIT_CHECK(New<RenderNullAdapter>(adapter));
+
+		RKIT_CHECK(adapters.Resize(1));
+		adapters[0] = std::move(adapter);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result RenderNullDriver::CreateDevice(UniquePtr<IRenderDevice> &outDevice, const Span<CommandQueueTypeRequest> &queueRequests, const IRenderDeviceCaps &requiredCaps, const IRenderDeviceCaps &optionalCaps, IRenderAdapter &adapter)
+	{
+		// There are no hardware limits, so grant everything that was asked for
+		RenderDeviceCaps grantedCaps;
+		grantedCaps.RaiseTo(optionalCaps);
+		grantedCaps.RaiseTo(requiredCaps);
+
+		RenderDeviceRequirements requirements;
+		requirements.SetUInt32Req(RenderDeviceUInt32Requirement::kDataBufferOffsetAlignment, 16);
+		requirements.SetUInt32Req(RenderDeviceUInt32Requirement::kConstantBufferOffsetAlignment, 256);
+		requirements.SetUInt32Req(RenderDeviceUInt32Requirement::kTexelBufferOffsetAlignment, 16);
+
+		size_t queueCounts[static_cast<size_t>(CommandQueueType::kCount)] = {};
+
+		for (const CommandQueueTypeRequest &queueRequest : queueRequests)
+		{
+			const size_t queueTypeInt = static_cast<size_t>(queueRequest.m_type);
+
+			if (queueRequest.m_numQueues == 0)
+			{
+				rkit::log::Error(u8"Command queue request didn't request any queues");
+				RKIT_THROW(ResultCode::kInvalidParameter);
+			}
+
+			if (queueCounts[queueTypeInt] != 0)
+			{
+				rkit::log::Error(u8"Queue type was requested multiple times");
+				RKIT_THROW(ResultCode::kInvalidParameter);
+			}
+
+			if (queueRequest.m_numQueues > NullDeviceBase::kMaxQueuesPerType)
+			{
+				rkit::log::Error(u8"Too many queues requested");
+				RKIT_THROW(ResultCode::kInvalidParameter);
+			}
+
+			queueCounts[queueTypeInt] = queueRequest.m_numQueues;
+		}
+
+		return NullDeviceBase::CreateDevice(outDevice, queueCounts, grantedCaps, requirements);
+	}
+} } } // rkit::render::null
+
+RKIT_IMPLEMENT_MODULE(RKit, Render_Null, ::rkit::render::null::RenderNullModule)
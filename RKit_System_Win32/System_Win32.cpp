@@ -1,8 +1,11 @@
 #include "rkit/Core/Algorithm.h"
 #include "rkit/Core/AsyncFile.h"
+#include "rkit/Core/ConditionVariable.h"
 #include "rkit/Core/DirectoryScan.h"
+#include "rkit/Core/DirectoryWatcher.h"
 #include "rkit/Core/Drivers.h"
 #include "rkit/Core/Event.h"
+#include "rkit/Core/FileMapping.h"
 #include "rkit/Core/Future.h"
 #include "rkit/Core/Job.h"
 #include "rkit/Core/JobQueue.h"
@@ -12,6 +15,7 @@
 #include "rkit/Core/Mutex.h"
 #include "rkit/Core/NewDelete.h"
 #include "rkit/Core/Path.h"
+#include "rkit/Core/ReadWriteLock.h"
 #include "rkit/Core/Span.h"
 #include "rkit/Core/Stream.h"
 #include "rkit/Core/String.h"
@@ -32,6 +36,7 @@
 #include <Shlwapi.h>
 #include <timezoneapi.h>
 #include <KnownFolders.h>
+#include <winioctl.h>
 
 
 namespace rkit
@@ -40,6 +45,15 @@ namespace rkit
 
 	typedef HRESULT(WINAPI *SetThreadDescriptionProc_Win32_t)(HANDLE hThread, PCWSTR lpThreadDescription);
 
+	// Same layout as WIN32_MEMORY_RANGE_ENTRY, which isn't declared when targeting pre-Windows 8
+	struct MemoryRangeEntry_Win32
+	{
+		PVOID m_virtualAddress;
+		SIZE_T m_numberOfBytes;
+	};
+
+	typedef BOOL(WINAPI *PrefetchVirtualMemoryProc_Win32_t)(HANDLE hProcess, ULONG_PTR numberOfEntries, MemoryRangeEntry_Win32 *virtualAddresses, ULONG flags);
+
 	class File_Win32 final : public ISeekableReadWriteStream
 	{
 	public:
@@ -199,6 +213,30 @@ namespace rkit
 		bool m_haveItem;
 	};
 
+	class DirectoryWatcher_Win32 final : public IDirectoryWatcher, public NoCopy
+	{
+	public:
+		DirectoryWatcher_Win32();
+		~DirectoryWatcher_Win32();
+
+		bool WaitForChanges(uint32_t msec) override;
+		Result ReadChanges(bool &outOverflowed, void *userdata, ChangedPathCallback_t callback) override;
+
+		Result Initialize(HANDLE dirHandle);
+
+	private:
+		static const size_t kBufferSizeDWords = 16384;
+
+		Result StartRead();
+
+		HANDLE m_dirHandle;
+		HANDLE m_event;
+		OVERLAPPED m_overlapped;
+		bool m_readPending;
+		DWORD m_buffer[kBufferSizeDWords];
+		Vector<Utf16Char_t> m_fileNameChars;
+	};
+
 	class SystemLibrary_Win32 final : public ISystemLibrary, public NoCopy
 	{
 	public:
@@ -213,6 +251,44 @@ namespace rkit
 		HMODULE m_hmodule;
 	};
 
+	class FileMappingView_Win32 final : public IFileMappingView, public NoCopy
+	{
+	public:
+		FileMappingView_Win32(void *baseAddress, size_t dataOffset, size_t size, bool writable, PrefetchVirtualMemoryProc_Win32_t prefetchProc);
+		~FileMappingView_Win32();
+
+		const void *GetData() const override;
+		size_t GetSize() const override;
+		void *GetMutableData() const override;
+		void Prefetch(size_t offset, size_t size) override;
+
+	private:
+		void *m_baseAddress;
+		uint8_t *m_data;
+		size_t m_size;
+		bool m_writable;
+		PrefetchVirtualMemoryProc_Win32_t m_prefetchProc;
+	};
+
+	class FileMapping_Win32 final : public IFileMapping, public NoCopy
+	{
+	public:
+		FileMapping_Win32(HANDLE hMapping, FilePos_t fileSize, FileMappingMode mode, const SYSTEM_INFO &sysInfo, PrefetchVirtualMemoryProc_Win32_t prefetchProc);
+		~FileMapping_Win32();
+
+		FilePos_t GetFileSize() const override;
+		size_t GetPageSize() const override;
+		Result MapView(UniquePtr<IFileMappingView> &outView, FilePos_t offset, size_t size) override;
+
+	private:
+		HANDLE m_hMapping;
+		FilePos_t m_fileSize;
+		FileMappingMode m_mode;
+		DWORD m_allocationGranularity;
+		DWORD m_pageSize;
+		PrefetchVirtualMemoryProc_Win32_t m_prefetchProc;
+	};
+
 	class Mutex_Win32 final : public IMutex
 	{
 	public:
@@ -223,10 +299,51 @@ namespace rkit
 		bool TryLock(uint32_t maxMSec) override;
 		void Unlock() override;
 
+		CRITICAL_SECTION *GetCriticalSection();
+
 	private:
 		CRITICAL_SECTION m_critSection;
 	};
 
+	// SRW locks spin briefly before parking the thread in the kernel, so uncontended and
+	// lightly contended acquires never leave user mode.
+	class ReadWriteLock_Win32 final : public IReadWriteLock, public NoCopy
+	{
+	public:
+		ReadWriteLock_Win32();
+
+		void LockShared() override;
+		bool TryLockShared() override;
+		void UnlockShared() override;
+
+		void LockExclusive() override;
+		bool TryLockExclusive() override;
+		void UnlockExclusive() override;
+
+		SRWLOCK *GetSRWLock();
+
+	private:
+		SRWLOCK m_srwLock;
+	};
+
+	class ConditionVariable_Win32 final : public IConditionVariable, public NoCopy
+	{
+	public:
+		ConditionVariable_Win32();
+
+		void Wait(IMutex &mutex) override;
+		bool TimedWait(IMutex &mutex, uint32_t msec) override;
+
+		void WaitExclusive(IReadWriteLock &rwLock) override;
+		void WaitShared(IReadWriteLock &rwLock) override;
+
+		void WakeOne() override;
+		void WakeAll() override;
+
+	private:
+		CONDITION_VARIABLE m_condVar;
+	};
+
 	class Event_Win32 final : public IEvent
 	{
 	public:
@@ -298,9 +415,14 @@ namespace rkit
 
 		Result CreateThreadWithPriority(UniqueThreadRef &outThread, UniquePtr<IThreadContext> &&threadContext, ThreadPriority priority, const StringView &threadName) override;
 		Result CreateMutex(UniquePtr<IMutex> &mutex) override;
+		Result CreateReadWriteLock(UniquePtr<IReadWriteLock> &outLock) override;
+		Result CreateConditionVariable(UniquePtr<IConditionVariable> &outConditionVariable) override;
 		Result CreateEvent(UniquePtr<IEvent> &outEvent, bool autoReset, bool startSignaled) override;
 		void SleepMSec(uint32_t msec) const override;
 
+		uint64_t GetHighResTimestamp() const override;
+		uint64_t GetHighResTimestampFrequency() const override;
+
 		Result AsyncOpenFileRead(IJobQueue &jobQueue, RCPtr<Job> &outOpenJob, Job *dependencyJob, const FutureContainerPtr<UniquePtr<ISeekableReadStream>> &outStream, FileLocation location, const CIPathView &path, bool allowFailure) override;
 		Result AsyncOpenFileReadAbs(IJobQueue &jobQueue, RCPtr<Job> &outOpenJob, Job *dependencyJob, const FutureContainerPtr<UniquePtr<ISeekableReadStream>> &outStream, const OSAbsPathView &path, bool allowFailure) override;
 
@@ -316,8 +438,12 @@ namespace rkit
 		Result OpenFileReadWrite(UniquePtr<ISeekableReadWriteStream> &outStream, FileLocation location, const CIPathView &path, bool createIfNotExists, bool createDirectories, bool truncateIfExists, bool allowFailure) override;
 		Result OpenFileReadWriteAbs(UniquePtr<ISeekableReadWriteStream> &outStream, const OSAbsPathView &path, bool createIfNotExists, bool createDirectories, bool truncateIfExists, bool allowFailure) override;
 
+		Result OpenFileMapping(UniquePtr<IFileMapping> &outMapping, FileLocation location, const CIPathView &path, FileMappingMode mode, FileAccessHint accessHint, bool allowFailure) override;
+		Result OpenFileMappingAbs(UniquePtr<IFileMapping> &outMapping, const OSAbsPathView &path, FileMappingMode mode, FileAccessHint accessHint, bool allowFailure) override;
+
 		Result OpenDirectoryScan(UniquePtr<IDirectoryScan> &outDirectoryScan, FileLocation location, const CIPathView &path, bool allowFailure) override;
 		Result OpenDirectoryScanAbs(UniquePtr<IDirectoryScan> &outDirectoryScan, const OSAbsPathView &path, bool allowFailure) override;
+		Result OpenDirectoryWatcherAbs(UniquePtr<IDirectoryWatcher> &outWatcher, const OSAbsPathView &path, bool allowFailure) override;
 		Result GetFileAttributes(bool &outSucceeded, bool &outExists, FileAttributes &outAttribs, FileLocation location, const CIPathView &path, bool allowFailure) override;
 		Result GetFileAttributesAbs(bool &outSucceeded, bool &outExists, FileAttributes &outAttribs, const OSAbsPathView &path, bool allowFailure) override;
 
@@ -326,11 +452,15 @@ namespace rkit
 		Result CopyFileFromAbs(bool &outSucceeded, const OSAbsPathView &srcPath, FileLocation location, const CIPathView &path, bool overwrite, bool allowFailure) override;
 		Result CopyFile(bool &outSucceeded, FileLocation srcLocation, const CIPathView &srcPath, FileLocation destLocation, const CIPathView &destPath, bool overwrite, bool allowFailure) override;
 
+		Result CloneFileFromAbsToAbs(bool &outSucceeded, const OSAbsPathView &srcPath, const OSAbsPathView &destPath, bool allowFailure) override;
+
 		Result MoveFileFromAbsToAbs(bool &outSucceeded, const OSAbsPathView &srcPath, const OSAbsPathView &destPath, bool overwrite, bool allowFailure) override;
 		Result MoveFileToAbs(bool &outSucceeded, FileLocation location, const CIPathView &path, const OSAbsPathView &destPath, bool overwrite, bool allowFailure) override;
 		Result MoveFileFromAbs(bool &outSucceeded, const OSAbsPathView &srcPath, FileLocation location, const CIPathView &path, bool overwrite, bool allowFailure) override;
 		Result MoveFile(bool &outSucceeded, FileLocation srcLocation, const CIPathView &srcPath, FileLocation destLocation, const CIPathView &destPath, bool overwrite, bool allowFailure) override;
 
+		Result CreateDirectoriesAbs(bool &outSucceeded, const OSAbsPathView &path, bool allowFailure) override;
+
 		Result SetGameDirectoryOverride(const OSAbsPathView &path) override;
 		Result SetSettingsDirectory(const StringView &path) override;
 		char GetPathSeparator() const override;
@@ -350,6 +480,7 @@ namespace rkit
 		Result OpenFileGeneral(UniquePtr<File_Win32> &outStream, const OSAbsPathView &path, bool createDirectories, bool allowFailure, DWORD access, DWORD shareMode, DWORD disposition, DWORD extraFlags);
 		Result OpenFileAsyncGeneral(UniquePtr<AsyncFile_Win32> &outStream, FilePos_t &outInitialSize, const OSAbsPathView &path, bool createDirectories, bool allowFailure, DWORD access, DWORD shareMode, DWORD disposition, DWORD extraFlags);
 		static Result CheckCreateDirectories(bool &outSucceeded, Vector<Utf16Char_t> &pathChars, bool allowFailure);
+		static bool DuplicateFileExtents(HANDLE srcFile, HANDLE destFile);
 
 		Result ResolveAbsPath(bool &resolvedOK, OSAbsPath &outPath, FileLocation location, const CIPathView &path);
 
@@ -372,6 +503,8 @@ namespace rkit
 
 		HMODULE m_kernelBaseModule = nullptr;
 
+		PrefetchVirtualMemoryProc_Win32_t m_prefetchVirtualMemoryProc = nullptr;
+
 #if RKIT_IS_DEBUG
 		SetThreadDescriptionProc_Win32_t m_setThreadDescriptionProc;
 #endif
@@ -1055,6 +1188,123 @@ namespace rkit
 		RKIT_RETURN_OK;
 	}
 
+	DirectoryWatcher_Win32::DirectoryWatcher_Win32()
+		: m_dirHandle(INVALID_HANDLE_VALUE)
+		, m_event(nullptr)
+		, m_overlapped{}
+		, m_readPending(false)
+		, m_buffer{}
+	{
+	}
+
+	DirectoryWatcher_Win32::~DirectoryWatcher_Win32()
+	{
+		if (m_readPending)
+		{
+			DWORD bytesTransferred = 0;
+			::CancelIoEx(m_dirHandle, &m_overlapped);
+			::GetOverlappedResult(m_dirHandle, &m_overlapped, &bytesTransferred, TRUE);
+		}
+
+		if (m_dirHandle != INVALID_HANDLE_VALUE)
+			::CloseHandle(m_dirHandle);
+
+		if (m_event)
+			::CloseHandle(m_event);
+	}
+
+	bool DirectoryWatcher_Win32::WaitForChanges(uint32_t msec)
+	{
+		if (!m_readPending)
+			return true;
+
+		if (msec >= INFINITE)
+			msec = static_cast<DWORD>(INFINITE) - 1u;
+
+		DWORD waitResult = ::WaitForSingleObject(m_event, msec);
+
+		return (waitResult != WAIT_TIMEOUT);
+	}
+
+	Result DirectoryWatcher_Win32::ReadChanges(bool &outOverflowed, void *userdata, ChangedPathCallback_t callback)
+	{
+		outOverflowed = false;
+
+		DWORD bytesTransferred = 0;
+		if (m_readPending)
+		{
+			if (!::GetOverlappedResult(m_dirHandle, &m_overlapped, &bytesTransferred, FALSE))
+			{
+				if (::GetLastError() == ERROR_IO_INCOMPLETE)
+					RKIT_RETURN_OK;
+
+				// ERROR_NOTIFY_ENUM_DIR and similar mean the change list was dropped
+				bytesTransferred = 0;
+			}
+
+			m_readPending = false;
+		}
+
+		// A successful read with no data means that the buffer overflowed
+		if (bytesTransferred == 0)
+			outOverflowed = true;
+		else
+		{
+			const uint8_t *bufferBytes = reinterpret_cast<const uint8_t *>(m_buffer);
+			size_t offset = 0;
+
+			for (;;)
+			{
+				const FILE_NOTIFY_INFORMATION *notifyInfo = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(bufferBytes + offset);
+
+				const size_t numChars = notifyInfo->FileNameLength / sizeof(WCHAR);
+
+				RKIT_CHECK(m_fileNameChars.Resize(numChars + 1));
+				memcpy(m_fileNameChars.GetBuffer(), notifyInfo->FileName, numChars * sizeof(WCHAR));
+				m_fileNameChars[numChars] = 0;
+
+				RKIT_CHECK(callback(userdata, OSRelPathView(Utf16StringView(m_fileNameChars.GetBuffer(), numChars))));
+
+				if (notifyInfo->NextEntryOffset == 0)
+					break;
+
+				offset += notifyInfo->NextEntryOffset;
+			}
+		}
+
+		RKIT_CHECK(StartRead());
+
+		RKIT_RETURN_OK;
+	}
+
+	Result DirectoryWatcher_Win32::Initialize(HANDLE dirHandle)
+	{
+		m_dirHandle = dirHandle;
+
+		m_event = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		if (!m_event)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		return StartRead();
+	}
+
+	Result DirectoryWatcher_Win32::StartRead()
+	{
+		const DWORD notifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION;
+
+		::ResetEvent(m_event);
+
+		m_overlapped = OVERLAPPED{};
+		m_overlapped.hEvent = m_event;
+
+		if (!::ReadDirectoryChangesW(m_dirHandle, m_buffer, sizeof(m_buffer), TRUE, notifyFilter, nullptr, &m_overlapped, nullptr))
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		m_readPending = true;
+
+		RKIT_RETURN_OK;
+	}
+
 	SystemLibrary_Win32::SystemLibrary_Win32()
 		: m_hmodule(nullptr)
 	{
@@ -1081,6 +1331,118 @@ namespace rkit
 		return true;
 	}
 
+	FileMappingView_Win32::FileMappingView_Win32(void *baseAddress, size_t dataOffset, size_t size, bool writable, PrefetchVirtualMemoryProc_Win32_t prefetchProc)
+		: m_baseAddress(baseAddress)
+		, m_data(baseAddress ? (static_cast<uint8_t *>(baseAddress) + dataOffset) : nullptr)
+		, m_size(size)
+		, m_writable(writable)
+		, m_prefetchProc(prefetchProc)
+	{
+	}
+
+	FileMappingView_Win32::~FileMappingView_Win32()
+	{
+		if (m_baseAddress)
+			UnmapViewOfFile(m_baseAddress);
+	}
+
+	const void *FileMappingView_Win32::GetData() const
+	{
+		return m_data;
+	}
+
+	size_t FileMappingView_Win32::GetSize() const
+	{
+		return m_size;
+	}
+
+	void *FileMappingView_Win32::GetMutableData() const
+	{
+		if (!m_writable)
+			return nullptr;
+
+		return m_data;
+	}
+
+	void FileMappingView_Win32::Prefetch(size_t offset, size_t size)
+	{
+		if (!m_prefetchProc || offset >= m_size)
+			return;
+
+		if (size > m_size - offset)
+			size = m_size - offset;
+
+		MemoryRangeEntry_Win32 rangeEntry;
+		rangeEntry.m_virtualAddress = m_data + offset;
+		rangeEntry.m_numberOfBytes = size;
+
+		m_prefetchProc(GetCurrentProcess(), 1, &rangeEntry, 0);
+	}
+
+	FileMapping_Win32::FileMapping_Win32(HANDLE hMapping, FilePos_t fileSize, FileMappingMode mode, const SYSTEM_INFO &sysInfo, PrefetchVirtualMemoryProc_Win32_t prefetchProc)
+		: m_hMapping(hMapping)
+		, m_fileSize(fileSize)
+		, m_mode(mode)
+		, m_allocationGranularity(sysInfo.dwAllocationGranularity)
+		, m_pageSize(sysInfo.dwPageSize)
+		, m_prefetchProc(prefetchProc)
+	{
+	}
+
+	FileMapping_Win32::~FileMapping_Win32()
+	{
+		if (m_hMapping)
+			CloseHandle(m_hMapping);
+	}
+
+	FilePos_t FileMapping_Win32::GetFileSize() const
+	{
+		return m_fileSize;
+	}
+
+	size_t FileMapping_Win32::GetPageSize() const
+	{
+		return m_pageSize;
+	}
+
+	Result FileMapping_Win32::MapView(UniquePtr<IFileMappingView> &outView, FilePos_t offset, size_t size)
+	{
+		if (offset > m_fileSize || size > m_fileSize - offset)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		const bool writable = (m_mode == FileMappingMode::kCopyOnWrite);
+
+		// Empty files have no mapping object, and empty views don't need one
+		if (size == 0)
+			return New<FileMappingView_Win32>(outView, nullptr, 0, 0, writable, m_prefetchProc);
+
+		// Views have to start on an allocation granularity boundary
+		const FilePos_t alignedOffset = offset - (offset % m_allocationGranularity);
+		const size_t dataOffset = static_cast<size_t>(offset - alignedOffset);
+
+		if (size > std::numeric_limits<size_t>::max() - dataOffset)
+			RKIT_THROW(ResultCode::kOutOfMemory);
+
+		const DWORD desiredAccess = writable ? FILE_MAP_COPY : FILE_MAP_READ;
+		const DWORD offsetHigh = static_cast<DWORD>((alignedOffset >> 32) & 0xffffffffu);
+		const DWORD offsetLow = static_cast<DWORD>(alignedOffset & 0xffffffffu);
+
+		void *baseAddress = MapViewOfFile(m_hMapping, desiredAccess, offsetHigh, offsetLow, dataOffset + size);
+		if (!baseAddress)
+			RKIT_THROW(ResultCode::kIOError);
+
+		RKIT_TRY_CATCH_RETHROW(New<FileMappingView_Win32>(outView, baseAddress, dataOffset, size, writable, m_prefetchProc),
+			CatchContext(
+				[baseAddress]
+				{
+					UnmapViewOfFile(baseAddress);
+				}
+			)
+		);
+
+		RKIT_RETURN_OK;
+	}
+
 	Mutex_Win32::Mutex_Win32()
 	{
 		InitializeCriticalSection(&m_critSection);
@@ -1121,6 +1483,92 @@ namespace rkit
 		LeaveCriticalSection(&m_critSection);
 	}
 
+	CRITICAL_SECTION *Mutex_Win32::GetCriticalSection()
+	{
+		return &m_critSection;
+	}
+
+	ReadWriteLock_Win32::ReadWriteLock_Win32()
+	{
+		InitializeSRWLock(&m_srwLock);
+	}
+
+	void ReadWriteLock_Win32::LockShared()
+	{
+		AcquireSRWLockShared(&m_srwLock);
+	}
+
+	bool ReadWriteLock_Win32::TryLockShared()
+	{
+		return TryAcquireSRWLockShared(&m_srwLock) != FALSE;
+	}
+
+	void ReadWriteLock_Win32::UnlockShared()
+	{
+		ReleaseSRWLockShared(&m_srwLock);
+	}
+
+	void ReadWriteLock_Win32::LockExclusive()
+	{
+		AcquireSRWLockExclusive(&m_srwLock);
+	}
+
+	bool ReadWriteLock_Win32::TryLockExclusive()
+	{
+		return TryAcquireSRWLockExclusive(&m_srwLock) != FALSE;
+	}
+
+	void ReadWriteLock_Win32::UnlockExclusive()
+	{
+		ReleaseSRWLockExclusive(&m_srwLock);
+	}
+
+	SRWLOCK *ReadWriteLock_Win32::GetSRWLock()
+	{
+		return &m_srwLock;
+	}
+
+	ConditionVariable_Win32::ConditionVariable_Win32()
+	{
+		InitializeConditionVariable(&m_condVar);
+	}
+
+	void ConditionVariable_Win32::Wait(IMutex &mutex)
+	{
+		SleepConditionVariableCS(&m_condVar, static_cast<Mutex_Win32 &>(mutex).GetCriticalSection(), INFINITE);
+	}
+
+	bool ConditionVariable_Win32::TimedWait(IMutex &mutex, uint32_t msec)
+	{
+		if (msec >= INFINITE)
+			msec = static_cast<DWORD>(INFINITE) - 1u;
+
+		if (SleepConditionVariableCS(&m_condVar, static_cast<Mutex_Win32 &>(mutex).GetCriticalSection(), msec))
+			return true;
+
+		return GetLastError() != ERROR_TIMEOUT;
+	}
+
+	void ConditionVariable_Win32::WaitExclusive(IReadWriteLock &rwLock)
+	{
+		SleepConditionVariableSRW(&m_condVar, static_cast<ReadWriteLock_Win32 &>(rwLock).GetSRWLock(), INFINITE, 0);
+	}
+
+	void ConditionVariable_Win32::WaitShared(IReadWriteLock &rwLock)
+	{
+		SleepConditionVariableSRW(&m_condVar, static_cast<ReadWriteLock_Win32 &>(rwLock).GetSRWLock(), INFINITE, CONDITION_VARIABLE_LOCKMODE_SHARED);
+	}
+
+	void ConditionVariable_Win32::WakeOne()
+	{
+		WakeConditionVariable(&m_condVar);
+	}
+
+	void ConditionVariable_Win32::WakeAll()
+	{
+		WakeAllConditionVariable(&m_condVar);
+	}
+
 	Event_Win32::Event_Win32()
 		: m_event(nullptr)
 	{
@@ -1276,6 +1724,11 @@ namespace rkit
 
 		RKIT_CHECK(render::DisplayManagerBase_Win32::Create(m_displayManager, m_alloc, m_hInstance));
 
+		// PrefetchVirtualMemory is only available on Windows 8 and later
+		HMODULE kernel32Module = GetModuleHandleW(L"kernel32.dll");
+		if (kernel32Module)
+			m_prefetchVirtualMemoryProc = reinterpret_cast<PrefetchVirtualMemoryProc_Win32_t>(GetProcAddress(kernel32Module, "PrefetchVirtualMemory"));
+
 #if RKIT_IS_DEBUG
 		m_kernelBaseModule = LoadLibraryW(L"KernelBase.dll");
 		if (m_kernelBaseModule)
@@ -1424,6 +1877,97 @@ namespace rkit
 		RKIT_RETURN_OK;
 	}
 
+	Result SystemDriver_Win32::OpenFileMapping(UniquePtr<IFileMapping> &outMapping, FileLocation location, const CIPathView &path, FileMappingMode mode, FileAccessHint accessHint, bool allowFailure)
+	{
+		OSAbsPath absPath;
+		bool resolvedOK = false;
+		RKIT_CHECK(ResolveAbsPath(resolvedOK, absPath, location, path));
+
+		if (!resolvedOK)
+		{
+			if (!allowFailure)
+				RKIT_THROW(ResultCode::kFileOpenError);
+
+			outMapping.Reset();
+			RKIT_RETURN_OK;
+		}
+
+		return OpenFileMappingAbs(outMapping, absPath, mode, accessHint, allowFailure);
+	}
+
+	Result SystemDriver_Win32::OpenFileMappingAbs(UniquePtr<IFileMapping> &outMapping, const OSAbsPathView &path, FileMappingMode mode, FileAccessHint accessHint, bool allowFailure)
+	{
+		outMapping.Reset();
+
+		// Mapped pages are faulted in through the cache manager, so the scan flags control read-ahead
+		DWORD flags = FILE_ATTRIBUTE_NORMAL;
+		switch (accessHint)
+		{
+		case FileAccessHint::kSequential:
+			flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+			break;
+		case FileAccessHint::kRandom:
+			flags |= FILE_FLAG_RANDOM_ACCESS;
+			break;
+		default:
+			break;
+		}
+
+		HANDLE fHandle = CreateFileW(reinterpret_cast<const wchar_t *>(path.GetChars()), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+
+		if (fHandle == INVALID_HANDLE_VALUE)
+		{
+			if (allowFailure)
+				RKIT_RETURN_OK;
+			else
+				RKIT_THROW(ResultCode::kFileOpenError);
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fHandle, &fileSize))
+		{
+			CloseHandle(fHandle);
+			if (allowFailure)
+				RKIT_RETURN_OK;
+			else
+				RKIT_THROW(ResultCode::kFileOpenError);
+		}
+
+		// CreateFileMapping fails on empty files, so those get a mapping with no handle
+		HANDLE hMapping = nullptr;
+		if (fileSize.QuadPart > 0)
+		{
+			const DWORD protect = (mode == FileMappingMode::kCopyOnWrite) ? PAGE_WRITECOPY : PAGE_READONLY;
+			hMapping = CreateFileMappingW(fHandle, nullptr, protect, 0, 0, nullptr);
+		}
+
+		// The mapping object keeps the file open
+		CloseHandle(fHandle);
+
+		if (fileSize.QuadPart > 0 && !hMapping)
+		{
+			if (allowFailure)
+				RKIT_RETURN_OK;
+			else
+				RKIT_THROW(ResultCode::kFileOpenError);
+		}
+
+		SYSTEM_INFO sysInfo;
+		GetSystemInfo(&sysInfo);
+
+		RKIT_TRY_CATCH_RETHROW(New<FileMapping_Win32>(outMapping, hMapping, static_cast<FilePos_t>(fileSize.QuadPart), mode, sysInfo, m_prefetchVirtualMemoryProc),
+			CatchContext(
+				[hMapping]
+				{
+					if (hMapping)
+						CloseHandle(hMapping);
+				}
+			)
+		);
+
+		RKIT_RETURN_OK;
+	}
+
 	Result SystemDriver_Win32::OpenFileAsyncRead(AsyncFileOpenReadResult &outStream, FileLocation location, const CIPathView &path, bool allowFailure)
 	{
 		OSAbsPath absPath;
@@ -1594,6 +2138,26 @@ namespace rkit
 		RKIT_RETURN_OK;
 	}
 
+	Result SystemDriver_Win32::CreateReadWriteLock(UniquePtr<IReadWriteLock> &outLock)
+	{
+		UniquePtr<ReadWriteLock_Win32> rwLock;
+		RKIT_CHECK(NewWithAlloc<ReadWriteLock_Win32>(rwLock, m_alloc));
+
+		outLock = std::move(rwLock);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result SystemDriver_Win32::CreateConditionVariable(UniquePtr<IConditionVariable> &outConditionVariable)
+	{
+		UniquePtr<ConditionVariable_Win32> condVar;
+		RKIT_CHECK(NewWithAlloc<ConditionVariable_Win32>(condVar, m_alloc));
+
+		outConditionVariable = std::move(condVar);
+
+		RKIT_RETURN_OK;
+	}
+
 	Result SystemDriver_Win32::CreateEvent(UniquePtr<IEvent> &outEvent, bool autoReset, bool startSignaled)
 	{
 		UniquePtr<Event_Win32> event;
@@ -1611,6 +2175,22 @@ namespace rkit
 		::Sleep(msec);
 	}
 
+	uint64_t SystemDriver_Win32::GetHighResTimestamp() const
+	{
+		LARGE_INTEGER qpc;
+		QueryPerformanceCounter(&qpc);
+
+		return static_cast<uint64_t>(qpc.QuadPart);
+	}
+
+	uint64_t SystemDriver_Win32::GetHighResTimestampFrequency() const
+	{
+		LARGE_INTEGER qpf;
+		QueryPerformanceFrequency(&qpf);
+
+		return static_cast<uint64_t>(qpf.QuadPart);
+	}
+
 	Result SystemDriver_Win32::OpenDirectoryScan(UniquePtr<IDirectoryScan> &outDirectoryScan, FileLocation location, const CIPathView &path, bool allowFailure)
 	{
 		OSAbsPath absPath;
@@ -1660,6 +2240,108 @@ namespace rkit
 		RKIT_RETURN_OK;
 	}
 
+	Result SystemDriver_Win32::CloneFileFromAbsToAbs(bool &outSucceeded, const OSAbsPathView &srcPath, const OSAbsPathView &destPath, bool allowFailure)
+	{
+		outSucceeded = false;
+
+		HANDLE srcFile = ::CreateFileW(reinterpret_cast<const wchar_t *>(srcPath.GetChars()), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (srcFile == INVALID_HANDLE_VALUE)
+		{
+			if (!allowFailure)
+				RKIT_THROW(ResultCode::kFileOpenError);
+
+			RKIT_RETURN_OK;
+		}
+
+		bool cloned = false;
+
+		HANDLE destFile = ::CreateFileW(reinterpret_cast<const wchar_t *>(destPath.GetChars()), GENERIC_READ | GENERIC_WRITE | DELETE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (destFile != INVALID_HANDLE_VALUE)
+		{
+			cloned = DuplicateFileExtents(srcFile, destFile);
+
+			if (!cloned)
+			{
+				FILE_DISPOSITION_INFO dispositionInfo = {};
+				dispositionInfo.DeleteFile = TRUE;
+
+				::SetFileInformationByHandle(destFile, FileDispositionInfo, &dispositionInfo, sizeof(dispositionInfo));
+			}
+
+			::CloseHandle(destFile);
+		}
+
+		::CloseHandle(srcFile);
+
+		if (!cloned && !allowFailure)
+			RKIT_THROW(ResultCode::kIOError);
+
+		outSucceeded = cloned;
+
+		RKIT_RETURN_OK;
+	}
+
+	// Shares the source file's clusters with the destination file.  Only ReFS supports this, and
+	// the source and destination must have matching integrity stream settings.
+	bool SystemDriver_Win32::DuplicateFileExtents(HANDLE srcFile, HANDLE destFile)
+	{
+		DWORD fsFlags = 0;
+		if (!::GetVolumeInformationByHandleW(destFile, nullptr, 0, nullptr, nullptr, &fsFlags, nullptr, 0))
+			return false;
+
+		if ((fsFlags & FILE_SUPPORTS_BLOCK_REFCOUNTING) == 0)
+			return false;
+
+		DWORD bytesReturned = 0;
+
+		FSCTL_GET_INTEGRITY_INFORMATION_BUFFER integrityInfo = {};
+		if (!::DeviceIoControl(srcFile, FSCTL_GET_INTEGRITY_INFORMATION, nullptr, 0, &integrityInfo, sizeof(integrityInfo), &bytesReturned, nullptr))
+			return false;
+
+		FSCTL_SET_INTEGRITY_INFORMATION_BUFFER setIntegrityInfo = {};
+		setIntegrityInfo.ChecksumAlgorithm = integrityInfo.ChecksumAlgorithm;
+		setIntegrityInfo.Flags = integrityInfo.Flags;
+		if (!::DeviceIoControl(destFile, FSCTL_SET_INTEGRITY_INFORMATION, &setIntegrityInfo, sizeof(setIntegrityInfo), nullptr, 0, &bytesReturned, nullptr))
+			return false;
+
+		LARGE_INTEGER fileSize = {};
+		if (!::GetFileSizeEx(srcFile, &fileSize))
+			return false;
+
+		FILE_END_OF_FILE_INFO eofInfo = {};
+		eofInfo.EndOfFile = fileSize;
+		if (!::SetFileInformationByHandle(destFile, FileEndOfFileInfo, &eofInfo, sizeof(eofInfo)))
+			return false;
+
+		// Ranges must be cluster-aligned, but the last one may extend past the end of the file.
+		// Each request must also be under 4GB.
+		const LONGLONG clusterSize = integrityInfo.ClusterSizeInBytes;
+		const LONGLONG maxChunkSize = 0x80000000LL;
+
+		if (clusterSize <= 0 || (maxChunkSize % clusterSize) != 0)
+			return false;
+
+		const LONGLONG alignedSize = (fileSize.QuadPart + clusterSize - 1) / clusterSize * clusterSize;
+
+		for (LONGLONG offset = 0; offset < alignedSize; offset += maxChunkSize)
+		{
+			LONGLONG chunkSize = alignedSize - offset;
+			if (chunkSize > maxChunkSize)
+				chunkSize = maxChunkSize;
+
+			DUPLICATE_EXTENTS_DATA duplicateData = {};
+			duplicateData.FileHandle = srcFile;
+			duplicateData.SourceFileOffset.QuadPart = offset;
+			duplicateData.TargetFileOffset.QuadPart = offset;
+			duplicateData.ByteCount.QuadPart = chunkSize;
+
+			if (!::DeviceIoControl(destFile, FSCTL_DUPLICATE_EXTENTS_TO_FILE, &duplicateData, sizeof(duplicateData), nullptr, 0, &bytesReturned, nullptr))
+				return false;
+		}
+
+		return true;
+	}
+
 	Result SystemDriver_Win32::CopyFileToAbs(bool &outSucceeded, FileLocation location, const CIPathView &path, const OSAbsPathView &destPath, bool overwrite, bool allowFailure)
 	{
 		OSAbsPath srcPath;
@@ -1792,6 +2474,19 @@ namespace rkit
 		return MoveFileFromAbsToAbs(outSucceeded, osSrcPath, osDestPath, overwrite, allowFailure);
 	}
 
+	Result SystemDriver_Win32::CreateDirectoriesAbs(bool &outSucceeded, const OSAbsPathView &path, bool allowFailure)
+	{
+		// CheckCreateDirectories creates the directories before each separator, so end the path with one
+		Vector<Utf16Char_t> dirCharsVector;
+		RKIT_CHECK(dirCharsVector.Resize(path.Length() + 2));
+
+		CopySpanNonOverlapping(dirCharsVector.ToSpan().SubSpan(0, path.Length()), path.ToStringView().ToSpan());
+		dirCharsVector[path.Length()] = L'\\';
+		dirCharsVector[path.Length() + 1] = L'\0';
+
+		return CheckCreateDirectories(outSucceeded, dirCharsVector, allowFailure);
+	}
+
 	Result SystemDriver_Win32::OpenDirectoryScanAbs(UniquePtr<IDirectoryScan> &outDirectoryScan, const OSAbsPathView &path, bool allowFailure)
 	{
 		UniquePtr<DirectoryScan_Win32> dirScan;
@@ -1827,6 +2522,30 @@ namespace rkit
 		RKIT_RETURN_OK;
 	}
 
+	Result SystemDriver_Win32::OpenDirectoryWatcherAbs(UniquePtr<IDirectoryWatcher> &outWatcher, const OSAbsPathView &path, bool allowFailure)
+	{
+		UniquePtr<DirectoryWatcher_Win32> watcher;
+		RKIT_CHECK(New<DirectoryWatcher_Win32>(watcher));
+
+		HANDLE dirHandle = ::CreateFileW(reinterpret_cast<const wchar_t *>(path.GetChars()), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if (dirHandle == INVALID_HANDLE_VALUE)
+		{
+			if (allowFailure)
+			{
+				outWatcher.Reset();
+				RKIT_RETURN_OK;
+			}
+
+			RKIT_THROW(ResultCode::kFileOpenError);
+		}
+
+		RKIT_CHECK(watcher->Initialize(dirHandle));
+
+		outWatcher = watcher.StaticCastMove<IDirectoryWatcher>();
+
+		RKIT_RETURN_OK;
+	}
+
 	Result SystemDriver_Win32::GetFileAttributesAbs(bool &outSucceeded, bool &outExists, FileAttributes &outAttribs, const OSAbsPathView &path, bool allowFailure)
 	{
 		DWORD attribs = GetFileAttributesW(reinterpret_cast<const wchar_t *>(path.GetChars()));
@@ -2024,7 +2743,8 @@ namespace rkit
 				{
 					pathChars[i] = 0;
 
-					if (!CreateDirectoryW(reinterpret_cast<const wchar_t *>(pathChars.GetBuffer()), nullptr))
+					// Another thread may have created the same directory since it was checked
+					if (!CreateDirectoryW(reinterpret_cast<const wchar_t *>(pathChars.GetBuffer()), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
 					{
 						outSucceeded = false;
 
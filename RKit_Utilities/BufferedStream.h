@@ -0,0 +1,41 @@
+#pragma once
+
+#include "rkit/Core/BufferedStream.h"
+#include "rkit/Core/UniquePtr.h"
+#include "rkit/Core/Vector.h"
+
+#include <utility>
+
+namespace rkit { namespace utils { namespace priv {
+	template<class TStream>
+	struct BufferedStreamStorage
+	{
+		BufferedStreamStorage(UniquePtr<TStream> &&stream, Vector<uint8_t> &&buffer);
+
+		UniquePtr<TStream> m_ownedStream;
+		Vector<uint8_t> m_ownedBuffer;
+	};
+
+	// Buffered stream adapter that owns the underlying stream and the buffer.
+	// The storage base is constructed first so that the adapter can bind to it.
+	template<class TBufferedStream, class TStream>
+	class OwningBufferedStream final : private BufferedStreamStorage<TStream>, public TBufferedStream
+	{
+	public:
+		OwningBufferedStream(UniquePtr<TStream> &&stream, Vector<uint8_t> &&buffer);
+	};
+} } } // rkit::utils::priv
+
+template<class TStream>
+rkit::utils::priv::BufferedStreamStorage<TStream>::BufferedStreamStorage(UniquePtr<TStream> &&stream, Vector<uint8_t> &&buffer)
+	: m_ownedStream(std::move(stream))
+	, m_ownedBuffer(std::move(buffer))
+{
+}
+
+template<class TBufferedStream, class TStream>
+rkit::utils::priv::OwningBufferedStream<TBufferedStream, TStream>::OwningBufferedStream(UniquePtr<TStream> &&stream, Vector<uint8_t> &&buffer)
+	: BufferedStreamStorage<TStream>(std::move(stream), std::move(buffer))
+	, TBufferedStream(*this->m_ownedStream, this->m_ownedBuffer.ToSpan())
+{
+}
@@ -0,0 +1,234 @@
+#include "ImageKernels.h"
+
+#include "rkit/Core/Algorithm.h"
+#include "rkit/Core/Platform.h"
+
+#include <string.h>
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+#include <emmintrin.h>
+#endif
+
+namespace rkit { namespace utils
+{
+	ImageKernels::ImageKernels(bool allowVector, const ConstSpan<uint16_t> &srgbToLinearTable, const ConstSpan<uint8_t> &linearToSRGBTable)
+		: m_allowVector(allowVector)
+		, m_srgbToLinearTable(srgbToLinearTable)
+		, m_linearToSRGBTable(linearToSRGBTable)
+	{
+	}
+
+	bool ImageKernels::ExpandPalette8ToRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inIndexes, const Span<const uint8_t> &paletteRGBA) const
+	{
+		const size_t numPixels = Min(outRGBA.Count() / 4u, inIndexes.Count());
+		const size_t numPaletteEntries = paletteRGBA.Count() / 4u;
+
+		uint8_t *outPtr = outRGBA.Ptr();
+		const uint8_t *inPtr = inIndexes.Ptr();
+		const uint8_t *palettePtr = paletteRGBA.Ptr();
+
+		// No gather in SSE2, so this is one 4-byte copy per pixel either way
+		for (size_t i = 0; i < numPixels; i++)
+		{
+			const size_t index = inPtr[i];
+			if (index >= numPaletteEntries)
+				return false;
+
+			memcpy(outPtr + i * 4u, palettePtr + index * 4u, 4);
+		}
+
+		return true;
+	}
+
+	void ImageKernels::ExpandGray8ToRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inGray) const
+	{
+		const size_t numPixels = Min(outRGBA.Count() / 4u, inGray.Count());
+
+		uint8_t *outPtr = outRGBA.Ptr();
+		const uint8_t *inPtr = inGray.Ptr();
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+		const size_t numVectorPixels = m_allowVector ? (numPixels / 16u * 16u) : 0;
+
+		const __m128i opaqueVector = _mm_set1_epi8(-1);
+
+		for (size_t startIndex = 0; startIndex < numVectorPixels; startIndex += 16u)
+		{
+			const __m128i gray = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inPtr + startIndex));
+
+			const __m128i grayGrayLo = _mm_unpacklo_epi8(gray, gray);
+			const __m128i grayGrayHi = _mm_unpackhi_epi8(gray, gray);
+			const __m128i grayAlphaLo = _mm_unpacklo_epi8(gray, opaqueVector);
+			const __m128i grayAlphaHi = _mm_unpackhi_epi8(gray, opaqueVector);
+
+			__m128i *outVectors = reinterpret_cast<__m128i *>(outPtr + startIndex * 4u);
+			_mm_storeu_si128(outVectors + 0, _mm_unpacklo_epi16(grayGrayLo, grayAlphaLo));
+			_mm_storeu_si128(outVectors + 1, _mm_unpackhi_epi16(grayGrayLo, grayAlphaLo));
+			_mm_storeu_si128(outVectors + 2, _mm_unpacklo_epi16(grayGrayHi, grayAlphaHi));
+			_mm_storeu_si128(outVectors + 3, _mm_unpackhi_epi16(grayGrayHi, grayAlphaHi));
+		}
+#else
+		const size_t numVectorPixels = 0;
+#endif
+
+		for (size_t i = numVectorPixels; i < numPixels; i++)
+		{
+			const uint8_t gray = inPtr[i];
+			uint8_t *outPixel = outPtr + i * 4u;
+
+			outPixel[0] = gray;
+			outPixel[1] = gray;
+			outPixel[2] = gray;
+			outPixel[3] = 0xffu;
+		}
+	}
+
+	void ImageKernels::ExpandRGB8ToRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inRGB, RGBChannelOrder inOrder) const
+	{
+		const size_t numPixels = Min(outRGBA.Count() / 4u, inRGB.Count() / 3u);
+
+		uint8_t *outPtr = outRGBA.Ptr();
+		const uint8_t *inPtr = inRGB.Ptr();
+
+		// 3-byte to 4-byte expansion needs a byte shuffle, which SSE2 doesn't have
+		const size_t redIndex = (inOrder == RGBChannelOrder::kBGR) ? 2 : 0;
+		const size_t blueIndex = 2 - redIndex;
+
+		for (size_t i = 0; i < numPixels; i++)
+		{
+			const uint8_t *inPixel = inPtr + i * 3u;
+			uint8_t *outPixel = outPtr + i * 4u;
+
+			outPixel[0] = inPixel[redIndex];
+			outPixel[1] = inPixel[1];
+			outPixel[2] = inPixel[blueIndex];
+			outPixel[3] = 0xffu;
+		}
+	}
+
+	void ImageKernels::SwapRedBlueRGBA8(const Span<uint8_t> &outPixels, const Span<const uint8_t> &inPixels) const
+	{
+		const size_t numPixels = Min(outPixels.Count(), inPixels.Count()) / 4u;
+
+		uint8_t *outPtr = outPixels.Ptr();
+		const uint8_t *inPtr = inPixels.Ptr();
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+		const size_t numVectorPixels = m_allowVector ? (numPixels / 4u * 4u) : 0;
+
+		const __m128i greenAlphaMask = _mm_set1_epi32(static_cast<int>(0xff00ff00u));
+
+		for (size_t startIndex = 0; startIndex < numVectorPixels; startIndex += 4u)
+		{
+			const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inPtr + startIndex * 4u));
+
+			const __m128i greenAlpha = _mm_and_si128(pixels, greenAlphaMask);
+			const __m128i redBlue = _mm_andnot_si128(greenAlphaMask, pixels);
+			const __m128i blueRed = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(outPtr + startIndex * 4u), _mm_or_si128(greenAlpha, blueRed));
+		}
+#else
+		const size_t numVectorPixels = 0;
+#endif
+
+		for (size_t i = numVectorPixels; i < numPixels; i++)
+		{
+			const uint8_t *inPixel = inPtr + i * 4u;
+			uint8_t *outPixel = outPtr + i * 4u;
+
+			const uint8_t red = inPixel[0];
+			const uint8_t blue = inPixel[2];
+
+			outPixel[0] = blue;
+			outPixel[1] = inPixel[1];
+			outPixel[2] = red;
+			outPixel[3] = inPixel[3];
+		}
+	}
+
+	void ImageKernels::PremultiplyAlphaRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inRGBA) const
+	{
+		const size_t numPixels = Min(outRGBA.Count(), inRGBA.Count()) / 4u;
+
+		uint8_t *outPtr = outRGBA.Ptr();
+		const uint8_t *inPtr = inRGBA.Ptr();
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+		const size_t numVectorPixels = m_allowVector ? (numPixels / 4u * 4u) : 0;
+
+		const __m128i zeroVector = _mm_setzero_si128();
+		const __m128i colorMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+		const __m128i alphaMultiplier = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+		const __m128i roundingBias = _mm_set1_epi16(128);
+
+		for (size_t startIndex = 0; startIndex < numVectorPixels; startIndex += 4u)
+		{
+			const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inPtr + startIndex * 4u));
+
+			__m128i results[2];
+			for (int half = 0; half < 2; half++)
+			{
+				const __m128i wide = (half == 0) ? _mm_unpacklo_epi8(pixels, zeroVector) : _mm_unpackhi_epi8(pixels, zeroVector);
+
+				// Alpha is multiplied by 255 so that it passes through the divide unchanged
+				const __m128i alphaBroadcast = _mm_shufflehi_epi16(_mm_shufflelo_epi16(wide, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				const __m128i multiplier = _mm_or_si128(_mm_and_si128(alphaBroadcast, colorMask), alphaMultiplier);
+
+				const __m128i biased = _mm_add_epi16(_mm_mullo_epi16(wide, multiplier), roundingBias);
+				results[half] = _mm_srli_epi16(_mm_add_epi16(biased, _mm_srli_epi16(biased, 8)), 8);
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(outPtr + startIndex * 4u), _mm_packus_epi16(results[0], results[1]));
+		}
+#else
+		const size_t numVectorPixels = 0;
+#endif
+
+		for (size_t i = numVectorPixels; i < numPixels; i++)
+		{
+			const uint8_t *inPixel = inPtr + i * 4u;
+			uint8_t *outPixel = outPtr + i * 4u;
+
+			const uint8_t alpha = inPixel[3];
+
+			outPixel[0] = MulDiv255(inPixel[0], alpha);
+			outPixel[1] = MulDiv255(inPixel[1], alpha);
+			outPixel[2] = MulDiv255(inPixel[2], alpha);
+			outPixel[3] = alpha;
+		}
+	}
+
+	void ImageKernels::DecodeSRGB8ToLinear(const Span<uint16_t> &outLinear, const Span<const uint8_t> &inSRGB) const
+	{
+		const size_t numValues = Min(outLinear.Count(), inSRGB.Count());
+
+		uint16_t *outPtr = outLinear.Ptr();
+		const uint8_t *inPtr = inSRGB.Ptr();
+		const uint16_t *tablePtr = m_srgbToLinearTable.Ptr();
+
+		// Table lookups, there is no gather to vectorize with
+		for (size_t i = 0; i < numValues; i++)
+			outPtr[i] = tablePtr[inPtr[i]];
+	}
+
+	void ImageKernels::EncodeLinearToSRGB8(const Span<uint8_t> &outSRGB, const Span<const uint16_t> &inLinear) const
+	{
+		const size_t numValues = Min(outSRGB.Count(), inLinear.Count());
+
+		uint8_t *outPtr = outSRGB.Ptr();
+		const uint16_t *inPtr = inLinear.Ptr();
+		const uint8_t *tablePtr = m_linearToSRGBTable.Ptr();
+		const size_t maxLinear = m_linearToSRGBTable.Count() - 1u;
+
+		for (size_t i = 0; i < numValues; i++)
+			outPtr[i] = tablePtr[Min<size_t>(inPtr[i], maxLinear)];
+	}
+
+	uint8_t ImageKernels::MulDiv255(uint8_t a, uint8_t b)
+	{
+		// Rounded a*b/255, matches the vector path exactly
+		const uint32_t biased = static_cast<uint32_t>(a) * b + 128u;
+		return static_cast<uint8_t>((biased + (biased >> 8)) >> 8);
+	}
+} } // rkit::utils
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "rkit/Utilities/ImageKernels.h"
+
+#include "rkit/Core/Span.h"
+
+namespace rkit { namespace utils
+{
+	class ImageKernels final : public IImageKernels
+	{
+	public:
+		ImageKernels(bool allowVector, const ConstSpan<uint16_t> &srgbToLinearTable, const ConstSpan<uint8_t> &linearToSRGBTable);
+
+		bool ExpandPalette8ToRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inIndexes, const Span<const uint8_t> &paletteRGBA) const override;
+
+		void ExpandGray8ToRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inGray) const override;
+		void ExpandRGB8ToRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inRGB, RGBChannelOrder inOrder) const override;
+
+		void SwapRedBlueRGBA8(const Span<uint8_t> &outPixels, const Span<const uint8_t> &inPixels) const override;
+
+		void PremultiplyAlphaRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inRGBA) const override;
+
+		void DecodeSRGB8ToLinear(const Span<uint16_t> &outLinear, const Span<const uint8_t> &inSRGB) const override;
+		void EncodeLinearToSRGB8(const Span<uint8_t> &outSRGB, const Span<const uint16_t> &inLinear) const override;
+
+	private:
+		static uint8_t MulDiv255(uint8_t a, uint8_t b);
+
+		bool m_allowVector;
+		ConstSpan<uint16_t> m_srgbToLinearTable;
+		ConstSpan<uint8_t> m_linearToSRGBTable;
+	};
+} } // rkit::utils
@@ -0,0 +1,1728 @@
+#include "ShadowFile.h"
+
+#include "rkit/Core/Algorithm.h"
+#include "rkit/Core/BoolVector.h"
+#include "rkit/Core/Endian.h"
+#include "rkit/Core/FileMapping.h"
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/Span.h"
+#include "rkit/Core/Stream.h"
+#include "rkit/Core/StringView.h"
+#include "rkit/Core/UniquePtr.h"
+#include "rkit/Core/Vector.h"
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace rkit { namespace utils { namespace priv
+{
+	struct ShadowFileLocator
+	{
+		endian::LittleUInt32_t m_extentsSectorListSector;
+		endian::LittleUInt32_t m_extentsTableSize;
+		endian::LittleUInt32_t m_fsRootExtentsStart;
+	};
+
+	struct ShadowFileHeader
+	{
+		uint8_t m_identifier[4];
+		endian::LittleUInt16_t m_version;
+		uint8_t m_sectorSizeBits;
+		ShadowFileLocator m_locators[2];
+		uint8_t m_activeLocator;
+	};
+
+	struct ShadowFileExtentsEntry
+	{
+		endian::LittleUInt32_t m_sector;
+		endian::LittleUInt32_t m_nextExtents;
+	};
+
+	struct ShadowFileTableEntryHeader
+	{
+		uint8_t m_nameLength;
+		uint8_t m_name[255];
+		endian::LittleUInt32_t m_flags;
+		endian::LittleUInt32_t m_extentsStart;
+		endian::LittleUInt64_t m_size;
+	};
+
+	static_assert(sizeof(ShadowFileHeader) == 32, "Shadow file header is the wrong size");
+	static_assert(sizeof(ShadowFileExtentsEntry) == 8, "Shadow file extents entry is the wrong size");
+	static_assert(sizeof(ShadowFileTableEntryHeader) == 272, "Shadow file table entry is the wrong size");
+
+	class ShadowFile final : public ShadowFileBase
+	{
+	public:
+		explicit ShadowFile(UniquePtr<ISeekableReadWriteStream> &&stream);
+		explicit ShadowFile(UniquePtr<IFileMappingView> &&view);
+
+		Result InitializeNew();
+		Result Load();
+
+		Result EntryExists(const StringSliceView &str, bool &outExists) override;
+
+		Result TryOpenFileRead(UniquePtr<ISeekableReadStream> &outStream, const StringSliceView &str) override;
+		Result TryOpenFileReadWrite(UniquePtr<ISeekableReadWriteStream> &outStream, const StringSliceView &str, bool createIfNotExists, bool createDirectories) override;
+
+		Result CopyEntry(const StringSliceView &oldName, const StringSliceView &newName) override;
+		Result MoveEntry(const StringSliceView &oldName, const StringSliceView &newName) override;
+
+		Result DeleteEntry(const StringSliceView &str) override;
+
+		Result CommitChanges() override;
+
+		// Used by file streams.  Streams must be released before the shadow file.
+		Result ReadFileData(uint32_t entryIndex, FilePos_t pos, void *data, size_t size);
+		Result WriteFileData(uint32_t entryIndex, FilePos_t pos, const void *data, size_t size);
+		Result ResizeFile(uint32_t entryIndex, FilePos_t newSize);
+		FilePos_t GetFileSize(uint32_t entryIndex) const;
+
+		void AddStreamRef(uint32_t entryIndex);
+		void RemoveStreamRef(uint32_t entryIndex);
+
+	private:
+		static const uint32_t kFileFlagDirectory = 1;
+		static const uint32_t kNoEntry = 0xffffffffu;
+		static const uint16_t kVersion = 1;
+		static const uint8_t kDefaultSectorSizeBits = 12;
+		static const uint8_t kMinSectorSizeBits = 9;
+		static const uint8_t kMaxSectorSizeBits = 16;
+		static const size_t kMaxNameLength = 254;
+
+		struct ExtentsEntry
+		{
+			uint32_t m_sector = 0;
+			uint32_t m_nextExtents = 0;
+		};
+
+		struct FileEntry
+		{
+			uint8_t m_name[255] = {};
+			uint8_t m_nameLength = 0;
+			uint32_t m_flags = 0;
+			FilePos_t m_size = 0;
+
+			// Always sized to the inline data capacity, zero past the end of the file
+			Vector<uint8_t> m_initialData;
+
+			// Extents table indexes of the sectors after the inline data
+			Vector<uint32_t> m_extents;
+
+			// Child entry indexes of directories, sorted by name
+			Vector<uint32_t> m_children;
+
+			uint32_t m_parent = kNoEntry;
+			uint32_t m_openStreamCount = 0;
+
+			bool m_inUse = false;
+			bool m_dirty = false;
+			bool m_childrenDirty = false;
+		};
+
+		void SetSectorSizeBits(uint8_t sectorSizeBits);
+
+		bool IsReadOnly() const;
+		FilePos_t GetStorageSize() const;
+
+		Result ReadSector(uint32_t sector, size_t offset, void *data, size_t size);
+		Result WriteSector(uint32_t sector, size_t offset, const void *data, size_t size);
+
+		Result AllocSector(uint32_t &outSector);
+		void FreeSector(uint32_t sector);
+		Result AllocReplacementSector(uint32_t oldSector, uint32_t &outSector);
+
+		Result AllocExtentsEntry(uint32_t &outIndex);
+		Result FreeExtentsEntry(uint32_t index);
+		void SetExtentsEntry(uint32_t index, uint32_t sector, uint32_t nextExtents);
+		void RelinkChain(const Vector<uint32_t> &chain);
+
+		Result PrepareDataSectorForWrite(uint32_t extentsIndex, bool fullOverwrite, uint32_t &outSector);
+
+		Result AllocFileEntry(uint32_t &outIndex);
+		Result FreeFileEntry(uint32_t entryIndex);
+
+		Result CreateEntry(uint32_t parentIndex, const StringSliceView &name, uint32_t flags, uint32_t &outIndex);
+		Result ReserveForDelete(uint32_t entryIndex);
+		void CountEntriesForDelete(uint32_t entryIndex, size_t &inOutNumEntries, size_t &inOutNumExtents) const;
+		Result DeleteEntryRecursive(uint32_t entryIndex);
+		bool HasOpenStreams(uint32_t entryIndex) const;
+		Result InsertChild(uint32_t parentIndex, uint32_t childIndex);
+		void RemoveChild(uint32_t parentIndex, uint32_t childIndex);
+
+		Result CheckName(const StringSliceView &name) const;
+		bool FindChild(uint32_t dirIndex, const uint8_t *name, size_t nameLength, uint32_t &outChildIndex, size_t &outInsertPos) const;
+		Result ResolvePath(const StringSliceView &path, bool createDirectories, uint32_t &outParent, StringSliceView &outName, uint32_t &outEntry);
+
+		Result ReadChain(uint32_t start, BoolVector &claimedExtents, Vector<uint32_t> &outChain) const;
+		Result MarkLoadedSector(uint32_t sector);
+
+		Result FlushDirectories();
+		Result SwitchActiveLocator(uint8_t newActiveLocator);
+		void RetainUncommittedSectors();
+
+		static int CompareNames(const uint8_t *nameA, size_t lengthA, const uint8_t *nameB, size_t lengthB);
+
+		UniquePtr<ISeekableReadWriteStream> m_stream;
+
+		// Set instead of the stream when opened read-only from a mapped file
+		UniquePtr<IFileMappingView> m_view;
+
+		ShadowFileHeader m_header;
+		uint8_t m_sectorSizeBits = 0;
+		size_t m_sectorSize = 0;
+		size_t m_inlineDataSize = 0;
+		size_t m_extentsPerPage = 0;
+		size_t m_maxExtentsPages = 0;
+
+		uint32_t m_numSectors = 0;
+		uint32_t m_sectorScanPos = 0;
+		BoolVector m_committedSectors;
+		BoolVector m_workingSectors;
+
+		Vector<ExtentsEntry> m_extentsTable;
+		Vector<uint32_t> m_freeExtents;
+		Vector<uint32_t> m_extentsPageSectors;
+		BoolVector m_dirtyExtentsPages;
+		uint32_t m_extentsSectorListSector = 0;
+
+		Vector<FileEntry> m_fileEntries;
+		Vector<uint32_t> m_fileTableChain;
+		Vector<uint32_t> m_freeFileEntries;
+
+		Vector<uint8_t> m_sectorBuffer;
+		Vector<uint8_t> m_zeroSector;
+	};
+
+	class ShadowFileStream final : public ISeekableReadWriteStream
+	{
+	public:
+		ShadowFileStream(ShadowFile &shadowFile, uint32_t entryIndex, bool writable);
+		~ShadowFileStream();
+
+		Result ReadPartial(void *data, size_t count, size_t &outCountRead) override;
+		Result WritePartial(const void *data, size_t count, size_t &outCountWritten) override;
+		Result Flush() override;
+
+		Result SeekStart(FilePos_t pos) override;
+		Result SeekCurrent(FileOffset_t pos) override;
+		Result SeekEnd(FileOffset_t pos) override;
+
+		FilePos_t Tell() const override;
+		FilePos_t GetSize() const override;
+
+		Result Truncate(FilePos_t size) override;
+
+	private:
+		ShadowFile &m_shadowFile;
+		uint32_t m_entryIndex;
+		FilePos_t m_pos;
+		bool m_writable;
+	};
+
+	ShadowFile::ShadowFile(UniquePtr<ISeekableReadWriteStream> &&stream)
+		: m_stream(std::move(stream))
+		, m_header{}
+	{
+	}
+
+	ShadowFile::ShadowFile(UniquePtr<IFileMappingView> &&view)
+		: m_view(std::move(view))
+		, m_header{}
+	{
+	}
+
+	void ShadowFile::SetSectorSizeBits(uint8_t sectorSizeBits)
+	{
+		m_sectorSizeBits = sectorSizeBits;
+		m_sectorSize = static_cast<size_t>(1) << sectorSizeBits;
+		m_inlineDataSize = m_sectorSize - sizeof(ShadowFileTableEntryHeader);
+		m_extentsPerPage = m_sectorSize / sizeof(ShadowFileExtentsEntry);
+		m_maxExtentsPages = m_sectorSize / sizeof(endian::LittleUInt32_t);
+	}
+
+	bool ShadowFile::IsReadOnly() const
+	{
+		return m_view.IsValid();
+	}
+
+	FilePos_t ShadowFile::GetStorageSize() const
+	{
+		if (m_view.IsValid())
+			return m_view->GetSize();
+
+		return m_stream->GetSize();
+	}
+
+	Result ShadowFile::InitializeNew()
+	{
+		if (IsReadOnly())
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		SetSectorSizeBits(kDefaultSectorSizeBits);
+
+		RKIT_CHECK(m_sectorBuffer.Resize(m_sectorSize));
+		RKIT_CHECK(m_zeroSector.Resize(m_sectorSize));
+		memset(m_zeroSector.GetBuffer(), 0, m_sectorSize);
+
+		m_header = ShadowFileHeader{};
+		m_header.m_identifier[0] = 'R';
+		m_header.m_identifier[1] = 'S';
+		m_header.m_identifier[2] = 'F';
+		m_header.m_identifier[3] = 'S';
+		m_header.m_version = kVersion;
+		m_header.m_sectorSizeBits = m_sectorSizeBits;
+		m_header.m_activeLocator = 0;
+
+		// The header is written as incomplete first, so an interrupted initialization
+		// is detected and redone on the next load.
+		memset(m_sectorBuffer.GetBuffer(), 0, m_sectorSize);
+		memcpy(m_sectorBuffer.GetBuffer(), &m_header, sizeof(m_header));
+
+		RKIT_CHECK(m_stream->Truncate(0));
+		RKIT_CHECK(m_stream->SeekStart(0));
+		RKIT_CHECK(m_stream->WriteAll(m_sectorBuffer.GetBuffer(), m_sectorSize));
+
+		m_committedSectors.Reset();
+		m_workingSectors.Reset();
+		RKIT_CHECK(m_committedSectors.Append(true));
+		RKIT_CHECK(m_workingSectors.Append(true));
+		m_numSectors = 1;
+		m_sectorScanPos = 1;
+
+		m_extentsTable.Reset();
+		m_freeExtents.Reset();
+		m_extentsPageSectors.Reset();
+		m_dirtyExtentsPages.Reset();
+		m_extentsSectorListSector = 0;
+
+		m_fileEntries.Reset();
+		m_fileTableChain.Reset();
+		m_freeFileEntries.Reset();
+
+		uint32_t rootIndex = 0;
+		RKIT_CHECK(AllocFileEntry(rootIndex));
+
+		FileEntry &root = m_fileEntries[rootIndex];
+		root.m_inUse = true;
+		root.m_flags = kFileFlagDirectory;
+		root.m_childrenDirty = true;
+
+		return CommitChanges();
+	}
+
+	Result ShadowFile::Load()
+	{
+		if (GetStorageSize() < sizeof(ShadowFileHeader))
+			RKIT_THROW(ResultCode::kMalformedFile);
+
+		// The sector size isn't known yet, but the header is at the start of sector 0
+		ShadowFileHeader header;
+		RKIT_CHECK(ReadSector(0, 0, &header, sizeof(header)));
+
+		if (header.m_identifier[0] != 'R' || header.m_identifier[1] != 'S' || header.m_identifier[2] != 'F' || header.m_identifier[3] != 'S')
+			RKIT_THROW(ResultCode::kMalformedFile);
+
+		if (header.m_version.Get() != kVersion)
+			RKIT_THROW(ResultCode::kMalformedFile);
+
+		if (header.m_sectorSizeBits < kMinSectorSizeBits || header.m_sectorSizeBits > kMaxSectorSizeBits)
+			RKIT_THROW(ResultCode::kMalformedFile);
+
+		// An interrupted initialization leaves no usable state, and silently reinitializing
+		// would discard the file, so the caller has to decide whether to recreate it.
+		if (header.m_activeLocator == 0 || header.m_activeLocator > 2)
+			RKIT_THROW(ResultCode::kMalformedFile);
+
+		m_header = header;
+		SetSectorSizeBits(header.m_sectorSizeBits);
+
+		RKIT_CHECK(m_sectorBuffer.Resize(m_sectorSize));
+		RKIT_CHECK(m_zeroSector.Resize(m_sectorSize));
+		memset(m_zeroSector.GetBuffer(), 0, m_sectorSize);
+
+		const FilePos_t numSectors = (GetStorageSize() + m_sectorSize - 1u) >> m_sectorSizeBits;
+		if (numSectors > 0xffffffffu)
+			RKIT_THROW(ResultCode::kMalformedFile);
+
+		m_numSectors = static_cast<uint32_t>(numSectors);
+		RKIT_CHECK(m_committedSectors.Resize(m_numSectors));
+		for (uint32_t i = 0; i < m_numSectors; i++)
+			m_committedSectors.Set(i, false);
+		m_committedSectors.Set(0, true);
+
+		const ShadowFileLocator &locator = header.m_locators[header.m_activeLocator - 1];
+		const uint32_t listSector = locator.m_extentsSectorListSector.Get();
+		const uint32_t tableSize = locator.m_extentsTableSize.Get();
+		const uint32_t rootExtentsStart = locator.m_fsRootExtentsStart.Get();
+
+		if (tableSize == 0)
+			RKIT_THROW(ResultCode::kMalformedFile);
+
+		const size_t numPages = (static_cast<size_t>(tableSize) + m_extentsPerPage - 1u) / m_extentsPerPage;
+		if (numPages > m_maxExtentsPages)
+			RKIT_THROW(ResultCode::kMalformedFile);
+
+		// Extents table
+		RKIT_CHECK(MarkLoadedSector(listSector));
+		RKIT_CHECK(ReadSector(listSector, 0, m_sectorBuffer.GetBuffer(), m_sectorSize));
+
+		RKIT_CHECK(m_extentsPageSectors.Resize(numPages));
+		RKIT_CHECK(m_dirtyExtentsPages.Resize(numPages));
+		for (size_t i = 0; i < numPages; i++)
+		{
+			endian::LittleUInt32_t pageSector;
+			memcpy(&pageSector, m_sectorBuffer.GetBuffer() + i * sizeof(pageSector), sizeof(pageSector));
+
+			m_extentsPageSectors[i] = pageSector.Get();
+			m_dirtyExtentsPages.Set(i, false);
+
+			RKIT_CHECK(MarkLoadedSector(pageSector.Get()));
+		}
+
+		RKIT_CHECK(m_extentsTable.Resize(tableSize));
+		for (size_t page = 0; page < numPages; page++)
+		{
+			RKIT_CHECK(ReadSector(m_extentsPageSectors[page], 0, m_sectorBuffer.GetBuffer(), m_sectorSize));
+
+			const size_t firstEntry = page * m_extentsPerPage;
+			const size_t numEntriesInPage = Min<size_t>(m_extentsPerPage, tableSize - firstEntry);
+
+			for (size_t i = 0; i < numEntriesInPage; i++)
+			{
+				ShadowFileExtentsEntry diskEntry;
+				memcpy(&diskEntry, m_sectorBuffer.GetBuffer() + i * sizeof(diskEntry), sizeof(diskEntry));
+
+				ExtentsEntry &entry = m_extentsTable[firstEntry + i];
+				entry.m_sector = diskEntry.m_sector.Get();
+				entry.m_nextExtents = diskEntry.m_nextExtents.Get();
+
+				if (entry.m_nextExtents >= tableSize)
+					RKIT_THROW(ResultCode::kMalformedFile);
+
+				if (entry.m_sector == 0)
+				{
+					RKIT_CHECK(m_freeExtents.Append(static_cast<uint32_t>(firstEntry + i)));
+				}
+				else
+				{
+					RKIT_CHECK(MarkLoadedSector(entry.m_sector));
+				}
+			}
+		}
+
+		m_extentsSectorListSector = listSector;
+
+		BoolVector claimedExtents;
+		RKIT_CHECK(claimedExtents.Resize(tableSize));
+		for (size_t i = 0; i < tableSize; i++)
+			claimedExtents.Set(i, false);
+
+		// File table
+		RKIT_CHECK(ReadChain(rootExtentsStart, claimedExtents, m_fileTableChain));
+
+		RKIT_CHECK(m_fileEntries.Resize(m_fileTableChain.Count()));
+		for (size_t entryIndex = 0; entryIndex < m_fileTableChain.Count(); entryIndex++)
+		{
+			RKIT_CHECK(ReadSector(m_extentsTable[m_fileTableChain[entryIndex]].m_sector, 0, m_sectorBuffer.GetBuffer(), m_sectorSize));
+
+			ShadowFileTableEntryHeader diskEntry;
+			memcpy(&diskEntry, m_sectorBuffer.GetBuffer(), sizeof(diskEntry));
+
+			FileEntry &entry = m_fileEntries[entryIndex];
+			RKIT_CHECK(entry.m_initialData.Resize(m_inlineDataSize));
+			memset(entry.m_initialData.GetBuffer(), 0, m_inlineDataSize);
+
+			if (diskEntry.m_nameLength > kMaxNameLength)
+				RKIT_THROW(ResultCode::kMalformedFile);
+
+			if (diskEntry.m_nameLength == 0 && entryIndex != 0)
+			{
+				RKIT_CHECK(m_freeFileEntries.Append(static_cast<uint32_t>(entryIndex)));
+				continue;
+			}
+
+			entry.m_inUse = true;
+			entry.m_nameLength = diskEntry.m_nameLength;
+			memcpy(entry.m_name, diskEntry.m_name, diskEntry.m_nameLength);
+			entry.m_flags = diskEntry.m_flags.Get();
+			entry.m_size = diskEntry.m_size.Get();
+
+			const size_t inlineSize = static_cast<size_t>(Min<FilePos_t>(entry.m_size, m_inlineDataSize));
+			memcpy(entry.m_initialData.GetBuffer(), m_sectorBuffer.GetBuffer() + sizeof(diskEntry), inlineSize);
+
+			if (entry.m_size > m_inlineDataSize)
+			{
+				const FilePos_t expectedChainLength = (entry.m_size - m_inlineDataSize + m_sectorSize - 1u) >> m_sectorSizeBits;
+
+				RKIT_CHECK(ReadChain(diskEntry.m_extentsStart.Get(), claimedExtents, entry.m_extents));
+
+				if (entry.m_extents.Count() != expectedChainLength)
+					RKIT_THROW(ResultCode::kMalformedFile);
+			}
+		}
+
+		for (size_t i = 0; i < tableSize; i++)
+		{
+			if (m_extentsTable[i].m_sector != 0 && !claimedExtents[i])
+				RKIT_THROW(ResultCode::kMalformedFile);
+		}
+
+		if (!m_fileEntries[0].m_inUse || (m_fileEntries[0].m_flags & kFileFlagDirectory) == 0)
+			RKIT_THROW(ResultCode::kMalformedFile);
+
+		// Directory contents
+		Vector<endian::LittleUInt32_t> childList;
+		for (size_t dirIndex = 0; dirIndex < m_fileEntries.Count(); dirIndex++)
+		{
+			FileEntry &dir = m_fileEntries[dirIndex];
+			if (!dir.m_inUse || (dir.m_flags & kFileFlagDirectory) == 0)
+				continue;
+
+			if (dir.m_size % sizeof(endian::LittleUInt32_t) != 0)
+				RKIT_THROW(ResultCode::kMalformedFile);
+
+			const size_t numChildren = static_cast<size_t>(dir.m_size / sizeof(endian::LittleUInt32_t));
+
+			RKIT_CHECK(childList.Resize(numChildren));
+			RKIT_CHECK(ReadFileData(static_cast<uint32_t>(dirIndex), 0, childList.GetBuffer(), numChildren * sizeof(endian::LittleUInt32_t)));
+
+			RKIT_CHECK(dir.m_children.Resize(numChildren));
+			for (size_t i = 0; i < numChildren; i++)
+			{
+				const uint32_t childIndex = childList[i].Get();
+				if (childIndex == 0 || childIndex >= m_fileEntries.Count())
+					RKIT_THROW(ResultCode::kMalformedFile);
+
+				FileEntry &child = m_fileEntries[childIndex];
+				if (!child.m_inUse || child.m_parent != kNoEntry)
+					RKIT_THROW(ResultCode::kMalformedFile);
+
+				if (i > 0)
+				{
+					const FileEntry &prevChild = m_fileEntries[dir.m_children[i - 1]];
+					if (CompareNames(prevChild.m_name, prevChild.m_nameLength, child.m_name, child.m_nameLength) >= 0)
+						RKIT_THROW(ResultCode::kMalformedFile);
+				}
+
+				child.m_parent = static_cast<uint32_t>(dirIndex);
+				dir.m_children[i] = childIndex;
+			}
+		}
+
+		for (size_t entryIndex = 1; entryIndex < m_fileEntries.Count(); entryIndex++)
+		{
+			const FileEntry &entry = m_fileEntries[entryIndex];
+			if (entry.m_inUse && entry.m_parent == kNoEntry)
+				RKIT_THROW(ResultCode::kMalformedFile);
+		}
+
+		RKIT_CHECK(m_workingSectors.Duplicate(m_committedSectors));
+		m_sectorScanPos = 1;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::ReadChain(uint32_t start, BoolVector &claimedExtents, Vector<uint32_t> &outChain) const
+	{
+		outChain.Reset();
+
+		uint32_t current = start;
+		do
+		{
+			if (current >= m_extentsTable.Count() || claimedExtents[current] || m_extentsTable[current].m_sector == 0)
+				RKIT_THROW(ResultCode::kMalformedFile);
+
+			claimedExtents.Set(current, true);
+			RKIT_CHECK(outChain.Append(current));
+
+			current = m_extentsTable[current].m_nextExtents;
+		} while (current != start);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::MarkLoadedSector(uint32_t sector)
+	{
+		// Every sector is owned by exactly one structure, so a sector that's
+		// referenced twice means the file is corrupt.
+		if (sector == 0 || sector >= m_numSectors || m_committedSectors[sector])
+			RKIT_THROW(ResultCode::kMalformedFile);
+
+		m_committedSectors.Set(sector, true);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::ReadSector(uint32_t sector, size_t offset, void *data, size_t size)
+	{
+		if (m_view.IsValid())
+		{
+			// The last sector of the file can be partial, so this has to check the exact range
+			const FilePos_t pos = (static_cast<FilePos_t>(sector) << m_sectorSizeBits) + offset;
+			const size_t viewSize = m_view->GetSize();
+			if (pos > viewSize || size > viewSize - pos)
+				RKIT_THROW(ResultCode::kIOReadError);
+
+			memcpy(data, static_cast<const uint8_t *>(m_view->GetData()) + pos, size);
+			RKIT_RETURN_OK;
+		}
+
+		RKIT_CHECK(m_stream->SeekStart((static_cast<FilePos_t>(sector) << m_sectorSizeBits) + offset));
+		return m_stream->ReadAll(data, size);
+	}
+
+	Result ShadowFile::WriteSector(uint32_t sector, size_t offset, const void *data, size_t size)
+	{
+		RKIT_CHECK(m_stream->SeekStart((static_cast<FilePos_t>(sector) << m_sectorSizeBits) + offset));
+		return m_stream->WriteAll(data, size);
+	}
+
+	Result ShadowFile::AllocSector(uint32_t &outSector)
+	{
+		// Sectors that are part of the committed state can't be reused until the
+		// next commit, even if they've been released from the working state.
+		while (m_sectorScanPos < m_numSectors)
+		{
+			const uint32_t sector = m_sectorScanPos++;
+			if (!m_committedSectors[sector] && !m_workingSectors[sector])
+			{
+				m_workingSectors.Set(sector, true);
+				outSector = sector;
+				RKIT_RETURN_OK;
+			}
+		}
+
+		if (m_numSectors == 0xffffffffu)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		// The base stream can't seek past its end, so it has to be extended to cover the new
+		// sector before anything is written to it.  The last sector can be partial, so this
+		// fills from the current end of the stream rather than from the sector start.
+		const FilePos_t sectorEnd = (static_cast<FilePos_t>(m_numSectors) + 1u) << m_sectorSizeBits;
+		FilePos_t streamSize = m_stream->GetSize();
+		if (streamSize < sectorEnd)
+		{
+			RKIT_CHECK(m_stream->SeekEnd(0));
+
+			while (streamSize < sectorEnd)
+			{
+				const size_t fillSize = static_cast<size_t>(Min<FilePos_t>(sectorEnd - streamSize, m_sectorSize));
+				RKIT_CHECK(m_stream->WriteAll(m_zeroSector.GetBuffer(), fillSize));
+				streamSize += fillSize;
+			}
+		}
+
+		RKIT_CHECK(m_committedSectors.Append(false));
+		RKIT_CHECK(m_workingSectors.Append(true));
+
+		outSector = m_numSectors++;
+		m_sectorScanPos = m_numSectors;
+
+		RKIT_RETURN_OK;
+	}
+
+	void ShadowFile::FreeSector(uint32_t sector)
+	{
+		m_workingSectors.Set(sector, false);
+
+		if (!m_committedSectors[sector] && sector < m_sectorScanPos)
+			m_sectorScanPos = sector;
+	}
+
+	Result ShadowFile::AllocReplacementSector(uint32_t oldSector, uint32_t &outSector)
+	{
+		if (oldSector != 0 && !m_committedSectors[oldSector])
+		{
+			outSector = oldSector;
+			RKIT_RETURN_OK;
+		}
+
+		RKIT_CHECK(AllocSector(outSector));
+
+		if (oldSector != 0)
+			FreeSector(oldSector);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::AllocExtentsEntry(uint32_t &outIndex)
+	{
+		if (m_freeExtents.Count() > 0)
+		{
+			outIndex = m_freeExtents[m_freeExtents.Count() - 1];
+			m_freeExtents.ShrinkToSize(m_freeExtents.Count() - 1);
+			RKIT_RETURN_OK;
+		}
+
+		const size_t newIndex = m_extentsTable.Count();
+		if (newIndex % m_extentsPerPage == 0)
+		{
+			if (m_extentsPageSectors.Count() == m_maxExtentsPages)
+				RKIT_THROW(ResultCode::kOperationFailed);
+
+			RKIT_CHECK(m_extentsPageSectors.Append(0));
+			RKIT_CHECK(m_dirtyExtentsPages.Append(true));
+		}
+
+		RKIT_CHECK(m_extentsTable.Append(ExtentsEntry()));
+
+		outIndex = static_cast<uint32_t>(newIndex);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::FreeExtentsEntry(uint32_t index)
+	{
+		RKIT_CHECK(m_freeExtents.Append(index));
+
+		SetExtentsEntry(index, 0, 0);
+
+		RKIT_RETURN_OK;
+	}
+
+	void ShadowFile::SetExtentsEntry(uint32_t index, uint32_t sector, uint32_t nextExtents)
+	{
+		ExtentsEntry &entry = m_extentsTable[index];
+		if (entry.m_sector == sector && entry.m_nextExtents == nextExtents)
+			return;
+
+		entry.m_sector = sector;
+		entry.m_nextExtents = nextExtents;
+
+		m_dirtyExtentsPages.Set(index / m_extentsPerPage, true);
+	}
+
+	void ShadowFile::RelinkChain(const Vector<uint32_t> &chain)
+	{
+		const size_t chainLength = chain.Count();
+		for (size_t i = 0; i < chainLength; i++)
+		{
+			const uint32_t extentsIndex = chain[i];
+			SetExtentsEntry(extentsIndex, m_extentsTable[extentsIndex].m_sector, chain[(i + 1) % chainLength]);
+		}
+	}
+
+	Result ShadowFile::PrepareDataSectorForWrite(uint32_t extentsIndex, bool fullOverwrite, uint32_t &outSector)
+	{
+		const ExtentsEntry &extents = m_extentsTable[extentsIndex];
+		const uint32_t oldSector = extents.m_sector;
+
+		uint32_t newSector = 0;
+		RKIT_CHECK(AllocReplacementSector(oldSector, newSector));
+
+		if (newSector != oldSector)
+		{
+			if (!fullOverwrite)
+			{
+				RKIT_CHECK(ReadSector(oldSector, 0, m_sectorBuffer.GetBuffer(), m_sectorSize));
+				RKIT_CHECK(WriteSector(newSector, 0, m_sectorBuffer.GetBuffer(), m_sectorSize));
+			}
+
+			SetExtentsEntry(extentsIndex, newSector, extents.m_nextExtents);
+		}
+
+		outSector = newSector;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::AllocFileEntry(uint32_t &outIndex)
+	{
+		if (m_freeFileEntries.Count() > 0)
+		{
+			outIndex = m_freeFileEntries[m_freeFileEntries.Count() - 1];
+			m_freeFileEntries.ShrinkToSize(m_freeFileEntries.Count() - 1);
+			m_fileEntries[outIndex].m_dirty = true;
+			RKIT_RETURN_OK;
+		}
+
+		FileEntry newEntry;
+		RKIT_CHECK(newEntry.m_initialData.Resize(m_inlineDataSize));
+		memset(newEntry.m_initialData.GetBuffer(), 0, m_inlineDataSize);
+		newEntry.m_dirty = true;
+
+		RKIT_CHECK(m_fileEntries.Reserve(m_fileEntries.Count() + 1));
+		RKIT_CHECK(m_fileTableChain.Reserve(m_fileTableChain.Count() + 1));
+
+		uint32_t sector = 0;
+		RKIT_CHECK(AllocSector(sector));
+
+		uint32_t extentsIndex = 0;
+		RKIT_CHECK(AllocExtentsEntry(extentsIndex));
+
+		SetExtentsEntry(extentsIndex, sector, extentsIndex);
+
+		RKIT_CHECK(m_fileTableChain.Append(extentsIndex));
+		RelinkChain(m_fileTableChain);
+
+		outIndex = static_cast<uint32_t>(m_fileEntries.Count());
+		RKIT_CHECK(m_fileEntries.Append(std::move(newEntry)));
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::FreeFileEntry(uint32_t entryIndex)
+	{
+		RKIT_CHECK(m_freeFileEntries.Reserve(m_freeFileEntries.Count() + 1));
+		RKIT_CHECK(ResizeFile(entryIndex, 0));
+
+		FileEntry &entry = m_fileEntries[entryIndex];
+		memset(entry.m_name, 0, sizeof(entry.m_name));
+		entry.m_nameLength = 0;
+		entry.m_flags = 0;
+		entry.m_children.Reset();
+		entry.m_parent = kNoEntry;
+		entry.m_inUse = false;
+		entry.m_dirty = true;
+		entry.m_childrenDirty = false;
+
+		return m_freeFileEntries.Append(entryIndex);
+	}
+
+	Result ShadowFile::CreateEntry(uint32_t parentIndex, const StringSliceView &name, uint32_t flags, uint32_t &outIndex)
+	{
+		// Reserve first so that nothing can fail after the entry is allocated
+		Vector<uint32_t> &siblings = m_fileEntries[parentIndex].m_children;
+		RKIT_CHECK(siblings.Reserve(siblings.Count() + 1));
+
+		uint32_t entryIndex = 0;
+		RKIT_CHECK(AllocFileEntry(entryIndex));
+
+		FileEntry &entry = m_fileEntries[entryIndex];
+		entry.m_nameLength = static_cast<uint8_t>(name.Length());
+		memcpy(entry.m_name, name.GetChars(), name.Length());
+		entry.m_flags = flags;
+		entry.m_size = 0;
+		entry.m_inUse = true;
+		entry.m_childrenDirty = ((flags & kFileFlagDirectory) != 0);
+
+		RKIT_CHECK(InsertChild(parentIndex, entryIndex));
+
+		outIndex = entryIndex;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::InsertChild(uint32_t parentIndex, uint32_t childIndex)
+	{
+		FileEntry &child = m_fileEntries[childIndex];
+
+		uint32_t existingIndex = kNoEntry;
+		size_t insertPos = 0;
+		if (FindChild(parentIndex, child.m_name, child.m_nameLength, existingIndex, insertPos))
+			RKIT_THROW(ResultCode::kInternalError);
+
+		FileEntry &parent = m_fileEntries[parentIndex];
+		RKIT_CHECK(parent.m_children.InsertAt(insertPos, childIndex));
+
+		parent.m_childrenDirty = true;
+		child.m_parent = parentIndex;
+
+		RKIT_RETURN_OK;
+	}
+
+	void ShadowFile::RemoveChild(uint32_t parentIndex, uint32_t childIndex)
+	{
+		FileEntry &child = m_fileEntries[childIndex];
+
+		uint32_t existingIndex = kNoEntry;
+		size_t pos = 0;
+		if (FindChild(parentIndex, child.m_name, child.m_nameLength, existingIndex, pos))
+		{
+			FileEntry &parent = m_fileEntries[parentIndex];
+			parent.m_children.RemoveAtIndex(pos);
+			parent.m_childrenDirty = true;
+		}
+
+		child.m_parent = kNoEntry;
+	}
+
+	Result ShadowFile::ReserveForDelete(uint32_t entryIndex)
+	{
+		size_t numEntries = 0;
+		size_t numExtents = 0;
+		CountEntriesForDelete(entryIndex, numEntries, numExtents);
+
+		RKIT_CHECK(m_freeFileEntries.Reserve(m_freeFileEntries.Count() + numEntries));
+		RKIT_CHECK(m_freeExtents.Reserve(m_freeExtents.Count() + numExtents));
+
+		RKIT_RETURN_OK;
+	}
+
+	void ShadowFile::CountEntriesForDelete(uint32_t entryIndex, size_t &inOutNumEntries, size_t &inOutNumExtents) const
+	{
+		const FileEntry &entry = m_fileEntries[entryIndex];
+
+		inOutNumEntries++;
+		inOutNumExtents += entry.m_extents.Count();
+
+		for (uint32_t childIndex : entry.m_children)
+			CountEntriesForDelete(childIndex, inOutNumEntries, inOutNumExtents);
+	}
+
+	Result ShadowFile::DeleteEntryRecursive(uint32_t entryIndex)
+	{
+		// Free lists must already be reserved with ReserveForDelete, so that a
+		// subtree is never left partially deleted.
+		FileEntry &entry = m_fileEntries[entryIndex];
+		for (uint32_t childIndex : entry.m_children)
+		{
+			RKIT_CHECK(DeleteEntryRecursive(childIndex));
+		}
+
+		return FreeFileEntry(entryIndex);
+	}
+
+	bool ShadowFile::HasOpenStreams(uint32_t entryIndex) const
+	{
+		const FileEntry &entry = m_fileEntries[entryIndex];
+		if (entry.m_openStreamCount > 0)
+			return true;
+
+		for (uint32_t childIndex : entry.m_children)
+		{
+			if (HasOpenStreams(childIndex))
+				return true;
+		}
+
+		return false;
+	}
+
+	int ShadowFile::CompareNames(const uint8_t *nameA, size_t lengthA, const uint8_t *nameB, size_t lengthB)
+	{
+		const int cmp = memcmp(nameA, nameB, Min(lengthA, lengthB));
+		if (cmp != 0)
+			return cmp;
+
+		if (lengthA < lengthB)
+			return -1;
+		if (lengthA > lengthB)
+			return 1;
+
+		return 0;
+	}
+
+	bool ShadowFile::FindChild(uint32_t dirIndex, const uint8_t *name, size_t nameLength, uint32_t &outChildIndex, size_t &outInsertPos) const
+	{
+		const Vector<uint32_t> &children = m_fileEntries[dirIndex].m_children;
+
+		size_t low = 0;
+		size_t high = children.Count();
+		while (low < high)
+		{
+			const size_t mid = low + (high - low) / 2;
+			const FileEntry &child = m_fileEntries[children[mid]];
+
+			const int cmp = CompareNames(child.m_name, child.m_nameLength, name, nameLength);
+			if (cmp == 0)
+			{
+				outChildIndex = children[mid];
+				outInsertPos = mid;
+				return true;
+			}
+
+			if (cmp < 0)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+
+		outChildIndex = kNoEntry;
+		outInsertPos = low;
+		return false;
+	}
+
+	Result ShadowFile::CheckName(const StringSliceView &name) const
+	{
+		if (name.Length() == 0 || name.Length() > kMaxNameLength)
+			RKIT_THROW(ResultCode::kInvalidPath);
+
+		for (size_t i = 0; i < name.Length(); i++)
+		{
+			if (name[i] == 0)
+				RKIT_THROW(ResultCode::kInvalidPath);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::ResolvePath(const StringSliceView &path, bool createDirectories, uint32_t &outParent, StringSliceView &outName, uint32_t &outEntry)
+	{
+		uint32_t dirIndex = 0;
+		size_t componentStart = 0;
+
+		for (;;)
+		{
+			size_t componentEnd = componentStart;
+			while (componentEnd < path.Length() && path[componentEnd] != '/')
+				componentEnd++;
+
+			const StringSliceView name = path.SubString(componentStart, componentEnd - componentStart);
+			RKIT_CHECK(CheckName(name));
+
+			const uint8_t *nameBytes = reinterpret_cast<const uint8_t *>(name.GetChars());
+
+			uint32_t childIndex = kNoEntry;
+			size_t insertPos = 0;
+			const bool found = FindChild(dirIndex, nameBytes, name.Length(), childIndex, insertPos);
+
+			if (componentEnd == path.Length())
+			{
+				outParent = dirIndex;
+				outName = name;
+				outEntry = childIndex;
+				RKIT_RETURN_OK;
+			}
+
+			if (!found)
+			{
+				if (!createDirectories)
+				{
+					outParent = kNoEntry;
+					outEntry = kNoEntry;
+					RKIT_RETURN_OK;
+				}
+
+				RKIT_CHECK(CreateEntry(dirIndex, name, kFileFlagDirectory, childIndex));
+			}
+			else if ((m_fileEntries[childIndex].m_flags & kFileFlagDirectory) == 0)
+			{
+				if (createDirectories)
+					RKIT_THROW(ResultCode::kOperationFailed);
+
+				outParent = kNoEntry;
+				outEntry = kNoEntry;
+				RKIT_RETURN_OK;
+			}
+
+			dirIndex = childIndex;
+			componentStart = componentEnd + 1;
+		}
+	}
+
+	Result ShadowFile::EntryExists(const StringSliceView &str, bool &outExists)
+	{
+		uint32_t parentIndex = kNoEntry;
+		uint32_t entryIndex = kNoEntry;
+		StringSliceView name;
+		RKIT_CHECK(ResolvePath(str, false, parentIndex, name, entryIndex));
+
+		outExists = (entryIndex != kNoEntry);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::TryOpenFileRead(UniquePtr<ISeekableReadStream> &outStream, const StringSliceView &str)
+	{
+		outStream.Reset();
+
+		uint32_t parentIndex = kNoEntry;
+		uint32_t entryIndex = kNoEntry;
+		StringSliceView name;
+		RKIT_CHECK(ResolvePath(str, false, parentIndex, name, entryIndex));
+
+		if (entryIndex == kNoEntry)
+			RKIT_RETURN_OK;
+
+		if (m_fileEntries[entryIndex].m_flags & kFileFlagDirectory)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		return New<ShadowFileStream>(outStream, *this, entryIndex, false);
+	}
+
+	Result ShadowFile::TryOpenFileReadWrite(UniquePtr<ISeekableReadWriteStream> &outStream, const StringSliceView &str, bool createIfNotExists, bool createDirectories)
+	{
+		outStream.Reset();
+
+		uint32_t parentIndex = kNoEntry;
+		uint32_t entryIndex = kNoEntry;
+		StringSliceView name;
+		if (IsReadOnly())
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		RKIT_CHECK(ResolvePath(str, createIfNotExists && createDirectories, parentIndex, name, entryIndex));
+
+		if (entryIndex == kNoEntry)
+		{
+			if (!createIfNotExists || parentIndex == kNoEntry)
+				RKIT_RETURN_OK;
+
+			RKIT_CHECK(CreateEntry(parentIndex, name, 0, entryIndex));
+		}
+
+		if (m_fileEntries[entryIndex].m_flags & kFileFlagDirectory)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		return New<ShadowFileStream>(outStream, *this, entryIndex, true);
+	}
+
+	Result ShadowFile::CopyEntry(const StringSliceView &oldName, const StringSliceView &newName)
+	{
+		if (IsReadOnly())
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		uint32_t srcParent = kNoEntry;
+		uint32_t srcIndex = kNoEntry;
+		StringSliceView srcName;
+		RKIT_CHECK(ResolvePath(oldName, false, srcParent, srcName, srcIndex));
+
+		if (srcIndex == kNoEntry)
+			RKIT_THROW(ResultCode::kKeyNotFound);
+
+		if (m_fileEntries[srcIndex].m_flags & kFileFlagDirectory)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		uint32_t destParent = kNoEntry;
+		uint32_t destIndex = kNoEntry;
+		StringSliceView destName;
+		RKIT_CHECK(ResolvePath(newName, false, destParent, destName, destIndex));
+
+		if (destIndex == srcIndex)
+			RKIT_RETURN_OK;
+
+		if (destIndex == kNoEntry)
+		{
+			if (destParent == kNoEntry)
+				RKIT_THROW(ResultCode::kInvalidPath);
+
+			RKIT_CHECK(CreateEntry(destParent, destName, 0, destIndex));
+		}
+		else
+		{
+			const FileEntry &destEntry = m_fileEntries[destIndex];
+			if ((destEntry.m_flags & kFileFlagDirectory) || destEntry.m_openStreamCount > 0)
+				RKIT_THROW(ResultCode::kOperationFailed);
+
+			RKIT_CHECK(ResizeFile(destIndex, 0));
+		}
+
+		const FilePos_t size = m_fileEntries[srcIndex].m_size;
+
+		Vector<uint8_t> copyBuffer;
+		RKIT_CHECK(copyBuffer.Resize(m_sectorSize));
+
+		FilePos_t pos = 0;
+		while (pos < size)
+		{
+			const size_t chunkSize = static_cast<size_t>(Min<FilePos_t>(size - pos, m_sectorSize));
+
+			RKIT_CHECK(ReadFileData(srcIndex, pos, copyBuffer.GetBuffer(), chunkSize));
+			RKIT_CHECK(ResizeFile(destIndex, pos + chunkSize));
+			RKIT_CHECK(WriteFileData(destIndex, pos, copyBuffer.GetBuffer(), chunkSize));
+
+			pos += chunkSize;
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::MoveEntry(const StringSliceView &oldName, const StringSliceView &newName)
+	{
+		if (IsReadOnly())
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		uint32_t srcParent = kNoEntry;
+		uint32_t srcIndex = kNoEntry;
+		StringSliceView srcName;
+		RKIT_CHECK(ResolvePath(oldName, false, srcParent, srcName, srcIndex));
+
+		if (srcIndex == kNoEntry)
+			RKIT_THROW(ResultCode::kKeyNotFound);
+
+		uint32_t destParent = kNoEntry;
+		uint32_t destIndex = kNoEntry;
+		StringSliceView destName;
+		RKIT_CHECK(ResolvePath(newName, false, destParent, destName, destIndex));
+
+		if (destParent == kNoEntry)
+			RKIT_THROW(ResultCode::kInvalidPath);
+
+		if (destIndex == srcIndex)
+			RKIT_RETURN_OK;
+
+		const bool srcIsDirectory = ((m_fileEntries[srcIndex].m_flags & kFileFlagDirectory) != 0);
+
+		// A directory can't be moved into itself
+		if (srcIsDirectory)
+		{
+			for (uint32_t ancestor = destParent; ancestor != kNoEntry; ancestor = m_fileEntries[ancestor].m_parent)
+			{
+				if (ancestor == srcIndex)
+					RKIT_THROW(ResultCode::kInvalidParameter);
+			}
+		}
+
+		if (destIndex != kNoEntry)
+		{
+			const FileEntry &destEntry = m_fileEntries[destIndex];
+			if (srcIsDirectory || (destEntry.m_flags & kFileFlagDirectory) || destEntry.m_openStreamCount > 0)
+				RKIT_THROW(ResultCode::kOperationFailed);
+		}
+
+		RKIT_CHECK(m_fileEntries[destParent].m_children.Reserve(m_fileEntries[destParent].m_children.Count() + 1));
+
+		if (destIndex != kNoEntry)
+		{
+			RKIT_CHECK(ReserveForDelete(destIndex));
+
+			RemoveChild(destParent, destIndex);
+			RKIT_CHECK(DeleteEntryRecursive(destIndex));
+		}
+
+		RemoveChild(srcParent, srcIndex);
+
+		FileEntry &entry = m_fileEntries[srcIndex];
+		memset(entry.m_name, 0, sizeof(entry.m_name));
+		memcpy(entry.m_name, destName.GetChars(), destName.Length());
+		entry.m_nameLength = static_cast<uint8_t>(destName.Length());
+		entry.m_dirty = true;
+
+		// Can't fail, space was reserved above
+		return InsertChild(destParent, srcIndex);
+	}
+
+	Result ShadowFile::DeleteEntry(const StringSliceView &str)
+	{
+		if (IsReadOnly())
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		uint32_t parentIndex = kNoEntry;
+		uint32_t entryIndex = kNoEntry;
+		StringSliceView name;
+		RKIT_CHECK(ResolvePath(str, false, parentIndex, name, entryIndex));
+
+		if (entryIndex == kNoEntry)
+			RKIT_THROW(ResultCode::kKeyNotFound);
+
+		if (HasOpenStreams(entryIndex))
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		RKIT_CHECK(ReserveForDelete(entryIndex));
+
+		RemoveChild(parentIndex, entryIndex);
+		return DeleteEntryRecursive(entryIndex);
+	}
+
+	Result ShadowFile::ReadFileData(uint32_t entryIndex, FilePos_t pos, void *data, size_t size)
+	{
+		const FileEntry &entry = m_fileEntries[entryIndex];
+		uint8_t *bytes = static_cast<uint8_t *>(data);
+
+		if (size > entry.m_size || pos > entry.m_size - size)
+			RKIT_THROW(ResultCode::kIOReadError);
+
+		if (pos < m_inlineDataSize && size > 0)
+		{
+			const size_t inlineSize = static_cast<size_t>(Min<FilePos_t>(size, m_inlineDataSize - pos));
+			memcpy(bytes, entry.m_initialData.GetBuffer() + pos, inlineSize);
+
+			bytes += inlineSize;
+			pos += inlineSize;
+			size -= inlineSize;
+		}
+
+		while (size > 0)
+		{
+			const FilePos_t dataPos = pos - m_inlineDataSize;
+			const size_t chainIndex = static_cast<size_t>(dataPos >> m_sectorSizeBits);
+			const size_t offset = static_cast<size_t>(dataPos & (m_sectorSize - 1u));
+			const size_t chunkSize = Min(size, m_sectorSize - offset);
+
+			RKIT_CHECK(ReadSector(m_extentsTable[entry.m_extents[chainIndex]].m_sector, offset, bytes, chunkSize));
+
+			bytes += chunkSize;
+			pos += chunkSize;
+			size -= chunkSize;
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::WriteFileData(uint32_t entryIndex, FilePos_t pos, const void *data, size_t size)
+	{
+		FileEntry &entry = m_fileEntries[entryIndex];
+		const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+		if (size > entry.m_size || pos > entry.m_size - size)
+			RKIT_THROW(ResultCode::kIOWriteError);
+
+		if (pos < m_inlineDataSize && size > 0)
+		{
+			const size_t inlineSize = static_cast<size_t>(Min<FilePos_t>(size, m_inlineDataSize - pos));
+			memcpy(entry.m_initialData.GetBuffer() + pos, bytes, inlineSize);
+			entry.m_dirty = true;
+
+			bytes += inlineSize;
+			pos += inlineSize;
+			size -= inlineSize;
+		}
+
+		while (size > 0)
+		{
+			const FilePos_t dataPos = pos - m_inlineDataSize;
+			const size_t chainIndex = static_cast<size_t>(dataPos >> m_sectorSizeBits);
+			const size_t offset = static_cast<size_t>(dataPos & (m_sectorSize - 1u));
+			const size_t chunkSize = Min(size, m_sectorSize - offset);
+
+			uint32_t sector = 0;
+			RKIT_CHECK(PrepareDataSectorForWrite(entry.m_extents[chainIndex], chunkSize == m_sectorSize, sector));
+			RKIT_CHECK(WriteSector(sector, offset, bytes, chunkSize));
+
+			bytes += chunkSize;
+			pos += chunkSize;
+			size -= chunkSize;
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::ResizeFile(uint32_t entryIndex, FilePos_t newSize)
+	{
+		FileEntry &entry = m_fileEntries[entryIndex];
+		const FilePos_t oldSize = entry.m_size;
+
+		if (newSize == oldSize)
+			RKIT_RETURN_OK;
+
+		FilePos_t chainLength = 0;
+		if (newSize > m_inlineDataSize)
+			chainLength = (newSize - m_inlineDataSize + m_sectorSize - 1u) >> m_sectorSizeBits;
+
+		if (chainLength > m_maxExtentsPages * m_extentsPerPage)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		const size_t oldChainLength = entry.m_extents.Count();
+
+		if (newSize < oldSize)
+		{
+			// Reserve first so that the chain can't be left partially freed
+			RKIT_CHECK(m_freeExtents.Reserve(m_freeExtents.Count() + oldChainLength - static_cast<size_t>(chainLength)));
+
+			while (entry.m_extents.Count() > chainLength)
+			{
+				const uint32_t extentsIndex = entry.m_extents[entry.m_extents.Count() - 1];
+				const uint32_t sector = m_extentsTable[extentsIndex].m_sector;
+
+				RKIT_CHECK(FreeExtentsEntry(extentsIndex));
+				FreeSector(sector);
+
+				entry.m_extents.ShrinkToSize(entry.m_extents.Count() - 1);
+			}
+
+			if (entry.m_extents.Count() != oldChainLength)
+				RelinkChain(entry.m_extents);
+
+			if (newSize < m_inlineDataSize)
+			{
+				const size_t clearEnd = static_cast<size_t>(Min<FilePos_t>(oldSize, m_inlineDataSize));
+				memset(entry.m_initialData.GetBuffer() + newSize, 0, clearEnd - static_cast<size_t>(newSize));
+			}
+
+			entry.m_size = newSize;
+			entry.m_dirty = true;
+
+			RKIT_RETURN_OK;
+		}
+
+		RKIT_CHECK(entry.m_extents.Reserve(static_cast<size_t>(chainLength)));
+
+		// Reused sectors may contain stale data, so new sectors are zero-filled in full.
+		while (entry.m_extents.Count() < chainLength)
+		{
+			uint32_t sector = 0;
+			RKIT_CHECK(AllocSector(sector));
+
+			uint32_t extentsIndex = 0;
+			RKIT_CHECK(AllocExtentsEntry(extentsIndex));
+
+			SetExtentsEntry(extentsIndex, sector, extentsIndex);
+			RKIT_CHECK(entry.m_extents.Append(extentsIndex));
+
+			RKIT_CHECK(WriteSector(sector, 0, m_zeroSector.GetBuffer(), m_sectorSize));
+		}
+
+		if (entry.m_extents.Count() != oldChainLength)
+			RelinkChain(entry.m_extents);
+
+		entry.m_size = newSize;
+		entry.m_dirty = true;
+
+		// The tail of the previous last sector may hold data from before a
+		// truncation, so it has to be cleared.  Inline data is always zero past
+		// the end of the file.
+		const FilePos_t oldCapacity = m_inlineDataSize + (static_cast<FilePos_t>(oldChainLength) << m_sectorSizeBits);
+		FilePos_t clearPos = Max<FilePos_t>(oldSize, m_inlineDataSize);
+		const FilePos_t clearEnd = Min(newSize, oldCapacity);
+
+		while (clearPos < clearEnd)
+		{
+			const size_t chunkSize = static_cast<size_t>(Min<FilePos_t>(clearEnd - clearPos, m_sectorSize));
+			RKIT_CHECK(WriteFileData(entryIndex, clearPos, m_zeroSector.GetBuffer(), chunkSize));
+			clearPos += chunkSize;
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	FilePos_t ShadowFile::GetFileSize(uint32_t entryIndex) const
+	{
+		return m_fileEntries[entryIndex].m_size;
+	}
+
+	void ShadowFile::AddStreamRef(uint32_t entryIndex)
+	{
+		m_fileEntries[entryIndex].m_openStreamCount++;
+	}
+
+	void ShadowFile::RemoveStreamRef(uint32_t entryIndex)
+	{
+		m_fileEntries[entryIndex].m_openStreamCount--;
+	}
+
+	Result ShadowFile::FlushDirectories()
+	{
+		Vector<endian::LittleUInt32_t> childList;
+
+		for (size_t dirIndex = 0; dirIndex < m_fileEntries.Count(); dirIndex++)
+		{
+			if (!m_fileEntries[dirIndex].m_childrenDirty)
+				continue;
+
+			const Vector<uint32_t> &children = m_fileEntries[dirIndex].m_children;
+
+			RKIT_CHECK(childList.Resize(children.Count()));
+			for (size_t i = 0; i < children.Count(); i++)
+				childList[i] = endian::LittleUInt32_t(children[i]);
+
+			const size_t dataSize = children.Count() * sizeof(endian::LittleUInt32_t);
+
+			RKIT_CHECK(ResizeFile(static_cast<uint32_t>(dirIndex), dataSize));
+			RKIT_CHECK(WriteFileData(static_cast<uint32_t>(dirIndex), 0, childList.GetBuffer(), dataSize));
+
+			m_fileEntries[dirIndex].m_childrenDirty = false;
+			m_fileEntries[dirIndex].m_dirty = true;
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::CommitChanges()
+	{
+		// Read-only files can't have changes
+		if (IsReadOnly())
+			RKIT_RETURN_OK;
+
+		RKIT_CHECK(FlushDirectories());
+
+		// Dirty flags are only cleared once the header switch is durable, so a
+		// commit that fails partway through is redone in full by the next one.
+		bool anyChanges = false;
+
+		// File table entries.  Entry sectors may be relocated, which dirties the
+		// extents table, so this has to happen before the extents are written.
+		for (size_t entryIndex = 0; entryIndex < m_fileEntries.Count(); entryIndex++)
+		{
+			const FileEntry &entry = m_fileEntries[entryIndex];
+			if (!entry.m_dirty)
+				continue;
+
+			const uint32_t extentsIndex = m_fileTableChain[entryIndex];
+			const ExtentsEntry &extents = m_extentsTable[extentsIndex];
+
+			uint32_t sector = 0;
+			RKIT_CHECK(AllocReplacementSector(extents.m_sector, sector));
+			SetExtentsEntry(extentsIndex, sector, extents.m_nextExtents);
+
+			ShadowFileTableEntryHeader diskEntry = {};
+			diskEntry.m_nameLength = entry.m_nameLength;
+			memcpy(diskEntry.m_name, entry.m_name, sizeof(entry.m_name));
+			diskEntry.m_flags = entry.m_flags;
+			diskEntry.m_extentsStart = (entry.m_extents.Count() > 0) ? entry.m_extents[0] : 0u;
+			diskEntry.m_size = entry.m_size;
+
+			memcpy(m_sectorBuffer.GetBuffer(), &diskEntry, sizeof(diskEntry));
+			memcpy(m_sectorBuffer.GetBuffer() + sizeof(diskEntry), entry.m_initialData.GetBuffer(), m_inlineDataSize);
+
+			RKIT_CHECK(WriteSector(sector, 0, m_sectorBuffer.GetBuffer(), m_sectorSize));
+
+			anyChanges = true;
+		}
+
+		// Extents table pages
+		for (size_t page = 0; page < m_extentsPageSectors.Count(); page++)
+		{
+			if (!m_dirtyExtentsPages[page])
+				continue;
+
+			uint32_t sector = 0;
+			RKIT_CHECK(AllocReplacementSector(m_extentsPageSectors[page], sector));
+			m_extentsPageSectors[page] = sector;
+
+			memset(m_sectorBuffer.GetBuffer(), 0, m_sectorSize);
+
+			const size_t firstEntry = page * m_extentsPerPage;
+			const size_t numEntriesInPage = Min(m_extentsPerPage, m_extentsTable.Count() - firstEntry);
+			for (size_t i = 0; i < numEntriesInPage; i++)
+			{
+				const ExtentsEntry &entry = m_extentsTable[firstEntry + i];
+
+				ShadowFileExtentsEntry diskEntry;
+				diskEntry.m_sector = entry.m_sector;
+				diskEntry.m_nextExtents = entry.m_nextExtents;
+
+				memcpy(m_sectorBuffer.GetBuffer() + i * sizeof(diskEntry), &diskEntry, sizeof(diskEntry));
+			}
+
+			RKIT_CHECK(WriteSector(sector, 0, m_sectorBuffer.GetBuffer(), m_sectorSize));
+
+			anyChanges = true;
+		}
+
+		if (!anyChanges)
+			RKIT_RETURN_OK;
+
+		// Extents sector list
+		{
+			uint32_t sector = 0;
+			RKIT_CHECK(AllocReplacementSector(m_extentsSectorListSector, sector));
+			m_extentsSectorListSector = sector;
+
+			memset(m_sectorBuffer.GetBuffer(), 0, m_sectorSize);
+			for (size_t i = 0; i < m_extentsPageSectors.Count(); i++)
+			{
+				const endian::LittleUInt32_t pageSector(m_extentsPageSectors[i]);
+				memcpy(m_sectorBuffer.GetBuffer() + i * sizeof(pageSector), &pageSector, sizeof(pageSector));
+			}
+
+			RKIT_CHECK(WriteSector(sector, 0, m_sectorBuffer.GetBuffer(), m_sectorSize));
+		}
+
+		// Everything written so far is unreachable from the active locator, so
+		// it only has to be durable before the header is written.  If this flush
+		// fails, the header is left alone.
+		RKIT_CHECK(m_stream->Flush());
+
+		const uint8_t newActiveLocator = (m_header.m_activeLocator == 1) ? 2 : 1;
+
+		RKIT_TRY_CATCH_RETHROW(SwitchActiveLocator(newActiveLocator),
+			CatchContext(
+				[this]
+				{
+					RetainUncommittedSectors();
+				}
+			)
+		);
+
+		for (FileEntry &entry : m_fileEntries)
+			entry.m_dirty = false;
+
+		for (size_t page = 0; page < m_extentsPageSectors.Count(); page++)
+			m_dirtyExtentsPages.Set(page, false);
+
+		RKIT_CHECK(m_committedSectors.Duplicate(m_workingSectors));
+		m_sectorScanPos = 1;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFile::SwitchActiveLocator(uint8_t newActiveLocator)
+	{
+		ShadowFileHeader header = m_header;
+
+		ShadowFileLocator &locator = header.m_locators[newActiveLocator - 1];
+		locator.m_extentsSectorListSector = m_extentsSectorListSector;
+		locator.m_extentsTableSize = static_cast<uint32_t>(m_extentsTable.Count());
+		locator.m_fsRootExtentsStart = m_fileTableChain[0];
+
+		header.m_activeLocator = newActiveLocator;
+
+		// The new locator and the active locator index are in the same sector, so they're
+		// written together and the switch either lands as a whole or doesn't.  The header
+		// copy is only kept once the flush succeeds, so a retry after a failed switch
+		// rewrites both from scratch.
+		RKIT_CHECK(WriteSector(0, 0, &header, sizeof(header)));
+		RKIT_CHECK(m_stream->Flush());
+
+		m_header = header;
+
+		RKIT_RETURN_OK;
+	}
+
+	void ShadowFile::RetainUncommittedSectors()
+	{
+		// If the switch failed, it may or may not have reached the disk, so sectors
+		// of both the previous and the new state must stay untouched until a later
+		// commit succeeds.
+		Span<BoolVector::Chunk_t> committedChunks = m_committedSectors.GetChunks();
+		Span<const BoolVector::Chunk_t> workingChunks = m_workingSectors.GetChunks();
+
+		for (size_t i = 0; i < committedChunks.Count(); i++)
+			committedChunks[i] |= workingChunks[i];
+
+		m_sectorScanPos = 1;
+	}
+
+	ShadowFileStream::ShadowFileStream(ShadowFile &shadowFile, uint32_t entryIndex, bool writable)
+		: m_shadowFile(shadowFile)
+		, m_entryIndex(entryIndex)
+		, m_pos(0)
+		, m_writable(writable)
+	{
+		m_shadowFile.AddStreamRef(m_entryIndex);
+	}
+
+	ShadowFileStream::~ShadowFileStream()
+	{
+		m_shadowFile.RemoveStreamRef(m_entryIndex);
+	}
+
+	Result ShadowFileStream::ReadPartial(void *data, size_t count, size_t &outCountRead)
+	{
+		const FilePos_t size = m_shadowFile.GetFileSize(m_entryIndex);
+
+		outCountRead = 0;
+
+		if (m_pos >= size)
+			RKIT_RETURN_OK;
+
+		const size_t countToRead = static_cast<size_t>(Min<FilePos_t>(count, size - m_pos));
+
+		RKIT_CHECK(m_shadowFile.ReadFileData(m_entryIndex, m_pos, data, countToRead));
+
+		m_pos += countToRead;
+		outCountRead = countToRead;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFileStream::WritePartial(const void *data, size_t count, size_t &outCountWritten)
+	{
+		outCountWritten = 0;
+
+		if (!m_writable)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		if (count > std::numeric_limits<FilePos_t>::max() - m_pos)
+			RKIT_THROW(ResultCode::kIOWriteError);
+
+		const FilePos_t endPos = m_pos + count;
+		if (endPos > m_shadowFile.GetFileSize(m_entryIndex))
+		{
+			RKIT_CHECK(m_shadowFile.ResizeFile(m_entryIndex, endPos));
+		}
+
+		RKIT_CHECK(m_shadowFile.WriteFileData(m_entryIndex, m_pos, data, count));
+
+		m_pos = endPos;
+		outCountWritten = count;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFileStream::Flush()
+	{
+		// Changes become durable when the shadow file is committed
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFileStream::SeekStart(FilePos_t pos)
+	{
+		if (pos > m_shadowFile.GetFileSize(m_entryIndex))
+			RKIT_THROW(ResultCode::kIOSeekOutOfRange);
+
+		m_pos = pos;
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFileStream::SeekCurrent(FileOffset_t offset)
+	{
+		if (offset < 0)
+		{
+			const FilePos_t backwardDist = rkit::ToUnsignedAbs<FileOffset_t, FilePos_t>(offset);
+			if (backwardDist > m_pos)
+				RKIT_THROW(ResultCode::kIOSeekOutOfRange);
+
+			return SeekStart(m_pos - backwardDist);
+		}
+
+		const FilePos_t distRemaining = m_shadowFile.GetFileSize(m_entryIndex) - m_pos;
+		if (static_cast<FilePos_t>(offset) > distRemaining)
+			RKIT_THROW(ResultCode::kIOSeekOutOfRange);
+
+		return SeekStart(m_pos + static_cast<FilePos_t>(offset));
+	}
+
+	Result ShadowFileStream::SeekEnd(FileOffset_t offset)
+	{
+		if (offset > 0)
+			RKIT_THROW(ResultCode::kIOSeekOutOfRange);
+
+		const FilePos_t size = m_shadowFile.GetFileSize(m_entryIndex);
+		const FilePos_t backwardDist = rkit::ToUnsignedAbs<FileOffset_t, FilePos_t>(offset);
+		if (backwardDist > size)
+			RKIT_THROW(ResultCode::kIOSeekOutOfRange);
+
+		return SeekStart(size - backwardDist);
+	}
+
+	FilePos_t ShadowFileStream::Tell() const
+	{
+		return m_pos;
+	}
+
+	FilePos_t ShadowFileStream::GetSize() const
+	{
+		return m_shadowFile.GetFileSize(m_entryIndex);
+	}
+
+	Result ShadowFileStream::Truncate(FilePos_t size)
+	{
+		if (!m_writable)
+			RKIT_THROW(ResultCode::kOperationFailed);
+
+		RKIT_CHECK(m_shadowFile.ResizeFile(m_entryIndex, size));
+
+		if (m_pos > size)
+			m_pos = size;
+
+		RKIT_RETURN_OK;
+	}
+} } } // rkit::utils::priv
+
+namespace rkit { namespace utils
+{
+	Result ShadowFileBase::Create(UniquePtr<ShadowFileBase> &outShadowFile, UniquePtr<ISeekableReadWriteStream> &&stream, bool initialize)
+	{
+		UniquePtr<priv::ShadowFile> shadowFile;
+		RKIT_CHECK(New<priv::ShadowFile>(shadowFile, std::move(stream)));
+
+		if (initialize)
+		{
+			RKIT_CHECK(shadowFile->InitializeNew());
+		}
+		else
+		{
+			RKIT_CHECK(shadowFile->Load());
+		}
+
+		outShadowFile = std::move(shadowFile);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result ShadowFileBase::CreateReadOnly(UniquePtr<ShadowFileBase> &outShadowFile, UniquePtr<IFileMappingView> &&view)
+	{
+		UniquePtr<priv::ShadowFile> shadowFile;
+		RKIT_CHECK(New<priv::ShadowFile>(shadowFile, std::move(view)));
+
+		RKIT_CHECK(shadowFile->Load());
+
+		outShadowFile = std::move(shadowFile);
+
+		RKIT_RETURN_OK;
+	}
+} } // rkit::utils
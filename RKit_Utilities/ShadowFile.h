@@ -0,0 +1,24 @@
+#pragma once
+
+#include "rkit/Utilities/ShadowFile.h"
+
+namespace rkit
+{
+	struct IFileMappingView;
+	struct ISeekableReadWriteStream;
+
+	template<class T>
+	class UniquePtr;
+}
+
+namespace rkit { namespace utils
+{
+	class ShadowFileBase : public IShadowFile
+	{
+	public:
+		virtual ~ShadowFileBase() {}
+
+		static Result Create(UniquePtr<ShadowFileBase> &outShadowFile, UniquePtr<ISeekableReadWriteStream> &&stream, bool initialize);
+		static Result CreateReadOnly(UniquePtr<ShadowFileBase> &outShadowFile, UniquePtr<IFileMappingView> &&view);
+	};
+} } // rkit::utils
@@ -19,13 +19,16 @@
 
 #include "rkit/Utilities/ThreadPool.h"
 
+#include "BufferedStream.h"
 #include "DeflateDecompressStream.h"
 #include "JobQueue.h"
 #include "Json.h"
 #include "Image.h"
+#include "ImageKernels.h"
 #include "MutexProtectedStream.h"
 #include "ModuleSandbox.h"
 #include "RangeLimitedReadStream.h"
+#include "ShadowFile.h"
 #include "Sha2Calculator.h"
 #include "TextParser.h"
 #include "ThreadPool.h"
@@ -63,8 +66,16 @@ namespace rkit
 		Result CreateRestartableDeflateDecompressStream(UniquePtr<ISeekableReadStream> &outStream, UniquePtr<ISeekableReadStream> &&compressedStream, FilePos_t decompressedSize) const override;
 		Result CreateDeflateDecompressStream(UniquePtr<IReadStream> &outStream, UniquePtr<IReadStream> &&compressedStream) const override;
 		Result CreateRangeLimitedReadStream(UniquePtr<ISeekableReadStream> &outStream, UniquePtr<ISeekableReadStream> &&stream, FilePos_t startPos, FilePos_t size) const override;
+		Result CreateShadowFile(UniquePtr<utils::IShadowFile> &outShadowFile, UniquePtr<ISeekableReadWriteStream> &&stream, bool initialize) const override;
+		Result CreateReadOnlyShadowFile(UniquePtr<utils::IShadowFile> &outShadowFile, UniquePtr<IFileMappingView> &&view) const override;
+
+		Result CreateBufferedReadStream(UniquePtr<BufferedReadStream> &outStream, UniquePtr<IReadStream> &&stream, size_t bufferSize) const override;
+		Result CreateBufferedSeekableReadStream(UniquePtr<BufferedSeekableReadStream> &outStream, UniquePtr<ISeekableReadStream> &&stream, size_t bufferSize) const override;
+		Result CreateBufferedWriteStream(UniquePtr<BufferedWriteStream> &outStream, UniquePtr<IWriteStream> &&stream, size_t bufferSize) const override;
+		Result CreateBufferedSeekableWriteStream(UniquePtr<BufferedSeekableWriteStream> &outStream, UniquePtr<ISeekableWriteStream> &&stream, size_t bufferSize) const override;
 
 		Result CreateThreadPool(UniquePtr<utils::IThreadPool> &outThreadPool, uint32_t numThreads) const override;
+		uint32_t ComputeThreadPoolSize(bool callingThreadRunsJobs) const override;
 
 		Result CreateTextParser(const Span<const uint8_t> &contents, utils::TextParserCommentType commentType, utils::TextParserLexerType lexType, UniquePtr<utils::ITextParser> &outParser) const override;
 		Result ReadEntireFile(ISeekableReadStream &stream, Vector<uint8_t> &outBytes) const override;
@@ -90,6 +101,9 @@ namespace rkit
 		ConstSpan<uint16_t> GetSRGBToLinearTable() const override;
 		int GetSRGBToLinearPrecisionBits() const override;
 
+		const utils::IImageKernels *GetImageKernels() const override;
+		const utils::IImageKernels *GetReferenceImageKernels() const override;
+
 		bool ContainsWildcards(const StringSliceView &str) const override;
 		bool MatchesWildcard(const StringSliceView &candidate, const StringSliceView &wildcard) const override;
 
@@ -123,6 +137,9 @@ namespace rkit
 		Result LinkSandbox(ISandbox &sandbox, sandbox::HostAPIDescriptor &hostAPIDescriptor) const override;
 
 	private:
+		template<class TBufferedStream, class TStream>
+		static Result CreateOwningBufferedStream(UniquePtr<TBufferedStream> &outStream, UniquePtr<TStream> &&stream, size_t bufferSize);
+
 		static bool ValidateFilePathSlice(const Span<const Utf8Char_t> &name, bool permitWildcards);
 
 		static bool MatchesWildcardWithMinLiteralCount(const StringSliceView &candidate, const StringSliceView &wildcard, size_t minLiteralCount);
@@ -145,6 +162,8 @@ namespace rkit
 		static bool ParseSignedInt(const ByteStringSliceView &str, uint8_t radix, TInteger &i);
 
 		utils::Sha256Calculator m_sha256Calculator;
+		utils::ImageKernels m_imageKernels;
+		utils::ImageKernels m_referenceImageKernels;
 
 		String m_programName;
 
@@ -158,7 +177,9 @@ namespace rkit
 	typedef DriverModuleStub<UtilitiesDriver, IUtilitiesDriver, &Drivers::m_utilitiesDriver> UtilitiesModule;
 
 	UtilitiesDriver::UtilitiesDriver()
-		: m_programVersion{ 1, 0, 0 }
+		: m_imageKernels(true, ConstSpan<uint16_t>(ms_srgbToLinearTable), ConstSpan<uint8_t>(ms_linearToSRGBTable))
+		, m_referenceImageKernels(false, ConstSpan<uint16_t>(ms_srgbToLinearTable), ConstSpan<uint8_t>(ms_linearToSRGBTable))
+		, m_programVersion{ 1, 0, 0 }
 	{
 	}
 
@@ -288,6 +309,60 @@ namespace rkit
 		return NewWithAlloc<RangeLimitedReadStream>(outStream, alloc, std::move(stream), startPos, size);
 	}
 
+	Result UtilitiesDriver::CreateShadowFile(UniquePtr<utils::IShadowFile> &outShadowFile, UniquePtr<ISeekableReadWriteStream> &&streamSrc, bool initialize) const
+	{
+		UniquePtr<utils::ShadowFileBase> shadowFile;
+		RKIT_CHECK(utils::ShadowFileBase::Create(shadowFile, std::move(streamSrc), initialize));
+
+		outShadowFile = std::move(shadowFile);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result UtilitiesDriver::CreateReadOnlyShadowFile(UniquePtr<utils::IShadowFile> &outShadowFile, UniquePtr<IFileMappingView> &&viewSrc) const
+	{
+		UniquePtr<utils::ShadowFileBase> shadowFile;
+		RKIT_CHECK(utils::ShadowFileBase::CreateReadOnly(shadowFile, std::move(viewSrc)));
+
+		outShadowFile = std::move(shadowFile);
+
+		RKIT_RETURN_OK;
+	}
+
+	Result UtilitiesDriver::CreateBufferedReadStream(UniquePtr<BufferedReadStream> &outStream, UniquePtr<IReadStream> &&stream, size_t bufferSize) const
+	{
+		return CreateOwningBufferedStream(outStream, std::move(stream), bufferSize);
+	}
+
+	Result UtilitiesDriver::CreateBufferedSeekableReadStream(UniquePtr<BufferedSeekableReadStream> &outStream, UniquePtr<ISeekableReadStream> &&stream, size_t bufferSize) const
+	{
+		return CreateOwningBufferedStream(outStream, std::move(stream), bufferSize);
+	}
+
+	Result UtilitiesDriver::CreateBufferedWriteStream(UniquePtr<BufferedWriteStream> &outStream, UniquePtr<IWriteStream> &&stream, size_t bufferSize) const
+	{
+		return CreateOwningBufferedStream(outStream, std::move(stream), bufferSize);
+	}
+
+	Result UtilitiesDriver::CreateBufferedSeekableWriteStream(UniquePtr<BufferedSeekableWriteStream> &outStream, UniquePtr<ISeekableWriteStream> &&stream, size_t bufferSize) const
+	{
+		return CreateOwningBufferedStream(outStream, std::move(stream), bufferSize);
+	}
+
+	template<class TBufferedStream, class TStream>
+	Result UtilitiesDriver::CreateOwningBufferedStream(UniquePtr<TBufferedStream> &outStream, UniquePtr<TStream> &&streamSrc, size_t bufferSize)
+	{
+		UniquePtr<TStream> stream(std::move(streamSrc));
+
+		if (bufferSize == 0)
+			RKIT_THROW(ResultCode::kInvalidParameter);
+
+		Vector<uint8_t> buffer;
+		RKIT_CHECK(buffer.Resize(bufferSize));
+
+		return New<utils::priv::OwningBufferedStream<TBufferedStream, TStream>>(outStream, std::move(stream), std::move(buffer));
+	}
+
 	Result UtilitiesDriver::CreateThreadPool(UniquePtr<utils::IThreadPool> &outThreadPool, uint32_t numThreads) const
 	{
 		UniquePtr<utils::ThreadPoolBase> threadPool;
@@ -298,6 +373,18 @@ namespace rkit
 		RKIT_RETURN_OK;
 	}
 
+	uint32_t UtilitiesDriver::ComputeThreadPoolSize(bool callingThreadRunsJobs) const
+	{
+		uint32_t processorCount = GetDrivers().m_systemDriver->GetProcessorCount();
+		if (processorCount < 1)
+			processorCount = 1;
+
+		if (callingThreadRunsJobs)
+			return processorCount;
+
+		return processorCount + 1;
+	}
+
 	Result UtilitiesDriver::CreateTextParser(const Span<const uint8_t> &contents, utils::TextParserCommentType commentType, utils::TextParserLexerType lexType, UniquePtr<utils::ITextParser> &outParser) const
 	{
 		UniquePtr<utils::TextParserBase> parser;
@@ -546,6 +633,16 @@ namespace rkit
 		return ms_linearToSRGBPrecisionBits;
 	}
 
+	const utils::IImageKernels *UtilitiesDriver::GetImageKernels() const
+	{
+		return &m_imageKernels;
+	}
+
+	const utils::IImageKernels *UtilitiesDriver::GetReferenceImageKernels() const
+	{
+		return &m_referenceImageKernels;
+	}
+
 	const uint16_t UtilitiesDriver::ms_srgbToLinearTable[256] =
 	{
 		0, 20, 40, 60, 80, 99, 119, 139,
@@ -0,0 +1,1294 @@
+#include "anox/AnoxModule.h"
+#include "anox/BuildDriver.h"
+
+#include "rkit/BuildSystem/BuildSystem.h"
+
+#include "rkit/Core/BufferedStream.h"
+#include "rkit/Core/CoreLib.h"
+#include "rkit/Core/DeduplicatedList.h"
+#include "rkit/Core/DirectoryScan.h"
+#include "rkit/Core/Drivers.h"
+#include "rkit/Core/HashTable.h"
+#include "rkit/Core/Job.h"
+#include "rkit/Core/JobQueue.h"
+#include "rkit/Core/LogDriver.h"
+#include "rkit/Core/MallocDriver.h"
+#include "rkit/Core/MemoryStream.h"
+#include "rkit/Core/ModuleDriver.h"
+#include "rkit/Core/ModuleGlue.h"
+#include "rkit/Core/Mutex.h"
+#include "rkit/Core/MutexLock.h"
+#include "rkit/Core/Path.h"
+#include "rkit/Core/ProgramDriver.h"
+#include "rkit/Core/DriverModuleStub.h"
+#include "rkit/Core/Event.h"
+#include "rkit/Core/ProgramStub.h"
+#include "rkit/Core/ReadWriteLock.h"
+#include "rkit/Core/ReadWriteLockGuard.h"
+#include "rkit/Core/RefCounted.h"
+#include "rkit/Core/Result.h"
+#include "rkit/Core/Span.h"
+#include "rkit/Core/Stream.h"
+#include "rkit/Core/StreamingCopy.h"
+#include "rkit/Core/StripedCopyJobRunner.h"
+#include "rkit/Core/String.h"
+#include "rkit/Core/SystemDriver.h"
+#include "rkit/Core/Thread.h"
+#include "rkit/Core/StringView.h"
+#include "rkit/Core/UtilitiesDriver.h"
+#include "rkit/Core/Vector.h"
+#include "rkit/Core/XorShift.h"
+
+#include "rkit/Data/DataDriver.h"
+#include "rkit/Data/RenderDataHandler.h"
+
+#include "rkit/Utilities/ImageKernels.h"
+#include "rkit/Utilities/ThreadPool.h"
+
+#include <string.h>
+
+namespace anox
+{
+	// Character source for the callback-based float parser
+	struct FloatScanChars
+	{
+		FloatScanChars(const uint8_t *chars, size_t length);
+
+		static bool GetOneChar(void *state, int32_t &outChar);
+		static void UnGetChar(void *state);
+
+		const uint8_t *m_chars;
+		size_t m_length;
+		size_t m_pos;
+		size_t m_overrun;
+	};
+
+	// State shared by the lock contention worker threads.  Exactly one of m_mutex and m_rwLock is set.
+	struct LockContentionState
+	{
+		rkit::IMutex *m_mutex = nullptr;
+		rkit::IReadWriteLock *m_rwLock = nullptr;
+		rkit::IEvent *m_startEvent = nullptr;
+		rkit::Span<uint32_t> m_table;
+		uint32_t m_numLookups = 0;
+	};
+
+	class LockContentionThreadContext final : public rkit::IThreadContext
+	{
+	public:
+		LockContentionThreadContext(const LockContentionState &state, uint32_t seed, uint32_t &outChecksum);
+
+		rkit::Result Run() override;
+
+	private:
+		const LockContentionState &m_state;
+		uint32_t m_seed;
+		uint32_t &m_outChecksum;
+	};
+
+	// Forwards to another malloc driver and counts the allocations made through it
+	class CountingMallocDriver final : public rkit::IMallocDriver
+	{
+	public:
+		explicit CountingMallocDriver(rkit::IMallocDriver &baseDriver);
+
+		bool TryResizeMemBlock(void *ptr, size_t newSize) override;
+
+		uint64_t GetNumAllocs() const;
+		uint64_t GetNumBytes() const;
+
+	protected:
+		void *InternalAlloc(size_t size) override;
+		void *InternalRealloc(void *ptr, size_t size) override;
+		void InternalFree(void *ptr) override;
+
+	private:
+		rkit::IMallocDriver &m_baseDriver;
+		uint64_t m_numAllocs;
+		uint64_t m_numBytes;
+	};
+
+	class BenchProgram final : public rkit::ISimpleProgram
+	{
+	public:
+		rkit::Result Run() override;
+
+	private:
+		// Same shape as the graphics subsystem's striped mem copy actions, with a plain memory
+		// destination instead of upload memory
+		struct StripedCopy
+		{
+			size_t m_srcOffset = 0;
+			size_t m_destOffset = 0;
+			uint32_t m_rowSizeBytes = 0;
+			uint32_t m_rowInPitch = 0;
+			uint32_t m_rowOutPitch = 0;
+			uint32_t m_rowCount = 0;
+
+			const uint8_t *m_src = nullptr;
+			uint8_t *m_dest = nullptr;
+
+			void CopyRange(uint64_t offset, uint64_t size) const;
+		};
+
+		struct ImageKernelBuffers
+		{
+			size_t m_numPixels = 0;
+			rkit::ConstSpan<uint8_t> m_inBytes;
+			rkit::ConstSpan<uint16_t> m_inLinear;
+			rkit::ConstSpan<uint8_t> m_palette;
+			rkit::Span<uint8_t> m_outBytes;
+			rkit::Span<uint16_t> m_outLinear;
+		};
+
+		static rkit::Result ParseCount(const rkit::Span<const rkit::StringView> &args, uint32_t &inOutCount);
+
+		static rkit::Result RunImageKernelBench(const rkit::Span<const rkit::StringView> &args);
+		static void RunImageKernel(const rkit::utils::IImageKernels &kernels, size_t kernelIndex, const ImageKernelBuffers &buffers);
+
+		static rkit::Result RunDedupBench(const rkit::Span<const rkit::StringView> &args);
+
+		static rkit::Result RunFloatParseBench(const rkit::Span<const rkit::StringView> &args);
+
+		static rkit::Result RunBufferedReadBench(const rkit::Span<const rkit::StringView> &args);
+
+		static rkit::Result RunRenderPackageBench(const rkit::Span<const rkit::StringView> &args);
+
+		static rkit::Result RunStripedUploadBench(const rkit::Span<const rkit::StringView> &args);
+
+		static rkit::Result RunLockContentionBench(const rkit::Span<const rkit::StringView> &args);
+		static rkit::Result RunLockContentionPass(const LockContentionState &baseState, uint32_t numThreads, uint64_t &outMicroseconds);
+		static rkit::Result StartLockContentionThreads(const LockContentionState &state, const rkit::Span<rkit::UniqueThreadRef> &threads, const rkit::Span<uint32_t> &checksums);
+
+		static rkit::Result RunAPEParseBench(const rkit::Span<const rkit::StringView> &args);
+		static rkit::Result RunAPEParsePasses(const IBuildDriver &buildDriver, const rkit::Vector<rkit::Vector<uint8_t>> &files, uint32_t numPasses, size_t &outNumCommands);
+		static rkit::Result RunAPECompileBench(const rkit::Span<const rkit::StringView> &args);
+		static rkit::Result LoadAPEFiles(const rkit::OSAbsPathView &dirPath, rkit::Vector<rkit::Vector<uint8_t>> &outFiles, size_t &outTotalBytes);
+		static rkit::Result LoadAnoxBuildDriver(const IBuildDriver *&outBuildDriver);
+
+		static rkit::Result RunBuildCacheBench(const rkit::Span<const rkit::StringView> &args);
+
+		template<class TStream>
+		static rkit::Result ReadInPieces(TStream &stream, size_t fileSize, size_t readSize, uint32_t &outChecksum);
+	};
+
+	typedef rkit::DriverModuleStub<rkit::ProgramStubDriver<BenchProgram>, rkit::IProgramDriver, &rkit::Drivers::m_programDriver> BenchModule;
+}
+
+anox::FloatScanChars::FloatScanChars(const uint8_t *chars, size_t length)
+	: m_chars(chars)
+	, m_length(length)
+	, m_pos(0)
+	, m_overrun(0)
+{
+}
+
+bool anox::FloatScanChars::GetOneChar(void *state, int32_t &outChar)
+{
+	FloatScanChars *scanChars = static_cast<FloatScanChars *>(state);
+	if (scanChars->m_pos == scanChars->m_length)
+	{
+		scanChars->m_overrun++;
+		return false;
+	}
+
+	outChar = scanChars->m_chars[scanChars->m_pos++];
+	return true;
+}
+
+void anox::FloatScanChars::UnGetChar(void *state)
+{
+	FloatScanChars *scanChars = static_cast<FloatScanChars *>(state);
+	if (scanChars->m_overrun > 0)
+		scanChars->m_overrun--;
+	else
+		scanChars->m_pos--;
+}
+
+anox::LockContentionThreadContext::LockContentionThreadContext(const LockContentionState &state, uint32_t seed, uint32_t &outChecksum)
+	: m_state(state)
+	, m_seed(seed)
+	, m_outChecksum(outChecksum)
+{
+}
+
+rkit::Result anox::LockContentionThreadContext::Run()
+{
+	m_state.m_startEvent->Wait();
+
+	rkit::XorShift32 rng(m_seed);
+
+	const size_t tableMask = m_state.m_table.Count() - 1;
+	uint32_t *table = m_state.m_table.Ptr();
+
+	uint32_t checksum = 0;
+	for (uint32_t i = 0; i < m_state.m_numLookups; i++)
+	{
+		const size_t slot = rng.Next() & tableMask;
+
+		// One access in 64 is a write, like a registration among resource lookups
+		const bool isWrite = ((i & 63u) == 63u);
+
+		if (m_state.m_rwLock != nullptr)
+		{
+			if (isWrite)
+			{
+				rkit::ExclusiveLock lock(*m_state.m_rwLock);
+				table[slot]++;
+			}
+			else
+			{
+				rkit::SharedLock lock(*m_state.m_rwLock);
+				checksum += table[slot];
+			}
+		}
+		else
+		{
+			rkit::MutexLock lock(*m_state.m_mutex);
+
+			if (isWrite)
+				table[slot]++;
+			else
+				checksum += table[slot];
+		}
+	}
+
+	m_outChecksum = checksum;
+
+	RKIT_RETURN_OK;
+}
+
+anox::CountingMallocDriver::CountingMallocDriver(rkit::IMallocDriver &baseDriver)
+	: m_baseDriver(baseDriver)
+	, m_numAllocs(0)
+	, m_numBytes(0)
+{
+}
+
+bool anox::CountingMallocDriver::TryResizeMemBlock(void *ptr, size_t newSize)
+{
+	return m_baseDriver.TryResizeMemBlock(ptr, newSize);
+}
+
+uint64_t anox::CountingMallocDriver::GetNumAllocs() const
+{
+	return m_numAllocs;
+}
+
+uint64_t anox::CountingMallocDriver::GetNumBytes() const
+{
+	return m_numBytes;
+}
+
+void *anox::CountingMallocDriver::InternalAlloc(size_t size)
+{
+	m_numAllocs++;
+	m_numBytes += size;
+	return m_baseDriver.Alloc(size);
+}
+
+void *anox::CountingMallocDriver::InternalRealloc(void *ptr, size_t size)
+{
+	m_numAllocs++;
+	m_numBytes += size;
+	return m_baseDriver.Realloc(ptr, size);
+}
+
+void anox::CountingMallocDriver::InternalFree(void *ptr)
+{
+	m_baseDriver.Free(ptr);
+}
+
+rkit::Result anox::BenchProgram::ParseCount(const rkit::Span<const rkit::StringView> &args, uint32_t &inOutCount)
+{
+	if (args.Count() == 0)
+		RKIT_RETURN_OK;
+
+	if (args.Count() > 1 || !rkit::GetDrivers().m_utilitiesDriver->ParseUInt32(args[0].RemoveEncoding(), 10, inOutCount) || inOutCount == 0)
+	{
+		rkit::log::Error(u8"Count must be a positive integer");
+		RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+	}
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::RunImageKernelBench(const rkit::Span<const rkit::StringView> &args)
+{
+	uint32_t numPixels = 1024 * 1024;
+	RKIT_CHECK(ParseCount(args, numPixels));
+
+	const rkit::IUtilitiesDriver &utils = *rkit::GetDrivers().m_utilitiesDriver;
+	const rkit::utils::IImageKernels &vectorKernels = *utils.GetImageKernels();
+	const rkit::utils::IImageKernels &referenceKernels = *utils.GetReferenceImageKernels();
+
+	rkit::Vector<uint8_t> inBytes;
+	rkit::Vector<uint16_t> inLinear;
+	rkit::Vector<uint8_t> palette;
+	rkit::Vector<uint8_t> vectorBytes;
+	rkit::Vector<uint8_t> referenceBytes;
+	rkit::Vector<uint16_t> vectorLinear;
+	rkit::Vector<uint16_t> referenceLinear;
+
+	RKIT_CHECK(inBytes.Resize(static_cast<size_t>(numPixels) * 4u));
+	RKIT_CHECK(inLinear.Resize(numPixels));
+	RKIT_CHECK(palette.Resize(256 * 4));
+	RKIT_CHECK(vectorBytes.Resize(static_cast<size_t>(numPixels) * 4u));
+	RKIT_CHECK(referenceBytes.Resize(static_cast<size_t>(numPixels) * 4u));
+	RKIT_CHECK(vectorLinear.Resize(numPixels));
+	RKIT_CHECK(referenceLinear.Resize(numPixels));
+
+	rkit::XorShift32 rng;
+	for (uint8_t &b : inBytes)
+		b = static_cast<uint8_t>(rng.Next() >> 24);
+
+	const uint32_t linearMask = (1u << utils.GetSRGBToLinearPrecisionBits()) - 1u;
+	for (uint16_t &linear : inLinear)
+		linear = static_cast<uint16_t>((rng.Next() >> 8) & linearMask);
+
+	for (size_t i = 0; i < palette.Count(); i++)
+		palette[i] = static_cast<uint8_t>(i * 37u);
+
+	ImageKernelBuffers vectorBuffers;
+	vectorBuffers.m_numPixels = numPixels;
+	vectorBuffers.m_inBytes = inBytes.ToSpan();
+	vectorBuffers.m_inLinear = inLinear.ToSpan();
+	vectorBuffers.m_palette = palette.ToSpan();
+	vectorBuffers.m_outBytes = vectorBytes.ToSpan();
+	vectorBuffers.m_outLinear = vectorLinear.ToSpan();
+
+	ImageKernelBuffers referenceBuffers = vectorBuffers;
+	referenceBuffers.m_outBytes = referenceBytes.ToSpan();
+	referenceBuffers.m_outLinear = referenceLinear.ToSpan();
+
+	const rkit::Utf8Char_t *labels[] =
+	{
+		u8"ExpandPalette8ToRGBA8",
+		u8"ExpandGray8ToRGBA8",
+		u8"ExpandRGB8ToRGBA8",
+		u8"SwapRedBlueRGBA8",
+		u8"PremultiplyAlphaRGBA8",
+		u8"DecodeSRGB8ToLinear",
+		u8"EncodeLinearToSRGB8",
+	};
+
+	const rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+	const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency();
+
+	uint32_t numMatching = 0;
+
+	for (size_t kernelIndex = 0; kernelIndex < sizeof(labels) / sizeof(labels[0]); kernelIndex++)
+	{
+		memset(vectorBytes.GetBuffer(), 0, vectorBytes.Count());
+		memset(referenceBytes.GetBuffer(), 0, referenceBytes.Count());
+		memset(vectorLinear.GetBuffer(), 0, vectorLinear.Count() * sizeof(uint16_t));
+		memset(referenceLinear.GetBuffer(), 0, referenceLinear.Count() * sizeof(uint16_t));
+
+		const uint64_t referenceStartTime = sysDriver.GetHighResTimestamp();
+		RunImageKernel(referenceKernels, kernelIndex, referenceBuffers);
+
+		const uint64_t vectorStartTime = sysDriver.GetHighResTimestamp();
+		RunImageKernel(vectorKernels, kernelIndex, vectorBuffers);
+
+		const uint64_t endTime = sysDriver.GetHighResTimestamp();
+
+		const bool matches = !memcmp(vectorBytes.GetBuffer(), referenceBytes.GetBuffer(), vectorBytes.Count())
+			&& !memcmp(vectorLinear.GetBuffer(), referenceLinear.GetBuffer(), vectorLinear.Count() * sizeof(uint16_t));
+
+		if (matches)
+			numMatching++;
+
+		const uint64_t referenceMicroseconds = (vectorStartTime - referenceStartTime) * 1000000u / timerFrequency;
+		const uint64_t vectorMicroseconds = (endTime - vectorStartTime) * 1000000u / timerFrequency;
+
+		rkit::log::LogInfoFmt(u8"{}: {} pixels, reference {} usec, vector {} usec{}", labels[kernelIndex], numPixels, referenceMicroseconds, vectorMicroseconds, matches ? u8"" : u8" (MISMATCH)");
+	}
+
+	rkit::log::LogInfoFmt(u8"Vector kernels matching reference kernels: {}/{}", numMatching, sizeof(labels) / sizeof(labels[0]));
+
+	RKIT_RETURN_OK;
+}
+
+void anox::BenchProgram::RunImageKernel(const rkit::utils::IImageKernels &kernels, size_t kernelIndex, const ImageKernelBuffers &buffers)
+{
+	const size_t numPixels = buffers.m_numPixels;
+
+	switch (kernelIndex)
+	{
+	case 0:
+		kernels.ExpandPalette8ToRGBA8(buffers.m_outBytes, buffers.m_inBytes.SubSpan(0, numPixels), buffers.m_palette);
+		break;
+	case 1:
+		kernels.ExpandGray8ToRGBA8(buffers.m_outBytes, buffers.m_inBytes.SubSpan(0, numPixels));
+		break;
+	case 2:
+		kernels.ExpandRGB8ToRGBA8(buffers.m_outBytes, buffers.m_inBytes.SubSpan(0, numPixels * 3u), rkit::utils::RGBChannelOrder::kBGR);
+		break;
+	case 3:
+		kernels.SwapRedBlueRGBA8(buffers.m_outBytes, buffers.m_inBytes);
+		break;
+	case 4:
+		kernels.PremultiplyAlphaRGBA8(buffers.m_outBytes, buffers.m_inBytes);
+		break;
+	case 5:
+		kernels.DecodeSRGB8ToLinear(buffers.m_outLinear, buffers.m_inBytes.SubSpan(0, numPixels));
+		break;
+	case 6:
+		kernels.EncodeLinearToSRGB8(buffers.m_outBytes.SubSpan(0, numPixels), buffers.m_inLinear);
+		break;
+	default:
+		break;
+	}
+}
+
+rkit::Result anox::BenchProgram::RunDedupBench(const rkit::Span<const rkit::StringView> &args)
+{
+	uint32_t numItems = 1000000;
+	RKIT_CHECK(ParseCount(args, numItems));
+
+	// Roughly half of the items are duplicates
+	rkit::Vector<uint64_t> items;
+	RKIT_CHECK(items.Resize(numItems));
+
+	rkit::XorShift32 rng;
+	for (uint64_t &item : items)
+		item = (static_cast<uint64_t>(rng.Next() % (numItems / 2u + 1u)) << 32) | 0x1234u;
+
+	const rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+	const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency();
+
+	rkit::Vector<size_t> mapIndexes;
+	rkit::Vector<size_t> listIndexes;
+	RKIT_CHECK(mapIndexes.Resize(numItems));
+	RKIT_CHECK(listIndexes.Resize(numItems));
+
+	// Previous layout: items stored in both a vector and a map
+	const uint64_t mapStartTime = sysDriver.GetHighResTimestamp();
+	{
+		rkit::HashMap<uint64_t, size_t> lookup;
+		rkit::Vector<uint64_t> uniqueItems;
+
+		for (size_t i = 0; i < numItems; i++)
+		{
+			const uint64_t item = items[i];
+
+			rkit::HashMap<uint64_t, size_t>::ConstIterator_t it = lookup.Find(item);
+			if (it != lookup.end())
+				mapIndexes[i] = it.Value();
+			else
+			{
+				mapIndexes[i] = uniqueItems.Count();
+				RKIT_CHECK(uniqueItems.Append(item));
+				RKIT_CHECK(lookup.Set(item, mapIndexes[i]));
+			}
+		}
+	}
+
+	const uint64_t listStartTime = sysDriver.GetHighResTimestamp();
+	size_t numUnique = 0;
+	{
+		rkit::DeduplicatedList<uint64_t> list;
+
+		for (size_t i = 0; i < numItems; i++)
+		{
+			RKIT_CHECK(list.AddAndGetIndex(listIndexes[i], items[i]));
+		}
+
+		numUnique = list.Count();
+	}
+
+	const uint64_t endTime = sysDriver.GetHighResTimestamp();
+
+	uint32_t numMatching = 0;
+	for (size_t i = 0; i < numItems; i++)
+	{
+		if (mapIndexes[i] == listIndexes[i])
+			numMatching++;
+	}
+
+	const uint64_t mapMicroseconds = (listStartTime - mapStartTime) * 1000000u / timerFrequency;
+	const uint64_t listMicroseconds = (endTime - listStartTime) * 1000000u / timerFrequency;
+
+	rkit::log::LogInfoFmt(u8"{} items, {} unique: HashMap+Vector {} usec, DeduplicatedList {} usec", numItems, numUnique, mapMicroseconds, listMicroseconds);
+	rkit::log::LogInfoFmt(u8"DeduplicatedList indexes matching HashMap indexes: {}/{}", numMatching, numItems);
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::RunFloatParseBench(const rkit::Span<const rkit::StringView> &args)
+{
+	uint32_t numValues = 1000000;
+	RKIT_CHECK(ParseCount(args, numValues));
+
+	// Half of the values are short decimals like the ones in text data files, the rest are
+	// random floats in their shortest round-trip form
+	rkit::Vector<uint8_t> text;
+	rkit::Vector<size_t> offsets;
+	RKIT_CHECK(offsets.Resize(static_cast<size_t>(numValues) + 1u));
+
+	rkit::XorShift32 rng;
+	rkit::String str;
+	for (uint32_t i = 0; i < numValues; i++)
+	{
+		offsets[i] = text.Count();
+
+		float f = 0.f;
+		if (i & 1u)
+		{
+			uint32_t floatBits = rng.Next();
+			if ((floatBits & 0x7f800000u) == 0x7f800000u)
+				floatBits &= 0xbfffffffu;
+
+			memcpy(&f, &floatBits, sizeof(f));
+		}
+		else
+			f = static_cast<float>(static_cast<int32_t>(rng.Next() % 200001u) - 100000) * 0.01f;
+
+		RKIT_CHECK(str.Format(u8"{}", f));
+		RKIT_CHECK(text.Append(str.ToByteView().ToSpan()));
+	}
+
+	offsets[numValues] = text.Count();
+
+	rkit::Vector<float> fastResults;
+	rkit::Vector<float> slowResults;
+	RKIT_CHECK(fastResults.Resize(numValues));
+	RKIT_CHECK(slowResults.Resize(numValues));
+
+	const rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+	const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency();
+
+	const uint8_t *chars = text.GetBuffer();
+
+	const uint64_t slowStartTime = sysDriver.GetHighResTimestamp();
+	for (uint32_t i = 0; i < numValues; i++)
+	{
+		FloatScanChars scanChars(chars + offsets[i], offsets[i + 1] - offsets[i]);
+		if (!rkit::utils::CharsToFloatDynamic(slowResults[i], &scanChars, FloatScanChars::GetOneChar, FloatScanChars::UnGetChar))
+			slowResults[i] = 0.f;
+	}
+
+	const uint64_t fastStartTime = sysDriver.GetHighResTimestamp();
+	for (uint32_t i = 0; i < numValues; i++)
+	{
+		size_t length = offsets[i + 1] - offsets[i];
+		if (!rkit::utils::CharsToFloat(fastResults[i], chars + offsets[i], length))
+			fastResults[i] = 0.f;
+	}
+
+	const uint64_t endTime = sysDriver.GetHighResTimestamp();
+
+	uint32_t numMatching = 0;
+	for (uint32_t i = 0; i < numValues; i++)
+	{
+		if (!memcmp(&fastResults[i], &slowResults[i], sizeof(float)))
+			numMatching++;
+	}
+
+	const uint64_t slowMicroseconds = (fastStartTime - slowStartTime) * 1000000u / timerFrequency;
+	const uint64_t fastMicroseconds = (endTime - fastStartTime) * 1000000u / timerFrequency;
+
+	rkit::log::LogInfoFmt(u8"{} floats, {} bytes: CharsToFloatDynamic {} usec, CharsToFloat {} usec", numValues, text.Count(), slowMicroseconds, fastMicroseconds);
+	rkit::log::LogInfoFmt(u8"CharsToFloat results matching CharsToFloatDynamic: {}/{}", numMatching, numValues);
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::RunBufferedReadBench(const rkit::Span<const rkit::StringView> &args)
+{
+	if (args.Count() < 1)
+	{
+		rkit::log::Error(u8"A file path is required");
+		RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+	}
+
+	// Most fields in APE files and render data packages are 4 bytes or less
+	uint32_t readSize = 4;
+	RKIT_CHECK(ParseCount(args.SubSpan(1), readSize));
+
+	rkit::OSAbsPath path;
+	RKIT_CHECK(path.SetFromEncodedString(args[0]));
+
+	rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+	const rkit::IUtilitiesDriver &utils = *rkit::GetDrivers().m_utilitiesDriver;
+
+	rkit::UniquePtr<rkit::ISeekableReadStream> unbufferedStream;
+	RKIT_CHECK(sysDriver.OpenFileReadAbs(unbufferedStream, path, false));
+
+	rkit::UniquePtr<rkit::ISeekableReadStream> streamToBuffer;
+	RKIT_CHECK(sysDriver.OpenFileReadAbs(streamToBuffer, path, false));
+
+	// Read the whole file first so that both passes read from the OS cache
+	rkit::Vector<uint8_t> contents;
+	RKIT_CHECK(utils.ReadEntireFile(*unbufferedStream, contents));
+	RKIT_CHECK(unbufferedStream->SeekStart(0));
+
+	uint32_t expectedChecksum = 0;
+	for (uint8_t b : contents)
+		expectedChecksum = expectedChecksum * 31u + b;
+
+	rkit::UniquePtr<rkit::BufferedSeekableReadStream> bufferedStream;
+	RKIT_CHECK(utils.CreateBufferedSeekableReadStream(bufferedStream, std::move(streamToBuffer), 64 * 1024));
+
+	const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency();
+
+	uint32_t unbufferedChecksum = 0;
+	uint32_t bufferedChecksum = 0;
+
+	const uint64_t unbufferedStartTime = sysDriver.GetHighResTimestamp();
+	RKIT_CHECK(ReadInPieces(*unbufferedStream, contents.Count(), readSize, unbufferedChecksum));
+
+	const uint64_t bufferedStartTime = sysDriver.GetHighResTimestamp();
+	RKIT_CHECK(ReadInPieces(*bufferedStream, contents.Count(), readSize, bufferedChecksum));
+
+	const uint64_t endTime = sysDriver.GetHighResTimestamp();
+
+	const uint64_t unbufferedMicroseconds = (bufferedStartTime - unbufferedStartTime) * 1000000u / timerFrequency;
+	const uint64_t bufferedMicroseconds = (endTime - bufferedStartTime) * 1000000u / timerFrequency;
+
+	const bool matches = (unbufferedChecksum == expectedChecksum && bufferedChecksum == expectedChecksum);
+
+	rkit::log::LogInfoFmt(u8"{} bytes in {}-byte reads: unbuffered {} usec, buffered {} usec{}", contents.Count(), readSize, unbufferedMicroseconds, bufferedMicroseconds, matches ? u8"" : u8" (MISMATCH)");
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::RunRenderPackageBench(const rkit::Span<const rkit::StringView> &args)
+{
+	if (args.Count() < 1)
+	{
+		rkit::log::Error(u8"A file path is required");
+		RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+	}
+
+	uint32_t numLoads = 100;
+	RKIT_CHECK(ParseCount(args.SubSpan(1), numLoads));
+
+	rkit::OSAbsPath path;
+	RKIT_CHECK(path.SetFromEncodedString(args[0]));
+
+	rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+
+	if (!rkit::GetDrivers().m_moduleDriver->LoadModule(rkit::IModuleDriver::kDefaultNamespace, u8"Data"))
+	{
+		rkit::log::Error(u8"Couldn't load data module");
+		RKIT_THROW(rkit::ResultCode::kModuleLoadFailed);
+	}
+
+	rkit::data::IDataDriver *dataDriver = static_cast<rkit::data::IDataDriver *>(rkit::GetDrivers().FindDriver(rkit::IModuleDriver::kDefaultNamespace, u8"Data"));
+	const rkit::data::IRenderDataHandler &dataHandler = *dataDriver->GetRenderDataHandler();
+
+	// Packages are loaded from memory so that only the parse and fixup are timed
+	rkit::Vector<uint8_t> contents;
+	{
+		rkit::UniquePtr<rkit::ISeekableReadStream> stream;
+		RKIT_CHECK(sysDriver.OpenFileReadAbs(stream, path, false));
+		RKIT_CHECK(rkit::GetDrivers().m_utilitiesDriver->ReadEntireFile(*stream, contents));
+	}
+
+	const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency();
+
+	const uint64_t hashStartTime = sysDriver.GetHighResTimestamp();
+	uint64_t layoutHash = 0;
+	RKIT_CHECK(dataHandler.GetPackageLayoutHash(layoutHash));
+
+	const uint64_t loadStartTime = sysDriver.GetHighResTimestamp();
+	for (uint32_t i = 0; i < numLoads; i++)
+	{
+		rkit::ReadOnlyMemoryStream stream(contents.ToSpan());
+
+		rkit::UniquePtr<rkit::data::IRenderDataPackage> package;
+		rkit::Vector<rkit::Vector<uint8_t>> binaryContent;
+		RKIT_CHECK(dataHandler.LoadPackage(static_cast<rkit::ISeekableReadStream &>(stream), false, nullptr, package, &binaryContent));
+	}
+
+	const uint64_t endTime = sysDriver.GetHighResTimestamp();
+
+	const uint64_t hashMicroseconds = (loadStartTime - hashStartTime) * 1000000u / timerFrequency;
+	const uint64_t loadMicroseconds = (endTime - loadStartTime) * 1000000u / timerFrequency;
+
+	rkit::log::LogInfoFmt(u8"{} bytes: {} loads in {} usec, {} usec per load, layout hash {} usec", contents.Count(), numLoads, loadMicroseconds, loadMicroseconds / numLoads, hashMicroseconds);
+
+	RKIT_RETURN_OK;
+}
+
+void anox::BenchProgram::StripedCopy::CopyRange(uint64_t offset, uint64_t size) const
+{
+	rkit::StreamingCopyRows(m_dest, m_src, m_rowSizeBytes, m_rowInPitch, m_rowOutPitch, m_rowCount, offset, size);
+}
+
+rkit::Result anox::BenchProgram::RunStripedUploadBench(const rkit::Span<const rkit::StringView> &args)
+{
+	uint32_t numCopies = 64;
+	RKIT_CHECK(ParseCount(args, numCopies));
+
+	// Texture rows that are tightly packed in the source but padded to the upload pitch
+	// alignment in the destination, plus a buffer upload every 8th copy
+	const uint32_t kTextureRowSize = 1000;
+	const uint32_t kTextureRowOutPitch = 1024;
+	const uint32_t kTextureRowCount = 256;
+	const uint32_t kBufferSize = 192 * 1024;
+
+	rkit::Vector<StripedCopy> copies;
+	RKIT_CHECK(copies.Resize(numCopies));
+
+	size_t srcSize = 0;
+	size_t destSize = 0;
+	uint64_t totalCopyBytes = 0;
+	for (uint32_t i = 0; i < numCopies; i++)
+	{
+		StripedCopy &copy = copies[i];
+		copy.m_srcOffset = srcSize;
+		copy.m_destOffset = destSize;
+
+		if (i % 8u == 7u)
+		{
+			copy.m_rowSizeBytes = kBufferSize;
+			copy.m_rowCount = 1;
+		}
+		else
+		{
+			copy.m_rowSizeBytes = kTextureRowSize;
+			copy.m_rowInPitch = kTextureRowSize;
+			copy.m_rowOutPitch = kTextureRowOutPitch;
+			copy.m_rowCount = kTextureRowCount;
+		}
+
+		const uint32_t inPitch = (copy.m_rowCount == 1) ? copy.m_rowSizeBytes : copy.m_rowInPitch;
+		const uint32_t outPitch = (copy.m_rowCount == 1) ? copy.m_rowSizeBytes : copy.m_rowOutPitch;
+
+		srcSize += static_cast<size_t>(inPitch) * copy.m_rowCount;
+		destSize += static_cast<size_t>(outPitch) * copy.m_rowCount;
+		totalCopyBytes += static_cast<uint64_t>(copy.m_rowSizeBytes) * copy.m_rowCount;
+	}
+
+	rkit::Vector<uint8_t> srcBytes;
+	rkit::Vector<uint8_t> referenceDest;
+	rkit::Vector<uint8_t> stripedDest;
+	RKIT_CHECK(srcBytes.Resize(srcSize));
+	RKIT_CHECK(referenceDest.Resize(destSize));
+	RKIT_CHECK(stripedDest.Resize(destSize));
+
+	rkit::XorShift32 rng;
+	for (uint8_t &b : srcBytes)
+		b = static_cast<uint8_t>(rng.Next() >> 24);
+
+	memset(referenceDest.GetBuffer(), 0, destSize);
+	memset(stripedDest.GetBuffer(), 0, destSize);
+
+	for (StripedCopy &copy : copies)
+	{
+		copy.m_src = srcBytes.GetBuffer() + copy.m_srcOffset;
+		copy.m_dest = stripedDest.GetBuffer() + copy.m_destOffset;
+	}
+
+	rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+	const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency();
+
+	// Split the same way as the graphics subsystem
+	const rkit::ConstSpan<StripedCopy> copySpan = copies.ToSpan();
+	const uint64_t numRanges = rkit::ComputeNumStripedCopyJobs(totalCopyBytes, sysDriver.GetProcessorCount());
+
+	// The pool is started before timing, so that thread startup isn't measured
+	rkit::UniquePtr<rkit::IEvent> wakeEvent;
+	rkit::UniquePtr<rkit::IEvent> terminateEvent;
+	RKIT_CHECK(sysDriver.CreateEvent(wakeEvent, true, false));
+	RKIT_CHECK(sysDriver.CreateEvent(terminateEvent, true, false));
+
+	const uint32_t numThreads = rkit::GetDrivers().m_utilitiesDriver->ComputeThreadPoolSize(true);
+
+	rkit::UniquePtr<rkit::utils::IThreadPool> threadPool;
+	RKIT_CHECK(rkit::GetDrivers().m_utilitiesDriver->CreateThreadPool(threadPool, numThreads));
+
+	rkit::IJobQueue &jobQueue = *threadPool->GetJobQueue();
+
+	rkit::Vector<rkit::RCPtr<rkit::Job>> copyJobs;
+	RKIT_CHECK(copyJobs.Reserve(static_cast<size_t>(numRanges)));
+
+	// Previous behavior: one job copies every row with memcpy
+	const uint64_t referenceStartTime = sysDriver.GetHighResTimestamp();
+	for (const StripedCopy &copy : copies)
+	{
+		const uint8_t *src = srcBytes.GetBuffer() + copy.m_srcOffset;
+		uint8_t *dest = referenceDest.GetBuffer() + copy.m_destOffset;
+
+		for (uint32_t row = 0; row < copy.m_rowCount; row++)
+		{
+			memcpy(dest, src, copy.m_rowSizeBytes);
+			src += copy.m_rowInPitch;
+			dest += copy.m_rowOutPitch;
+		}
+	}
+
+	// The same copy jobs that the graphics subsystem queues, including job creation and wake-up
+	const uint64_t stripedStartTime = sysDriver.GetHighResTimestamp();
+	for (uint64_t rangeIndex = 0; rangeIndex < numRanges; rangeIndex++)
+	{
+		const uint64_t firstByte = totalCopyBytes * rangeIndex / numRanges;
+		const uint64_t endByte = totalCopyBytes * (rangeIndex + 1) / numRanges;
+
+		rkit::UniquePtr<rkit::StripedCopyJobRunner<StripedCopy>> copyJobRunner;
+		RKIT_CHECK(rkit::New<rkit::StripedCopyJobRunner<StripedCopy>>(copyJobRunner, copySpan, firstByte, endByte));
+
+		rkit::RCPtr<rkit::Job> copyJob;
+		RKIT_CHECK(jobQueue.CreateJob(&copyJob, rkit::JobType::kNormalPriority, std::move(copyJobRunner), rkit::JobDependencyList()));
+
+		RKIT_CHECK(copyJobs.Append(std::move(copyJob)));
+	}
+
+	rkit::RCPtr<rkit::Job> doneJob;
+	RKIT_CHECK(jobQueue.CreateJob(&doneJob, rkit::JobType::kNormalPriority, rkit::UniquePtr<rkit::IJobRunner>(), copyJobs.ToSpan()));
+
+	copyJobs.Reset();
+
+	jobQueue.WaitForJob(*doneJob, threadPool->GetAllJobTypes(), wakeEvent.Get(), terminateEvent.Get());
+
+	const uint64_t endTime = sysDriver.GetHighResTimestamp();
+
+	RKIT_CHECK(jobQueue.CheckFault());
+	RKIT_CHECK(rkit::utils::ThrowResult(threadPool->Close()));
+
+	const bool matches = !memcmp(referenceDest.GetBuffer(), stripedDest.GetBuffer(), destSize);
+
+	const uint64_t referenceMicroseconds = (stripedStartTime - referenceStartTime) * 1000000u / timerFrequency;
+	const uint64_t stripedMicroseconds = (endTime - stripedStartTime) * 1000000u / timerFrequency;
+
+	rkit::log::LogInfoFmt(u8"{} copies, {} bytes in {} jobs on {} threads: row memcpy {} usec, striped streaming copy {} usec{}", numCopies, totalCopyBytes, numRanges, numThreads, referenceMicroseconds, stripedMicroseconds, matches ? u8"" : u8" (MISMATCH)");
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::RunLockContentionBench(const rkit::Span<const rkit::StringView> &args)
+{
+	uint32_t numLookups = 1000000;
+	RKIT_CHECK(ParseCount(args, numLookups));
+
+	rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+	const uint32_t numThreads = rkit::Max<uint32_t>(sysDriver.GetProcessorCount(), 1);
+
+	// Power of two, so that slots can be picked with a mask
+	rkit::Vector<uint32_t> table;
+	RKIT_CHECK(table.Resize(4096));
+
+	for (uint32_t &value : table)
+		value = 0;
+
+	rkit::UniquePtr<rkit::IMutex> mutex;
+	rkit::UniquePtr<rkit::IReadWriteLock> rwLock;
+	RKIT_CHECK(sysDriver.CreateMutex(mutex));
+	RKIT_CHECK(sysDriver.CreateReadWriteLock(rwLock));
+
+	LockContentionState state;
+	state.m_table = table.ToSpan();
+	state.m_numLookups = numLookups;
+
+	uint64_t mutexMicroseconds = 0;
+	uint64_t rwLockMicroseconds = 0;
+
+	state.m_mutex = mutex.Get();
+	RKIT_CHECK(RunLockContentionPass(state, numThreads, mutexMicroseconds));
+
+	state.m_mutex = nullptr;
+	state.m_rwLock = rwLock.Get();
+	RKIT_CHECK(RunLockContentionPass(state, numThreads, rwLockMicroseconds));
+
+	rkit::log::LogInfoFmt(u8"{} threads, {} lookups each (1 in 64 writes): mutex {} usec, reader-writer lock {} usec", numThreads, numLookups, mutexMicroseconds, rwLockMicroseconds);
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::RunLockContentionPass(const LockContentionState &baseState, uint32_t numThreads, uint64_t &outMicroseconds)
+{
+	rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+
+	rkit::UniquePtr<rkit::IEvent> startEvent;
+	RKIT_CHECK(sysDriver.CreateEvent(startEvent, false, false));
+
+	LockContentionState state = baseState;
+	state.m_startEvent = startEvent.Get();
+
+	rkit::Vector<uint32_t> checksums;
+	RKIT_CHECK(checksums.Resize(numThreads));
+
+	// Threads are finalized when this is destroyed, so it must be declared after everything
+	// that the threads use
+	rkit::Vector<rkit::UniqueThreadRef> threads;
+	RKIT_CHECK(threads.Resize(numThreads));
+
+	// Threads that did start are blocked on the start event, so release them before they are
+	// finalized if any of the others failed
+	RKIT_TRY_CATCH_RETHROW(StartLockContentionThreads(state, threads.ToSpan(), checksums.ToSpan()),
+		rkit::CatchContext(
+			[&startEvent]
+			{
+				startEvent->Signal();
+			}
+		)
+	);
+
+	const uint64_t startTime = sysDriver.GetHighResTimestamp();
+
+	startEvent->Signal();
+
+	for (rkit::UniqueThreadRef &thread : threads)
+	{
+		RKIT_CHECK(rkit::utils::ThrowResult(thread.Finalize()));
+	}
+
+	const uint64_t endTime = sysDriver.GetHighResTimestamp();
+
+	outMicroseconds = (endTime - startTime) * 1000000u / sysDriver.GetHighResTimestampFrequency();
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::StartLockContentionThreads(const LockContentionState &state, const rkit::Span<rkit::UniqueThreadRef> &threads, const rkit::Span<uint32_t> &checksums)
+{
+	rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+
+	for (size_t i = 0; i < threads.Count(); i++)
+	{
+		rkit::UniquePtr<rkit::IThreadContext> context;
+		RKIT_CHECK(rkit::New<LockContentionThreadContext>(context, state, rkit::XorShift32::kDefaultSeed + static_cast<uint32_t>(i), checksums[i]));
+
+		RKIT_CHECK(sysDriver.CreateThread(threads[i], std::move(context), u8"LockBench"));
+	}
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::RunAPEParseBench(const rkit::Span<const rkit::StringView> &args)
+{
+	if (args.Count() < 1)
+	{
+		rkit::log::Error(u8"A directory path is required");
+		RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+	}
+
+	uint32_t numPasses = 20;
+	RKIT_CHECK(ParseCount(args.SubSpan(1), numPasses));
+
+	rkit::OSAbsPath dirPath;
+	RKIT_CHECK(dirPath.SetFromEncodedString(args[0]));
+
+	rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+
+	const IBuildDriver *buildDriver = nullptr;
+	RKIT_CHECK(LoadAnoxBuildDriver(buildDriver));
+
+	// Scripts are loaded up front so that only the parse is timed
+	rkit::Vector<rkit::Vector<uint8_t>> files;
+	size_t totalBytes = 0;
+	RKIT_CHECK(LoadAPEFiles(dirPath, files, totalBytes));
+
+	// Every allocation made during the parse passes goes through the counting driver
+	CountingMallocDriver countingDriver(*rkit::GetDrivers().m_mallocDriver);
+	const rkit::SimpleObjectAllocation<rkit::IMallocDriver> prevMallocDriver = rkit::GetDrivers().m_mallocDriver;
+
+	rkit::GetMutableDrivers().m_mallocDriver.m_obj = &countingDriver;
+
+	const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency();
+	const uint64_t startTime = sysDriver.GetHighResTimestamp();
+
+	size_t numCommands = 0;
+	RKIT_TRY_FINALLY_RETHROW(RunAPEParsePasses(*buildDriver, files, numPasses, numCommands),
+		rkit::FinallyContext(
+			[&prevMallocDriver]
+			{
+				rkit::GetMutableDrivers().m_mallocDriver = prevMallocDriver;
+			}
+		)
+	);
+
+	const uint64_t endTime = sysDriver.GetHighResTimestamp();
+	const uint64_t microseconds = (endTime - startTime) * 1000000u / timerFrequency;
+
+	rkit::log::LogInfoFmt(u8"{} files, {} bytes, {} commands: {} passes in {} usec, {} usec per pass", files.Count(), totalBytes, numCommands, numPasses, microseconds, microseconds / numPasses);
+	rkit::log::LogInfoFmt(u8"{} allocations, {} bytes allocated per pass", countingDriver.GetNumAllocs() / numPasses, countingDriver.GetNumBytes() / numPasses);
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::RunAPEParsePasses(const IBuildDriver &buildDriver, const rkit::Vector<rkit::Vector<uint8_t>> &files, uint32_t numPasses, size_t &outNumCommands)
+{
+	size_t numCommands = 0;
+
+	for (uint32_t pass = 0; pass < numPasses; pass++)
+	{
+		numCommands = 0;
+
+		for (const rkit::Vector<uint8_t> &contents : files)
+		{
+			size_t fileCommands = 0;
+			RKIT_CHECK(buildDriver.ParseAPEScript(contents.ToSpan(), fileCommands));
+
+			numCommands += fileCommands;
+		}
+	}
+
+	outNumCommands = numCommands;
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::RunAPECompileBench(const rkit::Span<const rkit::StringView> &args)
+{
+	if (args.Count() < 1)
+	{
+		rkit::log::Error(u8"A directory path is required");
+		RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+	}
+
+	uint32_t numPasses = 5;
+	RKIT_CHECK(ParseCount(args.SubSpan(1), numPasses));
+
+	rkit::OSAbsPath dirPath;
+	RKIT_CHECK(dirPath.SetFromEncodedString(args[0]));
+
+	rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+
+	const IBuildDriver *buildDriver = nullptr;
+	RKIT_CHECK(LoadAnoxBuildDriver(buildDriver));
+
+	rkit::Vector<rkit::Vector<uint8_t>> files;
+	size_t totalBytes = 0;
+	RKIT_CHECK(LoadAPEFiles(dirPath, files, totalBytes));
+
+	if (!rkit::GetDrivers().m_moduleDriver->LoadModule(rkit::IModuleDriver::kDefaultNamespace, u8"Build"))
+	{
+		rkit::log::Error(u8"Couldn't load build module");
+		RKIT_THROW(rkit::ResultCode::kModuleLoadFailed);
+	}
+
+	rkit::buildsystem::IBuildSystemDriver *bsDriver = static_cast<rkit::buildsystem::IBuildSystemDriver *>(rkit::GetDrivers().FindDriver(rkit::IModuleDriver::kDefaultNamespace, u8"BuildSystem"));
+
+	// Batches run on the build instance's thread pool, the same as during a build
+	rkit::UniquePtr<rkit::buildsystem::IBuildSystemInstance> instance;
+	RKIT_CHECK(bsDriver->CreateBuildSystemInstance(instance));
+	RKIT_CHECK(instance->Initialize(u8"bench", dirPath, dirPath, dirPath, dirPath));
+
+	// The last entry never splits, so it's the single-threaded baseline
+	const size_t minItemsPerBatchValues[] = { 16, 64, 256, 1024, 4096, std::numeric_limits<size_t>::max() };
+
+	const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency();
+
+	for (size_t minItemsPerBatch : minItemsPerBatchValues)
+	{
+		// Untimed pass, so that thread pool startup isn't counted
+		for (const rkit::Vector<uint8_t> &contents : files)
+		{
+			RKIT_CHECK(buildDriver->CompileAPEScript(*instance, contents.ToSpan(), minItemsPerBatch));
+		}
+
+		const uint64_t startTime = sysDriver.GetHighResTimestamp();
+
+		for (uint32_t pass = 0; pass < numPasses; pass++)
+		{
+			for (const rkit::Vector<uint8_t> &contents : files)
+			{
+				RKIT_CHECK(buildDriver->CompileAPEScript(*instance, contents.ToSpan(), minItemsPerBatch));
+			}
+		}
+
+		const uint64_t endTime = sysDriver.GetHighResTimestamp();
+		const uint64_t microseconds = (endTime - startTime) * 1000000u / timerFrequency;
+
+		if (minItemsPerBatch == std::numeric_limits<size_t>::max())
+			rkit::log::LogInfoFmt(u8"{} files, {} bytes, unbatched: {} usec per pass", files.Count(), totalBytes, microseconds / numPasses);
+		else
+			rkit::log::LogInfoFmt(u8"{} files, {} bytes, at least {} items per batch: {} usec per pass", files.Count(), totalBytes, minItemsPerBatch, microseconds / numPasses);
+	}
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::LoadAnoxBuildDriver(const IBuildDriver *&outBuildDriver)
+{
+	if (!rkit::GetDrivers().m_moduleDriver->LoadModule(anox::kAnoxNamespaceID, u8"Build"))
+	{
+		rkit::log::Error(u8"Couldn't load build module");
+		RKIT_THROW(rkit::ResultCode::kModuleLoadFailed);
+	}
+
+	outBuildDriver = static_cast<const IBuildDriver *>(rkit::GetDrivers().FindDriver(anox::kAnoxNamespaceID, u8"Build"));
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::LoadAPEFiles(const rkit::OSAbsPathView &dirPath, rkit::Vector<rkit::Vector<uint8_t>> &outFiles, size_t &outTotalBytes)
+{
+	rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+
+	size_t totalBytes = 0;
+
+	rkit::UniquePtr<rkit::IDirectoryScan> dirScan;
+	RKIT_CHECK(sysDriver.OpenDirectoryScanAbs(dirScan, dirPath, false));
+
+	for (;;)
+	{
+		bool haveItem = false;
+		rkit::DirectoryScanItem scanItem;
+		RKIT_CHECK(dirScan->GetNext(haveItem, scanItem));
+
+		if (!haveItem)
+			break;
+
+		if (scanItem.m_attribs.m_isDirectory || !scanItem.m_fileName.ToStringView().EndsWithNoCase(RKIT_OS_PATH_LITERAL(".ape")))
+			continue;
+
+		rkit::OSAbsPath filePath;
+		RKIT_CHECK(filePath.Set(dirPath));
+		RKIT_CHECK(filePath.Append(scanItem.m_fileName));
+
+		rkit::UniquePtr<rkit::ISeekableReadStream> stream;
+		RKIT_CHECK(sysDriver.OpenFileReadAbs(stream, filePath, false));
+
+		rkit::Vector<uint8_t> contents;
+		RKIT_CHECK(rkit::GetDrivers().m_utilitiesDriver->ReadEntireFile(*stream, contents));
+
+		totalBytes += contents.Count();
+		RKIT_CHECK(outFiles.Append(std::move(contents)));
+	}
+
+	if (outFiles.Count() == 0)
+	{
+		rkit::log::Error(u8"No APE files were found");
+		RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+	}
+
+	outTotalBytes = totalBytes;
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::RunBuildCacheBench(const rkit::Span<const rkit::StringView> &args)
+{
+	if (args.Count() < 1)
+	{
+		rkit::log::Error(u8"An intermediate directory path is required");
+		RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+	}
+
+	uint32_t numPasses = 5;
+	RKIT_CHECK(ParseCount(args.SubSpan(1), numPasses));
+
+	rkit::OSAbsPath intermedDir;
+	RKIT_CHECK(intermedDir.SetFromEncodedString(args[0]));
+
+	if (!rkit::GetDrivers().m_moduleDriver->LoadModule(rkit::IModuleDriver::kDefaultNamespace, u8"Build"))
+	{
+		rkit::log::Error(u8"Couldn't load build module");
+		RKIT_THROW(rkit::ResultCode::kModuleLoadFailed);
+	}
+
+	rkit::buildsystem::IBuildSystemDriver *bsDriver = static_cast<rkit::buildsystem::IBuildSystemDriver *>(rkit::GetDrivers().FindDriver(rkit::IModuleDriver::kDefaultNamespace, u8"BuildSystem"));
+
+	rkit::UniquePtr<rkit::buildsystem::IBuildSystemInstance> instance;
+	RKIT_CHECK(bsDriver->CreateBuildSystemInstance(instance));
+
+	// Only the intermediate directory is used, since nothing is built
+	RKIT_CHECK(instance->Initialize(u8"bench", intermedDir, intermedDir, intermedDir, intermedDir));
+
+	// Records can only be decoded if every node type in the cache is registered
+	if (!rkit::GetDrivers().m_moduleDriver->LoadModule(anox::kAnoxNamespaceID, u8"Build"))
+	{
+		rkit::log::Error(u8"Couldn't load Anox build module");
+		RKIT_THROW(rkit::ResultCode::kModuleLoadFailed);
+	}
+
+	IBuildDriver *anoxBuildDriver = static_cast<IBuildDriver *>(rkit::GetDrivers().FindDriver(anox::kAnoxNamespaceID, u8"Build"));
+	RKIT_CHECK(anoxBuildDriver->RegisterBuildSystemAddOn(instance.Get()));
+
+	if (!rkit::GetDrivers().m_moduleDriver->LoadModule(rkit::IModuleDriver::kDefaultNamespace, u8"Build_Vulkan"))
+	{
+		rkit::log::Error(u8"Couldn't load render build add-on module");
+		RKIT_THROW(rkit::ResultCode::kModuleLoadFailed);
+	}
+
+	rkit::buildsystem::IBuildSystemAddOnDriver *renderAddOnDriver = static_cast<rkit::buildsystem::IBuildSystemAddOnDriver *>(rkit::GetDrivers().FindDriver(rkit::IModuleDriver::kDefaultNamespace, u8"Build_Vulkan"));
+	RKIT_CHECK(renderAddOnDriver->RegisterBuildSystemAddOn(instance.Get()));
+
+	RKIT_CHECK(instance->BenchmarkCache(numPasses));
+
+	RKIT_RETURN_OK;
+}
+
+template<class TStream>
+rkit::Result anox::BenchProgram::ReadInPieces(TStream &stream, size_t fileSize, size_t readSize, uint32_t &outChecksum)
+{
+	uint8_t bytes[256];
+	if (readSize > sizeof(bytes))
+		readSize = sizeof(bytes);
+
+	uint32_t checksum = 0;
+	size_t sizeRemaining = fileSize;
+	while (sizeRemaining > 0)
+	{
+		const size_t pieceSize = (sizeRemaining < readSize) ? sizeRemaining : readSize;
+
+		RKIT_CHECK(stream.ReadAll(bytes, pieceSize));
+
+		for (size_t i = 0; i < pieceSize; i++)
+			checksum = checksum * 31u + bytes[i];
+
+		sizeRemaining -= pieceSize;
+	}
+
+	outChecksum = checksum;
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::BenchProgram::Run()
+{
+	rkit::Span<const rkit::StringView> args = rkit::GetDrivers().m_systemDriver->GetCommandLine();
+
+	if (args.Count() >= 1)
+	{
+		const rkit::Span<const rkit::StringView> benchArgs = args.SubSpan(1);
+
+		if (args[0] == u8"imagekernels")
+			return RunImageKernelBench(benchArgs);
+
+		if (args[0] == u8"dedup")
+			return RunDedupBench(benchArgs);
+
+		if (args[0] == u8"floatparse")
+			return RunFloatParseBench(benchArgs);
+
+		if (args[0] == u8"bufferedread")
+			return RunBufferedReadBench(benchArgs);
+
+		if (args[0] == u8"renderpackage")
+			return RunRenderPackageBench(benchArgs);
+
+		if (args[0] == u8"stripedupload")
+			return RunStripedUploadBench(benchArgs);
+
+		if (args[0] == u8"lockcontention")
+			return RunLockContentionBench(benchArgs);
+
+		if (args[0] == u8"apeparse")
+			return RunAPEParseBench(benchArgs);
+
+		if (args[0] == u8"apecompile")
+			return RunAPECompileBench(benchArgs);
+
+		if (args[0] == u8"buildcache")
+			return RunBuildCacheBench(benchArgs);
+	}
+
+	::rkit::log::Error(u8"Usage: Bench imagekernels [pixel count]");
+	::rkit::log::Error(u8"       Bench dedup [item count]");
+	::rkit::log::Error(u8"       Bench floatparse [value count]");
+	::rkit::log::Error(u8"       Bench bufferedread <file path> [read size]");
+	::rkit::log::Error(u8"       Bench renderpackage <file path> [load count]");
+	::rkit::log::Error(u8"       Bench stripedupload [copy count]");
+	::rkit::log::Error(u8"       Bench lockcontention [lookups per thread]");
+	::rkit::log::Error(u8"       Bench apeparse <directory path> [pass count]");
+	::rkit::log::Error(u8"       Bench apecompile <directory path> [pass count]");
+	::rkit::log::Error(u8"       Bench buildcache <intermediate directory path> [pass count]");
+	RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+}
+
+RKIT_IMPLEMENT_MODULE(Tool, Bench, ::anox::BenchModule)
@@ -3,11 +3,18 @@
 #include "anox/AnoxUtilitiesDriver.h"
 
 #include "rkit/Core/Drivers.h"
+#include "rkit/Core/Event.h"
+#include "rkit/Core/FileMapping.h"
+#include "rkit/Core/HashTable.h"
+#include "rkit/Core/Job.h"
+#include "rkit/Core/JobQueue.h"
 #include "rkit/Core/LogDriver.h"
 #include "rkit/Core/Module.h"
 #include "rkit/Core/ModuleDriver.h"
 #include "rkit/Core/ModuleGlue.h"
+#include "rkit/Core/NewDelete.h"
 #include "rkit/Core/Path.h"
+#include "rkit/Core/RefCounted.h"
 #include "rkit/Core/Stream.h"
 #include "rkit/Core/ProgramDriver.h"
 #include "rkit/Core/DriverModuleStub.h"
@@ -17,6 +24,13 @@
 #include "rkit/Core/SystemDriver.h"
 #include "rkit/Core/StringProto.h"
 #include "rkit/Core/String.h"
+#include "rkit/Core/UtilitiesDriver.h"
+#include "rkit/Core/Vector.h"
+
+#include "rkit/Utilities/Sha2.h"
+#include "rkit/Utilities/ThreadPool.h"
+
+#include <cstring>
 
 namespace anox
 {
@@ -26,30 +40,164 @@ namespace anox
 		rkit::Result Run() override;
 
 	private:
+		class ExtractFileJobRunner final : public rkit::IJobRunner
+		{
+		public:
+			ExtractFileJobRunner(const afs::FileHandle &fileHandle, rkit::OSAbsPath &&outPath, bool verify);
+
+			rkit::Result Run() override;
+
+		private:
+			rkit::Result VerifyOutput(const rkit::utils::Sha256DigestBytes &expectedDigest) const;
+
+			afs::FileHandle m_fileHandle;
+			rkit::OSAbsPath m_outPath;
+			bool m_verify;
+		};
+
+		static const size_t kCopyBufferSize = 1024 * 1024;
 	};
 
 	typedef rkit::DriverModuleStub<rkit::ProgramStubDriver<ExtractDATProgram>, rkit::IProgramDriver, &rkit::Drivers::m_programDriver> ExtractDATModule;
 }
 
+anox::ExtractDATProgram::ExtractFileJobRunner::ExtractFileJobRunner(const afs::FileHandle &fileHandle, rkit::OSAbsPath &&outPath, bool verify)
+	: m_fileHandle(fileHandle)
+	, m_outPath(std::move(outPath))
+	, m_verify(verify)
+{
+}
+
+rkit::Result anox::ExtractDATProgram::ExtractFileJobRunner::Run()
+{
+	rkit::UniquePtr<rkit::ISeekableReadStream> fileStream;
+	RKIT_CHECK(m_fileHandle.Open(fileStream));
+
+	// Opened here rather than when the job is queued, so only the files being extracted hold handles.
+	// The parent directories were already created by the main thread.
+	rkit::UniquePtr<rkit::ISeekableWriteStream> writeStream;
+	RKIT_CHECK(rkit::GetDrivers().m_systemDriver->OpenFileWriteAbs(writeStream, m_outPath, true, false, true, false));
+
+	const uint32_t fileSize = m_fileHandle.GetFileSize();
+
+	size_t bufferSize = kCopyBufferSize;
+	if (bufferSize > fileSize)
+		bufferSize = fileSize;
+
+	rkit::Vector<uint8_t> buffer;
+	RKIT_CHECK(buffer.Resize(bufferSize));
+
+	const rkit::utils::ISha256Calculator *calculator = rkit::GetDrivers().m_utilitiesDriver->GetSha256Calculator();
+	rkit::utils::Sha256StreamingState streamingState = calculator->CreateStreamingState();
+
+	uint32_t sizeRemaining = fileSize;
+
+	while (sizeRemaining > 0)
+	{
+		size_t chunkSize = bufferSize;
+		if (chunkSize > sizeRemaining)
+			chunkSize = sizeRemaining;
+
+		RKIT_CHECK(fileStream->ReadAll(buffer.GetBuffer(), chunkSize));
+		RKIT_CHECK(writeStream->WriteAll(buffer.GetBuffer(), chunkSize));
+
+		if (m_verify)
+			calculator->AppendStreamingState(streamingState, buffer.GetBuffer(), chunkSize);
+
+		sizeRemaining -= static_cast<uint32_t>(chunkSize);
+	}
+
+	RKIT_CHECK(writeStream->Flush());
+	writeStream.Reset();
+
+	if (m_verify)
+	{
+		calculator->FinalizeStreamingState(streamingState);
+
+		RKIT_CHECK(VerifyOutput(calculator->FlushToBytes(streamingState.m_state)));
+	}
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::ExtractDATProgram::ExtractFileJobRunner::VerifyOutput(const rkit::utils::Sha256DigestBytes &expectedDigest) const
+{
+	rkit::UniquePtr<rkit::ISeekableReadStream> readStream;
+	RKIT_CHECK(rkit::GetDrivers().m_systemDriver->OpenFileReadAbs(readStream, m_outPath, false));
+
+	const rkit::FilePos_t fileSize = readStream->GetSize();
+	if (fileSize != m_fileHandle.GetFileSize())
+	{
+		rkit::log::ErrorFmt(u8"Verification failed for {}: Size mismatch", m_fileHandle.GetFilePath().ToUTF8());
+		RKIT_THROW(rkit::ResultCode::kDataError);
+	}
+
+	size_t bufferSize = kCopyBufferSize;
+	if (bufferSize > fileSize)
+		bufferSize = static_cast<size_t>(fileSize);
+
+	rkit::Vector<uint8_t> buffer;
+	RKIT_CHECK(buffer.Resize(bufferSize));
+
+	const rkit::utils::ISha256Calculator *calculator = rkit::GetDrivers().m_utilitiesDriver->GetSha256Calculator();
+	rkit::utils::Sha256StreamingState streamingState = calculator->CreateStreamingState();
+
+	rkit::FilePos_t sizeRemaining = fileSize;
+
+	while (sizeRemaining > 0)
+	{
+		size_t chunkSize = bufferSize;
+		if (chunkSize > sizeRemaining)
+			chunkSize = static_cast<size_t>(sizeRemaining);
+
+		RKIT_CHECK(readStream->ReadAll(buffer.GetBuffer(), chunkSize));
+		calculator->AppendStreamingState(streamingState, buffer.GetBuffer(), chunkSize);
+
+		sizeRemaining -= chunkSize;
+	}
+
+	calculator->FinalizeStreamingState(streamingState);
+
+	const rkit::utils::Sha256DigestBytes digest = calculator->FlushToBytes(streamingState.m_state);
+
+	if (memcmp(digest.m_data, expectedDigest.m_data, sizeof(digest.m_data)))
+	{
+		rkit::log::ErrorFmt(u8"Verification failed for {}: Content mismatch", m_fileHandle.GetFilePath().ToUTF8());
+		RKIT_THROW(rkit::ResultCode::kDataError);
+	}
+
+	RKIT_RETURN_OK;
+}
+
 rkit::Result anox::ExtractDATProgram::Run()
 {
 	rkit::IModule *anoxUtilsModule = rkit::GetDrivers().m_moduleDriver->LoadModule(anox::kAnoxNamespaceID, u8"Utilities");
 	if (!anoxUtilsModule)
 		RKIT_THROW(rkit::ResultCode::kModuleLoadFailed);
 
-	rkit::Span<const rkit::StringView> args = rkit::GetDrivers().m_systemDriver->GetCommandLine();
+	rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
 
-	if (args.Count() != 2)
+	rkit::Span<const rkit::StringView> args = sysDriver.GetCommandLine();
+
+	bool verify = false;
+	if (args.Count() == 3 && args[2] == u8"-verify")
+		verify = true;
+	else if (args.Count() != 2)
 	{
-		::rkit::log::Error(u8"Usage: ExtractDAT <input> <output>");
+		::rkit::log::Error(u8"Usage: ExtractDAT <input> <output> [-verify]");
 		RKIT_THROW(rkit::ResultCode::kInvalidParameter);
 	}
 
 	rkit::OSAbsPath inPath;
 	RKIT_CHECK(inPath.SetFromEncodedString(args[0]));
 
-	rkit::UniquePtr<rkit::ISeekableReadStream> datFileStream;
-	RKIT_TRY_CATCH_RETHROW(rkit::GetDrivers().m_systemDriver->OpenFileReadAbs(datFileStream, inPath, false),
+	rkit::OSAbsPath outBasePath;
+	RKIT_CHECK(outBasePath.SetFromEncodedString(args[1]));
+
+	// The archive is mapped so that the extract jobs copy entries out of the page cache instead of
+	// taking turns seeking and reading one shared file handle
+	rkit::UniquePtr<rkit::IFileMapping> datFileMapping;
+	RKIT_TRY_CATCH_RETHROW(sysDriver.OpenFileMappingAbs(datFileMapping, inPath, rkit::FileMappingMode::kReadOnly, rkit::FileAccessHint::kSequential, false),
 		rkit::CatchContext(
 			[]
 			{
@@ -58,6 +206,12 @@ rkit::Result anox::ExtractDATProgram::Run()
 		)
 	);
 
+	rkit::UniquePtr<rkit::IFileMappingView> datFileView;
+	RKIT_CHECK(datFileMapping->MapEntireFile(datFileView));
+
+	rkit::UniquePtr<rkit::ISeekableReadStream> datFileStream;
+	RKIT_CHECK(rkit::New<rkit::MappedViewReadStream>(datFileStream, std::move(datFileView)));
+
 	anox::IUtilitiesDriver *anoxUtils = static_cast<anox::IUtilitiesDriver*>(rkit::GetDrivers().FindDriver(kAnoxNamespaceID, u8"Utilities"));
 
 	RKIT_ASSERT(anoxUtils);
@@ -65,46 +219,78 @@ rkit::Result anox::ExtractDATProgram::Run()
 	rkit::UniquePtr<anox::afs::IArchive> archive;
 	RKIT_CHECK(anoxUtils->OpenAFSArchive(std::move(datFileStream), archive));
 
-	for (anox::afs::FileHandle fh : archive->GetFiles())
-	{
-		rkit::UniquePtr<rkit::ISeekableReadStream> fileStream;
-		RKIT_CHECK(fh.Open(fileStream));
+	rkit::UniquePtr<rkit::IEvent> mainThreadWakeEvent;
+	rkit::UniquePtr<rkit::IEvent> mainThreadTerminateEvent;
+	RKIT_CHECK(sysDriver.CreateEvent(mainThreadWakeEvent, true, false));
+	RKIT_CHECK(sysDriver.CreateEvent(mainThreadTerminateEvent, true, false));
 
-		uint32_t fileSize = fh.GetFileSize();
-		rkit::AsciiStringView filePath = fh.GetFilePath();
+	// This thread runs extract jobs while it waits
+	const uint32_t numThreads = rkit::GetDrivers().m_utilitiesDriver->ComputeThreadPoolSize(true);
 
+	// The thread pool must be destroyed before the archive, since the jobs reference it
+	rkit::UniquePtr<rkit::utils::IThreadPool> threadPool;
+	RKIT_CHECK(rkit::GetDrivers().m_utilitiesDriver->CreateThreadPool(threadPool, numThreads));
 
-		rkit::OSAbsPath outPath;
-		RKIT_CHECK(outPath.SetFromEncodedString(args[1]));
+	rkit::IJobQueue &jobQueue = *threadPool->GetJobQueue();
 
-		if (true)
-			RKIT_THROW(rkit::ResultCode::kNotYetImplemented);	// fix path handling here
+	rkit::Vector<rkit::RCPtr<rkit::Job>> extractJobs;
 
-		rkit::OSRelPath fpath;
-		RKIT_CHECK(fpath.SetFromEncodedString(filePath.ToUTF8()));
+	// Output directories are created once here, so the extract jobs only open and write files
+	bool createdDir = false;
+	RKIT_CHECK(sysDriver.CreateDirectoriesAbs(createdDir, outBasePath, false));
 
-		RKIT_CHECK(outPath.Append(fpath));
+	rkit::HashSet<rkit::CIPath> createdDirs;
 
-		rkit::UniquePtr<rkit::ISeekableWriteStream> writeStream;
-		RKIT_CHECK(rkit::GetDrivers().m_systemDriver->OpenFileWriteAbs(writeStream, outPath, true, true, true, false));
+	for (anox::afs::FileHandle fh : archive->GetFiles())
+	{
+		rkit::CIPath archivePath;
+		RKIT_CHECK(archivePath.SetFromUTF8(fh.GetFilePath().ToUTF8()));
 
-		uint8_t buffer[1024];
+		const size_t numComponents = archivePath.NumComponents();
+		if (numComponents > 1)
+		{
+			rkit::CIPath dirPath;
+			RKIT_CHECK(dirPath.Set(archivePath.AbsSlice(numComponents - 1)));
 
-		uint32_t sizeRemaining = fileSize;
+			if (!createdDirs.Contains(dirPath))
+			{
+				rkit::OSRelPath relDirPath;
+				RKIT_CHECK(relDirPath.ConvertFrom(dirPath));
 
-		while (sizeRemaining > 0)
-		{
-			uint32_t chunkSize = sizeof(buffer);
-			if (chunkSize > sizeRemaining)
-				chunkSize = sizeRemaining;
+				rkit::OSAbsPath outDirPath = outBasePath;
+				RKIT_CHECK(outDirPath.Append(relDirPath));
 
-			RKIT_CHECK(fileStream->ReadAll(buffer, chunkSize));
-			RKIT_CHECK(writeStream->WriteAll(buffer, chunkSize));
+				RKIT_CHECK(sysDriver.CreateDirectoriesAbs(createdDir, outDirPath, false));
 
-			sizeRemaining -= chunkSize;
+				RKIT_CHECK(createdDirs.Add(std::move(dirPath)));
+			}
 		}
+
+		rkit::OSRelPath relPath;
+		RKIT_CHECK(relPath.ConvertFrom(archivePath));
+
+		rkit::OSAbsPath outPath = outBasePath;
+		RKIT_CHECK(outPath.Append(relPath));
+
+		rkit::UniquePtr<rkit::IJobRunner> jobRunner;
+		RKIT_CHECK(rkit::New<ExtractFileJobRunner>(jobRunner, fh, std::move(outPath), verify));
+
+		rkit::RCPtr<rkit::Job> extractJob;
+		RKIT_CHECK(jobQueue.CreateJob(&extractJob, rkit::JobType::kNormalPriority, std::move(jobRunner), rkit::JobDependencyList()));
+
+		RKIT_CHECK(extractJobs.Append(std::move(extractJob)));
 	}
 
+	rkit::RCPtr<rkit::Job> doneJob;
+	RKIT_CHECK(jobQueue.CreateJob(&doneJob, rkit::JobType::kNormalPriority, rkit::UniquePtr<rkit::IJobRunner>(), extractJobs.ToSpan()));
+
+	extractJobs.Reset();
+
+	jobQueue.WaitForJob(*doneJob, threadPool->GetAllJobTypes(), mainThreadWakeEvent.Get(), mainThreadTerminateEvent.Get());
+	RKIT_CHECK(jobQueue.CheckFault());
+
+	RKIT_CHECK(rkit::utils::ThrowResult(threadPool->Close()));
+
 	RKIT_RETURN_OK;
 }
 
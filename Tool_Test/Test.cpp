@@ -0,0 +1,1348 @@
+#include "rkit/BuildSystem/BuildSystem.h"
+#include "rkit/BuildSystem/DependencyGraph.h"
+#include "rkit/Core/Algorithm.h"
+#include "rkit/Core/CoreLib.h"
+#include "rkit/Core/Drivers.h"
+#include "rkit/Core/FileMapping.h"
+#include "rkit/Core/LogDriver.h"
+#include "rkit/Core/ModuleDriver.h"
+#include "rkit/Core/ModuleGlue.h"
+#include "rkit/Core/NewDelete.h"
+#include "rkit/Core/Path.h"
+#include "rkit/Core/ProgramDriver.h"
+#include "rkit/Core/DriverModuleStub.h"
+#include "rkit/Core/ProgramStub.h"
+#include "rkit/Core/Result.h"
+#include "rkit/Core/Span.h"
+#include "rkit/Core/Stream.h"
+#include "rkit/Core/String.h"
+#include "rkit/Core/SystemDriver.h"
+#include "rkit/Core/StringView.h"
+#include "rkit/Core/UniquePtr.h"
+#include "rkit/Core/UtilitiesDriver.h"
+#include "rkit/Core/Vector.h"
+#include "rkit/Core/XorShift.h"
+
+#include "rkit/Utilities/ImageKernels.h"
+#include "rkit/Utilities/ShadowFile.h"
+
+#include <string.h>
+
+namespace anox
+{
+	// In-memory file that keeps flushed data separately from written data, so that a crash
+	// can be simulated by reopening from the flushed image.  When armed, every write, flush,
+	// and truncate after the first opsUntilFault operations fails.
+	struct FaultInjectionImage
+	{
+		rkit::Result FlushWritten();
+
+		// Sets both images to the data that survived a simulated crash of another file
+		rkit::Result RestoreFlushed(const FaultInjectionImage &crashedImage);
+
+		rkit::Vector<uint8_t> m_written;
+		rkit::Vector<uint8_t> m_flushed;
+
+		uint32_t m_opsUntilFault = 0;
+		bool m_faultArmed = false;
+
+		// If set, failed operations still take effect, as if the failure was reported late
+		bool m_failedOpsTakeEffect = false;
+	};
+
+	class FaultInjectionStream final : public rkit::ISeekableReadWriteStream
+	{
+	public:
+		explicit FaultInjectionStream(FaultInjectionImage &image);
+
+		rkit::Result ReadPartial(void *data, size_t count, size_t &outCountRead) override;
+		rkit::Result WritePartial(const void *data, size_t count, size_t &outCountWritten) override;
+		rkit::Result Flush() override;
+
+		rkit::Result SeekStart(rkit::FilePos_t pos) override;
+		rkit::Result SeekCurrent(rkit::FileOffset_t pos) override;
+		rkit::Result SeekEnd(rkit::FileOffset_t pos) override;
+
+		rkit::FilePos_t Tell() const override;
+		rkit::FilePos_t GetSize() const override;
+
+		rkit::Result Truncate(rkit::FilePos_t size) override;
+
+	private:
+		bool ConsumeOperation();
+
+		FaultInjectionImage &m_image;
+		rkit::FilePos_t m_pos;
+	};
+
+	class MemoryMappingView final : public rkit::IFileMappingView
+	{
+	public:
+		explicit MemoryMappingView(rkit::Vector<uint8_t> &&bytes);
+
+		const void *GetData() const override;
+		size_t GetSize() const override;
+		void *GetMutableData() const override;
+		void Prefetch(size_t offset, size_t size) override;
+
+	private:
+		rkit::Vector<uint8_t> m_bytes;
+	};
+
+	// Items that the node item test compiler registered, in the order that they were first added
+	struct NodeItemTestExpectations
+	{
+		rkit::Vector<rkit::buildsystem::FileStatus> m_products;
+		rkit::Vector<rkit::CIPath> m_fileDependencies;
+	};
+
+	// Registers many products and file dependencies, then registers all of them again in reverse
+	// order, so that a node's item lookups go through the build system's indexes
+	class NodeItemTestCompiler final : public rkit::buildsystem::IDependencyNodeCompiler
+	{
+	public:
+		NodeItemTestCompiler(uint32_t numItems, NodeItemTestExpectations &expectations);
+
+		bool HasAnalysisStage() const override;
+		rkit::Result RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
+		rkit::Result RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback) override;
+
+		uint32_t GetVersion() const override;
+
+	private:
+		rkit::Result WriteProduct(rkit::buildsystem::IDependencyNodeCompilerFeedback &feedback, rkit::buildsystem::BuildFileLocation location, const rkit::CIPath &path, bool isFirstPass);
+
+		uint32_t m_numItems;
+		NodeItemTestExpectations &m_expectations;
+	};
+
+	// Build file system where every output exists and no source file does
+	class NodeItemTestFileSystem final : public rkit::buildsystem::IBuildFileSystem
+	{
+	public:
+		rkit::Result ResolveFileStatusIfExists(rkit::buildsystem::BuildFileLocation inputFileLocation, const rkit::CIPathView &path, bool allowDirectories, void *userdata, ApplyFileStatusCallback_t applyStatus) override;
+		rkit::Result TryOpenFileRead(rkit::buildsystem::BuildFileLocation inputFileLocation, const rkit::CIPathView &path, rkit::UniquePtr<rkit::ISeekableReadStream> &outStream) override;
+		rkit::Result EnumerateDirectory(rkit::buildsystem::BuildFileLocation inputFileLocation, const rkit::CIPathView &path, bool listFiles, bool listDirectories, void *userdata, ApplyFileStatusCallback_t callback) override;
+	};
+
+	// Character source for the callback-based float parsers, which always use the slow path
+	struct FloatScanChars
+	{
+		FloatScanChars(const rkit::ByteStringSliceView &str);
+
+		static bool GetOneChar(void *state, int32_t &outChar);
+		static void UnGetChar(void *state);
+
+		const uint8_t *m_chars;
+		size_t m_length;
+		size_t m_pos;
+		size_t m_overrun;
+	};
+
+	class TestProgram final : public rkit::ISimpleProgram
+	{
+	public:
+		rkit::Result Run() override;
+
+	private:
+		enum class ShadowFileTestState
+		{
+			kOld,
+			kNew,
+			kInvalid,
+		};
+
+		struct ShadowFileTestData
+		{
+			rkit::Vector<uint8_t> m_oldPayload;
+			rkit::Vector<uint8_t> m_newPayload;
+			rkit::Vector<uint8_t> m_uncommittedPayload;
+			rkit::Vector<uint8_t> m_smallPayload;
+		};
+
+		struct ImageKernelBuffers
+		{
+			rkit::ConstSpan<uint8_t> m_inBytes;
+			rkit::ConstSpan<uint16_t> m_inLinear;
+			rkit::ConstSpan<uint8_t> m_palette;
+			rkit::Span<uint8_t> m_outBytes;
+			rkit::Span<uint16_t> m_outLinear;
+		};
+
+		static rkit::Result Expect(bool condition, const rkit::Utf8Char_t *description, uint32_t faultStep);
+		static rkit::Result ParseCount(const rkit::Span<const rkit::StringView> &args, uint32_t &inOutCount);
+
+		static rkit::Result RunShadowFileTests();
+		static rkit::Result RunShadowFileCommitFaultTests(const FaultInjectionImage &baseImage, const ShadowFileTestData &testData, bool failedOpsTakeEffect, uint32_t &outNumFaults);
+		static rkit::Result RunShadowFileWriteAfterFaultTest(const FaultInjectionImage &baseImage, const ShadowFileTestData &testData, bool failedOpsTakeEffect, uint32_t faultStep);
+		static rkit::Result RunShadowFileInitFaultTests(uint32_t &outNumFaults);
+		static rkit::Result RunShadowFileReadOnlyTests(const FaultInjectionImage &baseImage, const ShadowFileTestData &testData);
+
+		static rkit::Result OpenShadowFile(rkit::UniquePtr<rkit::utils::IShadowFile> &outShadowFile, FaultInjectionImage &image, bool initialize);
+		static rkit::Result ReopenFlushedImage(rkit::UniquePtr<rkit::utils::IShadowFile> &outShadowFile, FaultInjectionImage &outImage, const FaultInjectionImage &crashedImage);
+		static rkit::Result ApplyShadowFileChanges(rkit::utils::IShadowFile &shadowFile, const ShadowFileTestData &testData);
+		static rkit::Result IdentifyShadowFileState(rkit::utils::IShadowFile &shadowFile, const ShadowFileTestData &testData, ShadowFileTestState &outState);
+
+		static rkit::Result RunNodeItemTests(const rkit::Span<const rkit::StringView> &args);
+
+		static rkit::Result RunImageKernelTests(const rkit::Span<const rkit::StringView> &args);
+		static bool RunImageKernel(const rkit::utils::IImageKernels &kernels, size_t kernelIndex, const ImageKernelBuffers &buffers, size_t inOffset, size_t numPixels);
+
+		static rkit::Result RunStringToFloatTests(const rkit::Span<const rkit::StringView> &args);
+		static rkit::Result RunStringToDoubleTests(const rkit::Span<const rkit::StringView> &args);
+
+		static bool ParseFast(float &f, const uint8_t *chars, size_t &inOutLen);
+		static bool ParseFast(double &f, const uint8_t *chars, size_t &inOutLen);
+		static bool ParseSlow(float &f, FloatScanChars &scanChars);
+		static bool ParseSlow(double &f, FloatScanChars &scanChars);
+
+		template<class TFloat>
+		static rkit::Result CheckFloatParse(const rkit::String &str, const TFloat *expected, uint32_t &inOutNumMismatches);
+
+		static rkit::Result WriteTestFile(rkit::utils::IShadowFile &shadowFile, const rkit::StringSliceView &path, const rkit::Vector<uint8_t> &contents);
+		static rkit::Result TestFileMatches(rkit::utils::IShadowFile &shadowFile, const rkit::StringSliceView &path, const rkit::Vector<uint8_t> &contents, bool &outMatches);
+	};
+
+	typedef rkit::DriverModuleStub<rkit::ProgramStubDriver<TestProgram>, rkit::IProgramDriver, &rkit::Drivers::m_programDriver> TestModule;
+}
+
+rkit::Result anox::FaultInjectionImage::FlushWritten()
+{
+	m_flushed.Reset();
+	return m_flushed.Append(m_written.ToSpan());
+}
+
+rkit::Result anox::FaultInjectionImage::RestoreFlushed(const FaultInjectionImage &crashedImage)
+{
+	m_written.Reset();
+	RKIT_CHECK(m_written.Append(crashedImage.m_flushed.ToSpan()));
+
+	return FlushWritten();
+}
+
+anox::FaultInjectionStream::FaultInjectionStream(FaultInjectionImage &image)
+	: m_image(image)
+	, m_pos(0)
+{
+}
+
+rkit::Result anox::FaultInjectionStream::ReadPartial(void *data, size_t count, size_t &outCountRead)
+{
+	const size_t available = m_image.m_written.Count() - static_cast<size_t>(m_pos);
+	if (count > available)
+		count = available;
+
+	memcpy(data, m_image.m_written.GetBuffer() + m_pos, count);
+
+	m_pos += count;
+	outCountRead = count;
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::FaultInjectionStream::WritePartial(const void *data, size_t count, size_t &outCountWritten)
+{
+	outCountWritten = 0;
+
+	const bool fault = ConsumeOperation();
+
+	if (!fault || m_image.m_failedOpsTakeEffect)
+	{
+		const size_t endPos = static_cast<size_t>(m_pos) + count;
+		if (endPos > m_image.m_written.Count())
+		{
+			RKIT_CHECK(m_image.m_written.Resize(endPos));
+		}
+
+		memcpy(m_image.m_written.GetBuffer() + m_pos, data, count);
+		m_pos = endPos;
+	}
+
+	if (fault)
+		RKIT_THROW(rkit::ResultCode::kIOWriteError);
+
+	outCountWritten = count;
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::FaultInjectionStream::Flush()
+{
+	const bool fault = ConsumeOperation();
+
+	if (!fault || m_image.m_failedOpsTakeEffect)
+	{
+		RKIT_CHECK(m_image.FlushWritten());
+	}
+
+	if (fault)
+		RKIT_THROW(rkit::ResultCode::kIOError);
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::FaultInjectionStream::SeekStart(rkit::FilePos_t pos)
+{
+	// Like OS files opened by the system driver, seeking past the end fails
+	if (pos > m_image.m_written.Count())
+		RKIT_THROW(rkit::ResultCode::kIOSeekOutOfRange);
+
+	m_pos = pos;
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::FaultInjectionStream::SeekCurrent(rkit::FileOffset_t offset)
+{
+	if (offset < 0)
+	{
+		const rkit::FilePos_t backwardDist = rkit::ToUnsignedAbs<rkit::FileOffset_t, rkit::FilePos_t>(offset);
+		if (backwardDist > m_pos)
+			RKIT_THROW(rkit::ResultCode::kIOSeekOutOfRange);
+
+		return SeekStart(m_pos - backwardDist);
+	}
+
+	return SeekStart(m_pos + static_cast<rkit::FilePos_t>(offset));
+}
+
+rkit::Result anox::FaultInjectionStream::SeekEnd(rkit::FileOffset_t offset)
+{
+	if (offset > 0)
+		RKIT_THROW(rkit::ResultCode::kIOSeekOutOfRange);
+
+	const rkit::FilePos_t size = m_image.m_written.Count();
+	const rkit::FilePos_t backwardDist = rkit::ToUnsignedAbs<rkit::FileOffset_t, rkit::FilePos_t>(offset);
+	if (backwardDist > size)
+		RKIT_THROW(rkit::ResultCode::kIOSeekOutOfRange);
+
+	return SeekStart(size - backwardDist);
+}
+
+rkit::FilePos_t anox::FaultInjectionStream::Tell() const
+{
+	return m_pos;
+}
+
+rkit::FilePos_t anox::FaultInjectionStream::GetSize() const
+{
+	return m_image.m_written.Count();
+}
+
+rkit::Result anox::FaultInjectionStream::Truncate(rkit::FilePos_t size)
+{
+	const bool fault = ConsumeOperation();
+
+	if (!fault || m_image.m_failedOpsTakeEffect)
+	{
+		RKIT_CHECK(m_image.m_written.Resize(static_cast<size_t>(size)));
+
+		if (m_pos > size)
+			m_pos = size;
+	}
+
+	if (fault)
+		RKIT_THROW(rkit::ResultCode::kIOWriteError);
+
+	RKIT_RETURN_OK;
+}
+
+bool anox::FaultInjectionStream::ConsumeOperation()
+{
+	if (!m_image.m_faultArmed)
+		return false;
+
+	if (m_image.m_opsUntilFault == 0)
+		return true;
+
+	m_image.m_opsUntilFault--;
+	return false;
+}
+
+anox::MemoryMappingView::MemoryMappingView(rkit::Vector<uint8_t> &&bytes)
+	: m_bytes(std::move(bytes))
+{
+}
+
+const void *anox::MemoryMappingView::GetData() const
+{
+	return m_bytes.GetBuffer();
+}
+
+size_t anox::MemoryMappingView::GetSize() const
+{
+	return m_bytes.Count();
+}
+
+void *anox::MemoryMappingView::GetMutableData() const
+{
+	return nullptr;
+}
+
+void anox::MemoryMappingView::Prefetch(size_t offset, size_t size)
+{
+}
+
+anox::FloatScanChars::FloatScanChars(const rkit::ByteStringSliceView &str)
+	: m_chars(str.GetChars())
+	, m_length(str.Length())
+	, m_pos(0)
+	, m_overrun(0)
+{
+}
+
+bool anox::FloatScanChars::GetOneChar(void *state, int32_t &outChar)
+{
+	FloatScanChars *scanChars = static_cast<FloatScanChars *>(state);
+	if (scanChars->m_pos == scanChars->m_length)
+	{
+		scanChars->m_overrun++;
+		return false;
+	}
+
+	outChar = scanChars->m_chars[scanChars->m_pos++];
+	return true;
+}
+
+void anox::FloatScanChars::UnGetChar(void *state)
+{
+	FloatScanChars *scanChars = static_cast<FloatScanChars *>(state);
+	if (scanChars->m_overrun > 0)
+		scanChars->m_overrun--;
+	else
+		scanChars->m_pos--;
+}
+
+rkit::Result anox::TestProgram::Expect(bool condition, const rkit::Utf8Char_t *description, uint32_t faultStep)
+{
+	if (!condition)
+	{
+		rkit::log::ErrorFmt(u8"Check failed: {} (fault at operation {})", description, faultStep);
+		RKIT_THROW(rkit::ResultCode::kOperationFailed);
+	}
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::ParseCount(const rkit::Span<const rkit::StringView> &args, uint32_t &inOutCount)
+{
+	if (args.Count() == 0)
+		RKIT_RETURN_OK;
+
+	if (args.Count() > 1 || !rkit::GetDrivers().m_utilitiesDriver->ParseUInt32(args[0].RemoveEncoding(), 10, inOutCount) || inOutCount == 0)
+	{
+		rkit::log::Error(u8"Count must be a positive integer");
+		RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+	}
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::RunShadowFileTests()
+{
+	ShadowFileTestData testData;
+	RKIT_CHECK(testData.m_oldPayload.Resize(40000));
+	RKIT_CHECK(testData.m_newPayload.Resize(25000));
+	RKIT_CHECK(testData.m_uncommittedPayload.Resize(25000));
+	RKIT_CHECK(testData.m_smallPayload.Resize(100));
+
+	rkit::XorShift32 rng;
+	for (uint8_t &b : testData.m_oldPayload)
+		b = static_cast<uint8_t>(rng.Next() >> 24);
+	for (uint8_t &b : testData.m_newPayload)
+		b = static_cast<uint8_t>(rng.Next() >> 24);
+	for (uint8_t &b : testData.m_uncommittedPayload)
+		b = static_cast<uint8_t>(rng.Next() >> 24);
+	for (uint8_t &b : testData.m_smallPayload)
+		b = static_cast<uint8_t>(rng.Next() >> 24);
+
+	// Committed starting state shared by all of the tests
+	FaultInjectionImage baseImage;
+	{
+		rkit::UniquePtr<rkit::utils::IShadowFile> shadowFile;
+		RKIT_CHECK(OpenShadowFile(shadowFile, baseImage, true));
+
+		RKIT_CHECK(WriteTestFile(*shadowFile, u8"data/big.bin", testData.m_oldPayload));
+		RKIT_CHECK(WriteTestFile(*shadowFile, u8"data/removed.bin", testData.m_smallPayload));
+		RKIT_CHECK(shadowFile->CommitChanges());
+	}
+
+	uint32_t numLostWriteFaults = 0;
+	uint32_t numLateFailureFaults = 0;
+	uint32_t numInitFaults = 0;
+
+	RKIT_CHECK(RunShadowFileCommitFaultTests(baseImage, testData, false, numLostWriteFaults));
+	RKIT_CHECK(RunShadowFileCommitFaultTests(baseImage, testData, true, numLateFailureFaults));
+	RKIT_CHECK(RunShadowFileInitFaultTests(numInitFaults));
+	RKIT_CHECK(RunShadowFileReadOnlyTests(baseImage, testData));
+
+	rkit::log::LogInfoFmt(u8"ShadowFile: {} interrupted commits with lost writes, {} with late failures, {} interrupted initializations, read-only mapping OK", numLostWriteFaults, numLateFailureFaults, numInitFaults);
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::RunShadowFileCommitFaultTests(const FaultInjectionImage &baseImage, const ShadowFileTestData &testData, bool failedOpsTakeEffect, uint32_t &outNumFaults)
+{
+	// Fails the commit at each write and flush in turn, until one gets through
+	const uint32_t kMaxFaultSteps = 100000;
+
+	outNumFaults = 0;
+
+	for (uint32_t faultStep = 0; faultStep < kMaxFaultSteps; faultStep++)
+	{
+		FaultInjectionImage image;
+		RKIT_CHECK(image.RestoreFlushed(baseImage));
+		image.m_failedOpsTakeEffect = failedOpsTakeEffect;
+
+		rkit::UniquePtr<rkit::utils::IShadowFile> shadowFile;
+		RKIT_CHECK(OpenShadowFile(shadowFile, image, false));
+		RKIT_CHECK(ApplyShadowFileChanges(*shadowFile, testData));
+
+		image.m_faultArmed = true;
+		image.m_opsUntilFault = faultStep;
+
+		const rkit::PackedResultAndExtCode commitResult = RKIT_TRY_EVAL(shadowFile->CommitChanges());
+
+		image.m_faultArmed = false;
+
+		ShadowFileTestState state = ShadowFileTestState::kInvalid;
+
+		if (rkit::utils::ResultIsOK(commitResult))
+		{
+			rkit::UniquePtr<rkit::utils::IShadowFile> reopened;
+			FaultInjectionImage reopenedImage;
+			RKIT_CHECK(ReopenFlushedImage(reopened, reopenedImage, image));
+			RKIT_CHECK(IdentifyShadowFileState(*reopened, testData, state));
+			RKIT_CHECK(Expect(state == ShadowFileTestState::kNew, u8"Completed commit is durable", faultStep));
+
+			RKIT_RETURN_OK;
+		}
+
+		outNumFaults++;
+
+		// Simulated crash: only flushed data survives.  If failed writes never land, the
+		// switch can't have landed either, so the file must be in its previous state.
+		{
+			rkit::UniquePtr<rkit::utils::IShadowFile> reopened;
+			FaultInjectionImage reopenedImage;
+			RKIT_CHECK(ReopenFlushedImage(reopened, reopenedImage, image));
+			RKIT_CHECK(IdentifyShadowFileState(*reopened, testData, state));
+
+			if (failedOpsTakeEffect)
+			{
+				RKIT_CHECK(Expect(state != ShadowFileTestState::kInvalid, u8"Interrupted commit leaves a valid state", faultStep));
+			}
+			else
+			{
+				RKIT_CHECK(Expect(state == ShadowFileTestState::kOld, u8"Interrupted commit leaves the previous state", faultStep));
+			}
+
+			// The reopened file must still be usable
+			if (state == ShadowFileTestState::kOld)
+			{
+				RKIT_CHECK(ApplyShadowFileChanges(*reopened, testData));
+			}
+
+			RKIT_CHECK(reopened->CommitChanges());
+			RKIT_CHECK(IdentifyShadowFileState(*reopened, testData, state));
+			RKIT_CHECK(Expect(state == ShadowFileTestState::kNew, u8"Commit after reopening an interrupted file", faultStep));
+
+			reopened.Reset();
+
+			rkit::UniquePtr<rkit::utils::IShadowFile> reopenedAgain;
+			FaultInjectionImage reopenedAgainImage;
+			RKIT_CHECK(ReopenFlushedImage(reopenedAgain, reopenedAgainImage, reopenedImage));
+			RKIT_CHECK(IdentifyShadowFileState(*reopenedAgain, testData, state));
+			RKIT_CHECK(Expect(state == ShadowFileTestState::kNew, u8"Commit after reopening an interrupted file is durable", faultStep));
+		}
+
+		// Retrying on the same instance must redo the whole commit
+		RKIT_CHECK(shadowFile->CommitChanges());
+		RKIT_CHECK(IdentifyShadowFileState(*shadowFile, testData, state));
+		RKIT_CHECK(Expect(state == ShadowFileTestState::kNew, u8"Retried commit keeps the changes", faultStep));
+
+		{
+			rkit::UniquePtr<rkit::utils::IShadowFile> reopened;
+			FaultInjectionImage reopenedImage;
+			RKIT_CHECK(ReopenFlushedImage(reopened, reopenedImage, image));
+			RKIT_CHECK(IdentifyShadowFileState(*reopened, testData, state));
+			RKIT_CHECK(Expect(state == ShadowFileTestState::kNew, u8"Retried commit is durable", faultStep));
+		}
+
+		// Further changes after the retry must not overwrite anything the new state uses
+		RKIT_CHECK(WriteTestFile(*shadowFile, u8"data/extra.bin", testData.m_smallPayload));
+		RKIT_CHECK(shadowFile->CommitChanges());
+
+		{
+			rkit::UniquePtr<rkit::utils::IShadowFile> reopened;
+			FaultInjectionImage reopenedImage;
+			RKIT_CHECK(ReopenFlushedImage(reopened, reopenedImage, image));
+			RKIT_CHECK(IdentifyShadowFileState(*reopened, testData, state));
+			RKIT_CHECK(Expect(state == ShadowFileTestState::kNew, u8"Commit after a retried commit keeps the previous changes", faultStep));
+
+			bool extraMatches = false;
+			RKIT_CHECK(TestFileMatches(*reopened, u8"data/extra.bin", testData.m_smallPayload, extraMatches));
+			RKIT_CHECK(Expect(extraMatches, u8"Commit after a retried commit is durable", faultStep));
+		}
+
+		RKIT_CHECK(RunShadowFileWriteAfterFaultTest(baseImage, testData, failedOpsTakeEffect, faultStep));
+	}
+
+	rkit::log::Error(u8"Commit never completed");
+	RKIT_THROW(rkit::ResultCode::kOperationFailed);
+}
+
+rkit::Result anox::TestProgram::RunShadowFileWriteAfterFaultTest(const FaultInjectionImage &baseImage, const ShadowFileTestData &testData, bool failedOpsTakeEffect, uint32_t faultStep)
+{
+	// After a failed commit, either the previous or the new state may be the one on disk,
+	// so writes made before the next commit must not modify sectors of either of them.
+	FaultInjectionImage image;
+	RKIT_CHECK(image.RestoreFlushed(baseImage));
+	image.m_failedOpsTakeEffect = failedOpsTakeEffect;
+
+	rkit::UniquePtr<rkit::utils::IShadowFile> shadowFile;
+	RKIT_CHECK(OpenShadowFile(shadowFile, image, false));
+	RKIT_CHECK(ApplyShadowFileChanges(*shadowFile, testData));
+
+	image.m_faultArmed = true;
+	image.m_opsUntilFault = faultStep;
+
+	const rkit::PackedResultAndExtCode commitResult = RKIT_TRY_EVAL(shadowFile->CommitChanges());
+
+	image.m_faultArmed = false;
+
+	RKIT_CHECK(Expect(!rkit::utils::ResultIsOK(commitResult), u8"Repeated commit fails at the same operation", faultStep));
+
+	RKIT_CHECK(WriteTestFile(*shadowFile, u8"data/big.bin", testData.m_uncommittedPayload));
+
+	// Unflushed writes may reach the disk before a crash, so this reopens from everything written
+	FaultInjectionImage crashedImage;
+	RKIT_CHECK(crashedImage.m_flushed.Append(image.m_written.ToSpan()));
+
+	rkit::UniquePtr<rkit::utils::IShadowFile> reopened;
+	FaultInjectionImage reopenedImage;
+	RKIT_CHECK(ReopenFlushedImage(reopened, reopenedImage, crashedImage));
+
+	ShadowFileTestState state = ShadowFileTestState::kInvalid;
+	RKIT_CHECK(IdentifyShadowFileState(*reopened, testData, state));
+	RKIT_CHECK(Expect(state != ShadowFileTestState::kInvalid, u8"Writes after a failed commit leave committed data intact", faultStep));
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::RunShadowFileInitFaultTests(uint32_t &outNumFaults)
+{
+	const uint32_t kMaxFaultSteps = 1000;
+
+	outNumFaults = 0;
+
+	for (uint32_t faultStep = 0; faultStep < kMaxFaultSteps; faultStep++)
+	{
+		FaultInjectionImage image;
+		image.m_faultArmed = true;
+		image.m_opsUntilFault = faultStep;
+
+		rkit::UniquePtr<rkit::utils::IShadowFile> shadowFile;
+		const rkit::PackedResultAndExtCode initResult = RKIT_TRY_EVAL(OpenShadowFile(shadowFile, image, true));
+
+		image.m_faultArmed = false;
+
+		if (rkit::utils::ResultIsOK(initResult))
+			RKIT_RETURN_OK;
+
+		outNumFaults++;
+
+		// An interrupted initialization must fail to load instead of silently reinitializing
+		if (image.m_flushed.Count() == 0)
+			continue;
+
+		const size_t flushedSize = image.m_flushed.Count();
+
+		rkit::UniquePtr<rkit::utils::IShadowFile> reopened;
+		FaultInjectionImage reopenedImage;
+		const rkit::PackedResultAndExtCode loadResult = RKIT_TRY_EVAL(ReopenFlushedImage(reopened, reopenedImage, image));
+
+		RKIT_CHECK(Expect(!rkit::utils::ResultIsOK(loadResult), u8"Interrupted initialization fails to load", faultStep));
+		RKIT_CHECK(Expect(reopenedImage.m_written.Count() == flushedSize, u8"Failed load leaves the file alone", faultStep));
+	}
+
+	rkit::log::Error(u8"Initialization never completed");
+	RKIT_THROW(rkit::ResultCode::kOperationFailed);
+}
+
+rkit::Result anox::TestProgram::RunShadowFileReadOnlyTests(const FaultInjectionImage &baseImage, const ShadowFileTestData &testData)
+{
+	rkit::Vector<uint8_t> bytes;
+	RKIT_CHECK(bytes.Append(baseImage.m_flushed.ToSpan()));
+
+	rkit::UniquePtr<rkit::IFileMappingView> view;
+	RKIT_CHECK(rkit::New<MemoryMappingView>(view, std::move(bytes)));
+
+	rkit::UniquePtr<rkit::utils::IShadowFile> shadowFile;
+	RKIT_CHECK(rkit::GetDrivers().m_utilitiesDriver->CreateReadOnlyShadowFile(shadowFile, std::move(view)));
+
+	ShadowFileTestState state = ShadowFileTestState::kInvalid;
+	RKIT_CHECK(IdentifyShadowFileState(*shadowFile, testData, state));
+	RKIT_CHECK(Expect(state == ShadowFileTestState::kOld, u8"Read-only mapping reads the committed state", 0));
+
+	rkit::UniquePtr<rkit::ISeekableReadWriteStream> stream;
+	const rkit::PackedResultAndExtCode openResult = RKIT_TRY_EVAL(shadowFile->TryOpenFileReadWrite(stream, u8"data/big.bin", false, false));
+	RKIT_CHECK(Expect(!rkit::utils::ResultIsOK(openResult), u8"Read-only mapping can't be opened for writing", 0));
+
+	const rkit::PackedResultAndExtCode deleteResult = RKIT_TRY_EVAL(shadowFile->DeleteEntry(u8"data/removed.bin"));
+	RKIT_CHECK(Expect(!rkit::utils::ResultIsOK(deleteResult), u8"Read-only mapping can't delete entries", 0));
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::OpenShadowFile(rkit::UniquePtr<rkit::utils::IShadowFile> &outShadowFile, FaultInjectionImage &image, bool initialize)
+{
+	rkit::UniquePtr<rkit::ISeekableReadWriteStream> stream;
+	RKIT_CHECK(rkit::New<FaultInjectionStream>(stream, image));
+
+	return rkit::GetDrivers().m_utilitiesDriver->CreateShadowFile(outShadowFile, std::move(stream), initialize);
+}
+
+rkit::Result anox::TestProgram::ReopenFlushedImage(rkit::UniquePtr<rkit::utils::IShadowFile> &outShadowFile, FaultInjectionImage &outImage, const FaultInjectionImage &crashedImage)
+{
+	RKIT_CHECK(outImage.RestoreFlushed(crashedImage));
+
+	return OpenShadowFile(outShadowFile, outImage, false);
+}
+
+rkit::Result anox::TestProgram::ApplyShadowFileChanges(rkit::utils::IShadowFile &shadowFile, const ShadowFileTestData &testData)
+{
+	RKIT_CHECK(WriteTestFile(shadowFile, u8"data/big.bin", testData.m_newPayload));
+	RKIT_CHECK(WriteTestFile(shadowFile, u8"more/new.bin", testData.m_smallPayload));
+	RKIT_CHECK(shadowFile.DeleteEntry(u8"data/removed.bin"));
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::IdentifyShadowFileState(rkit::utils::IShadowFile &shadowFile, const ShadowFileTestData &testData, ShadowFileTestState &outState)
+{
+	outState = ShadowFileTestState::kInvalid;
+
+	bool removedExists = false;
+	bool newExists = false;
+	RKIT_CHECK(shadowFile.EntryExists(u8"data/removed.bin", removedExists));
+	RKIT_CHECK(shadowFile.EntryExists(u8"more/new.bin", newExists));
+
+	bool matches = false;
+	if (removedExists && !newExists)
+	{
+		RKIT_CHECK(TestFileMatches(shadowFile, u8"data/big.bin", testData.m_oldPayload, matches));
+		if (matches)
+		{
+			RKIT_CHECK(TestFileMatches(shadowFile, u8"data/removed.bin", testData.m_smallPayload, matches));
+		}
+
+		if (matches)
+			outState = ShadowFileTestState::kOld;
+	}
+	else if (!removedExists && newExists)
+	{
+		RKIT_CHECK(TestFileMatches(shadowFile, u8"data/big.bin", testData.m_newPayload, matches));
+		if (matches)
+		{
+			RKIT_CHECK(TestFileMatches(shadowFile, u8"more/new.bin", testData.m_smallPayload, matches));
+		}
+
+		if (matches)
+			outState = ShadowFileTestState::kNew;
+	}
+
+	RKIT_RETURN_OK;
+}
+
+anox::NodeItemTestCompiler::NodeItemTestCompiler(uint32_t numItems, NodeItemTestExpectations &expectations)
+	: m_numItems(numItems)
+	, m_expectations(expectations)
+{
+}
+
+bool anox::NodeItemTestCompiler::HasAnalysisStage() const
+{
+	return false;
+}
+
+rkit::Result anox::NodeItemTestCompiler::RunAnalysis(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
+{
+	RKIT_THROW(rkit::ResultCode::kInternalError);
+}
+
+rkit::Result anox::NodeItemTestCompiler::RunCompile(rkit::buildsystem::IDependencyNode *depsNode, rkit::buildsystem::IDependencyNodeCompilerFeedback *feedback)
+{
+	m_expectations.m_products.Reset();
+	m_expectations.m_fileDependencies.Reset();
+
+	rkit::String pathStr;
+	rkit::CIPath path;
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		const bool isFirstPass = (pass == 0);
+
+		for (uint32_t n = 0; n < m_numItems; n++)
+		{
+			const uint32_t itemIndex = isFirstPass ? n : (m_numItems - 1u - n);
+
+			// Spread over a few directories, like the outputs of a large map
+			RKIT_CHECK(pathStr.Format(u8"nodeitems/part{}/item_{}.bin", itemIndex % 16u, itemIndex));
+			RKIT_CHECK(path.Set(pathStr));
+
+			RKIT_CHECK(WriteProduct(*feedback, rkit::buildsystem::BuildFileLocation::kIntermediateDir, path, isFirstPass));
+
+			// The same path in another location is a different product
+			if (itemIndex % 4u == 0)
+			{
+				RKIT_CHECK(WriteProduct(*feedback, rkit::buildsystem::BuildFileLocation::kOutputFiles, path, isFirstPass));
+			}
+
+			bool exists = false;
+			RKIT_CHECK(feedback->CheckInputExists(rkit::buildsystem::BuildFileLocation::kSourceDir, path, exists));
+
+			if (isFirstPass)
+			{
+				RKIT_CHECK(m_expectations.m_fileDependencies.Append(path));
+			}
+		}
+	}
+
+	RKIT_RETURN_OK;
+}
+
+uint32_t anox::NodeItemTestCompiler::GetVersion() const
+{
+	return 1;
+}
+
+rkit::Result anox::NodeItemTestCompiler::WriteProduct(rkit::buildsystem::IDependencyNodeCompilerFeedback &feedback, rkit::buildsystem::BuildFileLocation location, const rkit::CIPath &path, bool isFirstPass)
+{
+	{
+		rkit::UniquePtr<rkit::ISeekableReadWriteStream> stream;
+		RKIT_CHECK(feedback.OpenOutput(location, path, stream));
+
+		const uint8_t contents = isFirstPass ? 1 : 2;
+		RKIT_CHECK(stream->WriteAll(&contents, 1));
+	}
+
+	// Closing the stream updates the product's status
+	RKIT_CHECK(feedback.CheckFault());
+
+	if (isFirstPass)
+	{
+		rkit::buildsystem::FileStatus product;
+		product.m_location = location;
+		RKIT_CHECK(product.m_filePath.Set(path));
+
+		RKIT_CHECK(m_expectations.m_products.Append(std::move(product)));
+	}
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::NodeItemTestFileSystem::ResolveFileStatusIfExists(rkit::buildsystem::BuildFileLocation inputFileLocation, const rkit::CIPathView &path, bool allowDirectories, void *userdata, ApplyFileStatusCallback_t applyStatus)
+{
+	if (inputFileLocation == rkit::buildsystem::BuildFileLocation::kSourceDir)
+		RKIT_RETURN_OK;
+
+	rkit::buildsystem::FileStatusView status;
+	status.m_filePath = path;
+	status.m_location = inputFileLocation;
+	status.m_fileSize = 1;
+
+	return applyStatus(userdata, status);
+}
+
+rkit::Result anox::NodeItemTestFileSystem::TryOpenFileRead(rkit::buildsystem::BuildFileLocation inputFileLocation, const rkit::CIPathView &path, rkit::UniquePtr<rkit::ISeekableReadStream> &outStream)
+{
+	outStream.Reset();
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::NodeItemTestFileSystem::EnumerateDirectory(rkit::buildsystem::BuildFileLocation inputFileLocation, const rkit::CIPathView &path, bool listFiles, bool listDirectories, void *userdata, ApplyFileStatusCallback_t callback)
+{
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::RunNodeItemTests(const rkit::Span<const rkit::StringView> &args)
+{
+	if (args.Count() < 1)
+	{
+		rkit::log::Error(u8"A scratch directory path is required");
+		RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+	}
+
+	uint32_t numItems = 10000;
+	RKIT_CHECK(ParseCount(args.SubSpan(1), numItems));
+
+	rkit::OSAbsPath scratchDir;
+	RKIT_CHECK(scratchDir.SetFromEncodedString(args[0]));
+
+	if (!rkit::GetDrivers().m_moduleDriver->LoadModule(rkit::IModuleDriver::kDefaultNamespace, u8"Build"))
+	{
+		rkit::log::Error(u8"Couldn't load build module");
+		RKIT_THROW(rkit::ResultCode::kModuleLoadFailed);
+	}
+
+	rkit::buildsystem::IBuildSystemDriver *bsDriver = static_cast<rkit::buildsystem::IBuildSystemDriver *>(rkit::GetDrivers().FindDriver(rkit::IModuleDriver::kDefaultNamespace, u8"BuildSystem"));
+
+	rkit::UniquePtr<rkit::buildsystem::IBuildSystemInstance> instance;
+	RKIT_CHECK(bsDriver->CreateBuildSystemInstance(instance));
+
+	// The cache isn't loaded, so the node is always compiled
+	RKIT_CHECK(instance->Initialize(u8"test", scratchDir, scratchDir, scratchDir, scratchDir));
+
+	const uint32_t kTestNamespace = RKIT_FOURCC('T', 'E', 'S', 'T');
+	const uint32_t kNodeItemTestNodeID = RKIT_FOURCC('N', 'I', 'D', 'X');
+
+	NodeItemTestExpectations expectations;
+
+	rkit::UniquePtr<rkit::buildsystem::IDependencyNodeCompiler> compiler;
+	RKIT_CHECK(rkit::New<NodeItemTestCompiler>(compiler, numItems, expectations));
+	RKIT_CHECK(instance->GetDependencyGraphFactory()->RegisterNodeCompiler(kTestNamespace, kNodeItemTestNodeID, std::move(compiler)));
+
+	rkit::buildsystem::IDependencyNode *node = nullptr;
+	RKIT_CHECK(instance->FindOrCreateNamedNode(kTestNamespace, kNodeItemTestNodeID, rkit::buildsystem::BuildFileLocation::kSourceDir, u8"nodeitems", node));
+	RKIT_CHECK(instance->AddRootNode(node));
+
+	const rkit::ISystemDriver &sysDriver = *rkit::GetDrivers().m_systemDriver;
+	const uint64_t timerFrequency = sysDriver.GetHighResTimestampFrequency();
+
+	NodeItemTestFileSystem fs;
+
+	const uint64_t buildStartTime = sysDriver.GetHighResTimestamp();
+	RKIT_CHECK(instance->Build(&fs));
+	const uint64_t buildEndTime = sysDriver.GetHighResTimestamp();
+
+	RKIT_CHECK(Expect(node->WasCompiled(), u8"Node was compiled", 0));
+
+	uint32_t numMismatches = 0;
+
+	const rkit::CallbackSpan<rkit::buildsystem::FileStatusView, const rkit::buildsystem::IDependencyNode *> products = node->GetCompileProducts();
+	if (products.Count() != expectations.m_products.Count())
+	{
+		rkit::log::ErrorFmt(u8"Node has {} products, expected {}", products.Count(), expectations.m_products.Count());
+		numMismatches++;
+	}
+	else
+	{
+		for (size_t i = 0; i < products.Count(); i++)
+		{
+			const rkit::buildsystem::FileStatusView product = products[i];
+			const rkit::buildsystem::FileStatus &expected = expectations.m_products[i];
+
+			if (product.m_location != expected.m_location || !(expected.m_filePath == product.m_filePath))
+			{
+				if (numMismatches < 20)
+					rkit::log::ErrorFmt(u8"Product {} is '{}', expected '{}'", i, product.m_filePath.GetChars(), expected.m_filePath.CStr());
+
+				numMismatches++;
+			}
+		}
+	}
+
+	const rkit::CallbackSpan<rkit::buildsystem::FileDependencyInfoView, const rkit::buildsystem::IDependencyNode *> fileDependencies = node->GetCompileFileDependencies();
+	if (fileDependencies.Count() != expectations.m_fileDependencies.Count())
+	{
+		rkit::log::ErrorFmt(u8"Node has {} file dependencies, expected {}", fileDependencies.Count(), expectations.m_fileDependencies.Count());
+		numMismatches++;
+	}
+	else
+	{
+		for (size_t i = 0; i < fileDependencies.Count(); i++)
+		{
+			const rkit::buildsystem::FileDependencyInfoView fileDependency = fileDependencies[i];
+			const rkit::CIPath &expectedPath = expectations.m_fileDependencies[i];
+
+			if (fileDependency.m_status.m_location != rkit::buildsystem::BuildFileLocation::kSourceDir || !(expectedPath == fileDependency.m_status.m_filePath))
+			{
+				if (numMismatches < 20)
+					rkit::log::ErrorFmt(u8"File dependency {} is '{}', expected '{}'", i, fileDependency.m_status.m_filePath.GetChars(), expectedPath.CStr());
+
+				numMismatches++;
+			}
+		}
+	}
+
+	const uint64_t buildMicroseconds = (buildEndTime - buildStartTime) * 1000000u / timerFrequency;
+
+	rkit::log::LogInfoFmt(u8"NodeItems: {} products, {} file dependencies, {} mismatches, build {} usec", products.Count(), fileDependencies.Count(), numMismatches, buildMicroseconds);
+
+	if (numMismatches > 0)
+		RKIT_THROW(rkit::ResultCode::kOperationFailed);
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::RunImageKernelTests(const rkit::Span<const rkit::StringView> &args)
+{
+	uint32_t numPixels = 65536;
+	RKIT_CHECK(ParseCount(args, numPixels));
+
+	const rkit::IUtilitiesDriver &utils = *rkit::GetDrivers().m_utilitiesDriver;
+	const rkit::utils::IImageKernels &vectorKernels = *utils.GetImageKernels();
+	const rkit::utils::IImageKernels &referenceKernels = *utils.GetReferenceImageKernels();
+
+	// Short runs exercise the scalar tails, odd input offsets exercise unaligned loads
+	const size_t kMaxShortPixels = 64;
+	const size_t kMaxInOffset = 3;
+
+	const size_t maxPixels = rkit::Max<size_t>(numPixels, kMaxShortPixels);
+	const size_t numInBytes = (maxPixels + kMaxInOffset) * 4u;
+
+	rkit::Vector<uint8_t> inBytes;
+	rkit::Vector<uint16_t> inLinear;
+	rkit::Vector<uint8_t> palette;
+	rkit::Vector<uint8_t> vectorBytes;
+	rkit::Vector<uint8_t> referenceBytes;
+	rkit::Vector<uint16_t> vectorLinear;
+	rkit::Vector<uint16_t> referenceLinear;
+
+	RKIT_CHECK(inBytes.Resize(numInBytes));
+	RKIT_CHECK(inLinear.Resize(maxPixels + kMaxInOffset));
+	RKIT_CHECK(palette.Resize(256 * 4));
+	RKIT_CHECK(vectorBytes.Resize(maxPixels * 4u));
+	RKIT_CHECK(referenceBytes.Resize(maxPixels * 4u));
+	RKIT_CHECK(vectorLinear.Resize(maxPixels));
+	RKIT_CHECK(referenceLinear.Resize(maxPixels));
+
+	rkit::XorShift32 rng;
+	for (uint8_t &b : inBytes)
+		b = static_cast<uint8_t>(rng.Next() >> 24);
+
+	// Alpha extremes are the edge cases for premultiply
+	for (size_t i = 3; i < 64; i += 4)
+		inBytes[i] = (i & 4) ? 0xffu : 0u;
+
+	const uint32_t linearMask = (1u << utils.GetSRGBToLinearPrecisionBits()) - 1u;
+	for (uint16_t &linear : inLinear)
+		linear = static_cast<uint16_t>((rng.Next() >> 8) & linearMask);
+
+	inLinear[0] = 0;
+	inLinear[1] = static_cast<uint16_t>(linearMask);
+
+	for (size_t i = 0; i < palette.Count(); i++)
+		palette[i] = static_cast<uint8_t>(i * 37u);
+
+	ImageKernelBuffers vectorBuffers;
+	vectorBuffers.m_inBytes = inBytes.ToSpan();
+	vectorBuffers.m_inLinear = inLinear.ToSpan();
+	vectorBuffers.m_palette = palette.ToSpan();
+	vectorBuffers.m_outBytes = vectorBytes.ToSpan();
+	vectorBuffers.m_outLinear = vectorLinear.ToSpan();
+
+	ImageKernelBuffers referenceBuffers = vectorBuffers;
+	referenceBuffers.m_outBytes = referenceBytes.ToSpan();
+	referenceBuffers.m_outLinear = referenceLinear.ToSpan();
+
+	// A palette that's too short for some of the indexes, which both paths must reject
+	ImageKernelBuffers shortPaletteBuffers = referenceBuffers;
+	shortPaletteBuffers.m_palette = palette.ToSpan().SubSpan(0, 16 * 4);
+
+	const rkit::Utf8Char_t *labels[] =
+	{
+		u8"ExpandPalette8ToRGBA8",
+		u8"ExpandGray8ToRGBA8",
+		u8"ExpandRGB8ToRGBA8",
+		u8"SwapRedBlueRGBA8",
+		u8"PremultiplyAlphaRGBA8",
+		u8"DecodeSRGB8ToLinear",
+		u8"EncodeLinearToSRGB8",
+	};
+
+	uint32_t numTested = 0;
+	uint32_t numMismatches = 0;
+
+	for (size_t kernelIndex = 0; kernelIndex < sizeof(labels) / sizeof(labels[0]); kernelIndex++)
+	{
+		for (size_t inOffset = 0; inOffset <= kMaxInOffset; inOffset++)
+		{
+			for (size_t runPixels = 0; runPixels <= kMaxShortPixels + 1; runPixels++)
+			{
+				const size_t testPixels = (runPixels > kMaxShortPixels) ? maxPixels : runPixels;
+
+				// Pre-filling the outputs catches writes past the end of the run
+				memset(vectorBytes.GetBuffer(), 0xa5, vectorBytes.Count());
+				memset(referenceBytes.GetBuffer(), 0xa5, referenceBytes.Count());
+				memset(vectorLinear.GetBuffer(), 0xa5, vectorLinear.Count() * sizeof(uint16_t));
+				memset(referenceLinear.GetBuffer(), 0xa5, referenceLinear.Count() * sizeof(uint16_t));
+
+				const bool referenceOK = RunImageKernel(referenceKernels, kernelIndex, referenceBuffers, inOffset, testPixels);
+				const bool vectorOK = RunImageKernel(vectorKernels, kernelIndex, vectorBuffers, inOffset, testPixels);
+
+				bool matches = (referenceOK == vectorOK)
+					&& !memcmp(vectorBytes.GetBuffer(), referenceBytes.GetBuffer(), vectorBytes.Count())
+					&& !memcmp(vectorLinear.GetBuffer(), referenceLinear.GetBuffer(), vectorLinear.Count() * sizeof(uint16_t));
+
+				// Output is unspecified when an index is out of range, so only the result is compared
+				if (kernelIndex == 0)
+				{
+					const bool referenceShortOK = RunImageKernel(referenceKernels, kernelIndex, shortPaletteBuffers, inOffset, testPixels);
+
+					shortPaletteBuffers.m_outBytes = vectorBytes.ToSpan();
+					const bool vectorShortOK = RunImageKernel(vectorKernels, kernelIndex, shortPaletteBuffers, inOffset, testPixels);
+					shortPaletteBuffers.m_outBytes = referenceBytes.ToSpan();
+
+					matches = matches && (referenceShortOK == vectorShortOK);
+				}
+
+				if (!matches)
+				{
+					if (numMismatches < 20)
+						rkit::log::ErrorFmt(u8"Mismatch in {}: {} pixels at input offset {}", labels[kernelIndex], testPixels, inOffset);
+
+					numMismatches++;
+				}
+
+				numTested++;
+			}
+		}
+	}
+
+	rkit::log::LogInfoFmt(u8"ImageKernels: {} runs tested, {} mismatches", numTested, numMismatches);
+
+	if (numMismatches > 0)
+		RKIT_THROW(rkit::ResultCode::kOperationFailed);
+
+	RKIT_RETURN_OK;
+}
+
+bool anox::TestProgram::RunImageKernel(const rkit::utils::IImageKernels &kernels, size_t kernelIndex, const ImageKernelBuffers &buffers, size_t inOffset, size_t numPixels)
+{
+	const rkit::ConstSpan<uint8_t> inBytes = buffers.m_inBytes.SubSpan(inOffset);
+	const rkit::ConstSpan<uint16_t> inLinear = buffers.m_inLinear.SubSpan(inOffset, numPixels);
+	const rkit::Span<uint8_t> outRGBA = buffers.m_outBytes.SubSpan(0, numPixels * 4u);
+
+	switch (kernelIndex)
+	{
+	case 0:
+		return kernels.ExpandPalette8ToRGBA8(outRGBA, inBytes.SubSpan(0, numPixels), buffers.m_palette);
+	case 1:
+		kernels.ExpandGray8ToRGBA8(outRGBA, inBytes.SubSpan(0, numPixels));
+		return true;
+	case 2:
+		kernels.ExpandRGB8ToRGBA8(outRGBA, inBytes.SubSpan(0, numPixels * 3u), rkit::utils::RGBChannelOrder::kBGR);
+		return true;
+	case 3:
+		kernels.SwapRedBlueRGBA8(outRGBA, inBytes.SubSpan(0, numPixels * 4u));
+		return true;
+	case 4:
+		kernels.PremultiplyAlphaRGBA8(outRGBA, inBytes.SubSpan(0, numPixels * 4u));
+		return true;
+	case 5:
+		kernels.DecodeSRGB8ToLinear(buffers.m_outLinear.SubSpan(0, numPixels), inBytes.SubSpan(0, numPixels));
+		return true;
+	case 6:
+		kernels.EncodeLinearToSRGB8(buffers.m_outBytes.SubSpan(0, numPixels), inLinear);
+		return true;
+	default:
+		return false;
+	}
+}
+
+rkit::Result anox::TestProgram::RunStringToFloatTests(const rkit::Span<const rkit::StringView> &args)
+{
+	// Every float bit pattern by default
+	uint32_t stride = 1;
+	RKIT_CHECK(ParseCount(args, stride));
+
+	uint32_t numTested = 0;
+	uint32_t numMismatches = 0;
+	rkit::String str;
+
+	uint64_t bits = 0;
+	while (bits <= 0xffffffffu)
+	{
+		const uint32_t floatBits = static_cast<uint32_t>(bits);
+		bits += stride;
+
+		// Infinities and NaNs always take the slow path
+		if ((floatBits & 0x7f800000u) == 0x7f800000u)
+			continue;
+
+		float f = 0.f;
+		memcpy(&f, &floatBits, sizeof(f));
+
+		// Shortest round-trip representation, which both paths must parse exactly
+		RKIT_CHECK(str.Format(u8"{}", f));
+		RKIT_CHECK(CheckFloatParse<float>(str, &f, numMismatches));
+
+		// The midpoint to the next float away from zero is a hard case for rounding.
+		// Its shortest double representation isn't necessarily exactly halfway, so the
+		// paths are only compared against each other.
+		if ((floatBits & 0x7fffffffu) != 0x7f7fffffu)
+		{
+			const uint32_t nextBits = floatBits + 1u;
+			float next = 0.f;
+			memcpy(&next, &nextBits, sizeof(next));
+
+			const double midpoint = (static_cast<double>(f) + static_cast<double>(next)) * 0.5;
+
+			RKIT_CHECK(str.Format(u8"{}", midpoint));
+			RKIT_CHECK(CheckFloatParse<float>(str, nullptr, numMismatches));
+		}
+
+		numTested++;
+
+		if ((numTested & 0xfffffffu) == 0)
+			rkit::log::LogInfoFmt(u8"{} floats tested", numTested);
+	}
+
+	rkit::log::LogInfoFmt(u8"StringToFloat: {} floats tested, {} mismatches", numTested, numMismatches);
+
+	if (numMismatches > 0)
+		RKIT_THROW(rkit::ResultCode::kOperationFailed);
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::RunStringToDoubleTests(const rkit::Span<const rkit::StringView> &args)
+{
+	uint32_t numDoubles = 10000000;
+	RKIT_CHECK(ParseCount(args, numDoubles));
+
+	uint32_t numMismatches = 0;
+	rkit::String str;
+
+	rkit::XorShift32 rng;
+	for (uint32_t i = 0; i < numDoubles; i++)
+	{
+		const uint64_t doubleBits = (static_cast<uint64_t>(rng.Next()) << 32) | rng.Next();
+
+		if ((doubleBits & 0x7ff0000000000000u) == 0x7ff0000000000000u)
+			continue;
+
+		double d = 0.0;
+		memcpy(&d, &doubleBits, sizeof(d));
+
+		RKIT_CHECK(str.Format(u8"{}", d));
+		RKIT_CHECK(CheckFloatParse<double>(str, &d, numMismatches));
+	}
+
+	rkit::log::LogInfoFmt(u8"StringToDouble: {} doubles tested, {} mismatches", numDoubles, numMismatches);
+
+	if (numMismatches > 0)
+		RKIT_THROW(rkit::ResultCode::kOperationFailed);
+
+	RKIT_RETURN_OK;
+}
+
+bool anox::TestProgram::ParseFast(float &f, const uint8_t *chars, size_t &inOutLen)
+{
+	return rkit::utils::CharsToFloat(f, chars, inOutLen);
+}
+
+bool anox::TestProgram::ParseFast(double &f, const uint8_t *chars, size_t &inOutLen)
+{
+	return rkit::utils::CharsToDouble(f, chars, inOutLen);
+}
+
+bool anox::TestProgram::ParseSlow(float &f, FloatScanChars &scanChars)
+{
+	return rkit::utils::CharsToFloatDynamic(f, &scanChars, FloatScanChars::GetOneChar, FloatScanChars::UnGetChar);
+}
+
+bool anox::TestProgram::ParseSlow(double &f, FloatScanChars &scanChars)
+{
+	return rkit::utils::CharsToDoubleDynamic(f, &scanChars, FloatScanChars::GetOneChar, FloatScanChars::UnGetChar);
+}
+
+template<class TFloat>
+rkit::Result anox::TestProgram::CheckFloatParse(const rkit::String &str, const TFloat *expected, uint32_t &inOutNumMismatches)
+{
+	const rkit::ByteStringView byteStr = str.ToByteView();
+
+	TFloat fastResult = 0;
+	size_t fastLength = byteStr.Length();
+	const bool fastOK = ParseFast(fastResult, byteStr.GetChars(), fastLength);
+
+	TFloat slowResult = 0;
+	FloatScanChars scanChars(byteStr);
+	const bool slowOK = ParseSlow(slowResult, scanChars);
+
+	bool matches = fastOK && slowOK && fastLength == byteStr.Length() && scanChars.m_pos == byteStr.Length()
+		&& !memcmp(&fastResult, &slowResult, sizeof(TFloat));
+
+	if (expected)
+		matches = matches && !memcmp(&fastResult, expected, sizeof(TFloat));
+
+	if (!matches)
+	{
+		// Only the first few are logged, since one bug usually affects many values
+		if (inOutNumMismatches < 20)
+			rkit::log::ErrorFmt(u8"Mismatch parsing {}: fast {}, slow {}", str, fastResult, slowResult);
+
+		inOutNumMismatches++;
+	}
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::WriteTestFile(rkit::utils::IShadowFile &shadowFile, const rkit::StringSliceView &path, const rkit::Vector<uint8_t> &contents)
+{
+	rkit::UniquePtr<rkit::ISeekableReadWriteStream> stream;
+	RKIT_CHECK(shadowFile.TryOpenFileReadWrite(stream, path, true, true));
+
+	if (!stream.IsValid())
+		RKIT_THROW(rkit::ResultCode::kFileOpenError);
+
+	RKIT_CHECK(stream->Truncate(0));
+	RKIT_CHECK(stream->WriteAll(contents.GetBuffer(), contents.Count()));
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::TestFileMatches(rkit::utils::IShadowFile &shadowFile, const rkit::StringSliceView &path, const rkit::Vector<uint8_t> &contents, bool &outMatches)
+{
+	outMatches = false;
+
+	rkit::UniquePtr<rkit::ISeekableReadStream> stream;
+	RKIT_CHECK(shadowFile.TryOpenFileRead(stream, path));
+
+	if (!stream.IsValid() || stream->GetSize() != contents.Count())
+		RKIT_RETURN_OK;
+
+	rkit::Vector<uint8_t> readBack;
+	RKIT_CHECK(readBack.Resize(contents.Count()));
+	RKIT_CHECK(stream->ReadAll(readBack.GetBuffer(), readBack.Count()));
+
+	outMatches = !memcmp(readBack.GetBuffer(), contents.GetBuffer(), contents.Count());
+
+	RKIT_RETURN_OK;
+}
+
+rkit::Result anox::TestProgram::Run()
+{
+	rkit::Span<const rkit::StringView> args = rkit::GetDrivers().m_systemDriver->GetCommandLine();
+
+	if (args.Count() >= 1)
+	{
+		const rkit::Span<const rkit::StringView> testArgs = args.SubSpan(1);
+
+		if (args[0] == u8"shadowfile" && testArgs.Count() == 0)
+			return RunShadowFileTests();
+
+		if (args[0] == u8"nodeitems")
+			return RunNodeItemTests(testArgs);
+
+		if (args[0] == u8"imagekernels")
+			return RunImageKernelTests(testArgs);
+
+		if (args[0] == u8"stringtofloat")
+			return RunStringToFloatTests(testArgs);
+
+		if (args[0] == u8"stringtodouble")
+			return RunStringToDoubleTests(testArgs);
+	}
+
+	::rkit::log::Error(u8"Usage: Test shadowfile");
+	::rkit::log::Error(u8"       Test nodeitems <scratch directory path> [item count]");
+	::rkit::log::Error(u8"       Test imagekernels [pixel count]");
+	::rkit::log::Error(u8"       Test stringtofloat [bit pattern stride]");
+	::rkit::log::Error(u8"       Test stringtodouble [value count]");
+	RKIT_THROW(rkit::ResultCode::kInvalidParameter);
+}
+
+RKIT_IMPLEMENT_MODULE(Tool, Test, ::anox::TestModule)
@@ -473,10 +473,10 @@ namespace APEWindowCommandReflector
                                 initValue = "0";
                                 break;
                             case FieldDef.FieldType.Str:
-                                fieldCppType = "::rkit::ByteString";
+                                fieldCppType = "::rkit::ByteStringView";
                                 break;
                             case FieldDef.FieldType.OptStr:
-                                fieldCppType = "::rkit::Optional<::rkit::ByteString>";
+                                fieldCppType = "::rkit::Optional<::rkit::ByteStringView>";
                                 break;
                             case FieldDef.FieldType.Format:
                                 fieldCppType = "FormattingValue";
@@ -42,13 +42,15 @@ namespace SandboxAPIGenerator
         public ParameterDef[] ReturnValues { get; private set; }
         public string Name { get; private set; }
         public bool NoExcept { get; private set; }
+        public bool DevOnly { get; private set; }
 
-        public FunctionDef(string name, ParameterDef[] parameters, ParameterDef[] returnValues, bool noExcept)
+        public FunctionDef(string name, ParameterDef[] parameters, ParameterDef[] returnValues, bool noExcept, bool devOnly)
         {
             Parameters = parameters;
             ReturnValues = returnValues;
             Name = name;
             NoExcept = noExcept;
+            DevOnly = devOnly;
         }
     }
 
@@ -353,12 +355,16 @@ namespace SandboxAPIGenerator
                 else if (directive == "export" || directive == "import")
                 {
                     bool isExport = (directive == "export");
-                    ParseFunctionDef(lineNum, tokens, isExport ? exports : imports, !isExport);
+                    ParseFunctionDef(lineNum, tokens, isExport ? exports : imports, !isExport, isExport);
                 }
                 else
                     ThrowOnLine(lineNum, "Unknown directive");
             }
 
+            // Dev-only exports go last so that the indexes of the other exports are the same in final builds
+            exports = exports.Where(fdef => !fdef.DevOnly).Concat(exports.Where(fdef => fdef.DevOnly)).ToList();
+            string exportCount = CountExpression(exports);
+
             {
                 string[] targetPathChunks = SplitIdentifierChunks(targetPath, '/', "target");
                 string[] classNameChunks = SplitIdentifierChunks(className, '.', "class name");
@@ -415,10 +421,12 @@ namespace SandboxAPIGenerator
 
                     foreach (FunctionDef fdef in exports)
                     {
+                        WriteDevOnlyBegin(sw, fdef);
                         sw.Write(indent + "\tstatic ::rkit::Result " + fdef.Name);
 
                         WriteCanonicalParamList(sw, "", fdef, false);
                         sw.WriteLine(";");
+                        WriteDevOnlyEnd(sw, fdef);
                     }
 
                     sw.WriteLine(indent + "};");
@@ -520,6 +528,7 @@ namespace SandboxAPIGenerator
                     sw.WriteLine(indent + "public:");
                     foreach (FunctionDef fdef in exports)
                     {
+                        WriteDevOnlyBegin(sw, fdef);
                         sw.WriteLine(indent + "\tstatic void " + fdef.Name + "(void *ioContext) noexcept");
                         sw.WriteLine(indent + "\t{");
 
@@ -584,18 +593,21 @@ namespace SandboxAPIGenerator
                         }
 
                         sw.WriteLine(indent + "\t}");
+                        WriteDevOnlyEnd(sw, fdef);
                         sw.WriteLine();
                     }
 
-                    sw.WriteLine(indent + "\tstatic const ::rkit::sandbox::ExportDescriptor ms_exports[" + exports.Count + "];");
+                    sw.WriteLine(indent + "\tstatic const ::rkit::sandbox::ExportDescriptor ms_exports[" + exportCount + "];");
                     sw.WriteLine(indent + "};");
 
                     sw.WriteLine();
-                    sw.WriteLine(indent + "const ::rkit::sandbox::ExportDescriptor SandboxExportThunks::ms_exports[" + exports.Count + "] =");
+                    sw.WriteLine(indent + "const ::rkit::sandbox::ExportDescriptor SandboxExportThunks::ms_exports[" + exportCount + "] =");
                     sw.WriteLine(indent + "{");
                     foreach (FunctionDef fdef in exports)
                     {
+                        WriteDevOnlyBegin(sw, fdef);
                         sw.WriteLine(indent + "\t{ u8\"" + fdef.Name + "\", " + fdef.Name.Length.ToString() + ", SandboxExportThunks::" + fdef.Name + " },");
+                        WriteDevOnlyEnd(sw, fdef);
 
                     }
                     sw.WriteLine(indent + "};");
@@ -609,7 +621,7 @@ namespace SandboxAPIGenerator
                     sw.WriteLine(indent + "\t\tsizeof(::rkit::sandbox::ExportDescriptor),");
                     sw.WriteLine(indent + "\t\t0,");
                     sw.WriteLine(indent + "\t\t" + imports.Count.ToString() + ",");
-                    sw.WriteLine(indent + "\t\t" + exports.Count.ToString() + ",");
+                    sw.WriteLine(indent + "\t\t" + exportCount + ",");
                     sw.WriteLine(indent + "\t},");
                     sw.WriteLine(indent + "\tSandboxAPI::ms_sysCallDescriptors,");
                     sw.WriteLine(indent + "\tSandboxAPI::ms_sysCallStubs,");
@@ -650,10 +662,12 @@ namespace SandboxAPIGenerator
 
                     foreach (FunctionDef fdef in exports)
                     {
+                        WriteDevOnlyBegin(sw, fdef);
                         sw.Write(indent + "\t::rkit::Result " + fdef.Name);
 
                         WriteCanonicalParamList(sw, "::rkit::sandbox::IThreadContext *thread", fdef, true);
                         sw.WriteLine(" const;");
+                        WriteDevOnlyEnd(sw, fdef);
                     }
 
                     sw.WriteLine();
@@ -664,7 +678,7 @@ namespace SandboxAPIGenerator
                     sw.WriteLine(indent + "\tHostImports &operator=(const HostImports&) = delete;");
                     sw.WriteLine(indent + "\tHostImports(const HostImports&) = delete;");
                     sw.WriteLine();
-                    sw.WriteLine(indent + "\t::rkit::sandbox::Address_t m_importAddresses[" + exports.Count.ToString() + "];");
+                    sw.WriteLine(indent + "\t::rkit::sandbox::Address_t m_importAddresses[" + exportCount + "];");
                     sw.WriteLine(indent + "\t::rkit::sandbox::HostAPIDescriptor m_hostAPI;");
 
                     sw.WriteLine(indent + "};");
@@ -711,7 +725,7 @@ namespace SandboxAPIGenerator
                     sw.WriteLine(indent + "public:");
                     sw.WriteLine(indent + "\tstatic const ::rkit::sandbox::io::SysCallDispatchFunc_t ms_sysCalls[" + imports.Count.ToString() + "];");
                     sw.WriteLine(indent + "\tstatic const ::rkit::sandbox::HostAPIName ms_sysCallNames[" + imports.Count.ToString() + "];");
-                    sw.WriteLine(indent + "\tstatic const ::rkit::sandbox::HostAPIName ms_importNames[" + exports.Count.ToString() + "];");
+                    sw.WriteLine(indent + "\tstatic const ::rkit::sandbox::HostAPIName ms_importNames[" + exportCount + "];");
                     sw.WriteLine();
                     sw.WriteLine(indent + "private:");
 
@@ -743,11 +757,13 @@ namespace SandboxAPIGenerator
                     sw.WriteLine(indent + "};");
                     sw.WriteLine();
 
-                    sw.WriteLine(indent + "const ::rkit::sandbox::HostAPIName HostAPI::ms_importNames[" + exports.Count.ToString() + "] =");
+                    sw.WriteLine(indent + "const ::rkit::sandbox::HostAPIName HostAPI::ms_importNames[" + exportCount + "] =");
                     sw.WriteLine(indent + "{");
                     foreach (FunctionDef fdef in exports)
                     {
+                        WriteDevOnlyBegin(sw, fdef);
                         sw.WriteLine(indent + "\t{ u8\"" + fdef.Name + "\", " + fdef.Name.Length.ToString() + " },");
+                        WriteDevOnlyEnd(sw, fdef);
                     }
                     sw.WriteLine(indent + "};");
                     sw.WriteLine();
@@ -827,6 +843,7 @@ namespace SandboxAPIGenerator
                         ParameterDef[] parameters = fdef.Parameters;
                         ParameterDef[] returnValues = fdef.ReturnValues;
 
+                        WriteDevOnlyBegin(sw, fdef);
                         sw.Write(indent + "::rkit::Result HostImports::" + fdef.Name + "(::rkit::sandbox::IThreadContext *thread");
 
                         foreach (ParameterDef rv in returnValues)
@@ -852,12 +869,13 @@ namespace SandboxAPIGenerator
 
                         sw.WriteLine(indent + "\tRKIT_RETURN_OK;");
                         sw.WriteLine(indent + "}");
+                        WriteDevOnlyEnd(sw, fdef);
                         sw.WriteLine();
                     }
 
                     sw.WriteLine(indent + "HostImports::HostImports()");
                     sw.WriteLine(indent + "\t: m_importAddresses {}");
-                    sw.WriteLine(indent + "\t, m_hostAPI{ nullptr, { HostAPI::ms_sysCalls, " + imports.Count.ToString() + " }, HostAPI::ms_sysCallNames, m_importAddresses, HostAPI::ms_importNames, " + exports.Count.ToString() + " }");
+                    sw.WriteLine(indent + "\t, m_hostAPI{ nullptr, { HostAPI::ms_sysCalls, " + imports.Count.ToString() + " }, HostAPI::ms_sysCallNames, m_importAddresses, HostAPI::ms_importNames, " + exportCount + " }");
                     sw.WriteLine(indent + "{");
                     sw.WriteLine(indent + "}");
 
@@ -939,7 +957,29 @@ namespace SandboxAPIGenerator
             }
         }
 
-        private static void ParseFunctionDef(int lineNum, string[] tokens, IList<FunctionDef> functionDefs, bool noExceptAllowed)
+        private static string CountExpression(IList<FunctionDef> functionDefs)
+        {
+            int numDevOnly = functionDefs.Count(fdef => fdef.DevOnly);
+
+            if (numDevOnly == 0)
+                return functionDefs.Count.ToString();
+
+            return "(" + (functionDefs.Count - numDevOnly).ToString() + " + ((!RKIT_IS_FINAL) ? " + numDevOnly.ToString() + " : 0))";
+        }
+
+        private static void WriteDevOnlyBegin(StreamWriter sw, FunctionDef fdef)
+        {
+            if (fdef.DevOnly)
+                sw.WriteLine("#if !RKIT_IS_FINAL");
+        }
+
+        private static void WriteDevOnlyEnd(StreamWriter sw, FunctionDef fdef)
+        {
+            if (fdef.DevOnly)
+                sw.WriteLine("#endif");
+        }
+
+        private static void ParseFunctionDef(int lineNum, string[] tokens, IList<FunctionDef> functionDefs, bool noExceptAllowed, bool devOnlyAllowed)
         {
             if (tokens.Length < 2)
                 ThrowOnLine(lineNum, "Invalid function def");
@@ -968,10 +1008,17 @@ namespace SandboxAPIGenerator
                 tokenNum++;
             }
 
+            bool isDevOnly = false;
+            if (tokenNum < tokens.Length && devOnlyAllowed && tokens[tokenNum] == "dev_only")
+            {
+                isDevOnly = true;
+                tokenNum++;
+            }
+
             if (tokenNum < tokens.Length)
                 ThrowOnLine(lineNum, "Unexpected tokens after return value list");
 
-            functionDefs.Add(new FunctionDef(functionName, parameters.ToArray(), returnValues.ToArray(), isNoExcept));
+            functionDefs.Add(new FunctionDef(functionName, parameters.ToArray(), returnValues.ToArray(), isNoExcept, isDevOnly));
         }
     }
 }
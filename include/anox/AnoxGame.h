@@ -28,6 +28,8 @@ namespace anox
 	class AudioSubsystem;
 	struct ICaptureHarness;
 
+	enum class RenderBackend;
+
 	struct IAnoxGame
 	{
 		virtual ~IAnoxGame() {}
@@ -44,6 +46,6 @@ namespace anox
 
 		virtual rkit::ResultCoroutine RestartGame(rkit::ICoroThread &thread, rkit::StringView initialMapName) = 0;
 
-		static rkit::Result Create(rkit::UniquePtr<IAnoxGame> &outGame, const rkit::Optional<uint16_t> &numThreads);
+		static rkit::Result Create(rkit::UniquePtr<IAnoxGame> &outGame, const rkit::Optional<uint16_t> &numThreads, RenderBackend renderBackend);
 	};
 }
@@ -1,6 +1,10 @@
 #pragma once
 
-#include "rkit/Core/Drivers.h"
+#include "rkit/BuildSystem/BuildSystem.h"
+#include "rkit/Core/SpanProtos.h"
+
+#include <cstddef>
+#include <cstdint>
 
 namespace rkit
 {
@@ -10,7 +14,9 @@ namespace rkit
 
 namespace anox
 {
-	struct IBuildDriver : public rkit::ICustomDriver
+	struct IBuildDriver : public rkit::buildsystem::IBuildSystemAddOnDriver
 	{
+		virtual rkit::Result ParseAPEScript(const rkit::ConstSpan<uint8_t> &fileContents, size_t &outNumCommands) const = 0;
+		virtual rkit::Result CompileAPEScript(rkit::buildsystem::IBuildSystemInstance &instance, const rkit::ConstSpan<uint8_t> &fileContents, size_t minItemsPerBatch) const = 0;
 	};
 }
@@ -12,6 +12,7 @@ namespace rkit
 	template<class T>
 	class UniquePtr;
 
+	struct IJobRunner;
 	struct IReadStream;
 
 	namespace data
@@ -71,6 +72,9 @@ namespace rkit
 			virtual Result Initialize(const StringView &targetName, const OSAbsPathView &srcDir, const OSAbsPathView &intermediateDir, const OSAbsPathView &dataFilesDir, const OSAbsPathView &dataContentDir) = 0;
 			virtual Result LoadCache() = 0;
 
+			// Times loading and saving the cache against decoding and rewriting every record.  Must be called instead of LoadCache.
+			virtual Result BenchmarkCache(uint32_t numPasses) = 0;
+
 			virtual IDependencyNode *FindNamedNode(uint32_t nodeTypeNamespace, uint32_t nodeTypeID, BuildFileLocation inputFileLocation, const StringView &identifier) const = 0;
 			virtual IDependencyNode *FindContentNode(uint32_t nodeTypeNamespace, uint32_t nodeTypeID, BuildFileLocation inputFileLocation, const Span<const uint8_t> &content) const = 0;
 			virtual Result FindOrCreateNamedNode(uint32_t nodeTypeNamespace, uint32_t nodeTypeID, BuildFileLocation inputFileLocation, const StringView &identifier, IDependencyNode *&outNode) = 0;
@@ -84,8 +88,21 @@ namespace rkit
 
 			virtual Result Build(IBuildFileSystem *fs) = 0;
 
+			// Rebuilds using file statuses cached by a previous build, except for ones that were invalidated
+			virtual Result BuildIncremental(IBuildFileSystem *fs) = 0;
+			virtual Result InvalidateFileStatus(BuildFileLocation location, const CIPathView &path) = 0;
+
 			virtual IDependencyGraphFactory *GetDependencyGraphFactory() const = 0;
 
+			// Number of batches to split independent items into, given the fewest items that are worth
+			// a batch of their own.  Returns 0 or 1 if the items should be processed on the calling thread.
+			virtual size_t ComputeNumBatches(size_t numItems, size_t minItemsPerBatch) const = 0;
+
+			// Runs independent jobs on the build's thread pool, including the calling thread, and waits
+			// for all of them to finish.  If other analyses are running concurrently, the jobs are run
+			// on the calling thread instead.
+			virtual Result RunBatchJobs(Vector<UniquePtr<IJobRunner>> &&batchRunners) = 0;
+
 			virtual CallbackSpan<IDependencyNode *, const IBuildSystemInstance *> GetBuildRelevantNodes() const = 0;
 
 			virtual Result TryOpenFileRead(BuildFileLocation location, const CIPathView &path, UniquePtr<ISeekableReadStream> &outFile) = 0;
@@ -134,5 +151,10 @@ namespace rkit
 		{
 			return u8"rpll_c/glob";
 		}
+
+		inline CIPathView GetCompiledShaderCacheIntermediateBasePath()
+		{
+			return u8"rpll_c/spv";
+		}
 	}
 }
@@ -179,15 +179,29 @@ namespace rkit
 			virtual Result Deserialize(IReadStream &stream, const IDeserializeResolver &resolver) = 0;
 		};
 
+		// Parsed form of a shared input file, owned by the build instance and immutable once parsed
+		struct IMemoizedInput
+		{
+			virtual ~IMemoizedInput() {}
+		};
+
 		struct IDependencyNodeCompilerFeedback
 		{
 			typedef Result(*EnumerateFilesResultCallback_t)(void *userdata, const CIPathView &fileName);
+			typedef Result(*ParseMemoizedInputCallback_t)(ISeekableReadStream &stream, UniquePtr<IMemoizedInput> &outParsedInput);
 
 			virtual ~IDependencyNodeCompilerFeedback() {}
 
 			virtual Result CheckInputExists(BuildFileLocation location, const CIPathView &path, bool &outExists) = 0;
 			virtual Result OpenInput(BuildFileLocation location, const CIPathView &path, UniquePtr<ISeekableReadStream> &inputFile) = 0;
 			virtual Result TryOpenInput(BuildFileLocation location, const CIPathView &path, UniquePtr<ISeekableReadStream> &inputFile) = 0;
+
+			// Opens an input file and parses it with the parse callback, or returns the previously-parsed object if the same
+			// file was already parsed by the same callback and its contents haven't changed.  Records the same dependency as
+			// OpenInput.  The parsed object remains valid until the next build.
+			virtual Result OpenMemoizedInput(BuildFileLocation location, const CIPathView &path, ParseMemoizedInputCallback_t parseCallback, const IMemoizedInput *&outParsedInput) = 0;
+			virtual Result TryOpenMemoizedInput(BuildFileLocation location, const CIPathView &path, ParseMemoizedInputCallback_t parseCallback, const IMemoizedInput *&outParsedInput) = 0;
+
 			virtual Result OpenOutput(BuildFileLocation location, const CIPathView &path, UniquePtr<ISeekableReadWriteStream> &outputFile) = 0;
 			virtual Result IndexCAS(BuildFileLocation location, const CIPathView &path, data::ContentID &outContentID) = 0;
 			virtual Result AddAnonymousDeployableContent(BuildFileLocation location, const CIPathView &path) = 0;
@@ -212,6 +226,10 @@ namespace rkit
 			virtual Result RunAnalysis(IDependencyNode *depsNode, IDependencyNodeCompilerFeedback *feedback) = 0;
 			virtual Result RunCompile(IDependencyNode *depsNode, IDependencyNodeCompilerFeedback *feedback) = 0;
 
+			// If this returns true, RunAnalysis may be called from a worker thread, concurrently with
+			// other analyses.  The compiler must then only access shared build state through the feedback.
+			virtual bool CanRunAnalysisConcurrently() const { return false; }
+
 			virtual uint32_t GetVersion() const = 0;
 		};
 
@@ -0,0 +1,438 @@
+#pragma once
+
+#include "Stream.h"
+
+#include <cstdint>
+
+namespace rkit
+{
+	// Buffered adapters for streams that are read or written in many small
+	// pieces.  Calls made through the adapter type itself (ReadAll, ReadOneBinary,
+	// WriteAll, etc.) are inlined and only call into the underlying stream when
+	// the buffer is exhausted.  Calls made through the stream interfaces still
+	// work, but go through the virtual ReadPartial/WritePartial.
+	//
+	// The adapters don't own the underlying stream or the buffer.  Use the
+	// utilities driver to create adapters that own both.
+	class BufferedReadStream : public virtual IReadStream
+	{
+	public:
+		BufferedReadStream(IReadStream &stream, const Span<uint8_t> &buffer);
+
+		Result ReadPartial(void *data, size_t count, size_t &outCountRead) override;
+		Result ReadAll(void *data, size_t count);
+
+		template<class T>
+		Result ReadOneBinary(T &object);
+
+		template<class T>
+		Result ReadAllSpan(const rkit::Span<T> &span);
+
+		// Returns the number of bytes that have been read from the underlying
+		// stream but not consumed yet
+		size_t GetBufferedCount() const;
+
+	protected:
+		Result ReadAllSlow(void *data, size_t count);
+		Result RefillBuffer(size_t minCount);
+		void DiscardBuffer();
+
+		IReadStream &m_stream;
+
+		uint8_t *m_bufferStart;
+		size_t m_bufferCapacity;
+
+		const uint8_t *m_bufferPos;
+		const uint8_t *m_bufferEnd;
+	};
+
+	class BufferedSeekableReadStream : public BufferedReadStream, public virtual ISeekableReadStream
+	{
+	public:
+		BufferedSeekableReadStream(ISeekableReadStream &stream, const Span<uint8_t> &buffer);
+
+		Result SeekStart(FilePos_t pos) override;
+		Result SeekCurrent(FileOffset_t offset) override;
+		Result SeekEnd(FileOffset_t offset) override;
+
+		FilePos_t Tell() const override;
+		FilePos_t GetSize() const override;
+
+	private:
+		ISeekableReadStream &m_seekableStream;
+	};
+
+	// Buffered data is only written to the underlying stream when the buffer
+	// fills or when Flush is called.  Anything still buffered when the adapter
+	// is destroyed is discarded, so the owner must Flush to observe errors.
+	class BufferedWriteStream : public virtual IWriteStream
+	{
+	public:
+		BufferedWriteStream(IWriteStream &stream, const Span<uint8_t> &buffer);
+
+		Result WritePartial(const void *data, size_t count, size_t &outCountWritten) override;
+		Result WriteAll(const void *data, size_t count);
+
+		template<class T>
+		Result WriteOneBinary(const T &object);
+
+		template<class T>
+		Result WriteAllSpan(const rkit::Span<T> &span);
+
+		Result Flush() override;
+
+		// Returns the number of bytes waiting to be written to the underlying stream
+		size_t GetBufferedCount() const;
+
+	protected:
+		Result WriteAllSlow(const void *data, size_t count);
+		Result FlushBuffer();
+
+		IWriteStream &m_stream;
+
+		uint8_t *m_bufferStart;
+		uint8_t *m_bufferPos;
+		uint8_t *m_bufferEnd;
+	};
+
+	class BufferedSeekableWriteStream : public BufferedWriteStream, public virtual ISeekableWriteStream
+	{
+	public:
+		BufferedSeekableWriteStream(ISeekableWriteStream &stream, const Span<uint8_t> &buffer);
+
+		Result SeekStart(FilePos_t pos) override;
+		Result SeekCurrent(FileOffset_t offset) override;
+		Result SeekEnd(FileOffset_t offset) override;
+
+		FilePos_t Tell() const override;
+		FilePos_t GetSize() const override;
+
+		Result Truncate(FilePos_t size) override;
+
+	private:
+		ISeekableWriteStream &m_seekableStream;
+	};
+}
+
+#include "Algorithm.h"
+#include "Result.h"
+#include "Span.h"
+
+#include <cstring>
+
+inline rkit::BufferedReadStream::BufferedReadStream(IReadStream &stream, const Span<uint8_t> &buffer)
+	: m_stream(stream)
+	, m_bufferStart(buffer.Ptr())
+	, m_bufferCapacity(buffer.Count())
+	, m_bufferPos(buffer.Ptr())
+	, m_bufferEnd(buffer.Ptr())
+{
+}
+
+inline rkit::Result rkit::BufferedReadStream::ReadPartial(void *data, size_t count, size_t &outCountRead)
+{
+	size_t available = static_cast<size_t>(m_bufferEnd - m_bufferPos);
+
+	if (available == 0 && count > 0)
+	{
+		if (count >= m_bufferCapacity)
+		{
+			DiscardBuffer();
+			return m_stream.ReadPartial(data, count, outCountRead);
+		}
+
+		RKIT_CHECK(RefillBuffer(1));
+		available = static_cast<size_t>(m_bufferEnd - m_bufferPos);
+	}
+
+	if (count > available)
+		count = available;
+
+	if (count > 0)
+	{
+		memcpy(data, m_bufferPos, count);
+		m_bufferPos += count;
+	}
+
+	outCountRead = count;
+	RKIT_RETURN_OK;
+}
+
+inline rkit::Result rkit::BufferedReadStream::ReadAll(void *data, size_t count)
+{
+	if (count <= static_cast<size_t>(m_bufferEnd - m_bufferPos))
+	{
+		memcpy(data, m_bufferPos, count);
+		m_bufferPos += count;
+		RKIT_RETURN_OK;
+	}
+
+	return ReadAllSlow(data, count);
+}
+
+template<class T>
+inline rkit::Result rkit::BufferedReadStream::ReadOneBinary(T &object)
+{
+	return this->ReadAll(&object, sizeof(T));
+}
+
+template<class T>
+inline rkit::Result rkit::BufferedReadStream::ReadAllSpan(const rkit::Span<T> &span)
+{
+	if (span.Count() == 0)
+		RKIT_RETURN_OK;
+
+	return this->ReadAll(span.Ptr(), span.Count() * sizeof(T));
+}
+
+inline size_t rkit::BufferedReadStream::GetBufferedCount() const
+{
+	return static_cast<size_t>(m_bufferEnd - m_bufferPos);
+}
+
+inline rkit::Result rkit::BufferedReadStream::ReadAllSlow(void *data, size_t count)
+{
+	const size_t available = static_cast<size_t>(m_bufferEnd - m_bufferPos);
+
+	if (available > 0)
+	{
+		memcpy(data, m_bufferPos, available);
+		data = static_cast<uint8_t *>(data) + available;
+		count -= available;
+	}
+
+	DiscardBuffer();
+
+	if (count >= m_bufferCapacity)
+		return m_stream.ReadAll(data, count);
+
+	RKIT_CHECK(RefillBuffer(count));
+
+	if (static_cast<size_t>(m_bufferEnd - m_bufferPos) < count)
+		RKIT_THROW(ResultCode::kIOReadError);
+
+	memcpy(data, m_bufferPos, count);
+	m_bufferPos += count;
+
+	RKIT_RETURN_OK;
+}
+
+inline rkit::Result rkit::BufferedReadStream::RefillBuffer(size_t minCount)
+{
+	// Only called when the buffer is empty
+	size_t totalRead = 0;
+
+	m_bufferPos = m_bufferStart;
+	m_bufferEnd = m_bufferStart;
+
+	while (totalRead < minCount)
+	{
+		size_t countRead = 0;
+		RKIT_CHECK(m_stream.ReadPartial(m_bufferStart + totalRead, m_bufferCapacity - totalRead, countRead));
+
+		if (countRead == 0)
+			break;
+
+		totalRead += countRead;
+		m_bufferEnd = m_bufferStart + totalRead;
+	}
+
+	RKIT_RETURN_OK;
+}
+
+inline void rkit::BufferedReadStream::DiscardBuffer()
+{
+	m_bufferPos = m_bufferStart;
+	m_bufferEnd = m_bufferStart;
+}
+
+inline rkit::BufferedSeekableReadStream::BufferedSeekableReadStream(ISeekableReadStream &stream, const Span<uint8_t> &buffer)
+	: BufferedReadStream(stream, buffer)
+	, m_seekableStream(stream)
+{
+}
+
+inline rkit::Result rkit::BufferedSeekableReadStream::SeekStart(FilePos_t pos)
+{
+	// If the new position is inside of the buffered data, either behind or ahead
+	// of the read position, just move the read position
+	const FilePos_t streamPos = m_seekableStream.Tell();
+	const size_t bufferedSize = static_cast<size_t>(m_bufferEnd - m_bufferStart);
+
+	if (pos <= streamPos && streamPos - pos <= bufferedSize)
+	{
+		m_bufferPos = m_bufferEnd - static_cast<size_t>(streamPos - pos);
+		RKIT_RETURN_OK;
+	}
+
+	// Only discard the buffer once the seek succeeds, so that a failed seek
+	// leaves the stream at its previous position
+	RKIT_CHECK(m_seekableStream.SeekStart(pos));
+	DiscardBuffer();
+
+	RKIT_RETURN_OK;
+}
+
+inline rkit::Result rkit::BufferedSeekableReadStream::SeekCurrent(FileOffset_t offset)
+{
+	const FilePos_t currentPos = Tell();
+
+	if (offset < 0)
+	{
+		const FilePos_t backwardDist = rkit::ToUnsignedAbs<FileOffset_t, FilePos_t>(offset);
+		if (backwardDist > currentPos)
+			RKIT_THROW(ResultCode::kIOSeekOutOfRange);
+
+		return SeekStart(currentPos - backwardDist);
+	}
+
+	return SeekStart(currentPos + static_cast<FilePos_t>(offset));
+}
+
+inline rkit::Result rkit::BufferedSeekableReadStream::SeekEnd(FileOffset_t offset)
+{
+	if (offset > 0)
+		RKIT_THROW(ResultCode::kIOSeekOutOfRange);
+
+	const FilePos_t size = GetSize();
+	const FilePos_t backwardDist = rkit::ToUnsignedAbs<FileOffset_t, FilePos_t>(offset);
+	if (backwardDist > size)
+		RKIT_THROW(ResultCode::kIOSeekOutOfRange);
+
+	return SeekStart(size - backwardDist);
+}
+
+inline rkit::FilePos_t rkit::BufferedSeekableReadStream::Tell() const
+{
+	return m_seekableStream.Tell() - static_cast<FilePos_t>(m_bufferEnd - m_bufferPos);
+}
+
+inline rkit::FilePos_t rkit::BufferedSeekableReadStream::GetSize() const
+{
+	return m_seekableStream.GetSize();
+}
+
+inline rkit::BufferedWriteStream::BufferedWriteStream(IWriteStream &stream, const Span<uint8_t> &buffer)
+	: m_stream(stream)
+	, m_bufferStart(buffer.Ptr())
+	, m_bufferPos(buffer.Ptr())
+	, m_bufferEnd(buffer.Ptr() + buffer.Count())
+{
+}
+
+inline rkit::Result rkit::BufferedWriteStream::WritePartial(const void *data, size_t count, size_t &outCountWritten)
+{
+	RKIT_CHECK(WriteAll(data, count));
+
+	outCountWritten = count;
+	RKIT_RETURN_OK;
+}
+
+inline rkit::Result rkit::BufferedWriteStream::WriteAll(const void *data, size_t count)
+{
+	if (count <= static_cast<size_t>(m_bufferEnd - m_bufferPos))
+	{
+		memcpy(m_bufferPos, data, count);
+		m_bufferPos += count;
+		RKIT_RETURN_OK;
+	}
+
+	return WriteAllSlow(data, count);
+}
+
+template<class T>
+inline rkit::Result rkit::BufferedWriteStream::WriteOneBinary(const T &object)
+{
+	return this->WriteAll(&object, sizeof(T));
+}
+
+template<class T>
+inline rkit::Result rkit::BufferedWriteStream::WriteAllSpan(const rkit::Span<T> &span)
+{
+	if (span.Count() == 0)
+		RKIT_RETURN_OK;
+
+	return this->WriteAll(span.Ptr(), span.Count() * sizeof(T));
+}
+
+inline rkit::Result rkit::BufferedWriteStream::Flush()
+{
+	RKIT_CHECK(FlushBuffer());
+
+	return m_stream.Flush();
+}
+
+inline size_t rkit::BufferedWriteStream::GetBufferedCount() const
+{
+	return static_cast<size_t>(m_bufferPos - m_bufferStart);
+}
+
+inline rkit::Result rkit::BufferedWriteStream::WriteAllSlow(const void *data, size_t count)
+{
+	RKIT_CHECK(FlushBuffer());
+
+	if (count >= static_cast<size_t>(m_bufferEnd - m_bufferStart))
+		return m_stream.WriteAll(data, count);
+
+	memcpy(m_bufferPos, data, count);
+	m_bufferPos += count;
+
+	RKIT_RETURN_OK;
+}
+
+inline rkit::Result rkit::BufferedWriteStream::FlushBuffer()
+{
+	const size_t bufferedCount = static_cast<size_t>(m_bufferPos - m_bufferStart);
+
+	if (bufferedCount > 0)
+	{
+		RKIT_CHECK(m_stream.WriteAll(m_bufferStart, bufferedCount));
+		m_bufferPos = m_bufferStart;
+	}
+
+	RKIT_RETURN_OK;
+}
+
+inline rkit::BufferedSeekableWriteStream::BufferedSeekableWriteStream(ISeekableWriteStream &stream, const Span<uint8_t> &buffer)
+	: BufferedWriteStream(stream, buffer)
+	, m_seekableStream(stream)
+{
+}
+
+inline rkit::Result rkit::BufferedSeekableWriteStream::SeekStart(FilePos_t pos)
+{
+	RKIT_CHECK(FlushBuffer());
+
+	return m_seekableStream.SeekStart(pos);
+}
+
+inline rkit::Result rkit::BufferedSeekableWriteStream::SeekCurrent(FileOffset_t offset)
+{
+	RKIT_CHECK(FlushBuffer());
+
+	return m_seekableStream.SeekCurrent(offset);
+}
+
+inline rkit::Result rkit::BufferedSeekableWriteStream::SeekEnd(FileOffset_t offset)
+{
+	RKIT_CHECK(FlushBuffer());
+
+	return m_seekableStream.SeekEnd(offset);
+}
+
+inline rkit::FilePos_t rkit::BufferedSeekableWriteStream::Tell() const
+{
+	return m_seekableStream.Tell() + static_cast<FilePos_t>(m_bufferPos - m_bufferStart);
+}
+
+inline rkit::FilePos_t rkit::BufferedSeekableWriteStream::GetSize() const
+{
+	return rkit::Max<FilePos_t>(m_seekableStream.GetSize(), Tell());
+}
+
+inline rkit::Result rkit::BufferedSeekableWriteStream::Truncate(FilePos_t size)
+{
+	RKIT_CHECK(FlushBuffer());
+
+	return m_seekableStream.Truncate(size);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace rkit
+{
+	struct IMutex;
+	struct IReadWriteLock;
+
+	// Mutexes and locks passed to a condition variable must have been created by the same
+	// system driver, and must be held by the caller.  Waits may wake spuriously, so callers
+	// should re-check their predicate in a loop.
+	struct IConditionVariable
+	{
+		virtual ~IConditionVariable() {}
+
+		virtual void Wait(IMutex &mutex) = 0;
+		virtual bool TimedWait(IMutex &mutex, uint32_t msec) = 0;
+
+		virtual void WaitExclusive(IReadWriteLock &rwLock) = 0;
+		virtual void WaitShared(IReadWriteLock &rwLock) = 0;
+
+		virtual void WakeOne() = 0;
+		virtual void WakeAll() = 0;
+	};
+}
@@ -1,57 +1,71 @@
 #pragma once
 
 #include "Vector.h"
-#include "HashTable.h"
+#include "HashValue.h"
+#include "OpenAddressedIndex.h"
+
+#include <stdint.h>
 
 namespace rkit
 {
 	template<class T>
 	class Span;
 
+	// Ordered list of unique items.  The lookup table only stores 32-bit item indexes and
+	// cached hashes, and probes back into the item list to compare, so each item is only
+	// stored once.
 	template<class TItem>
 	class DeduplicatedList
 	{
 	public:
+		DeduplicatedList();
+
 		Result AddAndGetIndex(size_t &outIndex, const TItem &item);
 		Result Add(const TItem &item);
 
+		bool Find(size_t &outIndex, const TItem &item) const;
+
+		Result Reserve(size_t count);
+		void Clear();
+
+		size_t Count() const;
 		Span<const TItem> GetItems() const;
 
 	private:
-		HashMap<TItem, size_t> m_lookup;
+		bool FindPrehashed(size_t &outIndex, HashValue_t hash, const TItem &item) const;
+
+		OpenAddressedIndex m_index;
 		Vector<TItem> m_items;
 	};
 }
 
-#include "HashValue.h"
+#include "Hasher.h"
 
 #include <utility>
 
 namespace rkit
 {
+	template<class TItem>
+	DeduplicatedList<TItem>::DeduplicatedList()
+	{
+	}
+
 	template<class TItem>
 	Result DeduplicatedList<TItem>::AddAndGetIndex(size_t &outIndex, const TItem &item)
 	{
 		const HashValue_t hashValue = Hasher<TItem>::ComputeHash(0, item);
 
-		const typename HashMap<TItem, size_t>::ConstIterator_t it = m_lookup.FindPrehashed(hashValue, item);
-		if (it != m_lookup.end())
-			outIndex = it.Value();
-		else
-		{
-			const size_t newIndex = m_items.Count();
-			RKIT_CHECK(m_items.Append(item));
-			RKIT_TRY_CATCH_RETHROW(m_lookup.SetPrehashed(hashValue, item, newIndex),
-				CatchContext(
-					[this, newIndex]
-					{
-						m_items.ShrinkToSize(newIndex);
-					}
-				)
-			);
-
-			outIndex = newIndex;
-		}
+		if (FindPrehashed(outIndex, hashValue, item))
+			RKIT_RETURN_OK;
+
+		const size_t newIndex = m_items.Count();
+
+		RKIT_CHECK(m_index.Reserve(newIndex + 1));
+		RKIT_CHECK(m_items.Append(item));
+
+		m_index.Insert(newIndex, hashValue);
+
+		outIndex = newIndex;
 
 		RKIT_RETURN_OK;
 	}
@@ -63,9 +77,48 @@ namespace rkit
 		return AddAndGetIndex(index, item);
 	}
 
+	template<class TItem>
+	bool DeduplicatedList<TItem>::Find(size_t &outIndex, const TItem &item) const
+	{
+		return FindPrehashed(outIndex, Hasher<TItem>::ComputeHash(0, item), item);
+	}
+
+	template<class TItem>
+	Result DeduplicatedList<TItem>::Reserve(size_t count)
+	{
+		RKIT_CHECK(m_items.Reserve(count));
+		RKIT_CHECK(m_index.Reserve(count));
+
+		RKIT_RETURN_OK;
+	}
+
+	template<class TItem>
+	void DeduplicatedList<TItem>::Clear()
+	{
+		m_items.ShrinkToSize(0);
+		m_index.Clear();
+	}
+
+	template<class TItem>
+	size_t DeduplicatedList<TItem>::Count() const
+	{
+		return m_items.Count();
+	}
+
 	template<class TItem>
 	Span<const TItem> DeduplicatedList<TItem>::GetItems() const
 	{
 		return m_items.ToSpan();
 	}
+
+	template<class TItem>
+	bool DeduplicatedList<TItem>::FindPrehashed(size_t &outIndex, HashValue_t hash, const TItem &item) const
+	{
+		const TItem *items = m_items.GetBuffer();
+
+		return m_index.Find(outIndex, hash, [items, &item](size_t itemIndex)
+			{
+				return items[itemIndex] == item;
+			});
+	}
 }
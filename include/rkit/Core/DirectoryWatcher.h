@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CoreDefs.h"
+#include "PathProto.h"
+
+#include <cstdint>
+
+namespace rkit
+{
+	struct IDirectoryWatcher
+	{
+		typedef Result (*ChangedPathCallback_t)(void *userdata, const OSRelPathView &path);
+
+		virtual ~IDirectoryWatcher() {}
+
+		// Waits up to msec for changes under the watched directory.  Returns true if any are pending.
+		virtual bool WaitForChanges(uint32_t msec) = 0;
+
+		// Reports each pending changed path, relative to the watched directory, and resumes watching.
+		// If outOverflowed is set, changes were lost and the whole directory should be treated as changed.
+		virtual Result ReadChanges(bool &outOverflowed, void *userdata, ChangedPathCallback_t callback) = 0;
+	};
+}
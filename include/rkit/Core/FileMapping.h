@@ -0,0 +1,141 @@
+#pragma once
+
+#include "CoreDefs.h"
+#include "MemoryStream.h"
+#include "StreamProtos.h"
+#include "UniquePtr.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rkit
+{
+	template<class T>
+	class Span;
+
+	enum class FileMappingMode
+	{
+		kReadOnly,
+		kCopyOnWrite,		// Views are writable, but writes are private to the process and never reach the file
+	};
+
+	enum class FileAccessHint
+	{
+		kNormal,
+		kSequential,
+		kRandom,
+	};
+
+	struct IFileMappingView
+	{
+		virtual ~IFileMappingView() {}
+
+		virtual const void *GetData() const = 0;
+		virtual size_t GetSize() const = 0;
+
+		// Returns null if the mapping is read-only
+		virtual void *GetMutableData() const = 0;
+
+		// Asks the OS to start paging in a range of the view.  This is only a hint and may do nothing.
+		virtual void Prefetch(size_t offset, size_t size) = 0;
+
+		Span<const uint8_t> GetBytes() const;
+	};
+
+	struct IFileMapping
+	{
+		virtual ~IFileMapping() {}
+
+		virtual FilePos_t GetFileSize() const = 0;
+
+		// Size of a memory page.  Views always start and end on page boundaries internally, so
+		// prefetches and access patterns are most efficient in page-sized units.
+		virtual size_t GetPageSize() const = 0;
+
+		// Maps a range of the file.  The offset doesn't need to be aligned.  Views stay valid
+		// after the mapping that created them is destroyed.
+		virtual Result MapView(UniquePtr<IFileMappingView> &outView, FilePos_t offset, size_t size) = 0;
+
+		Result MapEntireFile(UniquePtr<IFileMappingView> &outView);
+	};
+
+	// Read stream over a mapped view that keeps the view alive
+	class MappedViewReadStream final : public ISeekableReadStream
+	{
+	public:
+		explicit MappedViewReadStream(UniquePtr<IFileMappingView> &&view);
+
+		Result ReadPartial(void *data, size_t count, size_t &outCountRead) override;
+
+		Result SeekStart(FilePos_t pos) override;
+		Result SeekCurrent(FileOffset_t pos) override;
+		Result SeekEnd(FileOffset_t pos) override;
+
+		FilePos_t Tell() const override;
+		FilePos_t GetSize() const override;
+
+	private:
+		UniquePtr<IFileMappingView> m_view;
+		ReadOnlyMemoryStream m_stream;
+	};
+}
+
+#include "Result.h"
+#include "Span.h"
+
+#include <limits>
+#include <utility>
+
+namespace rkit
+{
+	inline Span<const uint8_t> IFileMappingView::GetBytes() const
+	{
+		return Span<const uint8_t>(static_cast<const uint8_t *>(GetData()), GetSize());
+	}
+
+	inline Result IFileMapping::MapEntireFile(UniquePtr<IFileMappingView> &outView)
+	{
+		const FilePos_t fileSize = GetFileSize();
+
+		if (fileSize > std::numeric_limits<size_t>::max())
+			RKIT_THROW(ResultCode::kOutOfMemory);
+
+		return MapView(outView, 0, static_cast<size_t>(fileSize));
+	}
+
+	inline MappedViewReadStream::MappedViewReadStream(UniquePtr<IFileMappingView> &&view)
+		: m_view(std::move(view))
+		, m_stream(m_view->GetData(), m_view->GetSize())
+	{
+	}
+
+	inline Result MappedViewReadStream::ReadPartial(void *data, size_t count, size_t &outCountRead)
+	{
+		return m_stream.ReadPartial(data, count, outCountRead);
+	}
+
+	inline Result MappedViewReadStream::SeekStart(FilePos_t pos)
+	{
+		return m_stream.SeekStart(pos);
+	}
+
+	inline Result MappedViewReadStream::SeekCurrent(FileOffset_t pos)
+	{
+		return m_stream.SeekCurrent(pos);
+	}
+
+	inline Result MappedViewReadStream::SeekEnd(FileOffset_t pos)
+	{
+		return m_stream.SeekEnd(pos);
+	}
+
+	inline FilePos_t MappedViewReadStream::Tell() const
+	{
+		return m_stream.Tell();
+	}
+
+	inline FilePos_t MappedViewReadStream::GetSize() const
+	{
+		return m_stream.GetSize();
+	}
+}
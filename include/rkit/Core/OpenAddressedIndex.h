@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Vector.h"
+#include "HashValue.h"
+
+#include <stdint.h>
+
+namespace rkit
+{
+	// Linear-probed hash index over an external list of items.  Only 32-bit item indexes and
+	// cached hashes are stored, and the caller compares candidates against its own list, so
+	// each item is only stored once.
+	class OpenAddressedIndex
+	{
+	public:
+		OpenAddressedIndex();
+
+		// Calls matchFunc(itemIndex) for each candidate with a matching hash until it returns true
+		template<class TMatchFunc>
+		bool Find(size_t &outItemIndex, HashValue_t hash, const TMatchFunc &matchFunc) const;
+
+		// Grows the table so that it can index numItems items
+		Result Reserve(size_t numItems);
+
+		// Space for the item must already be reserved
+		void Insert(size_t itemIndex, HashValue_t hash);
+
+		void Clear();
+
+		size_t Count() const;
+
+	private:
+		struct Slot
+		{
+			uint32_t m_itemIndex;
+			HashValue_t m_hash;
+		};
+
+		static const uint32_t kEmptySlot = 0xFFFFFFFFu;
+		static const size_t kMinSlots = 16;
+
+		Result Rehash(size_t numSlots);
+		void InsertSlot(const Slot &slot);
+		size_t GetHomeSlot(HashValue_t hash) const;
+
+		static size_t SlotCountForItems(size_t count);
+
+		Vector<Slot> m_slots;
+		size_t m_count;
+		int m_slotShift;
+	};
+}
+
+#include "RKitAssert.h"
+
+#include <utility>
+
+namespace rkit
+{
+	inline OpenAddressedIndex::OpenAddressedIndex()
+		: m_count(0)
+		, m_slotShift(32)
+	{
+	}
+
+	template<class TMatchFunc>
+	bool OpenAddressedIndex::Find(size_t &outItemIndex, HashValue_t hash, const TMatchFunc &matchFunc) const
+	{
+		const size_t numSlots = m_slots.Count();
+		if (numSlots == 0)
+			return false;
+
+		const size_t slotMask = numSlots - 1;
+		const Slot *slots = m_slots.GetBuffer();
+
+		size_t slotIndex = GetHomeSlot(hash);
+		for (;;)
+		{
+			const Slot &slot = slots[slotIndex];
+			if (slot.m_itemIndex == kEmptySlot)
+				return false;
+
+			if (slot.m_hash == hash && matchFunc(static_cast<size_t>(slot.m_itemIndex)))
+			{
+				outItemIndex = slot.m_itemIndex;
+				return true;
+			}
+
+			slotIndex = (slotIndex + 1) & slotMask;
+		}
+	}
+
+	inline Result OpenAddressedIndex::Reserve(size_t numItems)
+	{
+		if (numItems > kEmptySlot)
+			RKIT_THROW(ResultCode::kIntegerOverflow);
+
+		// Keep the load factor at or below 3/4
+		if (numItems * 4u > m_slots.Count() * 3u)
+		{
+			RKIT_CHECK(Rehash(SlotCountForItems(numItems)));
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	inline void OpenAddressedIndex::Insert(size_t itemIndex, HashValue_t hash)
+	{
+		RKIT_ASSERT(itemIndex < kEmptySlot);
+		RKIT_ASSERT((m_count + 1) * 4u <= m_slots.Count() * 3u);
+
+		Slot slot;
+		slot.m_itemIndex = static_cast<uint32_t>(itemIndex);
+		slot.m_hash = hash;
+
+		InsertSlot(slot);
+		m_count++;
+	}
+
+	inline void OpenAddressedIndex::Clear()
+	{
+		for (Slot &slot : m_slots)
+			slot.m_itemIndex = kEmptySlot;
+
+		m_count = 0;
+	}
+
+	inline size_t OpenAddressedIndex::Count() const
+	{
+		return m_count;
+	}
+
+	inline Result OpenAddressedIndex::Rehash(size_t numSlots)
+	{
+		Vector<Slot> newSlots;
+		RKIT_CHECK(newSlots.Resize(numSlots));
+
+		for (Slot &slot : newSlots)
+		{
+			slot.m_itemIndex = kEmptySlot;
+			slot.m_hash = 0;
+		}
+
+		int slotShift = 32;
+		for (size_t i = numSlots; i > 1; i >>= 1)
+			slotShift--;
+
+		Vector<Slot> oldSlots = std::move(m_slots);
+		m_slots = std::move(newSlots);
+		m_slotShift = slotShift;
+
+		for (const Slot &slot : oldSlots)
+		{
+			if (slot.m_itemIndex != kEmptySlot)
+				InsertSlot(slot);
+		}
+
+		RKIT_RETURN_OK;
+	}
+
+	inline void OpenAddressedIndex::InsertSlot(const Slot &slot)
+	{
+		const size_t slotMask = m_slots.Count() - 1;
+		Slot *slots = m_slots.GetBuffer();
+
+		size_t slotIndex = GetHomeSlot(slot.m_hash);
+		while (slots[slotIndex].m_itemIndex != kEmptySlot)
+			slotIndex = (slotIndex + 1) & slotMask;
+
+		slots[slotIndex] = slot;
+	}
+
+	inline size_t OpenAddressedIndex::GetHomeSlot(HashValue_t hash) const
+	{
+		// Fibonacci hashing, so that weak hashes still spread across the high bits
+		return static_cast<size_t>(static_cast<uint32_t>(hash * 0x9E3779B1u) >> m_slotShift);
+	}
+
+	inline size_t OpenAddressedIndex::SlotCountForItems(size_t count)
+	{
+		size_t numSlots = kMinSlots;
+		while (numSlots * 3u < count * 4u)
+			numSlots *= 2u;
+
+		return numSlots;
+	}
+}
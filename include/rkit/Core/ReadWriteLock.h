@@ -0,0 +1,19 @@
+#pragma once
+
+namespace rkit
+{
+	// Lock that can be held by any number of readers or by a single writer.
+	// Locks are not recursive and can't be upgraded from shared to exclusive.
+	struct IReadWriteLock
+	{
+		virtual ~IReadWriteLock() {}
+
+		virtual void LockShared() = 0;
+		virtual bool TryLockShared() = 0;
+		virtual void UnlockShared() = 0;
+
+		virtual void LockExclusive() = 0;
+		virtual bool TryLockExclusive() = 0;
+		virtual void UnlockExclusive() = 0;
+	};
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "NoCopy.h"
+
+namespace rkit
+{
+	struct IReadWriteLock;
+
+	class SharedLock final : public NoCopy
+	{
+	public:
+		explicit SharedLock(IReadWriteLock &rwLock);
+		~SharedLock();
+
+		void Unlock();
+
+	private:
+		IReadWriteLock *m_rwLock;
+	};
+
+	class ExclusiveLock final : public NoCopy
+	{
+	public:
+		explicit ExclusiveLock(IReadWriteLock &rwLock);
+		~ExclusiveLock();
+
+		void Unlock();
+
+	private:
+		IReadWriteLock *m_rwLock;
+	};
+}
+
+#include "ReadWriteLock.h"
+
+namespace rkit
+{
+	inline SharedLock::SharedLock(IReadWriteLock &rwLock)
+		: m_rwLock(&rwLock)
+	{
+		rwLock.LockShared();
+	}
+
+	inline SharedLock::~SharedLock()
+	{
+		this->Unlock();
+	}
+
+	inline void SharedLock::Unlock()
+	{
+		if (m_rwLock)
+		{
+			m_rwLock->UnlockShared();
+			m_rwLock = nullptr;
+		}
+	}
+
+	inline ExclusiveLock::ExclusiveLock(IReadWriteLock &rwLock)
+		: m_rwLock(&rwLock)
+	{
+		rwLock.LockExclusive();
+	}
+
+	inline ExclusiveLock::~ExclusiveLock()
+	{
+		this->Unlock();
+	}
+
+	inline void ExclusiveLock::Unlock()
+	{
+		if (m_rwLock)
+		{
+			m_rwLock->UnlockExclusive();
+			m_rwLock = nullptr;
+		}
+	}
+}
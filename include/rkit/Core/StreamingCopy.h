@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Platform.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+#include <emmintrin.h>
+#endif
+
+namespace rkit
+{
+	// Copies into memory that the CPU only writes, such as write-combined upload memory.
+	// Large copies use non-temporal stores, so FinishStreamingCopies must be called before
+	// another thread or the GPU is allowed to observe the destination.
+	void StreamingCopy(void *dest, const void *src, size_t size);
+
+	// Copies bytes [offset, offset + size) of a set of rows, counted as if the rows were packed
+	// end to end.  Rows are contiguous if there is only one row or both pitches equal the row size.
+	void StreamingCopyRows(void *dest, const void *src, uint32_t rowSizeBytes, uint32_t rowInPitch, uint32_t rowOutPitch, uint32_t rowCount, uint64_t offset, uint64_t size);
+
+	void FinishStreamingCopies();
+}
+
+namespace rkit { namespace priv {
+	static const size_t kMinStreamingCopySize = 256;
+} } // rkit::priv
+
+namespace rkit
+{
+	inline void StreamingCopy(void *destPtr, const void *srcPtr, size_t size)
+	{
+		uint8_t *dest = static_cast<uint8_t *>(destPtr);
+		const uint8_t *src = static_cast<const uint8_t *>(srcPtr);
+
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+		// Non-temporal stores fill whole write-combining lines without reading the destination
+		// into the cache
+		if (size >= priv::kMinStreamingCopySize)
+		{
+			const size_t destMisalignment = static_cast<size_t>(reinterpret_cast<uintptr_t>(dest) & 15u);
+			if (destMisalignment != 0)
+			{
+				const size_t headSize = 16u - destMisalignment;
+
+				memcpy(dest, src, headSize);
+				dest += headSize;
+				src += headSize;
+				size -= headSize;
+			}
+
+			while (size >= 64)
+			{
+				const __m128i chunk0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+				const __m128i chunk1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+				const __m128i chunk2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+				const __m128i chunk3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 48));
+
+				_mm_stream_si128(reinterpret_cast<__m128i *>(dest), chunk0);
+				_mm_stream_si128(reinterpret_cast<__m128i *>(dest + 16), chunk1);
+				_mm_stream_si128(reinterpret_cast<__m128i *>(dest + 32), chunk2);
+				_mm_stream_si128(reinterpret_cast<__m128i *>(dest + 48), chunk3);
+
+				dest += 64;
+				src += 64;
+				size -= 64;
+			}
+
+			while (size >= 16)
+			{
+				_mm_stream_si128(reinterpret_cast<__m128i *>(dest), _mm_loadu_si128(reinterpret_cast<const __m128i *>(src)));
+
+				dest += 16;
+				src += 16;
+				size -= 16;
+			}
+		}
+#endif
+
+		if (size > 0)
+			memcpy(dest, src, size);
+	}
+
+	inline void StreamingCopyRows(void *destPtr, const void *srcPtr, uint32_t rowSizeBytes, uint32_t rowInPitch, uint32_t rowOutPitch, uint32_t rowCount, uint64_t offset, uint64_t size)
+	{
+		uint8_t *dest = static_cast<uint8_t *>(destPtr);
+		const uint8_t *src = static_cast<const uint8_t *>(srcPtr);
+
+		if (rowCount == 1 || (rowInPitch == rowSizeBytes && rowOutPitch == rowSizeBytes))
+		{
+			StreamingCopy(dest + offset, src + offset, static_cast<size_t>(size));
+			return;
+		}
+
+		uint64_t row = offset / rowSizeBytes;
+		uint32_t rowOffset = static_cast<uint32_t>(offset % rowSizeBytes);
+
+		while (size > 0)
+		{
+			const uint32_t copySize = (size < rowSizeBytes - rowOffset) ? static_cast<uint32_t>(size) : (rowSizeBytes - rowOffset);
+
+			StreamingCopy(dest + row * rowOutPitch + rowOffset, src + row * rowInPitch + rowOffset, copySize);
+
+			size -= copySize;
+			rowOffset = 0;
+			row++;
+		}
+	}
+
+	inline void FinishStreamingCopies()
+	{
+#if RKIT_PLATFORM_ARCH_HAVE_SSE2 != 0
+		// Streaming stores are weakly ordered
+		_mm_sfence();
+#endif
+	}
+}
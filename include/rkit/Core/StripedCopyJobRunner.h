@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Job.h"
+#include "SpanProtos.h"
+
+#include <stdint.h>
+
+namespace rkit
+{
+	// Striped copies split the bytes of a set of row copies into balanced ranges, one job each,
+	// counting bytes as if each copy's rows were packed end to end.  Ranges are at least
+	// kMinStripedCopyBytesPerJob bytes, and there are at most maxJobs of them.
+	static const uint64_t kMinStripedCopyBytesPerJob = 256 * 1024;
+
+	uint64_t ComputeNumStripedCopyJobs(uint64_t totalCopyBytes, uint32_t maxJobs);
+
+	template<class TCopy>
+	uint64_t ComputeStripedCopyTotalBytes(const ConstSpan<TCopy> &copies);
+
+	// Copies one range of a set of striped copies.  TCopy must have m_rowSizeBytes and m_rowCount
+	// members, and a CopyRange(offset, size) method that copies bytes of its own packed rows,
+	// typically with StreamingCopyRows.
+	template<class TCopy>
+	class StripedCopyJobRunner final : public IJobRunner
+	{
+	public:
+		StripedCopyJobRunner(const ConstSpan<TCopy> &copies, uint64_t firstByte, uint64_t endByte);
+
+		Result Run() override;
+
+	private:
+		ConstSpan<TCopy> m_copies;
+		uint64_t m_firstByte;
+		uint64_t m_endByte;
+	};
+}
+
+#include "Algorithm.h"
+#include "Result.h"
+#include "Span.h"
+#include "StreamingCopy.h"
+
+inline uint64_t rkit::ComputeNumStripedCopyJobs(uint64_t totalCopyBytes, uint32_t maxJobs)
+{
+	return rkit::Max<uint64_t>(rkit::Min<uint64_t>(totalCopyBytes / kMinStripedCopyBytesPerJob, maxJobs), 1);
+}
+
+template<class TCopy>
+uint64_t rkit::ComputeStripedCopyTotalBytes(const ConstSpan<TCopy> &copies)
+{
+	uint64_t totalCopyBytes = 0;
+	for (const TCopy &copy : copies)
+		totalCopyBytes += static_cast<uint64_t>(copy.m_rowSizeBytes) * copy.m_rowCount;
+
+	return totalCopyBytes;
+}
+
+template<class TCopy>
+rkit::StripedCopyJobRunner<TCopy>::StripedCopyJobRunner(const ConstSpan<TCopy> &copies, uint64_t firstByte, uint64_t endByte)
+	: m_copies(copies)
+	, m_firstByte(firstByte)
+	, m_endByte(endByte)
+{
+}
+
+template<class TCopy>
+rkit::Result rkit::StripedCopyJobRunner<TCopy>::Run()
+{
+	uint64_t copyStartByte = 0;
+	for (const TCopy &copy : m_copies)
+	{
+		if (copyStartByte >= m_endByte)
+			break;
+
+		const uint64_t copyEndByte = copyStartByte + static_cast<uint64_t>(copy.m_rowSizeBytes) * copy.m_rowCount;
+
+		if (copyEndByte > m_firstByte)
+		{
+			const uint64_t rangeStart = rkit::Max(m_firstByte, copyStartByte) - copyStartByte;
+			const uint64_t rangeEnd = rkit::Min(m_endByte, copyEndByte) - copyStartByte;
+
+			copy.CopyRange(rangeStart, rangeEnd - rangeStart);
+		}
+
+		copyStartByte = copyEndByte;
+	}
+
+	// Streaming stores are weakly ordered, so fence them before the job is marked done
+	rkit::FinishStreamingCopies();
+
+	RKIT_RETURN_OK;
+}
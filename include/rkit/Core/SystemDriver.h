@@ -29,13 +29,17 @@ namespace rkit
 	struct FileAttributes;
 
 	struct IDirectoryScan;
+	struct IDirectoryWatcher;
+	struct IFileMapping;
 	struct IJobQueue;
 	struct ISeekableReadStream;
 	struct ISeekableReadWriteStream;
 	struct ISeekableWriteStream;
 	struct ISystemLibrary;
+	struct IConditionVariable;
 	struct IEvent;
 	struct IMutex;
+	struct IReadWriteLock;
 	struct IThread;
 	struct IThreadContext;
 
@@ -56,6 +60,9 @@ namespace rkit
 		virtual bool GetFunction(void *fnPtrAddress, const AsciiStringView &fnName) = 0;
 	};
 
+	enum class FileMappingMode;
+	enum class FileAccessHint;
+
 	enum class FileLocation
 	{
 		kProgramDirectory,			// Same directory as the program
@@ -101,14 +108,25 @@ namespace rkit
 		virtual Result OpenFileReadWrite(UniquePtr<ISeekableReadWriteStream> &outStream, FileLocation location, const CIPathView &path, bool createIfNotExists, bool createDirectories, bool truncateIfExists, bool allowFailure) = 0;
 		virtual Result OpenFileReadWriteAbs(UniquePtr<ISeekableReadWriteStream> &outStream, const OSAbsPathView &path, bool createIfNotExists, bool createDirectories, bool truncateIfExists, bool allowFailure) = 0;
 
+		// Memory-maps an existing file.  The access hint is passed on to the OS's read-ahead policy.
+		virtual Result OpenFileMapping(UniquePtr<IFileMapping> &outMapping, FileLocation location, const CIPathView &path, FileMappingMode mode, FileAccessHint accessHint, bool allowFailure) = 0;
+		virtual Result OpenFileMappingAbs(UniquePtr<IFileMapping> &outMapping, const OSAbsPathView &path, FileMappingMode mode, FileAccessHint accessHint, bool allowFailure) = 0;
+
 		virtual Result CreateThreadWithPriority(UniqueThreadRef &outThread, UniquePtr<IThreadContext> &&threadContext, ThreadPriority priority, const StringView &threadName) = 0;
 		Result CreateThread(UniqueThreadRef &outThread, UniquePtr<IThreadContext> &&threadContext, const StringView &threadName);
 		virtual Result CreateMutex(UniquePtr<IMutex> &outMutex) = 0;
+		virtual Result CreateReadWriteLock(UniquePtr<IReadWriteLock> &outLock) = 0;
+		virtual Result CreateConditionVariable(UniquePtr<IConditionVariable> &outConditionVariable) = 0;
 		virtual Result CreateEvent(UniquePtr<IEvent> &outEvent, bool autoReset, bool startSignaled) = 0;
 		virtual void SleepMSec(uint32_t msec) const = 0;
 
+		// Monotonic high-resolution timer, intended for profiling
+		virtual uint64_t GetHighResTimestamp() const = 0;
+		virtual uint64_t GetHighResTimestampFrequency() const = 0;
+
 		virtual Result OpenDirectoryScan(UniquePtr<IDirectoryScan> &outDirectoryScan, FileLocation location, const CIPathView &path, bool allowFailure) = 0;
 		virtual Result OpenDirectoryScanAbs(UniquePtr<IDirectoryScan> &outDirectoryScan, const OSAbsPathView &path, bool allowFailure) = 0;
+		virtual Result OpenDirectoryWatcherAbs(UniquePtr<IDirectoryWatcher> &outWatcher, const OSAbsPathView &path, bool allowFailure) = 0;
 		virtual Result GetFileAttributes(bool &outSucceeded, bool &outExists, FileAttributes &outAttribs, FileLocation location, const CIPathView &path, bool allowFailure) = 0;
 		virtual Result GetFileAttributesAbs(bool &outSucceeded, bool &outExists, FileAttributes &outAttribs, const OSAbsPathView &path, bool allowFailure) = 0;
 
@@ -117,11 +135,17 @@ namespace rkit
 		virtual Result CopyFileFromAbs(bool &outSucceeded, const OSAbsPathView &srcPath, FileLocation location, const CIPathView &path, bool overwrite, bool allowFailure) = 0;
 		virtual Result CopyFile(bool &outSucceeded, FileLocation srcLocation, const CIPathView &srcPath, FileLocation destLocation, const CIPathView &destPath, bool overwrite, bool allowFailure) = 0;
 
+		// Creates destPath as a copy-on-write clone of srcPath.  Fails if the file system can't share the storage.
+		virtual Result CloneFileFromAbsToAbs(bool &outSucceeded, const OSAbsPathView &srcPath, const OSAbsPathView &destPath, bool allowFailure) = 0;
+
 		virtual Result MoveFileFromAbsToAbs(bool &outSucceeded, const OSAbsPathView &srcPath, const OSAbsPathView &destPath, bool overwrite, bool allowFailure) = 0;
 		virtual Result MoveFileToAbs(bool &outSucceeded, FileLocation location, const CIPathView &path, const OSAbsPathView &destPath, bool overwrite, bool allowFailure) = 0;
 		virtual Result MoveFileFromAbs(bool &outSucceeded, const OSAbsPathView &srcPath, FileLocation location, const CIPathView &path, bool overwrite, bool allowFailure) = 0;
 		virtual Result MoveFile(bool &outSucceeded, FileLocation srcLocation, const CIPathView &srcPath, FileLocation destLocation, const CIPathView &destPath, bool overwrite, bool allowFailure) = 0;
 
+		// Creates a directory and any missing parent directories.  Succeeds if the directory already exists.
+		virtual Result CreateDirectoriesAbs(bool &outSucceeded, const OSAbsPathView &path, bool allowFailure) = 0;
+
 		virtual Result SetGameDirectoryOverride(const OSAbsPathView &path) = 0;
 		virtual Result SetSettingsDirectory(const StringView &path) = 0;
 		virtual char GetPathSeparator() const = 0;
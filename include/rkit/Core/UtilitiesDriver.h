@@ -23,6 +23,7 @@ namespace rkit
 		struct IThreadPool;
 		struct IShadowFile;
 		struct IImage;
+		struct IImageKernels;
 		struct ImageSpec;
 	}
 
@@ -52,8 +53,14 @@ namespace rkit
 	struct IMutexProtectedReadStream;
 	struct IMutexProtectedWriteStream;
 
+	struct IFileMappingView;
 	struct IMallocDriver;
 	struct IReadStream;
+	struct IWriteStream;
+	class BufferedReadStream;
+	class BufferedSeekableReadStream;
+	class BufferedWriteStream;
+	class BufferedSeekableWriteStream;
 	struct ISeekableReadWriteStream;
 	struct ISeekableReadStream;
 	struct ISeekableWriteStream;
@@ -81,9 +88,21 @@ namespace rkit
 		virtual Result CreateRestartableDeflateDecompressStream(UniquePtr<ISeekableReadStream> &outStream, UniquePtr<ISeekableReadStream> &&compressedStream, FilePos_t decompressedSize) const = 0;
 		virtual Result CreateDeflateDecompressStream(UniquePtr<IReadStream> &outStream, UniquePtr<IReadStream> &&compressedStream) const = 0;
 		virtual Result CreateRangeLimitedReadStream(UniquePtr<ISeekableReadStream> &outStream, UniquePtr<ISeekableReadStream> &&stream, FilePos_t startPos, FilePos_t size) const = 0;
+		virtual Result CreateShadowFile(UniquePtr<utils::IShadowFile> &outShadowFile, UniquePtr<ISeekableReadWriteStream> &&stream, bool initialize) const = 0;
+		virtual Result CreateReadOnlyShadowFile(UniquePtr<utils::IShadowFile> &outShadowFile, UniquePtr<IFileMappingView> &&view) const = 0;
+
+		virtual Result CreateBufferedReadStream(UniquePtr<BufferedReadStream> &outStream, UniquePtr<IReadStream> &&stream, size_t bufferSize) const = 0;
+		virtual Result CreateBufferedSeekableReadStream(UniquePtr<BufferedSeekableReadStream> &outStream, UniquePtr<ISeekableReadStream> &&stream, size_t bufferSize) const = 0;
+		virtual Result CreateBufferedWriteStream(UniquePtr<BufferedWriteStream> &outStream, UniquePtr<IWriteStream> &&stream, size_t bufferSize) const = 0;
+		virtual Result CreateBufferedSeekableWriteStream(UniquePtr<BufferedSeekableWriteStream> &outStream, UniquePtr<ISeekableWriteStream> &&stream, size_t bufferSize) const = 0;
 
 		virtual Result CreateThreadPool(UniquePtr<utils::IThreadPool> &outThreadPool, uint32_t numThreads) const = 0;
 
+		// Returns the thread count to create a pool with so that one thread per processor runs
+		// normal-priority jobs.  Worker 0 of a multi-thread pool only runs I/O jobs, so this is
+		// the processor count plus one, minus one if the calling thread also runs jobs.
+		virtual uint32_t ComputeThreadPoolSize(bool callingThreadRunsJobs) const = 0;
+
 		virtual Result CreateTextParser(const Span<const uint8_t> &contents, utils::TextParserCommentType commentType, utils::TextParserLexerType lexType, UniquePtr<utils::ITextParser> &outParser) const = 0;
 		virtual Result ReadEntireFile(ISeekableReadStream &stream, Vector<uint8_t> &outBytes) const = 0;
 
@@ -108,6 +127,9 @@ namespace rkit
 		virtual Span<const uint16_t> GetSRGBToLinearTable() const = 0;
 		virtual int GetSRGBToLinearPrecisionBits() const = 0;
 
+		virtual const utils::IImageKernels *GetImageKernels() const = 0;
+		virtual const utils::IImageKernels *GetReferenceImageKernels() const = 0;
+
 		virtual bool ContainsWildcards(const StringSliceView &str) const = 0;
 		virtual bool MatchesWildcard(const StringSliceView &candidate, const StringSliceView &wildcard) const = 0;
 
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+namespace rkit
+{
+	// Deterministic generator for benchmark and test inputs, so that runs are comparable.
+	// Not suitable for anything that needs good statistical quality.
+	class XorShift32
+	{
+	public:
+		static const uint32_t kDefaultSeed = 0x2545f491u;
+
+		explicit XorShift32(uint32_t seed = kDefaultSeed);
+
+		uint32_t Next();
+
+		// Returns a value in [0, 1) with 24 bits of precision
+		float NextUnitFloat();
+
+	private:
+		uint32_t m_state;
+	};
+}
+
+namespace rkit
+{
+	inline XorShift32::XorShift32(uint32_t seed)
+		: m_state(seed)
+	{
+	}
+
+	inline uint32_t XorShift32::Next()
+	{
+		uint32_t state = m_state;
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		m_state = state;
+
+		return state;
+	}
+
+	inline float XorShift32::NextUnitFloat()
+	{
+		return static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f);
+	}
+}
@@ -18,6 +18,7 @@ namespace rkit
 
 	struct IWriteStream;
 	struct IReadStream;
+	struct ISeekableReadStream;
 
 	namespace utils
 	{
@@ -383,6 +384,14 @@ namespace rkit { namespace data
 		virtual uint32_t GetPackageVersion() const = 0;
 		virtual uint32_t GetPackageIdentifier() const = 0;
 
+		// Hash of the in-memory layout of every indexable type, from the RTTI field offsets and types.
+		// Packages store object images in this layout, so a package is only loadable if it matches.
+		virtual Result GetPackageLayoutHash(uint64_t &outHash) const = 0;
+
+		// Reads ahead, so the stream may be positioned past the end of the package afterward
 		virtual Result LoadPackage(IReadStream &stream, bool allowTempStrings, IRenderDataConfigurator *configurator, UniquePtr<IRenderDataPackage> &outPackage, Vector<Vector<uint8_t>> *outBinaryContent) const = 0;
+
+		// Leaves the stream positioned immediately after the package data
+		virtual Result LoadPackage(ISeekableReadStream &stream, bool allowTempStrings, IRenderDataConfigurator *configurator, UniquePtr<IRenderDataPackage> &outPackage, Vector<Vector<uint8_t>> *outBinaryContent) const = 0;
 	};
 } } // rkit::data
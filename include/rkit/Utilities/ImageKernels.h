@@ -0,0 +1,38 @@
+#pragma once
+
+#include "rkit/Core/SpanProtos.h"
+
+#include <stdint.h>
+
+namespace rkit { namespace utils
+{
+	enum class RGBChannelOrder : uint8_t
+	{
+		kRGB,
+		kBGR,
+	};
+
+	// Pixel conversion kernels.  All RGBA8 buffers are 4 bytes per pixel in R, G, B, A order.
+	// Each kernel converts as many pixels as fit in both the input and output spans.
+	// Vectorized implementations must produce the same bytes as the reference implementation.
+	struct IImageKernels
+	{
+		// Expands 8-bit palette indexes using an RGBA8 palette.  Returns false if any index is
+		// outside of the palette, in which case the output contents are unspecified.
+		virtual bool ExpandPalette8ToRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inIndexes, const Span<const uint8_t> &paletteRGBA) const = 0;
+
+		virtual void ExpandGray8ToRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inGray) const = 0;
+		virtual void ExpandRGB8ToRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inRGB, RGBChannelOrder inOrder) const = 0;
+
+		// Swaps the R and B channels, converting between RGBA8 and BGRA8
+		virtual void SwapRedBlueRGBA8(const Span<uint8_t> &outPixels, const Span<const uint8_t> &inPixels) const = 0;
+
+		// Multiplies color channels by alpha, rounding to nearest
+		virtual void PremultiplyAlphaRGBA8(const Span<uint8_t> &outRGBA, const Span<const uint8_t> &inRGBA) const = 0;
+
+		// Per-channel sRGB conversions using the utilities driver sRGB tables.  Linear values use
+		// GetSRGBToLinearPrecisionBits bits of precision.
+		virtual void DecodeSRGB8ToLinear(const Span<uint16_t> &outLinear, const Span<const uint8_t> &inSRGB) const = 0;
+		virtual void EncodeLinearToSRGB8(const Span<uint8_t> &outSRGB, const Span<const uint16_t> &inLinear) const = 0;
+	};
+} } // rkit::utils
@@ -19,6 +19,8 @@ namespace rkit { namespace utils
 {
 	struct IShadowFile
 	{
+		virtual ~IShadowFile() {}
+
 		virtual Result EntryExists(const StringSliceView &str, bool &outExists) = 0;
 
 		virtual Result TryOpenFileRead(UniquePtr<ISeekableReadStream> &outStream, const StringSliceView &str) = 0;